@@ -147,6 +147,21 @@ public:
     Impl::Store(&this->m_Object, static_cast<typename Impl::ValueType>(val));
   }
 
+  /** Atomically replace the value by desired if it is equal to expected,
+   * and return true. Otherwise, set expected to the current value and
+   * return false. */
+  bool compare_exchange_strong(T &expected, T desired)
+  {
+    if( Impl::CompareAndSwap(&this->m_Object,
+                             static_cast<typename Impl::ValueType>(expected),
+                             static_cast<typename Impl::ValueType>(desired)) )
+      {
+      return true;
+      }
+    expected = this->load();
+    return false;
+  }
+
 private:
   typename Impl::AtomicType m_Object;
 };
@@ -116,6 +116,11 @@ public:
     *static_cast<volatile ValueType*>(ref) = val;
     __sync_synchronize();
   }
+
+  static bool CompareAndSwap(ValueType *ref, ValueType oldValue, ValueType newValue)
+  {
+    return __sync_bool_compare_and_swap(ref, oldValue, newValue);
+  }
 };
 
 #endif // defined ITK_HAVE_SYNC_BUILTINS
@@ -176,6 +181,11 @@ public:
     *static_cast<volatile int64_t*>(ref) = val;
     OSMemoryBarrier();
   }
+
+  static bool CompareAndSwap(int64_t *ref, int64_t oldValue, int64_t newValue)
+  {
+    return OSAtomicCompareAndSwap64Barrier(oldValue, newValue, ref);
+  }
 };
 
 #else
@@ -206,6 +216,7 @@ public:
   static int64_t PostDecrement(AtomicType *ref);
   static int64_t Load(const AtomicType *ref);
   static void Store(AtomicType *ref, int64_t val);
+  static bool CompareAndSwap(AtomicType *ref, int64_t oldValue, int64_t newValue);
 };
 
 #endif
@@ -266,6 +277,11 @@ public:
     *static_cast<volatile int32_t*>(ref) = val;
     OSMemoryBarrier();
   }
+
+  static bool CompareAndSwap(int32_t *ref, int32_t oldValue, int32_t newValue)
+  {
+    return OSAtomicCompareAndSwap32Barrier(oldValue, newValue, ref);
+  }
 };
 
 #else
@@ -295,6 +311,7 @@ public:
   static int32_t PostDecrement(AtomicType *ref);
   static int32_t Load(const AtomicType *ref);
   static void Store(AtomicType *ref, int32_t val);
+  static bool CompareAndSwap(AtomicType *ref, int32_t oldValue, int32_t newValue);
 };
 
 #endif
@@ -0,0 +1,141 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkConcurrentUnionFind_h
+#define itkConcurrentUnionFind_h
+
+#include "itkAtomicInt.h"
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+/** \class ConcurrentUnionFind
+ * \brief Disjoint sets of labels which several threads can merge
+ * concurrently, without locks.
+ *
+ * Each label is inserted in its own set with InsertSet(). The root of a set
+ * is its smallest label: LinkLabels() links the root of the larger label to
+ * the root of the smaller one with an atomic compare and swap, and starts
+ * again if another thread changed the root meanwhile. LookupSet() halves the
+ * path it follows, also with compare and swaps, so that InsertSet() of
+ * distinct labels, LookupSet() and LinkLabels() may be called by several
+ * threads at the same time.
+ *
+ * As the roots are the smallest labels, the sets do not depend on the order
+ * in which the threads link the labels. Once all the labels are linked,
+ * FlattenSet() makes a label point directly to its root, so that
+ * GetParent() gives the root.
+ *
+ * The labeling filters use it to merge the labels found in different parts
+ * of an image by different threads.
+ *
+ * \ingroup ITKCommon
+ */
+template< typename TLabel >
+class ConcurrentUnionFind
+{
+public:
+  typedef TLabel                      LabelType;
+  typedef AtomicInt< LabelType >      ParentType;
+  typedef std::vector< ParentType >   ParentsContainerType;
+
+  /** Set the number of labels, i.e. one more than the largest label. The
+   * labels have to be inserted afterwards. Not thread safe. */
+  void SetSize(SizeValueType size)
+  {
+    ParentsContainerType parents( size );
+    m_Parents.swap(parents);
+  }
+
+  SizeValueType GetSize() const
+  {
+    return static_cast< SizeValueType >( m_Parents.size() );
+  }
+
+  /** Put a label in its own set. */
+  void InsertSet(const LabelType label)
+  {
+    m_Parents[label].store(label);
+  }
+
+  /** Get the parent of a label, which is its root once it is flattened. */
+  LabelType GetParent(const LabelType label) const
+  {
+    return m_Parents[label].load();
+  }
+
+  /** Get the root of the set of a label, halving the path to it. */
+  LabelType LookupSet(LabelType label)
+  {
+    while ( true )
+      {
+      LabelType parent = m_Parents[label].load();
+      if ( parent == label )
+        {
+        return label;
+        }
+      const LabelType grandParent = m_Parents[parent].load();
+      if ( grandParent == parent )
+        {
+        return parent;
+        }
+      // a failed swap means another thread already shortened the path
+      m_Parents[label].compare_exchange_strong(parent, grandParent);
+      label = grandParent;
+      }
+  }
+
+  /** Merge the sets of two labels. */
+  void LinkLabels(LabelType label1, LabelType label2)
+  {
+    while ( true )
+      {
+      label1 = this->LookupSet(label1);
+      label2 = this->LookupSet(label2);
+      if ( label1 == label2 )
+        {
+        return;
+        }
+      if ( label1 > label2 )
+        {
+        std::swap(label1, label2);
+        }
+      // label2 may no longer be a root if another thread linked it
+      LabelType expected = label2;
+      if ( m_Parents[label2].compare_exchange_strong(expected, label1) )
+        {
+        return;
+        }
+      }
+  }
+
+  /** Make a label point to its root, and return the root. To be called once
+   * all the labels are linked. */
+  LabelType FlattenSet(const LabelType label)
+  {
+    const LabelType root = this->LookupSet(label);
+    m_Parents[label].store(root);
+    return root;
+  }
+
+private:
+  ParentsContainerType m_Parents;
+};
+} // end namespace itk
+
+#endif
@@ -0,0 +1,221 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryImage_h
+#define itkPackedBinaryImage_h
+
+#include "itkImageBase.h"
+#include "itkImportImageContainer.h"
+#include "itkIntTypes.h"
+
+namespace itk
+{
+/** \class PackedBinaryImage
+ * \brief Binary image storing one bit per pixel.
+ *
+ * The pixels of each line along the first dimension are packed in 64 bits
+ * words: the pixel of index x in the buffered region is the bit
+ * (x % 64) of the word x / 64 of its line. Each line starts on a new word,
+ * and the padding bits of the last word of a line are always 0. A binary
+ * mask thus uses 8 times less memory than an Image< unsigned char >, and
+ * the filters working on this image type (PackedBinaryDilateImageFilter,
+ * PackedBinaryErodeImageFilter, PackedBinaryLogicImageFilter,
+ * PackedBinaryConnectedComponentImageFilter, ...) process 64 pixels per
+ * operation.
+ *
+ * PackedBinaryImage is not an Image: the image iterators and the regular
+ * image filters can't be used with it. Use ImageToPackedBinaryImageFilter
+ * and PackedBinaryImageToImageFilter to convert from and to an Image.
+ *
+ * \sa ImageToPackedBinaryImageFilter, PackedBinaryImageToImageFilter
+ * \ingroup ImageObjects
+ * \ingroup ITKCommon
+ */
+template< unsigned int VImageDimension = 3 >
+class PackedBinaryImage:public ImageBase< VImageDimension >
+{
+public:
+  /** Standard class typedefs */
+  typedef PackedBinaryImage            Self;
+  typedef ImageBase< VImageDimension > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PackedBinaryImage, ImageBase);
+
+  /** The value of a pixel: true for the foreground. */
+  typedef bool PixelType;
+
+  /** The type of the words the pixels are packed in. */
+  typedef uint64_t WordType;
+
+  /** Number of pixels in a word. */
+  itkStaticConstMacro(WordSize, unsigned int, 64);
+
+  /** Dimension of the image. */
+  itkStaticConstMacro(ImageDimension, unsigned int, VImageDimension);
+
+  typedef typename Superclass::IndexType       IndexType;
+  typedef typename Superclass::IndexValueType  IndexValueType;
+  typedef typename Superclass::OffsetType      OffsetType;
+  typedef typename Superclass::OffsetValueType OffsetValueType;
+  typedef typename Superclass::SizeType        SizeType;
+  typedef typename Superclass::SizeValueType   SizeValueType;
+  typedef typename Superclass::RegionType      RegionType;
+  typedef typename Superclass::SpacingType     SpacingType;
+  typedef typename Superclass::PointType       PointType;
+  typedef typename Superclass::DirectionType   DirectionType;
+
+  /** Container used to store the words. */
+  typedef ImportImageContainer< SizeValueType, WordType > PixelContainer;
+  typedef typename PixelContainer::Pointer                PixelContainerPointer;
+  typedef typename PixelContainer::ConstPointer           PixelContainerConstPointer;
+
+  /** Set the buffered region and update the layout of the lines. */
+  virtual void SetBufferedRegion(const RegionType & region) ITK_OVERRIDE;
+
+  /** Allocate the words of the buffered region. */
+  virtual void Allocate(bool initializePixels = false) ITK_OVERRIDE;
+
+  /** Restore the data object to its initial state. This means releasing
+   * memory. */
+  virtual void Initialize() ITK_OVERRIDE;
+
+  /** Set all the pixels of the buffered region to value. */
+  void FillBuffer(bool value);
+
+  /** Set/Get a pixel. These methods are slow: use the words of the lines to
+   * process the image. */
+  void SetPixel(const IndexType & index, bool value)
+  {
+    WordType *          line = this->GetLineBufferPointer(index);
+    const SizeValueType x = index[0] - this->GetBufferedRegion().GetIndex()[0];
+    const WordType      bit = static_cast< WordType >( 1 ) << ( x % WordSize );
+    if ( value )
+      {
+      line[x / WordSize] |= bit;
+      }
+    else
+      {
+      line[x / WordSize] &= ~bit;
+      }
+  }
+
+  bool GetPixel(const IndexType & index) const
+  {
+    const WordType *    line = this->GetLineBufferPointer(index);
+    const SizeValueType x = index[0] - this->GetBufferedRegion().GetIndex()[0];
+    return ( line[x / WordSize] >> ( x % WordSize ) ) & 1;
+  }
+
+  /** Number of words used to store a line of the buffered region. */
+  SizeValueType GetNumberOfWordsPerLine() const
+  {
+    return m_WordsPerLine;
+  }
+
+  /** Number of lines in the buffered region. */
+  SizeValueType GetNumberOfLines() const
+  {
+    return m_NumberOfLines;
+  }
+
+  /** Mask of the bits of the last word of a line which are in the buffered
+   * region. */
+  WordType GetLastWordMask() const
+  {
+    return m_LastWordMask;
+  }
+
+  /** Pointer to the first word of the line containing index. index[0] is
+   * ignored. */
+  WordType * GetLineBufferPointer(const IndexType & index)
+  {
+    return this->GetBufferPointer() + this->ComputeLineOffset(index);
+  }
+  const WordType * GetLineBufferPointer(const IndexType & index) const
+  {
+    return this->GetBufferPointer() + this->ComputeLineOffset(index);
+  }
+
+  /** Offset of the first word of the line containing index from the
+   * beginning of the buffer. index[0] is ignored. */
+  OffsetValueType ComputeLineOffset(const IndexType & index) const
+  {
+    const IndexType & bufferIndex = this->GetBufferedRegion().GetIndex();
+    OffsetValueType   offset = 0;
+    for ( unsigned int i = 1; i < VImageDimension; i++ )
+      {
+      offset += ( index[i] - bufferIndex[i] ) * m_LineOffsetTable[i];
+      }
+    return offset;
+  }
+
+  /** Return a pointer to the beginning of the buffer. */
+  WordType * GetBufferPointer()
+  { return m_Buffer ? m_Buffer->GetBufferPointer() : ITK_NULLPTR; }
+  const WordType * GetBufferPointer() const
+  { return m_Buffer ? m_Buffer->GetBufferPointer() : ITK_NULLPTR; }
+
+  /** Return a pointer to the container. */
+  PixelContainer * GetPixelContainer()
+  { return m_Buffer.GetPointer(); }
+  const PixelContainer * GetPixelContainer() const
+  { return m_Buffer.GetPointer(); }
+
+  /** Set the container to use. The container must be allocated with
+   * the right number of words for the buffered region. */
+  void SetPixelContainer(PixelContainer *container);
+
+  /** Graft the data and information from one image to another. */
+  virtual void Graft(const DataObject *data) ITK_OVERRIDE;
+
+  virtual unsigned int GetNumberOfComponentsPerPixel() const ITK_OVERRIDE
+  {
+    return 1;
+  }
+
+protected:
+  PackedBinaryImage();
+  virtual ~PackedBinaryImage() {}
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** Compute the number of words per line and the line offset table from
+   * the buffered region. */
+  void ComputeLineOffsetTable();
+
+private:
+  PackedBinaryImage(const Self &); //purposely not implemented
+  void operator=(const Self &);    //purposely not implemented
+
+  PixelContainerPointer m_Buffer;
+  SizeValueType         m_WordsPerLine;
+  SizeValueType         m_NumberOfLines;
+  WordType              m_LastWordMask;
+  OffsetValueType       m_LineOffsetTable[VImageDimension + 1];
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkPackedBinaryImage.hxx"
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryImage_hxx
+#define itkPackedBinaryImage_hxx
+
+#include "itkPackedBinaryImage.h"
+#include <algorithm>
+
+namespace itk
+{
+template< unsigned int VImageDimension >
+PackedBinaryImage< VImageDimension >
+::PackedBinaryImage()
+{
+  m_Buffer = PixelContainer::New();
+  m_WordsPerLine = 0;
+  m_NumberOfLines = 0;
+  m_LastWordMask = 0;
+  std::fill_n( m_LineOffsetTable, VImageDimension + 1, 0 );
+}
+
+template< unsigned int VImageDimension >
+void
+PackedBinaryImage< VImageDimension >
+::ComputeLineOffsetTable()
+{
+  const SizeType & size = this->GetBufferedRegion().GetSize();
+
+  m_WordsPerLine = ( size[0] + WordSize - 1 ) / WordSize;
+  const SizeValueType lastBits = size[0] % WordSize;
+  m_LastWordMask = lastBits == 0 ? ~static_cast< WordType >( 0 )
+                   : ( static_cast< WordType >( 1 ) << lastBits ) - 1;
+
+  m_LineOffsetTable[0] = 0;
+  m_LineOffsetTable[1] = m_WordsPerLine;
+  m_NumberOfLines = 1;
+  for ( unsigned int i = 1; i < VImageDimension; i++ )
+    {
+    m_LineOffsetTable[i + 1] = m_LineOffsetTable[i] * size[i];
+    m_NumberOfLines *= size[i];
+    }
+}
+
+template< unsigned int VImageDimension >
+void
+PackedBinaryImage< VImageDimension >
+::SetBufferedRegion(const RegionType & region)
+{
+  Superclass::SetBufferedRegion(region);
+  this->ComputeLineOffsetTable();
+}
+
+template< unsigned int VImageDimension >
+void
+PackedBinaryImage< VImageDimension >
+::Allocate(bool initializePixels)
+{
+  this->ComputeOffsetTable();
+  this->ComputeLineOffsetTable();
+  m_Buffer->Reserve(m_WordsPerLine * m_NumberOfLines, initializePixels);
+  // the padding bits must always be 0
+  if ( !initializePixels )
+    {
+    this->FillBuffer(false);
+    }
+}
+
+template< unsigned int VImageDimension >
+void
+PackedBinaryImage< VImageDimension >
+::Initialize()
+{
+  // Call the superclass which should initialize the BufferedRegion ivar.
+  Superclass::Initialize();
+
+  // Replace the handle to the buffer. This is the safest thing to do,
+  // since the same container can be shared by multiple images (e.g.
+  // Grafted outputs and in place filters).
+  m_Buffer = PixelContainer::New();
+  this->ComputeLineOffsetTable();
+}
+
+template< unsigned int VImageDimension >
+void
+PackedBinaryImage< VImageDimension >
+::FillBuffer(bool value)
+{
+  if ( m_WordsPerLine == 0 )
+    {
+    // the lines are empty, there is no word to fill
+    return;
+    }
+  WordType *buffer = this->GetBufferPointer();
+  if ( !value )
+    {
+    std::fill_n( buffer, m_WordsPerLine * m_NumberOfLines, static_cast< WordType >( 0 ) );
+    return;
+    }
+  for ( SizeValueType l = 0; l < m_NumberOfLines; l++ )
+    {
+    WordType *line = buffer + l * m_WordsPerLine;
+    std::fill_n( line, m_WordsPerLine, ~static_cast< WordType >( 0 ) );
+    line[m_WordsPerLine - 1] = m_LastWordMask;
+    }
+}
+
+template< unsigned int VImageDimension >
+void
+PackedBinaryImage< VImageDimension >
+::SetPixelContainer(PixelContainer *container)
+{
+  if ( m_Buffer != container )
+    {
+    m_Buffer = container;
+    this->Modified();
+    }
+}
+
+template< unsigned int VImageDimension >
+void
+PackedBinaryImage< VImageDimension >
+::Graft(const DataObject *data)
+{
+  // call the superclass' implementation
+  Superclass::Graft(data);
+
+  if ( data )
+    {
+    // Attempt to cast data to a PackedBinaryImage
+    const Self * const imgData = dynamic_cast< const Self * >( data );
+
+    if ( imgData != ITK_NULLPTR )
+      {
+      // Now copy anything remaining that is needed
+      this->SetPixelContainer( const_cast< PixelContainer * >
+                               ( imgData->GetPixelContainer() ) );
+      this->ComputeLineOffsetTable();
+      }
+    else
+      {
+      // pointer could not be cast back down
+      itkExceptionMacro( << "itk::PackedBinaryImage::Graft() cannot cast "
+                         << typeid( data ).name() << " to "
+                         << typeid( const Self * ).name() );
+      }
+    }
+}
+
+template< unsigned int VImageDimension >
+void
+PackedBinaryImage< VImageDimension >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "WordsPerLine: " << m_WordsPerLine << std::endl;
+  os << indent << "NumberOfLines: " << m_NumberOfLines << std::endl;
+  os << indent << "PixelContainer: " << std::endl;
+  m_Buffer->Print( os, indent.GetNextIndent() );
+}
+} // end namespace itk
+
+#endif
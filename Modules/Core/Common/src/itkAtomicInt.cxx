@@ -175,6 +175,21 @@ void AtomicOps<8>::Store(AtomicType *ref, int64_t val)
 #endif
 }
 
+bool AtomicOps<8>::CompareAndSwap(AtomicType *ref, int64_t oldValue, int64_t newValue)
+{
+#if defined(ITK_WINDOWS_ATOMICS_64)
+  return InterlockedCompareExchange64(ref, newValue, oldValue) == oldValue;
+#else
+  MutexLockHolder<SimpleFastMutexLock> mutexHolder(*ref->mutex);
+  if( ref->var != oldValue )
+    {
+    return false;
+    }
+  ref->var = newValue;
+  return true;
+#endif
+}
+
 #endif // defined(ITK_WINDOWS_ATOMICS_64) || defined(ITK_LOCK_BASED_ATOMICS_64)
 
 
@@ -272,6 +287,21 @@ void AtomicOps<4>::Store(AtomicType *ref, int32_t val)
 #endif
 }
 
+bool AtomicOps<4>::CompareAndSwap(AtomicType *ref, int32_t oldValue, int32_t newValue)
+{
+#if defined(ITK_WINDOWS_ATOMICS_32)
+  return InterlockedCompareExchange(reinterpret_cast<long*>(ref), newValue, oldValue) == oldValue;
+#else
+  MutexLockHolder<SimpleFastMutexLock> mutexHolder(*ref->mutex);
+  if( ref->var != oldValue )
+    {
+    return false;
+    }
+  ref->var = newValue;
+  return true;
+#endif
+}
+
 #endif // defined(ITK_WINDOWS_ATOMICS_32) || defined(ITK_LOCK_BASED_ATOMICS_32)
 
 } // namespace Detail
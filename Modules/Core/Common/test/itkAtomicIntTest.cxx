@@ -112,6 +112,24 @@ ITK_THREAD_RETURN_TYPE MyFunction4(void *)
   return ITK_THREAD_RETURN_VALUE;
 }
 
+ITK_THREAD_RETURN_TYPE MyFunction5(void *)
+{
+  for (int i=0; i<Target/NumThreads; i++)
+    {
+    itk::uint32_t expected = TotalAtomic.load();
+    while (!TotalAtomic.compare_exchange_strong(expected, expected + 1))
+      {
+      }
+
+    itk::uint64_t expected64 = TotalAtomic64.load();
+    while (!TotalAtomic64.compare_exchange_strong(expected64, expected64 + 1))
+      {
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 int itkAtomicIntTest(int, char*[])
 {
   Total = 0;
@@ -199,5 +217,25 @@ int itkAtomicIntTest(int, char*[])
     return 1;
     }
 
+  // compare and swap increments
+  mt->SetSingleMethod(MyFunction5, NULL);
+  mt->SingleMethodExecute();
+
+  if (TotalAtomic.load() != static_cast<itk::uint32_t>(2 * Target) ||
+      TotalAtomic64.load() != static_cast<itk::uint64_t>(2 * Target) )
+    {
+    std::cout << "Wrong compare and swap increments: " << TotalAtomic.load()
+              << " " << TotalAtomic64.load() << std::endl;
+    return 1;
+    }
+
+  itk::uint32_t expected = 0;
+  if (TotalAtomic.compare_exchange_strong(expected, 5) ||
+      expected != static_cast<itk::uint32_t>(2 * Target) )
+    {
+    std::cout << "The failed compare and swap did not return the value" << std::endl;
+    return 1;
+    }
+
   return 0;
 }
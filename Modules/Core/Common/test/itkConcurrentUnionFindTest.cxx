@@ -0,0 +1,115 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkConcurrentUnionFind.h"
+#include "itkMultiThreader.h"
+#include <iostream>
+
+/**
+ * Several threads link the labels of interleaved chains concurrently: the
+ * label i is linked to the label i + NumberOfChains, in an order depending
+ * on the thread. Each chain must end up in a single set, whose root is its
+ * smallest label.
+ */
+
+namespace
+{
+typedef itk::ConcurrentUnionFind< itk::IdentifierType > UnionFindType;
+
+const unsigned int NumberOfThreads = 4;
+const unsigned int NumberOfChains = 7;
+const unsigned int NumberOfLabels = 100000;
+
+UnionFindType UnionFind;
+
+ITK_THREAD_RETURN_TYPE ConcurrentUnionFindTestLink( void * arg )
+{
+  const itk::ThreadIdType threadId = static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg )->ThreadID;
+
+  for( unsigned int i = threadId; i + NumberOfChains < NumberOfLabels; i += NumberOfThreads )
+    {
+    // link from both ends of the chains, with the labels in both orders
+    const unsigned int label = ( threadId % 2 == 0 ) ? i : NumberOfLabels - NumberOfChains - 1 - i;
+    if( threadId < 2 )
+      {
+      UnionFind.LinkLabels( label, label + NumberOfChains );
+      }
+    else
+      {
+      UnionFind.LinkLabels( label + NumberOfChains, label );
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+ITK_THREAD_RETURN_TYPE ConcurrentUnionFindTestFlatten( void * arg )
+{
+  const itk::ThreadIdType threadId = static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg )->ThreadID;
+
+  for( unsigned int label = threadId; label < NumberOfLabels; label += NumberOfThreads )
+    {
+    UnionFind.FlattenSet( label );
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+}
+
+int itkConcurrentUnionFindTest( int, char *[] )
+{
+  UnionFind.SetSize( NumberOfLabels );
+  if( UnionFind.GetSize() != NumberOfLabels )
+    {
+    std::cerr << "Wrong size: " << UnionFind.GetSize() << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int label = 0; label < NumberOfLabels; ++label )
+    {
+    UnionFind.InsertSet( label );
+    }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetGlobalMaximumNumberOfThreads( 128 );
+  threader->SetNumberOfThreads( NumberOfThreads );
+  threader->SetSingleMethod( ConcurrentUnionFindTestLink, ITK_NULLPTR );
+  threader->SingleMethodExecute();
+
+  // linking again labels of the same set changes nothing
+  const unsigned int lastLabel = ( NumberOfLabels - 1 ) / NumberOfChains * NumberOfChains;
+  UnionFind.LinkLabels( NumberOfChains, lastLabel );
+  if( UnionFind.LookupSet( lastLabel ) != 0 )
+    {
+    std::cerr << "Wrong root after linking labels of the same set" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  threader->SetSingleMethod( ConcurrentUnionFindTestFlatten, ITK_NULLPTR );
+  threader->SingleMethodExecute();
+
+  for( unsigned int label = 0; label < NumberOfLabels; ++label )
+    {
+    if( UnionFind.GetParent( label ) != label % NumberOfChains )
+      {
+      std::cerr << "Wrong root of label " << label << ": " << UnionFind.GetParent( label )
+                << " instead of " << label % NumberOfChains << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
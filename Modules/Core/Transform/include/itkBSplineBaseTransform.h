@@ -63,7 +63,8 @@ public:
   typedef typename Superclass::ParametersType      ParametersType;
 
   /** Standard Jacobian container. */
-  typedef typename Superclass::JacobianType JacobianType;
+  typedef typename Superclass::JacobianType               JacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
 
   /** Transform category type. */
   typedef typename Superclass::TransformCategoryType TransformCategoryType;
@@ -275,6 +276,17 @@ public:
 
   virtual void ComputeJacobianWithRespectToParameters( const InputPointType &, JacobianType & ) const ITK_OVERRIDE = 0;
 
+  /** Return the number of parameters the jacobian at a point depends on,
+   * that is SpaceDimension times the number of weights. */
+  virtual NumberOfParametersType GetNumberOfNonZeroJacobianIndices() const ITK_OVERRIDE;
+
+  /** Compute the jacobian with respect to the parameters of the support
+   * region of a point only. The columns of the jacobian are ordered by
+   * dimension, then by weight. Outside of the valid region, the jacobian
+   * is zero. */
+  virtual void ComputeSparseJacobianWithRespectToParameters( const InputPointType &, JacobianType &,
+                                                             NonZeroJacobianIndicesType & ) const ITK_OVERRIDE;
+
   virtual void ComputeJacobianWithRespectToPosition( const InputPointType &, JacobianType & ) const ITK_OVERRIDE
   {
     itkExceptionMacro( << "ComputeJacobianWithRespectToPosition not yet implemented "
@@ -305,6 +305,43 @@ BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
     }
 }
 
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+typename BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>::NumberOfParametersType
+BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
+::GetNumberOfNonZeroJacobianIndices() const
+{
+  return SpaceDimension * this->m_WeightsFunction->GetNumberOfWeights();
+}
+
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+void
+BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
+::ComputeSparseJacobianWithRespectToParameters( const InputPointType & point,
+  JacobianType & jacobian, NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const
+{
+  const NumberOfParametersType numberOfWeights = this->m_WeightsFunction->GetNumberOfWeights();
+  const NumberOfParametersType numberOfParametersPerDimension = this->GetNumberOfParametersPerDimension();
+
+  // Only the weights of the support region are non zero, and they are the
+  // same for each dimension. Outside of the valid region, the weights are
+  // zero and the indices are those of the first coefficient.
+  WeightsType             weights( numberOfWeights );
+  ParameterIndexArrayType indices( numberOfWeights );
+  this->ComputeJacobianFromBSplineWeightsWithRespectToPosition( point, weights, indices );
+
+  jacobian.SetSize( SpaceDimension, SpaceDimension * numberOfWeights );
+  jacobian.Fill( 0.0 );
+  nonZeroJacobianIndices.resize( SpaceDimension * numberOfWeights );
+  for( unsigned int d = 0; d < SpaceDimension; d++ )
+    {
+    for( NumberOfParametersType k = 0; k < numberOfWeights; k++ )
+      {
+      jacobian( d, d * numberOfWeights + k ) = weights[k];
+      nonZeroJacobianIndices[d * numberOfWeights + k] = indices[k] + d * numberOfParametersPerDimension;
+      }
+    }
+}
+
 template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
 unsigned int
 BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
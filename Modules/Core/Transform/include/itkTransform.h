@@ -25,6 +25,7 @@
 #include "itkVariableLengthVector.h"
 #include "vnl/vnl_vector_fixed.h"
 #include "itkMatrix.h"
+#include <vector>
 
 namespace itk
 {
@@ -182,6 +183,10 @@ public:
 
   typedef typename Superclass::NumberOfParametersType    NumberOfParametersType;
 
+  /** Type of the indices of the parameters the jacobian at a point
+   * may depend on, see ComputeSparseJacobianWithRespectToParameters(). */
+  typedef std::vector< NumberOfParametersType > NonZeroJacobianIndicesType;
+
   /**  Method to transform a point.
    * \warning This method must be thread-safe. See, e.g., its use
    * in ResampleImageFilter.
@@ -526,6 +531,35 @@ public:
     this->ComputeJacobianWithRespectToParameters(p, jacobian);
   }
 
+  /** Return the number of parameters the jacobian at any single point may
+   *  depend on, i.e. the number of columns of the jacobian computed by
+   *  ComputeSparseJacobianWithRespectToParameters(). Transforms with a sparse
+   *  jacobian, e.g. BSplineTransform, return much less than
+   *  GetNumberOfParameters(). */
+  virtual NumberOfParametersType GetNumberOfNonZeroJacobianIndices() const
+  {
+    return this->GetNumberOfLocalParameters();
+  }
+
+  /** Compute the columns of the jacobian with respect to the parameters
+   *  which may be non zero at \c p. On return, the column \c i of
+   *  \c jacobian holds the partial derivatives with respect to the parameter
+   *  \c nonZeroJacobianIndices[i]. This is meant for transforms with global
+   *  support only.
+   *  \c jacobian and \c nonZeroJacobianIndices are assumed to be thread-local
+   *  variables, and are only resized when needed. */
+  virtual void ComputeSparseJacobianWithRespectToParameters(const InputPointType & p, JacobianType & jacobian,
+                                                            NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+  {
+    //NOTE: default implementation returns the whole jacobian.
+    this->ComputeJacobianWithRespectToParameters(p, jacobian);
+    nonZeroJacobianIndices.resize( jacobian.cols() );
+    for( NumberOfParametersType i = 0; i < nonZeroJacobianIndices.size(); ++i )
+      {
+      nonZeroJacobianIndices[i] = i;
+      }
+  }
+
 
   /** This provides the ability to get a local jacobian value
    *  in a dense/local transform, e.g. DisplacementFieldTransform. For such
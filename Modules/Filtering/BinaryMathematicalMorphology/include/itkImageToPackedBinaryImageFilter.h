@@ -0,0 +1,92 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkImageToPackedBinaryImageFilter_h
+#define itkImageToPackedBinaryImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkPackedBinaryImage.h"
+#include "itkImageRegionSplitterDirection.h"
+
+namespace itk
+{
+/** \class ImageToPackedBinaryImageFilter
+ * \brief Convert an image to a PackedBinaryImage.
+ *
+ * The pixels equal to ForegroundValue are set to true in the output, all
+ * the other pixels are set to false. ForegroundValue defaults to the
+ * maximum value of the pixel type.
+ *
+ * \sa PackedBinaryImage, PackedBinaryImageToImageFilter
+ * \ingroup ITKBinaryMathematicalMorphology
+ */
+template< typename TInputImage >
+class ImageToPackedBinaryImageFilter:
+  public ImageToImageFilter< TInputImage, PackedBinaryImage< TInputImage::ImageDimension > >
+{
+public:
+  /** Standard class typedefs. */
+  typedef ImageToPackedBinaryImageFilter                     Self;
+  typedef PackedBinaryImage< TInputImage::ImageDimension >   OutputImageType;
+  typedef ImageToImageFilter< TInputImage, OutputImageType > Superclass;
+  typedef SmartPointer< Self >                               Pointer;
+  typedef SmartPointer< const Self >                         ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ImageToPackedBinaryImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef TInputImage                          InputImageType;
+  typedef typename InputImageType::PixelType   InputPixelType;
+  typedef typename OutputImageType::RegionType OutputImageRegionType;
+  typedef typename OutputImageType::WordType   WordType;
+
+  /** Set/Get the value of the input pixels converted to true. */
+  itkSetMacro(ForegroundValue, InputPixelType);
+  itkGetConstMacro(ForegroundValue, InputPixelType);
+
+protected:
+  ImageToPackedBinaryImageFilter();
+  virtual ~ImageToPackedBinaryImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            ThreadIdType threadId) ITK_OVERRIDE;
+
+  /** The lines are never split between the threads, so that each thread
+   * writes its own words. */
+  virtual const ImageRegionSplitterBase * GetImageRegionSplitter() const ITK_OVERRIDE;
+
+private:
+  ImageToPackedBinaryImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                 //purposely not implemented
+
+  InputPixelType m_ForegroundValue;
+
+  ImageRegionSplitterDirection::Pointer m_ImageRegionSplitter;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageToPackedBinaryImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,94 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkImageToPackedBinaryImageFilter_hxx
+#define itkImageToPackedBinaryImageFilter_hxx
+
+#include "itkImageToPackedBinaryImageFilter.h"
+#include "itkImageScanlineConstIterator.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+
+namespace itk
+{
+template< typename TInputImage >
+ImageToPackedBinaryImageFilter< TInputImage >
+::ImageToPackedBinaryImageFilter()
+{
+  m_ForegroundValue = NumericTraits< InputPixelType >::max();
+  m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
+  m_ImageRegionSplitter->SetDirection(0);
+}
+
+template< typename TInputImage >
+const ImageRegionSplitterBase *
+ImageToPackedBinaryImageFilter< TInputImage >
+::GetImageRegionSplitter() const
+{
+  return m_ImageRegionSplitter.GetPointer();
+}
+
+template< typename TInputImage >
+void
+ImageToPackedBinaryImageFilter< TInputImage >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  const InputImageType *input = this->GetInput();
+  OutputImageType *     output = this->GetOutput();
+
+  const unsigned int  wordSize = OutputImageType::WordSize;
+  const SizeValueType lineSize = outputRegionForThread.GetSize()[0];
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / lineSize );
+
+  // the lines are complete, so the words are built in a register and
+  // written once
+  ImageScanlineConstIterator< InputImageType > it(input, outputRegionForThread);
+  while ( !it.IsAtEnd() )
+    {
+    WordType *line = output->GetLineBufferPointer( it.GetIndex() );
+    for ( SizeValueType start = 0; start < lineSize; start += wordSize )
+      {
+      const SizeValueType end = std::min( start + wordSize, lineSize );
+      WordType            word = 0;
+      for ( SizeValueType x = start; x < end; ++x )
+        {
+        word |= static_cast< WordType >( it.Get() == m_ForegroundValue ) << ( x - start );
+        ++it;
+        }
+      *line++ = word;
+      }
+    it.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+template< typename TInputImage >
+void
+ImageToPackedBinaryImageFilter< TInputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "ForegroundValue: "
+     << static_cast< typename NumericTraits< InputPixelType >::PrintType >( m_ForegroundValue ) << std::endl;
+}
+} // end namespace itk
+
+#endif
@@ -0,0 +1,127 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryConnectedComponentImageFilter_h
+#define itkPackedBinaryConnectedComponentImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkPackedBinaryImage.h"
+
+#include <vector>
+
+namespace itk
+{
+/** \class PackedBinaryConnectedComponentImageFilter
+ * \brief Label the objects of a PackedBinaryImage.
+ *
+ * The runs of true pixels of each line are extracted 64 pixels at a time
+ * by locating the bit transitions in the words, and the runs overlapping in
+ * the neighbor lines are merged with a union-find. The output is the same
+ * as the one of ConnectedComponentImageFilter: the labels start at 1 and
+ * are consecutive, the objects reached earlier in raster order have a
+ * lower label, and the background is 0.
+ *
+ * After the filter is executed, ObjectCount holds the number of connected
+ * components.
+ *
+ * \sa ConnectedComponentImageFilter, PackedBinaryImage
+ * \ingroup SingleThreaded
+ * \ingroup ITKBinaryMathematicalMorphology
+ */
+template< typename TInputImage, typename TOutputImage >
+class PackedBinaryConnectedComponentImageFilter:
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef PackedBinaryConnectedComponentImageFilter       Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                            Pointer;
+  typedef SmartPointer< const Self >                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PackedBinaryConnectedComponentImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  typedef TInputImage                          InputImageType;
+  typedef typename InputImageType::WordType    WordType;
+  typedef TOutputImage                         OutputImageType;
+  typedef typename OutputImageType::PixelType  OutputPixelType;
+  typedef typename OutputImageType::RegionType RegionType;
+  typedef typename OutputImageType::IndexType  IndexType;
+  typedef typename OutputImageType::OffsetType OffsetType;
+  typedef SizeValueType                        LabelType;
+
+  /** Set/Get whether the connected components are defined strictly by
+   * face connectivity or by face+edge+vertex connectivity. Default is
+   * FullyConnectedOff. */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstReferenceMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /** The number of objects found by the last execution. */
+  itkGetConstReferenceMacro(ObjectCount, LabelType);
+
+protected:
+  PackedBinaryConnectedComponentImageFilter();
+  virtual ~PackedBinaryConnectedComponentImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** The whole input is required. */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  /** The whole output is produced. */
+  void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ) ITK_OVERRIDE;
+
+  void GenerateData() ITK_OVERRIDE;
+
+private:
+  PackedBinaryConnectedComponentImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                            //purposely not implemented
+
+  /** The pixels in [Begin, End) of a line. */
+  struct RunType
+  {
+    SizeValueType Begin;
+    SizeValueType End;
+  };
+
+  /** Extract the runs of the lines of the input. */
+  void ComputeRuns();
+
+  /** Union-find on the run indices. */
+  SizeValueType FindRoot(SizeValueType run);
+  void Union(SizeValueType run1, SizeValueType run2);
+
+  bool      m_FullyConnected;
+  LabelType m_ObjectCount;
+
+  std::vector< RunType >       m_Runs;
+  std::vector< SizeValueType > m_LineRuns;
+  std::vector< SizeValueType > m_Parents;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkPackedBinaryConnectedComponentImageFilter.hxx"
+#endif
+
+#endif
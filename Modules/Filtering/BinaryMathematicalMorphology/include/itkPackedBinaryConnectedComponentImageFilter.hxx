@@ -0,0 +1,301 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryConnectedComponentImageFilter_hxx
+#define itkPackedBinaryConnectedComponentImageFilter_hxx
+
+#include "itkPackedBinaryConnectedComponentImageFilter.h"
+#include "itkPackedBinaryLineUtilities.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+
+namespace itk
+{
+template< typename TInputImage, typename TOutputImage >
+PackedBinaryConnectedComponentImageFilter< TInputImage, TOutputImage >
+::PackedBinaryConnectedComponentImageFilter()
+{
+  m_FullyConnected = false;
+  m_ObjectCount = 0;
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+PackedBinaryConnectedComponentImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType *input = const_cast< InputImageType * >( this->GetInput() );
+  if ( input )
+    {
+    input->SetRequestedRegion( input->GetLargestPossibleRegion() );
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+PackedBinaryConnectedComponentImageFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion(DataObject *)
+{
+  OutputImageType *output = this->GetOutput();
+  output->SetRequestedRegion( output->GetLargestPossibleRegion() );
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+PackedBinaryConnectedComponentImageFilter< TInputImage, TOutputImage >
+::ComputeRuns()
+{
+  const InputImageType *input = this->GetInput();
+  const SizeValueType   numberOfLines = input->GetNumberOfLines();
+  const SizeValueType   numberOfWords = input->GetNumberOfWordsPerLine();
+  const SizeValueType   lineSize = input->GetBufferedRegion().GetSize()[0];
+  const unsigned int    wordSize = InputImageType::WordSize;
+  const WordType *      words = input->GetBufferPointer();
+
+  m_Runs.clear();
+  m_LineRuns.resize(numberOfLines + 1);
+  for ( SizeValueType l = 0; l < numberOfLines; l++ )
+    {
+    m_LineRuns[l] = m_Runs.size();
+    bool    inRun = false;
+    RunType run;
+    for ( SizeValueType w = 0; w < numberOfWords; w++, words++ )
+      {
+      // look for the next transition, from the previous one
+      const WordType bits = *words;
+      unsigned int   position = 0;
+      while ( position < wordSize )
+        {
+        const WordType remaining = ( inRun ? ~bits : bits ) >> position;
+        if ( remaining == 0 )
+          {
+          break;
+          }
+        position += PackedBinaryLine::CountTrailingZeros(remaining);
+        if ( inRun )
+          {
+          run.End = w * wordSize + position;
+          m_Runs.push_back(run);
+          }
+        else
+          {
+          run.Begin = w * wordSize + position;
+          }
+        inRun = !inRun;
+        }
+      }
+    if ( inRun )
+      {
+      run.End = lineSize;
+      m_Runs.push_back(run);
+      }
+    }
+  m_LineRuns[numberOfLines] = m_Runs.size();
+}
+
+template< typename TInputImage, typename TOutputImage >
+SizeValueType
+PackedBinaryConnectedComponentImageFilter< TInputImage, TOutputImage >
+::FindRoot(SizeValueType run)
+{
+  while ( m_Parents[run] != run )
+    {
+    // path halving
+    m_Parents[run] = m_Parents[m_Parents[run]];
+    run = m_Parents[run];
+    }
+  return run;
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+PackedBinaryConnectedComponentImageFilter< TInputImage, TOutputImage >
+::Union(SizeValueType run1, SizeValueType run2)
+{
+  run1 = this->FindRoot(run1);
+  run2 = this->FindRoot(run2);
+  if ( run1 < run2 )
+    {
+    m_Parents[run2] = run1;
+    }
+  else
+    {
+    m_Parents[run1] = run2;
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+PackedBinaryConnectedComponentImageFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  this->AllocateOutputs();
+
+  OutputImageType *   output = this->GetOutput();
+  const RegionType    region = output->GetBufferedRegion();
+  const IndexType &   start = region.GetIndex();
+  const SizeValueType numberOfLines = region.GetNumberOfPixels() / region.GetSize()[0];
+
+  ProgressReporter progress(this, 0, 2 * numberOfLines);
+
+  this->ComputeRuns();
+
+  // the neighbor lines already visited in raster order
+  std::vector< OffsetType >      neighbors;
+  std::vector< OffsetValueType > neighborLines;
+  OffsetType                     offset;
+  offset.Fill(-1);
+  offset[0] = 0;
+  while ( true )
+    {
+    unsigned int    nonZero = 0;
+    unsigned int    last = 0;
+    OffsetValueType lineOffset = 0;
+    OffsetValueType stride = 1;
+    for ( unsigned int i = 1; i < ImageDimension; i++ )
+      {
+      if ( offset[i] != 0 )
+        {
+        nonZero++;
+        last = i;
+        }
+      lineOffset += offset[i] * stride;
+      stride *= region.GetSize()[i];
+      }
+    if ( nonZero > 0 && offset[last] < 0 && ( m_FullyConnected || nonZero == 1 ) )
+      {
+      neighbors.push_back(offset);
+      neighborLines.push_back(lineOffset);
+      }
+    unsigned int i = 1;
+    while ( i < ImageDimension && offset[i] == 1 )
+      {
+      offset[i++] = -1;
+      }
+    if ( i == ImageDimension )
+      {
+      break;
+      }
+    offset[i]++;
+    }
+  // with full connectivity, the diagonal neighbors of the ends of the runs
+  // are connected
+  const SizeValueType margin = m_FullyConnected ? 1 : 0;
+
+  m_Parents.resize( m_Runs.size() );
+  for ( SizeValueType r = 0; r < m_Runs.size(); r++ )
+    {
+    m_Parents[r] = r;
+    }
+
+  IndexType index = start;
+  for ( SizeValueType l = 0; l < numberOfLines; l++ )
+    {
+    for ( SizeValueType n = 0; n < neighbors.size(); n++ )
+      {
+      if ( !region.IsInside(index + neighbors[n]) )
+        {
+        continue;
+        }
+      const SizeValueType neighborLine = l + neighborLines[n];
+      SizeValueType       r1 = m_LineRuns[l];
+      SizeValueType       r2 = m_LineRuns[neighborLine];
+      const SizeValueType end1 = m_LineRuns[l + 1];
+      const SizeValueType end2 = m_LineRuns[neighborLine + 1];
+      while ( r1 < end1 && r2 < end2 )
+        {
+        if ( m_Runs[r1].Begin < m_Runs[r2].End + margin && m_Runs[r2].Begin < m_Runs[r1].End + margin )
+          {
+          this->Union(r1, r2);
+          }
+        // move forward the run ending first
+        if ( m_Runs[r1].End < m_Runs[r2].End )
+          {
+          r1++;
+          }
+        else
+          {
+          r2++;
+          }
+        }
+      }
+
+    for ( unsigned int i = 1; i < ImageDimension; i++ )
+      {
+      if ( ++index[i] < start[i] + static_cast< OffsetValueType >( region.GetSize()[i] ) )
+        {
+        break;
+        }
+      index[i] = start[i];
+      }
+    progress.CompletedPixel();
+    }
+
+  // consecutive labels, in the order of the first run of the objects
+  m_ObjectCount = 0;
+  std::vector< LabelType > labels( m_Runs.size(), 0 );
+  for ( SizeValueType r = 0; r < m_Runs.size(); r++ )
+    {
+    const SizeValueType root = this->FindRoot(r);
+    if ( labels[root] == 0 )
+      {
+      if ( m_ObjectCount >= static_cast< LabelType >( NumericTraits< OutputPixelType >::max() ) )
+        {
+        itkExceptionMacro(<< "Number of objects greater than maximum of output pixel type ("
+                          << static_cast< typename NumericTraits< OutputPixelType >::PrintType >
+                                            ( NumericTraits< OutputPixelType >::max() ) << ").");
+        }
+      labels[root] = ++m_ObjectCount;
+      }
+    labels[r] = labels[root];
+    }
+
+  const SizeValueType lineSize = region.GetSize()[0];
+  OutputPixelType *   line = output->GetBufferPointer();
+  for ( SizeValueType l = 0; l < numberOfLines; l++, line += lineSize )
+    {
+    std::fill( line, line + lineSize, NumericTraits< OutputPixelType >::ZeroValue() );
+    for ( SizeValueType r = m_LineRuns[l]; r < m_LineRuns[l + 1]; r++ )
+      {
+      std::fill( line + m_Runs[r].Begin, line + m_Runs[r].End, static_cast< OutputPixelType >( labels[r] ) );
+      }
+    progress.CompletedPixel();
+    }
+
+  // free the memory
+  std::vector< RunType >().swap(m_Runs);
+  std::vector< SizeValueType >().swap(m_LineRuns);
+  std::vector< SizeValueType >().swap(m_Parents);
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+PackedBinaryConnectedComponentImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FullyConnected: " << m_FullyConnected << std::endl;
+  os << indent << "ObjectCount: " << m_ObjectCount << std::endl;
+}
+} // end namespace itk
+
+#endif
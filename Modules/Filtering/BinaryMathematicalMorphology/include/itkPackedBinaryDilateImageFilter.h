@@ -0,0 +1,61 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryDilateImageFilter_h
+#define itkPackedBinaryDilateImageFilter_h
+
+#include "itkPackedBinaryMorphologyImageFilter.h"
+
+namespace itk
+{
+/** \class PackedBinaryDilateImageFilter
+ * \brief Fast dilation of a PackedBinaryImage.
+ *
+ * The output is the union of the input translated by all the offsets of
+ * the structuring element. The pixels outside the image are background.
+ *
+ * \sa PackedBinaryMorphologyImageFilter, BinaryDilateImageFilter
+ * \ingroup ITKBinaryMathematicalMorphology
+ */
+template< typename TImage, typename TKernel = FlatStructuringElement< TImage::ImageDimension > >
+class PackedBinaryDilateImageFilter:
+  public PackedBinaryMorphologyImageFilter< TImage, TKernel >
+{
+public:
+  /** Standard class typedefs. */
+  typedef PackedBinaryDilateImageFilter                        Self;
+  typedef PackedBinaryMorphologyImageFilter< TImage, TKernel > Superclass;
+  typedef SmartPointer< Self >                                 Pointer;
+  typedef SmartPointer< const Self >                           ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PackedBinaryDilateImageFilter, PackedBinaryMorphologyImageFilter);
+
+protected:
+  PackedBinaryDilateImageFilter() {}
+  virtual ~PackedBinaryDilateImageFilter() {}
+
+private:
+  PackedBinaryDilateImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                //purposely not implemented
+};
+} // end namespace itk
+
+#endif
@@ -0,0 +1,66 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryErodeImageFilter_h
+#define itkPackedBinaryErodeImageFilter_h
+
+#include "itkPackedBinaryMorphologyImageFilter.h"
+
+namespace itk
+{
+/** \class PackedBinaryErodeImageFilter
+ * \brief Fast erosion of a PackedBinaryImage.
+ *
+ * A pixel of the output is true when the input translated by all the
+ * offsets of the structuring element is true. The pixels outside the image
+ * are foreground, so the objects touching the border of the image are not
+ * eroded from the border.
+ *
+ * \sa PackedBinaryMorphologyImageFilter, BinaryErodeImageFilter
+ * \ingroup ITKBinaryMathematicalMorphology
+ */
+template< typename TImage, typename TKernel = FlatStructuringElement< TImage::ImageDimension > >
+class PackedBinaryErodeImageFilter:
+  public PackedBinaryMorphologyImageFilter< TImage, TKernel >
+{
+public:
+  /** Standard class typedefs. */
+  typedef PackedBinaryErodeImageFilter                         Self;
+  typedef PackedBinaryMorphologyImageFilter< TImage, TKernel > Superclass;
+  typedef SmartPointer< Self >                                 Pointer;
+  typedef SmartPointer< const Self >                           ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PackedBinaryErodeImageFilter, PackedBinaryMorphologyImageFilter);
+
+protected:
+  PackedBinaryErodeImageFilter()
+  {
+    this->m_Erosion = true;
+  }
+  virtual ~PackedBinaryErodeImageFilter() {}
+
+private:
+  PackedBinaryErodeImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);               //purposely not implemented
+};
+} // end namespace itk
+
+#endif
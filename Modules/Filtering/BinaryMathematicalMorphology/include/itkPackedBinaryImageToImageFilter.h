@@ -0,0 +1,97 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryImageToImageFilter_h
+#define itkPackedBinaryImageToImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkPackedBinaryImage.h"
+#include "itkImageRegionSplitterDirection.h"
+
+namespace itk
+{
+/** \class PackedBinaryImageToImageFilter
+ * \brief Convert a PackedBinaryImage to an image.
+ *
+ * The true pixels are set to ForegroundValue in the output, and the false
+ * pixels to BackgroundValue. ForegroundValue defaults to the maximum value
+ * of the pixel type, and BackgroundValue to 0.
+ *
+ * \sa PackedBinaryImage, ImageToPackedBinaryImageFilter
+ * \ingroup ITKBinaryMathematicalMorphology
+ */
+template< typename TOutputImage >
+class PackedBinaryImageToImageFilter:
+  public ImageToImageFilter< PackedBinaryImage< TOutputImage::ImageDimension >, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef PackedBinaryImageToImageFilter                     Self;
+  typedef PackedBinaryImage< TOutputImage::ImageDimension >  InputImageType;
+  typedef ImageToImageFilter< InputImageType, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                               Pointer;
+  typedef SmartPointer< const Self >                         ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PackedBinaryImageToImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  typedef TOutputImage                         OutputImageType;
+  typedef typename OutputImageType::PixelType  OutputPixelType;
+  typedef typename OutputImageType::RegionType OutputImageRegionType;
+  typedef typename InputImageType::WordType    WordType;
+
+  /** Set/Get the value of the output pixels for the true input pixels. */
+  itkSetMacro(ForegroundValue, OutputPixelType);
+  itkGetConstMacro(ForegroundValue, OutputPixelType);
+
+  /** Set/Get the value of the output pixels for the false input pixels. */
+  itkSetMacro(BackgroundValue, OutputPixelType);
+  itkGetConstMacro(BackgroundValue, OutputPixelType);
+
+protected:
+  PackedBinaryImageToImageFilter();
+  virtual ~PackedBinaryImageToImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            ThreadIdType threadId) ITK_OVERRIDE;
+
+  /** The lines are never split between the threads, so that the words
+   * are read only once. */
+  virtual const ImageRegionSplitterBase * GetImageRegionSplitter() const ITK_OVERRIDE;
+
+private:
+  PackedBinaryImageToImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                 //purposely not implemented
+
+  OutputPixelType m_ForegroundValue;
+  OutputPixelType m_BackgroundValue;
+
+  ImageRegionSplitterDirection::Pointer m_ImageRegionSplitter;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkPackedBinaryImageToImageFilter.hxx"
+#endif
+
+#endif
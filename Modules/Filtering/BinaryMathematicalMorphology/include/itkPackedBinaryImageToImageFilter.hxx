@@ -0,0 +1,97 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryImageToImageFilter_hxx
+#define itkPackedBinaryImageToImageFilter_hxx
+
+#include "itkPackedBinaryImageToImageFilter.h"
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+
+namespace itk
+{
+template< typename TOutputImage >
+PackedBinaryImageToImageFilter< TOutputImage >
+::PackedBinaryImageToImageFilter()
+{
+  m_ForegroundValue = NumericTraits< OutputPixelType >::max();
+  m_BackgroundValue = NumericTraits< OutputPixelType >::ZeroValue();
+  m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
+  m_ImageRegionSplitter->SetDirection(0);
+}
+
+template< typename TOutputImage >
+const ImageRegionSplitterBase *
+PackedBinaryImageToImageFilter< TOutputImage >
+::GetImageRegionSplitter() const
+{
+  return m_ImageRegionSplitter.GetPointer();
+}
+
+template< typename TOutputImage >
+void
+PackedBinaryImageToImageFilter< TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  const InputImageType *input = this->GetInput();
+  OutputImageType *     output = this->GetOutput();
+
+  const unsigned int  wordSize = InputImageType::WordSize;
+  const SizeValueType lineSize = outputRegionForThread.GetSize()[0];
+  // the input may be buffered on a larger region than the output
+  const SizeValueType firstBit = outputRegionForThread.GetIndex()[0]
+                                 - input->GetBufferedRegion().GetIndex()[0];
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / lineSize );
+
+  ImageScanlineIterator< OutputImageType > it(output, outputRegionForThread);
+  while ( !it.IsAtEnd() )
+    {
+    const WordType *line = input->GetLineBufferPointer( it.GetIndex() );
+    for ( SizeValueType x = firstBit; x < firstBit + lineSize; ++x )
+      {
+      if ( ( line[x / wordSize] >> ( x % wordSize ) ) & 1 )
+        {
+        it.Set(m_ForegroundValue);
+        }
+      else
+        {
+        it.Set(m_BackgroundValue);
+        }
+      ++it;
+      }
+    it.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+template< typename TOutputImage >
+void
+PackedBinaryImageToImageFilter< TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "ForegroundValue: "
+     << static_cast< typename NumericTraits< OutputPixelType >::PrintType >( m_ForegroundValue ) << std::endl;
+  os << indent << "BackgroundValue: "
+     << static_cast< typename NumericTraits< OutputPixelType >::PrintType >( m_BackgroundValue ) << std::endl;
+}
+} // end namespace itk
+
+#endif
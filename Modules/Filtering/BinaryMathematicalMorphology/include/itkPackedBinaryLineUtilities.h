@@ -0,0 +1,124 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryLineUtilities_h
+#define itkPackedBinaryLineUtilities_h
+
+#include "itkIntTypes.h"
+
+namespace itk
+{
+/** \class PackedBinaryLineUtilities
+ * \brief Word level operations on the lines of a PackedBinaryImage.
+ *
+ * The pixel x of a line is the bit (x % 64) of the word x / 64.
+ *
+ * \ingroup ITKBinaryMathematicalMorphology
+ */
+namespace PackedBinaryLine
+{
+typedef uint64_t WordType;
+
+/** Number of pixels in a word. */
+const unsigned int WordSize = 64;
+
+/** out[x] |= in[x - shift] for all the pixels of the lines of
+ * numberOfWords words. The pixels shifted out of the line are lost and
+ * the pixels shifted in are 0. in and out can be the same line only if
+ * shift is positive. */
+inline void ShiftOr(const WordType *in, WordType *out, SizeValueType numberOfWords, OffsetValueType shift)
+{
+  if ( shift >= 0 )
+    {
+    const SizeValueType wordShift = shift / WordSize;
+    const unsigned int  bitShift = shift % WordSize;
+    if ( wordShift >= numberOfWords )
+      {
+      return;
+      }
+    // go backward so that the line can be shifted in place
+    for ( SizeValueType i = numberOfWords - 1; i > wordShift; i-- )
+      {
+      WordType w = in[i - wordShift] << bitShift;
+      if ( bitShift != 0 )
+        {
+        w |= in[i - wordShift - 1] >> ( WordSize - bitShift );
+        }
+      out[i] |= w;
+      }
+    out[wordShift] |= in[0] << bitShift;
+    }
+  else
+    {
+    const SizeValueType wordShift = ( -shift ) / WordSize;
+    const unsigned int  bitShift = ( -shift ) % WordSize;
+    if ( wordShift >= numberOfWords )
+      {
+      return;
+      }
+    const SizeValueType last = numberOfWords - 1 - wordShift;
+    for ( SizeValueType i = 0; i < last; i++ )
+      {
+      WordType w = in[i + wordShift] >> bitShift;
+      if ( bitShift != 0 )
+        {
+        w |= in[i + wordShift + 1] << ( WordSize - bitShift );
+        }
+      out[i] |= w;
+      }
+    out[last] |= in[numberOfWords - 1] >> bitShift;
+    }
+}
+
+/** line[x] = OR of line[x - t] for t in [0, length), computed in place with
+ * O(log(length)) shifts of the whole line. */
+inline void RunDilate(WordType *line, SizeValueType numberOfWords, SizeValueType length)
+{
+  SizeValueType covered = 1;
+  while ( covered < length )
+    {
+    const SizeValueType step = covered < length - covered ? covered : length - covered;
+    ShiftOr(line, line, numberOfWords, step);
+    covered += step;
+    }
+}
+
+/** Index of the lowest bit set in a non zero word. */
+inline unsigned int CountTrailingZeros(WordType word)
+{
+#if defined( __GNUC__ )
+  return __builtin_ctzll(word);
+#else
+  // de Bruijn multiplication of the isolated lowest bit
+  static const unsigned int table[64] = {
+    0,  1, 48,  2, 57, 49, 28,  3,
+    61, 58, 50, 42, 38, 29, 17,  4,
+    62, 55, 59, 36, 53, 51, 43, 22,
+    45, 39, 33, 30, 24, 18, 12,  5,
+    63, 47, 56, 27, 60, 41, 37, 16,
+    54, 35, 52, 21, 44, 32, 23, 11,
+    46, 26, 40, 15, 34, 20, 31, 10,
+    25, 14, 19,  9, 13,  8,  7,  6
+    };
+  const WordType deBruijn = ( static_cast< WordType >( 0x03f79d71 ) << 32 ) | 0xb4cb0a89;
+  return table[( ( word & ( ~word + 1 ) ) * deBruijn ) >> 58];
+#endif
+}
+} // end namespace PackedBinaryLine
+} // end namespace itk
+
+#endif
@@ -0,0 +1,122 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryLogicImageFilter_h
+#define itkPackedBinaryLogicImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkPackedBinaryImage.h"
+#include "itkImageRegionSplitterDirection.h"
+
+namespace itk
+{
+/** \class PackedBinaryLogicImageFilter
+ * \brief Pixel-wise logical operations on PackedBinaryImages.
+ *
+ * Computes Input1 AND Input2, Input1 OR Input2, Input1 XOR Input2 or
+ * NOT Input1, 64 pixels at a time. The two inputs must have the same
+ * largest possible region. The second input is not used by the NOT
+ * operation.
+ *
+ * The whole image is always processed.
+ *
+ * \sa AndImageFilter, OrImageFilter, XorImageFilter, NotImageFilter
+ * \ingroup ITKBinaryMathematicalMorphology
+ */
+template< typename TImage >
+class PackedBinaryLogicImageFilter:
+  public ImageToImageFilter< TImage, TImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef PackedBinaryLogicImageFilter         Self;
+  typedef ImageToImageFilter< TImage, TImage > Superclass;
+  typedef SmartPointer< Self >                 Pointer;
+  typedef SmartPointer< const Self >           ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PackedBinaryLogicImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TImage::ImageDimension);
+
+  typedef TImage                         ImageType;
+  typedef typename ImageType::RegionType RegionType;
+  typedef typename ImageType::IndexType  IndexType;
+  typedef typename ImageType::WordType   WordType;
+
+  /** The available operations. */
+  enum OperationType {
+    AND = 0,
+    OR = 1,
+    XOR = 2,
+    NOT = 3
+    };
+
+  /** Set/Get the operation. Defaults to AND. */
+  itkSetMacro(Operation, OperationType);
+  itkGetConstMacro(Operation, OperationType);
+
+  /** Set the first operand. */
+  void SetInput1(const ImageType *image)
+  {
+    this->SetInput(0, image);
+  }
+
+  /** Set the second operand. */
+  void SetInput2(const ImageType *image)
+  {
+    this->SetInput(1, image);
+  }
+
+protected:
+  PackedBinaryLogicImageFilter();
+  virtual ~PackedBinaryLogicImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** The whole inputs are required. */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  /** The whole output is produced. */
+  void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ) ITK_OVERRIDE;
+
+  /** Check the second input. */
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  void ThreadedGenerateData(const RegionType & outputRegionForThread,
+                            ThreadIdType threadId) ITK_OVERRIDE;
+
+  /** The lines are never split between the threads. */
+  virtual const ImageRegionSplitterBase * GetImageRegionSplitter() const ITK_OVERRIDE;
+
+private:
+  PackedBinaryLogicImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);               //purposely not implemented
+
+  OperationType m_Operation;
+
+  ImageRegionSplitterDirection::Pointer m_ImageRegionSplitter;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkPackedBinaryLogicImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,169 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryLogicImageFilter_hxx
+#define itkPackedBinaryLogicImageFilter_hxx
+
+#include "itkPackedBinaryLogicImageFilter.h"
+#include "itkProgressReporter.h"
+
+namespace itk
+{
+template< typename TImage >
+PackedBinaryLogicImageFilter< TImage >
+::PackedBinaryLogicImageFilter()
+{
+  m_Operation = AND;
+  m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
+  m_ImageRegionSplitter->SetDirection(0);
+}
+
+template< typename TImage >
+void
+PackedBinaryLogicImageFilter< TImage >
+::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  for ( unsigned int i = 0; i < 2; i++ )
+    {
+    ImageType *input = const_cast< ImageType * >( this->GetInput(i) );
+    if ( input )
+      {
+      input->SetRequestedRegion( input->GetLargestPossibleRegion() );
+      }
+    }
+}
+
+template< typename TImage >
+void
+PackedBinaryLogicImageFilter< TImage >
+::EnlargeOutputRequestedRegion(DataObject *)
+{
+  ImageType *output = this->GetOutput();
+  output->SetRequestedRegion( output->GetLargestPossibleRegion() );
+}
+
+template< typename TImage >
+const ImageRegionSplitterBase *
+PackedBinaryLogicImageFilter< TImage >
+::GetImageRegionSplitter() const
+{
+  return m_ImageRegionSplitter.GetPointer();
+}
+
+template< typename TImage >
+void
+PackedBinaryLogicImageFilter< TImage >
+::BeforeThreadedGenerateData()
+{
+  if ( m_Operation == NOT )
+    {
+    return;
+    }
+  const ImageType *input2 = this->GetInput(1);
+  if ( !input2 )
+    {
+    itkExceptionMacro(<< "Input2 is required by the operation " << m_Operation);
+    }
+  if ( input2->GetBufferedRegion() != this->GetOutput()->GetBufferedRegion() )
+    {
+    itkExceptionMacro(<< "Input1 and Input2 must have the same largest possible region: "
+                      << this->GetInput(0)->GetLargestPossibleRegion() << " and "
+                      << input2->GetLargestPossibleRegion());
+    }
+}
+
+template< typename TImage >
+void
+PackedBinaryLogicImageFilter< TImage >
+::ThreadedGenerateData(const RegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  ImageType *output = this->GetOutput();
+
+  const SizeValueType numberOfWords = output->GetNumberOfWordsPerLine();
+  const SizeValueType numberOfLines = outputRegionForThread.GetNumberOfPixels()
+                                      / outputRegionForThread.GetSize()[0];
+
+  ProgressReporter progress(this, threadId, 1);
+
+  // the whole lines are processed and only the outermost dimension is
+  // split, so the lines of the thread are contiguous in the buffers
+  const OffsetValueType offset = output->ComputeLineOffset( outputRegionForThread.GetIndex() );
+  const SizeValueType   size = numberOfLines * numberOfWords;
+  const WordType *      in1 = this->GetInput(0)->GetBufferPointer() + offset;
+  WordType *            out = output->GetBufferPointer() + offset;
+  const WordType *      in2 = ITK_NULLPTR;
+  if ( m_Operation != NOT )
+    {
+    in2 = this->GetInput(1)->GetBufferPointer() + offset;
+    }
+
+  switch ( m_Operation )
+    {
+    case AND:
+      for ( SizeValueType w = 0; w < size; w++ )
+        {
+        out[w] = in1[w] & in2[w];
+        }
+      break;
+    case OR:
+      for ( SizeValueType w = 0; w < size; w++ )
+        {
+        out[w] = in1[w] | in2[w];
+        }
+      break;
+    case XOR:
+      for ( SizeValueType w = 0; w < size; w++ )
+        {
+        out[w] = in1[w] ^ in2[w];
+        }
+      break;
+    case NOT:
+      {
+      const WordType lastWordMask = output->GetLastWordMask();
+      for ( SizeValueType l = 0; l < numberOfLines; l++ )
+        {
+        for ( SizeValueType w = 0; w < numberOfWords; w++ )
+          {
+          out[w] = ~in1[w];
+          }
+        // keep the padding bits to 0
+        out[numberOfWords - 1] &= lastWordMask;
+        in1 += numberOfWords;
+        out += numberOfWords;
+        }
+      break;
+      }
+    }
+  progress.CompletedPixel();
+}
+
+template< typename TImage >
+void
+PackedBinaryLogicImageFilter< TImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Operation: " << m_Operation << std::endl;
+}
+} // end namespace itk
+
+#endif
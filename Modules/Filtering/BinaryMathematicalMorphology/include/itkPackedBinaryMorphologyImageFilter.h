@@ -0,0 +1,135 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryMorphologyImageFilter_h
+#define itkPackedBinaryMorphologyImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkPackedBinaryImage.h"
+#include "itkFlatStructuringElement.h"
+#include "itkImageRegionSplitterDirection.h"
+
+#include <vector>
+
+namespace itk
+{
+/** \class PackedBinaryMorphologyImageFilter
+ * \brief Base class for the dilation and the erosion of a PackedBinaryImage.
+ *
+ * The structuring element is decomposed in runs of consecutive offsets
+ * along the first dimension, grouped by their offset in the other
+ * dimensions. The dilation of an output line is then the union of the
+ * neighbor input lines, each one dilated by its runs. A run of length n
+ * is applied to a whole line with O(log(n)) shifts and ors of 64 pixels
+ * words, so the cost of the filter is almost independent of the content
+ * of the image and of the size of the structuring element along the first
+ * dimension.
+ *
+ * The erosion is computed as the complement of the dilation of the
+ * complement of the input, with the pixels outside the image considered as
+ * foreground, like the default behavior of BinaryErodeImageFilter.
+ *
+ * The whole image is always processed.
+ *
+ * \sa PackedBinaryDilateImageFilter, PackedBinaryErodeImageFilter
+ * \ingroup ITKBinaryMathematicalMorphology
+ */
+template< typename TImage, typename TKernel = FlatStructuringElement< TImage::ImageDimension > >
+class PackedBinaryMorphologyImageFilter:
+  public ImageToImageFilter< TImage, TImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef PackedBinaryMorphologyImageFilter    Self;
+  typedef ImageToImageFilter< TImage, TImage > Superclass;
+  typedef SmartPointer< Self >                 Pointer;
+  typedef SmartPointer< const Self >           ConstPointer;
+
+  /** Runtime information support. */
+  itkTypeMacro(PackedBinaryMorphologyImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TImage::ImageDimension);
+
+  typedef TImage                         ImageType;
+  typedef typename ImageType::RegionType RegionType;
+  typedef typename ImageType::IndexType  IndexType;
+  typedef typename ImageType::OffsetType OffsetType;
+  typedef typename ImageType::WordType   WordType;
+  typedef TKernel                        KernelType;
+  typedef typename KernelType::PixelType KernelPixelType;
+
+  /** Set/Get the structuring element. */
+  itkSetMacro(Kernel, KernelType);
+  itkGetConstReferenceMacro(Kernel, KernelType);
+
+protected:
+  PackedBinaryMorphologyImageFilter();
+  virtual ~PackedBinaryMorphologyImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** The whole input is required. */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  /** The whole output is produced. */
+  void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ) ITK_OVERRIDE;
+
+  /** Decompose the structuring element in runs. */
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  void ThreadedGenerateData(const RegionType & outputRegionForThread,
+                            ThreadIdType threadId) ITK_OVERRIDE;
+
+  /** The lines are never split between the threads. */
+  virtual const ImageRegionSplitterBase * GetImageRegionSplitter() const ITK_OVERRIDE;
+
+  /** Set by the subclasses: compute an erosion instead of a dilation. */
+  bool m_Erosion;
+
+private:
+  PackedBinaryMorphologyImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                    //purposely not implemented
+
+  /** A run of length Length starting at the offset Start along the first
+   * dimension. */
+  struct RunType
+  {
+    OffsetValueType Start;
+    SizeValueType   Length;
+  };
+
+  /** The runs of the structuring element having the same offset in the
+   * dimensions other than the first one. */
+  struct RowType
+  {
+    OffsetType             Offset;
+    std::vector< RunType > Runs;
+  };
+
+  KernelType m_Kernel;
+
+  std::vector< RowType > m_Rows;
+  SizeValueType          m_MarginWords;
+
+  ImageRegionSplitterDirection::Pointer m_ImageRegionSplitter;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkPackedBinaryMorphologyImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,235 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPackedBinaryMorphologyImageFilter_hxx
+#define itkPackedBinaryMorphologyImageFilter_hxx
+
+#include "itkPackedBinaryMorphologyImageFilter.h"
+#include "itkPackedBinaryLineUtilities.h"
+#include "itkProgressReporter.h"
+
+#include <map>
+#include <algorithm>
+
+namespace itk
+{
+template< typename TImage, typename TKernel >
+PackedBinaryMorphologyImageFilter< TImage, TKernel >
+::PackedBinaryMorphologyImageFilter()
+{
+  m_Erosion = false;
+  m_MarginWords = 0;
+  m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
+  m_ImageRegionSplitter->SetDirection(0);
+
+  typename KernelType::SizeType radius;
+  radius.Fill(1);
+  m_Kernel = KernelType::Box(radius);
+}
+
+template< typename TImage, typename TKernel >
+void
+PackedBinaryMorphologyImageFilter< TImage, TKernel >
+::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  ImageType *input = const_cast< ImageType * >( this->GetInput() );
+  if ( input )
+    {
+    input->SetRequestedRegion( input->GetLargestPossibleRegion() );
+    }
+}
+
+template< typename TImage, typename TKernel >
+void
+PackedBinaryMorphologyImageFilter< TImage, TKernel >
+::EnlargeOutputRequestedRegion(DataObject *)
+{
+  ImageType *output = this->GetOutput();
+  output->SetRequestedRegion( output->GetLargestPossibleRegion() );
+}
+
+template< typename TImage, typename TKernel >
+const ImageRegionSplitterBase *
+PackedBinaryMorphologyImageFilter< TImage, TKernel >
+::GetImageRegionSplitter() const
+{
+  return m_ImageRegionSplitter.GetPointer();
+}
+
+template< typename TImage, typename TKernel >
+void
+PackedBinaryMorphologyImageFilter< TImage, TKernel >
+::BeforeThreadedGenerateData()
+{
+  // group the offsets of the structuring element by line
+  typedef std::map< OffsetType, std::vector< OffsetValueType >,
+                    typename OffsetType::LexicographicCompare > OffsetMapType;
+  OffsetMapType   lines;
+  OffsetValueType maximumShift = 0;
+  for ( unsigned int i = 0; i < m_Kernel.Size(); i++ )
+    {
+    if ( m_Kernel[i] > NumericTraits< KernelPixelType >::ZeroValue() )
+      {
+      OffsetType offset = m_Kernel.GetOffset(i);
+      const OffsetValueType shift = offset[0];
+      offset[0] = 0;
+      lines[offset].push_back(shift);
+      maximumShift = std::max( maximumShift, shift < 0 ? -shift : shift );
+      }
+    }
+
+  // and merge the consecutive offsets of a line in runs
+  m_Rows.clear();
+  for ( typename OffsetMapType::iterator it = lines.begin(); it != lines.end(); ++it )
+    {
+    std::vector< OffsetValueType > & shifts = it->second;
+    std::sort( shifts.begin(), shifts.end() );
+    RowType row;
+    row.Offset = it->first;
+    for ( SizeValueType i = 0; i < shifts.size(); i++ )
+      {
+      if ( !row.Runs.empty() && row.Runs.back().Start
+           + static_cast< OffsetValueType >( row.Runs.back().Length ) == shifts[i] )
+        {
+        row.Runs.back().Length++;
+        }
+      else
+        {
+        RunType run;
+        run.Start = shifts[i];
+        run.Length = 1;
+        row.Runs.push_back(run);
+        }
+      }
+    m_Rows.push_back(row);
+    }
+
+  // the lines are processed with enough zeros on both sides to keep all
+  // the pixels moved out of the line and back by a run and its shift
+  m_MarginWords = ( 3 * maximumShift + 1 ) / ImageType::WordSize + 1;
+}
+
+template< typename TImage, typename TKernel >
+void
+PackedBinaryMorphologyImageFilter< TImage, TKernel >
+::ThreadedGenerateData(const RegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  const ImageType *input = this->GetInput();
+  ImageType *      output = this->GetOutput();
+
+  const RegionType &  inputRegion = input->GetBufferedRegion();
+  const SizeValueType numberOfWords = output->GetNumberOfWordsPerLine();
+  const WordType      lastWordMask = output->GetLastWordMask();
+  const SizeValueType paddedWords = numberOfWords + 2 * m_MarginWords;
+  const SizeValueType numberOfLines = outputRegionForThread.GetNumberOfPixels()
+                                      / outputRegionForThread.GetSize()[0];
+
+  std::vector< WordType > inputLine(paddedWords, 0);
+  std::vector< WordType > runLine(paddedWords);
+  std::vector< WordType > outputLine(paddedWords);
+  WordType *              inputWords = &inputLine[m_MarginWords];
+  WordType *              outputWords = &outputLine[m_MarginWords];
+
+  ProgressReporter progress(this, threadId, numberOfLines);
+
+  IndexType index = outputRegionForThread.GetIndex();
+  for ( SizeValueType l = 0; l < numberOfLines; l++ )
+    {
+    std::fill( outputLine.begin(), outputLine.end(), static_cast< WordType >( 0 ) );
+
+    for ( typename std::vector< RowType >::const_iterator row = m_Rows.begin(); row != m_Rows.end(); ++row )
+      {
+      const IndexType inputIndex = index - row->Offset;
+      if ( !inputRegion.IsInside(inputIndex) )
+        {
+        // the lines outside of the image don't contribute: they are
+        // background for the dilation, and foreground for the erosion
+        continue;
+        }
+      const WordType *line = input->GetLineBufferPointer(inputIndex);
+      if ( m_Erosion )
+        {
+        for ( SizeValueType w = 0; w < numberOfWords; w++ )
+          {
+          inputWords[w] = ~line[w];
+          }
+        inputWords[numberOfWords - 1] &= lastWordMask;
+        }
+      else
+        {
+        std::copy( line, line + numberOfWords, inputWords );
+        }
+
+      for ( typename std::vector< RunType >::const_iterator run = row->Runs.begin(); run != row->Runs.end(); ++run )
+        {
+        if ( run->Length == 1 )
+          {
+          PackedBinaryLine::ShiftOr(&inputLine[0], &outputLine[0], paddedWords, run->Start);
+          }
+        else
+          {
+          std::copy( inputLine.begin(), inputLine.end(), runLine.begin() );
+          PackedBinaryLine::RunDilate(&runLine[0], paddedWords, run->Length);
+          PackedBinaryLine::ShiftOr(&runLine[0], &outputLine[0], paddedWords, run->Start);
+          }
+        }
+      }
+
+    WordType *outputBuffer = output->GetLineBufferPointer(index);
+    if ( m_Erosion )
+      {
+      for ( SizeValueType w = 0; w < numberOfWords; w++ )
+        {
+        outputBuffer[w] = ~outputWords[w];
+        }
+      }
+    else
+      {
+      std::copy( outputWords, outputWords + numberOfWords, outputBuffer );
+      }
+    outputBuffer[numberOfWords - 1] &= lastWordMask;
+
+    // next line
+    for ( unsigned int i = 1; i < ImageDimension; i++ )
+      {
+      if ( ++index[i] < outputRegionForThread.GetIndex()[i]
+           + static_cast< OffsetValueType >( outputRegionForThread.GetSize()[i] ) )
+        {
+        break;
+        }
+      index[i] = outputRegionForThread.GetIndex()[i];
+      }
+    progress.CompletedPixel();
+    }
+}
+
+template< typename TImage, typename TKernel >
+void
+PackedBinaryMorphologyImageFilter< TImage, TKernel >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Kernel: " << m_Kernel << std::endl;
+}
+} // end namespace itk
+
+#endif
@@ -9,6 +9,7 @@ itk_module(ITKBinaryMathematicalMorphology
     ITKMathematicalMorphology
   TEST_DEPENDS
     ITKTestKernel
+    ITKConnectedComponents
   DESCRIPTION
     "${DOCUMENTATION}"
 )
@@ -0,0 +1,251 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageToPackedBinaryImageFilter.h"
+#include "itkPackedBinaryImageToImageFilter.h"
+#include "itkPackedBinaryDilateImageFilter.h"
+#include "itkPackedBinaryErodeImageFilter.h"
+#include "itkPackedBinaryLogicImageFilter.h"
+#include "itkPackedBinaryConnectedComponentImageFilter.h"
+#include "itkBinaryDilateImageFilter.h"
+#include "itkBinaryErodeImageFilter.h"
+#include "itkConnectedComponentImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+// Compare the filters working on packed binary images to the equivalent
+// filters working on regular images.
+
+template< typename TImage >
+static bool
+PackedBinaryImageFiltersCompare(const TImage *expected, const TImage *result, const char *name)
+{
+  itk::ImageRegionConstIterator< TImage > eit( expected, expected->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< TImage > rit( result, result->GetLargestPossibleRegion() );
+  for ( ; !eit.IsAtEnd(); ++eit, ++rit )
+    {
+    if ( eit.Get() != rit.Get() )
+      {
+      std::cerr << name << ": wrong value at " << eit.GetIndex() << ": expected "
+                << static_cast< int >( eit.Get() ) << ", got " << static_cast< int >( rit.Get() ) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< unsigned int VDimension >
+static int
+PackedBinaryImageFiltersCheck(const typename itk::Image< unsigned char, VDimension >::SizeType & size,
+                              unsigned int numberOfThreads)
+{
+  typedef itk::Image< unsigned char, VDimension >   ImageType;
+  typedef itk::Image< unsigned int, VDimension >    LabelImageType;
+  typedef itk::PackedBinaryImage< VDimension >      PackedImageType;
+  typedef itk::FlatStructuringElement< VDimension > KernelType;
+
+  // two random images, with clusters of foreground pixels
+  typename ImageType::Pointer images[2];
+  unsigned int                seed = 12345;
+  for ( unsigned int i = 0; i < 2; i++ )
+    {
+    images[i] = ImageType::New();
+    images[i]->SetRegions( size );
+    images[i]->Allocate();
+    itk::ImageRegionIterator< ImageType > it( images[i], images[i]->GetLargestPossibleRegion() );
+    unsigned char previous = 0;
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      seed = seed * 1103515245 + 12345;
+      const unsigned int random = ( seed >> 16 ) % 100;
+      previous = previous ? random < 70 : random < 20;
+      it.Set( previous );
+      }
+    }
+
+  typedef itk::ImageToPackedBinaryImageFilter< ImageType > ToPackedType;
+  typedef itk::PackedBinaryImageToImageFilter< ImageType > FromPackedType;
+
+  typename ToPackedType::Pointer toPacked[2];
+  for ( unsigned int i = 0; i < 2; i++ )
+    {
+    toPacked[i] = ToPackedType::New();
+    toPacked[i]->SetInput( images[i] );
+    toPacked[i]->SetForegroundValue( 1 );
+    toPacked[i]->SetNumberOfThreads( numberOfThreads );
+    toPacked[i]->Update();
+    }
+
+  typename FromPackedType::Pointer fromPacked = FromPackedType::New();
+  fromPacked->SetForegroundValue( 1 );
+  fromPacked->SetNumberOfThreads( numberOfThreads );
+  fromPacked->SetInput( toPacked[0]->GetOutput() );
+  fromPacked->Update();
+  if ( !PackedBinaryImageFiltersCompare< ImageType >( images[0], fromPacked->GetOutput(), "Conversion" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // a box, a ball and an asymmetric kernel
+  typename KernelType::SizeType radius;
+  for ( unsigned int d = 0; d < VDimension; d++ )
+    {
+    radius[d] = d == 0 ? 3 : 1;
+    }
+  KernelType kernels[3];
+  kernels[0] = KernelType::Box( radius );
+  kernels[1] = KernelType::Ball( radius );
+  kernels[2] = KernelType::Box( radius );
+  for ( unsigned int i = 0; i < kernels[2].Size(); i += 3 )
+    {
+    kernels[2][i] = false;
+    }
+
+  for ( unsigned int k = 0; k < 3; k++ )
+    {
+    typedef itk::BinaryDilateImageFilter< ImageType, ImageType, KernelType > DilateType;
+    typename DilateType::Pointer dilate = DilateType::New();
+    dilate->SetInput( images[0] );
+    dilate->SetKernel( kernels[k] );
+    dilate->SetForegroundValue( 1 );
+    dilate->Update();
+
+    typedef itk::PackedBinaryDilateImageFilter< PackedImageType > PackedDilateType;
+    typename PackedDilateType::Pointer packedDilate = PackedDilateType::New();
+    packedDilate->SetInput( toPacked[0]->GetOutput() );
+    packedDilate->SetKernel( kernels[k] );
+    packedDilate->SetNumberOfThreads( numberOfThreads );
+    fromPacked->SetInput( packedDilate->GetOutput() );
+    fromPacked->Update();
+    if ( !PackedBinaryImageFiltersCompare< ImageType >( dilate->GetOutput(), fromPacked->GetOutput(), "Dilate" ) )
+      {
+      return EXIT_FAILURE;
+      }
+
+    typedef itk::BinaryErodeImageFilter< ImageType, ImageType, KernelType > ErodeType;
+    typename ErodeType::Pointer erode = ErodeType::New();
+    erode->SetInput( images[0] );
+    erode->SetKernel( kernels[k] );
+    erode->SetForegroundValue( 1 );
+    erode->Update();
+
+    typedef itk::PackedBinaryErodeImageFilter< PackedImageType > PackedErodeType;
+    typename PackedErodeType::Pointer packedErode = PackedErodeType::New();
+    packedErode->SetInput( toPacked[0]->GetOutput() );
+    packedErode->SetKernel( kernels[k] );
+    packedErode->SetNumberOfThreads( numberOfThreads );
+    fromPacked->SetInput( packedErode->GetOutput() );
+    fromPacked->Update();
+    if ( !PackedBinaryImageFiltersCompare< ImageType >( erode->GetOutput(), fromPacked->GetOutput(), "Erode" ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // logical operations
+  typedef itk::PackedBinaryLogicImageFilter< PackedImageType > LogicType;
+  typename LogicType::Pointer logic = LogicType::New();
+  logic->SetInput1( toPacked[0]->GetOutput() );
+  logic->SetInput2( toPacked[1]->GetOutput() );
+  logic->SetNumberOfThreads( numberOfThreads );
+  fromPacked->SetInput( logic->GetOutput() );
+  const char *operationNames[4] = { "And", "Or", "Xor", "Not" };
+  for ( unsigned int op = 0; op < 4; op++ )
+    {
+    logic->SetOperation( static_cast< typename LogicType::OperationType >( op ) );
+    fromPacked->Update();
+
+    typename ImageType::Pointer expected = ImageType::New();
+    expected->SetRegions( size );
+    expected->Allocate();
+    itk::ImageRegionIterator< ImageType >      eit( expected, expected->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< ImageType > it0( images[0], images[0]->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< ImageType > it1( images[1], images[1]->GetLargestPossibleRegion() );
+    for ( ; !eit.IsAtEnd(); ++eit, ++it0, ++it1 )
+      {
+      const bool a = it0.Get() != 0;
+      const bool b = it1.Get() != 0;
+      const bool values[4] = { a && b, a || b, a != b, !a };
+      eit.Set( values[op] );
+      }
+    if ( !PackedBinaryImageFiltersCompare< ImageType >( expected, fromPacked->GetOutput(), operationNames[op] ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // connected components
+  for ( unsigned int fullyConnected = 0; fullyConnected < 2; fullyConnected++ )
+    {
+    typedef itk::ConnectedComponentImageFilter< ImageType, LabelImageType > ConnectedComponentType;
+    typename ConnectedComponentType::Pointer connected = ConnectedComponentType::New();
+    connected->SetInput( images[0] );
+    connected->SetFullyConnected( fullyConnected );
+    connected->Update();
+
+    typedef itk::PackedBinaryConnectedComponentImageFilter< PackedImageType, LabelImageType >
+      PackedConnectedComponentType;
+    typename PackedConnectedComponentType::Pointer packedConnected = PackedConnectedComponentType::New();
+    packedConnected->SetInput( toPacked[0]->GetOutput() );
+    packedConnected->SetFullyConnected( fullyConnected );
+    packedConnected->Update();
+
+    if ( packedConnected->GetObjectCount() != connected->GetObjectCount() )
+      {
+      std::cerr << "Wrong number of objects: expected " << connected->GetObjectCount()
+                << ", got " << packedConnected->GetObjectCount() << std::endl;
+      return EXIT_FAILURE;
+      }
+    if ( !PackedBinaryImageFiltersCompare< LabelImageType >( connected->GetOutput(), packedConnected->GetOutput(),
+                                                            "ConnectedComponent" ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+int itkPackedBinaryImageFiltersTest(int, char* [] )
+{
+  int status = EXIT_SUCCESS;
+
+  itk::Size< 2 > size2 = { { 150, 37 } };
+  itk::Size< 3 > size3 = { { 64, 11, 9 } };
+  itk::Size< 3 > size3b = { { 71, 5, 4 } };
+  for ( unsigned int threads = 1; threads <= 3; threads += 2 )
+    {
+    status |= PackedBinaryImageFiltersCheck< 2 >( size2, threads );
+    status |= PackedBinaryImageFiltersCheck< 3 >( size3, threads );
+    status |= PackedBinaryImageFiltersCheck< 3 >( size3b, threads );
+    }
+
+  // lines of no pixel hold no word to fill
+  itk::PackedBinaryImage< 2 >::Pointer emptyLines = itk::PackedBinaryImage< 2 >::New();
+  itk::Size< 2 > emptyLinesSize = { { 0, 5 } };
+  emptyLines->SetRegions( emptyLinesSize );
+  emptyLines->Allocate();
+  emptyLines->FillBuffer( true );
+  emptyLines->FillBuffer( false );
+
+  if ( status == EXIT_SUCCESS )
+    {
+    std::cout << "Test passed." << std::endl;
+    }
+  return status;
+}
@@ -20,9 +20,9 @@
 
 #include "itkInvertDisplacementFieldImageFilter.h"
 
-#include "itkComposeDisplacementFieldsImageFilter.h"
 #include "itkImageDuplicator.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
 #include "itkMutexLockHolder.h"
 
 namespace itk
@@ -108,6 +108,14 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     this->m_DisplacementFieldSpacing[d] = displacementField->GetSpacing()[d];
     }
 
+  this->m_Interpolator->SetInputImage( displacementField );
+
+  // The composed field is allocated once, and overwritten at each iteration.
+  this->m_ComposedField = DisplacementFieldType::New();
+  this->m_ComposedField->CopyInformation( inverseDisplacementField );
+  this->m_ComposedField->SetRegions( inverseDisplacementField->GetRequestedRegion() );
+  this->m_ComposedField->Allocate();
+
   this->m_ScaledNormImage->CopyInformation( displacementField );
   this->m_ScaledNormImage->SetRegions( displacementField->GetRequestedRegion() );
   this->m_ScaledNormImage->Allocate(true); // initialize
@@ -126,17 +134,10 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     itkDebugMacro( "Iteration " << iteration << ": mean error norm = " << this->m_MeanErrorNorm
       << ", max error norm = " << this->m_MaxErrorNorm );
 
-    typedef ComposeDisplacementFieldsImageFilter<DisplacementFieldType> ComposerType;
-    typename ComposerType::Pointer composer = ComposerType::New();
-    composer->SetDisplacementField( displacementField );
-    composer->SetWarpingField( inverseDisplacementField );
-
-    this->m_ComposedField = composer->GetOutput();
-    this->m_ComposedField->Update();
-    this->m_ComposedField->DisconnectPipeline();
-
     /**
-     * Multithread processing to multiply each element of the composed field by 1 / spacing
+     * Multithread processing to compose the displacement field with the
+     * inverse field, and to compute the norm of each element of the composed
+     * field multiplied by 1 / spacing
      */
     this->m_MeanErrorNorm = NumericTraits<RealType>::ZeroValue();
     this->m_MaxErrorNorm = NumericTraits<RealType>::ZeroValue();
@@ -183,7 +184,7 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
 
   if( this->m_DoThreadedEstimateInverse )
     {
-    ImageRegionIterator<DisplacementFieldType> ItI( this->GetOutput(), region );
+    ImageRegionIteratorWithIndex<DisplacementFieldType> ItI( this->GetOutput(), region );
 
     for( ItI.GoToBegin(), ItE.GoToBegin(), ItS.GoToBegin(); !ItI.IsAtEnd(); ++ItI, ++ItE, ++ItS )
       {
@@ -212,6 +213,9 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     }
   else
     {
+    const InverseDisplacementFieldType * inverseField = this->GetOutput();
+    ImageRegionConstIteratorWithIndex<InverseDisplacementFieldType> ItW( inverseField, region );
+
     VectorType inverseSpacing;
     RealType localMean = NumericTraits<RealType>::ZeroValue();
     RealType localMax  = NumericTraits<RealType>::ZeroValue();
@@ -219,9 +223,37 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
       {
       inverseSpacing[d]=1.0/this->m_DisplacementFieldSpacing[d];
       }
-    for( ItE.GoToBegin(), ItS.GoToBegin(); !ItE.IsAtEnd(); ++ItE, ++ItS )
+
+    PointType pointIn1;
+    PointType pointIn2;
+    PointType pointIn3;
+
+    for( ItW.GoToBegin(), ItE.GoToBegin(), ItS.GoToBegin(); !ItW.IsAtEnd(); ++ItW, ++ItE, ++ItS )
       {
-      const VectorType & displacement = ItE.Get();
+      // Compose the displacement field with the inverse field estimate, as
+      // ComposeDisplacementFieldsImageFilter does.
+      inverseField->TransformIndexToPhysicalPoint( ItW.GetIndex(), pointIn1 );
+
+      const VectorType & warpVector = ItW.Get();
+      for( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        pointIn2[d] = pointIn1[d] + warpVector[d];
+        }
+
+      typename InterpolatorType::OutputType interpolatedDisplacement( 0.0 );
+      if( this->m_Interpolator->IsInsideBuffer( pointIn2 ) )
+        {
+        interpolatedDisplacement = this->m_Interpolator->Evaluate( pointIn2 );
+        }
+
+      for( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        pointIn3[d] = pointIn2[d] + interpolatedDisplacement[d];
+        }
+
+      VectorType displacement;
+      displacement = pointIn3 - pointIn1;
+
       RealType scaledNorm = 0.0;
       for( unsigned int d = 0; d < ImageDimension; ++d )
         {
@@ -52,6 +52,11 @@ namespace itk
  * Danielsson, Per-Erik.  Euclidean Distance Mapping.  Computer
  * Graphics and Image Processing 14, 227-248 (1980).
  *
+ * MaurerDistanceMapImageFilter computes the exact distance map and the
+ * Voronoi partition with less memory, using several threads.
+ *
+ * \sa MaurerDistanceMapImageFilter
+ *
  * \ingroup ImageFeatureExtraction
  * \ingroup ITKDistanceMap
  */
@@ -0,0 +1,198 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMaurerDistanceMapImageFilter_h
+#define itkMaurerDistanceMapImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkImageRegionSplitterDirection.h"
+
+namespace itk
+{
+/** \class MaurerDistanceMapImageFilter
+ *
+ * \tparam TInputImage Input Image Type
+ * \tparam TOutputImage Output Image Type
+ * \tparam TVoronoiImage Voronoi Image Type. Note the default value is TInputImage.
+ *
+ * \brief This filter computes the exact Euclidean distance map of the
+ * input image, and its Voronoi partition, in linear time.
+ *
+ * The input is assumed to contain numeric codes defining objects, like the
+ * input of DanielssonDistanceMapImageFilter. The filter produces:
+ *
+ * \li A <b>distance map</b> with the Euclidean distance from each pixel to
+ *   the closest object pixel, zero on the objects. The squared distance can
+ *   be computed instead with SquaredDistanceOn().
+ * \li A <b>Voronoi partition</b> using the same numeric codes as the input,
+ *   which gives for each pixel the code of the closest object.
+ *
+ * The squared distance is computed one dimension at a time, each line of
+ * the image being replaced by the lower envelope of the parabolas centered
+ * on its pixels, as described in:
+ *
+ * C. R. Maurer, Jr., R. Qi, and V. Raghavan, "A Linear Time Algorithm
+ * for Computing Exact Euclidean Distance Transforms of Binary Images in
+ * Arbitrary Dimensions", IEEE - Transactions on Pattern Analysis and
+ * Machine Intelligence, 25(2): 265-270, 2003.
+ *
+ * The code of the closest object is carried with each parabola, so the
+ * Voronoi partition is computed with the distance, without the vector
+ * image of DanielssonDistanceMapImageFilter. The lines are independent, and
+ * all the passes are split between the threads.
+ *
+ * Unlike DanielssonDistanceMapImageFilter, the distances are exact, and the
+ * vector map is not available. The pixels of the Voronoi map equidistant
+ * to several objects get the code of one of them.
+ *
+ * \sa DanielssonDistanceMapImageFilter, SignedMaurerDistanceMapImageFilter
+ *
+ * \ingroup ImageFeatureExtraction
+ * \ingroup ITKDistanceMap
+ */
+template< typename TInputImage,
+  typename TOutputImage,
+  typename TVoronoiImage = TInputImage >
+class MaurerDistanceMapImageFilter:
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MaurerDistanceMapImageFilter                    Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                            Pointer;
+  typedef SmartPointer< const Self >                      ConstPointer;
+
+  typedef DataObject::Pointer DataObjectPointer;
+
+  /** Method for creation through the object factory */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MaurerDistanceMapImageFilter, ImageToImageFilter);
+
+  /** The dimension of the input and output images. */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+
+  /** Image typedef support. */
+  typedef TInputImage                              InputImageType;
+  typedef typename InputImageType::PixelType       InputPixelType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename OutputImageType::PixelType      OutputPixelType;
+  typedef typename OutputImageType::RegionType     OutputImageRegionType;
+  typedef typename OutputImageType::IndexType      IndexType;
+  typedef typename OutputImageType::SpacingType    SpacingType;
+  typedef TVoronoiImage                            VoronoiImageType;
+  typedef typename VoronoiImageType::PixelType     VoronoiPixelType;
+
+  /** The image used to store the squared distances between the passes. */
+  typedef Image< double, itkGetStaticConstMacro(ImageDimension) > DistanceImageType;
+
+  /** Set if the distance should be squared. */
+  itkSetMacro(SquaredDistance, bool);
+  itkGetConstReferenceMacro(SquaredDistance, bool);
+  itkBooleanMacro(SquaredDistance);
+
+  /** Set if the input is binary. If this variable is set, all the nonzero
+   * pixels of the input image are given the code 1 in the Voronoi
+   * partition. */
+  itkSetMacro(InputIsBinary, bool);
+  itkGetConstReferenceMacro(InputIsBinary, bool);
+  itkBooleanMacro(InputIsBinary);
+
+  /** Set if image spacing should be used in computing distances. */
+  itkSetMacro(UseImageSpacing, bool);
+  itkGetConstReferenceMacro(UseImageSpacing, bool);
+  itkBooleanMacro(UseImageSpacing);
+
+  /** Get the distance map. This is the first output of the filter. */
+  OutputImageType * GetDistanceMap();
+
+  /** Get the Voronoi map, which gives for each pixel the code of the
+   * closest object. */
+  VoronoiImageType * GetVoronoiMap();
+
+  /** Standard itk::ProcessObject subclass method. */
+  typedef ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
+  using Superclass::MakeOutput;
+  virtual DataObjectPointer MakeOutput( DataObjectPointerArraySizeType idx ) ITK_OVERRIDE;
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  itkStaticConstMacro(OutputImageDimension, unsigned int,
+                      TOutputImage::ImageDimension);
+  itkStaticConstMacro(VoronoiImageDimension, unsigned int,
+                      TVoronoiImage::ImageDimension);
+
+  // Begin concept checking
+  itkConceptMacro( InputOutputSameDimensionCheck,
+                   ( Concept::SameDimension< ImageDimension, OutputImageDimension > ) );
+  itkConceptMacro( InputVoronoiSameDimensionCheck,
+                   ( Concept::SameDimension< ImageDimension, VoronoiImageDimension > ) );
+  itkConceptMacro( DoubleConvertibleToOutputCheck,
+                   ( Concept::Convertible< double, OutputPixelType > ) );
+  // End concept checking
+#endif
+
+protected:
+  MaurerDistanceMapImageFilter();
+  virtual ~MaurerDistanceMapImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** The whole input is required. */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  /** The whole output is produced. */
+  void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ) ITK_OVERRIDE;
+
+  /** Run one threaded pass per dimension. */
+  void GenerateData() ITK_OVERRIDE;
+
+  /** Compute the lines of the current dimension in the region. */
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            ThreadIdType threadId) ITK_OVERRIDE;
+
+  /** The lines of the current dimension are never split between the
+   * threads. */
+  virtual const ImageRegionSplitterBase * GetImageRegionSplitter() const ITK_OVERRIDE;
+
+private:
+  MaurerDistanceMapImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);               //purposely not implemented
+
+  /** Return true if the parabola in the middle is hidden by the two
+   * others, on the whole line. */
+  static bool Remove(double d1, double d2, double df,
+                     double x1, double x2, double xf);
+
+  bool m_SquaredDistance;
+  bool m_InputIsBinary;
+  bool m_UseImageSpacing;
+
+  unsigned int m_CurrentDimension;
+
+  typename DistanceImageType::Pointer m_SquaredDistanceMap;
+
+  ImageRegionSplitterDirection::Pointer m_ImageRegionSplitter;
+}; // end of MaurerDistanceMapImageFilter class
+} //end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMaurerDistanceMapImageFilter.hxx"
+#endif
+
+#endif
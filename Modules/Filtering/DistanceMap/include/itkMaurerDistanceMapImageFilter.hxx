@@ -0,0 +1,314 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMaurerDistanceMapImageFilter_hxx
+#define itkMaurerDistanceMapImageFilter_hxx
+
+#include "itkMaurerDistanceMapImageFilter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <vector>
+
+namespace itk
+{
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::MaurerDistanceMapImageFilter()
+{
+  this->SetNumberOfRequiredOutputs(2);
+
+  // distance map
+  this->SetNthOutput( 0, this->MakeOutput( 0 ) );
+
+  // voronoi map
+  this->SetNthOutput( 1, this->MakeOutput( 1 ) );
+
+  m_SquaredDistance = false;
+  m_InputIsBinary = false;
+  m_UseImageSpacing = true;
+  m_CurrentDimension = 0;
+
+  m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+typename MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >::DataObjectPointer
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::MakeOutput(DataObjectPointerArraySizeType idx)
+{
+  if ( idx == 1 )
+    {
+    return VoronoiImageType::New().GetPointer();
+    }
+  return Superclass::MakeOutput(idx);
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+typename MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >::OutputImageType *
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::GetDistanceMap()
+{
+  return dynamic_cast< OutputImageType * >( this->ProcessObject::GetOutput(0) );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+typename MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >::VoronoiImageType *
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::GetVoronoiMap()
+{
+  return dynamic_cast< VoronoiImageType * >( this->ProcessObject::GetOutput(1) );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+void
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType *input = const_cast< InputImageType * >( this->GetInput() );
+  if ( input )
+    {
+    input->SetRequestedRegion( input->GetLargestPossibleRegion() );
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+void
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::EnlargeOutputRequestedRegion(DataObject *)
+{
+  OutputImageType *output = this->GetOutput();
+  output->SetRequestedRegion( output->GetLargestPossibleRegion() );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+const ImageRegionSplitterBase *
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::GetImageRegionSplitter() const
+{
+  return m_ImageRegionSplitter.GetPointer();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+void
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::GenerateData()
+{
+  this->AllocateOutputs();
+
+  // the squared distances are kept between the passes, the last pass
+  // writes directly the output
+  if ( ImageDimension > 1 )
+    {
+    m_SquaredDistanceMap = DistanceImageType::New();
+    m_SquaredDistanceMap->SetRegions( this->GetOutput()->GetBufferedRegion() );
+    m_SquaredDistanceMap->Allocate();
+    }
+
+  // Set up the multithreaded processing
+  typename ImageSource< OutputImageType >::ThreadStruct str;
+  str.Filter = this;
+
+  MultiThreader *multithreader = this->GetMultiThreader();
+  multithreader->SetNumberOfThreads( this->GetNumberOfThreads() );
+  multithreader->SetSingleMethod(this->ThreaderCallback, &str);
+
+  // multithread the execution, one dimension at a time
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    m_CurrentDimension = d;
+    m_ImageRegionSplitter->SetDirection(d);
+    multithreader->SingleMethodExecute();
+    }
+
+  m_SquaredDistanceMap = ITK_NULLPTR;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+void
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  const InputImageType *input = this->GetInput();
+  OutputImageType *     output = this->GetOutput();
+  VoronoiImageType *    voronoiMap = this->GetVoronoiMap();
+  DistanceImageType *   distanceMap = m_SquaredDistanceMap.GetPointer();
+
+  const unsigned int  d = m_CurrentDimension;
+  const bool          firstPass = ( d == 0 );
+  const bool          lastPass = ( d == ImageDimension - 1 );
+  const SizeValueType lineLength = outputRegionForThread.GetSize()[d];
+  const double        spacing = m_UseImageSpacing ? output->GetSpacing()[d] : 1.0;
+  const double        infinity = NumericTraits< double >::max();
+
+  const OffsetValueType inputStride = input->GetOffsetTable()[d];
+  const OffsetValueType outputStride = output->GetOffsetTable()[d];
+  const OffsetValueType voronoiStride = voronoiMap->GetOffsetTable()[d];
+  const OffsetValueType distanceStride = distanceMap ? distanceMap->GetOffsetTable()[d] : 0;
+
+  // the parabolas of the lower envelope of the current line
+  std::vector< double >           g(lineLength);
+  std::vector< double >           h(lineLength);
+  std::vector< VoronoiPixelType > codes(lineLength);
+
+  ProgressReporter progress(this, threadId,
+                            outputRegionForThread.GetNumberOfPixels() / lineLength, 30,
+                            static_cast< float >( d ) / ImageDimension,
+                            1.0f / ImageDimension);
+
+  ImageLinearConstIteratorWithIndex< OutputImageType > it(output, outputRegionForThread);
+  it.SetDirection(d);
+  it.GoToBegin();
+  while ( !it.IsAtEnd() )
+    {
+    const IndexType   index = it.GetIndex();
+    OutputPixelType * outputLine = output->GetBufferPointer() + output->ComputeOffset(index);
+    VoronoiPixelType *voronoiLine = voronoiMap->GetBufferPointer() + voronoiMap->ComputeOffset(index);
+    double *          distanceLine = distanceMap ? distanceMap->GetBufferPointer() + distanceMap->ComputeOffset(index)
+                                     : ITK_NULLPTR;
+
+    // keep the parabolas of the pixels having a closest object, and remove
+    // the ones hidden by their neighbors
+    int l = -1;
+    if ( firstPass )
+      {
+      const InputPixelType *inputLine = input->GetBufferPointer() + input->ComputeOffset(index);
+      for ( SizeValueType i = 0; i < lineLength; i++ )
+        {
+        const InputPixelType value = inputLine[i * inputStride];
+        if ( value != NumericTraits< InputPixelType >::ZeroValue() )
+          {
+          const double x = i * spacing;
+          while ( l >= 1 && Remove(g[l - 1], g[l], 0.0, h[l - 1], h[l], x) )
+            {
+            l--;
+            }
+          l++;
+          g[l] = 0.0;
+          h[l] = x;
+          codes[l] = m_InputIsBinary ? NumericTraits< VoronoiPixelType >::OneValue()
+                     : static_cast< VoronoiPixelType >( value );
+          }
+        }
+      }
+    else
+      {
+      for ( SizeValueType i = 0; i < lineLength; i++ )
+        {
+        const double gi = distanceLine[i * distanceStride];
+        if ( gi != infinity )
+          {
+          const double x = i * spacing;
+          while ( l >= 1 && Remove(g[l - 1], g[l], gi, h[l - 1], h[l], x) )
+            {
+            l--;
+            }
+          l++;
+          g[l] = gi;
+          h[l] = x;
+          codes[l] = voronoiLine[i * voronoiStride];
+          }
+        }
+      }
+
+    if ( l == -1 )
+      {
+      // no object has been found yet for the pixels of this line
+      for ( SizeValueType i = 0; i < lineLength; i++ )
+        {
+        if ( lastPass )
+          {
+          outputLine[i * outputStride] = NumericTraits< OutputPixelType >::max();
+          }
+        else
+          {
+          distanceLine[i * distanceStride] = infinity;
+          }
+        if ( firstPass )
+          {
+          voronoiLine[i * voronoiStride] = NumericTraits< VoronoiPixelType >::ZeroValue();
+          }
+        }
+      }
+    else
+      {
+      // find the lowest parabola at each pixel
+      const int ns = l;
+      l = 0;
+      for ( SizeValueType i = 0; i < lineLength; i++ )
+        {
+        const double x = i * spacing;
+        double       d1 = g[l] + ( h[l] - x ) * ( h[l] - x );
+        while ( l < ns )
+          {
+          const double d2 = g[l + 1] + ( h[l + 1] - x ) * ( h[l + 1] - x );
+          if ( d1 <= d2 )
+            {
+            break;
+            }
+          l++;
+          d1 = d2;
+          }
+
+        if ( lastPass )
+          {
+          outputLine[i * outputStride] = static_cast< OutputPixelType >( m_SquaredDistance ? d1 : std::sqrt(d1) );
+          }
+        else
+          {
+          distanceLine[i * distanceStride] = d1;
+          }
+        voronoiLine[i * voronoiStride] = codes[l];
+        }
+      }
+
+    it.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+bool
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::Remove(double d1, double d2, double df,
+         double x1, double x2, double xf)
+{
+  const double a = x2 - x1;
+  const double b = xf - x2;
+  const double c = xf - x1;
+
+  return ( c * d2 - b * d1 - a * df - a * b * c ) > 0;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TVoronoiImage >
+void
+MaurerDistanceMapImageFilter< TInputImage, TOutputImage, TVoronoiImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Input Is Binary   : " << m_InputIsBinary << std::endl;
+  os << indent << "Use Image Spacing : " << m_UseImageSpacing << std::endl;
+  os << indent << "Squared Distance  : " << m_SquaredDistance << std::endl;
+}
+} // end namespace itk
+
+#endif
@@ -0,0 +1,181 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMaurerDistanceMapImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+
+#include <vector>
+
+// Compare the distance and Voronoi maps to the ones computed by brute
+// force, with and without spacing, with one and several threads.
+
+template< unsigned int VDimension >
+static int
+MaurerDistanceMapImageFilterCheck(const typename itk::Image< unsigned char, VDimension >::SizeType & size,
+                                  unsigned int numberOfObjects,
+                                  bool useImageSpacing,
+                                  unsigned int numberOfThreads)
+{
+  typedef itk::Image< unsigned char, VDimension > InputImageType;
+  typedef itk::Image< float, VDimension >         OutputImageType;
+  typedef typename InputImageType::IndexType      IndexType;
+
+  typename InputImageType::Pointer input = InputImageType::New();
+  input->SetRegions( size );
+  input->Allocate();
+  input->FillBuffer( 0 );
+
+  typename InputImageType::SpacingType spacing;
+  for ( unsigned int d = 0; d < VDimension; d++ )
+    {
+    spacing[d] = 0.5 + 0.75 * d;
+    }
+  input->SetSpacing( spacing );
+
+  // a few objects, with a different code each
+  std::vector< IndexType > objects;
+  unsigned int             seed = 12345;
+  for ( unsigned int o = 0; o < numberOfObjects; o++ )
+    {
+    IndexType index;
+    for ( unsigned int d = 0; d < VDimension; d++ )
+      {
+      seed = seed * 1103515245 + 12345;
+      index[d] = ( seed >> 16 ) % size[d];
+      }
+    if ( input->GetPixel( index ) == 0 )
+      {
+      input->SetPixel( index, static_cast< unsigned char >( o + 1 ) );
+      objects.push_back( index );
+      }
+    }
+
+  typedef itk::MaurerDistanceMapImageFilter< InputImageType, OutputImageType > FilterType;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( input );
+  filter->SetUseImageSpacing( useImageSpacing );
+  filter->SetSquaredDistance( true );
+  filter->SetNumberOfThreads( numberOfThreads );
+  filter->Update();
+
+  itk::ImageRegionIteratorWithIndex< OutputImageType > it( filter->GetDistanceMap(),
+                                                           filter->GetDistanceMap()->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    // the squared distance to each object
+    const IndexType       index = it.GetIndex();
+    std::vector< double > distances( objects.size() );
+    double                minimum = itk::NumericTraits< double >::max();
+    for ( unsigned int o = 0; o < objects.size(); o++ )
+      {
+      distances[o] = 0.0;
+      for ( unsigned int d = 0; d < VDimension; d++ )
+        {
+        const double component = ( index[d] - objects[o][d] ) * ( useImageSpacing ? spacing[d] : 1.0 );
+        distances[o] += component * component;
+        }
+      minimum = std::min( minimum, distances[o] );
+      }
+
+    if ( std::abs( it.Get() - minimum ) > 1e-3 * ( 1.0 + minimum ) )
+      {
+      std::cerr << "Wrong distance at " << index << ": expected " << minimum << ", got " << it.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // the code of the Voronoi map must be the one of a closest object
+    const unsigned char code = filter->GetVoronoiMap()->GetPixel( index );
+    bool found = false;
+    for ( unsigned int o = 0; o < objects.size(); o++ )
+      {
+      if ( input->GetPixel( objects[o] ) == code && std::abs( distances[o] - minimum ) <= 1e-3 * ( 1.0 + minimum ) )
+        {
+        found = true;
+        }
+      }
+    if ( !found )
+      {
+      std::cerr << "Wrong Voronoi code at " << index << ": " << static_cast< int >( code )
+                << " is not the code of a closest object" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the distance is the square root of the squared distance
+  typename OutputImageType::Pointer squared = filter->GetDistanceMap();
+  squared->DisconnectPipeline();
+  filter->SetSquaredDistance( false );
+  filter->Update();
+  itk::ImageRegionIteratorWithIndex< OutputImageType > sit( squared, squared->GetLargestPossibleRegion() );
+  for ( ; !sit.IsAtEnd(); ++sit )
+    {
+    const float distance = filter->GetDistanceMap()->GetPixel( sit.GetIndex() );
+    if ( std::abs( distance * distance - sit.Get() ) > 1e-3 * ( 1.0 + sit.Get() ) )
+      {
+      std::cerr << "Wrong distance at " << sit.GetIndex() << ": " << distance << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+int itkMaurerDistanceMapImageFilterTest(int, char* [] )
+{
+  int status = EXIT_SUCCESS;
+
+  itk::Size< 1 > size1 = { { 97 } };
+  itk::Size< 2 > size2 = { { 57, 43 } };
+  itk::Size< 3 > size3 = { { 19, 23, 17 } };
+  for ( unsigned int threads = 1; threads <= 3; threads += 2 )
+    {
+    for ( unsigned int spacing = 0; spacing < 2; spacing++ )
+      {
+      status |= MaurerDistanceMapImageFilterCheck< 1 >( size1, 5, spacing, threads );
+      status |= MaurerDistanceMapImageFilterCheck< 2 >( size2, 1, spacing, threads );
+      status |= MaurerDistanceMapImageFilterCheck< 2 >( size2, 20, spacing, threads );
+      status |= MaurerDistanceMapImageFilterCheck< 3 >( size3, 30, spacing, threads );
+      }
+    }
+
+  // an image without object
+  typedef itk::Image< unsigned char, 2 > InputImageType;
+  typedef itk::Image< float, 2 >         OutputImageType;
+  InputImageType::Pointer input = InputImageType::New();
+  input->SetRegions( size2 );
+  input->Allocate();
+  input->FillBuffer( 0 );
+
+  typedef itk::MaurerDistanceMapImageFilter< InputImageType, OutputImageType > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( input );
+  filter->Update();
+  if ( filter->GetDistanceMap()->GetPixel( input->GetLargestPossibleRegion().GetIndex() )
+       != itk::NumericTraits< float >::max() )
+    {
+    std::cerr << "Wrong distance without object" << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  if ( status == EXIT_SUCCESS )
+    {
+    std::cout << "Test passed." << std::endl;
+    }
+  return status;
+}
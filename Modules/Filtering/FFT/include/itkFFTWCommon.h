@@ -357,6 +357,96 @@ public:
     MutexLockHolder< FFTWGlobalConfiguration::MutexType > lock( FFTWGlobalConfiguration::GetLockMutex() );
     fftwf_destroy_plan(p);
   }
+  /** Get a plan from the plan cache of FFTWGlobalConfiguration, or create
+   * it and store it in the cache. The plan is owned by the cache and must
+   * not be destroyed, but given back with ReleaseCachedPlan() once
+   * executed. It must be executed with Execute_dft_c2r(), on arrays with
+   * the same alignment as the ones given here. */
+  static PlanType GetCachedPlan_dft_c2r(int rank,
+                                        const int *n,
+                                        ComplexType *in,
+                                        PixelType *out,
+                                        unsigned flags,
+                                        int threads=1,
+                                        bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::C2R, rank, n, flags, threads,
+                                                 static_cast< void * >( in ) == static_cast< void * >( out ),
+                                                 fftwf_alignment_of( reinterpret_cast< PixelType * >( in ) ),
+                                                 fftwf_alignment_of( out ) );
+    PlanType plan;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = FFTWGlobalConfiguration::AddCachedPlan( key, Plan_dft_c2r( rank, n, in, out, flags, threads, canDestroyInput ) );
+      }
+    return plan;
+  }
+
+  /** Get a plan from the plan cache, or create it. \sa GetCachedPlan_dft_c2r */
+  static PlanType GetCachedPlan_dft_r2c(int rank,
+                                        const int *n,
+                                        PixelType *in,
+                                        ComplexType *out,
+                                        unsigned flags,
+                                        int threads=1,
+                                        bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::R2C, rank, n, flags, threads,
+                                                 static_cast< void * >( in ) == static_cast< void * >( out ),
+                                                 fftwf_alignment_of( in ),
+                                                 fftwf_alignment_of( reinterpret_cast< PixelType * >( out ) ) );
+    PlanType plan;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = FFTWGlobalConfiguration::AddCachedPlan( key, Plan_dft_r2c( rank, n, in, out, flags, threads, canDestroyInput ) );
+      }
+    return plan;
+  }
+
+  /** Get a plan from the plan cache, or create it. \sa GetCachedPlan_dft_c2r */
+  static PlanType GetCachedPlan_dft(int rank,
+                                    const int *n,
+                                    ComplexType *in,
+                                    ComplexType *out,
+                                    int sign,
+                                    unsigned flags,
+                                    int threads=1,
+                                    bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( sign == FFTW_FORWARD ? FFTWGlobalConfiguration::FORWARD_DFT
+                                                : FFTWGlobalConfiguration::BACKWARD_DFT,
+                                                rank, n, flags, threads,
+                                                in == out,
+                                                fftwf_alignment_of( reinterpret_cast< PixelType * >( in ) ),
+                                                fftwf_alignment_of( reinterpret_cast< PixelType * >( out ) ) );
+    PlanType plan;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = FFTWGlobalConfiguration::AddCachedPlan( key, Plan_dft( rank, n, in, out, sign, flags, threads, canDestroyInput ) );
+      }
+    return plan;
+  }
+
+  /** Execute a plan on other arrays than the ones used to create it. This
+   * can be done concurrently by several threads with the same plan. */
+  static void Execute_dft_c2r(PlanType p, ComplexType *in, PixelType *out)
+  {
+    fftwf_execute_dft_c2r(p, in, out);
+  }
+  static void Execute_dft_r2c(PlanType p, PixelType *in, ComplexType *out)
+  {
+    fftwf_execute_dft_r2c(p, in, out);
+  }
+  static void Execute_dft(PlanType p, ComplexType *in, ComplexType *out)
+  {
+    fftwf_execute_dft(p, in, out);
+  }
+
+  /** Give back a plan obtained with one of the GetCachedPlan methods. */
+  static void ReleaseCachedPlan(PlanType p)
+  {
+    FFTWGlobalConfiguration::ReleaseCachedPlan(p);
+  }
 };
 
 #endif // ITK_USE_FFTWF
@@ -660,6 +750,96 @@ public:
     MutexLockHolder< FFTWGlobalConfiguration::MutexType > lock( FFTWGlobalConfiguration::GetLockMutex() );
     fftw_destroy_plan(p);
   }
+  /** Get a plan from the plan cache of FFTWGlobalConfiguration, or create
+   * it and store it in the cache. The plan is owned by the cache and must
+   * not be destroyed, but given back with ReleaseCachedPlan() once
+   * executed. It must be executed with Execute_dft_c2r(), on arrays with
+   * the same alignment as the ones given here. */
+  static PlanType GetCachedPlan_dft_c2r(int rank,
+                                        const int *n,
+                                        ComplexType *in,
+                                        PixelType *out,
+                                        unsigned flags,
+                                        int threads=1,
+                                        bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::C2R, rank, n, flags, threads,
+                                                 static_cast< void * >( in ) == static_cast< void * >( out ),
+                                                 fftw_alignment_of( reinterpret_cast< PixelType * >( in ) ),
+                                                 fftw_alignment_of( out ) );
+    PlanType plan;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = FFTWGlobalConfiguration::AddCachedPlan( key, Plan_dft_c2r( rank, n, in, out, flags, threads, canDestroyInput ) );
+      }
+    return plan;
+  }
+
+  /** Get a plan from the plan cache, or create it. \sa GetCachedPlan_dft_c2r */
+  static PlanType GetCachedPlan_dft_r2c(int rank,
+                                        const int *n,
+                                        PixelType *in,
+                                        ComplexType *out,
+                                        unsigned flags,
+                                        int threads=1,
+                                        bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::R2C, rank, n, flags, threads,
+                                                 static_cast< void * >( in ) == static_cast< void * >( out ),
+                                                 fftw_alignment_of( in ),
+                                                 fftw_alignment_of( reinterpret_cast< PixelType * >( out ) ) );
+    PlanType plan;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = FFTWGlobalConfiguration::AddCachedPlan( key, Plan_dft_r2c( rank, n, in, out, flags, threads, canDestroyInput ) );
+      }
+    return plan;
+  }
+
+  /** Get a plan from the plan cache, or create it. \sa GetCachedPlan_dft_c2r */
+  static PlanType GetCachedPlan_dft(int rank,
+                                    const int *n,
+                                    ComplexType *in,
+                                    ComplexType *out,
+                                    int sign,
+                                    unsigned flags,
+                                    int threads=1,
+                                    bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( sign == FFTW_FORWARD ? FFTWGlobalConfiguration::FORWARD_DFT
+                                                : FFTWGlobalConfiguration::BACKWARD_DFT,
+                                                rank, n, flags, threads,
+                                                in == out,
+                                                fftw_alignment_of( reinterpret_cast< PixelType * >( in ) ),
+                                                fftw_alignment_of( reinterpret_cast< PixelType * >( out ) ) );
+    PlanType plan;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = FFTWGlobalConfiguration::AddCachedPlan( key, Plan_dft( rank, n, in, out, sign, flags, threads, canDestroyInput ) );
+      }
+    return plan;
+  }
+
+  /** Execute a plan on other arrays than the ones used to create it. This
+   * can be done concurrently by several threads with the same plan. */
+  static void Execute_dft_c2r(PlanType p, ComplexType *in, PixelType *out)
+  {
+    fftw_execute_dft_c2r(p, in, out);
+  }
+  static void Execute_dft_r2c(PlanType p, PixelType *in, ComplexType *out)
+  {
+    fftw_execute_dft_r2c(p, in, out);
+  }
+  static void Execute_dft(PlanType p, ComplexType *in, ComplexType *out)
+  {
+    fftw_execute_dft(p, in, out);
+  }
+
+  /** Give back a plan obtained with one of the GetCachedPlan methods. */
+  static void ReleaseCachedPlan(PlanType p)
+  {
+    FFTWGlobalConfiguration::ReleaseCachedPlan(p);
+  }
 };
 
 #endif
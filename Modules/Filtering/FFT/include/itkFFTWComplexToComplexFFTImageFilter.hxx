@@ -94,16 +94,17 @@ FFTWComplexToComplexFFTImageFilter< TImage >
     sizes[(ImageDimension - 1) - i] = inputSize[i];
     }
 
-  plan = FFTWProxyType::Plan_dft(ImageDimension,sizes,
-                                    in,
-                                    out,
-                                    transformDirection,
-                                    flags,
-                                    this->GetNumberOfThreads());
+  plan = FFTWProxyType::GetCachedPlan_dft(ImageDimension,sizes,
+                                          in,
+                                          out,
+                                          transformDirection,
+                                          flags,
+                                          this->GetNumberOfThreads());
   delete[] sizes;
 
-  FFTWProxyType::Execute(plan);
-  FFTWProxyType::DestroyPlan(plan);
+  // the plan is owned by the plan cache, give it back once executed
+  FFTWProxyType::Execute_dft(plan, in, out);
+  FFTWProxyType::ReleaseCachedPlan(plan);
 }
 
 
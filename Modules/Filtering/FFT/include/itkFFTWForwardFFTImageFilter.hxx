@@ -110,13 +110,14 @@ FFTWForwardFFTImageFilter< TInputImage, TOutputImage >
     sizes[(ImageDimension - 1) - i] = inputSize[i];
     }
 
-  plan = FFTWProxyType::Plan_dft_r2c(ImageDimension, sizes, in,
-                                     (typename FFTWProxyType::ComplexType*)
-                                     fftwOutput->GetBufferPointer(), flags,
-                                     this->GetNumberOfThreads());
+  typename FFTWProxyType::ComplexType * out =
+    (typename FFTWProxyType::ComplexType*) fftwOutput->GetBufferPointer();
+  plan = FFTWProxyType::GetCachedPlan_dft_r2c(ImageDimension, sizes, in, out, flags,
+                                              this->GetNumberOfThreads());
   delete[] sizes;
-  FFTWProxyType::Execute(plan);
-  FFTWProxyType::DestroyPlan(plan);
+  // the plan is owned by the plan cache, give it back once executed
+  FFTWProxyType::Execute_dft_r2c(plan, in, out);
+  FFTWProxyType::ReleaseCachedPlan(plan);
 
   // Expand the half image to the full image size
   typedef HalfToFullHermitianImageFilter< OutputImageType > HalfToFullFilterType;
@@ -31,6 +31,8 @@
 #include "fftw3.h"
 #include <algorithm>
 #include <cctype>
+#include <map>
+#include <vector>
 
 //* The fftw utilities help control the various strategies
 //available for controlling optimizations for the FFTW library.
@@ -51,6 +53,11 @@
 //                             set, then ITK_FFTW_WISDOM_CACHE_BASE
 //                             is ignored.
 //
+// The plans created by the FFTW filters are kept in a plan cache, and
+// reused by all the filters transforming images of the same size. The
+// least recently used plans are destroyed when the cache holds more plans
+// than MaximumNumberOfCachedPlans.
+//
 // The above behaviors can also be controlled by the application.
 //
 
@@ -280,6 +287,73 @@ public:
   static bool ImportDefaultWisdomFileFloat();
   static bool ExportDefaultWisdomFileFloat();
 
+  /** The kinds of transforms stored in the plan cache. */
+  typedef enum { R2C = 0, C2R = 1, FORWARD_DFT = 2, BACKWARD_DFT = 3 } PlanKindType;
+
+  /** \class PlanKey
+   * \brief Identify a plan in the plan cache.
+   *
+   * A plan can be executed on other arrays than the ones used to create
+   * it, as long as they have the same sizes, the same memory layout and
+   * the same alignment.
+   * \ingroup ITKFFT
+   */
+  class PlanKey
+  {
+  public:
+    PlanKey(PlanKindType kind, int rank, const int *n, unsigned flags, int threads,
+            bool inPlace, int inputAlignment, int outputAlignment);
+
+    bool operator<(const PlanKey & other) const;
+
+  private:
+    PlanKindType       m_Kind;
+    std::vector< int > m_Sizes;
+    unsigned           m_Flags;
+    int                m_NumberOfThreads;
+    bool               m_InPlace;
+    int                m_InputAlignment;
+    int                m_OutputAlignment;
+  };
+
+#if defined(ITK_USE_FFTWF)
+  /** Get a plan from the plan cache. Return false if the cache doesn't
+   * contain any plan for that key. The plan is not destroyed until it is
+   * given back with ReleaseCachedPlan(). */
+  static bool GetCachedPlan( const PlanKey & key, fftwf_plan & plan );
+
+  /** Store a plan in the plan cache, which then owns it. If another thread
+   * has already stored a plan for the same key, the given plan is destroyed
+   * and the cached one is returned. The plan must be given back with
+   * ReleaseCachedPlan(). */
+  static fftwf_plan AddCachedPlan( const PlanKey & key, fftwf_plan plan );
+
+  /** Give back a plan obtained with GetCachedPlan() or AddCachedPlan()
+   * once it has been executed, so that it can be destroyed when the cache
+   * is full. */
+  static void ReleaseCachedPlan( fftwf_plan plan );
+#endif
+
+#if defined(ITK_USE_FFTWD)
+  static bool GetCachedPlan( const PlanKey & key, fftw_plan & plan );
+  static fftw_plan AddCachedPlan( const PlanKey & key, fftw_plan plan );
+  static void ReleaseCachedPlan( fftw_plan plan );
+#endif
+
+  /** Destroy all the plans of the plan cache which are not being used by
+   * a filter. The plan cache is cleared automatically at exit. */
+  static void ClearPlanCache();
+
+  /** Get the number of plans in the plan cache. */
+  static SizeValueType GetNumberOfCachedPlans();
+
+  /** Set/Get the maximum number of plans kept in the plan cache. When the
+   * cache holds more plans, the least recently used ones which are not
+   * being used by a filter are destroyed. With a maximum of 0, the plans
+   * are destroyed as soon as they have been executed. The default is 64. */
+  static void SetMaximumNumberOfCachedPlans( const SizeValueType & v );
+  static SizeValueType GetMaximumNumberOfCachedPlans();
+
 private:
   FFTWGlobalConfiguration(); //This will process env variables
   ~FFTWGlobalConfiguration(); //This will write cache file if requested.
@@ -287,6 +361,23 @@ private:
   /** Return the singleton instance with no reference counting. */
   static Pointer GetInstance();
 
+  /** Destroy the cached plans, without locking. If onlyUnused is true,
+   * the plans being used by a filter are kept. */
+  void DestroyCachedPlans(bool onlyUnused);
+
+  /** Destroy the least recently used plans which are not being used until
+   * the cache is not larger than its maximum size, without locking. */
+  void EvictCachedPlans();
+
+  /** A plan of the plan cache, with the time of its last use and the number
+   * of filters using it. */
+  template< typename TPlan >
+  struct CachedPlan {
+    TPlan         Plan;
+    SizeValueType LastUse;
+    unsigned int  NumberOfUsers;
+  };
+
   /** This is a singleton pattern New.  There will only be ONE
    * reference to a FFTWGlobalConfiguration object per process.
    * The single instance will be unreferenced when
@@ -308,6 +399,15 @@ private:
   //m_WriteWisdomCache Controls the behavior of default
   //wisdom file creation policies.
   WisdomFilenameGeneratorBase * m_WisdomFilenameGenerator;
+
+  SizeValueType                 m_MaximumNumberOfCachedPlans;
+  SizeValueType                 m_PlanUseCount;
+#if defined(ITK_USE_FFTWF)
+  std::map< PlanKey, CachedPlan< fftwf_plan > > m_FloatPlans;
+#endif
+#if defined(ITK_USE_FFTWD)
+  std::map< PlanKey, CachedPlan< fftw_plan > >  m_DoublePlans;
+#endif
 };
 }
 #endif
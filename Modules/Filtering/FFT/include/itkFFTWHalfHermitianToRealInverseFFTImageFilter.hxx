@@ -94,9 +94,9 @@ FFTWHalfHermitianToRealInverseFFTImageFilter< TInputImage, TOutputImage >
     {
     sizes[(ImageDimension - 1) - i] = outputSize[i];
     }
-  plan = FFTWProxyType::Plan_dft_c2r( ImageDimension, sizes, in, out, m_PlanRigor,
-                                      this->GetNumberOfThreads(),
-                                      !m_CanUseDestructiveAlgorithm );
+  plan = FFTWProxyType::GetCachedPlan_dft_c2r( ImageDimension, sizes, in, out, m_PlanRigor,
+                                                this->GetNumberOfThreads(),
+                                                !m_CanUseDestructiveAlgorithm );
   if( !m_CanUseDestructiveAlgorithm )
     {
     // complex<double> and double[2] types are compatible memory layouts.
@@ -106,10 +106,10 @@ FFTWHalfHermitianToRealInverseFFTImageFilter< TInputImage, TOutputImage >
                inputPtr->GetBufferPointer()+totalInputSize,
                reinterpret_cast< typename InputImageType::PixelType * > (in) );
     }
-  FFTWProxyType::Execute( plan );
+  FFTWProxyType::Execute_dft_c2r( plan, in, out );
+  FFTWProxyType::ReleaseCachedPlan( plan );
 
-  // Some cleanup.
-  FFTWProxyType::DestroyPlan( plan );
+  // Some cleanup. The plan is owned by the plan cache.
   if( !m_CanUseDestructiveAlgorithm )
     {
     delete[] in;
@@ -92,12 +92,11 @@ FFTWInverseFFTImageFilter< TInputImage, TOutputImage >
     sizes[(ImageDimension - 1) - i] = outputSize[i];
     }
 
-  plan = FFTWProxyType::Plan_dft_c2r( ImageDimension, sizes, in, out, m_PlanRigor,
-                                      this->GetNumberOfThreads(), false );
-  FFTWProxyType::Execute( plan );
-
-  // Some cleanup.
-  FFTWProxyType::DestroyPlan( plan );
+  plan = FFTWProxyType::GetCachedPlan_dft_c2r( ImageDimension, sizes, in, out, m_PlanRigor,
+                                                this->GetNumberOfThreads(), false );
+  // the plan is owned by the plan cache, give it back once executed
+  FFTWProxyType::Execute_dft_c2r( plan, in, out );
+  FFTWProxyType::ReleaseCachedPlan( plan );
 }
 
 template <typename TInputImage, typename TOutputImage>
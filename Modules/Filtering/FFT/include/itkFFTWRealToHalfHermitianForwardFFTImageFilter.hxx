@@ -93,11 +93,12 @@ FFTWRealToHalfHermitianForwardFFTImageFilter< TInputImage, TOutputImage >
     sizes[(ImageDimension - 1) - i] = inputSize[i];
     }
 
-  plan = FFTWProxyType::Plan_dft_r2c(ImageDimension, sizes, in, out, flags,
-                                    this->GetNumberOfThreads());
+  plan = FFTWProxyType::GetCachedPlan_dft_r2c(ImageDimension, sizes, in, out, flags,
+                                              this->GetNumberOfThreads());
   delete[] sizes;
-  FFTWProxyType::Execute(plan);
-  FFTWProxyType::DestroyPlan(plan);
+  // the plan is owned by the plan cache, give it back once executed
+  FFTWProxyType::Execute_dft_r2c(plan, in, out);
+  FFTWProxyType::ReleaseCachedPlan(plan);
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -31,6 +31,8 @@
 #endif
 
 # include "itkObjectFactory.h"
+# include "itkMutexLockHolder.h"
+# include "itkNumericTraits.h"
 
 namespace itk
 {
@@ -410,7 +412,9 @@ FFTWGlobalConfiguration
   m_PlanRigor(0),
   m_WriteWisdomCache(false),
   m_ReadWisdomCache(true),
-  m_WisdomCacheBase("")
+  m_WisdomCacheBase(""),
+  m_MaximumNumberOfCachedPlans(64),
+  m_PlanUseCount(0)
 {
     {//Configure default method for creating WISDOM_CACHE files
     std::string manualCacheFilename="";
@@ -550,6 +554,7 @@ FFTWGlobalConfiguration
       }
 #endif
     }
+  this->DestroyCachedPlans(false);
 #if defined(ITK_USE_FFTWF)
   fftwf_cleanup_threads();
   fftwf_cleanup();
@@ -837,6 +842,314 @@ FFTWGlobalConfiguration
   return GetInstance()->m_WisdomCacheBase;
 }
 
+FFTWGlobalConfiguration::PlanKey
+::PlanKey(PlanKindType kind, int rank, const int *n, unsigned flags, int threads,
+          bool inPlace, int inputAlignment, int outputAlignment)
+  : m_Kind(kind),
+    m_Sizes(n, n + rank),
+    m_Flags(flags),
+    m_NumberOfThreads(threads),
+    m_InPlace(inPlace),
+    m_InputAlignment(inputAlignment),
+    m_OutputAlignment(outputAlignment)
+{
+}
+
+bool
+FFTWGlobalConfiguration::PlanKey
+::operator<(const PlanKey & other) const
+{
+  if( m_Kind != other.m_Kind )
+    {
+    return m_Kind < other.m_Kind;
+    }
+  if( m_Sizes != other.m_Sizes )
+    {
+    return m_Sizes < other.m_Sizes;
+    }
+  if( m_Flags != other.m_Flags )
+    {
+    return m_Flags < other.m_Flags;
+    }
+  if( m_NumberOfThreads != other.m_NumberOfThreads )
+    {
+    return m_NumberOfThreads < other.m_NumberOfThreads;
+    }
+  if( m_InPlace != other.m_InPlace )
+    {
+    return m_InPlace < other.m_InPlace;
+    }
+  if( m_InputAlignment != other.m_InputAlignment )
+    {
+    return m_InputAlignment < other.m_InputAlignment;
+    }
+  return m_OutputAlignment < other.m_OutputAlignment;
+}
+
+namespace
+{
+#if defined(ITK_USE_FFTWF)
+void DestroyFFTWPlan( fftwf_plan plan )
+{
+  fftwf_destroy_plan( plan );
+}
+#endif
+#if defined(ITK_USE_FFTWD)
+void DestroyFFTWPlan( fftw_plan plan )
+{
+  fftw_destroy_plan( plan );
+}
+#endif
+
+template< typename TPlanMap, typename TPlan >
+bool LookUpCachedPlan( TPlanMap & plans, const FFTWGlobalConfiguration::PlanKey & key, TPlan & plan,
+                       SizeValueType useCount )
+{
+  typename TPlanMap::iterator it = plans.find( key );
+  if( it == plans.end() )
+    {
+    return false;
+    }
+  it->second.LastUse = useCount;
+  ++it->second.NumberOfUsers;
+  plan = it->second.Plan;
+  return true;
+}
+
+template< typename TPlanMap, typename TPlan >
+TPlan InsertCachedPlan( TPlanMap & plans, const FFTWGlobalConfiguration::PlanKey & key, TPlan plan,
+                        SizeValueType useCount )
+{
+  typename TPlanMap::mapped_type cachedPlan;
+  cachedPlan.Plan = plan;
+  cachedPlan.LastUse = useCount;
+  cachedPlan.NumberOfUsers = 0;
+  std::pair< typename TPlanMap::iterator, bool > inserted = plans.insert( std::make_pair( key, cachedPlan ) );
+  if( !inserted.second )
+    {
+    // another thread has created the same plan in the mean time
+    DestroyFFTWPlan( plan );
+    inserted.first->second.LastUse = useCount;
+    }
+  ++inserted.first->second.NumberOfUsers;
+  return inserted.first->second.Plan;
+}
+
+template< typename TPlanMap, typename TPlan >
+void ReleaseCachedPlanOfMap( TPlanMap & plans, TPlan plan )
+{
+  for( typename TPlanMap::iterator it = plans.begin(); it != plans.end(); ++it )
+    {
+    if( it->second.Plan == plan )
+      {
+      if( it->second.NumberOfUsers > 0 )
+        {
+        --it->second.NumberOfUsers;
+        }
+      return;
+      }
+    }
+}
+
+/** Return the least recently used plan which is not being used, or end()
+ * if all the plans are being used. */
+template< typename TPlanMap >
+typename TPlanMap::iterator LeastRecentlyUsedPlan( TPlanMap & plans )
+{
+  typename TPlanMap::iterator leastRecentlyUsed = plans.end();
+  for( typename TPlanMap::iterator it = plans.begin(); it != plans.end(); ++it )
+    {
+    if( it->second.NumberOfUsers == 0
+        && ( leastRecentlyUsed == plans.end() || it->second.LastUse < leastRecentlyUsed->second.LastUse ) )
+      {
+      leastRecentlyUsed = it;
+      }
+    }
+  return leastRecentlyUsed;
+}
+
+template< typename TPlanMap >
+void DestroyCachedPlansOfMap( TPlanMap & plans, bool onlyUnused )
+{
+  typename TPlanMap::iterator it = plans.begin();
+  while( it != plans.end() )
+    {
+    if( onlyUnused && it->second.NumberOfUsers > 0 )
+      {
+      ++it;
+      continue;
+      }
+    DestroyFFTWPlan( it->second.Plan );
+    plans.erase( it++ );
+    }
+}
+} // end anonymous namespace
+
+#if defined(ITK_USE_FFTWF)
+bool
+FFTWGlobalConfiguration
+::GetCachedPlan( const PlanKey & key, fftwf_plan & plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< SimpleFastMutexLock > lock( instance->m_Lock );
+  return LookUpCachedPlan( instance->m_FloatPlans, key, plan, ++instance->m_PlanUseCount );
+}
+
+fftwf_plan
+FFTWGlobalConfiguration
+::AddCachedPlan( const PlanKey & key, fftwf_plan plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< SimpleFastMutexLock > lock( instance->m_Lock );
+  return InsertCachedPlan( instance->m_FloatPlans, key, plan, ++instance->m_PlanUseCount );
+}
+
+void
+FFTWGlobalConfiguration
+::ReleaseCachedPlan( fftwf_plan plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< SimpleFastMutexLock > lock( instance->m_Lock );
+  ReleaseCachedPlanOfMap( instance->m_FloatPlans, plan );
+  instance->EvictCachedPlans();
+}
+#endif
+
+#if defined(ITK_USE_FFTWD)
+bool
+FFTWGlobalConfiguration
+::GetCachedPlan( const PlanKey & key, fftw_plan & plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< SimpleFastMutexLock > lock( instance->m_Lock );
+  return LookUpCachedPlan( instance->m_DoublePlans, key, plan, ++instance->m_PlanUseCount );
+}
+
+fftw_plan
+FFTWGlobalConfiguration
+::AddCachedPlan( const PlanKey & key, fftw_plan plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< SimpleFastMutexLock > lock( instance->m_Lock );
+  return InsertCachedPlan( instance->m_DoublePlans, key, plan, ++instance->m_PlanUseCount );
+}
+
+void
+FFTWGlobalConfiguration
+::ReleaseCachedPlan( fftw_plan plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< SimpleFastMutexLock > lock( instance->m_Lock );
+  ReleaseCachedPlanOfMap( instance->m_DoublePlans, plan );
+  instance->EvictCachedPlans();
+}
+#endif
+
+void
+FFTWGlobalConfiguration
+::ClearPlanCache()
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< SimpleFastMutexLock > lock( instance->m_Lock );
+  instance->DestroyCachedPlans(true);
+}
+
+SizeValueType
+FFTWGlobalConfiguration
+::GetNumberOfCachedPlans()
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< SimpleFastMutexLock > lock( instance->m_Lock );
+  SizeValueType numberOfPlans = 0;
+#if defined(ITK_USE_FFTWF)
+  numberOfPlans += instance->m_FloatPlans.size();
+#endif
+#if defined(ITK_USE_FFTWD)
+  numberOfPlans += instance->m_DoublePlans.size();
+#endif
+  return numberOfPlans;
+}
+
+void
+FFTWGlobalConfiguration
+::SetMaximumNumberOfCachedPlans( const SizeValueType & v )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< SimpleFastMutexLock > lock( instance->m_Lock );
+  instance->m_MaximumNumberOfCachedPlans = v;
+  instance->EvictCachedPlans();
+}
+
+SizeValueType
+FFTWGlobalConfiguration
+::GetMaximumNumberOfCachedPlans()
+{
+  return GetInstance()->m_MaximumNumberOfCachedPlans;
+}
+
+void
+FFTWGlobalConfiguration
+::DestroyCachedPlans(bool onlyUnused)
+{
+#if defined(ITK_USE_FFTWF)
+  DestroyCachedPlansOfMap( m_FloatPlans, onlyUnused );
+#endif
+#if defined(ITK_USE_FFTWD)
+  DestroyCachedPlansOfMap( m_DoublePlans, onlyUnused );
+#endif
+}
+
+void
+FFTWGlobalConfiguration
+::EvictCachedPlans()
+{
+  for(;;)
+    {
+    // the use counts are unique, so the least recently used plan is the
+    // one whose last use is the oldest
+    SizeValueType numberOfPlans = 0;
+    SizeValueType lastUse = NumericTraits< SizeValueType >::max();
+#if defined(ITK_USE_FFTWF)
+    numberOfPlans += m_FloatPlans.size();
+    std::map< PlanKey, CachedPlan< fftwf_plan > >::iterator floatIt = LeastRecentlyUsedPlan( m_FloatPlans );
+    if( floatIt != m_FloatPlans.end() )
+      {
+      lastUse = std::min( lastUse, floatIt->second.LastUse );
+      }
+#endif
+#if defined(ITK_USE_FFTWD)
+    numberOfPlans += m_DoublePlans.size();
+    std::map< PlanKey, CachedPlan< fftw_plan > >::iterator doubleIt = LeastRecentlyUsedPlan( m_DoublePlans );
+    if( doubleIt != m_DoublePlans.end() )
+      {
+      lastUse = std::min( lastUse, doubleIt->second.LastUse );
+      }
+#endif
+    if( numberOfPlans <= m_MaximumNumberOfCachedPlans )
+      {
+      return;
+      }
+#if defined(ITK_USE_FFTWF)
+    if( floatIt != m_FloatPlans.end() && floatIt->second.LastUse == lastUse )
+      {
+      fftwf_destroy_plan( floatIt->second.Plan );
+      m_FloatPlans.erase( floatIt );
+      continue;
+      }
+#endif
+#if defined(ITK_USE_FFTWD)
+    if( doubleIt != m_DoublePlans.end() && doubleIt->second.LastUse == lastUse )
+      {
+      fftw_destroy_plan( doubleIt->second.Plan );
+      m_DoublePlans.erase( doubleIt );
+      continue;
+      }
+#endif
+    // all the plans are being used: they will be evicted when released
+    return;
+    }
+}
+
 }//end namespace itk
 
 #endif
@@ -0,0 +1,135 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFFTWRealToHalfHermitianForwardFFTImageFilter.h"
+#include "itkFFTWHalfHermitianToRealInverseFFTImageFilter.h"
+#include "itkImageRegionIterator.h"
+
+// Check that the FFTW filters reuse the cached plans for the images of
+// the same size, and that the cached plans produce the right output when
+// executed on other buffers than the ones used to create them, and that
+// the cache does not grow past its maximum size.
+
+int itkFFTWD_PlanCacheTest(int, char* [] )
+{
+  typedef itk::Image< double, 2 >                                               ImageType;
+  typedef itk::Image< std::complex< double >, 2 >                               ComplexImageType;
+  typedef itk::FFTWRealToHalfHermitianForwardFFTImageFilter< ImageType >        ForwardFilterType;
+  typedef itk::FFTWHalfHermitianToRealInverseFFTImageFilter< ComplexImageType > InverseFilterType;
+
+  itk::FFTWGlobalConfiguration::ClearPlanCache();
+
+  ImageType::SizeType size = { { 30, 21 } };
+  unsigned int        seed = 12345;
+  itk::SizeValueType  numberOfPlans = 0;
+  for ( unsigned int i = 0; i < 4; i++ )
+    {
+    ImageType::Pointer image = ImageType::New();
+    image->SetRegions( size );
+    image->Allocate();
+    itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      seed = seed * 1103515245 + 12345;
+      it.Set( ( seed >> 16 ) % 100 );
+      }
+
+    ForwardFilterType::Pointer forward = ForwardFilterType::New();
+    forward->SetInput( image );
+    InverseFilterType::Pointer inverse = InverseFilterType::New();
+    inverse->SetInput( forward->GetOutput() );
+    inverse->SetActualXDimensionIsOdd( size[0] % 2 );
+    inverse->Update();
+
+    // the image is restored by the inverse transform
+    itk::ImageRegionIterator< ImageType > oit( inverse->GetOutput(), image->GetLargestPossibleRegion() );
+    for ( it.GoToBegin(); !it.IsAtEnd(); ++it, ++oit )
+      {
+      if ( std::abs( it.Get() - oit.Get() ) > 1e-6 )
+        {
+        std::cerr << "Wrong value at " << it.GetIndex() << " in iteration " << i << ": expected "
+                  << it.Get() << ", got " << oit.Get() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    // one plan in each direction, created only once
+    if ( i == 0 )
+      {
+      numberOfPlans = itk::FFTWGlobalConfiguration::GetNumberOfCachedPlans();
+      if ( numberOfPlans == 0 )
+        {
+        std::cerr << "No plan has been cached" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    else if ( itk::FFTWGlobalConfiguration::GetNumberOfCachedPlans() != numberOfPlans )
+      {
+      std::cerr << "Wrong number of cached plans in iteration " << i << ": expected " << numberOfPlans
+                << ", got " << itk::FFTWGlobalConfiguration::GetNumberOfCachedPlans() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the least recently used plans are destroyed when the cache is full
+  const itk::SizeValueType maximumNumberOfPlans = itk::FFTWGlobalConfiguration::GetMaximumNumberOfCachedPlans();
+  itk::FFTWGlobalConfiguration::SetMaximumNumberOfCachedPlans( numberOfPlans );
+  for ( unsigned int i = 1; i < 4; i++ )
+    {
+    ImageType::SizeType otherSize = { { 30 + i, 21 } };
+    ImageType::Pointer  image = ImageType::New();
+    image->SetRegions( otherSize );
+    image->Allocate();
+    image->FillBuffer( i );
+
+    ForwardFilterType::Pointer forward = ForwardFilterType::New();
+    forward->SetInput( image );
+    forward->Update();
+    if ( itk::FFTWGlobalConfiguration::GetNumberOfCachedPlans() > numberOfPlans )
+      {
+      std::cerr << "Too many cached plans for size " << otherSize << ": expected at most " << numberOfPlans
+                << ", got " << itk::FFTWGlobalConfiguration::GetNumberOfCachedPlans() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  itk::FFTWGlobalConfiguration::SetMaximumNumberOfCachedPlans( 0 );
+  if ( itk::FFTWGlobalConfiguration::GetNumberOfCachedPlans() != 0 )
+    {
+    std::cerr << "The plan cache has not been emptied by a maximum of 0 plans" << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::FFTWGlobalConfiguration::SetMaximumNumberOfCachedPlans( maximumNumberOfPlans );
+
+  ForwardFilterType::Pointer forward = ForwardFilterType::New();
+  ImageType::Pointer         image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  image->FillBuffer( 1 );
+  forward->SetInput( image );
+  forward->Update();
+  itk::FFTWGlobalConfiguration::ClearPlanCache();
+  if ( itk::FFTWGlobalConfiguration::GetNumberOfCachedPlans() != 0 )
+    {
+    std::cerr << "The plan cache has not been cleared" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,180 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef itkParallelFastSweepingImageFilterBase_h
+#define itkParallelFastSweepingImageFilterBase_h
+
+#include "itkFastMarchingImageFilterBase.h"
+#include "itkMultiThreader.h"
+#include "itkBarrier.h"
+
+namespace itk
+{
+/**
+ * \class ParallelFastSweepingImageFilterBase
+ * \brief Solve the Eikonal equation of FastMarchingImageFilterBase with
+ * several threads, using the fast sweeping method.
+ *
+ * This filter takes the same inputs, alive, trial and forbidden points and
+ * stopping criterion as FastMarchingImageFilterBase, and computes the same
+ * arrival times, unless the front reaches the border of the image (see
+ * below). Instead of moving the front one node at a time in the order of a
+ * priority queue, which is inherently serial, the upwind update of
+ * FastMarchingImageFilterBase::Solve() is iterated over the whole image in
+ * the \f$2^N\f$ diagonal orderings, until no arrival time decreases any
+ * more. Both methods converge to the solution of the same discrete
+ * equations, so that the arrival times only differ by rounding errors.
+ *
+ * At the border of the image, FastMarchingImageFilterBase::UpdateNeighbors()
+ * does not update the neighbor inside the image of a node accepted on the
+ * border, along the dimensions of the border, whereas the sweeps update all
+ * the nodes from all their neighbors. The arrival times of the fast marching
+ * may thus be larger near the border, and wherever the front got there
+ * through the border. Both filters give the same arrival times when the
+ * border of the image is forbidden, and the fast sweeping gives those of
+ * the fast marching through the image padded with a forbidden border.
+ *
+ * Each sweep visits the image one hyperplane \f$ \sum_i \pm x_i = c \f$ at
+ * a time. The nodes of a hyperplane do not depend on each other, and are
+ * updated by several threads. Their upwind neighbors all lie on the
+ * previous hyperplane, so that the results do not depend on the number of
+ * threads.
+ *
+ * Once the arrival times are known, the nodes are accepted in increasing
+ * order of arrival time and given to the stopping criterion, as the fast
+ * marching would do. The nodes following the one which satisfies the
+ * criterion are reset, and those next to the accepted nodes get the trial
+ * values computed from them. The output and the label image are then the
+ * ones of FastMarchingImageFilterBase.
+ *
+ * The number of sweeps depends on the number of turns of the
+ * characteristics: a constant speed needs two rounds of sweeps, whereas a
+ * maze like speed image may need many more. The alive points are sources
+ * of the propagation by themselves, and topology constraints are not
+ * supported.
+ *
+ * Reference: M. Detrixhe, F. Gibou, C. Min, "A parallel fast sweeping
+ * method for the Eikonal equation", Journal of Computational Physics,
+ * 237:46-55, 2013.
+ *
+ * \sa FastMarchingImageFilterBase
+ * \ingroup ITKFastMarching
+*/
+template< typename TInput, typename TOutput >
+class ParallelFastSweepingImageFilterBase :
+    public FastMarchingImageFilterBase< TInput, TOutput >
+  {
+public:
+  typedef ParallelFastSweepingImageFilterBase            Self;
+  typedef FastMarchingImageFilterBase< TInput, TOutput > Superclass;
+  typedef SmartPointer< Self >                           Pointer;
+  typedef SmartPointer< const Self >                     ConstPointer;
+  typedef typename Superclass::Traits                    Traits;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ParallelFastSweepingImageFilterBase, FastMarchingImageFilterBase);
+
+  typedef typename Superclass::OutputImageType      OutputImageType;
+  typedef typename Superclass::OutputPixelType      OutputPixelType;
+  typedef typename Superclass::OutputRegionType     OutputRegionType;
+  typedef typename Superclass::OutputSizeType       OutputSizeType;
+  typedef typename Superclass::LabelImageType       LabelImageType;
+
+  typedef typename Superclass::NodeType             NodeType;
+  typedef typename Superclass::NodePairType         NodePairType;
+
+  typedef typename Superclass::InternalNodeStructureArray
+    InternalNodeStructureArray;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, Traits::ImageDimension );
+
+  /** Get the number of rounds of \f$2^N\f$ sweeps done by the last update,
+   * including the last one, which changes no arrival time. */
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+protected:
+
+  /** Constructor */
+  ParallelFastSweepingImageFilterBase();
+
+  /** Destructor */
+  virtual ~ParallelFastSweepingImageFilterBase();
+
+  /** Compute the arrival times with the sweeps, then accept the nodes in
+   * increasing order until the stopping criterion is satisfied. */
+  void GenerateData() ITK_OVERRIDE;
+
+  /** Do the sweeps assigned to a thread, until the arrival times no longer
+   * change. */
+  void ThreadedSweep( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  /** Update the arrival time of the nodes of a hyperplane assigned to a
+   * thread.  The bits of \c sweep give the directions of the sweep along
+   * each dimension. Returns true if an arrival time decreased. */
+  bool SweepHyperplane( OutputImageType* oImage,
+                        unsigned int sweep,
+                        OffsetValueType level,
+                        ThreadIdType threadId,
+                        ThreadIdType numberOfThreads );
+
+  /** Update the arrival time of a node, at the given offset in the
+   * buffers, from its smallest neighbor along each dimension. Returns true
+   * if it decreased. */
+  bool UpdateNodeFromNeighbors( OutputImageType* oImage,
+                                const NodeType & node,
+                                OffsetValueType offset,
+                                ThreadIdType threadId );
+
+  /** \brief PrintSelf method  */
+  void PrintSelf( std::ostream & os, Indent indent ) const ITK_OVERRIDE;
+
+  unsigned int m_NumberOfIterations;
+
+private:
+  ParallelFastSweepingImageFilterBase( const Self& ); //purposely not implemented
+  void operator = ( const Self& );                    //purposely not implemented
+
+  /** Static callback of the threads doing the sweeps. */
+  static ITK_THREAD_RETURN_TYPE SweepThreaderCallback( void *arg );
+
+  Barrier::Pointer m_Barrier;
+
+  /** Raw access to the output and the labels, whose buffers have the
+   * region of the output. */
+  OutputPixelType *                          m_OutputBuffer;
+  const typename LabelImageType::PixelType * m_LabelBuffer;
+  OffsetValueType                            m_Strides[ImageDimension];
+
+  /** For each round of sweeps, whether a thread changed an arrival time.
+   * The rounds alternate between two sets of flags, so that a thread may
+   * reset its flag of the next round while the others read the flags of
+   * the last one. */
+  std::vector< unsigned char > m_ThreadChanged[2];
+
+  /** Whether Solve() failed in a thread, in which case the node is left
+   * as is. */
+  std::vector< unsigned char > m_ThreadFailed;
+  };
+}
+
+#include "itkParallelFastSweepingImageFilterBase.hxx"
+
+#endif // itkParallelFastSweepingImageFilterBase_h
@@ -0,0 +1,468 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef itkParallelFastSweepingImageFilterBase_hxx
+#define itkParallelFastSweepingImageFilterBase_hxx
+
+#include "itkParallelFastSweepingImageFilterBase.h"
+
+#include "itkProgressReporter.h"
+#include <algorithm>
+
+namespace itk
+{
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+ParallelFastSweepingImageFilterBase< TInput, TOutput >::
+ParallelFastSweepingImageFilterBase() :
+  m_NumberOfIterations( 0 ),
+  m_OutputBuffer( ITK_NULLPTR ),
+  m_LabelBuffer( ITK_NULLPTR )
+  {
+  for ( unsigned int j = 0; j < ImageDimension; j++ )
+    {
+    m_Strides[j] = 0;
+    }
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+ParallelFastSweepingImageFilterBase< TInput, TOutput >::
+~ParallelFastSweepingImageFilterBase()
+  {
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+void
+ParallelFastSweepingImageFilterBase< TInput, TOutput >::
+PrintSelf( std::ostream & os, Indent indent ) const
+  {
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Number of iterations: " << m_NumberOfIterations << std::endl;
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+void
+ParallelFastSweepingImageFilterBase< TInput, TOutput >::
+GenerateData()
+  {
+  if( this->m_TopologyCheck != Superclass::Nothing )
+    {
+    itkExceptionMacro( << "Topology constraints are not supported" );
+    }
+
+  OutputImageType* output = this->GetOutput();
+
+  this->Initialize( output );
+
+  // the trial points are known from the label image: the heap is only used
+  // for the nodes which the front did not reach
+  while( !this->m_Heap.empty() )
+    {
+    this->m_Heap.pop();
+    }
+
+  m_OutputBuffer = output->GetBufferPointer();
+  m_LabelBuffer = this->m_LabelImage->GetBufferPointer();
+  for ( unsigned int j = 0; j < ImageDimension; j++ )
+    {
+    m_Strides[j] = output->GetOffsetTable()[j];
+    }
+
+  // compute the arrival times
+  ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  numberOfThreads = this->GetMultiThreader()->GetNumberOfThreads();
+
+  m_Barrier = Barrier::New();
+  m_Barrier->Initialize( numberOfThreads );
+  m_ThreadChanged[0].assign( numberOfThreads, 0 );
+  m_ThreadChanged[1].assign( numberOfThreads, 0 );
+  m_ThreadFailed.assign( numberOfThreads, 0 );
+
+  this->GetMultiThreader()->SetSingleMethod( this->SweepThreaderCallback, this );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  m_Barrier = ITK_NULLPTR;
+  for ( ThreadIdType i = 0; i < numberOfThreads; i++ )
+    {
+    if ( m_ThreadFailed[i] )
+      {
+      itkExceptionMacro( <<"Discriminant of quadratic equation is negative" );
+      }
+    }
+
+  // sort the nodes reached by the front by arrival time, and by offset for
+  // equal times
+  typedef std::pair< OutputPixelType, OffsetValueType > ArrivalType;
+  std::vector< ArrivalType > arrivals;
+
+  const OffsetValueType numberOfNodes =
+    static_cast< OffsetValueType >( this->m_BufferedRegion.GetNumberOfPixels() );
+  for ( OffsetValueType offset = 0; offset < numberOfNodes; offset++ )
+    {
+    if ( ( m_LabelBuffer[offset] == Traits::Far && m_OutputBuffer[offset] < this->m_LargeValue ) ||
+         m_LabelBuffer[offset] == Traits::InitialTrial )
+      {
+      arrivals.push_back( ArrivalType( m_OutputBuffer[offset], offset ) );
+      }
+    }
+  std::sort( arrivals.begin(), arrivals.end() );
+
+  // accept the nodes in the order of the fast marching, until the stopping
+  // criterion is satisfied
+  OutputPixelType current_value = 0.;
+
+  ProgressReporter progress( this, 0, this->GetTotalNumberOfNodes() );
+
+  this->m_StoppingCriterion->Reinitialize();
+
+  typename std::vector< ArrivalType >::const_iterator arrivalIt = arrivals.begin();
+  while( arrivalIt != arrivals.end() )
+    {
+    const NodePairType current_node_pair( output->ComputeIndex( arrivalIt->second ),
+                                          arrivalIt->first );
+    current_value = current_node_pair.GetValue();
+
+    this->m_StoppingCriterion->SetCurrentNodePair( current_node_pair );
+
+    if( this->m_StoppingCriterion->IsSatisfied() )
+      {
+      break;
+      }
+
+    if ( this->m_CollectPoints )
+      {
+      this->m_ProcessedPoints->push_back( current_node_pair );
+      }
+
+    // set this node as alive
+    this->SetLabelValueForGivenNode( current_node_pair.GetNode(), Traits::Alive );
+
+    progress.CompletedPixel();
+    ++arrivalIt;
+    }
+
+  this->m_TargetReachedValue = current_value;
+
+  // the front stopped before the remaining nodes, which keep the values
+  // computed from their alive neighbors only, if any
+  const typename std::vector< ArrivalType >::const_iterator stopIt = arrivalIt;
+  for ( arrivalIt = stopIt; arrivalIt != arrivals.end(); ++arrivalIt )
+    {
+    if ( m_LabelBuffer[arrivalIt->second] == Traits::Far )
+      {
+      m_OutputBuffer[arrivalIt->second] = this->m_LargeValue;
+      }
+    }
+  for ( arrivalIt = stopIt; arrivalIt != arrivals.end(); ++arrivalIt )
+    {
+    const OffsetValueType offset = arrivalIt->second;
+    if ( m_LabelBuffer[offset] != Traits::Far )
+      {
+      continue;
+      }
+    const NodeType node = output->ComputeIndex( offset );
+    bool nextToAlive = false;
+    for ( unsigned int j = 0; j < ImageDimension; j++ )
+      {
+      if ( ( node[j] > this->m_StartIndex[j] && m_LabelBuffer[offset - m_Strides[j]] == Traits::Alive ) ||
+           ( node[j] < this->m_LastIndex[j] && m_LabelBuffer[offset + m_Strides[j]] == Traits::Alive ) )
+        {
+        nextToAlive = true;
+        }
+      }
+    if ( nextToAlive )
+      {
+      this->UpdateValue( output, node );
+      }
+    }
+
+  // let's release some useless memory...
+  while( !this->m_Heap.empty() )
+    {
+    this->m_Heap.pop();
+    }
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+ITK_THREAD_RETURN_TYPE
+ParallelFastSweepingImageFilterBase< TInput, TOutput >::
+SweepThreaderCallback( void *arg )
+  {
+  MultiThreader::ThreadInfoStruct *threadInfo =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self *filter = static_cast< Self * >( threadInfo->UserData );
+
+  filter->ThreadedSweep( threadInfo->ThreadID, threadInfo->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+void
+ParallelFastSweepingImageFilterBase< TInput, TOutput >::
+ThreadedSweep( ThreadIdType threadId, ThreadIdType numberOfThreads )
+  {
+  OutputImageType* output = this->GetOutput();
+
+  const OutputSizeType size = this->m_BufferedRegion.GetSize();
+  OffsetValueType numberOfLevels = 1;
+  for ( unsigned int j = 0; j < ImageDimension; j++ )
+    {
+    numberOfLevels += static_cast< OffsetValueType >( size[j] ) - 1;
+    }
+  const unsigned int numberOfSweeps = 1u << ImageDimension;
+
+  unsigned int iteration = 0;
+  bool changed = true;
+  while( changed )
+    {
+    const unsigned int flags = iteration % 2;
+    m_ThreadChanged[flags][threadId] = 0;
+
+    for ( unsigned int sweep = 0; sweep < numberOfSweeps; sweep++ )
+      {
+      for ( OffsetValueType level = 0; level < numberOfLevels; level++ )
+        {
+        if ( this->SweepHyperplane( output, sweep, level, threadId, numberOfThreads ) )
+          {
+          m_ThreadChanged[flags][threadId] = 1;
+          }
+        // the next hyperplane depends on this one
+        if ( numberOfThreads > 1 )
+          {
+          m_Barrier->Wait();
+          }
+        }
+      }
+
+    // every thread takes the same decision from the flags of all of them
+    changed = false;
+    for ( ThreadIdType i = 0; i < numberOfThreads; i++ )
+      {
+      if ( m_ThreadChanged[flags][i] )
+        {
+        changed = true;
+        }
+      }
+    ++iteration;
+    }
+
+  if ( threadId == 0 )
+    {
+    m_NumberOfIterations = iteration;
+    }
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+bool
+ParallelFastSweepingImageFilterBase< TInput, TOutput >::
+SweepHyperplane( OutputImageType* oImage,
+                 unsigned int sweep,
+                 OffsetValueType level,
+                 ThreadIdType threadId,
+                 ThreadIdType numberOfThreads )
+  {
+  const OutputSizeType size = this->m_BufferedRegion.GetSize();
+
+  // the largest sum of the coordinates along the dimensions after each one
+  OffsetValueType remainingExtents[ImageDimension];
+  OffsetValueType extent = 0;
+  for ( int j = ImageDimension - 1; j >= 0; j-- )
+    {
+    remainingExtents[j] = extent;
+    extent += static_cast< OffsetValueType >( size[j] ) - 1;
+    }
+
+  // the coordinates along the directions of the sweep, whose sum is the
+  // level, and the part of the level left for the dimensions after each one
+  OffsetValueType coordinates[ImageDimension];
+  OffsetValueType lastCoordinates[ImageDimension];
+  OffsetValueType remainders[ImageDimension];
+
+  bool changed = false;
+
+  // the threads take the coordinates along the first dimension in turn
+  const OffsetValueType step = static_cast< OffsetValueType >( numberOfThreads );
+  OffsetValueType first = std::max< OffsetValueType >( level - remainingExtents[0], 0 );
+  const OffsetValueType last =
+    std::min< OffsetValueType >( static_cast< OffsetValueType >( size[0] ) - 1, level );
+  if ( ImageDimension == 1 )
+    {
+    if ( threadId != 0 )
+      {
+      return false;
+      }
+    }
+  else
+    {
+    first += ( static_cast< OffsetValueType >( threadId ) - first % step + step ) % step;
+    }
+
+  for ( coordinates[0] = first; coordinates[0] <= last; coordinates[0] += step )
+    {
+    if ( ImageDimension > 1 )
+      {
+      remainders[1] = level - coordinates[0];
+      }
+
+    unsigned int j = 1;
+    while( true )
+      {
+      // the first coordinates of the dimensions from j on, the last one
+      // being given by the level
+      for ( ; j + 1 < ImageDimension; j++ )
+        {
+        coordinates[j] = std::max< OffsetValueType >( remainders[j] - remainingExtents[j], 0 );
+        lastCoordinates[j] =
+          std::min< OffsetValueType >( static_cast< OffsetValueType >( size[j] ) - 1, remainders[j] );
+        remainders[j + 1] = remainders[j] - coordinates[j];
+        }
+      if ( ImageDimension > 1 )
+        {
+        coordinates[ImageDimension - 1] = remainders[ImageDimension - 1];
+        }
+
+      NodeType node;
+      OffsetValueType offset = 0;
+      for ( unsigned int k = 0; k < ImageDimension; k++ )
+        {
+        const OffsetValueType position = ( sweep & ( 1u << k ) ) ?
+          static_cast< OffsetValueType >( size[k] ) - 1 - coordinates[k] : coordinates[k];
+        node[k] = this->m_StartIndex[k] + position;
+        offset += position * m_Strides[k];
+        }
+      if ( this->UpdateNodeFromNeighbors( oImage, node, offset, threadId ) )
+        {
+        changed = true;
+        }
+
+      // next coordinates in the hyperplane
+      if ( ImageDimension < 3 )
+        {
+        break;
+        }
+      j = ImageDimension - 2;
+      while( j > 0 && coordinates[j] == lastCoordinates[j] )
+        {
+        j--;
+        }
+      if ( j == 0 )
+        {
+        break;
+        }
+      coordinates[j]++;
+      remainders[j + 1] = remainders[j] - coordinates[j];
+      j++;
+      }
+    }
+
+  return changed;
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+bool
+ParallelFastSweepingImageFilterBase< TInput, TOutput >::
+UpdateNodeFromNeighbors( OutputImageType* oImage,
+                         const NodeType& iNode,
+                         OffsetValueType offset,
+                         ThreadIdType threadId )
+  {
+  // the alive, initial trial and forbidden nodes keep their values
+  if ( m_LabelBuffer[offset] != Traits::Far )
+    {
+    return false;
+    }
+
+  InternalNodeStructureArray neighbors;
+  bool reached = false;
+
+  for ( unsigned int j = 0; j < ImageDimension; j++ )
+    {
+    OutputPixelType value = this->m_LargeValue;
+
+    // find smallest valued neighbor in this dimension
+    if ( iNode[j] > this->m_StartIndex[j] )
+      {
+      const OffsetValueType neighbor = offset - m_Strides[j];
+      if ( m_LabelBuffer[neighbor] != Traits::Forbidden && m_OutputBuffer[neighbor] < value )
+        {
+        value = m_OutputBuffer[neighbor];
+        }
+      }
+    if ( iNode[j] < this->m_LastIndex[j] )
+      {
+      const OffsetValueType neighbor = offset + m_Strides[j];
+      if ( m_LabelBuffer[neighbor] != Traits::Forbidden && m_OutputBuffer[neighbor] < value )
+        {
+        value = m_OutputBuffer[neighbor];
+        }
+      }
+
+    if ( value < this->m_LargeValue )
+      {
+      reached = true;
+      }
+    neighbors[j].m_Value = value;
+    neighbors[j].m_Axis = j;
+    }
+
+  if ( !reached )
+    {
+    return false;
+    }
+
+  double solution;
+  try
+    {
+    solution = this->Solve( oImage, iNode, neighbors );
+    }
+  catch ( ExceptionObject & )
+    {
+    // the exception is thrown again once the threads are done
+    m_ThreadFailed[threadId] = 1;
+    return false;
+    }
+
+  const OutputPixelType outputPixel = static_cast< OutputPixelType >( solution );
+  if ( outputPixel < m_OutputBuffer[offset] )
+    {
+    m_OutputBuffer[offset] = outputPixel;
+    return true;
+    }
+  return false;
+  }
+// -----------------------------------------------------------------------------
+
+} // end of namespace itk
+
+#endif // itkParallelFastSweepingImageFilterBase_hxx
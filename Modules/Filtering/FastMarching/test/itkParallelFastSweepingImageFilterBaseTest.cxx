@@ -0,0 +1,264 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkParallelFastSweepingImageFilterBase.h"
+#include "itkFastMarchingThresholdStoppingCriterion.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Propagate a front from two seeds through a speed image with a slow wall,
+ * which the front has to go round, and forbidden points, with the fast
+ * marching and with the fast sweeping. The arrival times must be the same
+ * up to rounding errors, and the fast sweeping must give the same results
+ * with one thread and with several threads. Without forbidden border, the
+ * fast sweeping must give the arrival times of the fast marching through
+ * an image padded with a forbidden border.
+ */
+
+namespace
+{
+const unsigned int Dimension = 3;
+typedef float                                PixelType;
+typedef itk::Image< PixelType, Dimension >   FloatImageType;
+
+typedef itk::FastMarchingImageFilterBase< FloatImageType, FloatImageType >         FastMarchingType;
+typedef itk::ParallelFastSweepingImageFilterBase< FloatImageType, FloatImageType > FastSweepingType;
+typedef itk::FastMarchingThresholdStoppingCriterion< FloatImageType, FloatImageType >
+  CriterionType;
+
+typedef FastMarchingType::NodePairType           NodePairType;
+typedef FastMarchingType::NodePairContainerType  NodePairContainerType;
+typedef FastMarchingType::LabelImageType         LabelImageType;
+
+/** Speed image with a slow wall and a hole in it. */
+FloatImageType::Pointer ParallelFastSweepingImageFilterBaseTestSpeed( const FloatImageType::RegionType & region )
+{
+  FloatImageType::Pointer speedImage = FloatImageType::New();
+  speedImage->SetRegions( region );
+  FloatImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 1.5;
+  spacing[2] = 0.8;
+  speedImage->SetSpacing( spacing );
+  speedImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< FloatImageType > it( speedImage, region );
+  for(; !it.IsAtEnd(); ++it )
+    {
+    const FloatImageType::IndexType index = it.GetIndex();
+    float speed = 1.0f + 0.5f * std::sin( 0.4f * index[0] + 0.3f * index[2] );
+    if( index[1] == 10 && ( index[0] > 5 || index[2] > 4 ) )
+      {
+      speed = 0.01f;
+      }
+    it.Set( speed );
+    }
+  return speedImage;
+}
+
+template< typename TFilter >
+void ParallelFastSweepingImageFilterBaseTestSetUp( TFilter * filter,
+                                                   FloatImageType * speedImage,
+                                                   double threshold,
+                                                   bool forbiddenBorder )
+{
+  NodePairContainerType::Pointer alive = NodePairContainerType::New();
+  NodePairContainerType::Pointer trial = NodePairContainerType::New();
+  const itk::IndexValueType seeds[2][Dimension] = { { 4, 5, 3 }, { 25, 14, 11 } };
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    FloatImageType::IndexType index;
+    for( unsigned int j = 0; j < Dimension; ++j )
+      {
+      index[j] = seeds[i][j];
+      }
+    alive->push_back( NodePairType( index, 0.0 ) );
+    for( unsigned int j = 0; j < Dimension; ++j )
+      {
+      for( int s = -1; s < 2; s += 2 )
+        {
+        FloatImageType::IndexType neighbor = index;
+        neighbor[j] += s;
+        trial->push_back( NodePairType( neighbor, 1.0 / speedImage->GetPixel( neighbor ) ) );
+        }
+      }
+    }
+
+  // forbidden points in a slab, and optionally on the border of the image,
+  // where the fast marching does not update the neighbors along the
+  // dimensions of the border
+  NodePairContainerType::Pointer forbidden = NodePairContainerType::New();
+  const FloatImageType::RegionType region = speedImage->GetBufferedRegion();
+  itk::ImageRegionConstIteratorWithIndex< FloatImageType > it( speedImage, region );
+  for(; !it.IsAtEnd(); ++it )
+    {
+    const FloatImageType::IndexType index = it.GetIndex();
+    bool isForbidden = ( index[0] == 14 && index[1] < 6 );
+    for( unsigned int j = 0; j < Dimension; ++j )
+      {
+      if( forbiddenBorder &&
+          ( index[j] == region.GetIndex()[j] ||
+            index[j] == region.GetIndex()[j] + static_cast< itk::IndexValueType >( region.GetSize()[j] ) - 1 ) )
+        {
+        isForbidden = true;
+        }
+      }
+    if( isForbidden )
+      {
+      forbidden->push_back( NodePairType( index, 0.0 ) );
+      }
+    }
+
+  typename CriterionType::Pointer criterion = CriterionType::New();
+  criterion->SetThreshold( threshold );
+
+  filter->SetInput( speedImage );
+  filter->SetAlivePoints( alive );
+  filter->SetTrialPoints( trial );
+  filter->SetForbiddenPoints( forbidden );
+  filter->SetStoppingCriterion( criterion );
+}
+
+bool ParallelFastSweepingImageFilterBaseTestCompare( const FloatImageType * output1,
+                                                     const LabelImageType * labels1,
+                                                     const FloatImageType * output2,
+                                                     const LabelImageType * labels2,
+                                                     double tolerance,
+                                                     const char * name )
+{
+  // the second images may be larger than the first ones
+  itk::ImageRegionConstIteratorWithIndex< FloatImageType > it1( output1, output1->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< LabelImageType >          lit1( labels1, labels1->GetBufferedRegion() );
+  for(; !it1.IsAtEnd(); ++it1, ++lit1 )
+    {
+    const FloatImageType::IndexType index = it1.GetIndex();
+    const PixelType                 value2 = output2->GetPixel( index );
+    const unsigned char             label2 = labels2->GetPixel( index );
+    if( lit1.Get() != label2 ||
+        std::fabs( it1.Get() - value2 ) > tolerance * std::max( 1.0f, std::fabs( it1.Get() ) ) )
+      {
+      std::cerr << name << ": different result at " << index << ": "
+                << it1.Get() << " (label " << static_cast< int >( lit1.Get() ) << ") instead of "
+                << value2 << " (label " << static_cast< int >( label2 ) << ")" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkParallelFastSweepingImageFilterBaseTest( int, char *[] )
+{
+  FloatImageType::SizeType size = {{ 30, 20, 16 }};
+  FloatImageType::RegionType region( size );
+  FloatImageType::Pointer speedImage = ParallelFastSweepingImageFilterBaseTestSpeed( region );
+
+  // the same speed image with one more node on each side
+  FloatImageType::RegionType paddedRegion = region;
+  paddedRegion.PadByRadius( 1 );
+  FloatImageType::Pointer paddedSpeedImage = ParallelFastSweepingImageFilterBaseTestSpeed( paddedRegion );
+
+  // propagate to the whole image, then stop the front at a threshold
+  const double thresholds[2] = { 1000.0, 12.5 };
+  for( unsigned int t = 0; t < 2; ++t )
+    {
+    FastMarchingType::Pointer marcher = FastMarchingType::New();
+    ParallelFastSweepingImageFilterBaseTestSetUp( marcher.GetPointer(), speedImage, thresholds[t], true );
+    marcher->Update();
+
+    FloatImageType::Pointer outputs[2];
+    LabelImageType::Pointer labels[2];
+    const itk::ThreadIdType numbersOfThreads[2] = { 1, 4 };
+    for( unsigned int i = 0; i < 2; ++i )
+      {
+      FastSweepingType::Pointer sweeper = FastSweepingType::New();
+      ParallelFastSweepingImageFilterBaseTestSetUp( sweeper.GetPointer(), speedImage, thresholds[t], true );
+      sweeper->SetNumberOfThreads( numbersOfThreads[i] );
+      sweeper->Update();
+      std::cout << "Threshold " << thresholds[t] << ", " << numbersOfThreads[i] << " threads: "
+                << sweeper->GetNumberOfIterations() << " iterations, stopped at "
+                << sweeper->GetTargetReachedValue();
+      if( sweeper->GetTargetReachedValue() != marcher->GetTargetReachedValue() )
+        {
+        std::cout << " instead of " << marcher->GetTargetReachedValue();
+        }
+      std::cout << std::endl;
+      if( sweeper->GetNumberOfIterations() < 3 )
+        {
+        std::cerr << "The front should need more than one round of sweeps to go round the wall" << std::endl;
+        return EXIT_FAILURE;
+        }
+      outputs[i] = sweeper->GetOutput();
+      labels[i] = sweeper->GetLabelImage();
+      if( !ParallelFastSweepingImageFilterBaseTestCompare( outputs[i], labels[i],
+                                                           marcher->GetOutput(), marcher->GetLabelImage(),
+                                                           1e-4, "Fast marching" ) )
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    if( !ParallelFastSweepingImageFilterBaseTestCompare( outputs[1], labels[1], outputs[0], labels[0],
+                                                         0.0, "Several threads" ) )
+      {
+      return EXIT_FAILURE;
+      }
+
+    // the fast marching does not step inward from the nodes of the border
+    // of the image, the fast sweeping does: without forbidden border, it
+    // gives the arrival times of the fast marching through the padded
+    // image, where these nodes are inside and the padding is forbidden
+    FastMarchingType::Pointer paddedMarcher = FastMarchingType::New();
+    ParallelFastSweepingImageFilterBaseTestSetUp( paddedMarcher.GetPointer(), paddedSpeedImage, thresholds[t], true );
+    paddedMarcher->Update();
+
+    FastSweepingType::Pointer sweeper = FastSweepingType::New();
+    ParallelFastSweepingImageFilterBaseTestSetUp( sweeper.GetPointer(), speedImage, thresholds[t], false );
+    sweeper->SetNumberOfThreads( 4 );
+    sweeper->Update();
+    std::cout << "Threshold " << thresholds[t] << ", no forbidden border: "
+              << sweeper->GetNumberOfIterations() << " iterations" << std::endl;
+    if( !ParallelFastSweepingImageFilterBaseTestCompare( sweeper->GetOutput(), sweeper->GetLabelImage(),
+                                                         paddedMarcher->GetOutput(), paddedMarcher->GetLabelImage(),
+                                                         1e-4, "No forbidden border" ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // topology constraints are not supported
+  FastSweepingType::Pointer sweeper = FastSweepingType::New();
+  ParallelFastSweepingImageFilterBaseTestSetUp( sweeper.GetPointer(), speedImage, 10.0, true );
+  sweeper->SetTopologyCheck( FastSweepingType::Strict );
+  bool caught = false;
+  try
+    {
+    sweeper->Update();
+    }
+  catch( itk::ExceptionObject & excep )
+    {
+    std::cout << "Expected exception: " << excep.GetDescription() << std::endl;
+    caught = true;
+    }
+  if( !caught )
+    {
+    std::cerr << "No exception with a topology check" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
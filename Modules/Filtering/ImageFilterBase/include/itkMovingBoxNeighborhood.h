@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMovingBoxNeighborhood_h
+#define itkMovingBoxNeighborhood_h
+
+#include "itkImageRegion.h"
+#include "itkFixedArray.h"
+
+#include <vector>
+
+namespace itk
+{
+/** \class MovingBoxNeighborhood
+ * \brief Moves a box neighborhood over a region and updates a histogram.
+ *
+ * The center of the box visits all the pixels of a region in
+ * boustrophedon order: along the first dimension, then one step in the
+ * second dimension, back along the first dimension, and so on. Each step
+ * only adds to the histogram the (N-1)-dimensional face of pixels
+ * entering the box and removes the face leaving it, so the cost per pixel
+ * is proportional to the size of a face of the box instead of the size of
+ * the box. No histogram copy or reset is required between the lines.
+ *
+ * The pixels outside the buffered region of the image are replaced by
+ * the nearest pixel of the buffered region, so the content of the
+ * histogram is the same as the content of a ConstNeighborhoodIterator
+ * using a ZeroFluxNeumannBoundaryCondition.
+ *
+ * The histogram type only needs to provide the AddPixel() and
+ * RemovePixel() methods used by MovingHistogramImageFilter. The typical
+ * use is
+ *
+ * \code
+ * MovingBoxNeighborhood< ImageType > box( image, radius, region );
+ * box.Initialize( histogram );
+ * do
+ *   {
+ *   output->SetPixel( box.GetIndex(), histogram.GetValue() );
+ *   }
+ * while( box.Next( histogram ) );
+ * \endcode
+ *
+ * \sa MovingHistogramImageFilter
+ * \ingroup ITKImageFilterBase
+ */
+template< typename TImage >
+class MovingBoxNeighborhood
+{
+public:
+  typedef TImage                                    ImageType;
+  typedef typename ImageType::PixelType             PixelType;
+  typedef typename ImageType::InternalPixelType     InternalPixelType;
+  typedef typename ImageType::RegionType            RegionType;
+  typedef typename ImageType::IndexType             IndexType;
+  typedef typename ImageType::SizeType              RadiusType;
+  typedef typename ImageType::OffsetValueType       OffsetValueType;
+  typedef typename ImageType::NeighborhoodAccessorFunctorType NeighborhoodAccessorFunctorType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TImage::ImageDimension);
+
+  /** region must not be empty and must be inside the buffered region of
+   * image. */
+  MovingBoxNeighborhood(const ImageType *image, const RadiusType & radius, const RegionType & region);
+
+  /** Add the pixels of the box centered on the first pixel of the region
+   * to histogram. */
+  template< typename THistogram >
+  void Initialize(THistogram & histogram);
+
+  /** Move the center of the box to the next pixel of the region and
+   * update histogram. Returns false when all the pixels of the region
+   * have been visited. */
+  template< typename THistogram >
+  bool Next(THistogram & histogram);
+
+  /** Index of the current center of the box. */
+  const IndexType & GetIndex() const
+  {
+    return m_Index;
+  }
+
+private:
+  /** Add (or remove) all the pixels in the box starting at lower and of
+   * the given size, after clamping their index to the buffered region. */
+  template< typename THistogram >
+  void VisitBox(THistogram & histogram, const IndexType & lower, const RadiusType & size, bool add);
+
+  const InternalPixelType *                     m_Buffer;
+  NeighborhoodAccessorFunctorType               m_Accessor;
+  RegionType                                    m_BufferedRegion;
+  RadiusType                                    m_Radius;
+  RegionType                                    m_Region;
+  IndexType                                     m_Index;
+  FixedArray< OffsetValueType, ImageDimension > m_Strides;
+  FixedArray< int, ImageDimension >             m_Direction;
+
+  std::vector< OffsetValueType > m_Contributions[ImageDimension];
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMovingBoxNeighborhood.hxx"
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMovingBoxNeighborhood_hxx
+#define itkMovingBoxNeighborhood_hxx
+
+#include "itkMovingBoxNeighborhood.h"
+
+namespace itk
+{
+template< typename TImage >
+MovingBoxNeighborhood< TImage >
+::MovingBoxNeighborhood(const ImageType *image, const RadiusType & radius, const RegionType & region)
+{
+  m_Buffer = image->GetBufferPointer();
+  m_Accessor = image->GetNeighborhoodAccessor();
+  m_Accessor.SetBegin(m_Buffer);
+  m_BufferedRegion = image->GetBufferedRegion();
+  m_Radius = radius;
+  m_Region = region;
+  m_Index = region.GetIndex();
+
+  const OffsetValueType *offsetTable = image->GetOffsetTable();
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    m_Strides[i] = offsetTable[i];
+    m_Direction[i] = 1;
+    m_Contributions[i].reserve(2 * radius[i] + 1);
+    }
+}
+
+template< typename TImage >
+template< typename THistogram >
+void
+MovingBoxNeighborhood< TImage >
+::Initialize(THistogram & histogram)
+{
+  m_Index = m_Region.GetIndex();
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    m_Direction[i] = 1;
+    }
+
+  IndexType  lower;
+  RadiusType size;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    lower[i] = m_Index[i] - static_cast< OffsetValueType >( m_Radius[i] );
+    size[i] = 2 * m_Radius[i] + 1;
+    }
+  this->VisitBox(histogram, lower, size, true);
+}
+
+template< typename TImage >
+template< typename THistogram >
+bool
+MovingBoxNeighborhood< TImage >
+::Next(THistogram & histogram)
+{
+  // find the first dimension in which a step can be done in the current
+  // direction. The direction is reversed in all the dimensions before it.
+  unsigned int dim = 0;
+  while ( dim < ImageDimension )
+    {
+    const OffsetValueType next = m_Index[dim] + m_Direction[dim];
+    if ( next >= m_Region.GetIndex()[dim]
+         && next < m_Region.GetIndex()[dim] + static_cast< OffsetValueType >( m_Region.GetSize()[dim] ) )
+      {
+      break;
+      }
+    m_Direction[dim] = -m_Direction[dim];
+    ++dim;
+    }
+  if ( dim == ImageDimension )
+    {
+    return false;
+    }
+
+  // the face at -direction * radius leaves the box, the one at
+  // direction * (radius + 1) enters it
+  const OffsetValueType step = m_Direction[dim];
+  const OffsetValueType radius = static_cast< OffsetValueType >( m_Radius[dim] );
+  IndexType  lower;
+  RadiusType size;
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    lower[i] = m_Index[i] - static_cast< OffsetValueType >( m_Radius[i] );
+    size[i] = 2 * m_Radius[i] + 1;
+    }
+  size[dim] = 1;
+
+  lower[dim] = m_Index[dim] + step * ( radius + 1 );
+  this->VisitBox(histogram, lower, size, true);
+  lower[dim] = m_Index[dim] - step * radius;
+  this->VisitBox(histogram, lower, size, false);
+
+  m_Index[dim] += step;
+  return true;
+}
+
+template< typename TImage >
+template< typename THistogram >
+void
+MovingBoxNeighborhood< TImage >
+::VisitBox(THistogram & histogram, const IndexType & lower, const RadiusType & size, bool add)
+{
+  // offset of each coordinate of the box in the buffer, clamped to the
+  // buffered region
+  const IndexType  bufferIndex = m_BufferedRegion.GetIndex();
+  const RadiusType bufferSize = m_BufferedRegion.GetSize();
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    const OffsetValueType last = static_cast< OffsetValueType >( bufferSize[i] ) - 1;
+    m_Contributions[i].resize(size[i]);
+    for ( SizeValueType j = 0; j < size[i]; j++ )
+      {
+      OffsetValueType c = lower[i] + static_cast< OffsetValueType >( j ) - bufferIndex[i];
+      c = c < 0 ? 0 : ( c > last ? last : c );
+      m_Contributions[i][j] = c * m_Strides[i];
+      }
+    }
+
+  // odometer over the dimensions above the first one
+  FixedArray< SizeValueType, ImageDimension > counter;
+  counter.Fill(0);
+  const OffsetValueType *first = &( m_Contributions[0][0] );
+  const SizeValueType    firstSize = size[0];
+  for (;; )
+    {
+    OffsetValueType base = 0;
+    for ( unsigned int i = 1; i < ImageDimension; i++ )
+      {
+      base += m_Contributions[i][counter[i]];
+      }
+    const InternalPixelType *line = m_Buffer + base;
+    if ( add )
+      {
+      for ( SizeValueType j = 0; j < firstSize; j++ )
+        {
+        histogram.AddPixel( m_Accessor.Get(line + first[j]) );
+        }
+      }
+    else
+      {
+      for ( SizeValueType j = 0; j < firstSize; j++ )
+        {
+        histogram.RemovePixel( m_Accessor.Get(line + first[j]) );
+        }
+      }
+
+    unsigned int i = 1;
+    while ( i < ImageDimension )
+      {
+      if ( ++counter[i] < size[i] )
+        {
+        break;
+        }
+      counter[i] = 0;
+      ++i;
+      }
+    if ( i >= ImageDimension )
+      {
+      break;
+      }
+    }
+}
+} // end namespace itk
+
+#endif
@@ -260,6 +260,21 @@ private:
 };
 
 
+/** \class VectorRankHistogram
+ * \brief Rank histogram of small integer pixel types stored in a vector.
+ *
+ * The counts are kept on two levels, as proposed by Perreault and
+ * Hebert ("Median Filtering in Constant Time", IEEE TIP 2007): a fine
+ * level with one bin per pixel value and a coarse level where each bin
+ * holds the sum of 2^m_FineBits consecutive fine bins. The coarse bin
+ * containing the requested rank is tracked from one call of GetValue()
+ * to the next, so that finding the rank only scans the few coarse bins
+ * the rank moved across, and then at most one block of fine bins. This
+ * bounds the cost of GetValue() by O(sqrt(number of pixel values)),
+ * independently of the size of the kernel.
+ *
+ * \ingroup ITKImageFilterBase
+ */
 template< typename TInputPixel >
 class VectorRankHistogram
 {
@@ -270,17 +285,19 @@ public:
   {
     m_Size = (OffsetValueType)NumericTraits< TInputPixel >::max() - (OffsetValueType)NumericTraits< TInputPixel >::NonpositiveMin() + 1;
     m_Vec.resize(m_Size, 0);
-    if ( m_Compare( NumericTraits< TInputPixel >::max(),
-                    NumericTraits< TInputPixel >::NonpositiveMin() ) )
-      {
-      m_InitVal = NumericTraits< TInputPixel >::NonpositiveMin();
-      }
-    else
+
+    // use about sqrt(m_Size) fine bins per coarse bin
+    unsigned int bits = 0;
+    while ( ( static_cast< SizeValueType >( 1 ) << bits ) < m_Size )
       {
-      m_InitVal = NumericTraits< TInputPixel >::max();
+      ++bits;
       }
-    m_Entries = m_Below = 0;
-    m_RankValue = m_InitVal  - NumericTraits< TInputPixel >::NonpositiveMin();
+    m_FineBits = bits / 2;
+    m_Coarse.resize( ( ( m_Size - 1 ) >> m_FineBits ) + 1, 0 );
+
+    m_Entries = 0;
+    m_CoarseIndex = 0;
+    m_CoarseBelow = 0;
     m_Rank = 0.5;
   }
 
@@ -308,17 +325,51 @@ public:
 
   TInputPixel GetValue(const TInputPixel &)
   {
-    return GetValueBruteForce();
+    if ( m_Entries == 0 )
+      {
+      return NumericTraits< TInputPixel >::max();
+      }
+    const SizeValueType target = (SizeValueType)( m_Rank * ( m_Entries - 1 ) ) + 1;
+
+    // move the coarse bin until it contains the target rank:
+    // m_CoarseBelow < target <= m_CoarseBelow + m_Coarse[m_CoarseIndex]
+    while ( m_CoarseBelow >= target )
+      {
+      --m_CoarseIndex;
+      m_CoarseBelow -= m_Coarse[m_CoarseIndex];
+      }
+    while ( m_CoarseBelow + m_Coarse[m_CoarseIndex] < target )
+      {
+      m_CoarseBelow += m_Coarse[m_CoarseIndex];
+      ++m_CoarseIndex;
+      }
+
+    // then scan the fine bins of that coarse bin
+    SizeValueType count = m_CoarseBelow;
+    SizeValueType i = m_CoarseIndex << m_FineBits;
+    for (;; ++i )
+      {
+      count += m_Vec[i];
+      if ( count >= target )
+        {
+        break;
+        }
+      }
+    const TInputPixel value = static_cast< TInputPixel >( i + NumericTraits< TInputPixel >::NonpositiveMin() );
+    itkAssertInDebugAndIgnoreInReleaseMacro( value == GetValueBruteForce() );
+    return value;
   }
 
   void AddPixel(const TInputPixel & p)
   {
-    OffsetValueType q = (OffsetValueType)p - NumericTraits< TInputPixel >::NonpositiveMin();
+    const OffsetValueType q = (OffsetValueType)p - NumericTraits< TInputPixel >::NonpositiveMin();
+    const SizeValueType   c = static_cast< SizeValueType >( q ) >> m_FineBits;
 
     m_Vec[q]++;
-    if ( m_Compare(p, m_RankValue) || p == m_RankValue )
+    m_Coarse[c]++;
+    if ( c < m_CoarseIndex )
       {
-      ++m_Below;
+      ++m_CoarseBelow;
       }
     ++m_Entries;
   }
@@ -326,19 +377,20 @@ public:
   void RemovePixel(const TInputPixel & p)
   {
     const OffsetValueType q = (OffsetValueType)p - NumericTraits< TInputPixel >::NonpositiveMin();
+    const SizeValueType   c = static_cast< SizeValueType >( q ) >> m_FineBits;
 
     itkAssertInDebugAndIgnoreInReleaseMacro( q >= 0 );
-    itkAssertInDebugAndIgnoreInReleaseMacro( q < (int)m_Vec.size() );
+    itkAssertInDebugAndIgnoreInReleaseMacro( q < (OffsetValueType)m_Vec.size() );
     itkAssertInDebugAndIgnoreInReleaseMacro( m_Entries >= 1 );
     itkAssertInDebugAndIgnoreInReleaseMacro( m_Vec[q] > 0 );
 
     m_Vec[q]--;
-    --m_Entries;
-
-    if ( m_Compare(p, m_RankValue) || p == m_RankValue )
+    m_Coarse[c]--;
+    if ( c < m_CoarseIndex )
       {
-      --m_Below;
+      --m_CoarseBelow;
       }
+    --m_Entries;
   }
 
   void SetRank(float rank)
@@ -362,16 +414,17 @@ private:
   typedef typename std::vector< SizeValueType > VecType;
 
   VecType       m_Vec;
+  VecType       m_Coarse;
   SizeValueType m_Size;
-  TCompare      m_Compare;
-  TInputPixel   m_RankValue;
-  TInputPixel   m_InitVal;
-  int           m_Below;
-  int           m_Entries;
+  unsigned int  m_FineBits;
+  SizeValueType m_CoarseIndex;
+  SizeValueType m_CoarseBelow;
+  SizeValueType m_Entries;
 };
 
-// now create MorphologicalGradientHistogram specilizations using the VectorMorphologicalGradientHistogram
-// as base class
+// now create RankHistogram specilizations using the VectorRankHistogram
+// as base class. The vector is small enough to be copied at each line by
+// MovingHistogramImageFilter for the 8 and 16 bits types.
 
 /** \cond HIDE_SPECIALIZATION_DOCUMENTATION */
 
@@ -393,6 +446,18 @@ class RankHistogram<bool>:
 {
 };
 
+template<>
+class RankHistogram<unsigned short>:
+  public VectorRankHistogram<unsigned short>
+{
+};
+
+template<>
+class RankHistogram<short>:
+  public VectorRankHistogram<short>
+{
+};
+
 /** \endcond */
 
 } // end namespace Function
@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkRankSelectionNetwork_h
+#define itkRankSelectionNetwork_h
+
+#include "itkIntTypes.h"
+#include "itkMetaProgrammingLibrary.h"
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+namespace itk
+{
+namespace Function
+{
+/** \class RankSelectionNetwork
+ * \brief Selects a given rank in a small array with a sorting network.
+ *
+ * The network is a Batcher odd-even merge sort for the number of values,
+ * from which all the compare-exchange operations that can't change the
+ * value finally stored at the requested rank have been removed. The
+ * sequence of compare-exchange operations doesn't depend on the values,
+ * so, for scalar pixel types, it is executed without any branch and is
+ * much faster than std::nth_element() on the small neighborhoods commonly
+ * used for median filtering (3x3, 5x5, 3x3x3, ...).
+ *
+ * The value type must provide operator<().
+ *
+ * \ingroup ITKImageFilterBase
+ */
+template< typename TValue >
+class RankSelectionNetwork
+{
+public:
+  typedef std::pair< unsigned int, unsigned int > ComparatorType;
+  typedef std::vector< ComparatorType >           ComparatorListType;
+
+  RankSelectionNetwork()
+  {
+    m_NumberOfValues = 0;
+    m_RankIndex = 0;
+  }
+
+  /** Build the network selecting the value of index rankIndex in the
+   * sorted array of numberOfValues values. */
+  RankSelectionNetwork(unsigned int numberOfValues, unsigned int rankIndex)
+  {
+    this->Initialize(numberOfValues, rankIndex);
+  }
+
+  void Initialize(unsigned int numberOfValues, unsigned int rankIndex)
+  {
+    m_NumberOfValues = numberOfValues;
+    m_RankIndex = rankIndex;
+    m_Comparators.clear();
+    if ( numberOfValues < 2 )
+      {
+      return;
+      }
+
+    // Batcher's odd-even merge sort on the next power of two. The
+    // missing values are considered as +infinity, so they stay on the
+    // upper wires and the comparators touching them can be dropped.
+    unsigned int size = 1;
+    while ( size < numberOfValues )
+      {
+      size <<= 1;
+      }
+    ComparatorListType sorting;
+    for ( unsigned int p = 1; p < size; p <<= 1 )
+      {
+      for ( unsigned int k = p; k >= 1; k >>= 1 )
+        {
+        for ( unsigned int j = k % p; j + k < size; j += 2 * k )
+          {
+          for ( unsigned int i = 0; i < k && i + j + k < size; ++i )
+            {
+            if ( ( i + j ) / ( 2 * p ) == ( i + j + k ) / ( 2 * p )
+                 && i + j + k < numberOfValues )
+              {
+              sorting.push_back( ComparatorType(i + j, i + j + k) );
+              }
+            }
+          }
+        }
+      }
+
+    // keep only the comparators the selected wire depends on
+    std::vector< bool > needed(numberOfValues, false);
+    needed[rankIndex] = true;
+    for ( typename ComparatorListType::reverse_iterator it = sorting.rbegin(); it != sorting.rend(); ++it )
+      {
+      if ( needed[it->first] || needed[it->second] )
+        {
+        needed[it->first] = true;
+        needed[it->second] = true;
+        m_Comparators.push_back(*it);
+        }
+      }
+    std::reverse( m_Comparators.begin(), m_Comparators.end() );
+  }
+
+  /** Reorder the values so that values[rankIndex] is the value of
+   * rank rankIndex. The other values are left in an unspecified order. */
+  void Select(TValue *values) const
+  {
+    typedef typename mpl::If< std::numeric_limits< TValue >::is_integer,
+                              mpl::TrueType, mpl::FalseType >::Type IsIntegerType;
+    this->Select( values, IsIntegerType() );
+  }
+
+  unsigned int GetNumberOfValues() const
+  {
+    return m_NumberOfValues;
+  }
+
+  unsigned int GetRankIndex() const
+  {
+    return m_RankIndex;
+  }
+
+  SizeValueType GetNumberOfComparators() const
+  {
+    return m_Comparators.size();
+  }
+
+private:
+  // The compare-exchange operations are written so that the compiler
+  // emits conditional moves for the integer types, and min/max
+  // instructions for the floating point types.
+  void Select(TValue *values, mpl::TrueType) const
+  {
+    for ( typename ComparatorListType::const_iterator it = m_Comparators.begin(); it != m_Comparators.end(); ++it )
+      {
+      const TValue a = values[it->first];
+      const TValue b = values[it->second];
+      const bool   swap = b < a;
+      values[it->first] = swap ? b : a;
+      values[it->second] = swap ? a : b;
+      }
+  }
+
+  void Select(TValue *values, mpl::FalseType) const
+  {
+    for ( typename ComparatorListType::const_iterator it = m_Comparators.begin(); it != m_Comparators.end(); ++it )
+      {
+      const TValue a = values[it->first];
+      const TValue b = values[it->second];
+      values[it->first] = std::min(a, b);
+      values[it->second] = std::max(a, b);
+      }
+  }
+
+  ComparatorListType m_Comparators;
+  unsigned int       m_NumberOfValues;
+  unsigned int       m_RankIndex;
+};
+} // end namespace Function
+} // end namespace itk
+
+#endif
@@ -27,6 +27,7 @@
 #include "itkLabelMap.h"
 #include "itkLabelObject.h"
 #include "itkImageRegionSplitterDirection.h"
+#include "itkConcurrentUnionFind.h"
 
 namespace itk
 {
@@ -43,6 +44,11 @@ namespace itk
  *
  * The GetOutput() function of this class returns an itk::LabelMap.
  *
+ * The threads encode the runs of their blocks of lines and link the
+ * labels of neighbor runs, across the blocks too, in a union-find
+ * structure shared without locks (see ConcurrentUnionFind). The label
+ * objects are then filled by a single thread.
+ *
  * This implementation was taken from the Insight Journal paper:
  * http://hdl.handle.net/1926/584  or
  * http://www.insight-journal.org/browse/publication/176
@@ -207,23 +213,12 @@ private:
   typedef std::vector< OffsetValueType > OffsetVectorType;
 
   // the types to support union-find operations
-  typedef std::vector< InternalLabelType > UnionFindType;
+  typedef ConcurrentUnionFind< InternalLabelType > UnionFindType;
   UnionFindType m_UnionFind;
 
   typedef std::vector< OutputPixelType > ConsecutiveVectorType;
   ConsecutiveVectorType m_Consecutive;
 
-  // functions to support union-find operations
-  void InitUnion(const InternalLabelType size);
-
-  void InsertSet(const InternalLabelType label);
-
-  InternalLabelType LookupSet(const InternalLabelType label);
-
-  void LinkLabels(const InternalLabelType lab1, const InternalLabelType lab2);
-
-  SizeValueType CreateConsecutive();
-
   //////////////////
   bool CheckNeighbors(const OutputIndexType & A,
                       const OutputIndexType & B);
@@ -245,7 +240,7 @@ private:
   bool m_FullyConnected;
 
   std::vector< SizeValueType >   m_NumberOfLabels;
-  std::vector< SizeValueType >   m_FirstLineIdToJoin;
+  std::vector< SizeValueType >   m_NumberOfRoots;
 
   typename Barrier::Pointer m_Barrier;
 
@@ -109,7 +109,8 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
   const SizeValueType xsize = requestedSize[0];
   const SizeValueType linecount = pixelcount / xsize;
   m_LineMap.resize(linecount);
-  m_FirstLineIdToJoin.resize(nbOfThreads - 1);
+  m_NumberOfRoots.clear();
+  m_NumberOfRoots.resize(nbOfThreads, 0);
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -204,33 +205,42 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
   // wait for the other threads to complete that part
   this->Wait();
 
-  // compute the total number of labels
+  // compute the total number of labels, and the first label of that thread
   nbOfLabels = 0;
+  InternalLabelType firstLabelForThread = 1;
   for ( SizeValueType i = 0; i < nbOfThreads; ++i )
     {
+    if ( i < threadId )
+      {
+      firstLabelForThread += this->m_NumberOfLabels[i];
+      }
     nbOfLabels += this->m_NumberOfLabels[i];
     }
+  const InternalLabelType lastLabelForThread = firstLabelForThread + this->m_NumberOfLabels[threadId];
 
   if ( threadId == 0 )
     {
     // set up the union find structure
-    this->InitUnion(nbOfLabels);
-    // insert all the labels into the structure -- an extra loop but
-    // saves complicating the ones that come later
-    typename LineMapType::iterator MapBegin, MapEnd, LineIt;
-    MapBegin = m_LineMap.begin();
-    MapEnd = m_LineMap.end();
-    LineIt = MapBegin;
-    InternalLabelType label = 1;
-    for ( LineIt = MapBegin; LineIt != MapEnd; ++LineIt )
+    m_UnionFind.SetSize(nbOfLabels + 1);
+    m_UnionFind.InsertSet(0);
+    m_Consecutive = ConsecutiveVectorType(nbOfLabels + 1);
+    m_Consecutive[0] = this->m_OutputBackgroundValue;
+    }
+
+  // wait for the other threads to complete that part
+  this->Wait();
+
+  // insert the labels of the runs of that thread into the structure
+  const SizeValueType lastLineIdForThread = firstLineIdForThread + linecountForThread;
+  InternalLabelType   label = firstLabelForThread;
+  for ( SizeValueType thisIdx = firstLineIdForThread; thisIdx < lastLineIdForThread; ++thisIdx )
+    {
+    typename lineEncoding::iterator cIt;
+    for ( cIt = m_LineMap[thisIdx].begin(); cIt != m_LineMap[thisIdx].end(); ++cIt )
       {
-      typename lineEncoding::iterator cIt;
-      for ( cIt = LineIt->begin(); cIt != LineIt->end(); ++cIt )
-        {
-        cIt->label = label;
-        this->InsertSet(label);
-        label++;
-        }
+      cIt->label = label;
+      m_UnionFind.InsertSet(label);
+      label++;
       }
     }
 
@@ -238,26 +248,12 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
   this->Wait();
 
   // now process the map and make appropriate entries in an equivalence
-  // table
+  // table. The neighbor lines of the first lines of the thread belong to
+  // the previous thread: the threads link their labels concurrently.
   const SizeValueType pixelcount = output->GetRequestedRegion().GetNumberOfPixels();
   const SizeValueType xsize = output->GetRequestedRegion().GetSize()[0];
   const OffsetValueType linecount = pixelcount / xsize;
 
-  SizeValueType lastLineIdForThread =  linecount;
-  OffsetValueType nbOfLineIdToJoin = 0;
-  if ( static_cast<SizeValueType>( threadId ) + 1 != nbOfThreads )
-    {
-    SizeType localRegionSize = outputRegionForThreadSize;
-    localRegionSize[splitAxis] -= 1;
-    lastLineIdForThread = firstLineIdForThread
-                          + RegionType(outputRegionIdx, localRegionSize).GetNumberOfPixels() / xsizeForThread;
-    m_FirstLineIdToJoin[threadId] = lastLineIdForThread;
-    // found the number of line ids to join
-    nbOfLineIdToJoin =
-      RegionType( outputRegionIdx, outputRegionForThread.GetSize() ).GetNumberOfPixels() / xsizeForThread
-      - RegionType(outputRegionIdx, localRegionSize).GetNumberOfPixels() / xsizeForThread;
-    }
-
   for ( SizeValueType thisIdx = firstLineIdForThread; thisIdx < lastLineIdForThread; ++thisIdx )
     {
     if ( !m_LineMap[thisIdx].empty() )
@@ -285,53 +281,43 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
   // wait for the other threads to complete that part
   this->Wait();
 
-  while ( m_FirstLineIdToJoin.size() != 0 )
+  // point the labels of that thread to their roots, and count the roots
+  SizeValueType nbOfRoots = 0;
+  for ( label = firstLabelForThread; label < lastLabelForThread; ++label )
     {
-    const SizeValueType threadChunk = 2 * threadId;
-    if ( threadChunk < (SizeValueType)m_FirstLineIdToJoin.size() )
+    if ( m_UnionFind.FlattenSet(label) == label )
       {
-      for ( SizeValueType thisIdx = m_FirstLineIdToJoin[threadChunk];
-            thisIdx < m_FirstLineIdToJoin[threadChunk] + nbOfLineIdToJoin;
-            ++thisIdx )
-        {
-        if ( !m_LineMap[thisIdx].empty() )
-          {
-          typename OffsetVectorType::const_iterator I = LineOffsets.begin();
-          while ( I != LineOffsets.end() )
-            {
-            OffsetValueType NeighIdx = thisIdx + ( *I );
-            // check if the neighbor is in the map
-            if ( NeighIdx >= 0 && NeighIdx < linecount && !m_LineMap[NeighIdx].empty() )
-              {
-              // Now check whether they are really neighbors
-              bool areNeighbors =
-                CheckNeighbors(m_LineMap[thisIdx][0].where, m_LineMap[NeighIdx][0].where);
-              if ( areNeighbors )
-                {
-                // Compare the two lines
-                CompareLines(m_LineMap[thisIdx], m_LineMap[NeighIdx]);
-                }
-              }
-            ++I;
-            }
-          }
-        }
+      ++nbOfRoots;
       }
+    }
+  m_NumberOfRoots[threadId] = nbOfRoots;
 
-    this->Wait();
+  // wait for the other threads to complete that part
+  this->Wait();
 
-    if ( threadId == 0 )
+  // give consecutive labels to the roots, in the order of the labels, the
+  // background value being skipped
+  SizeValueType consecutiveLabel = 0;
+  for ( SizeValueType i = 0; i < threadId; ++i )
+    {
+    consecutiveLabel += m_NumberOfRoots[i];
+    }
+  const SizeValueType backgroundValue = static_cast< SizeValueType >( this->m_OutputBackgroundValue );
+  if ( consecutiveLabel >= backgroundValue )
+    {
+    ++consecutiveLabel;
+    }
+  for ( label = firstLabelForThread; label < lastLabelForThread; ++label )
+    {
+    if ( m_UnionFind.GetParent(label) == label )
       {
-      // remove the region already joined
-      typename std::vector< SizeValueType > newFirstLineIdToJoin;
-      for ( SizeValueType i = 1; i < (SizeValueType)m_FirstLineIdToJoin.size(); i += 2 )
+      if ( consecutiveLabel == backgroundValue )
         {
-        newFirstLineIdToJoin.push_back(m_FirstLineIdToJoin[i]);
+        ++consecutiveLabel;
         }
-      m_FirstLineIdToJoin = newFirstLineIdToJoin;
+      m_Consecutive[label] = static_cast< OutputPixelType >( consecutiveLabel );
+      ++consecutiveLabel;
       }
-
-    this->Wait();
     }
 }
 
@@ -345,7 +331,11 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
   const SizeValueType pixelcount = output->GetRequestedRegion().GetNumberOfPixels();
   const SizeValueType xsize = output->GetRequestedRegion().GetSize()[0];
   const SizeValueType linecount = pixelcount / xsize;
-  SizeValueType totalLabs = CreateConsecutive();
+  SizeValueType totalLabs = 0;
+  for ( SizeValueType i = 0; i < m_NumberOfRoots.size(); ++i )
+    {
+    totalLabs += m_NumberOfRoots[i];
+    }
   ProgressReporter  progress(this, 0, linecount, 25, 0.75f, 0.25f);
   // check for overflow exception here
   if ( totalLabs > static_cast< SizeValueType >( NumericTraits< OutputPixelType >::max() ) )
@@ -366,8 +356,7 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
 
     while ( cIt != cEnd )
       {
-      const InternalLabelType Ilab = LookupSet(cIt->label);
-      const OutputPixelType lab = m_Consecutive[Ilab];
+      const OutputPixelType lab = m_Consecutive[m_UnionFind.GetParent(cIt->label)];
       output->SetLine(cIt->where, cIt->length, lab);
       ++cIt;
       }
@@ -375,8 +364,11 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
     }
 
   this->m_NumberOfLabels.clear();
+  this->m_NumberOfRoots.clear();
   this->m_Barrier = ITK_NULLPTR;
 
+  m_UnionFind.SetSize(0);
+  m_Consecutive.clear();
   m_LineMap.clear();
 }
 
@@ -528,7 +520,7 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
 
       if ( eq )
         {
-        LinkLabels(nIt->label, cIt->label);
+        m_UnionFind.LinkLabels(nIt->label, cIt->label);
         }
 
       if ( ee1 >= cLast )
@@ -542,14 +534,6 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
     }
 }
 
-template< typename TInputImage, typename TOutputImage >
-void
-BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
-::InitUnion(const InternalLabelType size)
-{
-  m_UnionFind = UnionFindType(size + 1);
-}
-
 template< typename TInputImage, typename TOutputImage >
 void
 BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
@@ -562,76 +546,6 @@ BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
     }
 }
 
-// union find related functions
-template< typename TInputImage, typename TOutputImage >
-void
-BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
-::InsertSet(const InternalLabelType label)
-{
-  m_UnionFind[label] = label;
-}
-
-template< typename TInputImage, typename TOutputImage >
-typename BinaryImageToLabelMapFilter< TInputImage, TOutputImage >::SizeValueType
-BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
-::CreateConsecutive()
-{
-  const size_t N = m_UnionFind.size();
-
-  m_Consecutive = ConsecutiveVectorType( N );
-  m_Consecutive[ 0 ] = this->m_OutputBackgroundValue;
-
-  OutputPixelType consecutiveLabel = 0;
-  SizeValueType count = 0;
-
-  for ( size_t i = 1; i < N; i++ )
-    {
-    const size_t label = static_cast< size_t >( m_UnionFind[i] );
-    if ( label == i )
-      {
-      if ( consecutiveLabel == this->m_OutputBackgroundValue )
-        {
-        ++consecutiveLabel;
-        }
-      m_Consecutive[label] = consecutiveLabel;
-      ++consecutiveLabel;
-      ++count;
-      }
-    }
-  return count;
-}
-
-template< typename TInputImage, typename TOutputImage >
-typename BinaryImageToLabelMapFilter< TInputImage, TOutputImage >::InternalLabelType
-BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
-::LookupSet(const InternalLabelType label)
-{
-  // recursively set the equivalence if necessary
-  if ( label != m_UnionFind[label] )
-    {
-    m_UnionFind[label] = this->LookupSet(m_UnionFind[label]);
-    }
-  return ( m_UnionFind[label] );
-}
-
-template< typename TInputImage, typename TOutputImage >
-void
-BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
-::LinkLabels(const InternalLabelType lab1, const InternalLabelType lab2)
-{
-  InternalLabelType E1 = this->LookupSet(lab1);
-  InternalLabelType E2 = this->LookupSet(lab2);
-
-  if ( E1 < E2 )
-    {
-    m_UnionFind[E2] = E1;
-    }
-  else
-    {
-    m_UnionFind[E1] = E2;
-    }
-}
-
 template< typename TInputImage, typename TOutputImage >
 void
 BinaryImageToLabelMapFilter< TInputImage, TOutputImage >
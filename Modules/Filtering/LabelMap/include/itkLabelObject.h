@@ -18,7 +18,7 @@
 #ifndef itkLabelObject_h
 #define itkLabelObject_h
 
-#include <deque>
+#include <vector>
 #include "itkLightObject.h"
 #include "itkLabelObjectLine.h"
 #include "itkWeakPointer.h"
@@ -243,7 +243,7 @@ public:
     }
 
   private:
-    typedef typename std::deque< LineType >            LineContainerType;
+    typedef typename std::vector< LineType >           LineContainerType;
     typedef typename LineContainerType::const_iterator InternalIteratorType;
     InternalIteratorType m_Iterator;
     InternalIteratorType m_Begin;
@@ -338,7 +338,7 @@ public:
 
   private:
 
-    typedef typename std::deque< LineType >            LineContainerType;
+    typedef typename std::vector< LineType >           LineContainerType;
     typedef typename LineContainerType::const_iterator InternalIteratorType;
     void NextValidLine()
     {
@@ -367,7 +367,7 @@ private:
   LabelObject(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
-  typedef typename std::deque< LineType >    LineContainerType;
+  typedef typename std::vector< LineType >   LineContainerType;
 
   LineContainerType m_LineContainer;
   LabelType         m_Label;
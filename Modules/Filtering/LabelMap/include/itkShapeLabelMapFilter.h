@@ -19,6 +19,9 @@
 #define itkShapeLabelMapFilter_h
 
 #include "itkInPlaceLabelMapFilter.h"
+#include "itkSimpleFastMutexLock.h"
+#include <map>
+#include <vector>
 
 namespace itk
 {
@@ -28,15 +31,16 @@ namespace itk
  * ShapeLabelMapFilter can be used to set the attributes values of the
  * ShapeLabelObject in a LabelMap.
  *
- * ShapeLabelMapFilter takes an optional parameter, used only to
- * optimize the computation time and the memory usage when the
- * perimeter or the feret diameter is used: the exact copy of the
- * input LabelMap is stored in an Image.
- * It can be set with SetLabelImage(). It is cleared at the end of the
- * computation, so must be reset before running Update() again. It is
- * not part of the pipeline management design, to let the subclasses
- * of ShapeLabelMapFilter use the pipeline design to specify truly
- * required inputs.
+ * The label objects are processed concurrently by the threads of the
+ * filter. The Feret diameter and the perimeter of the objects much larger
+ * than the others, which would keep a thread busy long after the others
+ * are done, are computed after the other objects, with all the threads
+ * working on the same object.
+ *
+ * The Feret diameter is computed from the ends of the lines of the
+ * objects, which are the only pixels that can be at its ends, so no
+ * image of the labels is needed anymore. SetLabelImage() is kept for
+ * backward compatibility, but the image set is not used.
  *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
@@ -115,7 +119,7 @@ public:
   itkGetConstReferenceMacro(ComputePerimeter, bool);
   itkBooleanMacro(ComputePerimeter);
 
-  /** Set the label image */
+  /** Set the label image. The image is not used anymore. */
   void SetLabelImage(const TLabelImage *input)
   {
     m_LabelImage = input;
@@ -137,12 +141,56 @@ private:
   ShapeLabelMapFilter(const Self &); //purposely not implemented
   void operator=(const Self &);      //purposely not implemented
 
+  typedef typename LabelObjectType::LineType                                          LineType;
+  typedef std::vector< LineType >                                                     VectorLineType;
+  typedef Image< VectorLineType, ImageDimension - 1 >                                 LineImageType;
+  typedef typename LineImageType::RegionType                                          LineRegionType;
+  typedef std::map< OffsetType, SizeValueType, typename OffsetType::LexicographicCompare > MapInterceptType;
+  typedef std::vector< IndexType >                                                    IndexListType;
+
+  /** Data shared by the threads computing the Feret diameter or the
+   * perimeter of a large label object. */
+  struct ThreadStruct
+  {
+    Self *                          Filter;
+    const IndexListType *           Indexes;
+    std::vector< double >           SquaredFeretDiameters;
+    const LineImageType *           LineImage;
+    std::vector< LineRegionType >   LineRegions;
+    std::vector< MapInterceptType > Intercepts;
+  };
+
   bool                   m_ComputeFeretDiameter;
   bool                   m_ComputePerimeter;
   LabelImageConstPointer m_LabelImage;
 
-  void ComputeFeretDiameter(LabelObjectType *labelObject);
-  void ComputePerimeter(LabelObjectType *labelObject);
+  /** The label objects with more lines than m_LargeLabelObjectNumberOfLines
+   * have their Feret diameter and perimeter computed by all the threads in
+   * AfterThreadedGenerateData(). */
+  SizeValueType                    m_LargeLabelObjectNumberOfLines;
+  std::vector< LabelObjectType * > m_LargeLabelObjects;
+  SimpleFastMutexLock              m_LargeLabelObjectsLock;
+
+  void ComputeFeretDiameter(LabelObjectType *labelObject, ThreadIdType numberOfThreads);
+  void ComputePerimeter(LabelObjectType *labelObject, ThreadIdType numberOfThreads);
+
+  /** The ends of the lines of a label object which are vertices of the
+   * convex hull of the ends in their plane. The Feret diameter is the
+   * largest distance between two of them. */
+  void GetFeretDiameterCandidates(const LabelObjectType *labelObject, IndexListType & indexes) const;
+
+  /** The largest squared distance between the indexes i, i + step,
+   * i + 2 * step... starting at first and all the following indexes. */
+  double ComputeSquaredFeretDiameter(const IndexListType & indexes, SizeValueType first, SizeValueType step) const;
+
+  /** Count the intercepts of the contour of the lines of a region of the
+   * image of lines with the lines of the directions of the neighbors. */
+  void CountIntercepts(const LineImageType *lineImage, const LineRegionType & region,
+                       MapInterceptType & intercepts) const;
+
+  static ITK_THREAD_RETURN_TYPE FeretDiameterThreaderCallback(void *arg);
+
+  static ITK_THREAD_RETURN_TYPE PerimeterThreaderCallback(void *arg);
 
   typedef itk::Offset<2>                                                          Offset2Type;
   typedef itk::Offset<3>                                                          Offset3Type;
@@ -20,17 +20,15 @@
 
 #include "itkShapeLabelMapFilter.h"
 #include "itkProgressReporter.h"
-#include "itkConstNeighborhoodIterator.h"
 #include "itkConstShapedNeighborhoodIterator.h"
-#include "itkLabelMapToLabelImageFilter.h"
-#include "itkConstantBoundaryCondition.h"
 #include "itkGeometryUtilities.h"
 #include "itkConnectedComponentAlgorithm.h"
+#include "itkImageRegionSplitterSlowDimension.h"
+#include "itkMutexLockHolder.h"
 #include "vnl/algo/vnl_real_eigensystem.h"
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
 #include "vnl/vnl_math.h"
-#include <deque>
-#include <map>
+#include <algorithm>
 
 namespace itk
 {
@@ -40,6 +38,7 @@ ShapeLabelMapFilter< TImage, TLabelImage >
 {
   m_ComputeFeretDiameter = false;
   m_ComputePerimeter = true;
+  m_LargeLabelObjectNumberOfLines = NumericTraits< SizeValueType >::max();
 }
 
 template< typename TImage, typename TLabelImage >
@@ -49,20 +48,23 @@ ShapeLabelMapFilter< TImage, TLabelImage >
 {
   Superclass::BeforeThreadedGenerateData();
 
-  // Generate the label image, if needed
-  if ( m_ComputeFeretDiameter )
+  // An object with more lines than half the mean number of lines per
+  // thread would keep its thread busy after the others are done: its
+  // Feret diameter and its perimeter are computed at the end, by all the
+  // threads
+  m_LargeLabelObjects.clear();
+  m_LargeLabelObjectNumberOfLines = NumericTraits< SizeValueType >::max();
+  const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  if ( numberOfThreads > 1 && ( m_ComputeFeretDiameter || m_ComputePerimeter ) )
     {
-    if ( !m_LabelImage )
+    SizeValueType numberOfLines = 0;
+    typename ImageType::ConstIterator it( this->GetLabelMap() );
+    while ( !it.IsAtEnd() )
       {
-      // generate an image of the labelized image
-      typedef LabelMapToLabelImageFilter< TImage, LabelImageType > LCI2IType;
-      typename LCI2IType::Pointer lci2i = LCI2IType::New();
-      lci2i->SetInput( this->GetOutput() );
-      // Respect the number of threads of the filter
-      lci2i->SetNumberOfThreads( this->GetNumberOfThreads() );
-      lci2i->Update();
-      m_LabelImage = lci2i->GetOutput();
+      numberOfLines += it.GetLabelObject()->GetNumberOfLines();
+      ++it;
       }
+    m_LargeLabelObjectNumberOfLines = numberOfLines / ( 2 * numberOfThreads );
     }
 }
 
@@ -371,76 +373,196 @@ ShapeLabelMapFilter< TImage, TLabelImage >
   labelObject->SetEquivalentEllipsoidDiameter(ellipsoidDiameter);
   labelObject->SetFlatness(flatness);
 
+  if ( ( m_ComputeFeretDiameter || m_ComputePerimeter )
+       && labelObject->GetNumberOfLines() > m_LargeLabelObjectNumberOfLines )
+    {
+    // Leave the object to all the threads, at the end
+    MutexLockHolder< SimpleFastMutexLock > lock(m_LargeLabelObjectsLock);
+    m_LargeLabelObjects.push_back(labelObject);
+    return;
+    }
+
   if ( m_ComputeFeretDiameter )
     {
-    this->ComputeFeretDiameter(labelObject);
+    this->ComputeFeretDiameter(labelObject, 1);
     }
 
   if ( m_ComputePerimeter )
     {
-    this->ComputePerimeter(labelObject);
+    this->ComputePerimeter(labelObject, 1);
     }
 }
 
 template< typename TImage, typename TLabelImage >
 void
 ShapeLabelMapFilter< TImage, TLabelImage >
-::ComputeFeretDiameter(LabelObjectType *labelObject)
+::ComputeFeretDiameter(LabelObjectType *labelObject, ThreadIdType numberOfThreads)
 {
-  const LabelPixelType & label = labelObject->GetLabel();
-
-  typedef typename std::deque< IndexType > IndexListType;
   IndexListType idxList;
+  this->GetFeretDiameterCandidates(labelObject, idxList);
 
-  typedef typename itk::ConstNeighborhoodIterator< LabelImageType > NeighborIteratorType;
-  SizeType neighborHoodRadius;
-  neighborHoodRadius.Fill(1);
-  NeighborIteratorType                        it( neighborHoodRadius, m_LabelImage, m_LabelImage->GetBufferedRegion() );
-  ConstantBoundaryCondition< LabelImageType > lcbc;
-  // Use label + 1 to have a label different of the current label on the border
-  lcbc.SetConstant(label + 1);
-  it.OverrideBoundaryCondition(&lcbc);
-  it.GoToBegin();
+  // We can now search the feret diameter
+  double feretDiameter = 0;
+  if ( numberOfThreads > 1 && idxList.size() > numberOfThreads )
+    {
+    this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+    numberOfThreads = this->GetMultiThreader()->GetNumberOfThreads();
 
-  typedef typename NeighborIteratorType::NeighborIndexType   NeighborIndexType;
+    ThreadStruct str;
+    str.Filter = this;
+    str.Indexes = &idxList;
+    str.SquaredFeretDiameters.resize(numberOfThreads, 0.0);
+    this->GetMultiThreader()->SetSingleMethod(Self::FeretDiameterThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
 
-  // Iterate over all the indexes
-  typename LabelObjectType::ConstIndexIterator iit( labelObject );
-  while( ! iit.IsAtEnd() )
+    for ( ThreadIdType i = 0; i < numberOfThreads; i++ )
+      {
+      if ( feretDiameter < str.SquaredFeretDiameters[i] )
+        {
+        feretDiameter = str.SquaredFeretDiameters[i];
+        }
+      }
+    }
+  else
     {
-    // Move the iterator to the new location
-    it += iit.GetIndex() - it.GetIndex();
+    feretDiameter = this->ComputeSquaredFeretDiameter(idxList, 0, 1);
+    }
+  // Final computation
+  feretDiameter = std::sqrt(feretDiameter);
 
-    // Push the pixel in the list if it is on the border of the object
-    for ( NeighborIndexType i = 0; i < it.Size(); i++ )
+  // Finally put the values in the label object
+  labelObject->SetFeretDiameter(feretDiameter);
+}
+
+template< typename TImage, typename TLabelImage >
+void
+ShapeLabelMapFilter< TImage, TLabelImage >
+::GetFeretDiameterCandidates(const LabelObjectType *labelObject, IndexListType & indexes) const
+{
+  // The distance to a point is largest at one of the ends of a line, so
+  // the Feret diameter is the largest distance between two ends of lines
+  indexes.clear();
+  indexes.reserve( 2 * labelObject->GetNumberOfLines() );
+  typename LabelObjectType::ConstLineIterator lit( labelObject );
+  while( ! lit.IsAtEnd() )
+    {
+    const LineType & line = lit.GetLine();
+    if ( line.GetLength() > 0 )
       {
-      if ( it.GetPixel(i) != label )
+      IndexType idx = line.GetIndex();
+      indexes.push_back(idx);
+      idx[0] += static_cast< OffsetValueType >( line.GetLength() ) - 1;
+      indexes.push_back(idx);
+      }
+    ++lit;
+    }
+
+  if ( ImageDimension < 2 )
+    {
+    return;
+    }
+
+  // A point which is not a vertex of the convex hull of the ends in its
+  // plane of the last two dimensions is between other ends, and can't be
+  // at the ends of the largest distance. The ends sorted in lexicographic
+  // order are grouped by plane, and sorted in each plane as the monotone
+  // chain algorithm needs it.
+  std::sort( indexes.begin(), indexes.end(), typename IndexType::LexicographicCompare() );
+  indexes.erase( std::unique( indexes.begin(), indexes.end() ), indexes.end() );
+
+  const unsigned int u = ImageDimension - 2;
+  const unsigned int v = ImageDimension - 1;
+  IndexListType      candidates;
+  IndexListType      hull;
+  SizeValueType      begin = 0;
+  while ( begin < indexes.size() )
+    {
+    SizeValueType end = begin + 1;
+    bool          samePlane = true;
+    while ( end < indexes.size() && samePlane )
+      {
+      for ( unsigned int i = 0; i < u; i++ )
         {
-        idxList.push_back( iit.GetIndex() );
-        break;
+        if ( indexes[end][i] != indexes[begin][i] )
+          {
+          samePlane = false;
+          }
+        }
+      if ( samePlane )
+        {
+        end++;
         }
       }
-    ++iit;
-    }
 
-  ImageType *output = this->GetOutput();
+    if ( end - begin <= 2 )
+      {
+      candidates.insert( candidates.end(), indexes.begin() + begin, indexes.begin() + end );
+      }
+    else
+      {
+      // The lower part of the hull, then the upper part, without the
+      // points on its edges
+      hull.clear();
+      for ( SizeValueType i = begin; i < end; i++ )
+        {
+        while ( hull.size() >= 2 )
+          {
+          const IndexType & a = hull[hull.size() - 2];
+          const IndexType & b = hull[hull.size() - 1];
+          const OffsetValueType cross = ( b[u] - a[u] ) * ( indexes[i][v] - a[v] )
+                                        - ( b[v] - a[v] ) * ( indexes[i][u] - a[u] );
+          if ( cross > 0 )
+            {
+            break;
+            }
+          hull.pop_back();
+          }
+        hull.push_back(indexes[i]);
+        }
+      const SizeValueType lowerSize = hull.size();
+      for ( SizeValueType i = end - 1; i > begin; i-- )
+        {
+        const IndexType & p = indexes[i - 1];
+        while ( hull.size() > lowerSize )
+          {
+          const IndexType & a = hull[hull.size() - 2];
+          const IndexType & b = hull[hull.size() - 1];
+          const OffsetValueType cross = ( b[u] - a[u] ) * ( p[v] - a[v] )
+                                        - ( b[v] - a[v] ) * ( p[u] - a[u] );
+          if ( cross > 0 )
+            {
+            break;
+            }
+          hull.pop_back();
+          }
+        hull.push_back(p);
+        }
+      // The first point is also the last one
+      hull.pop_back();
+      candidates.insert( candidates.end(), hull.begin(), hull.end() );
+      }
+    begin = end;
+    }
+  indexes.swap(candidates);
+}
 
-  const typename ImageType::SpacingType & spacing = output->GetSpacing();
+template< typename TImage, typename TLabelImage >
+double
+ShapeLabelMapFilter< TImage, TLabelImage >
+::ComputeSquaredFeretDiameter(const IndexListType & indexes, SizeValueType first, SizeValueType step) const
+{
+  const typename ImageType::SpacingType & spacing = this->GetOutput()->GetSpacing();
 
-  // We can now search the feret diameter
   double feretDiameter = 0;
-  for ( typename IndexListType::const_iterator iIt1 = idxList.begin();
-        iIt1 != idxList.end();
-        iIt1++ )
+  for ( SizeValueType i1 = first; i1 < indexes.size(); i1 += step )
     {
-    typename IndexListType::const_iterator iIt2 = iIt1;
-    for ( iIt2++; iIt2 != idxList.end(); iIt2++ )
+    for ( SizeValueType i2 = i1 + 1; i2 < indexes.size(); i2++ )
       {
       // Compute the length between the 2 indexes
       double length = 0;
       for ( unsigned int i = 0; i < ImageDimension; i++ )
         {
-        const OffsetValueType indexDifference = ( iIt1->operator[](i) - iIt2->operator[](i) );
+        const OffsetValueType indexDifference = ( indexes[i1][i] - indexes[i2][i] );
         length += std::pow(indexDifference * spacing[i], 2);
         }
       if ( feretDiameter < length )
@@ -449,21 +571,31 @@ ShapeLabelMapFilter< TImage, TLabelImage >
         }
       }
     }
-  // Final computation
-  feretDiameter = std::sqrt(feretDiameter);
+  return feretDiameter;
+}
 
-  // Finally put the values in the label object
-  labelObject->SetFeretDiameter(feretDiameter);
+template< typename TImage, typename TLabelImage >
+ITK_THREAD_RETURN_TYPE
+ShapeLabelMapFilter< TImage, TLabelImage >
+::FeretDiameterThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+  // The threads take the rows of the triangle of pairs in turn
+  str->SquaredFeretDiameters[info->ThreadID] =
+    str->Filter->ComputeSquaredFeretDiameter(*str->Indexes, info->ThreadID, info->NumberOfThreads);
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template< typename TImage, typename TLabelImage >
 void
 ShapeLabelMapFilter< TImage, TLabelImage >
-::ComputePerimeter(LabelObjectType *labelObject)
+::ComputePerimeter(LabelObjectType *labelObject, ThreadIdType numberOfThreads)
 {
   // store the lines in a N-1D image of vectors
-  typedef std::deque< typename LabelObjectType::LineType > VectorLineType;
-  typedef itk::Image< VectorLineType, ImageDimension - 1 > LineImageType;
   typename LineImageType::Pointer lineImage = LineImageType::New();
   typename LineImageType::IndexType lIdx;
   typename LineImageType::SizeType lSize;
@@ -502,14 +634,82 @@ ShapeLabelMapFilter< TImage, TLabelImage >
     }
 
   // a data structure to store the number of intercepts on each direction
-  typedef typename std::map<OffsetType, SizeValueType, typename OffsetType::LexicographicCompare> MapInterceptType;
   MapInterceptType intercepts;
   // int nbOfDirections = (int)std::pow( 2.0, (int)ImageDimension ) - 1;
   // intecepts.resize(nbOfDirections + 1);  // code begins at position 1
 
+  if ( numberOfThreads > 1 )
+    {
+    // each thread counts the intercepts in a slab of the image of lines
+    typedef ImageRegionSplitterSlowDimension SplitterType;
+    SplitterType::Pointer splitter = SplitterType::New();
+    const unsigned int numberOfPieces = splitter->GetNumberOfSplits(lRegion, numberOfThreads);
+
+    ThreadStruct str;
+    str.Filter = this;
+    str.LineImage = lineImage;
+    str.LineRegions.resize(numberOfPieces, lRegion);
+    for ( unsigned int i = 0; i < numberOfPieces; i++ )
+      {
+      splitter->GetSplit(i, numberOfPieces, str.LineRegions[i]);
+      }
+    str.Intercepts.resize(numberOfPieces);
+
+    this->GetMultiThreader()->SetNumberOfThreads(numberOfPieces);
+    this->GetMultiThreader()->SetSingleMethod(Self::PerimeterThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    for ( unsigned int i = 0; i < numberOfPieces; i++ )
+      {
+      for ( typename MapInterceptType::const_iterator it = str.Intercepts[i].begin();
+            it != str.Intercepts[i].end();
+            ++it )
+        {
+        intercepts[it->first] += it->second;
+        }
+      }
+    }
+  else
+    {
+    this->CountIntercepts(lineImage, lRegion, intercepts);
+    }
+
+  // compute the perimeter based on the intercept counts
+  double perimeter = PerimeterFromInterceptCount( intercepts, this->GetOutput()->GetSpacing() );
+  labelObject->SetPerimeter( perimeter );
+  labelObject->SetRoundness( labelObject->GetEquivalentSphericalPerimeter() / perimeter );
+  labelObject->SetPerimeterOnBorderRatio( labelObject->GetPerimeterOnBorder() / perimeter );
+}
+
+template< typename TImage, typename TLabelImage >
+ITK_THREAD_RETURN_TYPE
+ShapeLabelMapFilter< TImage, TLabelImage >
+::PerimeterThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+  if ( info->ThreadID < str->LineRegions.size() )
+    {
+    str->Filter->CountIntercepts(str->LineImage, str->LineRegions[info->ThreadID],
+                                 str->Intercepts[info->ThreadID]);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TImage, typename TLabelImage >
+void
+ShapeLabelMapFilter< TImage, TLabelImage >
+::CountIntercepts(const LineImageType *lineImage, const LineRegionType & region,
+                  MapInterceptType & intercepts) const
+{
   // now iterate over the vectors of lines
   typedef ConstShapedNeighborhoodIterator< LineImageType > LineImageIteratorType;
-  LineImageIteratorType lIt( lSize, lineImage, lRegion ); // the original, non padded region
+  typename LineImageType::SizeType lSize;
+  lSize.Fill(1);
+  LineImageIteratorType lIt( lSize, lineImage, region ); // the original, non padded region
   setConnectivity( &lIt, true );
   for( lIt.GoToBegin(); !lIt.IsAtEnd(); ++lIt )
     {
@@ -618,12 +818,6 @@ ShapeLabelMapFilter< TImage, TLabelImage >
         }
       }
     }
-
-  // compute the perimeter based on the intercept counts
-  double perimeter = PerimeterFromInterceptCount( intercepts, this->GetOutput()->GetSpacing() );
-  labelObject->SetPerimeter( perimeter );
-  labelObject->SetRoundness( labelObject->GetEquivalentSphericalPerimeter() / perimeter );
-  labelObject->SetPerimeterOnBorderRatio( labelObject->GetPerimeterOnBorder() / perimeter );
 }
 
 template< typename TImage, typename TLabelImage >
@@ -743,6 +937,23 @@ void
 ShapeLabelMapFilter< TImage, TLabelImage >
 ::AfterThreadedGenerateData()
 {
+  // Compute the Feret diameter and the perimeter of the large objects with
+  // all the threads
+  for ( typename std::vector< LabelObjectType * >::const_iterator it = m_LargeLabelObjects.begin();
+        it != m_LargeLabelObjects.end();
+        ++it )
+    {
+    if ( m_ComputeFeretDiameter )
+      {
+      this->ComputeFeretDiameter( *it, this->GetNumberOfThreads() );
+      }
+    if ( m_ComputePerimeter )
+      {
+      this->ComputePerimeter( *it, this->GetNumberOfThreads() );
+      }
+    }
+  m_LargeLabelObjects.clear();
+
   Superclass::AfterThreadedGenerateData();
 
   // Release the label image
@@ -0,0 +1,162 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkShapeLabelMapFilter.h"
+#include "itkShapeLabelObject.h"
+#include "itkLabelMap.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Compute the shape attributes of a large object with holes and of small
+ * objects, with one thread, and with several threads so that the Feret
+ * diameter and the perimeter of the large object are computed by all the
+ * threads. The attributes must be identical, and the Feret diameters must
+ * be the largest distances between two pixels of the objects.
+ */
+
+namespace
+{
+template< unsigned int VDimension >
+int ShapeLabelMapFilterLargeObjectTest( unsigned int size )
+{
+  typedef itk::Image< unsigned short, VDimension >                LabelImageType;
+  typedef itk::ShapeLabelObject< unsigned short, VDimension >     LabelObjectType;
+  typedef itk::LabelMap< LabelObjectType >                        LabelMapType;
+  typedef itk::LabelImageToLabelMapFilter< LabelImageType, LabelMapType > I2LType;
+  typedef itk::ShapeLabelMapFilter< LabelMapType >                ShapeFilterType;
+
+  typename LabelImageType::SizeType imageSize;
+  imageSize.Fill( size );
+  typename LabelImageType::SpacingType spacing;
+  for( unsigned int d = 0; d < VDimension; ++d )
+    {
+    spacing[d] = 1.0 + 0.3 * d;
+    }
+  typename LabelImageType::Pointer image = LabelImageType::New();
+  image->SetRegions( imageSize );
+  image->SetSpacing( spacing );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< LabelImageType > it( image, image->GetBufferedRegion() );
+  for(; !it.IsAtEnd(); ++it )
+    {
+    const typename LabelImageType::IndexType index = it.GetIndex();
+    double r2 = 0;
+    for( unsigned int d = 0; d < VDimension; ++d )
+      {
+      const double c = index[d] - 0.45 * size;
+      r2 += c * c * ( 1.0 + 0.4 * d );
+      }
+    unsigned short label = 0;
+    if( r2 < 0.12 * size * size && std::sin( 0.9 * index[0] ) * std::cos( 0.7 * index[1] ) < 0.8 )
+      {
+      label = 1;
+      }
+    else if( index[0] < 4 && index[1] < 5 )
+      {
+      label = 2 + index[VDimension - 1] % 2;
+      }
+    it.Set( label );
+    }
+
+  typename I2LType::Pointer i2l = I2LType::New();
+  i2l->SetInput( image );
+  i2l->Update();
+
+  typename LabelMapType::Pointer outputs[2];
+  const itk::ThreadIdType numbersOfThreads[2] = { 1, 4 };
+  for( unsigned int t = 0; t < 2; ++t )
+    {
+    typename ShapeFilterType::Pointer shape = ShapeFilterType::New();
+    shape->SetInput( i2l->GetOutput() );
+    shape->SetComputeFeretDiameter( true );
+    shape->SetComputePerimeter( true );
+    shape->SetNumberOfThreads( numbersOfThreads[t] );
+    shape->Update();
+    outputs[t] = shape->GetOutput();
+    outputs[t]->DisconnectPipeline();
+    }
+
+  for( unsigned int n = 0; n < outputs[0]->GetNumberOfLabelObjects(); ++n )
+    {
+    const LabelObjectType *labelObject = outputs[0]->GetNthLabelObject( n );
+    const LabelObjectType *threadedLabelObject = outputs[1]->GetLabelObject( labelObject->GetLabel() );
+    std::cout << VDimension << "D object " << labelObject->GetLabel() << ": "
+              << labelObject->GetNumberOfPixels() << " pixels, Feret diameter "
+              << labelObject->GetFeretDiameter() << ", perimeter "
+              << labelObject->GetPerimeter() << std::endl;
+
+    if( threadedLabelObject->GetFeretDiameter() != labelObject->GetFeretDiameter()
+        || threadedLabelObject->GetPerimeter() != labelObject->GetPerimeter()
+        || threadedLabelObject->GetRoundness() != labelObject->GetRoundness()
+        || threadedLabelObject->GetNumberOfPixels() != labelObject->GetNumberOfPixels() )
+      {
+      std::cerr << "Attributes with several threads: Feret diameter "
+                << threadedLabelObject->GetFeretDiameter() << ", perimeter "
+                << threadedLabelObject->GetPerimeter() << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // the largest distance between two pixels of the object
+    std::vector< typename LabelImageType::IndexType > indexes;
+    typename LabelObjectType::ConstIndexIterator iit( labelObject );
+    for(; !iit.IsAtEnd(); ++iit )
+      {
+      indexes.push_back( iit.GetIndex() );
+      }
+    double feretDiameter = 0;
+    for( size_t i = 0; i < indexes.size(); ++i )
+      {
+      for( size_t j = i + 1; j < indexes.size(); ++j )
+        {
+        double length = 0;
+        for( unsigned int d = 0; d < VDimension; ++d )
+          {
+          const itk::OffsetValueType indexDifference = indexes[i][d] - indexes[j][d];
+          length += std::pow( indexDifference * spacing[d], 2 );
+          }
+        if( feretDiameter < length )
+          {
+          feretDiameter = length;
+          }
+        }
+      }
+    feretDiameter = std::sqrt( feretDiameter );
+    if( labelObject->GetFeretDiameter() != feretDiameter )
+      {
+      std::cerr << "Feret diameter " << labelObject->GetFeretDiameter()
+                << " instead of " << feretDiameter << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+}
+
+int itkShapeLabelMapFilterLargeObjectTest( int, char *[] )
+{
+  if( ShapeLabelMapFilterLargeObjectTest< 2 >( 90 ) == EXIT_FAILURE
+      || ShapeLabelMapFilterLargeObjectTest< 3 >( 26 ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
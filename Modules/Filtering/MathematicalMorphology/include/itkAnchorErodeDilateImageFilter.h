@@ -82,9 +82,11 @@ protected:
   ~AnchorErodeDilateImageFilter() {}
   void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
-  /** Multi-thread version GenerateData. */
-  void  ThreadedGenerateData(const InputImageRegionType & outputRegionForThread,
-                             ThreadIdType threadId) ITK_OVERRIDE;
+  /** Apply the lines of the decomposition of the structuring element one
+   * after the other. All the lines parallel to a given line of the
+   * decomposition are independent, so they are shared between the threads,
+   * and the whole image is processed once per line of the decomposition. */
+  void GenerateData() ITK_OVERRIDE;
 
   // should be set by the meta filter
   InputImagePixelType m_Boundary;
@@ -95,6 +97,25 @@ private:
 
   typedef BresenhamLine< itkGetStaticConstMacro(InputImageDimension) > BresType;
 
+  typedef typename KernelType::LType KernelLType;
+
+  /** The data shared by the threads during a pass. */
+  struct LinesThreadStruct
+  {
+    Self *                 Filter;
+    InputImageConstPointer Input;
+    InputImagePointer      Output;
+    InputImageRegionType   Region;
+    InputImageRegionType   Face;
+    KernelLType            Line;
+    unsigned int           BufferLength;
+    bool                   Copy;
+  };
+
+  /** Process the lines starting in the part of the face of the thread, or
+   * copy the part of the output region of the thread when Copy is set. */
+  static ITK_THREAD_RETURN_TYPE LinesThreaderCallback(void *arg);
+
   // the class that operates on lines
   typedef AnchorErodeDilateLine< InputImagePixelType, TFunction1 > AnchorLineType;
 }; // end of class
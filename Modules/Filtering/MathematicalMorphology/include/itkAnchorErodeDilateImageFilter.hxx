@@ -19,7 +19,7 @@
 #define itkAnchorErodeDilateImageFilter_hxx
 
 #include "itkAnchorErodeDilateImageFilter.h"
-
+#include "itkImageRegionIterator.h"
 
 #include "itkAnchorUtilities.h"
 namespace itk
@@ -34,8 +34,7 @@ AnchorErodeDilateImageFilter< TImage, TKernel, TFunction1 >
 template< typename TImage, typename TKernel, typename TFunction1 >
 void
 AnchorErodeDilateImageFilter< TImage, TKernel, TFunction1 >
-::ThreadedGenerateData(const InputImageRegionType & outputRegionForThread,
-                       ThreadIdType threadId)
+::GenerateData()
 {
   // check that we are using a decomposable kernel
   if ( !this->GetKernel().GetDecomposable() )
@@ -43,10 +42,8 @@ AnchorErodeDilateImageFilter< TImage, TKernel, TFunction1 >
     itkExceptionMacro("Anchor morphology only works with decomposable structuring elements");
     return;
     }
-  // TFunction1 will be < for erosions
-  // TFunction2 will be <=
 
-  AnchorLineType AnchorLine;
+  this->AllocateOutputs();
 
   // the initial version will adopt the methodology of loading a line
   // at a time into a buffer vector, carrying out the opening or
@@ -54,11 +51,7 @@ AnchorErodeDilateImageFilter< TImage, TKernel, TFunction1 >
   // will improve cache performance when working along non raster
   // directions.
 
-  ProgressReporter progress(this, threadId, this->GetKernel().GetLines().size() + 1);
-
-  InputImageConstPointer input = this->GetInput();
-
-  InputImageRegionType IReg = outputRegionForThread;
+  InputImageRegionType IReg = this->GetOutput()->GetRequestedRegion();
   IReg.PadByRadius( this->GetKernel().GetRadius() );
   IReg.Crop( this->GetInput()->GetRequestedRegion() );
 
@@ -66,10 +59,7 @@ AnchorErodeDilateImageFilter< TImage, TKernel, TFunction1 >
   typename InputImageType::Pointer internalbuffer = InputImageType::New();
   internalbuffer->SetRegions(IReg);
   internalbuffer->Allocate();
-  InputImagePointer output = internalbuffer;
 
-  // get the region size
-  InputImageRegionType OReg = outputRegionForThread;
   // maximum buffer length is sum of dimensions
   unsigned int bufflength = 0;
   for ( unsigned i = 0; i < TImage::ImageDimension; i++ )
@@ -80,58 +70,103 @@ AnchorErodeDilateImageFilter< TImage, TKernel, TFunction1 >
   // compat
   bufflength += 2;
 
-  std::vector<InputImagePixelType> buffer(bufflength);
-  std::vector<InputImagePixelType> inbuffer(bufflength);
+  LinesThreadStruct str;
+  str.Filter = this;
+  str.Input = this->GetInput();
+  str.Output = internalbuffer;
+  str.Region = IReg;
+  str.BufferLength = bufflength;
+  str.Copy = false;
 
-  // iterate over all the structuring elements
-  typename KernelType::DecompType decomposition = this->GetKernel().GetLines();
-  BresType BresLine;
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->SetSingleMethod(this->LinesThreaderCallback, &str);
 
+  // iterate over all the structuring elements
+  const typename KernelType::DecompType & decomposition = this->GetKernel().GetLines();
+  ProgressReporter progress(this, 0, decomposition.size() + 1);
   for ( unsigned i = 0; i < decomposition.size(); i++ )
     {
-    typename KernelType::LType ThisLine = decomposition[i];
-    typename BresType::OffsetArray TheseOffsets = BresLine.BuildLine(ThisLine, bufflength);
+    str.Line = decomposition[i];
+    str.Face = MakeEnlargedFace< InputImageType, KernelLType >(str.Input, IReg, str.Line);
+    this->GetMultiThreader()->SingleMethodExecute();
 
-    typedef typename KernelType::LType KernelLType;
+    // after the first pass the input will be taken from the output
+    str.Input = internalbuffer;
+    progress.CompletedPixel();
+    }
 
-    unsigned int SELength = GetLinePixels< KernelLType >(ThisLine);
+  // copy internal buffer to output
+  str.Copy = true;
+  this->GetMultiThreader()->SingleMethodExecute();
+  progress.CompletedPixel();
+}
 
-    // want lines to be odd
-    if ( !( SELength % 2 ) )
+template< typename TImage, typename TKernel, typename TFunction1 >
+ITK_THREAD_RETURN_TYPE
+AnchorErodeDilateImageFilter< TImage, TKernel, TFunction1 >
+::LinesThreaderCallback(void *arg)
+{
+  const ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const ThreadIdType threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+  LinesThreadStruct *str = (LinesThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  if ( str->Copy )
+    {
+    InputImageRegionType OReg = str->Filter->GetOutput()->GetRequestedRegion();
+    if ( threadId < str->Filter->GetImageRegionSplitter()->GetSplit(threadId, threadCount, OReg) )
       {
-      ++SELength;
+      typedef ImageRegionIterator< InputImageType > IterType;
+      IterType oit(str->Filter->GetOutput(), OReg);
+      IterType iit(str->Output, OReg);
+      for ( oit.GoToBegin(), iit.GoToBegin(); !oit.IsAtEnd(); ++oit, ++iit )
+        {
+        oit.Set( iit.Get() );
+        }
       }
+    return ITK_THREAD_RETURN_VALUE;
+    }
 
-    InputImageRegionType BigFace = MakeEnlargedFace< InputImageType, KernelLType >(input, IReg, ThisLine);
-
-    AnchorLine.SetSize(SELength);
-
-    DoAnchorFace< TImage, BresType, AnchorLineType, KernelLType >(
-      input,
-      output,
-      m_Boundary,
-      ThisLine,
-      AnchorLine,
-      TheseOffsets,
-      inbuffer,
-      buffer,
-      IReg,
-      BigFace
-      );
-    // after the first pass the input will be taken from the output
-    input = internalbuffer;
-    progress.CompletedPixel();
+  // each thread processes the lines starting in its part of the face
+  InputImageRegionType face = str->Face;
+  if ( threadId >= str->Filter->GetImageRegionSplitter()->GetSplit(threadId, threadCount, face) )
+    {
+    return ITK_THREAD_RETURN_VALUE;
     }
 
-  // copy internal buffer to output
-  typedef ImageRegionIterator< InputImageType > IterType;
-  IterType oit(this->GetOutput(), OReg);
-  IterType iit(internalbuffer, OReg);
-  for ( oit.GoToBegin(), iit.GoToBegin(); !oit.IsAtEnd(); ++oit, ++iit )
+  // TFunction1 will be < for erosions
+  // TFunction2 will be <=
+  AnchorLineType AnchorLine;
+
+  std::vector<InputImagePixelType> buffer(str->BufferLength);
+  std::vector<InputImagePixelType> inbuffer(str->BufferLength);
+
+  BresType BresLine;
+  typename BresType::OffsetArray TheseOffsets = BresLine.BuildLine(str->Line, str->BufferLength);
+
+  unsigned int SELength = GetLinePixels< KernelLType >(str->Line);
+
+  // want lines to be odd
+  if ( !( SELength % 2 ) )
     {
-    oit.Set( iit.Get() );
+    ++SELength;
     }
-  progress.CompletedPixel();
+
+  AnchorLine.SetSize(SELength);
+
+  DoAnchorFace< TImage, BresType, AnchorLineType, KernelLType >(
+    str->Input,
+    str->Output,
+    str->Filter->m_Boundary,
+    str->Line,
+    AnchorLine,
+    TheseOffsets,
+    inbuffer,
+    buffer,
+    str->Region,
+    face
+    );
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template< typename TImage, typename TKernel, typename TFunction1 >
@@ -21,6 +21,7 @@
 #include "itkGrayscaleDilateImageFilter.h"
 #include "itkNumericTraits.h"
 #include "itkProgressAccumulator.h"
+#include "itkGrayscaleMorphologyCostModel.h"
 #include <string>
 
 namespace itk
@@ -57,39 +58,42 @@ GrayscaleDilateImageFilter< TInputImage, TOutputImage, TKernel >
 {
   const FlatKernelType *flatKernel = dynamic_cast< const FlatKernelType * >( &kernel );
 
+  // estimate the cost of each applicable algorithm, and select the cheapest
+  // one. The histogram filter must know the kernel to report the number of
+  // pixels added and removed at each translation.
+  typedef GrayscaleMorphologyCostModel< PixelType > CostModelType;
+
+  m_HistogramFilter->SetKernel(kernel);
+  int    algorithm = HISTO;
+  double cost = CostModelType::GetHistogramCost( m_HistogramFilter->GetPixelsPerTranslation(),
+                                                 m_HistogramFilter->GetUseVectorBasedAlgorithm() );
+
+  const double basicCost = CostModelType::GetBasicCost( kernel.Size() );
+  if ( basicCost < cost )
+    {
+    algorithm = BASIC;
+    cost = basicCost;
+    }
+
   if ( flatKernel != ITK_NULLPTR && flatKernel->GetDecomposable() )
     {
-    m_AnchorFilter->SetKernel(*flatKernel);
-    m_Algorithm = ANCHOR;
+    const double vhgwCost = CostModelType::GetVanHerkGilWermanCost( flatKernel->GetLines().size() );
+    if ( vhgwCost < cost )
+      {
+      algorithm = VHGW;
+      cost = vhgwCost;
+      }
     }
-  else if ( m_HistogramFilter->GetUseVectorBasedAlgorithm() )
+
+  if ( algorithm == BASIC )
     {
-    // histogram based filter is as least as good as the basic one, so always
-    // use it
-    m_Algorithm = HISTO;
-    m_HistogramFilter->SetKernel(kernel);
+    m_BasicFilter->SetKernel(kernel);
     }
-  else
+  else if ( algorithm == VHGW )
     {
-    // basic filter can be better than the histogram based one
-    // apply a poor heuristic to find the best one. What is very important is to
-    // select the histogram for large kernels
-
-    // we need to set the kernel on the histogram filter to compare basic and
-    // histogram algorithm
-    m_HistogramFilter->SetKernel(kernel);
-
-    if ( ( ImageDimension == 2 && this->GetKernel().Size() < m_HistogramFilter->GetPixelsPerTranslation() * 5.4 )
-         || ( ImageDimension == 3 && this->GetKernel().Size() < m_HistogramFilter->GetPixelsPerTranslation() * 4.5 ) )
-      {
-      m_BasicFilter->SetKernel(kernel);
-      m_Algorithm = BASIC;
-      }
-    else
-      {
-      m_Algorithm = HISTO;
-      }
+    m_VHGWFilter->SetKernel(*flatKernel);
     }
+  m_Algorithm = algorithm;
 
   Superclass::SetKernel(kernel);
 }
@@ -40,7 +40,11 @@ namespace itk
  * values (zero or one). Only elements of the structuring element
  * having values > 0 are candidates for affecting the center pixel.
  *
- * \sa MorphologyImageFilter, GrayscaleFunctionErodeImageFilter, BinaryErodeImageFilter
+ * The filter uses the backend algorithm estimated to be the fastest for
+ * the structuring element by GrayscaleMorphologyCostModel. Another
+ * algorithm can be forced with SetAlgorithm() after setting the kernel.
+ *
+ * \sa MorphologyImageFilter, GrayscaleMorphologyCostModel, GrayscaleFunctionErodeImageFilter, BinaryErodeImageFilter
  * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
  * \ingroup ITKMathematicalMorphology
  *
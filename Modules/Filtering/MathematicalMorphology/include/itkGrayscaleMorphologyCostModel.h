@@ -0,0 +1,84 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkGrayscaleMorphologyCostModel_h
+#define itkGrayscaleMorphologyCostModel_h
+
+#include "itkNumericTraits.h"
+
+namespace itk
+{
+/** \class GrayscaleMorphologyCostModel
+ * \brief Estimate the cost of the algorithms computing a grayscale
+ * dilation or erosion.
+ *
+ * The costs are expressed as an approximate time per pixel, in
+ * nanoseconds, and are only meant to be compared with each other:
+ *
+ * - the basic algorithm visits the whole structuring element for each
+ *   pixel, and is more expensive for floating point pixels;
+ * - the moving histogram algorithm updates its histogram with the pixels
+ *   entering and leaving the structuring element at each translation. The
+ *   histogram is an array for the small integer types, and a much slower
+ *   std::map for the other ones;
+ * - the van Herk/Gil-Werman algorithm needs a constant number of
+ *   operations per pixel for each line of the decomposition of the
+ *   structuring element, whatever its length.
+ *
+ * The anchor algorithm is not modeled: its cost depends on the content of
+ * the image, and it has been measured to be slower than the van Herk/Gil-Werman
+ * algorithm in all the tested configurations, so it is only used when
+ * selected explicitly.
+ *
+ * \sa GrayscaleDilateImageFilter, GrayscaleErodeImageFilter
+ * \ingroup ITKMathematicalMorphology
+ */
+template< typename TPixel >
+class GrayscaleMorphologyCostModel
+{
+public:
+  /** Cost of the basic algorithm for a structuring element of the given
+   * size. */
+  static double GetBasicCost(SizeValueType kernelSize)
+  {
+    const double costPerElement = NumericTraits< TPixel >::is_integer ? 3.5 : 5.0;
+
+    return costPerElement * kernelSize;
+  }
+
+  /** Cost of the moving histogram algorithm, for the given number of
+   * pixels added and removed at each translation of the structuring
+   * element. */
+  static double GetHistogramCost(SizeValueType pixelsPerTranslation, bool useVectorBasedAlgorithm)
+  {
+    if ( useVectorBasedAlgorithm )
+      {
+      return 15.0 + 5.0 * pixelsPerTranslation;
+      }
+    return 200.0 + 60.0 * pixelsPerTranslation;
+  }
+
+  /** Cost of the van Herk/Gil-Werman algorithm, for the given number of
+   * lines in the decomposition of the structuring element. */
+  static double GetVanHerkGilWermanCost(SizeValueType numberOfLines)
+  {
+    return 10.0 + 20.0 * numberOfLines;
+  }
+};
+} // end namespace itk
+
+#endif
@@ -35,8 +35,7 @@ VanHerkGilWermanErodeDilateImageFilter< TImage, TKernel, TFunction1 >
 template< typename TImage, typename TKernel, typename TFunction1 >
 void
 VanHerkGilWermanErodeDilateImageFilter< TImage, TKernel, TFunction1 >
-::ThreadedGenerateData(const InputImageRegionType & outputRegionForThread,
-                       ThreadIdType threadId)
+::GenerateData()
 {
   // check that we are using a decomposable kernel
   if ( !this->GetKernel().GetDecomposable() )
@@ -45,7 +44,7 @@ VanHerkGilWermanErodeDilateImageFilter< TImage, TKernel, TFunction1 >
     return;
     }
 
-// TFunction1 will be < for erosions
+  this->AllocateOutputs();
 
   // the initial version will adopt the methodology of loading a line
   // at a time into a buffer vector, carrying out the opening or
@@ -53,23 +52,15 @@ VanHerkGilWermanErodeDilateImageFilter< TImage, TKernel, TFunction1 >
   // will improve cache performance when working along non raster
   // directions.
 
-  ProgressReporter progress(this, threadId, this->GetKernel().GetLines().size() + 1);
-
-  InputImageConstPointer input = this->GetInput();
-
-  InputImageRegionType IReg = outputRegionForThread;
+  InputImageRegionType IReg = this->GetOutput()->GetRequestedRegion();
   IReg.PadByRadius( this->GetKernel().GetRadius() );
-  // IReg.PadByRadius( this->GetKernel().GetRadius() );
   IReg.Crop( this->GetInput()->GetRequestedRegion() );
 
   // allocate an internal buffer
   typename InputImageType::Pointer internalbuffer = InputImageType::New();
   internalbuffer->SetRegions(IReg);
   internalbuffer->Allocate();
-  InputImagePointer output = internalbuffer;
 
-  // get the region size
-  InputImageRegionType OReg = outputRegionForThread;
   // maximum buffer length is sum of dimensions
   unsigned int bufflength = 0;
   for ( unsigned i = 0; i < TImage::ImageDimension; i++ )
@@ -80,47 +71,90 @@ VanHerkGilWermanErodeDilateImageFilter< TImage, TKernel, TFunction1 >
   // compat
   bufflength += 2;
 
-  std::vector<InputImagePixelType> buffer(bufflength);
-  std::vector<InputImagePixelType> forward(bufflength);
-  std::vector<InputImagePixelType> reverse(bufflength);
-  // iterate over all the structuring elements
-  typename KernelType::DecompType decomposition = this->GetKernel().GetLines();
-  BresType BresLine;
+  LinesThreadStruct str;
+  str.Filter = this;
+  str.Input = this->GetInput();
+  str.Output = internalbuffer;
+  str.Region = IReg;
+  str.BufferLength = bufflength;
+  str.Copy = false;
 
-  typedef typename KernelType::LType KernelLType;
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->SetSingleMethod(this->LinesThreaderCallback, &str);
 
+  // iterate over all the structuring elements
+  const typename KernelType::DecompType & decomposition = this->GetKernel().GetLines();
+  ProgressReporter progress(this, 0, decomposition.size() + 1);
   for ( unsigned i = 0; i < decomposition.size(); i++ )
     {
-    typename KernelType::LType ThisLine = decomposition[i];
-    typename BresType::OffsetArray TheseOffsets = BresLine.BuildLine(ThisLine, bufflength);
-    unsigned int SELength = GetLinePixels< KernelLType >(ThisLine);
-    // want lines to be odd
-    if ( !( SELength % 2 ) )
-      {
-      ++SELength;
-      }
-
-    InputImageRegionType BigFace = MakeEnlargedFace< InputImageType, KernelLType >(input, IReg, ThisLine);
-
-    DoFace< TImage, BresType, TFunction1, KernelLType >(input, output, m_Boundary, ThisLine,
-                                                        TheseOffsets, SELength,
-                                                        buffer, forward,
-                                                        reverse, IReg, BigFace);
+    str.Line = decomposition[i];
+    str.Face = MakeEnlargedFace< InputImageType, KernelLType >(str.Input, IReg, str.Line);
+    this->GetMultiThreader()->SingleMethodExecute();
 
     // after the first pass the input will be taken from the output
-    input = internalbuffer;
+    str.Input = internalbuffer;
     progress.CompletedPixel();
     }
 
   // copy internal buffer to output
-  typedef ImageRegionIterator< InputImageType > IterType;
-  IterType oit(this->GetOutput(), OReg);
-  IterType iit(internalbuffer, OReg);
-  for ( oit.GoToBegin(), iit.GoToBegin(); !oit.IsAtEnd(); ++oit, ++iit )
+  str.Copy = true;
+  this->GetMultiThreader()->SingleMethodExecute();
+  progress.CompletedPixel();
+}
+
+template< typename TImage, typename TKernel, typename TFunction1 >
+ITK_THREAD_RETURN_TYPE
+VanHerkGilWermanErodeDilateImageFilter< TImage, TKernel, TFunction1 >
+::LinesThreaderCallback(void *arg)
+{
+  const ThreadIdType threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const ThreadIdType threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+  LinesThreadStruct *str = (LinesThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  if ( str->Copy )
     {
-    oit.Set( iit.Get() );
+    InputImageRegionType OReg = str->Filter->GetOutput()->GetRequestedRegion();
+    if ( threadId < str->Filter->GetImageRegionSplitter()->GetSplit(threadId, threadCount, OReg) )
+      {
+      typedef ImageRegionIterator< InputImageType > IterType;
+      IterType oit(str->Filter->GetOutput(), OReg);
+      IterType iit(str->Output, OReg);
+      for ( oit.GoToBegin(), iit.GoToBegin(); !oit.IsAtEnd(); ++oit, ++iit )
+        {
+        oit.Set( iit.Get() );
+        }
+      }
+    return ITK_THREAD_RETURN_VALUE;
     }
-  progress.CompletedPixel();
+
+  // each thread processes the lines starting in its part of the face
+  InputImageRegionType face = str->Face;
+  if ( threadId >= str->Filter->GetImageRegionSplitter()->GetSplit(threadId, threadCount, face) )
+    {
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  // TFunction1 will be < for erosions
+  std::vector<InputImagePixelType> buffer(str->BufferLength);
+  std::vector<InputImagePixelType> forward(str->BufferLength);
+  std::vector<InputImagePixelType> reverse(str->BufferLength);
+
+  BresType BresLine;
+  typename BresType::OffsetArray TheseOffsets = BresLine.BuildLine(str->Line, str->BufferLength);
+
+  unsigned int SELength = GetLinePixels< KernelLType >(str->Line);
+  // want lines to be odd
+  if ( !( SELength % 2 ) )
+    {
+    ++SELength;
+    }
+
+  DoFace< TImage, BresType, TFunction1, KernelLType >(str->Input, str->Output, str->Filter->m_Boundary, str->Line,
+                                                      TheseOffsets, SELength,
+                                                      buffer, forward,
+                                                      reverse, str->Region, face);
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template< typename TImage, typename TKernel, typename TFunction1 >
@@ -0,0 +1,135 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFlatStructuringElement.h"
+#include "itkGrayscaleDilateImageFilter.h"
+#include "itkGrayscaleErodeImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+// Check that all the algorithms of the grayscale dilation and erosion,
+// including the one selected automatically, produce the same output as
+// the basic algorithm, whatever the number of threads.
+
+template< typename TFilter >
+static int
+GrayscaleDilateErodeImageFilterCheck(const typename TFilter::InputImageType::SizeType & size,
+                                     const typename TFilter::RadiusType & radius)
+{
+  typedef typename TFilter::InputImageType ImageType;
+  typedef typename TFilter::KernelType     KernelType;
+
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  unsigned int                          seed = 12345;
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    seed = seed * 1103515245 + 12345;
+    it.Set( static_cast< typename ImageType::PixelType >( ( seed >> 16 ) % 200 ) );
+    }
+
+  const KernelType kernel = KernelType::Box( radius );
+
+  typename TFilter::Pointer basic = TFilter::New();
+  basic->SetInput( image );
+  basic->SetKernel( kernel );
+  basic->SetAlgorithm( TFilter::BASIC );
+  basic->SetNumberOfThreads( 1 );
+  basic->Update();
+
+  const char *names[5] = { "BASIC", "HISTO", "ANCHOR", "VHGW", "automatic" };
+  for ( unsigned int threads = 1; threads <= 3; threads += 2 )
+    {
+    for ( int algorithm = TFilter::HISTO; algorithm <= TFilter::VHGW + 1; algorithm++ )
+      {
+      typename TFilter::Pointer filter = TFilter::New();
+      filter->SetInput( image );
+      filter->SetKernel( kernel );
+      if ( algorithm <= TFilter::VHGW )
+        {
+        filter->SetAlgorithm( algorithm );
+        }
+      filter->SetNumberOfThreads( threads );
+      filter->Update();
+
+      itk::ImageRegionConstIterator< ImageType > eit( basic->GetOutput(), image->GetLargestPossibleRegion() );
+      itk::ImageRegionConstIterator< ImageType > rit( filter->GetOutput(), image->GetLargestPossibleRegion() );
+      for ( ; !eit.IsAtEnd(); ++eit, ++rit )
+        {
+        if ( eit.Get() != rit.Get() )
+          {
+          std::cerr << filter->GetNameOfClass() << " " << names[algorithm] << " with " << threads
+                    << " threads and radius " << radius << ": wrong value at " << eit.GetIndex()
+                    << ": expected " << static_cast< double >( eit.Get() ) << ", got "
+                    << static_cast< double >( rit.Get() ) << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+int itkGrayscaleDilateErodeImageFilterTest(int, char* [] )
+{
+  typedef itk::Image< unsigned char, 2 >  UCharImageType;
+  typedef itk::Image< short, 3 >          ShortImageType;
+  typedef itk::Image< float, 3 >          FloatImageType;
+  typedef itk::FlatStructuringElement< 2 > Kernel2Type;
+  typedef itk::FlatStructuringElement< 3 > Kernel3Type;
+
+  typedef itk::GrayscaleDilateImageFilter< UCharImageType, UCharImageType, Kernel2Type > UCharDilateType;
+  typedef itk::GrayscaleErodeImageFilter< UCharImageType, UCharImageType, Kernel2Type >  UCharErodeType;
+  typedef itk::GrayscaleDilateImageFilter< ShortImageType, ShortImageType, Kernel3Type > ShortDilateType;
+  typedef itk::GrayscaleErodeImageFilter< FloatImageType, FloatImageType, Kernel3Type >  FloatErodeType;
+
+  int status = EXIT_SUCCESS;
+
+  UCharImageType::SizeType size2 = { { 67, 45 } };
+  ShortImageType::SizeType size3 = { { 23, 17, 19 } };
+  Kernel2Type::RadiusType  radius2;
+  Kernel3Type::RadiusType  radius3;
+  for ( unsigned int r = 1; r <= 4; r += 3 )
+    {
+    radius2.Fill( r );
+    radius3.Fill( r );
+    status |= GrayscaleDilateErodeImageFilterCheck< UCharDilateType >( size2, radius2 );
+    status |= GrayscaleDilateErodeImageFilterCheck< UCharErodeType >( size2, radius2 );
+    status |= GrayscaleDilateErodeImageFilterCheck< ShortDilateType >( size3, radius3 );
+    status |= GrayscaleDilateErodeImageFilterCheck< FloatErodeType >( size3, radius3 );
+    }
+
+  // a structuring element with a different radius in each direction
+  radius2[0] = 5;
+  radius2[1] = 2;
+  radius3[0] = 1;
+  radius3[1] = 3;
+  radius3[2] = 2;
+  status |= GrayscaleDilateErodeImageFilterCheck< UCharDilateType >( size2, radius2 );
+  status |= GrayscaleDilateErodeImageFilterCheck< ShortDilateType >( size3, radius3 );
+  status |= GrayscaleDilateErodeImageFilterCheck< FloatErodeType >( size3, radius3 );
+
+  if ( status == EXIT_SUCCESS )
+    {
+    std::cout << "Test passed." << std::endl;
+    }
+  return status;
+}
@@ -20,6 +20,8 @@
 
 #include "itkBoxImageFilter.h"
 #include "itkImage.h"
+#include "itkRankHistogram.h"
+#include "itkProgressReporter.h"
 
 namespace itk
 {
@@ -35,6 +37,19 @@ namespace itk
  * This filter requires that the input pixel type provides an operator<()
  * (LessThan Comparable).
  *
+ * The algorithm is selected from the size of the neighborhood and the
+ * input pixel type:
+ * - small neighborhoods (up to GetMaximumSelectionNetworkSize() pixels,
+ *   e.g. 3x3, 5x5 or 3x3x3) are copied in an array where the median is
+ *   selected by a sorting network (Function::RankSelectionNetwork);
+ * - for larger neighborhoods and 8 or 16 bits integer pixel types, a
+ *   histogram (Function::RankHistogram) is moved over the image with
+ *   MovingBoxNeighborhood, so that only the pixels entering and leaving
+ *   the neighborhood are read at each step;
+ * - otherwise the median of each neighborhood is found with
+ *   std::nth_element().
+ * All the algorithms produce the same output.
+ *
  * \sa Image
  * \sa Neighborhood
  * \sa NeighborhoodOperator
@@ -84,6 +99,13 @@ public:
 
   typedef typename InputImageType::SizeType InputSizeType;
 
+  /** Neighborhoods up to this number of pixels are processed with a
+   * sorting network. */
+  static unsigned int GetMaximumSelectionNetworkSize()
+  {
+    return 27;
+  }
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   // Begin concept checking
   itkConceptMacro( SameDimensionCheck,
@@ -113,6 +135,25 @@ protected:
                             ThreadIdType threadId) ITK_OVERRIDE;
 
 private:
+  /** Compute the median of each neighborhood from a copy of its pixels,
+   * using a sorting network or std::nth_element(). */
+  void SelectionThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                     ProgressReporter & progress);
+
+  /** Compute the median with a moving histogram. Only available for the
+   * pixel types having a vector based RankHistogram. */
+  template< typename TPixel >
+  bool HistogramThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                     ProgressReporter & progress,
+                                     const Function::VectorRankHistogram< TPixel > *);
+
+  bool HistogramThreadedGenerateData(const OutputImageRegionType &,
+                                     ProgressReporter &,
+                                     const void *)
+  {
+    return false;
+  }
+
   MedianImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);    //purposely not implemented
 };
@@ -25,6 +25,8 @@
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
+#include "itkRankSelectionNetwork.h"
+#include "itkMovingBoxNeighborhood.h"
 
 #include <vector>
 #include <algorithm>
@@ -41,6 +43,57 @@ void
 MedianImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        ThreadIdType threadId)
+{
+  // support progress methods/callbacks
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  SizeValueType neighborhoodSize = 1;
+  for ( unsigned int i = 0; i < InputImageDimension; i++ )
+    {
+    neighborhoodSize *= 2 * this->GetRadius()[i] + 1;
+    }
+
+  typedef Function::RankHistogram< InputPixelType > HistogramType;
+  if ( neighborhoodSize <= GetMaximumSelectionNetworkSize()
+       || !this->HistogramThreadedGenerateData( outputRegionForThread, progress,
+                                                static_cast< HistogramType * >( ITK_NULLPTR ) ) )
+    {
+    this->SelectionThreadedGenerateData(outputRegionForThread, progress);
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+template< typename TPixel >
+bool
+MedianImageFilter< TInputImage, TOutputImage >
+::HistogramThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                ProgressReporter & progress,
+                                const Function::VectorRankHistogram< TPixel > *)
+{
+  typename OutputImageType::Pointer output = this->GetOutput();
+  typename  InputImageType::ConstPointer input  = this->GetInput();
+
+  // the default rank of the histogram is the median
+  Function::RankHistogram< InputPixelType > histogram;
+
+  MovingBoxNeighborhood< InputImageType > box( input, this->GetRadius(), outputRegionForThread );
+  box.Initialize(histogram);
+  do
+    {
+    output->SetPixel( box.GetIndex(),
+                      static_cast< OutputPixelType >( histogram.GetValue( NumericTraits< InputPixelType >::ZeroValue() ) ) );
+    progress.CompletedPixel();
+    }
+  while ( box.Next(histogram) );
+
+  return true;
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::SelectionThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                ProgressReporter & progress)
 {
   // Allocate output
   typename OutputImageType::Pointer output = this->GetOutput();
@@ -51,15 +104,13 @@ MedianImageFilter< TInputImage, TOutputImage >
   typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType >::FaceListType
   faceList = bC( input, outputRegionForThread, this->GetRadius() );
 
-  // support progress methods/callbacks
-  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
-
   // All of our neighborhoods have an odd number of pixels, so there is
   // always a median index (if there where an even number of pixels
   // in the neighborhood we have to average the middle two values).
 
   ZeroFluxNeumannBoundaryCondition< InputImageType > nbc;
   std::vector< InputPixelType >                      pixels;
+  Function::RankSelectionNetwork< InputPixelType >   network;
   // Process each of the boundary faces.  These are N-d regions which border
   // the edge of the buffer.
   for ( typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType >::FaceListType::iterator
@@ -73,20 +124,31 @@ MedianImageFilter< TInputImage, TOutputImage >
     bit.GoToBegin();
     const unsigned int neighborhoodSize = bit.Size();
     const unsigned int medianPosition = neighborhoodSize / 2;
+    const bool         useNetwork = neighborhoodSize <= GetMaximumSelectionNetworkSize();
+    if ( useNetwork && network.GetNumberOfValues() != neighborhoodSize )
+      {
+      network.Initialize(neighborhoodSize, medianPosition);
+      }
+    pixels.resize(neighborhoodSize);
     while ( !bit.IsAtEnd() )
       {
       // collect all the pixels in the neighborhood, note that we use
       // GetPixel on the NeighborhoodIterator to honor the boundary conditions
-      pixels.resize(neighborhoodSize);
       for ( unsigned int i = 0; i < neighborhoodSize; ++i )
         {
         pixels[i] = ( bit.GetPixel(i) );
         }
 
       // get the median value
-      const typename std::vector< InputPixelType >::iterator medianIterator = pixels.begin() + medianPosition;
-      std::nth_element( pixels.begin(), medianIterator, pixels.end() );
-      it.Set( static_cast< typename OutputImageType::PixelType >( *medianIterator ) );
+      if ( useNetwork )
+        {
+        network.Select( &pixels[0] );
+        }
+      else
+        {
+        std::nth_element( pixels.begin(), pixels.begin() + medianPosition, pixels.end() );
+        }
+      it.Set( static_cast< typename OutputImageType::PixelType >( pixels[medianPosition] ) );
 
       ++bit;
       ++it;
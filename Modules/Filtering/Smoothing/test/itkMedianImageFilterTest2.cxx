@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkRandomImageSource.h"
+#include "itkMedianImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <vector>
+#include <algorithm>
+
+// Compare the output of the median filter to a direct computation of the
+// median, for radii using the sorting network, the moving histogram and
+// std::nth_element.
+template< typename TPixel >
+static int
+MedianImageFilterCheck(unsigned int radiusValue, unsigned int numberOfThreads, TPixel minimum, TPixel maximum)
+{
+  typedef itk::Image< TPixel, 3 > ImageType;
+
+  typename itk::RandomImageSource< ImageType >::Pointer random = itk::RandomImageSource< ImageType >::New();
+  random->SetMin( minimum );
+  random->SetMax( maximum );
+  typename ImageType::SizeValueType randomSize[3] = { 13, 9, 7 };
+  random->SetSize(randomSize);
+  random->Update();
+  const ImageType *input = random->GetOutput();
+
+  typedef itk::MedianImageFilter< ImageType, ImageType > FilterType;
+  typename FilterType::Pointer median = FilterType::New();
+  median->SetInput( input );
+  median->SetNumberOfThreads( numberOfThreads );
+  typename ImageType::SizeType radius;
+  radius.Fill( radiusValue );
+  median->SetRadius( radius );
+  median->Update();
+
+  const typename ImageType::RegionType region = input->GetLargestPossibleRegion();
+  std::vector< TPixel > values;
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( median->GetOutput(), region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    // zero flux Neumann boundary conditions
+    values.clear();
+    typename ImageType::IndexType center = it.GetIndex();
+    typename ImageType::IndexType idx;
+    for ( int z = -(int)radiusValue; z <= (int)radiusValue; z++ )
+      {
+      for ( int y = -(int)radiusValue; y <= (int)radiusValue; y++ )
+        {
+        for ( int x = -(int)radiusValue; x <= (int)radiusValue; x++ )
+          {
+          const int shift[3] = { x, y, z };
+          for ( unsigned int d = 0; d < 3; d++ )
+            {
+            idx[d] = std::max( static_cast< typename ImageType::IndexValueType >( 0 ),
+                               std::min( center[d] + shift[d],
+                                         static_cast< typename ImageType::IndexValueType >( region.GetSize()[d] ) - 1 ) );
+            }
+          values.push_back( input->GetPixel(idx) );
+          }
+        }
+      }
+    std::nth_element( values.begin(), values.begin() + values.size() / 2, values.end() );
+    if ( it.Get() != values[values.size() / 2] )
+      {
+      std::cerr << "Wrong median at " << center << " for radius " << radiusValue
+                << " and " << numberOfThreads << " threads: expected "
+                << static_cast< typename itk::NumericTraits< TPixel >::PrintType >( values[values.size() / 2] )
+                << ", got " << static_cast< typename itk::NumericTraits< TPixel >::PrintType >( it.Get() )
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+int itkMedianImageFilterTest2(int, char* [] )
+{
+  int status = EXIT_SUCCESS;
+  for ( unsigned int radius = 0; radius <= 3; radius++ )
+    {
+    for ( unsigned int threads = 1; threads <= 3; threads += 2 )
+      {
+      status |= MedianImageFilterCheck< unsigned char >( radius, threads, 0, 255 );
+      status |= MedianImageFilterCheck< short >( radius, threads, -1000, 3000 );
+      status |= MedianImageFilterCheck< float >( radius, threads, -1000.0f, 3000.0f );
+      }
+    }
+
+  if ( status == EXIT_SUCCESS )
+    {
+    std::cout << "Test passed." << std::endl;
+    }
+  return status;
+}
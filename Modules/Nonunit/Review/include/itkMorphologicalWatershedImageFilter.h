@@ -33,6 +33,13 @@ namespace itk
  * labels such that object labels are consecutive and sorted based on object
  * size by passing the output of this filter to a RelabelComponentImageFilter.
  *
+ * The number of threads of this filter is passed to its internal h-minima,
+ * regional minima, connected component and watershed filters. The flooding
+ * of MorphologicalWatershedFromMarkersImageFilter pops the pixels from a
+ * single priority queue ordered by value, and the label a pixel gets
+ * depends on which basin reached it first, so it has no independent chunks
+ * and stays serial.
+ *
  * The morphological watershed transform algorithm is described in
  * Chapter 9.2 of Pierre Soille's book "Morphological Image Analysis:
  * Principles and Applications", Second Edition, Springer, 2003.
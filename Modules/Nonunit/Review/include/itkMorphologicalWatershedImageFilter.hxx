@@ -93,6 +93,7 @@ MorphologicalWatershedImageFilter< TInputImage, TOutputImage >
   rmin->SetFullyConnected(m_FullyConnected);
   rmin->SetBackgroundValue(NumericTraits< OutputImagePixelType >::ZeroValue());
   rmin->SetForegroundValue( NumericTraits< OutputImagePixelType >::max() );
+  rmin->SetNumberOfThreads( this->GetNumberOfThreads() );
 
   // label the components
   typedef ConnectedComponentImageFilter< TOutputImage, TOutputImage >
@@ -100,6 +101,7 @@ MorphologicalWatershedImageFilter< TInputImage, TOutputImage >
   typename ConnectedCompType::Pointer label = ConnectedCompType::New();
   label->SetFullyConnected(m_FullyConnected);
   label->SetInput( rmin->GetOutput() );
+  label->SetNumberOfThreads( this->GetNumberOfThreads() );
 
   // the watershed
   typedef
@@ -110,6 +112,7 @@ MorphologicalWatershedImageFilter< TInputImage, TOutputImage >
   wshed->SetMarkerImage( label->GetOutput() );
   wshed->SetFullyConnected(m_FullyConnected);
   wshed->SetMarkWatershedLine(m_MarkWatershedLine);
+  wshed->SetNumberOfThreads( this->GetNumberOfThreads() );
 
   if ( m_Level != NumericTraits< InputImagePixelType >::ZeroValue() )
     {
@@ -119,6 +122,7 @@ MorphologicalWatershedImageFilter< TInputImage, TOutputImage >
     hmin->SetInput( this->GetInput() );
     hmin->SetHeight(m_Level);
     hmin->SetFullyConnected(m_FullyConnected);
+    hmin->SetNumberOfThreads( this->GetNumberOfThreads() );
     // replace the input of the r-min filter
     rmin->SetInput( hmin->GetOutput() );
 
@@ -55,6 +55,11 @@ namespace itk
  * max(|best_parameters_i - current_parameters_i|) is less than a threshold
  * (SetParametersConvergenceTolerance).
  *
+ * When concurrent metrics are added with AddConcurrentMetric(), the n+1
+ * corners of each initial simplex are evaluated concurrently before vnl_amoeba
+ * starts from them. The following steps of the algorithm, which are run by
+ * vnl_amoeba, evaluate the cost function one corner at a time.
+ *
  * \ingroup ITKOptimizersv4
  */
 class ITKOptimizersv4_EXPORT AmoebaOptimizerv4:
@@ -141,9 +146,18 @@ protected:
 
   typedef Superclass::CostFunctionAdaptorType CostFunctionAdaptorType;
 
+  /** Evaluate the corners of the initial simplex assigned to
+   * \c evaluationId. */
+  virtual void ConcurrentEvaluation( ThreadIdType evaluationId, ThreadIdType numberOfConcurrentEvaluations ) ITK_OVERRIDE;
+
 private:
   /**Check that the settings are valid. If not throw an exception.*/
   void ValidateSettings();
+
+  /** Evaluate concurrently the corners of the simplex vnl_amoeba sets up
+   * from \c parameters and \c delta, and pass their values to the cost
+   * function adaptor. */
+  void EvaluateInitialSimplex( const InternalParametersType & parameters, const InternalParametersType & delta );
   //purposely not implemented
   AmoebaOptimizerv4(const Self &);
   //purposely not implemented
@@ -156,6 +170,9 @@ private:
   bool                            m_OptimizeWithRestarts;
   vnl_amoeba *                    m_VnlOptimizer;
 
+  std::vector< InternalParametersType > m_InitialSimplex;
+  std::vector< MeasureType >            m_InitialSimplexValues;
+
   std::ostringstream              m_StopConditionDescription;
 };
 } // end namespace itk
@@ -72,6 +72,21 @@ namespace itk
  * the number of steps along each dimension, a side of the region is
  * stepLength*(2*numberOfSteps[d]+1)*scaling[d].
  *
+ * When concurrent metrics are added with AddConcurrentMetric(), batches of
+ * consecutive grid positions are evaluated concurrently, each concurrent
+ * metric evaluating its share of the batch. The positions are still
+ * reported, and the minimum and maximum still updated, in the order of the
+ * walk, so that the results don't depend on the number of concurrent
+ * metrics.
+ *
+ * The number of positions grows exponentially with the number of
+ * parameters. SetCoarseGridStride() with a stride s larger than 1 prunes
+ * the search: the optimizer first walks the coarse grid made of every
+ * s-th position along each parameter (and the last one), then only the
+ * positions of the full grid within s-1 steps of the
+ * NumberOfCoarseGridCandidates coarse positions with the lowest metric
+ * values. The IterationEvents are only invoked for the visited positions.
+ *
  * \ingroup ITKOptimizersv4
  */
 template<typename TInternalComputationValueType>
@@ -125,6 +140,17 @@ public:
   itkGetConstReferenceMacro(MaximumMetricValuePosition, ParametersType);
   itkGetConstReferenceMacro(CurrentIndex, ParametersType);
 
+  /** Set/Get the stride of the coarse grid walked first to prune the search.
+   * The default, 1, walks the full grid. */
+  itkSetClampMacro(CoarseGridStride, SizeValueType, 1, NumericTraits< SizeValueType >::max());
+  itkGetConstMacro(CoarseGridStride, SizeValueType);
+
+  /** Set/Get the number of coarse grid positions, those with the lowest
+   * metric values, around which the full grid is walked when the search is
+   * pruned. The default is 1. */
+  itkSetClampMacro(NumberOfCoarseGridCandidates, SizeValueType, 1, NumericTraits< SizeValueType >::max());
+  itkGetConstMacro(NumberOfCoarseGridCandidates, SizeValueType);
+
   /** Get the reason for termination */
   virtual const std::string GetStopConditionDescription() const ITK_OVERRIDE;
 
@@ -147,6 +173,10 @@ protected:
 
   void IncrementIndex(ParametersType & param);
 
+  /** Evaluate the grid positions of the current batch assigned to
+   * \c evaluationId. */
+  virtual void ConcurrentEvaluation( ThreadIdType evaluationId, ThreadIdType numberOfConcurrentEvaluations ) ITK_OVERRIDE;
+
 protected:
   ParametersType  m_InitialPosition;
   MeasureType     m_CurrentValue;
@@ -158,8 +188,43 @@ protected:
   MeasureType     m_MinimumMetricValue;
   ParametersType  m_MinimumMetricValuePosition;
   ParametersType  m_MaximumMetricValuePosition;
+  SizeValueType   m_CoarseGridStride;
+  SizeValueType   m_NumberOfCoarseGridCandidates;
 
 private:
+  /** Move \c index to the next grid index of the current stage of the walk,
+   * the coarse grid or the pruned full grid. Return false at the end of the
+   * stage. */
+  bool GetNextGridIndex(ParametersType & index, SizeValueType & fineGridPosition) const;
+
+  /** Position of the grid index \c index. */
+  void ComputeGridPosition(const ParametersType & index, ParametersType & position) const;
+
+  /** Linear index of the grid index \c index, the first parameter varying fastest. */
+  SizeValueType ComputeLinearGridIndex(const ParametersType & index) const;
+
+  /** Start walking the full grid around the best coarse grid positions.
+   * Return false if there is no position left to visit. */
+  bool StartWalkingFineGrid();
+
+  /** Return the metric value at the current position, evaluating the next
+   * batch of positions concurrently when there are concurrent metrics. */
+  MeasureType GetCurrentPositionValue();
+
+  /** Pruned walk: whether the coarse grid has been walked, the metric
+   * values and linear indices of the coarse grid positions, and the linear
+   * indices of the positions of the full grid left to visit. */
+  bool                                                 m_WalkingFineGrid;
+  SizeValueType                                        m_FineGridPosition;
+  std::vector< std::pair< MeasureType, SizeValueType > > m_CoarseGridValues;
+  std::vector< SizeValueType >                         m_FineGridIndices;
+
+  /** Positions of the batch evaluated concurrently, starting at iteration
+   * m_BatchBegin, and their metric values. */
+  SizeValueType                                        m_BatchBegin;
+  std::vector< ParametersType >                        m_BatchPositions;
+  std::vector< MeasureType >                           m_BatchValues;
+
   //purposely not implemented
   ExhaustiveOptimizerv4(const Self &);
   void operator=(const Self &);
@@ -19,6 +19,8 @@
 #define itkExhaustiveOptimizerv4_hxx
 
 #include "itkExhaustiveOptimizerv4.h"
+#include <algorithm>
+#include <set>
 
 namespace itk
 {
@@ -33,6 +35,11 @@ ExhaustiveOptimizerv4<TInternalComputationValueType>
   m_CurrentIndex(0),
   m_MaximumMetricValue(0.0),
   m_MinimumMetricValue(0.0),
+  m_CoarseGridStride(1),
+  m_NumberOfCoarseGridCandidates(1),
+  m_WalkingFineGrid(false),
+  m_FineGridPosition(0),
+  m_BatchBegin(0),
   m_StopConditionDescription("")
 {
   this->m_NumberOfIterations = 0;
@@ -79,6 +86,13 @@ ExhaustiveOptimizerv4<TInternalComputationValueType>
   m_CurrentIndex.SetSize(spaceDimension);
   m_CurrentIndex.Fill(0);
 
+  m_WalkingFineGrid = false;
+  m_FineGridPosition = 0;
+  m_CoarseGridValues.clear();
+  m_FineGridIndices.clear();
+  m_BatchBegin = 0;
+  m_BatchPositions.clear();
+
   const ScalesType & scales = this->GetScales();
   // Make sure the scales have been set properly
   if ( scales.size() != spaceDimension )
@@ -121,7 +135,7 @@ ExhaustiveOptimizerv4<TInternalComputationValueType>
       break;
       }
 
-    m_CurrentValue = this->m_Metric->GetValue();
+    m_CurrentValue = this->GetCurrentPositionValue();
 
     if ( m_CurrentValue > m_MaximumMetricValue )
       {
@@ -133,6 +147,10 @@ ExhaustiveOptimizerv4<TInternalComputationValueType>
       m_MinimumMetricValue = m_CurrentValue;
       m_MinimumMetricValuePosition = currentPosition;
       }
+    if ( m_CoarseGridStride > 1 && !m_WalkingFineGrid )
+      {
+      m_CoarseGridValues.push_back( std::make_pair( m_CurrentValue, this->ComputeLinearGridIndex( m_CurrentIndex ) ) );
+      }
 
     if ( m_Stop )
       {
@@ -183,38 +201,222 @@ void
 ExhaustiveOptimizerv4<TInternalComputationValueType>
 ::IncrementIndex(ParametersType & newPosition)
 {
-  unsigned int       idx = 0;
   const unsigned int spaceDimension = this->m_Metric->GetParameters().GetSize();
 
-  while ( idx < spaceDimension )
+  if ( !this->GetNextGridIndex( m_CurrentIndex, m_FineGridPosition ) &&
+       !( m_CoarseGridStride > 1 && !m_WalkingFineGrid && this->StartWalkingFineGrid() ) )
     {
-    m_CurrentIndex[idx]++;
+    m_Stop = true;
+    m_StopConditionDescription.str("");
+    m_StopConditionDescription << this->GetNameOfClass() << ": ";
+    m_StopConditionDescription << "Completed sampling of parametric space of size " << spaceDimension;
+    }
+
+  this->ComputeGridPosition( m_CurrentIndex, newPosition );
+}
 
-    if ( m_CurrentIndex[idx] > ( 2 * m_NumberOfSteps[idx] ) )
+template<typename TInternalComputationValueType>
+bool
+ExhaustiveOptimizerv4<TInternalComputationValueType>
+::GetNextGridIndex(ParametersType & index, SizeValueType & fineGridPosition) const
+{
+  const unsigned int spaceDimension = index.GetSize();
+
+  if ( m_WalkingFineGrid )
+    {
+    ++fineGridPosition;
+    if ( fineGridPosition >= m_FineGridIndices.size() )
       {
-      m_CurrentIndex[idx] = 0;
+      return false;
+      }
+    SizeValueType linearIndex = m_FineGridIndices[fineGridPosition];
+    for ( unsigned int i = 0; i < spaceDimension; i++ )
+      {
+      index[i] = linearIndex % ( 2 * m_NumberOfSteps[i] + 1 );
+      linearIndex /= ( 2 * m_NumberOfSteps[i] + 1 );
+      }
+    return true;
+    }
+
+  // Walk the coarse grid, or the full grid when its stride is 1.
+  unsigned int idx = 0;
+  while ( idx < spaceDimension )
+    {
+    const double lastIndex = 2 * m_NumberOfSteps[idx];
+    if ( index[idx] >= lastIndex )
+      {
+      index[idx] = 0;
       idx++;
       }
     else
       {
+      index[idx] = std::min( index[idx] + m_CoarseGridStride, lastIndex );
       break;
       }
     }
+  return idx < spaceDimension;
+}
+
+template<typename TInternalComputationValueType>
+void
+ExhaustiveOptimizerv4<TInternalComputationValueType>
+::ComputeGridPosition(const ParametersType & index, ParametersType & position) const
+{
+  const unsigned int spaceDimension = index.GetSize();
+  const ScalesType & scales = this->GetScales();
 
-  if ( idx == spaceDimension )
+  position.SetSize( spaceDimension );
+  for ( unsigned int i = 0; i < spaceDimension; i++ )
     {
-    m_Stop = true;
-    m_StopConditionDescription.str("");
-    m_StopConditionDescription << this->GetNameOfClass() << ": ";
-    m_StopConditionDescription << "Completed sampling of parametric space of size " << spaceDimension;
+    position[i] = ( index[i] - m_NumberOfSteps[i] )
+                  * m_StepLength * scales[i]
+                  + m_InitialPosition[i];
     }
+}
 
-  const ScalesType & scales = this->GetScales();
+template<typename TInternalComputationValueType>
+SizeValueType
+ExhaustiveOptimizerv4<TInternalComputationValueType>
+::ComputeLinearGridIndex(const ParametersType & index) const
+{
+  SizeValueType linearIndex = 0;
+  for ( unsigned int i = index.GetSize(); i > 0; i-- )
+    {
+    linearIndex = linearIndex * ( 2 * m_NumberOfSteps[i - 1] + 1 ) + static_cast< SizeValueType >( index[i - 1] );
+    }
+  return linearIndex;
+}
+
+template<typename TInternalComputationValueType>
+bool
+ExhaustiveOptimizerv4<TInternalComputationValueType>
+::StartWalkingFineGrid()
+{
+  m_WalkingFineGrid = true;
+  m_FineGridPosition = 0;
+
+  const unsigned int spaceDimension = m_CurrentIndex.GetSize();
+  const SizeValueType radius = m_CoarseGridStride - 1;
+
+  // The best candidates first, ties broken by their order in the walk.
+  std::sort( m_CoarseGridValues.begin(), m_CoarseGridValues.end() );
+  const SizeValueType numberOfCandidates =
+    std::min( m_NumberOfCoarseGridCandidates, static_cast< SizeValueType >( m_CoarseGridValues.size() ) );
+
+  std::set< SizeValueType > fineGridIndices;
+  ParametersType            candidate( spaceDimension );
+  ParametersType            lower( spaceDimension );
+  ParametersType            upper( spaceDimension );
+  ParametersType            index( spaceDimension );
+  for ( SizeValueType c = 0; c < numberOfCandidates; c++ )
+    {
+    SizeValueType linearIndex = m_CoarseGridValues[c].second;
+    for ( unsigned int i = 0; i < spaceDimension; i++ )
+      {
+      candidate[i] = linearIndex % ( 2 * m_NumberOfSteps[i] + 1 );
+      linearIndex /= ( 2 * m_NumberOfSteps[i] + 1 );
+      lower[i] = std::max( candidate[i] - radius, 0.0 );
+      upper[i] = std::min( candidate[i] + radius, static_cast< double >( 2 * m_NumberOfSteps[i] ) );
+      }
+
+    // Add the positions of the neighborhood which aren't on the coarse grid.
+    index = lower;
+    unsigned int idx = 0;
+    while ( idx < spaceDimension )
+      {
+      bool onCoarseGrid = true;
+      for ( unsigned int i = 0; i < spaceDimension && onCoarseGrid; i++ )
+        {
+        const SizeValueType k = static_cast< SizeValueType >( index[i] );
+        onCoarseGrid = ( k % m_CoarseGridStride == 0 || k == 2 * m_NumberOfSteps[i] );
+        }
+      if ( !onCoarseGrid )
+        {
+        fineGridIndices.insert( this->ComputeLinearGridIndex( index ) );
+        }
+
+      idx = 0;
+      while ( idx < spaceDimension )
+        {
+        if ( index[idx] >= upper[idx] )
+          {
+          index[idx] = lower[idx];
+          idx++;
+          }
+        else
+          {
+          index[idx] += 1;
+          break;
+          }
+        }
+      }
+    }
+
+  m_FineGridIndices.assign( fineGridIndices.begin(), fineGridIndices.end() );
+  if ( m_FineGridIndices.empty() )
+    {
+    return false;
+    }
+  SizeValueType linearIndex = m_FineGridIndices[0];
   for ( unsigned int i = 0; i < spaceDimension; i++ )
     {
-    newPosition[i] = ( m_CurrentIndex[i] - m_NumberOfSteps[i] )
-                     * m_StepLength * scales[i]
-                     + this->GetInitialPosition()[i];
+    m_CurrentIndex[i] = linearIndex % ( 2 * m_NumberOfSteps[i] + 1 );
+    linearIndex /= ( 2 * m_NumberOfSteps[i] + 1 );
+    }
+  return true;
+}
+
+template<typename TInternalComputationValueType>
+typename ExhaustiveOptimizerv4<TInternalComputationValueType>::MeasureType
+ExhaustiveOptimizerv4<TInternalComputationValueType>
+::GetCurrentPositionValue()
+{
+  const ThreadIdType numberOfConcurrentEvaluations =
+    this->GetNumberOfConcurrentEvaluations( NumericTraits< SizeValueType >::max() );
+  if ( numberOfConcurrentEvaluations <= 1 )
+    {
+    return this->m_Metric->GetValue();
+    }
+
+  if ( this->m_CurrentIteration < m_BatchBegin || this->m_CurrentIteration >= m_BatchBegin + m_BatchPositions.size() )
+    {
+    // Batches of 16 positions per metric amortize starting the threads.
+    const SizeValueType batchSize = 16 * numberOfConcurrentEvaluations;
+
+    m_BatchBegin = this->m_CurrentIteration;
+    m_BatchPositions.clear();
+    m_BatchPositions.push_back( this->GetCurrentPosition() );
+    ParametersType index = m_CurrentIndex;
+    SizeValueType  fineGridPosition = m_FineGridPosition;
+    ParametersType position;
+    while ( m_BatchPositions.size() < batchSize && this->GetNextGridIndex( index, fineGridPosition ) )
+      {
+      this->ComputeGridPosition( index, position );
+      m_BatchPositions.push_back( position );
+      }
+    m_BatchValues.resize( m_BatchPositions.size() );
+
+    this->ExecuteConcurrentEvaluations( std::min( numberOfConcurrentEvaluations,
+                                                  static_cast< ThreadIdType >( m_BatchPositions.size() ) ) );
+
+    // Reset the position of the metric
+    this->m_Metric->SetParameters( m_BatchPositions[0] );
+    }
+
+  return m_BatchValues[this->m_CurrentIteration - m_BatchBegin];
+}
+
+template<typename TInternalComputationValueType>
+void
+ExhaustiveOptimizerv4<TInternalComputationValueType>
+::ConcurrentEvaluation( ThreadIdType evaluationId, ThreadIdType numberOfConcurrentEvaluations )
+{
+  typename Superclass::MetricType * metric = this->GetConcurrentEvaluationMetric( evaluationId );
+  for ( SizeValueType i = evaluationId; i < m_BatchPositions.size(); i += numberOfConcurrentEvaluations )
+    {
+    ParametersType position( m_BatchPositions[i] );
+    metric->SetParameters( position );
+    m_BatchValues[i] = metric->GetValue();
     }
 }
 
@@ -252,6 +454,8 @@ ExhaustiveOptimizerv4<TInternalComputationValueType>
   os << indent << "MinimumMetricValue = " << m_MinimumMetricValue << std::endl;
   os << indent << "MinimumMetricValuePosition = " << m_MinimumMetricValuePosition << std::endl;
   os << indent << "MaximumMetricValuePosition = " << m_MaximumMetricValuePosition << std::endl;
+  os << indent << "CoarseGridStride = " << m_CoarseGridStride << std::endl;
+  os << indent << "NumberOfCoarseGridCandidates = " << m_NumberOfCoarseGridCandidates << std::endl;
 }
 } // end namespace itk
 
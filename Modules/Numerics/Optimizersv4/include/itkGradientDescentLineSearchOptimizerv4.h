@@ -53,6 +53,13 @@ namespace itk
  * parameters that were calculated during the optimization.
  * See SetReturnBestParametersAndValue().
  *
+ * The metric value of each learning rate visited by the line search is
+ * computed only once. When concurrent metrics are added with
+ * AddConcurrentMetric(), the line search speculatively evaluates, together
+ * with the next learning rate it needs, those it would need after the
+ * following comparisons, so that several steps of the golden section search
+ * are done in the time of one metric evaluation.
+ *
  * \ingroup ITKOptimizersv4
  */
 template<typename TInternalComputationValueType>
@@ -79,6 +86,7 @@ public:
   typedef typename Superclass::DerivativeType      DerivativeType;
 
   /** Metric type over which this class is templated */
+  typedef typename Superclass::MetricType          MetricType;
   typedef typename Superclass::MeasureType         MeasureType;
   typedef typename Superclass::ParametersType      ParametersType;
 
@@ -122,6 +130,10 @@ protected:
 
   TInternalComputationValueType GoldenSectionSearch( TInternalComputationValueType a, TInternalComputationValueType b, TInternalComputationValueType c );
 
+  /** Evaluate the metric at the learning rates of the current line search
+   * batch assigned to \c evaluationId. */
+  virtual void ConcurrentEvaluation( ThreadIdType evaluationId, ThreadIdType numberOfConcurrentEvaluations ) ITK_OVERRIDE;
+
   TInternalComputationValueType m_LowerLimit;
   TInternalComputationValueType m_UpperLimit;
   TInternalComputationValueType m_Phi;
@@ -134,6 +146,41 @@ protected:
   unsigned int      m_LineSearchIterations;
 
 private:
+  /** Return the learning rate probed by the golden section search within
+   * the bracket ( a, b, c ), or false if the search ends there. */
+  bool GoldenSectionProbe( TInternalComputationValueType a, TInternalComputationValueType b,
+                           TInternalComputationValueType c, unsigned int lineSearchIterations,
+                           TInternalComputationValueType & x ) const;
+
+  /** Return the index of \c learningRate in the evaluated learning rates, or
+   * their number if it has not been evaluated. */
+  SizeValueType FindLineSearchLearningRate( TInternalComputationValueType learningRate ) const;
+
+  /** Evaluate the learning rates \c b and \c x of the bracket ( a, b, c ),
+   * together with the ones the following steps of the search may need. */
+  void EvaluateLineSearchLearningRates( TInternalComputationValueType a, TInternalComputationValueType b,
+                                        TInternalComputationValueType c, TInternalComputationValueType x );
+
+  /** Bracket of a step of the golden section search, with the learning rate
+   * probed within it. */
+  struct BracketType
+    {
+    TInternalComputationValueType a;
+    TInternalComputationValueType b;
+    TInternalComputationValueType c;
+    TInternalComputationValueType x;
+    unsigned int                  lineSearchIterations;
+    };
+
+  /** Learning rates evaluated by the current line search and their metric
+   * values. The current batch, [m_LineSearchBatchBegin, end), is evaluated
+   * concurrently from the position and gradient at the start of the search. */
+  std::vector< TInternalComputationValueType > m_LineSearchLearningRates;
+  std::vector< MeasureType >                   m_LineSearchValues;
+  SizeValueType                                m_LineSearchBatchBegin;
+  ParametersType                               m_LineSearchBaseParameters;
+  DerivativeType                               m_LineSearchBaseGradient;
+
   GradientDescentLineSearchOptimizerv4Template( const Self & ); //purposely not implemented
   void operator=( const Self& ); //purposely not implemented
 
@@ -19,6 +19,7 @@
 #define itkGradientDescentLineSearchOptimizerv4_hxx
 
 #include "itkGradientDescentLineSearchOptimizerv4.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -32,6 +33,7 @@ GradientDescentLineSearchOptimizerv4Template<TInternalComputationValueType>
 {
   this->m_MaximumLineSearchIterations = 20;
   this->m_LineSearchIterations = NumericTraits<unsigned int>::ZeroValue();
+  this->m_LineSearchBatchBegin = 0;
   this->m_LowerLimit = itk::NumericTraits< TInternalComputationValueType >::ZeroValue();
   this->m_UpperLimit = 5.0;
   this->m_Phi = 1.618034;
@@ -116,13 +118,73 @@ TInternalComputationValueType
 GradientDescentLineSearchOptimizerv4Template<TInternalComputationValueType>
 ::GoldenSectionSearch( TInternalComputationValueType a, TInternalComputationValueType b, TInternalComputationValueType c )
 {
-  if ( this->m_LineSearchIterations > this->m_MaximumLineSearchIterations )
+  // Cache the parameters and gradient the learning rates are evaluated from.
+  this->m_LineSearchBaseParameters = this->GetCurrentPosition();
+  this->m_LineSearchBaseGradient = this->m_Gradient;
+  this->m_LineSearchLearningRates.clear();
+  this->m_LineSearchValues.clear();
+
+  TInternalComputationValueType x;
+  while( this->GoldenSectionProbe( a, b, c, this->m_LineSearchIterations, x ) )
     {
-    return ( c + a ) / 2;
+    this->m_LineSearchIterations++;
+
+    SizeValueType xIndex = this->FindLineSearchLearningRate( x );
+    SizeValueType bIndex = this->FindLineSearchLearningRate( b );
+    if( xIndex == this->m_LineSearchLearningRates.size() || bIndex == this->m_LineSearchLearningRates.size() )
+      {
+      this->EvaluateLineSearchLearningRates( a, b, c, x );
+      xIndex = this->FindLineSearchLearningRate( x );
+      bIndex = this->FindLineSearchLearningRate( b );
+      }
+    const MeasureType metricx = this->m_LineSearchValues[xIndex];
+    const MeasureType metricb = this->m_LineSearchValues[bIndex];
+
+    /** golden section */
+    if (  metricx < metricb )
+      {
+      if (c - b > b - a)
+        {
+        a = b;
+        b = x;
+        }
+      else
+        {
+        c = b;
+        b = x;
+        }
+      }
+    else
+      {
+      if ( c - b > b - a )
+        {
+        c = x;
+        }
+      else
+        {
+        a = x;
+        }
+      }
     }
-  this->m_LineSearchIterations++;
 
-  TInternalComputationValueType x;
+  // Free the cached position and gradient, which can be large with dense
+  // transforms.
+  this->m_LineSearchBaseParameters.SetSize( 0 );
+  this->m_LineSearchBaseGradient.SetSize( 0 );
+  return ( c + a ) / 2;
+}
+
+template<typename TInternalComputationValueType>
+bool
+GradientDescentLineSearchOptimizerv4Template<TInternalComputationValueType>
+::GoldenSectionProbe( TInternalComputationValueType a, TInternalComputationValueType b,
+                      TInternalComputationValueType c, unsigned int lineSearchIterations,
+                      TInternalComputationValueType & x ) const
+{
+  if ( lineSearchIterations > this->m_MaximumLineSearchIterations )
+    {
+    return false;
+    }
   if ( c - b > b - a )
     {
     x = b + this->m_Resphi * ( c - b );
@@ -131,67 +193,111 @@ GradientDescentLineSearchOptimizerv4Template<TInternalComputationValueType>
     {
     x = b - this->m_Resphi * ( b - a );
     }
-  if ( std::abs( c - a ) < this->m_Epsilon * ( std::abs( b ) + std::abs( x ) ) )
+  return !( std::abs( c - a ) < this->m_Epsilon * ( std::abs( b ) + std::abs( x ) ) );
+}
+
+template<typename TInternalComputationValueType>
+SizeValueType
+GradientDescentLineSearchOptimizerv4Template<TInternalComputationValueType>
+::FindLineSearchLearningRate( TInternalComputationValueType learningRate ) const
+{
+  SizeValueType i = 0;
+  while( i < this->m_LineSearchLearningRates.size() && this->m_LineSearchLearningRates[i] != learningRate )
     {
-    return ( c + a ) / 2;
+    ++i;
     }
+  return i;
+}
 
-  TInternalComputationValueType metricx, metricb;
+template<typename TInternalComputationValueType>
+void
+GradientDescentLineSearchOptimizerv4Template<TInternalComputationValueType>
+::EvaluateLineSearchLearningRates( TInternalComputationValueType a, TInternalComputationValueType b,
+                                   TInternalComputationValueType c, TInternalComputationValueType x )
+{
+  const ThreadIdType numberOfConcurrentEvaluations =
+    this->GetNumberOfConcurrentEvaluations( NumericTraits<SizeValueType>::max() );
 
+  this->m_LineSearchBatchBegin = this->m_LineSearchLearningRates.size();
+  if( this->FindLineSearchLearningRate( b ) == this->m_LineSearchLearningRates.size() )
     {
-      // Cache the learning rate , parameters , gradient
-      // Contain this in a block so these variables go out of
-      // scope before we call recursively below. With dense transforms
-      // we would otherwise eat up a lot of memory unnecessarily.
-    TInternalComputationValueType baseLearningRate = this->m_LearningRate;
-    DerivativeType baseGradient( this->m_Gradient );
-    ParametersType baseParameters( this->GetCurrentPosition() );
-
-    this->m_LearningRate = x;
-    this->ModifyGradientByLearningRate();
-    this->m_Metric->UpdateTransformParameters( this->m_Gradient );
-    metricx = this->GetMetric()->GetValue( );
-
-    /** reset position of transform and gradient */
-    this->m_Metric->SetParameters( baseParameters );
-    this->m_Gradient = baseGradient;
-
-    this->m_LearningRate = b;
-    this->ModifyGradientByLearningRate();
-
-    this->m_Metric->UpdateTransformParameters( this->m_Gradient );
-    metricb = this->GetMetric()->GetValue( );
-
-    /** reset position of transform and learning rate */
-    this->m_Metric->SetParameters( baseParameters );
-    this->m_Gradient = baseGradient;
-    this->m_LearningRate = baseLearningRate;
+    this->m_LineSearchLearningRates.push_back( b );
+    }
+  if( this->FindLineSearchLearningRate( x ) == this->m_LineSearchLearningRates.size() )
+    {
+    this->m_LineSearchLearningRates.push_back( x );
     }
 
-  /** golden section */
-  if (  metricx < metricb )
+  // Speculatively add the learning rates probed after either outcome of the
+  // comparisons, breadth first, while there are idle concurrent metrics.
+  std::vector< BracketType > brackets;
+  const BracketType bracket = { a, b, c, x, this->m_LineSearchIterations };
+  brackets.push_back( bracket );
+  for( SizeValueType i = 0; i < brackets.size() &&
+       this->m_LineSearchLearningRates.size() - this->m_LineSearchBatchBegin < numberOfConcurrentEvaluations; ++i )
     {
-    if (c - b > b - a)
+    const BracketType current = brackets[i];
+    BracketType next[2];
+    if( current.c - current.b > current.b - current.a )
       {
-      return this->GoldenSectionSearch( b, x, c );
+      const BracketType xIsBetter = { current.b, current.x, current.c, 0, current.lineSearchIterations };
+      const BracketType bIsBetter = { current.a, current.b, current.x, 0, current.lineSearchIterations };
+      next[0] = xIsBetter;
+      next[1] = bIsBetter;
       }
     else
       {
-      return this->GoldenSectionSearch( a, x, b );
+      const BracketType xIsBetter = { current.a, current.x, current.b, 0, current.lineSearchIterations };
+      const BracketType bIsBetter = { current.x, current.b, current.c, 0, current.lineSearchIterations };
+      next[0] = xIsBetter;
+      next[1] = bIsBetter;
       }
-    }
-  else
-    {
-    if ( c - b > b - a )
+    for( unsigned int n = 0; n < 2 &&
+         this->m_LineSearchLearningRates.size() - this->m_LineSearchBatchBegin < numberOfConcurrentEvaluations; ++n )
       {
-      return this->GoldenSectionSearch( a, b, x );
+      if( this->GoldenSectionProbe( next[n].a, next[n].b, next[n].c, next[n].lineSearchIterations, next[n].x ) )
+        {
+        next[n].lineSearchIterations++;
+        if( this->FindLineSearchLearningRate( next[n].x ) == this->m_LineSearchLearningRates.size() )
+          {
+          this->m_LineSearchLearningRates.push_back( next[n].x );
+          }
+        brackets.push_back( next[n] );
+        }
       }
-    else
+    }
+
+  this->m_LineSearchValues.resize( this->m_LineSearchLearningRates.size() );
+  const SizeValueType batchSize = this->m_LineSearchLearningRates.size() - this->m_LineSearchBatchBegin;
+  this->ExecuteConcurrentEvaluations( std::min( numberOfConcurrentEvaluations,
+                                                static_cast<ThreadIdType>( batchSize ) ) );
+
+  /** reset position of transform */
+  this->m_Metric->SetParameters( this->m_LineSearchBaseParameters );
+}
+
+template<typename TInternalComputationValueType>
+void
+GradientDescentLineSearchOptimizerv4Template<TInternalComputationValueType>
+::ConcurrentEvaluation( ThreadIdType evaluationId, ThreadIdType numberOfConcurrentEvaluations )
+{
+  MetricType * metric = this->GetConcurrentEvaluationMetric( evaluationId );
+  for( SizeValueType i = this->m_LineSearchBatchBegin + evaluationId; i < this->m_LineSearchLearningRates.size();
+       i += numberOfConcurrentEvaluations )
+    {
+    // Same update as ModifyGradientByLearningRate() followed by
+    // UpdateTransformParameters() from the start of the search.
+    DerivativeType update( this->m_LineSearchBaseGradient );
+    const TInternalComputationValueType learningRate = this->m_LineSearchLearningRates[i];
+    for( SizeValueType j = 0; j < update.Size(); ++j )
       {
-      return this->GoldenSectionSearch( x, b, c  );
+      update[j] = update[j] * learningRate;
       }
+    metric->SetParameters( this->m_LineSearchBaseParameters );
+    metric->UpdateTransformParameters( update );
+    this->m_LineSearchValues[i] = metric->GetValue();
     }
-  }
+}
 
 }//namespace itk
 
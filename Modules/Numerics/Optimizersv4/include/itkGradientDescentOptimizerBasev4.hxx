@@ -141,17 +141,12 @@ GradientDescentOptimizerBasev4Template<TInternalComputationValueType>
                       "are enabled. Not allowed. ");
     }
 
-  /* Estimate the parameter scales if requested. */
-  if ( this->m_ScalesEstimator.IsNotNull() && this->m_DoEstimateScales )
+  /* The parameter scales are estimated by the superclass. If the user
+   * hasn't set the maximum step size, assign the default. */
+  if ( this->m_ScalesEstimator.IsNotNull() && this->m_DoEstimateScales &&
+       this->m_MaximumStepSizeInPhysicalUnits <= NumericTraits<TInternalComputationValueType>::epsilon() )
     {
-    this->m_ScalesEstimator->EstimateScales(this->m_Scales);
-    itkDebugMacro( "Estimated scales = " << this->m_Scales );
-
-    /* If user hasn't set this, assign the default. */
-    if ( this->m_MaximumStepSizeInPhysicalUnits <= NumericTraits<TInternalComputationValueType>::epsilon())
-      {
-      this->m_MaximumStepSizeInPhysicalUnits = this->m_ScalesEstimator->EstimateMaximumStepSize();
-      }
+    this->m_MaximumStepSizeInPhysicalUnits = this->m_ScalesEstimator->EstimateMaximumStepSize();
     }
 
   if ( this->m_UseConvergenceMonitoring )
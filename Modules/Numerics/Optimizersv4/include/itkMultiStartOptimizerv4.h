@@ -34,6 +34,14 @@ namespace itk
    *   focus modifying the parameter sample space.  This is why we place the burden on the user to provide
    *   the parameter samples over which to optimize.
    *
+   *   The starts are independent, and run concurrently when concurrent metrics
+   *   are added with AddConcurrentMetric(): each concurrent metric runs the
+   *   starts of one thread, sharing the number of threads of the optimizer
+   *   with the other metrics. When a local optimizer is set, each concurrent
+   *   metric also needs its own local optimizer, set up like the local
+   *   optimizer and added with AddConcurrentLocalOptimizer(). The results do
+   *   not depend on the number of concurrent starts.
+   *
    * \ingroup ITKOptimizersv4
    */
 template<typename TInternalComputationValueType>
@@ -131,6 +139,17 @@ public:
 
   inline ParameterListSizeType GetBestParametersIndex( ) { return this->m_BestParametersIndex; }
 
+  /** Add a local optimizer, set up like the local optimizer, used by a
+   * concurrent metric to run its starts.
+   * \sa ObjectToObjectOptimizerBaseTemplate::AddConcurrentMetric() */
+  void AddConcurrentLocalOptimizer( OptimizerType * optimizer );
+
+  /** Remove all the concurrent local optimizers. */
+  void ClearConcurrentLocalOptimizers();
+
+  /** Get the number of concurrent local optimizers. */
+  SizeValueType GetNumberOfConcurrentLocalOptimizers() const;
+
 protected:
   /** Default constructor */
   MultiStartOptimizerv4Template();
@@ -138,6 +157,9 @@ protected:
 
   virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
+  /** Run the starts of the current batch assigned to \c evaluationId. */
+  virtual void ConcurrentEvaluation( ThreadIdType evaluationId, ThreadIdType numberOfConcurrentEvaluations ) ITK_OVERRIDE;
+
   /* Common variables for optimization control and reporting */
   bool                          m_Stop;
   StopConditionType             m_StopCondition;
@@ -150,6 +172,17 @@ protected:
   OptimizerPointer              m_LocalOptimizer;
 
 private:
+  /** Local optimizers of the concurrent metrics. */
+  std::vector< OptimizerPointer > m_ConcurrentLocalOptimizers;
+
+  /** Starts run concurrently, in [m_ConcurrentStartsBegin, m_ConcurrentStartsEnd),
+   * with their metric values and whether they succeeded. Unlike those of
+   * std::vector< bool >, the flags can be written concurrently. */
+  ParameterListSizeType           m_ConcurrentStartsBegin;
+  ParameterListSizeType           m_ConcurrentStartsEnd;
+  MetricValuesListType            m_ConcurrentStartValues;
+  std::vector< unsigned char >    m_ConcurrentStartSucceeded;
+
   MultiStartOptimizerv4Template( const Self & ); //purposely not implemented
   void operator=( const Self& ); //purposely not implemented
 
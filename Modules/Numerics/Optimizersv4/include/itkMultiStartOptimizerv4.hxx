@@ -19,6 +19,7 @@
 #define itkMultiStartOptimizerv4_hxx
 
 #include "itkMultiStartOptimizerv4.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -37,6 +38,8 @@ MultiStartOptimizerv4Template<TInternalComputationValueType>
   this->m_MaximumMetricValue=NumericTraits<MeasureType>::max();
   this->m_MinimumMetricValue = this->m_MaximumMetricValue;
   m_LocalOptimizer = ITK_NULLPTR;
+  this->m_ConcurrentStartsBegin = static_cast<ParameterListSizeType>(0);
+  this->m_ConcurrentStartsEnd = static_cast<ParameterListSizeType>(0);
 }
 
 //-------------------------------------------------------------------
@@ -54,6 +57,7 @@ MultiStartOptimizerv4Template<TInternalComputationValueType>
   Superclass::PrintSelf(os, indent);
   os << indent << "Stop condition:"<< this->m_StopCondition << std::endl;
   os << indent << "Stop condition description: " << this->m_StopConditionDescription.str()  << std::endl;
+  os << indent << "Number of concurrent local optimizers: " << this->m_ConcurrentLocalOptimizers.size() << std::endl;
 }
 
 //-------------------------------------------------------------------
@@ -109,6 +113,42 @@ MultiStartOptimizerv4Template<TInternalComputationValueType>
   this->m_LocalOptimizer=optimizer;
 }
 
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+MultiStartOptimizerv4Template<TInternalComputationValueType>
+::AddConcurrentLocalOptimizer( OptimizerType * optimizer )
+{
+  if( optimizer == ITK_NULLPTR )
+    {
+    itkExceptionMacro("The concurrent local optimizer must not be null.");
+    }
+  this->m_ConcurrentLocalOptimizers.push_back( optimizer );
+  this->Modified();
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+MultiStartOptimizerv4Template<TInternalComputationValueType>
+::ClearConcurrentLocalOptimizers()
+{
+  if( !this->m_ConcurrentLocalOptimizers.empty() )
+    {
+    this->m_ConcurrentLocalOptimizers.clear();
+    this->Modified();
+    }
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+SizeValueType
+MultiStartOptimizerv4Template<TInternalComputationValueType>
+::GetNumberOfConcurrentLocalOptimizers() const
+{
+  return static_cast<SizeValueType>( this->m_ConcurrentLocalOptimizers.size() );
+}
+
 //-------------------------------------------------------------------
 template<typename TInternalComputationValueType>
 const typename MultiStartOptimizerv4Template<TInternalComputationValueType>::StopConditionReturnStringType
@@ -177,28 +217,66 @@ MultiStartOptimizerv4Template<TInternalComputationValueType>
   this->m_StopConditionDescription << this->GetNameOfClass() << ": ";
   this->InvokeEvent( StartEvent() );
 
+  /* Each concurrent start needs its own local optimizer. */
+  ThreadIdType numberOfConcurrentStarts = this->GetNumberOfConcurrentEvaluations(
+    this->m_NumberOfIterations - this->m_CurrentIteration );
+  if ( this->m_LocalOptimizer )
+    {
+    numberOfConcurrentStarts = std::min( numberOfConcurrentStarts,
+      static_cast<ThreadIdType>( this->m_ConcurrentLocalOptimizers.size() + 1 ) );
+    }
+  this->m_ConcurrentStartsBegin = this->m_CurrentIteration;
+  this->m_ConcurrentStartsEnd = this->m_CurrentIteration;
+
   this->m_Stop = false;
   while( ! this->m_Stop )
     {
-    /* Compute metric value */
-    try
+    if ( numberOfConcurrentStarts > 1 )
       {
-      this->m_Metric->SetParameters( this->m_ParametersList[ this->m_CurrentIteration ] );
-      if (  this->m_LocalOptimizer )
+      /* Run the next batch of starts concurrently, then report them in order. */
+      if ( this->m_CurrentIteration >= this->m_ConcurrentStartsEnd )
         {
-        this->m_LocalOptimizer->SetMetric( this->m_Metric );
-        this->m_LocalOptimizer->StartOptimization();
-        this->m_ParametersList[this->m_CurrentIteration] = this->m_Metric->GetParameters();
+        this->m_ConcurrentStartsBegin = this->m_CurrentIteration;
+        this->m_ConcurrentStartsEnd = std::min( this->m_CurrentIteration + numberOfConcurrentStarts,
+                                                static_cast<ParameterListSizeType>( this->m_NumberOfIterations ) );
+        this->m_ConcurrentStartValues.assign( numberOfConcurrentStarts, this->m_CurrentMetricValue );
+        this->m_ConcurrentStartSucceeded.assign( numberOfConcurrentStarts, false );
+        this->ExecuteConcurrentEvaluations( static_cast<ThreadIdType>( this->m_ConcurrentStartsEnd -
+                                                                       this->m_ConcurrentStartsBegin ) );
+        }
+      const ParameterListSizeType start = this->m_CurrentIteration - this->m_ConcurrentStartsBegin;
+      if ( this->m_ConcurrentStartSucceeded[start] )
+        {
+        this->m_CurrentMetricValue = this->m_ConcurrentStartValues[start];
+        this->m_MetricValuesList.push_back(this->m_CurrentMetricValue);
+        }
+      else
+        {
+        itkWarningMacro("An exception occurred in sub-optimization number " << this->m_CurrentIteration << ".  If too many of these occur, you may need to set a different set of initial parameters.");
         }
-      this->m_CurrentMetricValue = this->m_Metric->GetValue();
-      this->m_MetricValuesList.push_back(this->m_CurrentMetricValue);
       }
-    catch ( ExceptionObject & )
+    else
       {
-      /** We simply ignore this exception because it may just be a bad starting point.
-       *  We hope that other start points are better.
-       */
-      itkWarningMacro("An exception occurred in sub-optimization number " << this->m_CurrentIteration << ".  If too many of these occur, you may need to set a different set of initial parameters.");
+      /* Compute metric value */
+      try
+        {
+        this->m_Metric->SetParameters( this->m_ParametersList[ this->m_CurrentIteration ] );
+        if (  this->m_LocalOptimizer )
+          {
+          this->m_LocalOptimizer->SetMetric( this->m_Metric );
+          this->m_LocalOptimizer->StartOptimization();
+          this->m_ParametersList[this->m_CurrentIteration] = this->m_Metric->GetParameters();
+          }
+        this->m_CurrentMetricValue = this->m_Metric->GetValue();
+        this->m_MetricValuesList.push_back(this->m_CurrentMetricValue);
+        }
+      catch ( ExceptionObject & )
+        {
+        /** We simply ignore this exception because it may just be a bad starting point.
+         *  We hope that other start points are better.
+         */
+        itkWarningMacro("An exception occurred in sub-optimization number " << this->m_CurrentIteration << ".  If too many of these occur, you may need to set a different set of initial parameters.");
+        }
       }
 
     if ( this->m_CurrentMetricValue <  this->m_MinimumMetricValue )
@@ -230,6 +308,45 @@ MultiStartOptimizerv4Template<TInternalComputationValueType>
     } //while (!m_Stop)
 }
 
+/**
+* Run the starts of the current batch assigned to a concurrent metric.
+*/
+template<typename TInternalComputationValueType>
+void
+MultiStartOptimizerv4Template<TInternalComputationValueType>
+::ConcurrentEvaluation( ThreadIdType evaluationId, ThreadIdType numberOfConcurrentEvaluations )
+{
+  MetricType * metric = this->GetConcurrentEvaluationMetric( evaluationId );
+  OptimizerType * localOptimizer = this->m_LocalOptimizer.GetPointer();
+  if ( localOptimizer && evaluationId > 0 )
+    {
+    localOptimizer = this->m_ConcurrentLocalOptimizers[evaluationId - 1].GetPointer();
+    }
+
+  for ( ParameterListSizeType start = this->m_ConcurrentStartsBegin + evaluationId;
+        start < this->m_ConcurrentStartsEnd; start += numberOfConcurrentEvaluations )
+    {
+    const ParameterListSizeType i = start - this->m_ConcurrentStartsBegin;
+    try
+      {
+      metric->SetParameters( this->m_ParametersList[ start ] );
+      if ( localOptimizer )
+        {
+        localOptimizer->SetMetric( metric );
+        localOptimizer->StartOptimization();
+        this->m_ParametersList[start] = metric->GetParameters();
+        }
+      this->m_ConcurrentStartValues[i] = metric->GetValue();
+      this->m_ConcurrentStartSucceeded[i] = true;
+      }
+    catch ( ExceptionObject & )
+      {
+      /** A bad starting point, reported when the start is processed. */
+      this->m_ConcurrentStartSucceeded[i] = false;
+      }
+    }
+}
+
 } //namespace itk
 
 #endif
@@ -86,6 +86,24 @@ public:
   itkSetConstObjectMacro( MovingObject, ObjectType );
   itkGetConstObjectMacro( MovingObject, ObjectType );
 
+  /** Get/Set an object caching data computed from the moving object, e.g.
+   * the interleaved values and gradients of a moving image. Sharing it
+   * between metrics avoids computing the same data for each of them.
+   * Metrics which don't use any ignore it. */
+  virtual void SetMovingObjectCache( ObjectType * ) {}
+  virtual ObjectType * GetMovingObjectCache() const
+  {
+    return ITK_NULLPTR;
+  }
+
+  /** Set/Get the maximum number of threads used to evaluate the metric.
+   * Metrics which aren't multithreaded use a single thread and ignore it. */
+  virtual void SetMaximumNumberOfThreads( const ThreadIdType ) {}
+  virtual ThreadIdType GetMaximumNumberOfThreads() const
+  {
+    return 1;
+  }
+
   /** Source of the gradient(s) used by the metric
    * (e.g. image gradients, in the case of
    * image to image metrics). Defaults to Moving. */
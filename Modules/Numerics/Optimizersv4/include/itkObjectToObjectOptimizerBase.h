@@ -22,6 +22,8 @@
 #include "itkOptimizerParameterScalesEstimator.h"
 #include "itkObjectToObjectMetricBase.h"
 #include "itkIntTypes.h"
+#include "itkMultiThreader.h"
+#include <vector>
 
 namespace itk
 {
@@ -71,6 +73,17 @@ namespace itk
  * Threading of some optimizer operations may be handled within
  * derived classes, for example in GradientDescentOptimizer.
  *
+ * AddConcurrentMetric() allows derived classes to evaluate the metric at
+ * several positions at the same time, e.g. the starts of
+ * MultiStartOptimizerv4 or the line search points of
+ * GradientDescentLineSearchOptimizerv4. A concurrent metric must be set up
+ * like the metric being optimized, with its own moving transform, since
+ * its parameters are changed independently. The number of threads of the
+ * optimizer is then the budget shared by the concurrent evaluations: each
+ * of the \c n metrics evaluated together uses at most
+ * <tt>NumberOfThreads / n</tt> threads, so that the optimizer and the
+ * threading of the metrics don't oversubscribe the processors.
+ *
  * \note Derived classes must override StartOptimization, and then call
  * this base class version to perform common initializations.
  *
@@ -186,6 +199,21 @@ public:
   /** Get the number of threads set to be used. */
   itkGetConstReferenceMacro( NumberOfThreads, ThreadIdType );
 
+  /** Add a metric, set up like the metric being optimized but with its own
+   * moving transform, which derived classes may evaluate concurrently with
+   * it. Optimizers which don't evaluate concurrently ignore them.
+   * \sa ClearConcurrentMetrics() */
+  void AddConcurrentMetric( MetricType * metric );
+
+  /** Remove all the concurrent metrics. */
+  void ClearConcurrentMetrics();
+
+  /** Get the number of concurrent metrics. */
+  SizeValueType GetNumberOfConcurrentMetrics() const;
+
+  /** Get a concurrent metric. */
+  MetricType * GetConcurrentMetric( SizeValueType i ) const;
+
   /** Return current number of iterations. */
   itkGetConstMacro(CurrentIteration, SizeValueType);
 
@@ -218,6 +246,28 @@ protected:
   ObjectToObjectOptimizerBaseTemplate();
   virtual ~ObjectToObjectOptimizerBaseTemplate();
 
+  /** Return the number of the \c numberOfEvaluations independent metric
+   * evaluations which can run concurrently, given the concurrent metrics and
+   * the number of threads. */
+  ThreadIdType GetNumberOfConcurrentEvaluations( SizeValueType numberOfEvaluations ) const;
+
+  /** Return the metric used by the concurrent evaluation \c evaluationId:
+   * the metric being optimized for the first one, and the concurrent
+   * metrics for the others. */
+  MetricType * GetConcurrentEvaluationMetric( ThreadIdType evaluationId ) const;
+
+  /** Call ConcurrentEvaluation() in \c numberOfConcurrentEvaluations
+   * threads, after sharing the number of threads of the optimizer between
+   * their metrics. The number of threads of the metrics is restored
+   * afterwards. An exception thrown by an evaluation is thrown again once
+   * all the evaluations are done. */
+  void ExecuteConcurrentEvaluations( ThreadIdType numberOfConcurrentEvaluations );
+
+  /** Evaluation run by ExecuteConcurrentEvaluations() in each thread, with
+   * the metric returned by GetConcurrentEvaluationMetric( evaluationId ).
+   * Derived classes evaluating concurrently must override it. */
+  virtual void ConcurrentEvaluation( ThreadIdType evaluationId, ThreadIdType numberOfConcurrentEvaluations );
+
   MetricTypePointer             m_Metric;
   ThreadIdType                  m_NumberOfThreads;
   SizeValueType                 m_CurrentIteration;
@@ -254,6 +304,11 @@ protected:
 
 private:
 
+  static ITK_THREAD_RETURN_TYPE ConcurrentEvaluationThreaderCallback( void * arg );
+
+  std::vector< MetricTypePointer > m_ConcurrentMetrics;
+  MultiThreader::Pointer           m_ConcurrentEvaluationThreader;
+
   //purposely not implemented
   ObjectToObjectOptimizerBaseTemplate( const Self & );
   //purposely not implemented
@@ -19,7 +19,7 @@
 #define itkObjectToObjectOptimizerBase_hxx
 
 #include "itkObjectToObjectOptimizerBase.h"
-#include "itkMultiThreader.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -39,6 +39,7 @@ ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
   this->m_ScalesAreIdentity = false;
   this->m_WeightsAreIdentity = true;
   this->m_DoEstimateScales = true;
+  this->m_ConcurrentEvaluationThreader = MultiThreader::New();
 }
 
 //-------------------------------------------------------------------
@@ -56,6 +57,7 @@ ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Number of threads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "Number of concurrent metrics: " << this->m_ConcurrentMetrics.size() << std::endl;
   os << indent << "Number of scales:  " << this->m_Scales.Size() << std::endl;
   if( this->GetScalesInitialized() )
     {
@@ -102,6 +104,147 @@ ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
     }
 }
 
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::AddConcurrentMetric( MetricType * metric )
+{
+  if( metric == ITK_NULLPTR )
+    {
+    itkExceptionMacro("The concurrent metric must not be null.");
+    }
+  this->m_ConcurrentMetrics.push_back( metric );
+  this->Modified();
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::ClearConcurrentMetrics()
+{
+  if( !this->m_ConcurrentMetrics.empty() )
+    {
+    this->m_ConcurrentMetrics.clear();
+    this->Modified();
+    }
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+SizeValueType
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::GetNumberOfConcurrentMetrics() const
+{
+  return static_cast<SizeValueType>( this->m_ConcurrentMetrics.size() );
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+typename ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>::MetricType *
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::GetConcurrentMetric( SizeValueType i ) const
+{
+  if( i >= this->m_ConcurrentMetrics.size() )
+    {
+    itkExceptionMacro("Concurrent metric " << i << " doesn't exist, there are only "
+                      << this->m_ConcurrentMetrics.size() << " concurrent metrics.");
+    }
+  return this->m_ConcurrentMetrics[i].GetPointer();
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+ThreadIdType
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::GetNumberOfConcurrentEvaluations( SizeValueType numberOfEvaluations ) const
+{
+  SizeValueType numberOfConcurrentEvaluations = this->m_ConcurrentMetrics.size() + 1;
+  numberOfConcurrentEvaluations = std::min( numberOfConcurrentEvaluations,
+                                            static_cast<SizeValueType>( this->m_NumberOfThreads ) );
+  numberOfConcurrentEvaluations = std::min( numberOfConcurrentEvaluations, numberOfEvaluations );
+  return static_cast<ThreadIdType>( std::max( numberOfConcurrentEvaluations, static_cast<SizeValueType>( 1 ) ) );
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+typename ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>::MetricType *
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::GetConcurrentEvaluationMetric( ThreadIdType evaluationId ) const
+{
+  if( evaluationId == 0 )
+    {
+    return this->m_Metric.GetPointer();
+    }
+  return this->m_ConcurrentMetrics[evaluationId - 1].GetPointer();
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::ExecuteConcurrentEvaluations( ThreadIdType numberOfConcurrentEvaluations )
+{
+  if( numberOfConcurrentEvaluations <= 1 )
+    {
+    this->ConcurrentEvaluation( 0, 1 );
+    return;
+    }
+
+  /* Share the threads between the metrics evaluated together. */
+  const ThreadIdType numberOfThreadsPerEvaluation =
+    std::max( this->m_NumberOfThreads / numberOfConcurrentEvaluations, static_cast<ThreadIdType>( 1 ) );
+  std::vector< ThreadIdType > maximumNumberOfThreads( numberOfConcurrentEvaluations );
+  for( ThreadIdType i = 0; i < numberOfConcurrentEvaluations; ++i )
+    {
+    MetricType * metric = this->GetConcurrentEvaluationMetric( i );
+    maximumNumberOfThreads[i] = metric->GetMaximumNumberOfThreads();
+    metric->SetMaximumNumberOfThreads( std::min( maximumNumberOfThreads[i], numberOfThreadsPerEvaluation ) );
+    }
+
+  this->m_ConcurrentEvaluationThreader->SetNumberOfThreads( numberOfConcurrentEvaluations );
+  this->m_ConcurrentEvaluationThreader->SetSingleMethod( Self::ConcurrentEvaluationThreaderCallback, this );
+  try
+    {
+    this->m_ConcurrentEvaluationThreader->SingleMethodExecute();
+    }
+  catch( ... )
+    {
+    for( ThreadIdType i = 0; i < numberOfConcurrentEvaluations; ++i )
+      {
+      this->GetConcurrentEvaluationMetric( i )->SetMaximumNumberOfThreads( maximumNumberOfThreads[i] );
+      }
+    throw;
+    }
+
+  for( ThreadIdType i = 0; i < numberOfConcurrentEvaluations; ++i )
+    {
+    this->GetConcurrentEvaluationMetric( i )->SetMaximumNumberOfThreads( maximumNumberOfThreads[i] );
+    }
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::ConcurrentEvaluation( ThreadIdType itkNotUsed(evaluationId), ThreadIdType itkNotUsed(numberOfConcurrentEvaluations) )
+{
+  itkExceptionMacro("ConcurrentEvaluation must be overridden by the optimizers evaluating concurrently.");
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+ITK_THREAD_RETURN_TYPE
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::ConcurrentEvaluationThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self * self = static_cast< Self * >( info->UserData );
+  self->ConcurrentEvaluation( info->ThreadID, info->NumberOfThreads );
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 //-------------------------------------------------------------------
 template<typename TInternalComputationValueType>
 void
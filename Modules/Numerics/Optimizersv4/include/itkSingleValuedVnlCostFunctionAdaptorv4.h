@@ -21,6 +21,7 @@
 #include "itkOptimizerParameters.h"
 #include "itkObjectToObjectMetricBase.h"
 #include "vnl/vnl_cost_function.h"
+#include <vector>
 
 namespace itk
 {
@@ -106,6 +107,19 @@ public:
   /** Return the parameters directly from the assigned metric. */
   const ParametersType & GetCachedCurrentParameters() const;
 
+  /** Convert internal parameters, scaled if scales are set, to the
+   * parameters of the cost function. */
+  void ConvertInternalToExternalParameters( const InternalParametersType & input, ParametersType & output ) const;
+
+  /** Add the value of the cost function at \c parameters, e.g. computed
+   * concurrently with the values at other parameters before the vnl
+   * optimizer needs them. f() returns it instead of evaluating the cost
+   * function at these parameters. */
+  void AddPrecomputedValue( const InternalParametersType & parameters, InternalMeasureType value );
+
+  /** Remove all the precomputed values. */
+  void ClearPrecomputedValues();
+
 protected:
 
   /** This method is intended to be called by the derived classes in order to
@@ -122,6 +136,9 @@ private:
   mutable MeasureType    m_CachedValue;
   mutable DerivativeType m_CachedDerivative;
 
+  std::vector< InternalParametersType > m_PrecomputedParameters;
+  std::vector< InternalMeasureType >    m_PrecomputedValues;
+
 };  // end of Class CostFunction
 
 } // end namespace itk
@@ -20,6 +20,8 @@
 
 #include "itkConvergenceMonitoringFunction.h"
 
+#include <vector>
+
 namespace itk
 {
 namespace Function
@@ -28,6 +30,11 @@ namespace Function
  * \class WindowConvergenceMonitoringFunction
  * \brief Class which monitors convergence during the course of optimization.
  *
+ * The convergence value is the negative slope, at the end of the window, of
+ * the linear B-spline fitted to the last WindowSize energy values normalized
+ * by the total energy. As the fit is linear in the energy values, it reduces
+ * to a weighted sum of the window, whose weights only depend on the window
+ * size and are computed once when it is set.
  *
  * \author Nick Tustison
  * \author Brian Avants
@@ -68,7 +75,7 @@ public:
   virtual void ClearEnergyValues() ITK_OVERRIDE;
 
   /** Set/Get window size over which the convergence value is calculated */
-  itkSetMacro( WindowSize, EnergyValueContainerSizeType );
+  virtual void SetWindowSize( const EnergyValueContainerSizeType );
   itkGetConstMacro( WindowSize, EnergyValueContainerSizeType );
 
   /** Calculate convergence value by fitting to a window of the enrgy profile */
@@ -85,8 +92,13 @@ private:
   WindowConvergenceMonitoringFunction( const Self & ); //purposely not implemented
   void operator=( const Self & );  //purposely not implemented
 
+  /** Compute the weights of the energy values in the convergence value. */
+  void ComputeWindowWeights();
+
   EnergyValueContainerSizeType                   m_WindowSize;
 
+  std::vector<RealType>                          m_WindowWeights;
+
   RealType                                       m_TotalEnergy;
 
 };
@@ -20,11 +20,7 @@
 
 #include "itkWindowConvergenceMonitoringFunction.h"
 
-#include "itkBSplineControlPointImageFunction.h"
-#include "itkBSplineScatteredDataPointSetToImageFilter.h"
-#include "itkImage.h"
-#include "itkPointSet.h"
-#include "itkVector.h"
+#include "vnl/vnl_math.h"
 
 namespace itk
 {
@@ -36,7 +32,9 @@ WindowConvergenceMonitoringFunction<TScalar>
 ::WindowConvergenceMonitoringFunction() :
   m_WindowSize( 10 ),
   m_TotalEnergy( 0 )
-{}
+{
+  this->ComputeWindowWeights();
+}
 
 template<typename TScalar>
 WindowConvergenceMonitoringFunction<TScalar>
@@ -70,70 +68,81 @@ WindowConvergenceMonitoringFunction<TScalar>
 }
 
 template<typename TScalar>
-typename WindowConvergenceMonitoringFunction<TScalar>::RealType
+void
 WindowConvergenceMonitoringFunction<TScalar>
-::GetConvergenceValue() const
+::SetWindowSize( const EnergyValueContainerSizeType windowSize )
 {
-  if( this->GetNumberOfEnergyValues() < this->m_WindowSize )
+  itkDebugMacro( "setting WindowSize to " << windowSize );
+  if( this->m_WindowSize != windowSize )
     {
-    return NumericTraits<RealType>::max();
+    this->m_WindowSize = windowSize;
+    this->ComputeWindowWeights();
+    this->Modified();
     }
+}
 
-  typedef Vector<RealType, 1>                     ProfilePointDataType;
-  typedef Image<ProfilePointDataType, 1>          CurveType;
-  typedef PointSet<ProfilePointDataType, 1>       EnergyProfileType;
-  typedef typename EnergyProfileType::PointType   ProfilePointType;
-
-  typename CurveType::PointType    origin;
-  typename CurveType::SizeType     size;
-  typename CurveType::SpacingType  spacing;
-
-  origin[0] = 0.0;
-  size[0] = 11;
-  spacing[0] = 0.1;
-
-  typedef BSplineScatteredDataPointSetToImageFilter<EnergyProfileType, CurveType> BSplinerType;
-  typename BSplinerType::Pointer bspliner = BSplinerType::New();
-  bspliner->SetOrigin( origin );
-  bspliner->SetSpacing( spacing );
-  bspliner->SetSize( size );
-  bspliner->SetNumberOfLevels( 1 );
-  bspliner->SetSplineOrder( 1 );
-  typename BSplinerType::ArrayType ncps;
-  ncps.Fill( bspliner->GetSplineOrder()[0] + 1 );
-  bspliner->SetNumberOfControlPoints( ncps );
-
-  typename EnergyProfileType::Pointer energyProfileWindow = EnergyProfileType::New();
-  energyProfileWindow->Initialize();
-
-  for( unsigned int n = 0; n < this->m_WindowSize; n++ )
+template<typename TScalar>
+void
+WindowConvergenceMonitoringFunction<TScalar>
+::ComputeWindowWeights()
+{
+  // The energy profile was fitted with a BSplineScatteredDataPointSetToImageFilter
+  // of order 1 with 2 control points over [0, 1], the window values being at
+  // n / ( WindowSize - 1 ). The control point values are then
+  //
+  //   phi_j = sum_n B_j(t_n)^3 / ( B_0(t_n)^2 + B_1(t_n)^2 ) * E_n / sum_n B_j(t_n)^2
+  //
+  // with B_0(t) = 1 - t and B_1(t) = t, and the convergence value, the opposite
+  // of the derivative of the spline, is phi_0 - phi_1. The last point is moved
+  // into the domain as in the filter.
+  this->m_WindowWeights.assign( this->m_WindowSize, NumericTraits<RealType>::ZeroValue() );
+  if( this->m_WindowSize < 2 )
     {
-    ProfilePointType windowPoint;
-    windowPoint[0] = static_cast<typename ProfilePointType::CoordRepType>( n ) /
-      static_cast<typename ProfilePointType::CoordRepType>( this->m_WindowSize - 1 );
-    energyProfileWindow->SetPoint( n, windowPoint );
-    energyProfileWindow->SetPointData( n, ProfilePointDataType( this->m_EnergyValues[n] / this->m_TotalEnergy ) );
+    return;
     }
 
-  bspliner->SetInput( energyProfileWindow );
-  bspliner->Update();
+  const RealType epsilon = 0.1 * 1e-3;
 
-  typedef BSplineControlPointImageFunction<CurveType> BSplinerFunctionType;
-  typename BSplinerFunctionType::Pointer bsplinerFunction = BSplinerFunctionType::New();
-  bsplinerFunction->SetOrigin( origin );
-  bsplinerFunction->SetSpacing( spacing );
-  bsplinerFunction->SetSize( size );
-  bsplinerFunction->SetSplineOrder( bspliner->GetSplineOrder() );
-  bsplinerFunction->SetInputImage( bspliner->GetPhiLattice() );
+  std::vector<RealType> parameters( this->m_WindowSize );
+  RealType omega[2] = { 0.0, 0.0 };
+  for( EnergyValueContainerSizeType n = 0; n < this->m_WindowSize; n++ )
+    {
+    RealType t = static_cast<float>( n ) / static_cast<float>( this->m_WindowSize - 1 );
+    if( std::abs( t - 1.0 ) <= epsilon )
+      {
+      t = 1.0 - epsilon;
+      }
+    parameters[n] = t;
+    omega[0] += ( 1.0 - t ) * ( 1.0 - t );
+    omega[1] += t * t;
+    }
+  for( EnergyValueContainerSizeType n = 0; n < this->m_WindowSize; n++ )
+    {
+    const RealType B0 = 1.0 - parameters[n];
+    const RealType B1 = parameters[n];
+    const RealType w2Sum = B0 * B0 + B1 * B1;
+    this->m_WindowWeights[n] = ( B0 * B0 * B0 / omega[0] - B1 * B1 * B1 / omega[1] ) / w2Sum;
+    }
+}
 
-  ProfilePointType endPoint;
-  endPoint[0] = NumericTraits<RealType>::OneValue();
-  typename BSplinerFunctionType::GradientType gradient =
-    bsplinerFunction->EvaluateGradientAtParametricPoint( endPoint );
+template<typename TScalar>
+typename WindowConvergenceMonitoringFunction<TScalar>::RealType
+WindowConvergenceMonitoringFunction<TScalar>
+::GetConvergenceValue() const
+{
+  if( this->GetNumberOfEnergyValues() < this->m_WindowSize )
+    {
+    return NumericTraits<RealType>::max();
+    }
 
-  RealType convergenceValue = -gradient[0][0];
+  RealType convergenceValue = NumericTraits<RealType>::ZeroValue();
+  EnergyValueConstIterator it = this->m_EnergyValues.begin();
+  for( EnergyValueContainerSizeType n = 0; n < this->m_WindowSize; n++, ++it )
+    {
+    convergenceValue += this->m_WindowWeights[n] * static_cast<RealType>( *it );
+    }
 
-  return convergenceValue;
+  return convergenceValue / this->m_TotalEnergy;
 }
 
 /**
@@ -196,7 +196,9 @@ AmoebaOptimizerv4
     delta = automaticDelta;
     }
 
+  this->EvaluateInitialSimplex( parameters, delta );
   this->m_VnlOptimizer->minimize( parameters, delta );
+  adaptor->ClearPrecomputedValues();
   bestPosition = parameters;
   double bestValue = adaptor->f( bestPosition );
   //multiple restart heuristic
@@ -211,7 +213,9 @@ AmoebaOptimizerv4
       parameters = bestPosition;
       delta = delta*( 1.0/pow( 2.0, static_cast<double>(i) ) *
                      (rand() > RAND_MAX/2 ? 1 : -1) );
+      this->EvaluateInitialSimplex( parameters, delta );
       m_VnlOptimizer->minimize( parameters, delta );
+      adaptor->ClearPrecomputedValues();
       double currentValue = adaptor->f( parameters );
       // be consistent with the underlying vnl amoeba implementation
       double maxAbs = 0.0;
@@ -270,6 +274,51 @@ AmoebaOptimizerv4
 }
 
 
+void
+AmoebaOptimizerv4
+::EvaluateInitialSimplex( const InternalParametersType & parameters, const InternalParametersType & delta )
+{
+  const unsigned int n = parameters.size();
+  const ThreadIdType numberOfConcurrentEvaluations = this->GetNumberOfConcurrentEvaluations( n + 1 );
+  if ( numberOfConcurrentEvaluations <= 1 )
+    {
+    return;
+    }
+
+  // Same corners as vnl_amoebaFit::set_up_simplex_absolute()
+  this->m_InitialSimplex.assign( n + 1, parameters );
+  for ( unsigned int j = 0; j < n; ++j )
+    {
+    this->m_InitialSimplex[j + 1][j] = this->m_InitialSimplex[j + 1][j] + delta[j];
+    }
+  this->m_InitialSimplexValues.resize( n + 1 );
+
+  this->ExecuteConcurrentEvaluations( numberOfConcurrentEvaluations );
+
+  CostFunctionAdaptorType *adaptor = this->GetNonConstCostFunctionAdaptor();
+  for ( unsigned int j = 0; j <= n; ++j )
+    {
+    adaptor->AddPrecomputedValue( this->m_InitialSimplex[j], this->m_InitialSimplexValues[j] );
+    }
+}
+
+
+void
+AmoebaOptimizerv4
+::ConcurrentEvaluation( ThreadIdType evaluationId, ThreadIdType numberOfConcurrentEvaluations )
+{
+  MetricType *                    metric = this->GetConcurrentEvaluationMetric( evaluationId );
+  const CostFunctionAdaptorType * adaptor = this->GetCostFunctionAdaptor();
+  ParametersType                  parameters;
+  for ( SizeValueType i = evaluationId; i < this->m_InitialSimplex.size(); i += numberOfConcurrentEvaluations )
+    {
+    adaptor->ConvertInternalToExternalParameters( this->m_InitialSimplex[i], parameters );
+    metric->SetParameters( parameters );
+    this->m_InitialSimplexValues[i] = metric->GetValue();
+    }
+}
+
+
 void
 AmoebaOptimizerv4
 ::ValidateSettings()
@@ -62,7 +62,20 @@ SingleValuedVnlCostFunctionAdaptorv4
     }
 
   this->m_ObjectMetric->SetParameters( parameters );
-  InternalMeasureType value = static_cast< InternalMeasureType >( m_ObjectMetric->GetValue() );
+  InternalMeasureType value;
+  SizeValueType       precomputed = 0;
+  while ( precomputed < m_PrecomputedParameters.size() && m_PrecomputedParameters[precomputed] != inparameters )
+    {
+    ++precomputed;
+    }
+  if ( precomputed < m_PrecomputedParameters.size() )
+    {
+    value = m_PrecomputedValues[precomputed];
+    }
+  else
+    {
+    value = static_cast< InternalMeasureType >( m_ObjectMetric->GetValue() );
+    }
 
   // Notify observers. This is used for overcoming the limitaion of VNL
   // optimizers of not providing callbacks per iteration.
@@ -72,6 +85,40 @@ SingleValuedVnlCostFunctionAdaptorv4
   return value;
 }
 
+void
+SingleValuedVnlCostFunctionAdaptorv4
+::ConvertInternalToExternalParameters(const InternalParametersType & input, ParametersType & output) const
+{
+  output.SetSize( input.size() );
+  for ( SizeValueType i = 0; i < output.GetSize(); ++i )
+    {
+    if ( m_ScalesInitialized )
+      {
+      output[i] = input[i] / m_Scales[i];
+      }
+    else
+      {
+      output[i] = input[i];
+      }
+    }
+}
+
+void
+SingleValuedVnlCostFunctionAdaptorv4
+::AddPrecomputedValue(const InternalParametersType & parameters, InternalMeasureType value)
+{
+  m_PrecomputedParameters.push_back( parameters );
+  m_PrecomputedValues.push_back( value );
+}
+
+void
+SingleValuedVnlCostFunctionAdaptorv4
+::ClearPrecomputedValues()
+{
+  m_PrecomputedParameters.clear();
+  m_PrecomputedValues.clear();
+}
+
 void
 SingleValuedVnlCostFunctionAdaptorv4
 ::gradf(const InternalParametersType & inparameters, InternalDerivativeType & gradient)
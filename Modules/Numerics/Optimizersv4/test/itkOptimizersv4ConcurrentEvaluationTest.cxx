@@ -0,0 +1,497 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkGradientDescentLineSearchOptimizerv4.h"
+#include "itkConjugateGradientLineSearchOptimizerv4.h"
+#include "itkMultiStartOptimizerv4.h"
+#include "itkExhaustiveOptimizerv4.h"
+#include "itkAmoebaOptimizerv4.h"
+
+/**
+ * Check that the optimizers evaluating concurrent metrics find the same
+ * solutions as without them, and share their number of threads with the
+ * metrics. Also check that the coarse-to-fine exhaustive search finds the
+ * minimum of the full grid search.
+ */
+
+namespace
+{
+/** \class Optimizersv4ConcurrentEvaluationTestMetric
+ *
+ * The quadratic form 1/2 x^T A x - b^T x, minimal at ( 2, -2 ), with
+ *
+ *     | 3  2 |        |  2 |
+ * A = | 2  6 |,   b = | -8 |
+ *
+ * It counts the evaluations of its value alone, as done by the line
+ * searches, and records the number of threads it was allowed to use for
+ * them.
+ */
+class Optimizersv4ConcurrentEvaluationTestMetric
+  : public itk::ObjectToObjectMetricBase
+{
+public:
+
+  typedef Optimizersv4ConcurrentEvaluationTestMetric  Self;
+  typedef itk::ObjectToObjectMetricBase               Superclass;
+  typedef itk::SmartPointer<Self>                     Pointer;
+  typedef itk::SmartPointer<const Self>               ConstPointer;
+  itkNewMacro( Self );
+  itkTypeMacro( Optimizersv4ConcurrentEvaluationTestMetric, ObjectToObjectMetricBase );
+
+  enum { SpaceDimension=2 };
+
+  typedef Superclass::ParametersType        ParametersType;
+  typedef Superclass::ParametersValueType   ParametersValueType;
+  typedef Superclass::DerivativeType        DerivativeType;
+  typedef Superclass::MeasureType           MeasureType;
+
+  virtual void Initialize(void) throw ( itk::ExceptionObject ) ITK_OVERRIDE {}
+
+  virtual void GetDerivative( DerivativeType & derivative ) const ITK_OVERRIDE
+  {
+    MeasureType value;
+    GetValueAndDerivative( value, derivative );
+  }
+
+  void GetValueAndDerivative( MeasureType & value,
+                              DerivativeType & derivative ) const ITK_OVERRIDE
+  {
+    const double x = m_Parameters[0];
+    const double y = m_Parameters[1];
+
+    value = 0.5*(3*x*x+4*x*y+6*y*y) - 2*x + 8*y;
+    derivative.SetSize( SpaceDimension );
+    derivative[0] = -( 3 * x + 2 * y -2 );
+    derivative[1] = -( 2 * x + 6 * y +8 );
+  }
+
+  virtual MeasureType GetValue() const ITK_OVERRIDE
+  {
+    const double x = m_Parameters[0];
+    const double y = m_Parameters[1];
+
+    ++m_NumberOfEvaluations;
+    m_LargestNumberOfThreadsUsed = std::max( m_LargestNumberOfThreadsUsed, m_MaximumNumberOfThreads );
+    return 0.5*(3*x*x+4*x*y+6*y*y) - 2*x + 8*y;
+  }
+
+  virtual void UpdateTransformParameters( const DerivativeType & update, ParametersValueType ) ITK_OVERRIDE
+  {
+    m_Parameters += update;
+  }
+
+  virtual unsigned int GetNumberOfParameters(void) const ITK_OVERRIDE
+  {
+    return SpaceDimension;
+  }
+
+  virtual unsigned int GetNumberOfLocalParameters() const ITK_OVERRIDE
+  {
+    return SpaceDimension;
+  }
+
+  virtual bool HasLocalSupport() const ITK_OVERRIDE
+  {
+    return false;
+  }
+
+  virtual void SetParameters( ParametersType & parameters ) ITK_OVERRIDE
+  {
+    m_Parameters = parameters;
+  }
+
+  virtual const ParametersType & GetParameters() const ITK_OVERRIDE
+  {
+    return m_Parameters;
+  }
+
+  virtual void SetMaximumNumberOfThreads( const itk::ThreadIdType threads ) ITK_OVERRIDE
+  {
+    m_MaximumNumberOfThreads = threads;
+  }
+
+  virtual itk::ThreadIdType GetMaximumNumberOfThreads() const ITK_OVERRIDE
+  {
+    return m_MaximumNumberOfThreads;
+  }
+
+  unsigned int GetNumberOfEvaluations() const
+  {
+    return m_NumberOfEvaluations;
+  }
+
+  itk::ThreadIdType GetLargestNumberOfThreadsUsed() const
+  {
+    return m_LargestNumberOfThreadsUsed;
+  }
+
+protected:
+  Optimizersv4ConcurrentEvaluationTestMetric() :
+    m_MaximumNumberOfThreads( 8 ),
+    m_NumberOfEvaluations( 0 ),
+    m_LargestNumberOfThreadsUsed( 0 )
+  {
+    m_Parameters.SetSize( SpaceDimension );
+    m_Parameters.Fill( 0 );
+  }
+
+private:
+  ParametersType            m_Parameters;
+  itk::ThreadIdType         m_MaximumNumberOfThreads;
+  mutable unsigned int      m_NumberOfEvaluations;
+  mutable itk::ThreadIdType m_LargestNumberOfThreadsUsed;
+};
+
+typedef Optimizersv4ConcurrentEvaluationTestMetric MetricType;
+
+/** Run the line search optimizer from ( 100, -100 ), with the given number
+ * of concurrent metrics, and return the final position and the number of
+ * evaluations of the metric being optimized. */
+template< typename TOptimizer >
+int Optimizersv4ConcurrentLineSearch( unsigned int numberOfConcurrentMetrics,
+                                      MetricType::ParametersType & finalPosition,
+                                      unsigned int & numberOfEvaluations )
+{
+  typename TOptimizer::Pointer optimizer = TOptimizer::New();
+  MetricType::Pointer metric = MetricType::New();
+  MetricType::ParametersType initialPosition( 2 );
+  initialPosition[0] = 100;
+  initialPosition[1] = -100;
+  metric->SetParameters( initialPosition );
+
+  optimizer->SetMetric( metric );
+  optimizer->SetLearningRate( 0.1 );
+  optimizer->SetNumberOfIterations( 20 );
+  optimizer->SetLowerLimit( 0 );
+  optimizer->SetUpperLimit( 3 );
+  optimizer->SetEpsilon( 0.2 );
+  optimizer->SetNumberOfThreads( 8 );
+
+  std::vector< MetricType::Pointer > concurrentMetrics;
+  for( unsigned int i = 0; i < numberOfConcurrentMetrics; ++i )
+    {
+    concurrentMetrics.push_back( MetricType::New() );
+    optimizer->AddConcurrentMetric( concurrentMetrics.back() );
+    }
+  if( optimizer->GetNumberOfConcurrentMetrics() != numberOfConcurrentMetrics )
+    {
+    std::cerr << "Wrong number of concurrent metrics: " << optimizer->GetNumberOfConcurrentMetrics() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  optimizer->StartOptimization();
+
+  finalPosition = metric->GetParameters();
+  numberOfEvaluations = metric->GetNumberOfEvaluations();
+
+  if( metric->GetMaximumNumberOfThreads() != 8 )
+    {
+    std::cerr << optimizer->GetNameOfClass() << ": the number of threads of the metric was not restored" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int i = 0; i < numberOfConcurrentMetrics; ++i )
+    {
+    if( concurrentMetrics[i]->GetNumberOfEvaluations() == 0 )
+      {
+      std::cerr << optimizer->GetNameOfClass() << ": concurrent metric " << i << " was not used" << std::endl;
+      return EXIT_FAILURE;
+      }
+    // a concurrent metric is evaluated together with at least the optimized
+    // one, and shares the 8 threads with it
+    if( concurrentMetrics[i]->GetLargestNumberOfThreadsUsed() > 4 )
+      {
+      std::cerr << optimizer->GetNameOfClass() << ": concurrent metric " << i << " used "
+                << concurrentMetrics[i]->GetLargestNumberOfThreadsUsed() << " threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+template< typename TOptimizer >
+int Optimizersv4ConcurrentLineSearchTest()
+{
+  MetricType::ParametersType positions[3];
+  unsigned int               numberOfEvaluations[3];
+  const unsigned int         numberOfConcurrentMetrics[3] = { 0, 1, 6 };
+  for( unsigned int i = 0; i < 3; ++i )
+    {
+    if( Optimizersv4ConcurrentLineSearch< TOptimizer >( numberOfConcurrentMetrics[i], positions[i],
+                                                        numberOfEvaluations[i] ) == EXIT_FAILURE )
+      {
+      return EXIT_FAILURE;
+      }
+    std::cout << TOptimizer::New()->GetNameOfClass() << " with " << numberOfConcurrentMetrics[i]
+              << " concurrent metrics: " << positions[i] << ", " << numberOfEvaluations[i]
+              << " evaluations of the optimized metric" << std::endl;
+    }
+
+  if( std::abs( positions[0][0] - 2 ) > 0.01 || std::abs( positions[0][1] + 2 ) > 0.01 )
+    {
+    std::cerr << "Wrong solution " << positions[0] << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int i = 1; i < 3; ++i )
+    {
+    if( positions[i] != positions[0] )
+      {
+      std::cerr << "The solution " << positions[i] << " with " << numberOfConcurrentMetrics[i]
+                << " concurrent metrics differs from the solution " << positions[0] << " without." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if( !( numberOfEvaluations[2] < numberOfEvaluations[0] ) )
+    {
+    std::cerr << "The metric is not evaluated less often with concurrent metrics" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+/** Run the multi-start optimizer with a local optimizer and the given number
+ * of concurrent metrics, and return the metric values of the starts and the
+ * best parameters. */
+int Optimizersv4ConcurrentMultiStart( unsigned int numberOfConcurrentMetrics,
+                                      itk::MultiStartOptimizerv4::MetricValuesListType & values,
+                                      itk::MultiStartOptimizerv4::ParametersType & bestParameters )
+{
+  typedef itk::MultiStartOptimizerv4 OptimizerType;
+
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  MetricType::Pointer    metric = MetricType::New();
+  optimizer->SetMetric( metric );
+  optimizer->SetNumberOfThreads( 8 );
+
+  OptimizerType::ParametersListType parametersList;
+  for( int i = -3; i <= 3; ++i )
+    {
+    for( int j = -3; j <= 3; ++j )
+      {
+      OptimizerType::ParametersType parameters( 2 );
+      parameters[0] = 10 * i;
+      parameters[1] = 10 * j;
+      parametersList.push_back( parameters );
+      }
+    }
+  optimizer->SetParametersList( parametersList );
+
+  optimizer->InstantiateLocalOptimizer();
+  std::vector< MetricType::Pointer > concurrentMetrics;
+  for( unsigned int i = 0; i < numberOfConcurrentMetrics; ++i )
+    {
+    concurrentMetrics.push_back( MetricType::New() );
+    optimizer->AddConcurrentMetric( concurrentMetrics.back() );
+    OptimizerType::LocalOptimizerPointer localOptimizer = OptimizerType::LocalOptimizerType::New();
+    localOptimizer->SetLearningRate( 1.e-1 );
+    localOptimizer->SetNumberOfIterations( 25 );
+    optimizer->AddConcurrentLocalOptimizer( localOptimizer );
+    }
+
+  optimizer->StartOptimization();
+
+  values = optimizer->GetMetricValuesList();
+  bestParameters = optimizer->GetBestParameters();
+  if( metric->GetParameters() != bestParameters )
+    {
+    std::cerr << "The metric is not left at the best parameters" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int i = 0; i < numberOfConcurrentMetrics; ++i )
+    {
+    if( concurrentMetrics[i]->GetNumberOfEvaluations() == 0 )
+      {
+      std::cerr << "MultiStartOptimizerv4: concurrent metric " << i << " was not used" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+/** Run the exhaustive optimizer on the grid of [-5, 5]^2 with a step of
+ * 0.5, with the given number of concurrent metrics and coarse grid stride,
+ * and return the position of the minimum and the number of visited
+ * positions. */
+int Optimizersv4ConcurrentExhaustive( unsigned int numberOfConcurrentMetrics, itk::SizeValueType coarseGridStride,
+                                      itk::ExhaustiveOptimizerv4< double >::ParametersType & minimumPosition,
+                                      itk::SizeValueType & numberOfVisitedPositions )
+{
+  typedef itk::ExhaustiveOptimizerv4< double > OptimizerType;
+
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  MetricType::Pointer    metric = MetricType::New();
+  optimizer->SetMetric( metric );
+  optimizer->SetNumberOfThreads( 8 );
+  OptimizerType::StepsType steps( 2 );
+  steps.Fill( 10 );
+  optimizer->SetNumberOfSteps( steps );
+  optimizer->SetStepLength( 0.5 );
+  OptimizerType::ScalesType scales( 2 );
+  scales.Fill( 1.0 );
+  optimizer->SetScales( scales );
+  optimizer->SetCoarseGridStride( coarseGridStride );
+  optimizer->SetNumberOfCoarseGridCandidates( 2 );
+
+  std::vector< MetricType::Pointer > concurrentMetrics;
+  for( unsigned int i = 0; i < numberOfConcurrentMetrics; ++i )
+    {
+    concurrentMetrics.push_back( MetricType::New() );
+    optimizer->AddConcurrentMetric( concurrentMetrics.back() );
+    }
+
+  optimizer->StartOptimization();
+
+  minimumPosition = optimizer->GetMinimumMetricValuePosition();
+  numberOfVisitedPositions = optimizer->GetCurrentIteration();
+  for( unsigned int i = 0; i < numberOfConcurrentMetrics; ++i )
+    {
+    if( concurrentMetrics[i]->GetNumberOfEvaluations() == 0 )
+      {
+      std::cerr << "ExhaustiveOptimizerv4: concurrent metric " << i << " was not used" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+/** Run the amoeba optimizer from ( 10, 10 ) with the given number of
+ * concurrent metrics, and return the final position. */
+int Optimizersv4ConcurrentAmoeba( unsigned int numberOfConcurrentMetrics,
+                                  itk::AmoebaOptimizerv4::ParametersType & finalPosition )
+{
+  typedef itk::AmoebaOptimizerv4 OptimizerType;
+
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  MetricType::Pointer    metric = MetricType::New();
+  MetricType::ParametersType initialPosition( 2 );
+  initialPosition.Fill( 10 );
+  metric->SetParameters( initialPosition );
+  optimizer->SetMetric( metric );
+  optimizer->SetNumberOfThreads( 8 );
+  OptimizerType::ParametersType simplexDelta( 2 );
+  simplexDelta.Fill( 3 );
+  optimizer->SetInitialSimplexDelta( simplexDelta );
+  optimizer->OptimizeWithRestartsOn();
+  optimizer->SetNumberOfIterations( 300 );
+
+  std::vector< MetricType::Pointer > concurrentMetrics;
+  for( unsigned int i = 0; i < numberOfConcurrentMetrics; ++i )
+    {
+    concurrentMetrics.push_back( MetricType::New() );
+    optimizer->AddConcurrentMetric( concurrentMetrics.back() );
+    }
+
+  optimizer->StartOptimization();
+
+  finalPosition = metric->GetParameters();
+  for( unsigned int i = 0; i < numberOfConcurrentMetrics; ++i )
+    {
+    if( concurrentMetrics[i]->GetNumberOfEvaluations() == 0 )
+      {
+      std::cerr << "AmoebaOptimizerv4: concurrent metric " << i << " was not used" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int itkOptimizersv4ConcurrentEvaluationTest(int, char* [])
+{
+  if( Optimizersv4ConcurrentLineSearchTest< itk::GradientDescentLineSearchOptimizerv4 >() == EXIT_FAILURE ||
+      Optimizersv4ConcurrentLineSearchTest< itk::ConjugateGradientLineSearchOptimizerv4 >() == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  itk::MultiStartOptimizerv4::MetricValuesListType values[2];
+  itk::MultiStartOptimizerv4::ParametersType       bestParameters[2];
+  const unsigned int                               numberOfConcurrentMetrics[2] = { 0, 3 };
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    if( Optimizersv4ConcurrentMultiStart( numberOfConcurrentMetrics[i], values[i], bestParameters[i] ) == EXIT_FAILURE )
+      {
+      return EXIT_FAILURE;
+      }
+    std::cout << "MultiStartOptimizerv4 with " << numberOfConcurrentMetrics[i]
+              << " concurrent metrics: best parameters " << bestParameters[i] << std::endl;
+    }
+  if( values[1] != values[0] || bestParameters[1] != bestParameters[0] )
+    {
+    std::cerr << "The starts run concurrently give different results" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( std::abs( bestParameters[0][0] - 2 ) > 0.01 || std::abs( bestParameters[0][1] + 2 ) > 0.01 )
+    {
+    std::cerr << "Wrong solution " << bestParameters[0] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the exhaustive search visits the same positions in the same order with
+  // concurrent metrics, and the pruned search finds the minimum with fewer
+  // positions
+  itk::ExhaustiveOptimizerv4< double >::ParametersType minimumPositions[3];
+  itk::SizeValueType                                   numberOfVisitedPositions[3];
+  const unsigned int                                   exhaustiveConcurrentMetrics[3] = { 0, 3, 3 };
+  const itk::SizeValueType                             coarseGridStrides[3] = { 1, 1, 4 };
+  for( unsigned int i = 0; i < 3; ++i )
+    {
+    if( Optimizersv4ConcurrentExhaustive( exhaustiveConcurrentMetrics[i], coarseGridStrides[i],
+                                          minimumPositions[i], numberOfVisitedPositions[i] ) == EXIT_FAILURE )
+      {
+      return EXIT_FAILURE;
+      }
+    std::cout << "ExhaustiveOptimizerv4 with " << exhaustiveConcurrentMetrics[i] << " concurrent metrics and a coarse grid stride of "
+              << coarseGridStrides[i] << ": minimum at " << minimumPositions[i] << ", "
+              << numberOfVisitedPositions[i] << " positions visited" << std::endl;
+    if( std::abs( minimumPositions[i][0] - 2 ) > 1e-9 || std::abs( minimumPositions[i][1] + 2 ) > 1e-9 )
+      {
+      std::cerr << "Wrong minimum " << minimumPositions[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if( numberOfVisitedPositions[0] != 21 * 21 || numberOfVisitedPositions[1] != numberOfVisitedPositions[0] ||
+      minimumPositions[1] != minimumPositions[0] )
+    {
+    std::cerr << "The concurrent exhaustive search differs from the serial one" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( !( numberOfVisitedPositions[2] < numberOfVisitedPositions[0] / 2 ) )
+    {
+    std::cerr << "The pruned exhaustive search visited too many positions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::AmoebaOptimizerv4::ParametersType amoebaPositions[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    if( Optimizersv4ConcurrentAmoeba( 2 * i, amoebaPositions[i] ) == EXIT_FAILURE )
+      {
+      return EXIT_FAILURE;
+      }
+    std::cout << "AmoebaOptimizerv4 with " << 2 * i << " concurrent metrics: " << amoebaPositions[i] << std::endl;
+    }
+  if( amoebaPositions[1] != amoebaPositions[0] ||
+      std::abs( amoebaPositions[0][0] - 2 ) > 0.01 || std::abs( amoebaPositions[0][1] + 2 ) > 0.01 )
+    {
+    std::cerr << "Wrong amoeba solution" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
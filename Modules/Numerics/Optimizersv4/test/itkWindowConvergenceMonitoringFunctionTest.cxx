@@ -41,6 +41,29 @@ int itkWindowConvergenceMonitoringFunctionTest( int itkNotUsed( argc ), char * [
       }
     }
 
+  // a flat energy profile is converged, a decreasing one is not
+  convergenceMonitoring->ClearEnergyValues();
+  for( unsigned int n = 0; n < 10; n++ )
+    {
+    convergenceMonitoring->AddEnergyValue( 2.0 );
+    }
+  if( std::abs( convergenceMonitoring->GetConvergenceValue() ) > 1e-5 )
+    {
+    std::cerr << "Wrong convergence value of a flat profile: " << convergenceMonitoring->GetConvergenceValue() << std::endl;
+    return EXIT_FAILURE;
+    }
+  convergenceMonitoring->SetWindowSize( 5 );
+  convergenceMonitoring->ClearEnergyValues();
+  for( unsigned int n = 0; n < 5; n++ )
+    {
+    convergenceMonitoring->AddEnergyValue( 10.0 - n );
+    }
+  if( convergenceMonitoring->GetConvergenceValue() <= 0.0 )
+    {
+    std::cerr << "Wrong convergence value of a decreasing profile: " << convergenceMonitoring->GetConvergenceValue() << std::endl;
+    return EXIT_FAILURE;
+    }
+
   convergenceMonitoring->GetWindowSize();
   convergenceMonitoring->Print( std::cout, 3 );
 
@@ -0,0 +1,164 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkHistogramAccumulator_h
+#define itkHistogramAccumulator_h
+
+#include <map>
+#include <vector>
+
+#include "itkObject.h"
+#include "itkMultiThreader.h"
+
+namespace itk
+{
+namespace Statistics
+{
+/** \class HistogramAccumulator
+ *  \brief Accumulates the frequencies of the bins of a histogram with
+ *  several threads.
+ *
+ * After Initialize(), each thread increases the frequencies of the bins
+ * of the histogram in a storage of its own, without any lock: a dense
+ * array of all the bins when the histogram has at most
+ * MaximumNumberOfDenseBins bins, a map of the bins with a frequency
+ * otherwise. AddToHistogram() then sums the frequencies of the threads,
+ * the dense arrays being summed by several threads, each thread summing a
+ * range of the bins, and adds the sums to the histogram. With integer
+ * frequencies, the histogram is the same as if its frequencies were
+ * increased one after the other by one thread.
+ *
+ * The histogram may have any frequency container: it is only used to
+ * find the bins, and to add the sums of the frequencies of the bins.
+ *
+ * \sa Histogram, ScalarImageToCooccurrenceMatrixFilter,
+ * ScalarImageToRunLengthMatrixFilter
+ * \ingroup ITKStatistics
+ */
+
+template< typename THistogram >
+class HistogramAccumulator:public Object
+{
+public:
+  /** Standard class typedefs */
+  typedef HistogramAccumulator       Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Run-time type information (and related methods) */
+  itkTypeMacro(HistogramAccumulator, Object);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  typedef THistogram                                    HistogramType;
+  typedef typename HistogramType::IndexType             IndexType;
+  typedef typename HistogramType::InstanceIdentifier    InstanceIdentifier;
+  typedef typename HistogramType::AbsoluteFrequencyType AbsoluteFrequencyType;
+
+  /** Set/Get the largest number of bins of a histogram whose frequencies
+   * are accumulated in dense arrays. Default is 2^20. */
+  itkSetMacro(MaximumNumberOfDenseBins, SizeValueType);
+  itkGetConstMacro(MaximumNumberOfDenseBins, SizeValueType);
+
+  /** Set/Get the number of threads summing the dense arrays of the
+   * threads. Default is the global default number of threads of
+   * MultiThreader. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
+
+  /** Prepares the storages of the frequencies of the threads 0 to
+   * numberOfAccumulatingThreads - 1 for the bins of a histogram, which
+   * must be initialized and must not be modified until AddToHistogram(). */
+  void Initialize(const HistogramType *histogram, ThreadIdType numberOfAccumulatingThreads);
+
+  /** Returns true if the frequencies are accumulated in dense arrays. */
+  bool GetDense() const
+  {
+    return m_Dense;
+  }
+
+  /** Increases the frequency of a bin of the histogram for a thread.
+   * Nothing is done if the instance identifier is not one of a bin. */
+  void IncreaseFrequency(ThreadIdType threadId, InstanceIdentifier id, AbsoluteFrequencyType value)
+  {
+    if ( id >= m_NumberOfBins )
+      {
+      return;
+      }
+    if ( m_Dense )
+      {
+      m_DenseFrequencies[threadId][id] += value;
+      }
+    else
+      {
+      m_SparseFrequencies[threadId][id] += value;
+      }
+  }
+
+  /** Increases the frequency of the bin at an index of the histogram for
+   * a thread. Nothing is done if the index is not one of a bin. */
+  void IncreaseFrequencyOfIndex(ThreadIdType threadId, const IndexType & index, AbsoluteFrequencyType value)
+  {
+    this->IncreaseFrequency( threadId, m_Histogram->GetInstanceIdentifier(index), value );
+  }
+
+  /** Adds the frequencies accumulated by the threads to the histogram,
+   * and releases the storages of the threads. */
+  void AddToHistogram(HistogramType *histogram);
+
+protected:
+  HistogramAccumulator();
+  virtual ~HistogramAccumulator() {}
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** Sums a range of the bins of the dense arrays of the threads in the
+   * array of the first thread. */
+  void ThreadedSumDenseFrequencies(ThreadIdType threadId);
+
+private:
+  HistogramAccumulator(const Self &); //purposely not implemented
+  void operator=(const Self &);       //purposely not implemented
+
+  /** Static callback of the threads summing the dense arrays. */
+  static ITK_THREAD_RETURN_TYPE SumDenseFrequenciesThreaderCallback(void *arg);
+
+  typedef std::vector< AbsoluteFrequencyType >                 DenseFrequencyArrayType;
+  typedef std::map< InstanceIdentifier, AbsoluteFrequencyType > SparseFrequencyMapType;
+
+  SizeValueType m_MaximumNumberOfDenseBins;
+  ThreadIdType  m_NumberOfThreads;
+
+  MultiThreader::Pointer m_Threader;
+  ThreadIdType           m_NumberOfSummingThreads;
+
+  const HistogramType *m_Histogram;
+  InstanceIdentifier   m_NumberOfBins;
+  bool                 m_Dense;
+
+  std::vector< DenseFrequencyArrayType > m_DenseFrequencies;
+  std::vector< SparseFrequencyMapType >  m_SparseFrequencies;
+};
+} // end of namespace Statistics
+} // end of namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkHistogramAccumulator.hxx"
+#endif
+
+#endif
@@ -0,0 +1,197 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkHistogramAccumulator_hxx
+#define itkHistogramAccumulator_hxx
+
+#include "itkHistogramAccumulator.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+
+namespace itk
+{
+namespace Statistics
+{
+template< typename THistogram >
+HistogramAccumulator< THistogram >
+::HistogramAccumulator()
+{
+  m_MaximumNumberOfDenseBins = 1 << 20;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  m_Threader = MultiThreader::New();
+  m_NumberOfSummingThreads = 1;
+
+  m_Histogram = ITK_NULLPTR;
+  m_NumberOfBins = 0;
+  m_Dense = true;
+}
+
+template< typename THistogram >
+void
+HistogramAccumulator< THistogram >
+::Initialize(const HistogramType *histogram, ThreadIdType numberOfAccumulatingThreads)
+{
+  if ( histogram == ITK_NULLPTR )
+    {
+    itkExceptionMacro("The histogram is not set");
+    }
+  if ( numberOfAccumulatingThreads < 1 )
+    {
+    numberOfAccumulatingThreads = 1;
+    }
+
+  m_Histogram = histogram;
+  m_NumberOfBins = histogram->Size();
+  m_Dense = ( m_NumberOfBins <= m_MaximumNumberOfDenseBins );
+
+  m_DenseFrequencies.clear();
+  m_SparseFrequencies.clear();
+  if ( m_Dense )
+    {
+    m_DenseFrequencies.resize(numberOfAccumulatingThreads);
+    for ( ThreadIdType t = 0; t < numberOfAccumulatingThreads; ++t )
+      {
+      m_DenseFrequencies[t].assign( m_NumberOfBins, NumericTraits< AbsoluteFrequencyType >::ZeroValue() );
+      }
+    }
+  else
+    {
+    m_SparseFrequencies.resize(numberOfAccumulatingThreads);
+    }
+}
+
+template< typename THistogram >
+void
+HistogramAccumulator< THistogram >
+::AddToHistogram(HistogramType *histogram)
+{
+  if ( histogram == ITK_NULLPTR )
+    {
+    itkExceptionMacro("The histogram is not set");
+    }
+  if ( histogram->Size() != m_NumberOfBins )
+    {
+    itkExceptionMacro(<< "The histogram has " << histogram->Size()
+                      << " bins instead of " << m_NumberOfBins);
+    }
+
+  if ( m_Dense )
+    {
+    if ( m_DenseFrequencies.size() > 1 )
+      {
+      // Each thread sums the frequencies of a range of the bins
+      ThreadIdType numberOfThreads = m_NumberOfThreads;
+      if ( static_cast< InstanceIdentifier >( numberOfThreads ) > m_NumberOfBins )
+        {
+        numberOfThreads = static_cast< ThreadIdType >( m_NumberOfBins );
+        }
+      if ( numberOfThreads < 1 )
+        {
+        numberOfThreads = 1;
+        }
+      m_Threader->SetNumberOfThreads(numberOfThreads);
+      m_NumberOfSummingThreads = m_Threader->GetNumberOfThreads();
+      m_Threader->SetSingleMethod(Self::SumDenseFrequenciesThreaderCallback, this);
+      m_Threader->SingleMethodExecute();
+      }
+    if ( !m_DenseFrequencies.empty() )
+      {
+      const DenseFrequencyArrayType & frequencies = m_DenseFrequencies[0];
+      for ( InstanceIdentifier id = 0; id < m_NumberOfBins; ++id )
+        {
+        if ( frequencies[id] != NumericTraits< AbsoluteFrequencyType >::ZeroValue() )
+          {
+          histogram->IncreaseFrequency(id, frequencies[id]);
+          }
+        }
+      }
+    }
+  else
+    {
+    for ( size_t t = 0; t < m_SparseFrequencies.size(); ++t )
+      {
+      typename SparseFrequencyMapType::const_iterator it = m_SparseFrequencies[t].begin();
+      for (; it != m_SparseFrequencies[t].end(); ++it )
+        {
+        histogram->IncreaseFrequency(it->first, it->second);
+        }
+      }
+    }
+
+  // Release the storages of the threads
+  m_DenseFrequencies.clear();
+  m_SparseFrequencies.clear();
+  m_Histogram = ITK_NULLPTR;
+}
+
+template< typename THistogram >
+ITK_THREAD_RETURN_TYPE
+HistogramAccumulator< THistogram >
+::SumDenseFrequenciesThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self *accumulator = static_cast< Self * >( info->UserData );
+
+  if ( info->ThreadID < accumulator->m_NumberOfSummingThreads )
+    {
+    accumulator->ThreadedSumDenseFrequencies(info->ThreadID);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename THistogram >
+void
+HistogramAccumulator< THistogram >
+::ThreadedSumDenseFrequencies(ThreadIdType threadId)
+{
+  const InstanceIdentifier binsPerThread =
+    ( m_NumberOfBins + m_NumberOfSummingThreads - 1 ) / m_NumberOfSummingThreads;
+  const InstanceIdentifier begin = threadId * binsPerThread;
+  const InstanceIdentifier end = std::min(begin + binsPerThread, m_NumberOfBins);
+
+  DenseFrequencyArrayType & sums = m_DenseFrequencies[0];
+  for ( size_t t = 1; t < m_DenseFrequencies.size(); ++t )
+    {
+    const DenseFrequencyArrayType & frequencies = m_DenseFrequencies[t];
+    for ( InstanceIdentifier id = begin; id < end; ++id )
+      {
+      sums[id] += frequencies[id];
+      }
+    }
+}
+
+template< typename THistogram >
+void
+HistogramAccumulator< THistogram >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "MaximumNumberOfDenseBins: " << m_MaximumNumberOfDenseBins << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfBins: " << m_NumberOfBins << std::endl;
+  os << indent << "Dense: " << m_Dense << std::endl;
+  os << indent << "NumberOfAccumulatingThreads: "
+     << ( m_Dense ? m_DenseFrequencies.size() : m_SparseFrequencies.size() ) << std::endl;
+}
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
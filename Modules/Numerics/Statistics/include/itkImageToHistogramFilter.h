@@ -19,8 +19,8 @@
 #define itkImageToHistogramFilter_h
 
 #include "itkHistogram.h"
+#include "itkHistogramAccumulator.h"
 #include "itkImageTransformer.h"
-#include "itkBarrier.h"
 #include "itkSimpleDataObjectDecorator.h"
 #include "itkProgressReporter.h"
 
@@ -36,6 +36,15 @@ namespace Statistics
  *  an histogram from an image. Internally it creates a List that is feed into
  *  the SampleToHistogramFilter.
  *
+ *  The pixels are shared among several threads, each thread increasing the
+ *  frequencies of the bins in a storage of its own (see
+ *  HistogramAccumulator), which are summed in the output histogram at the
+ *  end. The input can also be streamed: with NumberOfStreamDivisions
+ *  greater than one, the largest possible region of the input is split in
+ *  pieces which are requested and processed one after the other, twice
+ *  when the minimum and maximum are computed automatically. The histogram
+ *  does not depend on the number of threads or pieces.
+ *
  * \ingroup ITKStatistics
  */
 
@@ -113,6 +122,11 @@ public:
    * automatically from the values of the sample */
   itkSetGetDecoratedInputMacro(AutoMinimumMaximum, bool);
 
+  /** Set/Get the number of pieces in which the input is streamed. Default
+   * is 1: the whole input is requested at once. */
+  itkSetMacro(NumberOfStreamDivisions, unsigned int);
+  itkGetConstMacro(NumberOfStreamDivisions, unsigned int);
+
   /** Method that facilitates the use of this filter in the internal
    * pipeline of another filter. */
   virtual void GraftOutput(DataObject *output);
@@ -122,9 +136,12 @@ protected:
   virtual ~ImageToHistogramFilter() {}
   void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
-  void BeforeThreadedGenerateData(void) ITK_OVERRIDE;
-  void ThreadedGenerateData(const RegionType & inputRegionForThread, ThreadIdType threadId) ITK_OVERRIDE;
-  void AfterThreadedGenerateData(void) ITK_OVERRIDE;
+  /** Request the first piece of the inputs when they are streamed. */
+  void GenerateInputRequestedRegion(void) ITK_OVERRIDE;
+
+  /** Compute the minimum and maximum if needed, then fill the histogram,
+   * piece after piece, with several threads. */
+  void GenerateData(void) ITK_OVERRIDE;
 
   /** Method that construct the outputs */
   typedef ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
@@ -134,7 +151,11 @@ protected:
   virtual void ThreadedComputeMinimumAndMaximum( const RegionType & inputRegionForThread, ThreadIdType threadId, ProgressReporter & progress );
   virtual void ThreadedComputeHistogram( const RegionType & inputRegionForThread, ThreadIdType threadId, ProgressReporter & progress );
 
-  std::vector< HistogramPointer >               m_Histograms;
+  typedef HistogramAccumulator< HistogramType > AccumulatorType;
+
+  /** The frequencies of the threads, increased by ThreadedComputeHistogram()
+   * for the bins of the output histogram. */
+  typename AccumulatorType::Pointer             m_Accumulator;
   std::vector< HistogramMeasurementVectorType > m_Minimums;
   std::vector< HistogramMeasurementVectorType > m_Maximums;
 
@@ -143,8 +164,30 @@ private:
   void operator=(const Self &);         //purposely not implemented
 
   void ApplyMarginalScale( HistogramMeasurementVectorType & min, HistogramMeasurementVectorType & max, HistogramSizeType & size );
-  typename Barrier::Pointer                     m_Barrier;
 
+  /** Split the largest possible region of the input in the streamed pieces. */
+  void ComputeStreamedPieces( std::vector< RegionType > & pieces );
+
+  /** Request a piece of all the image inputs, and update them. */
+  void UpdateInputPiece( const RegionType & piece );
+
+  /** Process the requested region of the input with several threads, to
+   * compute the minimum and maximum or to fill the histogram. */
+  void ThreadedProcessPiece( bool computeMinimumAndMaximum, ThreadIdType numberOfThreads,
+                             float initialProgress, float progressWeight );
+
+  /** Static callback of the threads processing a piece. */
+  static ITK_THREAD_RETURN_TYPE PieceThreaderCallback( void *arg );
+
+  struct PieceThreadStruct {
+    Self *Filter;
+    bool ComputeMinimumAndMaximum;
+    ThreadIdType NumberOfThreads;
+    float InitialProgress;
+    float ProgressWeight;
+  };
+
+  unsigned int m_NumberOfStreamDivisions;
 };
 } // end of namespace Statistics
 } // end of namespace itk
@@ -20,6 +20,7 @@
 
 #include "itkImageToHistogramFilter.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionSplitterSlowDimension.h"
 
 namespace itk
 {
@@ -52,6 +53,9 @@ ImageToHistogramFilter< TImage >
     autoMinMax->Set(true);
     }
    this->ProcessObject::SetInput( "AutoMinimumMaximum", autoMinMax );
+
+  m_Accumulator = AccumulatorType::New();
+  m_NumberOfStreamDivisions = 1;
 }
 
 template< typename TImage >
@@ -100,54 +104,101 @@ ImageToHistogramFilter< TImage >
 template< typename TImage >
 void
 ImageToHistogramFilter< TImage >
-::BeforeThreadedGenerateData()
+::GenerateInputRequestedRegion()
 {
-  // find the actual number of threads
-  long nbOfThreads = this->GetNumberOfThreads();
-  if ( itk::MultiThreader::GetGlobalMaximumNumberOfThreads() != 0 )
+  // request the largest possible region of the inputs
+  Superclass::GenerateInputRequestedRegion();
+
+  if( m_NumberOfStreamDivisions > 1 )
     {
-    nbOfThreads = vnl_math_min( this->GetNumberOfThreads(), itk::MultiThreader::GetGlobalMaximumNumberOfThreads() );
+    // only the first piece is requested here, the next pieces are
+    // requested in GenerateData()
+    std::vector< RegionType > pieces;
+    this->ComputeStreamedPieces( pieces );
+    const ProcessObject::DataObjectPointerArray inputs = this->GetInputs();
+    for( unsigned int i=0; i<inputs.size(); i++ )
+      {
+      typedef ImageBase< ImageType::ImageDimension > ImageBaseType;
+      ImageBaseType *input = dynamic_cast< ImageBaseType * >( inputs[i].GetPointer() );
+      if( input )
+        {
+        input->SetRequestedRegion( pieces[0] );
+        }
+      }
     }
-  // number of threads can be constrained by the region size, so call the
-  // SplitRequestedRegion
-  // to get the real number of threads which will be used
-  RegionType splitRegion;  // dummy region - just to call the following method
-  nbOfThreads = this->SplitRequestedRegion(0, nbOfThreads, splitRegion);
-
-  // and allocate one histogram per thread
-  m_Histograms.resize(nbOfThreads);
-  m_Minimums.resize(nbOfThreads);
-  m_Maximums.resize(nbOfThreads);
-  m_Barrier = Barrier::New();
-  m_Barrier->Initialize(nbOfThreads);
 }
 
 
 template< typename TImage >
 void
 ImageToHistogramFilter< TImage >
-::ThreadedGenerateData(const RegionType & inputRegionForThread, ThreadIdType threadId)
+::ComputeStreamedPieces( std::vector< RegionType > & pieces )
 {
-  long nbOfPixels = inputRegionForThread.GetNumberOfPixels();
-  if( this->GetAutoMinimumMaximumInput() && this->GetAutoMinimumMaximum() )
+  const RegionType largestRegion = this->GetInput()->GetLargestPossibleRegion();
+
+  typedef ImageRegionSplitterSlowDimension SplitterType;
+  SplitterType::Pointer splitter = SplitterType::New();
+  unsigned int numberOfPieces = 1;
+  if( m_NumberOfStreamDivisions > 1 )
     {
-    // we'll have to iterate over all the pixels 2 times
-    nbOfPixels *= 2;
+    numberOfPieces = splitter->GetNumberOfSplits( largestRegion, m_NumberOfStreamDivisions );
     }
-  ProgressReporter progress( this, threadId, nbOfPixels );
-
-  if( threadId == 0 )
+  pieces.assign( numberOfPieces, largestRegion );
+  for( unsigned int i=0; i<numberOfPieces; i++ )
     {
-    // just use the main one
-    m_Histograms[threadId] = this->GetOutput();
+    splitter->GetSplit( i, numberOfPieces, pieces[i] );
     }
-  else
+}
+
+
+template< typename TImage >
+void
+ImageToHistogramFilter< TImage >
+::UpdateInputPiece( const RegionType & piece )
+{
+  // like in the ImageFileWriter, request the piece of the inputs and
+  // update them
+  const ProcessObject::DataObjectPointerArray inputs = this->GetInputs();
+  for( unsigned int i=0; i<inputs.size(); i++ )
     {
-    m_Histograms[threadId] = HistogramType::New();
+    typedef ImageBase< ImageType::ImageDimension > ImageBaseType;
+    ImageBaseType *input = dynamic_cast< ImageBaseType * >( inputs[i].GetPointer() );
+    if( input )
+      {
+      input->SetRequestedRegion( piece );
+      input->PropagateRequestedRegion();
+      input->UpdateOutputData();
+      }
     }
-  HistogramType * hist = m_Histograms[threadId];
+}
+
+
+template< typename TImage >
+void
+ImageToHistogramFilter< TImage >
+::GenerateData()
+{
+  HistogramType * hist = this->GetOutput();
   hist->SetClipBinsAtEnds(true);
 
+  // find the actual number of threads
+  ThreadIdType nbOfThreads = this->GetNumberOfThreads();
+  if ( itk::MultiThreader::GetGlobalMaximumNumberOfThreads() != 0 )
+    {
+    nbOfThreads = vnl_math_min( this->GetNumberOfThreads(), itk::MultiThreader::GetGlobalMaximumNumberOfThreads() );
+    }
+
+  // the pieces of the input, processed one after the other. The first one
+  // has already been updated by the pipeline.
+  std::vector< RegionType > pieces;
+  this->ComputeStreamedPieces( pieces );
+  unsigned int currentPiece = 0;
+  if( pieces.size() == 1 )
+    {
+    // the whole requested region of the input, without streaming
+    pieces[0] = this->GetInput()->GetRequestedRegion();
+    }
+
   // the parameter needed to initialize the histogram
   unsigned int nbOfComponents = this->GetInput()->GetNumberOfComponentsPerPixel();
   HistogramSizeType size( nbOfComponents );
@@ -164,20 +215,35 @@ ImageToHistogramFilter< TImage >
     size.Fill(256);
     }
 
-  if( this->GetAutoMinimumMaximumInput() && this->GetAutoMinimumMaximum() )
+  // the progress is shared among the passes on the pieces
+  const bool autoMinimumMaximum = this->GetAutoMinimumMaximumInput() && this->GetAutoMinimumMaximum();
+  const unsigned int nbOfPasses = autoMinimumMaximum ? 2 : 1;
+  float totalNbOfPixels = 0;
+  for( unsigned int p=0; p<pieces.size(); p++ )
     {
-    // we have to compute the minimum and maximum values
-    this->ThreadedComputeMinimumAndMaximum( inputRegionForThread, threadId, progress );
-
-    // wait for the other threads to complete their part
-    m_Barrier->Wait();
+    totalNbOfPixels += pieces[p].GetNumberOfPixels();
+    }
+  totalNbOfPixels *= nbOfPasses;
+  float processedNbOfPixels = 0;
 
-    // a non multithreaded part
-    if( threadId == 0 )
+  if( autoMinimumMaximum )
+    {
+    // we have to compute the minimum and maximum values
+    min.Fill( NumericTraits<ValueType>::max() );
+    max.Fill( NumericTraits<ValueType>::NonpositiveMin() );
+    for( unsigned int p=0; p<pieces.size(); p++ )
       {
-      min = m_Minimums[0];
-      max = m_Maximums[0];
-      for( unsigned int t=1; t<m_Minimums.size(); t++ )
+      if( p != currentPiece )
+        {
+        this->UpdateInputPiece( pieces[p] );
+        currentPiece = p;
+        }
+      const float nbOfPixels = pieces[p].GetNumberOfPixels();
+      this->ThreadedProcessPiece( true, nbOfThreads, processedNbOfPixels / totalNbOfPixels,
+                                  nbOfPixels / totalNbOfPixels );
+      processedNbOfPixels += nbOfPixels;
+
+      for( unsigned int t=0; t<m_Minimums.size(); t++ )
         {
         for( unsigned int i=0; i<nbOfComponents; i++ )
           {
@@ -185,18 +251,8 @@ ImageToHistogramFilter< TImage >
           max[i] = std::max( max[i], m_Maximums[t][i] );
           }
         }
-      this->ApplyMarginalScale( min, max, size );
-      // store the values so they can be retreived by the other threads
-      m_Minimums[0] = min;
-      m_Maximums[0] = max;
       }
-
-    // wait for all the threads to complete
-    m_Barrier->Wait();
-
-    // and get the values computed in the main thread
-    min = m_Minimums[0];
-    max = m_Maximums[0];
+    this->ApplyMarginalScale( min, max, size );
     }
   else
     {
@@ -219,42 +275,94 @@ ImageToHistogramFilter< TImage >
       }
     }
 
-  // finally, initialize the histogram
+  // initialize the histogram
   hist->SetMeasurementVectorSize( nbOfComponents );
   hist->Initialize( size, min, max );
 
-  // now fill the histograms
-  this->ThreadedComputeHistogram( inputRegionForThread, threadId, progress );
+  // now fill the histogram, starting with the piece of the input which is
+  // already up to date
+  m_Accumulator->SetNumberOfThreads( nbOfThreads );
+  m_Accumulator->Initialize( hist, nbOfThreads );
+  const bool reverseOrder = ( currentPiece != 0 );
+  for( unsigned int n=0; n<pieces.size(); n++ )
+    {
+    const unsigned int p = reverseOrder ? pieces.size() - 1 - n : n;
+    if( p != currentPiece )
+      {
+      this->UpdateInputPiece( pieces[p] );
+      currentPiece = p;
+      }
+    const float nbOfPixels = pieces[p].GetNumberOfPixels();
+    this->ThreadedProcessPiece( false, nbOfThreads, processedNbOfPixels / totalNbOfPixels,
+                                nbOfPixels / totalNbOfPixels );
+    processedNbOfPixels += nbOfPixels;
+    }
+
+  // group the results of the threads in the output histogram
+  m_Accumulator->AddToHistogram( hist );
+
+  // and drop the temporary values
+  m_Minimums.clear();
+  m_Maximums.clear();
 }
 
 
 template< typename TImage >
 void
 ImageToHistogramFilter< TImage >
-::AfterThreadedGenerateData()
+::ThreadedProcessPiece( bool computeMinimumAndMaximum, ThreadIdType numberOfThreads,
+                        float initialProgress, float progressWeight )
 {
-  // group the results in the output histogram
-  HistogramType * hist = m_Histograms[0];
-  typename HistogramType::IndexType index;
-  for( unsigned int i=1; i<m_Histograms.size(); i++ )
+  // number of threads can be constrained by the region size, so call the
+  // SplitRequestedRegion
+  // to get the real number of threads which will be used
+  RegionType splitRegion;  // dummy region - just to call the following method
+  numberOfThreads = this->SplitRequestedRegion(0, numberOfThreads, splitRegion);
+
+  m_Minimums.resize(numberOfThreads);
+  m_Maximums.resize(numberOfThreads);
+
+  PieceThreadStruct str;
+  str.Filter = this;
+  str.ComputeMinimumAndMaximum = computeMinimumAndMaximum;
+  str.NumberOfThreads = numberOfThreads;
+  str.InitialProgress = initialProgress;
+  str.ProgressWeight = progressWeight;
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( Self::PieceThreaderCallback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+
+template< typename TImage >
+ITK_THREAD_RETURN_TYPE
+ImageToHistogramFilter< TImage >
+::PieceThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  PieceThreadStruct *str = static_cast< PieceThreadStruct * >( info->UserData );
+
+  const ThreadIdType threadId = info->ThreadID;
+  if( threadId < str->NumberOfThreads )
     {
-    typedef typename HistogramType::ConstIterator         HistogramIterator;
+    RegionType splitRegion;
+    str->Filter->SplitRequestedRegion( threadId, str->NumberOfThreads, splitRegion );
 
-    HistogramIterator hit = m_Histograms[i]->Begin();
-    HistogramIterator end = m_Histograms[i]->End();
-    while ( hit != end )
+    ProgressReporter progress( str->Filter, threadId, splitRegion.GetNumberOfPixels(), 100,
+                               str->InitialProgress, str->ProgressWeight );
+    if( str->ComputeMinimumAndMaximum )
+      {
+      str->Filter->ThreadedComputeMinimumAndMaximum( splitRegion, threadId, progress );
+      }
+    else
       {
-      hist->GetIndex( hit.GetMeasurementVector(), index);
-      hist->IncreaseFrequencyOfIndex( index, hit.GetFrequency() );
-      ++hit;
+      str->Filter->ThreadedComputeHistogram( splitRegion, threadId, progress );
       }
     }
 
-  // and drop the temporary histograms
-  m_Histograms.clear();
-  m_Minimums.clear();
-  m_Maximums.clear();
-  m_Barrier = ITK_NULLPTR;
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 
@@ -304,8 +412,8 @@ ImageToHistogramFilter< TImage >
     {
     const PixelType & p = inputIt.Get();
     NumericTraits<PixelType>::AssignToArray( p, m );
-    m_Histograms[threadId]->GetIndex( m, index );
-    m_Histograms[threadId]->IncreaseFrequencyOfIndex( index, 1 );
+    this->GetOutput()->GetIndex( m, index );
+    m_Accumulator->IncreaseFrequencyOfIndex( threadId, index, 1 );
     ++inputIt;
     progress.CompletedPixel();  // potential exception thrown here
     }
@@ -375,10 +483,7 @@ ImageToHistogramFilter< TImage >
     }
   if( clipHistograms == false )
     {
-    for( unsigned int i=0; i<m_Histograms.size(); i++ )
-      {
-      m_Histograms[i]->SetClipBinsAtEnds(false);
-      }
+    this->GetOutput()->SetClipBinsAtEnds(false);
     }
 }
 
@@ -398,6 +503,7 @@ ImageToHistogramFilter< TImage >
   os << indent << "AutoMinimumMaximum: " << this->GetAutoMinimumMaximumInput() << std::endl;
   // m_HistogramSize
   os << indent << "HistogramSize: " << this->GetHistogramSizeInput() << std::endl;
+  os << indent << "NumberOfStreamDivisions: " << m_NumberOfStreamDivisions << std::endl;
 }
 } // end of namespace Statistics
 } // end of namespace itk
@@ -25,6 +25,7 @@
 #include "itkSize.h"
 #include "itkObject.h"
 #include "itkArray.h"
+#include "itkMultiThreader.h"
 
 #include "itkSubsample.h"
 
@@ -99,6 +100,11 @@ struct KdTreeNode
   /** Returns the const pointer to the right child of this node */
   virtual const Self * Right() const = 0;
 
+  /** Replaces the children of a nonterminal node. The generators use it
+   * when the subtrees are built after their parent node. Terminal nodes
+   * have no child and ignore it. */
+  virtual void SetChildren( Self *, Self * ) {}
+
   /**
    * Returs the number of measurement vectors under this node including
    * its children
@@ -178,6 +184,13 @@ struct KdTreeNonterminalNode:public KdTreeNode<TSample>
     return m_Right;
   }
 
+  /** Replaces the children of this node */
+  void SetChildren( Superclass *left, Superclass *right )
+  {
+    m_Left = left;
+    m_Right = right;
+  }
+
   /**
    * Returs the number of measurement vectors under this node including
    * its children
@@ -294,6 +307,13 @@ struct KdTreeWeightedCentroidNonterminalNode:public KdTreeNode<TSample>
     return m_Right;
   }
 
+  /** Replace the left and the right trees. */
+  void SetChildren( Superclass *left, Superclass *right )
+  {
+    m_Left = left;
+    m_Right = right;
+  }
+
   /** Return the size of the node. */
   unsigned int Size() const
   {
@@ -467,6 +487,13 @@ private:
  * GetSearchResult method returns a pointer to a NearestNeighbors object
  * with k-nearest neighbors.
  *
+ * The Search methods taking a container of query points answer the
+ * queries with several threads, each thread searching the neighbors of a
+ * contiguous range of the query points. The results are the same as with
+ * one query at a time. The measurement vectors of the sample are then read
+ * by several threads at the same time, which the sample must allow, as
+ * ListSample and VectorContainerToListSampleAdaptor do.
+ *
  * <b>Recent API changes:</b>
  * The static const macro to get the length of a measurement vector,
  * 'MeasurementVectorSize'  has been removed to allow the length of a measurement
@@ -521,6 +548,12 @@ public:
 
   typedef std::vector< InstanceIdentifier > InstanceIdentifierVectorType;
 
+  /** Containers of query points and of search results, for the searches
+   * of the neighbors of several query points. */
+  typedef std::vector< MeasurementVectorType >         MeasurementVectorContainerType;
+  typedef std::vector< InstanceIdentifierVectorType >  InstanceIdentifierVectorContainerType;
+  typedef std::vector< std::vector< double > >         DistanceVectorContainerType;
+
   /** \class NearestNeighbors
    * \brief data structure for storing k-nearest neighbor search result
    * (k number of Neighbors)
@@ -686,6 +719,29 @@ public:
   void Search( const MeasurementVectorType &, double,
     InstanceIdentifierVectorType & ) const;
 
+  /** Searches the k-nearest neighbors of each query point, with several
+   * threads. */
+  void Search( const MeasurementVectorContainerType &, unsigned int,
+    InstanceIdentifierVectorContainerType & ) const;
+
+  /** Searches the k-nearest neighbors of each query point and returns
+   * their distances, with several threads. */
+  void Search( const MeasurementVectorContainerType &, unsigned int,
+    InstanceIdentifierVectorContainerType &,
+    DistanceVectorContainerType & ) const;
+
+  /** Searches the neighbors fallen into a hypersphere around each query
+   * point, with several threads. */
+  void Search( const MeasurementVectorContainerType &, double,
+    InstanceIdentifierVectorContainerType & ) const;
+
+  /** Set/Get the number of threads of the searches of several query
+   * points. The threads read the measurement vectors of the sample at the
+   * same time, which the image and point set adaptors do not allow, since
+   * they copy them into a member. Default is one thread. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
   /** Returns true if the intermediate k-nearest neighbors exist within
    * the the bounding box defined by the lowerBound and the
    * upperBound. Otherwise returns false. Returns false if the ball
@@ -743,6 +799,28 @@ private:
   KdTree( const Self & );         //purposely not implemented
   void operator=( const Self & ); //purposely not implemented
 
+  /** Data shared by the threads searching the neighbors of several query
+   * points. Distances is null when they are not returned. */
+  struct SearchThreadStruct
+    {
+    const Self                            *Tree;
+    const MeasurementVectorContainerType  *Queries;
+    bool                                   RadiusSearch;
+    unsigned int                           NumberOfNeighbors;
+    double                                 Radius;
+    InstanceIdentifierVectorContainerType *Results;
+    DistanceVectorContainerType           *Distances;
+    };
+
+  /** Searches the neighbors of several query points with several threads */
+  void ThreadedSearch( const MeasurementVectorContainerType &, bool,
+    unsigned int, double, InstanceIdentifierVectorContainerType &,
+    DistanceVectorContainerType * ) const;
+
+  /** Static callback of the threads searching the neighbors of several
+   * query points. */
+  static ITK_THREAD_RETURN_TYPE SearchThreaderCallback( void *arg );
+
   /** Pointer to the input sample */
   const TSample *m_Sample;
 
@@ -760,6 +838,9 @@ private:
 
   /** Measurement vector size */
   MeasurementVectorSizeType m_MeasurementVectorSize;
+
+  /** Number of threads of the searches of several query points */
+  ThreadIdType m_NumberOfThreads;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
@@ -20,6 +20,8 @@
 
 #include "itkKdTree.h"
 
+#include <algorithm>
+
 namespace itk
 {
 namespace Statistics
@@ -86,6 +88,7 @@ KdTree<TSample>
   this->m_Root = ITK_NULLPTR;
   this->m_BucketSize = 16;
   this->m_MeasurementVectorSize = 0;
+  this->m_NumberOfThreads = 1;
 }
 
 template<typename TSample>
@@ -127,6 +130,7 @@ KdTree<TSample>
     }
   os << indent << "MeasurementVectorSize: "
      << this->m_MeasurementVectorSize << std::endl;
+  os << indent << "Number Of Threads: " << this->m_NumberOfThreads << std::endl;
 }
 
 template<typename TSample>
@@ -374,6 +378,116 @@ KdTree<TSample>
   this->SearchLoop( this->m_Root, query, radius, lowerBound, upperBound, result );
 }
 
+template<typename TSample>
+void
+KdTree<TSample>
+::Search( const MeasurementVectorContainerType & queries,
+  unsigned int numberOfNeighborsRequested,
+  InstanceIdentifierVectorContainerType & results ) const
+{
+  this->ThreadedSearch( queries, false, numberOfNeighborsRequested, 0.0,
+    results, ITK_NULLPTR );
+}
+
+template<typename TSample>
+void
+KdTree<TSample>
+::Search( const MeasurementVectorContainerType & queries,
+  unsigned int numberOfNeighborsRequested,
+  InstanceIdentifierVectorContainerType & results,
+  DistanceVectorContainerType & distances ) const
+{
+  this->ThreadedSearch( queries, false, numberOfNeighborsRequested, 0.0,
+    results, &distances );
+}
+
+template<typename TSample>
+void
+KdTree<TSample>
+::Search( const MeasurementVectorContainerType & queries, double radius,
+  InstanceIdentifierVectorContainerType & results ) const
+{
+  this->ThreadedSearch( queries, true, 0, radius, results, ITK_NULLPTR );
+}
+
+template<typename TSample>
+void
+KdTree<TSample>
+::ThreadedSearch( const MeasurementVectorContainerType & queries,
+  bool radiusSearch, unsigned int numberOfNeighborsRequested, double radius,
+  InstanceIdentifierVectorContainerType & results,
+  DistanceVectorContainerType * distances ) const
+{
+  if( numberOfNeighborsRequested > this->Size() )
+    {
+    itkExceptionMacro( "The numberOfNeighborsRequested for the nearest "
+      << "neighbor search should be less than or equal to the number of "
+      << "the measurement vectors." );
+    }
+
+  results.resize( queries.size() );
+  if( distances )
+    {
+    distances->resize( queries.size() );
+    }
+  if( queries.empty() )
+    {
+    return;
+    }
+
+  SearchThreadStruct str;
+  str.Tree = this;
+  str.Queries = &queries;
+  str.RadiusSearch = radiusSearch;
+  str.NumberOfNeighbors = numberOfNeighborsRequested;
+  str.Radius = radius;
+  str.Results = &results;
+  str.Distances = distances;
+
+  // a threader of its own, so that several threads may search the tree at
+  // the same time
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast< ThreadIdType >( std::min(
+    static_cast< SizeValueType >( this->m_NumberOfThreads ),
+    static_cast< SizeValueType >( queries.size() ) ) ) );
+  threader->SetSingleMethod( Self::SearchThreaderCallback, &str );
+  threader->SingleMethodExecute();
+}
+
+template<typename TSample>
+ITK_THREAD_RETURN_TYPE
+KdTree<TSample>
+::SearchThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  SearchThreadStruct *str = static_cast< SearchThreadStruct * >( info->UserData );
+  const SizeValueType numberOfQueries = str->Queries->size();
+  const SizeValueType begin = numberOfQueries * info->ThreadID / info->NumberOfThreads;
+  const SizeValueType end = numberOfQueries * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+  std::vector<double> notUsedDistances;
+  for( SizeValueType i = begin; i < end; ++i )
+    {
+    if( str->RadiusSearch )
+      {
+      str->Tree->Search( ( *str->Queries )[i], str->Radius, ( *str->Results )[i] );
+      }
+    else if( str->Distances )
+      {
+      str->Tree->Search( ( *str->Queries )[i], str->NumberOfNeighbors,
+        ( *str->Results )[i], ( *str->Distances )[i] );
+      }
+    else
+      {
+      str->Tree->Search( ( *str->Queries )[i], str->NumberOfNeighbors,
+        ( *str->Results )[i], notUsedDistances );
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template<typename TSample>
 inline int
 KdTree<TSample>
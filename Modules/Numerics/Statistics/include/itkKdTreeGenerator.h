@@ -18,10 +18,13 @@
 #ifndef itkKdTreeGenerator_h
 #define itkKdTreeGenerator_h
 
+#include <map>
 #include <vector>
 
 #include "itkKdTree.h"
 #include "itkStatisticsAlgorithm.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 
 namespace itk
 {
@@ -51,6 +54,16 @@ namespace Statistics
  * Update method will run this generator. To get the resulting KdTree
  * object, call the GetOutput method.
  *
+ * With several threads (SetNumberOfThreads), the top levels of the tree
+ * are built first, down to subtrees of about a fourth of the measurement
+ * vectors per thread. The threads then build these subtrees, which
+ * partition disjoint ranges of the internal Subsample, and the subtrees
+ * are plugged into their parent nodes. The tree is the same as with one
+ * thread. The measurement vectors of the sample are then read by several
+ * threads at the same time, which the sample must allow, as ListSample and
+ * VectorContainerToListSampleAdaptor do, but not the image adaptors, which
+ * is why the default is one thread.
+ *
  * <b>Recent API changes:</b>
  * The static const macro to get the length of a measurement vector,
  * 'MeasurementVectorSize'  has been removed to allow the length of a measurement
@@ -129,6 +142,10 @@ public:
   /** Runs this k-d tree construction algorithm. */
   void GenerateData();
 
+  /** Set/Get the number of threads building the tree. Default is one. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
+
   /** Get macro to get the length of the measurement vectors that are being
    * held in the 'sample' that is passed to this class */
   itkGetConstMacro(MeasurementVectorSize, unsigned int);
@@ -157,7 +174,8 @@ protected:
                                                    & upperBound,
                                                    unsigned int level);
 
-  /** Tree generation loop */
+  /** Tree generation loop. Returns a placeholder for the subtrees built
+   * later by the threads. */
   KdTreeNodeType * GenerateTreeLoop(unsigned int beginIndex, unsigned int endIndex,
                                     MeasurementVectorType & lowerBound,
                                     MeasurementVectorType & upperBound,
@@ -182,17 +200,46 @@ private:
   /** Pointer to the resulting k-d tree. */
   OutputPointer m_Tree;
 
-  /** Temporary lower bound for the TreeGenerationLoop */
-  MeasurementVectorType m_TempLowerBound;
+  /** Length of a measurement vector */
+  MeasurementVectorSizeType m_MeasurementVectorSize;
 
-  /** Temporary upper bound for the TreeGenerationLoop */
-  MeasurementVectorType m_TempUpperBound;
+  /** A subtree built by one of the threads, over a range of the
+   * Subsample, and the node standing for it in its parent until then. */
+  struct DeferredSubtreeType
+    {
+    unsigned int          BeginIndex;
+    unsigned int          EndIndex;
+    MeasurementVectorType LowerBound;
+    MeasurementVectorType UpperBound;
+    unsigned int          Level;
+    KdTreeNodeType       *Placeholder;
+    KdTreeNodeType       *Root;
+    };
 
-  /** Temporary mean for the TreeGenerationLoop */
-  MeasurementVectorType m_TempMean;
+  /** Builds the subtrees not built yet, until there is none left. */
+  void ThreadedGenerateDeferredSubtrees();
 
-  /** Length of a measurement vector */
-  MeasurementVectorSizeType m_MeasurementVectorSize;
+  /** Static callback of the threads building the subtrees. */
+  static ITK_THREAD_RETURN_TYPE GenerateDeferredSubtreesThreaderCallback(void *arg);
+
+  typedef std::map< KdTreeNodeType *, KdTreeNodeType * > PlaceholderMapType;
+
+  /** Replaces the placeholders below a node by their subtrees. */
+  void ReplacePlaceholders(KdTreeNodeType *node, const PlaceholderMapType & subtrees);
+
+  /** Number of threads building the tree */
+  ThreadIdType m_NumberOfThreads;
+
+  MultiThreader::Pointer m_Threader;
+
+  /** While the top levels of the tree are built, the ranges of the
+   * Subsample with more than the bucket size and at most this number of
+   * measurement vectors are left to the threads. Zero otherwise. */
+  unsigned int m_DeferredSubtreeSize;
+
+  std::vector< DeferredSubtreeType > m_DeferredSubtrees;
+  size_t                             m_NextDeferredSubtree;
+  SimpleFastMutexLock                m_DeferredSubtreesLock;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
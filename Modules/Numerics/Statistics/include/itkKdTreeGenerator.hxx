@@ -19,6 +19,9 @@
 #define itkKdTreeGenerator_hxx
 
 #include  "itkKdTreeGenerator.h"
+#include  "itkMutexLockHolder.h"
+
+#include <algorithm>
 
 namespace itk
 {
@@ -32,6 +35,10 @@ KdTreeGenerator< TSample >
   m_BucketSize = 16;
   m_Subsample = SubsampleType::New();
   m_MeasurementVectorSize = 0;
+  m_NumberOfThreads = 1;
+  m_Threader = MultiThreader::New();
+  m_DeferredSubtreeSize = 0;
+  m_NextDeferredSubtree = 0;
 }
 
 template< typename TSample >
@@ -54,6 +61,7 @@ KdTreeGenerator< TSample >
   os << indent << "Bucket Size: " << m_BucketSize << std::endl;
   os << indent << "MeasurementVectorSize: "
      << m_MeasurementVectorSize << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
 }
 
 template< typename TSample >
@@ -65,9 +73,6 @@ KdTreeGenerator< TSample >
   m_Subsample->SetSample(sample);
   m_Subsample->InitializeWithAllInstances();
   m_MeasurementVectorSize = sample->GetMeasurementVectorSize();
-  NumericTraits<MeasurementVectorType>::SetLength(m_TempLowerBound, m_MeasurementVectorSize);
-  NumericTraits<MeasurementVectorType>::SetLength(m_TempUpperBound, m_MeasurementVectorSize);
-  NumericTraits<MeasurementVectorType>::SetLength(m_TempMean, m_MeasurementVectorSize);
 }
 
 template< typename TSample >
@@ -115,11 +120,116 @@ KdTreeGenerator< TSample >
     upperBound[d] = NumericTraits< MeasurementType >::max();
     }
 
+  // With several threads, the subtrees of about a fourth of the
+  // measurement vectors per thread are left to the threads while the top
+  // levels of the tree are built.
+  const unsigned int size = static_cast< unsigned int >( m_Subsample->Size() );
+  m_DeferredSubtrees.clear();
+  m_DeferredSubtreeSize = 0;
+  if ( m_NumberOfThreads > 1 && size / ( 4 * m_NumberOfThreads ) > m_BucketSize )
+    {
+    m_DeferredSubtreeSize = size / ( 4 * m_NumberOfThreads );
+    }
+
   KdTreeNodeType *root =
-    this->GenerateTreeLoop(0, m_Subsample->Size(), lowerBound, upperBound, 0);
+    this->GenerateTreeLoop(0, size, lowerBound, upperBound, 0);
+  m_DeferredSubtreeSize = 0;
+
+  if ( !m_DeferredSubtrees.empty() )
+    {
+    m_NextDeferredSubtree = 0;
+    m_Threader->SetNumberOfThreads( static_cast< ThreadIdType >(
+      std::min( static_cast< size_t >( m_NumberOfThreads ), m_DeferredSubtrees.size() ) ) );
+    m_Threader->SetSingleMethod(Self::GenerateDeferredSubtreesThreaderCallback, this);
+    m_Threader->SingleMethodExecute();
+
+    PlaceholderMapType subtrees;
+    for ( size_t i = 0; i < m_DeferredSubtrees.size(); i++ )
+      {
+      subtrees[m_DeferredSubtrees[i].Placeholder] = m_DeferredSubtrees[i].Root;
+      }
+    this->ReplacePlaceholders(root, subtrees);
+    for ( size_t i = 0; i < m_DeferredSubtrees.size(); i++ )
+      {
+      delete m_DeferredSubtrees[i].Placeholder;
+      }
+    m_DeferredSubtrees.clear();
+    }
+
   m_Tree->SetRoot(root);
 }
 
+template< typename TSample >
+ITK_THREAD_RETURN_TYPE
+KdTreeGenerator< TSample >
+::GenerateDeferredSubtreesThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self *generator = static_cast< Self * >( info->UserData );
+
+  generator->ThreadedGenerateDeferredSubtrees();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TSample >
+void
+KdTreeGenerator< TSample >
+::ThreadedGenerateDeferredSubtrees()
+{
+  while ( true )
+    {
+    size_t subtreeIndex;
+      {
+      MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_DeferredSubtreesLock);
+      subtreeIndex = m_NextDeferredSubtree++;
+      }
+    if ( subtreeIndex >= m_DeferredSubtrees.size() )
+      {
+      return;
+      }
+
+    // the subtree only reorders its own range of the Subsample
+    DeferredSubtreeType & subtree = m_DeferredSubtrees[subtreeIndex];
+    subtree.Root = this->GenerateTreeLoop(subtree.BeginIndex, subtree.EndIndex,
+                                          subtree.LowerBound, subtree.UpperBound,
+                                          subtree.Level);
+    }
+}
+
+template< typename TSample >
+void
+KdTreeGenerator< TSample >
+::ReplacePlaceholders(KdTreeNodeType *node, const PlaceholderMapType & subtrees)
+{
+  if ( node->IsTerminal() )
+    {
+    return;
+    }
+
+  KdTreeNodeType *children[2] = { node->Left(), node->Right() };
+  for ( unsigned int i = 0; i < 2; i++ )
+    {
+    typename PlaceholderMapType::const_iterator it = subtrees.find(children[i]);
+    if ( it != subtrees.end() )
+      {
+      children[i] = it->second;
+      }
+    else
+      {
+      this->ReplacePlaceholders(children[i], subtrees);
+      }
+    }
+
+  node->SetChildren(children[0], children[1]);
+  if ( node->Left() != children[0] || node->Right() != children[1] )
+    {
+    itkExceptionMacro(<< "The nonterminal nodes must implement SetChildren "
+                      << "for the tree to be built with several threads");
+    }
+}
+
 template< typename TSample >
 inline typename KdTreeGenerator< TSample >::KdTreeNodeType *
 KdTreeGenerator< TSample >
@@ -141,16 +251,23 @@ KdTreeGenerator< TSample >
 
   SubsamplePointer subsample = this->GetSubsample();
 
-  // find most widely spread dimension
+  // find most widely spread dimension, with temporary vectors of the
+  // calling thread
+  MeasurementVectorType tempLowerBound;
+  NumericTraits<MeasurementVectorType>::SetLength(tempLowerBound, m_MeasurementVectorSize);
+  MeasurementVectorType tempUpperBound;
+  NumericTraits<MeasurementVectorType>::SetLength(tempUpperBound, m_MeasurementVectorSize);
+  MeasurementVectorType tempMean;
+  NumericTraits<MeasurementVectorType>::SetLength(tempMean, m_MeasurementVectorSize);
   Algorithm::FindSampleBoundAndMean< SubsampleType >(subsample,
                                                      beginIndex, endIndex,
-                                                     m_TempLowerBound, m_TempUpperBound,
-                                                     m_TempMean);
+                                                     tempLowerBound, tempUpperBound,
+                                                     tempMean);
 
   maxSpread = NumericTraits< MeasurementType >::NonpositiveMin();
   for ( i = 0; i < m_MeasurementVectorSize; i++ )
     {
-    spread = m_TempUpperBound[i] - m_TempLowerBound[i];
+    spread = tempUpperBound[i] - tempLowerBound[i];
     if ( spread >= maxSpread )
       {
       maxSpread = spread;
@@ -234,6 +351,20 @@ KdTreeGenerator< TSample >
       return ptr;
       }
     }
+  else if ( endIndex - beginIndex <= m_DeferredSubtreeSize )
+    {
+    // leave the subtree to one of the threads, and stand for it until then
+    DeferredSubtreeType subtree;
+    subtree.BeginIndex = beginIndex;
+    subtree.EndIndex = endIndex;
+    subtree.LowerBound = lowerBound;
+    subtree.UpperBound = upperBound;
+    subtree.Level = level;
+    subtree.Placeholder = new KdTreeTerminalNode< TSample >();
+    subtree.Root = ITK_NULLPTR;
+    m_DeferredSubtrees.push_back(subtree);
+    return subtree.Placeholder;
+    }
   else
     {
     return this->GenerateNonterminalNode(beginIndex, endIndex,
@@ -93,8 +93,8 @@ MaskedImageToHistogramFilter< TImage, TMaskImage >
       {
       const PixelType & p = inputIt.Get();
       NumericTraits<PixelType>::AssignToArray( p, m );
-      this->m_Histograms[threadId]->GetIndex( m, index );
-      this->m_Histograms[threadId]->IncreaseFrequencyOfIndex( index, 1 );
+      this->GetOutput()->GetIndex( m, index );
+      this->m_Accumulator->IncreaseFrequencyOfIndex( threadId, index, 1 );
       }
     ++inputIt;
     ++maskIt;
@@ -0,0 +1,288 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMovingTextureFeaturesImageFilter_h
+#define itkMovingTextureFeaturesImageFilter_h
+
+#include <vector>
+
+#include "itkImageToImageFilter.h"
+#include "itkVectorImage.h"
+#include "itkVectorContainer.h"
+#include "itkHistogram.h"
+
+namespace itk
+{
+namespace Statistics
+{
+/** \class MovingTextureFeaturesImageFilter
+ *  \brief Computes maps of the Haralick and run length texture features
+ *  in a window moving over an image.
+ *
+ * For each pixel of the output, this filter computes the texture features
+ * of the box of radius Radius centered on the pixel, cropped to the
+ * largest possible region of the input. Each component of the output
+ * VectorImage is the mean of one feature over the offsets whose matrix is
+ * not empty:
+ * -# components 0 to 7 are the features of the grey level co-occurrence
+ *    matrices, in the order of HistogramToTextureFeaturesFilter:
+ *    Energy, Entropy, Correlation, InverseDifferenceMoment, Inertia,
+ *    ClusterShade, ClusterProminence and HaralickCorrelation;
+ * -# components 8 to 17 are the features of the run length matrices, in
+ *    the order of HistogramToRunLengthFeaturesFilter: ShortRunEmphasis,
+ *    LongRunEmphasis, GreyLevelNonuniformity, RunLengthNonuniformity,
+ *    LowGreyLevelRunEmphasis, HighGreyLevelRunEmphasis,
+ *    ShortRunLowGreyLevelEmphasis, ShortRunHighGreyLevelEmphasis,
+ *    LongRunLowGreyLevelEmphasis and LongRunHighGreyLevelEmphasis.
+ *
+ * The matrices of a window are the ones computed by
+ * ScalarImageToCooccurrenceMatrixFilter and
+ * ScalarImageToRunLengthMatrixFilter on an image made of the pixels of the
+ * window, with the same number of bins, pixel value range and distance
+ * range: the co-occurrences are the pairs of pixels of the window, and the
+ * runs stop at the border of the window. A feature of an offset without any
+ * co-occurrence or run is not included in the mean, and the features are
+ * zero when no offset has any.
+ *
+ * Computing the matrices of each window from scratch would visit all the
+ * pixels of the window for each output pixel. Instead, the matrices are
+ * updated as the window moves by one pixel, in the way of
+ * MovingHistogramImageFilter: the co-occurrences of the pixels leaving and
+ * entering the window are removed and added, and the runs are only
+ * recomputed at the ends of the lines whose part in the window changes.
+ * The filter is multithreaded over the output regions.
+ *
+ * The matrices of a window are small, so the default number of bins per
+ * axis is 8. The default offsets are the ones of
+ * ScalarImageToTextureFeaturesFilter, and the default pixel value and
+ * distance ranges are the ones of the matrix filters.
+ *
+ * \sa ScalarImageToTextureFeaturesFilter
+ * \sa ScalarImageToRunLengthFeaturesFilter
+ * \sa MovingHistogramImageFilter
+ * \ingroup ITKStatistics
+ */
+
+template< typename TImageType,
+          typename TOutputImageType = VectorImage< float, TImageType::ImageDimension > >
+class MovingTextureFeaturesImageFilter:
+  public ImageToImageFilter< TImageType, TOutputImageType >
+{
+public:
+  /** Standard typedefs */
+  typedef MovingTextureFeaturesImageFilter                   Self;
+  typedef ImageToImageFilter< TImageType, TOutputImageType > Superclass;
+  typedef SmartPointer< Self >                               Pointer;
+  typedef SmartPointer< const Self >                         ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MovingTextureFeaturesImageFilter, ImageToImageFilter);
+
+  /** standard New() method support */
+  itkNewMacro(Self);
+
+  typedef TImageType                                   ImageType;
+  typedef typename ImageType::PixelType                PixelType;
+  typedef typename ImageType::IndexType                IndexType;
+  typedef typename ImageType::RegionType               RegionType;
+  typedef typename ImageType::SizeType                 RadiusType;
+  typedef typename ImageType::OffsetType               OffsetType;
+  typedef VectorContainer< unsigned char, OffsetType > OffsetVector;
+  typedef typename OffsetVector::Pointer               OffsetVectorPointer;
+  typedef typename OffsetVector::ConstPointer          OffsetVectorConstPointer;
+
+  typedef TOutputImageType                             OutputImageType;
+  typedef typename OutputImageType::PixelType          OutputPixelType;
+  typedef typename OutputImageType::RegionType         OutputImageRegionType;
+
+  typedef typename NumericTraits< PixelType >::RealType MeasurementType;
+  typedef typename NumericTraits< PixelType >::RealType RealType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, ImageType::ImageDimension);
+
+  itkStaticConstMacro(NumberOfTextureFeatures, unsigned int, 8);
+  itkStaticConstMacro(NumberOfRunLengthFeatures, unsigned int, 10);
+
+  itkStaticConstMacro(DefaultBinsPerAxis, unsigned int, 8);
+
+  /** Set/Get the radius of the window. */
+  itkSetMacro(Radius, RadiusType);
+  itkGetConstReferenceMacro(Radius, RadiusType);
+  void SetRadius(SizeValueType radius);
+
+  /** Set/Get the offsets of the co-occurrences and the directions of the
+   * runs. */
+  itkSetConstObjectMacro(Offsets, OffsetVector);
+  itkGetConstObjectMacro(Offsets, OffsetVector);
+  void SetOffset(const OffsetType offset);
+
+  /** Set/Get the number of bins of the pixel values, and of the run
+   * distances. */
+  itkSetMacro(NumberOfBinsPerAxis, unsigned int);
+  itkGetConstMacro(NumberOfBinsPerAxis, unsigned int);
+
+  /** Set the range of the pixel values of the matrices. The pixels whose
+   * values are out of the range are not in any co-occurrence or run. */
+  void SetPixelValueMinMax(PixelType min, PixelType max);
+  itkGetConstMacro(Min, PixelType);
+  itkGetConstMacro(Max, PixelType);
+
+  /** Set the range of the physical distances between the first and the
+   * last pixels of the runs of the run length matrices. */
+  void SetDistanceValueMinMax(RealType min, RealType max);
+  itkGetConstMacro(MinDistance, RealType);
+  itkGetConstMacro(MaxDistance, RealType);
+
+protected:
+  MovingTextureFeaturesImageFilter();
+  virtual ~MovingTextureFeaturesImageFilter() {}
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** The output has one component per feature. */
+  virtual void GenerateOutputInformation() ITK_OVERRIDE;
+
+  /** The input requested region is the output requested region padded by
+   * the radius. */
+  virtual void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  virtual void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  virtual void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                    ThreadIdType threadId) ITK_OVERRIDE;
+
+private:
+  MovingTextureFeaturesImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                   //purposely not implemented
+
+  typedef Histogram< MeasurementType > HistogramType;
+
+  /** Image of the bins of the pixel values, -1 for the values out of the
+   * range. */
+  typedef Image< int, itkGetStaticConstMacro(ImageDimension) > BinImageType;
+
+  /** Co-occurrence and run length matrices of all the offsets for a
+   * window. The first index of a matrix varies the fastest, as in the
+   * frequency containers of Histogram. */
+  struct WindowMatrices {
+    std::vector< SizeValueType > Cooccurrence;
+    std::vector< SizeValueType > RunLength;
+  };
+
+  /** Returns the window centered on a pixel. */
+  RegionType GetWindow(const IndexType & center) const;
+
+  /** Quantizes the pixel values of a region of the input. */
+  void ComputeBins(const RegionType & region, BinImageType *cooccurrenceBins,
+                   BinImageType *runLengthBins) const;
+
+  /** Computes the matrices of a window from scratch. */
+  void InitializeMatrices(WindowMatrices & matrices, const RegionType & window,
+                          const BinImageType *cooccurrenceBins,
+                          const BinImageType *runLengthBins) const;
+
+  /** Updates the matrices of the window centered on a pixel for the move
+   * of the window by one pixel along a dimension. */
+  void MoveMatrices(WindowMatrices & matrices, const IndexType & center, unsigned int dimension,
+                    const BinImageType *cooccurrenceBins,
+                    const BinImageType *runLengthBins) const;
+
+  /** Returns the slabs of a window leaving and entering it when it moves by
+   * one pixel along a dimension, and whether a slab leaves the window. */
+  static bool GetMovingSlabs(const RegionType & oldWindow, const RegionType & newWindow,
+                             unsigned int dimension, RegionType & leavingSlab,
+                             RegionType & enteringSlab);
+
+  /** Returns the offset in the buffer of the bins between two pixels. */
+  static OffsetValueType GetBufferStride(const BinImageType *bins, const OffsetType & offset)
+  {
+    OffsetValueType stride = 0;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      stride += offset[d] * bins->GetOffsetTable()[d];
+      }
+    return stride;
+  }
+
+  /** Adds or removes the co-occurrences in a window of the pixels of a
+   * slab of the window. */
+  void UpdateCooccurrences(WindowMatrices & matrices, const RegionType & slab,
+                           const RegionType & window, const BinImageType *bins,
+                           bool add) const;
+
+  /** Replaces the runs in a window by the runs in the window moved by one
+   * pixel along a dimension, or adds the runs of the new window when the
+   * old window is empty and the dimension is ImageDimension. */
+  void UpdateRuns(WindowMatrices & matrices, const RegionType & oldWindow,
+                  const RegionType & newWindow, unsigned int dimension,
+                  const BinImageType *bins) const;
+
+  /** Replaces the runs in a window by the runs in another window on the
+   * line of an offset through a pixel. */
+  void UpdateRunsOfLine(SizeValueType *matrix, const std::vector< int > & distanceBins,
+                        const int *line, OffsetValueType stride, const IndexType & index,
+                        const OffsetType & offset, const RegionType & oldWindow,
+                        const RegionType & newWindow) const;
+
+  /** Returns the first and the last positions, relative to a pixel, of the
+   * pixels of a line in a region, the last being before the first when the
+   * line does not cross the region. */
+  static void GetLineRange(const IndexType & index, const OffsetType & offset,
+                           const RegionType & region, OffsetValueType & first,
+                           OffsetValueType & last);
+
+  /** Adds or removes the runs of the pixels first to last of a line. */
+  void UpdateRunsOfSegment(SizeValueType *matrix, const std::vector< int > & distanceBins,
+                           const int *line, OffsetValueType stride, OffsetValueType first,
+                           OffsetValueType last, bool add) const;
+
+  /** Computes the mean features of the matrices of a window. */
+  void ComputeFeatures(const WindowMatrices & matrices, OutputPixelType & features) const;
+
+  /** Computes the features of a co-occurrence matrix as
+   * HistogramToTextureFeaturesFilter. Returns false if the matrix is
+   * empty. */
+  bool ComputeTextureFeatures(const SizeValueType *matrix, double *features) const;
+
+  /** Computes the features of a run length matrix as
+   * HistogramToRunLengthFeaturesFilter. Returns false if the matrix is
+   * empty. */
+  bool ComputeRunLengthFeatures(const SizeValueType *matrix, double *features) const;
+
+  RadiusType               m_Radius;
+  OffsetVectorConstPointer m_Offsets;
+  unsigned int             m_NumberOfBinsPerAxis;
+  PixelType                m_Min;
+  PixelType                m_Max;
+  RealType                 m_MinDistance;
+  RealType                 m_MaxDistance;
+
+  typename HistogramType::Pointer m_CooccurrenceBinHistogram;
+  typename HistogramType::Pointer m_RunLengthBinHistogram;
+
+  /** Bins of the distances of the runs of each offset, indexed by the
+   * number of pixels of the runs, -1 for the distances out of the
+   * range. */
+  std::vector< std::vector< int > > m_DistanceBins;
+};
+} // end of namespace Statistics
+} // end of namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMovingTextureFeaturesImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,1006 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMovingTextureFeaturesImageFilter_hxx
+#define itkMovingTextureFeaturesImageFilter_hxx
+
+#include "itkMovingTextureFeaturesImageFilter.h"
+#include "itkNeighborhood.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+#include "itkMath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace itk
+{
+namespace Statistics
+{
+template< typename TImageType, typename TOutputImageType >
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::MovingTextureFeaturesImageFilter() :
+  m_NumberOfBinsPerAxis( itkGetStaticConstMacro( DefaultBinsPerAxis ) ),
+  m_Min( NumericTraits< PixelType >::NonpositiveMin() ),
+  m_Max( NumericTraits< PixelType >::max() ),
+  m_MinDistance( NumericTraits< RealType >::ZeroValue() ),
+  m_MaxDistance( NumericTraits< RealType >::max() )
+{
+  m_Radius.Fill(1);
+
+  // Set the offset directions to their defaults: half of all the possible
+  // directions 1 pixel away. (The other half is included by symmetry.)
+  typedef Neighborhood< PixelType, ImageDimension > NeighborhoodType;
+  NeighborhoodType hood;
+  hood.SetRadius(1);
+
+  // select all "previous" neighbors that are face+edge+vertex
+  // connected to the current pixel. do not include the center pixel.
+  unsigned int        centerIndex = hood.GetCenterNeighborhoodIndex();
+  OffsetVectorPointer offsets = OffsetVector::New();
+  for ( unsigned int d = 0; d < centerIndex; d++ )
+    {
+    offsets->push_back( hood.GetOffset(d) );
+    }
+  this->SetOffsets(offsets);
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::SetRadius(SizeValueType radius)
+{
+  RadiusType rad;
+
+  rad.Fill(radius);
+  this->SetRadius(rad);
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::SetOffset(const OffsetType offset)
+{
+  OffsetVectorPointer offsetVector = OffsetVector::New();
+  offsetVector->push_back(offset);
+  this->SetOffsets(offsetVector);
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::SetPixelValueMinMax(PixelType min, PixelType max)
+{
+  itkDebugMacro("setting Min to " << min << "and Max to " << max);
+  if ( m_Min != min || m_Max != max )
+    {
+    m_Min = min;
+    m_Max = max;
+    this->Modified();
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::SetDistanceValueMinMax(RealType min, RealType max)
+{
+  itkDebugMacro("setting MinDistance to " << min << "and MaxDistance to " << max);
+  if ( Math::NotExactlyEquals(m_MinDistance, min) || Math::NotExactlyEquals(m_MaxDistance, max) )
+    {
+    m_MinDistance = min;
+    m_MaxDistance = max;
+    this->Modified();
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  this->GetOutput()->SetNumberOfComponentsPerPixel(NumberOfTextureFeatures + NumberOfRunLengthFeatures);
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  ImageType *inputPtr = const_cast< ImageType * >( this->GetInput() );
+  if ( !inputPtr )
+    {
+    return;
+    }
+
+  // pad the input requested region by the radius of the window
+  RegionType inputRequestedRegion = inputPtr->GetRequestedRegion();
+  inputRequestedRegion.PadByRadius(m_Radius);
+
+  // crop the input requested region at the input's largest possible region
+  if ( inputRequestedRegion.Crop( inputPtr->GetLargestPossibleRegion() ) )
+    {
+    inputPtr->SetRequestedRegion(inputRequestedRegion);
+    return;
+    }
+  else
+    {
+    // Couldn't crop the region (requested region is outside the largest
+    // possible region).  Throw an exception.
+
+    // store what we tried to request (prior to trying to crop)
+    inputPtr->SetRequestedRegion(inputRequestedRegion);
+
+    // build an exception
+    InvalidRequestedRegionError e(__FILE__, __LINE__);
+    e.SetLocation(ITK_LOCATION);
+    e.SetDescription("Requested region is (at least partially) outside the largest possible region.");
+    e.SetDataObject(inputPtr);
+    throw e;
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::BeforeThreadedGenerateData()
+{
+  if ( m_Offsets.IsNull() || m_Offsets->Size() == 0 )
+    {
+    itkExceptionMacro("No offset is set");
+    }
+  typename OffsetVector::ConstIterator offsets;
+  for ( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); offsets++ )
+    {
+    OffsetType zeroOffset;
+    zeroOffset.Fill(0);
+    if ( offsets.Value() == zeroOffset )
+      {
+      itkExceptionMacro("The offsets must not be zero");
+      }
+    }
+  if ( m_NumberOfBinsPerAxis < 1 )
+    {
+    itkExceptionMacro("The number of bins per axis must be at least 1");
+    }
+
+  // The pixel values are put in the bins of the matrix filters: a last bin
+  // open at Max + 1 for the co-occurrences, closed at Max for the runs
+  typename HistogramType::SizeType size(1);
+  size.Fill(m_NumberOfBinsPerAxis);
+  typename HistogramType::MeasurementVectorType lowerBound(1);
+  typename HistogramType::MeasurementVectorType upperBound(1);
+
+  m_CooccurrenceBinHistogram = HistogramType::New();
+  m_CooccurrenceBinHistogram->SetMeasurementVectorSize(1);
+  lowerBound.Fill(m_Min);
+  upperBound.Fill(m_Max + 1);
+  m_CooccurrenceBinHistogram->Initialize(size, lowerBound, upperBound);
+
+  m_RunLengthBinHistogram = HistogramType::New();
+  m_RunLengthBinHistogram->SetMeasurementVectorSize(1);
+  upperBound.Fill(m_Max);
+  m_RunLengthBinHistogram->Initialize(size, lowerBound, upperBound);
+
+  typename HistogramType::Pointer distanceBinHistogram = HistogramType::New();
+  distanceBinHistogram->SetMeasurementVectorSize(1);
+  lowerBound.Fill(m_MinDistance);
+  upperBound.Fill(m_MaxDistance);
+  distanceBinHistogram->Initialize(size, lowerBound, upperBound);
+
+  // The bins of the distances of the longest runs in a window along each
+  // offset
+  const ImageType *input = this->GetInput();
+  const RegionType largestRegion = input->GetLargestPossibleRegion();
+  const IndexType  start = largestRegion.GetIndex();
+
+  typename ImageType::PointType startPoint;
+  input->TransformIndexToPhysicalPoint(start, startPoint);
+
+  typename HistogramType::MeasurementVectorType distance(1);
+  typename HistogramType::IndexType             distanceIndex(1);
+
+  m_DistanceBins.resize( m_Offsets->Size() );
+  unsigned int offsetNumber = 0;
+  for ( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); offsets++, offsetNumber++ )
+    {
+    const OffsetType offset = offsets.Value();
+    OffsetValueType  maximumRunLength = NumericTraits< OffsetValueType >::max();
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      if ( offset[d] != 0 )
+        {
+        const OffsetValueType width = static_cast< OffsetValueType >(
+          std::min( 2 * m_Radius[d], std::max( largestRegion.GetSize(d), SizeValueType(1) ) - 1 ) );
+        maximumRunLength = std::min( maximumRunLength, width / std::abs(offset[d]) + 1 );
+        }
+      }
+
+    std::vector< int > & distanceBins = m_DistanceBins[offsetNumber];
+    distanceBins.assign(maximumRunLength + 1, -1);
+    for ( OffsetValueType length = 1; length <= maximumRunLength; ++length )
+      {
+      IndexType index;
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        index[d] = start[d] + offset[d] * ( length - 1 );
+        }
+      typename ImageType::PointType point;
+      input->TransformIndexToPhysicalPoint(index, point);
+      distance[0] = startPoint.EuclideanDistanceTo(point);
+
+      if ( distance[0] >= m_MinDistance && distance[0] <= m_MaxDistance
+           && distanceBinHistogram->GetIndex(distance, distanceIndex) )
+        {
+        distanceBins[length] = static_cast< int >( distanceIndex[0] );
+        }
+      }
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                       ThreadIdType threadId)
+{
+  const ImageType *input = this->GetInput();
+  OutputImageType *output = this->GetOutput();
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  // Put the pixels of the windows of the region in their bins once
+  RegionType inputRegion = outputRegionForThread;
+  inputRegion.PadByRadius(m_Radius);
+  inputRegion.Crop( input->GetLargestPossibleRegion() );
+
+  typename BinImageType::Pointer cooccurrenceBins = BinImageType::New();
+  cooccurrenceBins->SetRegions(inputRegion);
+  cooccurrenceBins->Allocate();
+  typename BinImageType::Pointer runLengthBins = BinImageType::New();
+  runLengthBins->SetRegions(inputRegion);
+  runLengthBins->Allocate();
+  this->ComputeBins(inputRegion, cooccurrenceBins, runLengthBins);
+
+  // As in MovingHistogramImageFilter, the matrices are kept for each
+  // dimension: the matrices of a dimension are the ones of the window
+  // centered on the current pixel with the indices of the lower dimensions
+  // moved back to the start of the region. The matrices of the first
+  // dimension move along the lines, and the matrices of a dimension move
+  // when a line of that dimension is started.
+  std::vector< WindowMatrices > matrices(ImageDimension);
+  std::vector< IndexType >      centers( ImageDimension, outputRegionForThread.GetIndex() );
+  this->InitializeMatrices(matrices[ImageDimension - 1], this->GetWindow(centers[0]),
+                           cooccurrenceBins, runLengthBins);
+  for ( unsigned int d = 0; d + 1 < ImageDimension; ++d )
+    {
+    matrices[d] = matrices[ImageDimension - 1];
+    }
+
+  OutputPixelType features;
+  NumericTraits< OutputPixelType >::SetLength(features, NumberOfTextureFeatures + NumberOfRunLengthFeatures);
+
+  ImageRegionIteratorWithIndex< OutputImageType > outputIt(output, outputRegionForThread);
+  for ( outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt )
+    {
+    const IndexType index = outputIt.GetIndex();
+
+    unsigned int dimension = ImageDimension;
+    for ( unsigned int d = ImageDimension; d > 0; --d )
+      {
+      if ( index[d - 1] != centers[0][d - 1] )
+        {
+        dimension = d - 1;
+        break;
+        }
+      }
+    if ( dimension < ImageDimension )
+      {
+      this->MoveMatrices(matrices[dimension], centers[dimension], dimension,
+                         cooccurrenceBins, runLengthBins);
+      ++centers[dimension][dimension];
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        matrices[d] = matrices[dimension];
+        centers[d] = centers[dimension];
+        }
+      }
+
+    this->ComputeFeatures(matrices[0], features);
+    outputIt.Set(features);
+    progress.CompletedPixel();
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+typename MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >::RegionType
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::GetWindow(const IndexType & center) const
+{
+  RegionType window;
+  window.SetIndex(center);
+  window.PadByRadius(m_Radius);
+  window.Crop( this->GetInput()->GetLargestPossibleRegion() );
+  return window;
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::ComputeBins(const RegionType & region, BinImageType *cooccurrenceBins,
+              BinImageType *runLengthBins) const
+{
+  typename HistogramType::MeasurementVectorType measurement(1);
+  typename HistogramType::IndexType             binIndex(1);
+
+  ImageRegionConstIterator< ImageType > inputIt(this->GetInput(), region);
+  ImageRegionIterator< BinImageType >   cooccurrenceIt(cooccurrenceBins, region);
+  ImageRegionIterator< BinImageType >   runLengthIt(runLengthBins, region);
+  for (; !inputIt.IsAtEnd(); ++inputIt, ++cooccurrenceIt, ++runLengthIt )
+    {
+    const PixelType value = inputIt.Get();
+    int             cooccurrenceBin = -1;
+    int             runLengthBin = -1;
+    if ( value >= m_Min && value <= m_Max )
+      {
+      measurement[0] = value;
+      if ( m_CooccurrenceBinHistogram->GetIndex(measurement, binIndex) )
+        {
+        cooccurrenceBin = static_cast< int >( binIndex[0] );
+        }
+      if ( m_RunLengthBinHistogram->GetIndex(measurement, binIndex) )
+        {
+        runLengthBin = static_cast< int >( binIndex[0] );
+        }
+      }
+    cooccurrenceIt.Set(cooccurrenceBin);
+    runLengthIt.Set(runLengthBin);
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::InitializeMatrices(WindowMatrices & matrices, const RegionType & window,
+                     const BinImageType *cooccurrenceBins,
+                     const BinImageType *runLengthBins) const
+{
+  const SizeValueType matrixSize = m_NumberOfBinsPerAxis * m_NumberOfBinsPerAxis;
+
+  matrices.Cooccurrence.assign(m_Offsets->Size() * matrixSize, 0);
+  matrices.RunLength.assign(m_Offsets->Size() * matrixSize, 0);
+
+  // all the pixels of the window enter the window
+  this->UpdateCooccurrences(matrices, window, window, cooccurrenceBins, true);
+
+  RegionType emptyWindow = window;
+  RadiusType emptySize;
+  emptySize.Fill(0);
+  emptyWindow.SetSize(emptySize);
+  this->UpdateRuns(matrices, emptyWindow, window, ImageDimension, runLengthBins);
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::MoveMatrices(WindowMatrices & matrices, const IndexType & center, unsigned int dimension,
+               const BinImageType *cooccurrenceBins,
+               const BinImageType *runLengthBins) const
+{
+  IndexType nextCenter = center;
+  ++nextCenter[dimension];
+
+  const RegionType oldWindow = this->GetWindow(center);
+  const RegionType newWindow = this->GetWindow(nextCenter);
+
+  RegionType leavingSlab;
+  RegionType enteringSlab;
+  if ( this->GetMovingSlabs(oldWindow, newWindow, dimension, leavingSlab, enteringSlab) )
+    {
+    this->UpdateCooccurrences(matrices, leavingSlab, oldWindow, cooccurrenceBins, false);
+    }
+  if ( enteringSlab.GetNumberOfPixels() > 0 )
+    {
+    this->UpdateCooccurrences(matrices, enteringSlab, newWindow, cooccurrenceBins, true);
+    }
+
+  this->UpdateRuns(matrices, oldWindow, newWindow, dimension, runLengthBins);
+}
+
+template< typename TImageType, typename TOutputImageType >
+bool
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::GetMovingSlabs(const RegionType & oldWindow, const RegionType & newWindow,
+                 unsigned int dimension, RegionType & leavingSlab,
+                 RegionType & enteringSlab)
+{
+  // The windows are cropped at the image boundaries, so a slab leaves or
+  // enters the window only away from them
+  const IndexValueType oldEnd = oldWindow.GetIndex(dimension)
+                                + static_cast< IndexValueType >( oldWindow.GetSize(dimension) );
+  const IndexValueType newEnd = newWindow.GetIndex(dimension)
+                                + static_cast< IndexValueType >( newWindow.GetSize(dimension) );
+
+  leavingSlab = oldWindow;
+  leavingSlab.SetSize( dimension, ( oldWindow.GetIndex(dimension) < newWindow.GetIndex(dimension) ) ? 1 : 0 );
+
+  enteringSlab = newWindow;
+  enteringSlab.SetIndex(dimension, newEnd - 1);
+  enteringSlab.SetSize( dimension, ( newEnd > oldEnd ) ? 1 : 0 );
+
+  return leavingSlab.GetNumberOfPixels() > 0;
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::UpdateCooccurrences(WindowMatrices & matrices, const RegionType & slab,
+                      const RegionType & window, const BinImageType *bins,
+                      bool add) const
+{
+  const SizeValueType binsPerAxis = m_NumberOfBinsPerAxis;
+
+  // the offsets in the buffer of the bins
+  std::vector< OffsetValueType > strides;
+  typename OffsetVector::ConstIterator offsets;
+  for ( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); offsets++ )
+    {
+    strides.push_back( GetBufferStride( bins, offsets.Value() ) );
+    }
+
+  ImageRegionConstIteratorWithIndex< BinImageType > it(bins, slab);
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const int bin = it.Get();
+    if ( bin < 0 )
+      {
+      continue;
+      }
+    const IndexType index = it.GetIndex();
+    const int *     pixel = &it.Value();
+
+    SizeValueType *matrix = &matrices.Cooccurrence[0];
+    unsigned int   offsetNumber = 0;
+    for ( offsets = m_Offsets->Begin(); offsets != m_Offsets->End();
+          offsets++, offsetNumber++, matrix += binsPerAxis * binsPerAxis )
+      {
+      // Each pair is counted once: from its first pixel if it is in the
+      // slab, from its second pixel otherwise
+      for ( unsigned int side = 0; side < 2; ++side )
+        {
+        const IndexType neighbor = ( side == 0 ) ? index + offsets.Value() : index - offsets.Value();
+        if ( !window.IsInside(neighbor) || ( side == 1 && slab.IsInside(neighbor) ) )
+          {
+          continue;
+          }
+        const int neighborBin = ( side == 0 ) ? pixel[strides[offsetNumber]] : pixel[-strides[offsetNumber]];
+        if ( neighborBin < 0 )
+          {
+          continue;
+          }
+
+        // both possible co-occurrence combinations
+        SizeValueType & frequency = matrix[bin + neighborBin * binsPerAxis];
+        SizeValueType & symmetricFrequency = matrix[neighborBin + bin * binsPerAxis];
+        if ( add )
+          {
+          ++frequency;
+          ++symmetricFrequency;
+          }
+        else
+          {
+          --frequency;
+          --symmetricFrequency;
+          }
+        }
+      }
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::UpdateRuns(WindowMatrices & matrices, const RegionType & oldWindow,
+             const RegionType & newWindow, unsigned int dimension,
+             const BinImageType *bins) const
+{
+  const SizeValueType binsPerAxis = m_NumberOfBinsPerAxis;
+
+  RegionType leavingSlab;
+  RegionType enteringSlab;
+  if ( dimension < ImageDimension )
+    {
+    this->GetMovingSlabs(oldWindow, newWindow, dimension, leavingSlab, enteringSlab);
+    }
+
+  typename OffsetVector::ConstIterator offsets;
+  unsigned int offsetNumber = 0;
+  for ( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); offsets++, offsetNumber++ )
+    {
+    const OffsetType      offset = offsets.Value();
+    const OffsetValueType stride = GetBufferStride(bins, offset);
+    SizeValueType *       matrix = &matrices.RunLength[offsetNumber * binsPerAxis * binsPerAxis];
+
+    // Only the lines crossing the slabs leaving and entering the window
+    // change. When the window does not move, the lines are the ones
+    // starting in the new window.
+    RegionType slabs[2] = { leavingSlab, enteringSlab };
+    if ( dimension == ImageDimension )
+      {
+      slabs[0] = newWindow;
+      }
+    for ( unsigned int s = 0; s < 2; ++s )
+      {
+      ImageRegionConstIteratorWithIndex< BinImageType > it(bins, slabs[s]);
+      for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+        {
+        const IndexType index = it.GetIndex();
+        if ( dimension == ImageDimension || offset[dimension] == 0 )
+          {
+          // the line is in the slab: start it at its first pixel in the slab
+          if ( slabs[s].IsInside(index - offset) )
+            {
+            continue;
+            }
+          }
+        else if ( s == 1 && leavingSlab.GetNumberOfPixels() > 0 )
+          {
+          // the line crosses the slabs once: skip it if it crossed the
+          // leaving slab
+          const OffsetValueType shift = leavingSlab.GetIndex(dimension) - index[dimension];
+          if ( shift % offset[dimension] == 0 )
+            {
+            IndexType crossing;
+            for ( unsigned int d = 0; d < ImageDimension; ++d )
+              {
+              crossing[d] = index[d] + offset[d] * ( shift / offset[dimension] );
+              }
+            if ( leavingSlab.IsInside(crossing) )
+              {
+              continue;
+              }
+            }
+          }
+        this->UpdateRunsOfLine(matrix, m_DistanceBins[offsetNumber], &it.Value(), stride,
+                               index, offset, oldWindow, newWindow);
+        }
+      }
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::UpdateRunsOfLine(SizeValueType *matrix, const std::vector< int > & distanceBins,
+                   const int *line, OffsetValueType stride, const IndexType & index,
+                   const OffsetType & offset, const RegionType & oldWindow,
+                   const RegionType & newWindow) const
+{
+  OffsetValueType oldFirst;
+  OffsetValueType oldLast;
+  OffsetValueType newFirst;
+  OffsetValueType newLast;
+  GetLineRange(index, offset, oldWindow, oldFirst, oldLast);
+  GetLineRange(index, offset, newWindow, newFirst, newLast);
+  const bool oldEmpty = oldFirst > oldLast;
+  const bool newEmpty = newFirst > newLast;
+  if ( ( oldEmpty && newEmpty ) || ( oldFirst == newFirst && oldLast == newLast ) )
+    {
+    return;
+    }
+
+  // Only the runs of the line before its first change of bin and after its
+  // last change of bin in the part common to both windows may be different
+  const OffsetValueType first = std::max(oldFirst, newFirst);
+  const OffsetValueType last = std::min(oldLast, newLast);
+  OffsetValueType       firstChange = last + 1;
+  OffsetValueType       lastChange = first;
+  if ( !oldEmpty && !newEmpty && first <= last )
+    {
+    if ( oldFirst != newFirst )
+      {
+      for ( OffsetValueType t = first + 1; t <= last; ++t )
+        {
+        if ( line[t * stride] != line[( t - 1 ) * stride] )
+          {
+          firstChange = t;
+          break;
+          }
+        }
+      }
+    if ( oldLast != newLast )
+      {
+      for ( OffsetValueType t = last; t > first; --t )
+        {
+        if ( line[t * stride] != line[( t - 1 ) * stride] )
+          {
+          lastChange = t;
+          break;
+          }
+        }
+      }
+    }
+
+  if ( oldEmpty || newEmpty || first > last
+       || ( oldFirst != newFirst && firstChange > last )
+       || ( oldLast != newLast && lastChange <= first ) )
+    {
+    // all the runs may be different
+    if ( !oldEmpty )
+      {
+      this->UpdateRunsOfSegment(matrix, distanceBins, line, stride, oldFirst, oldLast, false);
+      }
+    if ( !newEmpty )
+      {
+      this->UpdateRunsOfSegment(matrix, distanceBins, line, stride, newFirst, newLast, true);
+      }
+    return;
+    }
+  if ( oldFirst != newFirst )
+    {
+    this->UpdateRunsOfSegment(matrix, distanceBins, line, stride, oldFirst, firstChange - 1, false);
+    this->UpdateRunsOfSegment(matrix, distanceBins, line, stride, newFirst, firstChange - 1, true);
+    }
+  if ( oldLast != newLast )
+    {
+    this->UpdateRunsOfSegment(matrix, distanceBins, line, stride, lastChange, oldLast, false);
+    this->UpdateRunsOfSegment(matrix, distanceBins, line, stride, lastChange, newLast, true);
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::GetLineRange(const IndexType & index, const OffsetType & offset,
+               const RegionType & region, OffsetValueType & first,
+               OffsetValueType & last)
+{
+  first = NumericTraits< OffsetValueType >::NonpositiveMin();
+  last = NumericTraits< OffsetValueType >::max();
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    const OffsetValueType lower = region.GetIndex(d) - index[d];
+    const OffsetValueType upper = lower + static_cast< OffsetValueType >( region.GetSize(d) ) - 1;
+    if ( upper < lower )
+      {
+      first = 1;
+      last = 0;
+      return;
+      }
+    if ( offset[d] == 0 )
+      {
+      if ( lower > 0 || upper < 0 )
+        {
+        first = 1;
+        last = 0;
+        return;
+        }
+      continue;
+      }
+
+    // the positions t with lower <= t * offset[d] <= upper
+    const OffsetValueType low = ( offset[d] > 0 ) ? lower : upper;
+    const OffsetValueType high = ( offset[d] > 0 ) ? upper : lower;
+    const OffsetValueType step = offset[d];
+    OffsetValueType       tLow = low / step;
+    if ( tLow * step != low && ( ( low < 0 ) == ( step < 0 ) ) )
+      {
+      ++tLow;
+      }
+    OffsetValueType tHigh = high / step;
+    if ( tHigh * step != high && ( ( high < 0 ) != ( step < 0 ) ) )
+      {
+      --tHigh;
+      }
+    first = std::max(first, tLow);
+    last = std::min(last, tHigh);
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::UpdateRunsOfSegment(SizeValueType *matrix, const std::vector< int > & distanceBins,
+                      const int *line, OffsetValueType stride, OffsetValueType first,
+                      OffsetValueType last, bool add) const
+{
+  const SizeValueType binsPerAxis = m_NumberOfBinsPerAxis;
+
+  OffsetValueType t = first;
+  while ( t <= last )
+    {
+    // follow the run of the bin of the pixel t
+    const int             runBin = line[t * stride];
+    const OffsetValueType runFirst = t;
+    for ( ++t; t <= last && line[t * stride] == runBin; ++t )
+      {
+      }
+    if ( runBin < 0 )
+      {
+      continue;
+      }
+    const int distanceBin = distanceBins[t - runFirst];
+    if ( distanceBin < 0 )
+      {
+      continue;
+      }
+    if ( add )
+      {
+      ++matrix[runBin + distanceBin * binsPerAxis];
+      }
+    else
+      {
+      --matrix[runBin + distanceBin * binsPerAxis];
+      }
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::ComputeFeatures(const WindowMatrices & matrices, OutputPixelType & features) const
+{
+  typedef typename NumericTraits< OutputPixelType >::ValueType OutputValueType;
+
+  const SizeValueType matrixSize = m_NumberOfBinsPerAxis * m_NumberOfBinsPerAxis;
+
+  double       textureSums[NumberOfTextureFeatures];
+  double       runLengthSums[NumberOfRunLengthFeatures];
+  double       textureFeatures[NumberOfTextureFeatures];
+  double       runLengthFeatures[NumberOfRunLengthFeatures];
+  unsigned int numberOfTextureMatrices = 0;
+  unsigned int numberOfRunLengthMatrices = 0;
+  std::fill(textureSums, textureSums + NumberOfTextureFeatures, 0.0);
+  std::fill(runLengthSums, runLengthSums + NumberOfRunLengthFeatures, 0.0);
+
+  for ( SizeValueType offsetNumber = 0; offsetNumber < m_Offsets->Size(); ++offsetNumber )
+    {
+    if ( this->ComputeTextureFeatures(&matrices.Cooccurrence[offsetNumber * matrixSize], textureFeatures) )
+      {
+      for ( unsigned int i = 0; i < NumberOfTextureFeatures; ++i )
+        {
+        textureSums[i] += textureFeatures[i];
+        }
+      ++numberOfTextureMatrices;
+      }
+    if ( this->ComputeRunLengthFeatures(&matrices.RunLength[offsetNumber * matrixSize], runLengthFeatures) )
+      {
+      for ( unsigned int i = 0; i < NumberOfRunLengthFeatures; ++i )
+        {
+        runLengthSums[i] += runLengthFeatures[i];
+        }
+      ++numberOfRunLengthMatrices;
+      }
+    }
+
+  for ( unsigned int i = 0; i < NumberOfTextureFeatures; ++i )
+    {
+    features[i] = static_cast< OutputValueType >( numberOfTextureMatrices > 0
+                                                  ? textureSums[i] / numberOfTextureMatrices : 0.0 );
+    }
+  for ( unsigned int i = 0; i < NumberOfRunLengthFeatures; ++i )
+    {
+    features[NumberOfTextureFeatures + i] =
+      static_cast< OutputValueType >( numberOfRunLengthMatrices > 0
+                                      ? runLengthSums[i] / numberOfRunLengthMatrices : 0.0 );
+    }
+}
+
+template< typename TImageType, typename TOutputImageType >
+bool
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::ComputeTextureFeatures(const SizeValueType *matrix, double *features) const
+{
+  const IndexValueType binsPerAxis = m_NumberOfBinsPerAxis;
+  const SizeValueType  matrixSize = m_NumberOfBinsPerAxis * m_NumberOfBinsPerAxis;
+
+  SizeValueType total = 0;
+  for ( SizeValueType id = 0; id < matrixSize; ++id )
+    {
+    total += matrix[id];
+    }
+  if ( total == 0 )
+    {
+    return false;
+    }
+  const double totalFrequency = static_cast< double >( total );
+
+  // The means and variances, as in HistogramToTextureFeaturesFilter
+  std::vector< double > marginalSums(binsPerAxis, 0.0);
+  double                pixelMean = 0;
+  for ( IndexValueType j = 0; j < binsPerAxis; ++j )
+    {
+    for ( IndexValueType i = 0; i < binsPerAxis; ++i )
+      {
+      const double frequency = matrix[i + j * binsPerAxis] / totalFrequency;
+      pixelMean += i * frequency;
+      marginalSums[i] += frequency;
+      }
+    }
+
+  double marginalMean = marginalSums[0];
+  double marginalDevSquared = 0;
+  for ( IndexValueType arrayIndex = 1; arrayIndex < binsPerAxis; arrayIndex++ )
+    {
+    const int    k = arrayIndex + 1;
+    const double M_k_minus_1 = marginalMean;
+    const double x_k = marginalSums[arrayIndex];
+    const double M_k = M_k_minus_1 + ( x_k - M_k_minus_1 ) / k;
+    marginalDevSquared += ( x_k - M_k_minus_1 ) * ( x_k - M_k );
+    marginalMean = M_k;
+    }
+  marginalDevSquared = marginalDevSquared / binsPerAxis;
+
+  double pixelVariance = 0;
+  for ( IndexValueType j = 0; j < binsPerAxis; ++j )
+    {
+    for ( IndexValueType i = 0; i < binsPerAxis; ++i )
+      {
+      const double frequency = matrix[i + j * binsPerAxis] / totalFrequency;
+      pixelVariance += ( i - pixelMean ) * ( i - pixelMean ) * frequency;
+      }
+    }
+
+  double energy = 0;
+  double entropy = 0;
+  double correlation = 0;
+  double inverseDifferenceMoment = 0;
+  double inertia = 0;
+  double clusterShade = 0;
+  double clusterProminence = 0;
+  double haralickCorrelation = 0;
+
+  double pixelVarianceSquared = pixelVariance * pixelVariance;
+  if ( Math::FloatAlmostEqual( pixelVarianceSquared, 0.0, 4, 2 * NumericTraits< double >::epsilon() ) )
+    {
+    pixelVarianceSquared = 1.;
+    }
+  const double log2 = std::log(2.0);
+
+  for ( IndexValueType j = 0; j < binsPerAxis; ++j )
+    {
+    for ( IndexValueType i = 0; i < binsPerAxis; ++i )
+      {
+      const double frequency = matrix[i + j * binsPerAxis] / totalFrequency;
+      if ( Math::AlmostEquals( frequency, 0.0 ) )
+        {
+        continue;
+        }
+      energy += frequency * frequency;
+      entropy -= ( frequency > 0.0001 ) ? frequency * std::log(frequency) / log2 : 0;
+      correlation += ( ( i - pixelMean ) * ( j - pixelMean ) * frequency ) / pixelVarianceSquared;
+      inverseDifferenceMoment += frequency / ( 1.0 + ( i - j ) * ( i - j ) );
+      inertia += ( i - j ) * ( i - j ) * frequency;
+      const double deviationSum = ( i - pixelMean ) + ( j - pixelMean );
+      clusterShade += deviationSum * deviationSum * deviationSum * frequency;
+      clusterProminence += deviationSum * deviationSum * deviationSum * deviationSum * frequency;
+      haralickCorrelation += i * j * frequency;
+      }
+    }
+  haralickCorrelation = ( haralickCorrelation - marginalMean * marginalMean ) / marginalDevSquared;
+
+  features[0] = energy;
+  features[1] = entropy;
+  features[2] = correlation;
+  features[3] = inverseDifferenceMoment;
+  features[4] = inertia;
+  features[5] = clusterShade;
+  features[6] = clusterProminence;
+  features[7] = haralickCorrelation;
+  return true;
+}
+
+template< typename TImageType, typename TOutputImageType >
+bool
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::ComputeRunLengthFeatures(const SizeValueType *matrix, double *features) const
+{
+  const IndexValueType binsPerAxis = m_NumberOfBinsPerAxis;
+
+  // As in HistogramToRunLengthFeaturesFilter
+  std::vector< double > greyLevelNonuniformityVector(binsPerAxis, 0.0);
+  std::vector< double > runLengthNonuniformityVector(binsPerAxis, 0.0);
+  std::fill(features, features + NumberOfRunLengthFeatures, 0.0);
+
+  SizeValueType totalNumberOfRuns = 0;
+  for ( IndexValueType j = 0; j < binsPerAxis; ++j )
+    {
+    for ( IndexValueType i = 0; i < binsPerAxis; ++i )
+      {
+      const SizeValueType runs = matrix[i + j * binsPerAxis];
+      if ( runs == 0 )
+        {
+        continue;
+        }
+      totalNumberOfRuns += runs;
+
+      const double frequency = static_cast< double >( runs );
+      const double i2 = static_cast< double >( ( i + 1 ) * ( i + 1 ) );
+      const double j2 = static_cast< double >( ( j + 1 ) * ( j + 1 ) );
+
+      // Traditional measures
+      features[0] += frequency / j2;
+      features[1] += frequency * j2;
+
+      greyLevelNonuniformityVector[i] += frequency;
+      runLengthNonuniformityVector[j] += frequency;
+
+      // measures from Chu et al.
+      features[4] += frequency / i2;
+      features[5] += frequency * i2;
+
+      // measures from Dasarathy and Holder
+      features[6] += frequency / ( i2 * j2 );
+      features[7] += frequency * i2 / j2;
+      features[8] += frequency * j2 / i2;
+      features[9] += frequency * i2 * j2;
+      }
+    }
+  if ( totalNumberOfRuns == 0 )
+    {
+    return false;
+    }
+  for ( IndexValueType i = 0; i < binsPerAxis; ++i )
+    {
+    features[2] += greyLevelNonuniformityVector[i] * greyLevelNonuniformityVector[i];
+    features[3] += runLengthNonuniformityVector[i] * runLengthNonuniformityVector[i];
+    }
+
+  // Normalize all measures by the total number of runs
+  for ( unsigned int f = 0; f < NumberOfRunLengthFeatures; ++f )
+    {
+    features[f] /= static_cast< double >( totalNumberOfRuns );
+    }
+  return true;
+}
+
+template< typename TImageType, typename TOutputImageType >
+void
+MovingTextureFeaturesImageFilter< TImageType, TOutputImageType >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Radius: " << m_Radius << std::endl;
+  os << indent << "Offsets: ";
+  if ( m_Offsets.IsNotNull() )
+    {
+    for ( typename OffsetVector::ConstIterator offsets = m_Offsets->Begin();
+          offsets != m_Offsets->End(); offsets++ )
+      {
+      os << offsets.Value() << " ";
+      }
+    }
+  os << std::endl;
+  os << indent << "NumberOfBinsPerAxis: " << m_NumberOfBinsPerAxis << std::endl;
+  os << indent << "Min: " << static_cast< typename NumericTraits< PixelType >::PrintType >( m_Min ) << std::endl;
+  os << indent << "Max: " << static_cast< typename NumericTraits< PixelType >::PrintType >( m_Max ) << std::endl;
+  os << indent << "MinDistance: " << m_MinDistance << std::endl;
+  os << indent << "MaxDistance: " << m_MaxDistance << std::endl;
+}
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
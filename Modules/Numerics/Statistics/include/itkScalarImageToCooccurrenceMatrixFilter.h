@@ -20,6 +20,7 @@
 
 #include "itkImage.h"
 #include "itkHistogram.h"
+#include "itkHistogramAccumulator.h"
 #include "itkVectorContainer.h"
 #include "itkNumericTraits.h"
 
@@ -68,6 +69,11 @@ namespace Statistics
  * for a given image, the max and min pixel values that will be placed in the
  * histogram can be set manually. NB: The min and max are INCLUSIVE.
  *
+ * The requested region is split in slabs filled by several threads, each
+ * thread increasing the frequencies of the bins in a storage of its own
+ * (see HistogramAccumulator), which are summed in the histogram at the end.
+ * The histogram does not depend on the number of threads.
+ *
  * Further, the type of histogram frequency container used is an optional template
  * parameter. By default, a dense container is used, but for images with little
  * texture or in cases where the user wants more histogram bins, a sparse container
@@ -174,9 +180,21 @@ protected:
   virtual ~ScalarImageToCooccurrenceMatrixFilter() {}
   virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
-  virtual void FillHistogram(RadiusType radius, RegionType region);
+  /** Fill the histogram with the co-occurrence pairs of a region, for
+   * one of the threads. The frequencies are increased in the storage of
+   * the thread of the accumulator. */
+  virtual void FillHistogram(RadiusType radius, RegionType region, ThreadIdType threadId);
+
+  virtual void FillHistogramWithMask(RadiusType radius, RegionType region, const ImageType *maskImage,
+                                     ThreadIdType threadId);
+
+  typedef HistogramAccumulator< HistogramType > AccumulatorType;
 
-  virtual void FillHistogramWithMask(RadiusType radius, RegionType region, const ImageType *maskImage);
+  /** Get the accumulator of the frequencies of the threads. */
+  AccumulatorType * GetAccumulator()
+  {
+    return m_Accumulator.GetPointer();
+  }
 
   /** Standard itk::ProcessObject subclass method. */
   typedef DataObject::Pointer DataObjectPointer;
@@ -197,6 +215,17 @@ private:
 
   void NormalizeHistogram();
 
+  /** Static callback of the threads filling the histogram with a slab of
+   * the requested region. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  struct ThreadStruct {
+    Self *Filter;
+    RadiusType Radius;
+    const ImageType *MaskImage;
+    std::vector< RegionType > Pieces;
+  };
+
   OffsetVectorConstPointer m_Offsets;
   PixelType                m_Min;
   PixelType                m_Max;
@@ -207,6 +236,8 @@ private:
   bool                  m_Normalize;
 
   PixelType m_InsidePixelValue;
+
+  typename AccumulatorType::Pointer m_Accumulator;
 };
 } // end of namespace Statistics
 } // end of namespace itk
@@ -21,6 +21,7 @@
 #include "itkScalarImageToCooccurrenceMatrixFilter.h"
 
 #include "itkConstNeighborhoodIterator.h"
+#include "itkImageRegionSplitterSlowDimension.h"
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -58,6 +59,8 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
 
   this->m_NumberOfBinsPerAxis = DefaultBinsPerAxis;
   this->m_Normalize = false;
+
+  this->m_Accumulator = AccumulatorType::New();
 }
 
 template< typename TImageType, typename THistogramFrequencyContainer >
@@ -182,16 +185,32 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
     maskImage = this->GetMaskImage();
     }
 
-  // Now fill in the histogram
-  if ( maskImage != ITK_NULLPTR )
-    {
-    this->FillHistogramWithMask(radius, input->GetRequestedRegion(), maskImage);
-    }
-  else
+  // Now fill in the histogram, each thread with a slab of the requested
+  // region
+  ThreadStruct str;
+  str.Filter = this;
+  str.Radius = radius;
+  str.MaskImage = maskImage;
+
+  typedef ImageRegionSplitterSlowDimension SplitterType;
+  SplitterType::Pointer splitter = SplitterType::New();
+  const unsigned int numberOfPieces =
+    splitter->GetNumberOfSplits( input->GetRequestedRegion(), this->GetNumberOfThreads() );
+  str.Pieces.resize( numberOfPieces, input->GetRequestedRegion() );
+  for ( unsigned int i = 0; i < numberOfPieces; ++i )
     {
-    this->FillHistogram( radius, input->GetRequestedRegion() );
+    splitter->GetSplit(i, numberOfPieces, str.Pieces[i]);
     }
 
+  m_Accumulator->SetNumberOfThreads( this->GetNumberOfThreads() );
+  m_Accumulator->Initialize(output, numberOfPieces);
+
+  this->GetMultiThreader()->SetNumberOfThreads(numberOfPieces);
+  this->GetMultiThreader()->SetSingleMethod(Self::ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  m_Accumulator->AddToHistogram(output);
+
   // Normalizse the histogram if requested
   if ( m_Normalize )
     {
@@ -199,11 +218,36 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
     }
 }
 
+template< typename TImageType, typename THistogramFrequencyContainer >
+ITK_THREAD_RETURN_TYPE
+ScalarImageToCooccurrenceMatrixFilter< TImageType,
+                                       THistogramFrequencyContainer >::ThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+  if ( info->ThreadID < str->Pieces.size() )
+    {
+    if ( str->MaskImage != ITK_NULLPTR )
+      {
+      str->Filter->FillHistogramWithMask(str->Radius, str->Pieces[info->ThreadID], str->MaskImage,
+                                         info->ThreadID);
+      }
+    else
+      {
+      str->Filter->FillHistogram(str->Radius, str->Pieces[info->ThreadID], info->ThreadID);
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< typename TImageType, typename THistogramFrequencyContainer >
 void
 ScalarImageToCooccurrenceMatrixFilter< TImageType,
                                        THistogramFrequencyContainer >::FillHistogram(RadiusType radius,
-                                                                                     RegionType region)
+                                                                                     RegionType region,
+                                                                                     ThreadIdType threadId)
 {
   // Iterate over all of those pixels and offsets, adding each
   // co-occurrence pair to the histogram
@@ -255,12 +299,12 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
       cooccur[0] = centerPixelIntensity;
       cooccur[1] = pixelIntensity;
       output->GetIndex( cooccur, index );
-      output->IncreaseFrequencyOfIndex( index, 1 );
+      m_Accumulator->IncreaseFrequencyOfIndex( threadId, index, 1 );
 
       cooccur[1] = centerPixelIntensity;
       cooccur[0] = pixelIntensity;
       output->GetIndex( cooccur, index );
-      output->IncreaseFrequencyOfIndex( index, 1 );
+      m_Accumulator->IncreaseFrequencyOfIndex( threadId, index, 1 );
       }
     }
 }
@@ -270,7 +314,8 @@ void
 ScalarImageToCooccurrenceMatrixFilter< TImageType,
                                        THistogramFrequencyContainer >::FillHistogramWithMask(RadiusType radius,
                                                                                              RegionType region,
-                                                                                             const ImageType *maskImage)
+                                                                                             const ImageType *maskImage,
+                                                                                             ThreadIdType threadId)
 {
   // Iterate over all of those pixels and offsets, adding each
   // co-occurrence pair to the histogram
@@ -336,13 +381,13 @@ ScalarImageToCooccurrenceMatrixFilter< TImageType,
       cooccur[0] = centerPixelIntensity;
       cooccur[1] = pixelIntensity;
       output->GetIndex( cooccur, index );
-      output->IncreaseFrequencyOfIndex(index, 1);
+      m_Accumulator->IncreaseFrequencyOfIndex(threadId, index, 1);
 
 
       cooccur[1] = centerPixelIntensity;
       cooccur[0] = pixelIntensity;
       output->GetIndex( cooccur, index );
-      output->IncreaseFrequencyOfIndex(index, 1);
+      m_Accumulator->IncreaseFrequencyOfIndex(threadId, index, 1);
       }
     }
 }
@@ -105,6 +105,9 @@ void
 ScalarImageToRunLengthFeaturesFilter<TImage, THistogramFrequencyContainer>
 ::GenerateData(void)
 {
+  // the run length matrices are computed with the threads of this filter
+  this->m_RunLengthMatrixGenerator->SetNumberOfThreads( this->GetNumberOfThreads() );
+
   if ( this->m_FastCalculations )
     {
     this->FastCompute();
@@ -20,6 +20,7 @@
 
 #include "itkImage.h"
 #include "itkHistogram.h"
+#include "itkHistogramAccumulator.h"
 #include "itkNumericTraits.h"
 #include "itkVectorContainer.h"
 
@@ -79,6 +80,11 @@ namespace Statistics
  * for a given image, the max and min pixel values that will be placed in the
  * histogram can be set manually. NB: The min and max are INCLUSIVE.
  *
+ * The offsets are shared among several threads, each thread increasing the
+ * frequencies of the bins in a storage of its own (see HistogramAccumulator),
+ * which are summed in the histogram at the end. The histogram does not
+ * depend on the number of threads.
+ *
  * Further, the type of histogram frequency container used is an optional
  * template parameter. By default, a dense container is used, but for images
  * with little texture or in cases where the user wants more histogram bins,
@@ -254,8 +260,20 @@ protected:
    * */
   void NormalizeOffsetDirection(OffsetType &offset);
 
+  /**
+   * Fill the histogram with the runs along the offsets of a thread: the
+   * offsets are shared among the threads in turn. The frequencies are
+   * increased in the storage of the thread of the accumulator.
+   */
+  virtual void ThreadedFillHistogram( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  typedef HistogramAccumulator<HistogramType> AccumulatorType;
+
 private:
 
+  /** Static callback of the threads filling the histogram. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void *arg );
+
   unsigned int             m_NumberOfBinsPerAxis;
   PixelType                m_Min;
   PixelType                m_Max;
@@ -267,6 +285,7 @@ private:
   MeasurementVectorType    m_UpperBound;
   OffsetVectorPointer      m_Offsets;
 
+  typename AccumulatorType::Pointer m_Accumulator;
 };
 } // end of namespace Statistics
 } // end of namespace itk
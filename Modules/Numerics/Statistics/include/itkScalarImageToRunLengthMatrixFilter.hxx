@@ -57,6 +57,8 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
   this->m_LowerBound[1] = this->m_MinDistance;
   this->m_UpperBound[0] = this->m_Max;
   this->m_UpperBound[1] = this->m_MaxDistance;
+
+  this->m_Accumulator = AccumulatorType::New();
 }
 
 template<typename TImageType, typename THistogramFrequencyContainer>
@@ -139,9 +141,6 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
   HistogramType *output =
     static_cast<HistogramType *>( this->ProcessObject::GetOutput( 0 ) );
 
-  const ImageType * inputImage = this->GetInput();
-
-
   // First, create an appropriate histogram with the right number of bins
   // and mins and maxes correct for the image type.
   typename HistogramType::SizeType size( output->GetMeasurementVectorSize() );
@@ -153,6 +152,51 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
   this->m_UpperBound[1] = this->m_MaxDistance;
   output->Initialize( size, this->m_LowerBound, this->m_UpperBound );
 
+  // Each thread fills the histogram with the runs along some of the
+  // offsets, with an image of the visited pixels of its own
+  ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  if( numberOfThreads > this->GetOffsets()->Size() )
+    {
+    numberOfThreads = static_cast<ThreadIdType>( this->GetOffsets()->Size() );
+    }
+  if( numberOfThreads < 1 )
+    {
+    numberOfThreads = 1;
+    }
+
+  this->m_Accumulator->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->m_Accumulator->Initialize( output, numberOfThreads );
+
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( Self::ThreaderCallback, this );
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  this->m_Accumulator->AddToHistogram( output );
+}
+
+template<typename TImageType, typename THistogramFrequencyContainer>
+ITK_THREAD_RETURN_TYPE
+ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
+::ThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self *filter = static_cast<Self *>( info->UserData );
+
+  filter->ThreadedFillHistogram( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<typename TImageType, typename THistogramFrequencyContainer>
+void
+ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
+::ThreadedFillHistogram( ThreadIdType threadId, ThreadIdType numberOfThreads )
+{
+  const HistogramType *output = this->GetOutput();
+
+  const ImageType * inputImage = this->GetInput();
+
   MeasurementVectorType run( output->GetMeasurementVectorSize() );
   typename HistogramType::IndexType hIndex;
 
@@ -175,10 +219,17 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
   alreadyVisitedImage->SetRegions( inputImage->GetRequestedRegion() );
   alreadyVisitedImage->Allocate();
 
+  // The runs along an offset depend on the order of the visits of the
+  // pixels, so each offset is processed by one thread
   typename OffsetVector::ConstIterator offsets;
+  ThreadIdType offsetNumber = 0;
   for( offsets = this->GetOffsets()->Begin();
-    offsets != this->GetOffsets()->End(); offsets++ )
+    offsets != this->GetOffsets()->End(); offsets++, offsetNumber++ )
     {
+    if( offsetNumber % numberOfThreads != threadId )
+      {
+      continue;
+      }
 
     alreadyVisitedImage->FillBuffer( false );
 
@@ -273,7 +324,7 @@ ScalarImageToRunLengthMatrixFilter<TImageType, THistogramFrequencyContainer>
       if( run[1] >= this->m_MinDistance && run[1] <= this->m_MaxDistance )
         {
         output->GetIndex( run, hIndex );
-        output->IncreaseFrequencyOfIndex( hIndex, 1 );
+        this->m_Accumulator->IncreaseFrequencyOfIndex( threadId, hIndex, 1 );
 
         itkDebugStatement(typename HistogramType::IndexType tempMeasurementIndex;)
         itkDebugStatement(output->GetIndex(run,tempMeasurementIndex);)
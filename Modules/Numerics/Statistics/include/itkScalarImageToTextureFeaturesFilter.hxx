@@ -90,6 +90,9 @@ template< typename TImage, typename THistogramFrequencyContainer >
 void
 ScalarImageToTextureFeaturesFilter< TImage, THistogramFrequencyContainer >::GenerateData(void)
 {
+  // the co-occurrence matrices are computed with the threads of this filter
+  this->m_GLCMGenerator->SetNumberOfThreads( this->GetNumberOfThreads() );
+
   if ( m_FastCalculations )
     {
     this->FastCompute();
@@ -89,7 +89,9 @@ public:
   InstanceIdentifier Size() const ITK_OVERRIDE;
 
   /** returns the measurement vector that is specified by the instance
-   * identifier argument. */
+   * identifier argument. The reference is to the element of the vector
+   * container, so that several threads may read measurement vectors at
+   * the same time. */
   const MeasurementVectorType & GetMeasurementVector( InstanceIdentifier ) const ITK_OVERRIDE;
 
   /** returns 1 as other subclasses of ListSampleBase does */
@@ -259,9 +261,6 @@ private:
   /** the points container which will be actually used for storing
    * measurement vectors */
   VectorContainerConstPointer  m_VectorContainer;
-
-  /** temporary points for conversions */
-  mutable typename VectorContainerType::Element m_TempPoint;
 };  // end of class VectorContainerToListSampleAdaptor
 } // end of namespace Statistics
 } // end of namespace itk
@@ -108,10 +108,6 @@ protected:
 private:
   WeightedCentroidKdTreeGenerator(const Self &); //purposely not implemented
   void operator=(const Self &);                  //purposely not implemented
-
-  MeasurementVectorType m_TempLowerBound;
-  MeasurementVectorType m_TempUpperBound;
-  MeasurementVectorType m_TempMean;
 };  // end of class
 } // end of namespace Statistics
 } // end of namespace itk
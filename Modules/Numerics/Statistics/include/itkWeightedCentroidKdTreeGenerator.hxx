@@ -82,16 +82,26 @@ WeightedCentroidKdTreeGenerator< TSample >
       }
     }
 
-  // find most widely spread dimension
+  // find most widely spread dimension, with temporary vectors of the
+  // calling thread
+  MeasurementVectorType tempLowerBound;
+  NumericTraits<MeasurementVectorType>::SetLength( tempLowerBound,
+    this->GetMeasurementVectorSize() );
+  MeasurementVectorType tempUpperBound;
+  NumericTraits<MeasurementVectorType>::SetLength( tempUpperBound,
+    this->GetMeasurementVectorSize() );
+  MeasurementVectorType tempMean;
+  NumericTraits<MeasurementVectorType>::SetLength( tempMean,
+    this->GetMeasurementVectorSize() );
   Algorithm::FindSampleBoundAndMean< SubsampleType >(this->GetSubsample(),
                                                      beginIndex, endIndex,
-                                                     m_TempLowerBound, m_TempUpperBound,
-                                                     m_TempMean);
+                                                     tempLowerBound, tempUpperBound,
+                                                     tempMean);
 
   maxSpread = NumericTraits< MeasurementType >::NonpositiveMin();
   for ( i = 0; i < this->GetMeasurementVectorSize(); i++ )
     {
-    spread = m_TempUpperBound[i] - m_TempLowerBound[i];
+    spread = tempUpperBound[i] - tempLowerBound[i];
     if ( spread >= maxSpread )
       {
       maxSpread = spread;
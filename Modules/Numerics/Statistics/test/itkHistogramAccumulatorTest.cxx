@@ -0,0 +1,323 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkHistogramAccumulator.h"
+#include "itkImageToHistogramFilter.h"
+#include "itkMaskedImageToHistogramFilter.h"
+#include "itkScalarImageToCooccurrenceMatrixFilter.h"
+#include "itkScalarImageToRunLengthMatrixFilter.h"
+#include "itkSparseFrequencyContainer2.h"
+#include "itkShiftScaleImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Accumulate the frequencies of histograms with several threads, in dense
+ * arrays and in maps, and compute histograms of an image with one thread
+ * and with several threads: ImageToHistogramFilter and
+ * MaskedImageToHistogramFilter, also with a streamed input, and the
+ * co-occurrence and run length matrices. The histograms must be identical.
+ */
+
+namespace
+{
+const unsigned int Dimension = 3;
+typedef itk::Image< short, Dimension >         ImageType;
+typedef itk::Image< unsigned char, Dimension > MaskImageType;
+
+template< typename THistogram >
+bool HistogramAccumulatorTestCompare( const THistogram * histogram1, const THistogram * histogram2,
+                                      const char * name )
+{
+  if( histogram1->Size() != histogram2->Size()
+      || histogram1->GetTotalFrequency() != histogram2->GetTotalFrequency() )
+    {
+    std::cerr << name << ": " << histogram2->Size() << " bins and total frequency "
+              << histogram2->GetTotalFrequency() << " instead of " << histogram1->Size()
+              << " bins and total frequency " << histogram1->GetTotalFrequency() << std::endl;
+    return false;
+    }
+  for( unsigned int d = 0; d < histogram1->GetMeasurementVectorSize(); ++d )
+    {
+    if( histogram1->GetBinMin( d, 0 ) != histogram2->GetBinMin( d, 0 )
+        || histogram1->GetBinMax( d, histogram1->GetSize( d ) - 1 )
+           != histogram2->GetBinMax( d, histogram2->GetSize( d ) - 1 ) )
+      {
+      std::cerr << name << ": different bounds of the bins" << std::endl;
+      return false;
+      }
+    }
+  for( typename THistogram::InstanceIdentifier id = 0; id < histogram1->Size(); ++id )
+    {
+    if( histogram1->GetFrequency( id ) != histogram2->GetFrequency( id ) )
+      {
+      std::cerr << name << ": frequency " << histogram2->GetFrequency( id ) << " instead of "
+                << histogram1->GetFrequency( id ) << " in bin " << id << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< typename THistogram >
+bool HistogramAccumulatorTestAccumulate( itk::SizeValueType maximumNumberOfDenseBins )
+{
+  typedef itk::Statistics::HistogramAccumulator< THistogram > AccumulatorType;
+
+  typename THistogram::SizeType size( 2 );
+  size[0] = 13;
+  size[1] = 7;
+  typename THistogram::MeasurementVectorType lowerBound( 2 );
+  typename THistogram::MeasurementVectorType upperBound( 2 );
+  lowerBound.Fill( 0 );
+  upperBound.Fill( 100 );
+
+  typename THistogram::Pointer expected = THistogram::New();
+  expected->SetMeasurementVectorSize( 2 );
+  expected->Initialize( size, lowerBound, upperBound );
+  typename THistogram::Pointer histogram = THistogram::New();
+  histogram->SetMeasurementVectorSize( 2 );
+  histogram->Initialize( size, lowerBound, upperBound );
+  // a frequency before the accumulation is kept
+  expected->IncreaseFrequency( 5, 2 );
+  histogram->IncreaseFrequency( 5, 2 );
+
+  typename AccumulatorType::Pointer accumulator = AccumulatorType::New();
+  accumulator->SetMaximumNumberOfDenseBins( maximumNumberOfDenseBins );
+  accumulator->SetNumberOfThreads( 3 );
+  const itk::ThreadIdType numberOfAccumulatingThreads = 4;
+  accumulator->Initialize( histogram, numberOfAccumulatingThreads );
+  typename THistogram::IndexType index( 2 );
+  for( unsigned int i = 0; i < 1000; ++i )
+    {
+    index[0] = ( i * 7 ) % 13;
+    index[1] = ( i * i ) % 7;
+    expected->IncreaseFrequencyOfIndex( index, 1 );
+    accumulator->IncreaseFrequencyOfIndex( i % numberOfAccumulatingThreads, index, 1 );
+    }
+  // identifiers which are not those of bins are ignored
+  accumulator->IncreaseFrequency( 1, histogram->Size(), 3 );
+  accumulator->AddToHistogram( histogram );
+
+  std::cout << ( accumulator->GetDense() ? "Dense" : "Sparse" ) << " accumulation of "
+            << histogram->GetTotalFrequency() << " frequencies" << std::endl;
+  return HistogramAccumulatorTestCompare( expected.GetPointer(), histogram.GetPointer(), "Accumulator" );
+}
+}
+
+int itkHistogramAccumulatorTest( int, char *[] )
+{
+  typedef itk::Statistics::DenseFrequencyContainer2                        DenseContainerType;
+  typedef itk::Statistics::SparseFrequencyContainer2                       SparseContainerType;
+  typedef itk::Statistics::Histogram< double, DenseContainerType >         DenseHistogramType;
+  typedef itk::Statistics::Histogram< double, SparseContainerType >        SparseHistogramType;
+  if( !HistogramAccumulatorTestAccumulate< DenseHistogramType >( 1000 )
+      || !HistogramAccumulatorTestAccumulate< DenseHistogramType >( 10 )
+      || !HistogramAccumulatorTestAccumulate< SparseHistogramType >( 1000 )
+      || !HistogramAccumulatorTestAccumulate< SparseHistogramType >( 10 ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // an image with a non zero start index, and a mask
+  ImageType::IndexType     start = {{ -4, 3, 1 }};
+  ImageType::SizeType      size = {{ 37, 29, 23 }};
+  ImageType::RegionType    region( start, size );
+  ImageType::Pointer       image = ImageType::New();
+  MaskImageType::Pointer   mask = MaskImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  mask->SetRegions( region );
+  mask->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for(; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    const double value = 300.0 * std::sin( 0.31 * index[0] + 0.17 * index[2] ) * std::cos( 0.23 * index[1] )
+                         + 40.0 * std::sin( 0.11 * index[0] * index[2] );
+    it.Set( static_cast< short >( value ) );
+    mask->SetPixel( index, ( index[0] + index[1] ) % 5 != 0 ? 255 : 0 );
+    }
+  image->SetPixel( start, -1000 );
+
+  typedef itk::ShiftScaleImageFilter< ImageType, ImageType > ShiftScaleType;
+  typedef itk::Statistics::ImageToHistogramFilter< ImageType >                      HistogramFilterType;
+  typedef itk::Statistics::MaskedImageToHistogramFilter< ImageType, MaskImageType > MaskedHistogramFilterType;
+  typedef HistogramFilterType::HistogramType                                        HistogramType;
+
+  const itk::ThreadIdType numbersOfThreads[3] = { 1, 3, 8 };
+  const unsigned int      numbersOfStreamDivisions[3] = { 1, 1, 4 };
+  HistogramType::Pointer  histograms[3];
+  HistogramType::Pointer  maskedHistograms[3];
+  HistogramType::Pointer  fixedHistograms[3];
+  for( unsigned int t = 0; t < 3; ++t )
+    {
+    // an upstream filter, which can stream its output
+    ShiftScaleType::Pointer shiftScale = ShiftScaleType::New();
+    shiftScale->SetInput( image );
+    shiftScale->SetShift( 7 );
+
+    HistogramFilterType::HistogramSizeType histogramSize( 1 );
+    histogramSize.Fill( 50 );
+
+    // the minimum and maximum are computed automatically
+    HistogramFilterType::Pointer histogramFilter = HistogramFilterType::New();
+    histogramFilter->SetInput( shiftScale->GetOutput() );
+    histogramFilter->SetHistogramSize( histogramSize );
+    histogramFilter->SetNumberOfThreads( numbersOfThreads[t] );
+    histogramFilter->SetNumberOfStreamDivisions( numbersOfStreamDivisions[t] );
+    histogramFilter->Update();
+    histograms[t] = histogramFilter->GetOutput();
+    histograms[t]->DisconnectPipeline();
+
+    if( numbersOfStreamDivisions[t] > 1
+        && shiftScale->GetOutput()->GetBufferedRegion() == shiftScale->GetOutput()->GetLargestPossibleRegion() )
+      {
+      std::cerr << "The input has not been streamed" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    MaskedHistogramFilterType::Pointer maskedHistogramFilter = MaskedHistogramFilterType::New();
+    maskedHistogramFilter->SetInput( shiftScale->GetOutput() );
+    maskedHistogramFilter->SetMaskImage( mask );
+    maskedHistogramFilter->SetMaskValue( 255 );
+    maskedHistogramFilter->SetHistogramSize( histogramSize );
+    maskedHistogramFilter->SetNumberOfThreads( numbersOfThreads[t] );
+    maskedHistogramFilter->SetNumberOfStreamDivisions( numbersOfStreamDivisions[t] );
+    maskedHistogramFilter->Update();
+    maskedHistograms[t] = maskedHistogramFilter->GetOutput();
+    maskedHistograms[t]->DisconnectPipeline();
+
+    // the given minimum and maximum, which clip some values
+    HistogramFilterType::HistogramMeasurementVectorType minimum( 1 );
+    HistogramFilterType::HistogramMeasurementVectorType maximum( 1 );
+    minimum.Fill( -200 );
+    maximum.Fill( 250 );
+    HistogramFilterType::Pointer fixedHistogramFilter = HistogramFilterType::New();
+    fixedHistogramFilter->SetInput( shiftScale->GetOutput() );
+    fixedHistogramFilter->SetHistogramSize( histogramSize );
+    fixedHistogramFilter->SetAutoMinimumMaximum( false );
+    fixedHistogramFilter->SetHistogramBinMinimum( minimum );
+    fixedHistogramFilter->SetHistogramBinMaximum( maximum );
+    fixedHistogramFilter->SetNumberOfThreads( numbersOfThreads[t] );
+    fixedHistogramFilter->SetNumberOfStreamDivisions( numbersOfStreamDivisions[t] );
+    fixedHistogramFilter->Update();
+    fixedHistograms[t] = fixedHistogramFilter->GetOutput();
+    fixedHistograms[t]->DisconnectPipeline();
+
+    std::cout << numbersOfThreads[t] << " threads, " << numbersOfStreamDivisions[t] << " pieces: "
+              << histograms[t]->GetTotalFrequency() << ", " << maskedHistograms[t]->GetTotalFrequency()
+              << " and " << fixedHistograms[t]->GetTotalFrequency() << " pixels" << std::endl;
+    if( histograms[t]->GetTotalFrequency() != region.GetNumberOfPixels() )
+      {
+      std::cerr << "The histogram does not have all the pixels" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( t > 0 && ( !HistogramAccumulatorTestCompare( histograms[0].GetPointer(), histograms[t].GetPointer(),
+                                                     "ImageToHistogramFilter" )
+                   || !HistogramAccumulatorTestCompare( maskedHistograms[0].GetPointer(),
+                                                        maskedHistograms[t].GetPointer(),
+                                                        "MaskedImageToHistogramFilter" )
+                   || !HistogramAccumulatorTestCompare( fixedHistograms[0].GetPointer(),
+                                                        fixedHistograms[t].GetPointer(),
+                                                        "ImageToHistogramFilter with minimum and maximum" ) ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the co-occurrence and run length matrices, with and without mask
+  typedef itk::Statistics::ScalarImageToCooccurrenceMatrixFilter< ImageType > CooccurrenceFilterType;
+  typedef itk::Statistics::ScalarImageToRunLengthMatrixFilter< ImageType >    RunLengthFilterType;
+  typedef CooccurrenceFilterType::HistogramType                               CooccurrenceHistogramType;
+  typedef RunLengthFilterType::HistogramType                                  RunLengthHistogramType;
+
+  ImageType::Pointer maskImage = ImageType::New();
+  maskImage->SetRegions( region );
+  maskImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > mit( maskImage, region );
+  for(; !mit.IsAtEnd(); ++mit )
+    {
+    mit.Set( mask->GetPixel( mit.GetIndex() ) ? 1 : 0 );
+    }
+
+  CooccurrenceFilterType::OffsetVectorPointer offsets = CooccurrenceFilterType::OffsetVector::New();
+  const ImageType::OffsetType offset0 = {{ 1, 0, 0 }};
+  const ImageType::OffsetType offset1 = {{ 1, -1, 0 }};
+  const ImageType::OffsetType offset2 = {{ 0, 1, 1 }};
+  const ImageType::OffsetType offset3 = {{ 0, 0, 2 }};
+  offsets->push_back( offset0 );
+  offsets->push_back( offset1 );
+  offsets->push_back( offset2 );
+  offsets->push_back( offset3 );
+
+  CooccurrenceHistogramType::Pointer cooccurrenceHistograms[2][3];
+  RunLengthHistogramType::Pointer    runLengthHistograms[2][3];
+  for( unsigned int m = 0; m < 2; ++m )
+    {
+    for( unsigned int t = 0; t < 3; ++t )
+      {
+      CooccurrenceFilterType::Pointer cooccurrence = CooccurrenceFilterType::New();
+      cooccurrence->SetInput( image );
+      if( m == 1 )
+        {
+        cooccurrence->SetMaskImage( maskImage );
+        }
+      cooccurrence->SetOffsets( offsets );
+      cooccurrence->SetNumberOfBinsPerAxis( 16 );
+      cooccurrence->SetPixelValueMinMax( -350, 350 );
+      cooccurrence->SetNumberOfThreads( numbersOfThreads[t] );
+      cooccurrence->Update();
+      cooccurrenceHistograms[m][t] = const_cast< CooccurrenceHistogramType * >( cooccurrence->GetOutput() );
+
+      RunLengthFilterType::Pointer runLength = RunLengthFilterType::New();
+      runLength->SetInput( image );
+      if( m == 1 )
+        {
+        runLength->SetMaskImage( maskImage );
+        }
+      runLength->SetOffsets( offsets );
+      runLength->SetNumberOfBinsPerAxis( 12 );
+      runLength->SetPixelValueMinMax( -350, 350 );
+      runLength->SetDistanceValueMinMax( 0, 20 );
+      runLength->SetNumberOfThreads( numbersOfThreads[t] );
+      runLength->Update();
+      runLengthHistograms[m][t] = const_cast< RunLengthHistogramType * >( runLength->GetOutput() );
+
+      std::cout << ( m == 1 ? "With" : "Without" ) << " mask, " << numbersOfThreads[t] << " threads: "
+                << cooccurrenceHistograms[m][t]->GetTotalFrequency() << " co-occurrences and "
+                << runLengthHistograms[m][t]->GetTotalFrequency() << " runs" << std::endl;
+      if( cooccurrenceHistograms[m][t]->GetTotalFrequency() == 0 || runLengthHistograms[m][t]->GetTotalFrequency() == 0 )
+        {
+        std::cerr << "The matrices are empty" << std::endl;
+        return EXIT_FAILURE;
+        }
+      if( t > 0 && ( !HistogramAccumulatorTestCompare( cooccurrenceHistograms[m][0].GetPointer(),
+                                                       cooccurrenceHistograms[m][t].GetPointer(),
+                                                       "ScalarImageToCooccurrenceMatrixFilter" )
+                     || !HistogramAccumulatorTestCompare( runLengthHistograms[m][0].GetPointer(),
+                                                          runLengthHistograms[m][t].GetPointer(),
+                                                          "ScalarImageToRunLengthMatrixFilter" ) ) )
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,271 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkListSample.h"
+#include "itkImageToListSampleAdaptor.h"
+#include "itkImageRegionIterator.h"
+#include "itkKdTreeGenerator.h"
+#include "itkWeightedCentroidKdTreeGenerator.h"
+
+/**
+ * Build k-d trees of a sample with many repeated measurement values, with
+ * KdTreeGenerator and WeightedCentroidKdTreeGenerator, with one thread and
+ * with several threads. The trees must be identical. Then search the
+ * neighbors of several query points at once with several threads, which
+ * must give the same neighbors as the searches of one query point at a
+ * time. Finally search several query points at once in a tree of an
+ * ImageToListSampleAdaptor, whose measurement vectors cannot be read by
+ * several threads, with the default number of threads.
+ */
+
+namespace
+{
+typedef itk::Vector< float, 3 >                               MeasurementVectorType;
+typedef itk::Statistics::ListSample< MeasurementVectorType >  SampleType;
+typedef itk::Statistics::KdTree< SampleType >                 TreeType;
+typedef TreeType::KdTreeNodeType                              NodeType;
+
+bool KdTreeThreadingTestCompareNodes( NodeType *node1, NodeType *node2, TreeType * tree1, TreeType * tree2 )
+{
+  if( node1->IsTerminal() != node2->IsTerminal() || node1->Size() != node2->Size() )
+    {
+    std::cerr << "The nodes have different types or sizes" << std::endl;
+    return false;
+    }
+  if( node1->IsTerminal() )
+    {
+    if( ( node1 == tree1->GetEmptyTerminalNode() ) != ( node2 == tree2->GetEmptyTerminalNode() ) )
+      {
+      std::cerr << "Only one of the terminal nodes is empty" << std::endl;
+      return false;
+      }
+    for( unsigned int i = 0; i < node1->Size(); ++i )
+      {
+      if( node1->GetInstanceIdentifier( i ) != node2->GetInstanceIdentifier( i ) )
+        {
+        std::cerr << "The terminal nodes have different instances" << std::endl;
+        return false;
+        }
+      }
+    return true;
+    }
+
+  unsigned int                partitionDimension1;
+  unsigned int                partitionDimension2;
+  SampleType::MeasurementType partitionValue1;
+  SampleType::MeasurementType partitionValue2;
+  node1->GetParameters( partitionDimension1, partitionValue1 );
+  node2->GetParameters( partitionDimension2, partitionValue2 );
+  NodeType::CentroidType centroid1;
+  NodeType::CentroidType centroid2;
+  node1->GetWeightedCentroid( centroid1 );
+  node2->GetWeightedCentroid( centroid2 );
+  if( partitionDimension1 != partitionDimension2 || partitionValue1 != partitionValue2
+      || node1->GetInstanceIdentifier( 0 ) != node2->GetInstanceIdentifier( 0 )
+      || centroid1 != centroid2 )
+    {
+    std::cerr << "The nonterminal nodes are different: dimension " << partitionDimension2
+              << " instead of " << partitionDimension1 << ", value " << partitionValue2
+              << " instead of " << partitionValue1 << ", instance " << node2->GetInstanceIdentifier( 0 )
+              << " instead of " << node1->GetInstanceIdentifier( 0 ) << std::endl;
+    return false;
+    }
+  return KdTreeThreadingTestCompareNodes( node1->Left(), node2->Left(), tree1, tree2 )
+         && KdTreeThreadingTestCompareNodes( node1->Right(), node2->Right(), tree1, tree2 );
+}
+
+template< typename TGenerator >
+bool KdTreeThreadingTestGenerator( SampleType * sample, const char * name )
+{
+  const itk::ThreadIdType numbersOfThreads[3] = { 1, 3, 8 };
+  typename TreeType::Pointer trees[3];
+  for( unsigned int t = 0; t < 3; ++t )
+    {
+    typename TGenerator::Pointer generator = TGenerator::New();
+    generator->SetSample( sample );
+    generator->SetBucketSize( 4 );
+    generator->SetNumberOfThreads( numbersOfThreads[t] );
+    generator->Update();
+    trees[t] = generator->GetOutput();
+    if( t > 0 && !KdTreeThreadingTestCompareNodes( trees[0]->GetRoot(), trees[t]->GetRoot(), trees[0], trees[t] ) )
+      {
+      std::cerr << name << " with " << numbersOfThreads[t] << " threads" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkKdTreeThreadingTest( int, char *[] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator NumberGeneratorType;
+  NumberGeneratorType::Pointer randomNumberGenerator = NumberGeneratorType::New();
+  randomNumberGenerator->Initialize( 1234 );
+
+  // coarse values, so that the medians have ties
+  SampleType::Pointer sample = SampleType::New();
+  sample->SetMeasurementVectorSize( 3 );
+  MeasurementVectorType mv;
+  for( unsigned int i = 0; i < 5000; ++i )
+    {
+    for( unsigned int d = 0; d < 3; ++d )
+      {
+      mv[d] = static_cast< float >( randomNumberGenerator->GetIntegerVariate( 40 ) ) / ( d + 1 );
+      }
+    sample->PushBack( mv );
+    }
+
+  typedef itk::Statistics::KdTreeGenerator< SampleType >                 GeneratorType;
+  typedef itk::Statistics::WeightedCentroidKdTreeGenerator< SampleType > WeightedCentroidGeneratorType;
+  if( !KdTreeThreadingTestGenerator< GeneratorType >( sample, "KdTreeGenerator" )
+      || !KdTreeThreadingTestGenerator< WeightedCentroidGeneratorType >( sample, "WeightedCentroidKdTreeGenerator" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->SetSample( sample );
+  generator->SetBucketSize( 8 );
+  generator->SetNumberOfThreads( 4 );
+  generator->Update();
+  TreeType::Pointer tree = generator->GetOutput();
+
+  TreeType::MeasurementVectorContainerType queries;
+  for( unsigned int i = 0; i < 300; ++i )
+    {
+    for( unsigned int d = 0; d < 3; ++d )
+      {
+      mv[d] = randomNumberGenerator->GetUniformVariate( -2.0, 42.0 );
+      }
+    queries.push_back( mv );
+    }
+
+  const unsigned int numberOfNeighbors = 7;
+  const double       radius = 3.5;
+  const itk::ThreadIdType numbersOfThreads[3] = { 1, 3, 1000 };
+  for( unsigned int t = 0; t < 3; ++t )
+    {
+    tree->SetNumberOfThreads( numbersOfThreads[t] );
+    TreeType::InstanceIdentifierVectorContainerType neighbors;
+    TreeType::DistanceVectorContainerType           distances;
+    TreeType::InstanceIdentifierVectorContainerType neighborsWithoutDistances;
+    TreeType::InstanceIdentifierVectorContainerType neighborsInRadius;
+    tree->Search( queries, numberOfNeighbors, neighbors, distances );
+    tree->Search( queries, numberOfNeighbors, neighborsWithoutDistances );
+    tree->Search( queries, radius, neighborsInRadius );
+    if( neighbors.size() != queries.size() || distances.size() != queries.size()
+        || neighborsWithoutDistances.size() != queries.size() || neighborsInRadius.size() != queries.size() )
+      {
+      std::cerr << "The searches give " << neighbors.size() << ", " << distances.size() << ", "
+                << neighborsWithoutDistances.size() << " and " << neighborsInRadius.size()
+                << " results for " << queries.size() << " query points" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    itk::SizeValueType numberOfNeighborsInRadius = 0;
+    for( unsigned int i = 0; i < queries.size(); ++i )
+      {
+      TreeType::InstanceIdentifierVectorType expectedNeighbors;
+      std::vector< double >                  expectedDistances;
+      TreeType::InstanceIdentifierVectorType expectedNeighborsInRadius;
+      tree->Search( queries[i], numberOfNeighbors, expectedNeighbors, expectedDistances );
+      tree->Search( queries[i], radius, expectedNeighborsInRadius );
+      if( neighbors[i] != expectedNeighbors || distances[i] != expectedDistances
+          || neighborsWithoutDistances[i] != expectedNeighbors || neighborsInRadius[i] != expectedNeighborsInRadius )
+        {
+        std::cerr << "The neighbors of query point " << i << " are different with "
+                  << numbersOfThreads[t] << " threads" << std::endl;
+        return EXIT_FAILURE;
+        }
+      numberOfNeighborsInRadius += neighborsInRadius[i].size();
+      }
+    std::cout << numbersOfThreads[t] << " threads: " << numberOfNeighborsInRadius
+              << " neighbors in the radius" << std::endl;
+    }
+
+  // an empty container of query points
+  TreeType::MeasurementVectorContainerType noQueries;
+  TreeType::InstanceIdentifierVectorContainerType noNeighbors( 3 );
+  tree->Search( noQueries, numberOfNeighbors, noNeighbors );
+  if( !noNeighbors.empty() )
+    {
+    std::cerr << "The search of no query point gives results" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // an image sample, searched with the default single thread
+  typedef itk::Image< MeasurementVectorType, 2 >                ImageType;
+  typedef itk::Statistics::ImageToListSampleAdaptor< ImageType > ImageSampleType;
+  typedef itk::Statistics::KdTreeGenerator< ImageSampleType >    ImageGeneratorType;
+  typedef ImageGeneratorType::KdTreeType                         ImageTreeType;
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 40 );
+  image->SetRegions( imageSize );
+  image->Allocate();
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    for( unsigned int d = 0; d < 3; ++d )
+      {
+      mv[d] = static_cast< float >( randomNumberGenerator->GetIntegerVariate( 40 ) ) / ( d + 1 );
+      }
+    it.Set( mv );
+    }
+  ImageSampleType::Pointer imageSample = ImageSampleType::New();
+  imageSample->SetImage( image );
+
+  ImageGeneratorType::Pointer imageGenerator = ImageGeneratorType::New();
+  imageGenerator->SetSample( imageSample );
+  imageGenerator->SetBucketSize( 8 );
+  imageGenerator->Update();
+  ImageTreeType::Pointer imageTree = imageGenerator->GetOutput();
+  if( imageTree->GetNumberOfThreads() != 1 )
+    {
+    std::cerr << "The default number of threads of the tree is " << imageTree->GetNumberOfThreads()
+              << " instead of 1" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageTreeType::MeasurementVectorContainerType imageQueries( queries.begin(), queries.end() );
+  ImageTreeType::InstanceIdentifierVectorContainerType imageNeighbors;
+  ImageTreeType::DistanceVectorContainerType           imageDistances;
+  ImageTreeType::InstanceIdentifierVectorContainerType imageNeighborsInRadius;
+  imageTree->Search( imageQueries, numberOfNeighbors, imageNeighbors, imageDistances );
+  imageTree->Search( imageQueries, radius, imageNeighborsInRadius );
+  for( unsigned int i = 0; i < imageQueries.size(); ++i )
+    {
+    ImageTreeType::InstanceIdentifierVectorType expectedNeighbors;
+    std::vector< double >                       expectedDistances;
+    ImageTreeType::InstanceIdentifierVectorType expectedNeighborsInRadius;
+    imageTree->Search( imageQueries[i], numberOfNeighbors, expectedNeighbors, expectedDistances );
+    imageTree->Search( imageQueries[i], radius, expectedNeighborsInRadius );
+    if( imageNeighbors[i] != expectedNeighbors || imageDistances[i] != expectedDistances
+        || imageNeighborsInRadius[i] != expectedNeighborsInRadius )
+      {
+      std::cerr << "The neighbors of query point " << i << " in the image sample are different" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
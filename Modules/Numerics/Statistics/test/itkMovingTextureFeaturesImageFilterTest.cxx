@@ -0,0 +1,287 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMovingTextureFeaturesImageFilter.h"
+#include "itkScalarImageToCooccurrenceMatrixFilter.h"
+#include "itkScalarImageToRunLengthMatrixFilter.h"
+#include "itkHistogramToTextureFeaturesFilter.h"
+#include "itkHistogramToRunLengthFeaturesFilter.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "vnl/vnl_math.h"
+
+/**
+ * Compute the texture feature maps of small images with
+ * MovingTextureFeaturesImageFilter, and compare each pixel with the mean
+ * features of the co-occurrence and run length matrices computed by the
+ * matrix filters on the pixels of its window. The maps must not depend on
+ * the number of threads, nor on the output requested region.
+ */
+
+namespace
+{
+const unsigned int MovingTextureFeaturesImageFilterTestBins = 4;
+
+bool MovingTextureFeaturesImageFilterTestClose( double expected, double actual )
+{
+  if( vnl_math_isnan( expected ) || vnl_math_isnan( actual ) )
+    {
+    return vnl_math_isnan( expected ) && vnl_math_isnan( actual );
+    }
+  if( vnl_math_isinf( expected ) || vnl_math_isinf( actual ) )
+    {
+    return expected == actual;
+    }
+  return std::fabs( expected - actual ) <= 1e-4 * std::max( 1.0, std::fabs( expected ) );
+}
+
+template< unsigned int VDimension >
+bool MovingTextureFeaturesImageFilterTestImage( const itk::Size< VDimension > & size,
+                                                const itk::Size< VDimension > & radius,
+                                                const double * spacing,
+                                                double maxDistance,
+                                                const std::vector< itk::Offset< VDimension > > & offsets )
+{
+  typedef itk::Image< unsigned char, VDimension >                               ImageType;
+  typedef itk::Statistics::MovingTextureFeaturesImageFilter< ImageType >        FilterType;
+  typedef typename FilterType::OutputImageType                                  OutputImageType;
+  typedef itk::Statistics::ScalarImageToCooccurrenceMatrixFilter< ImageType >   CooccurrenceFilterType;
+  typedef itk::Statistics::ScalarImageToRunLengthMatrixFilter< ImageType >      RunLengthFilterType;
+  typedef itk::Statistics::HistogramToTextureFeaturesFilter<
+    typename CooccurrenceFilterType::HistogramType >                            TextureFeaturesFilterType;
+  typedef itk::Statistics::HistogramToRunLengthFeaturesFilter<
+    typename RunLengthFilterType::HistogramType >                               RunLengthFeaturesFilterType;
+
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator NumberGeneratorType;
+  NumberGeneratorType::Pointer randomNumberGenerator = NumberGeneratorType::New();
+  randomNumberGenerator->Initialize( 2016 );
+
+  // random values, half of them repeated along the first dimension so that
+  // there are runs longer than one pixel
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->Allocate();
+  unsigned char previousValue = 0;
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if( randomNumberGenerator->GetIntegerVariate( 1 ) == 0 )
+      {
+      previousValue = static_cast< unsigned char >( randomNumberGenerator->GetIntegerVariate( 9 ) );
+      }
+    it.Set( previousValue );
+    }
+
+  typename FilterType::OffsetVectorPointer offsetVector;
+  if( !offsets.empty() )
+    {
+    offsetVector = FilterType::OffsetVector::New();
+    for( unsigned int o = 0; o < offsets.size(); ++o )
+      {
+      offsetVector->push_back( offsets[o] );
+      }
+    }
+
+  // the maps with 1 and 3 threads, and the map of a part of the image
+  typename OutputImageType::Pointer maps[3];
+  typename ImageType::RegionType partRegion = image->GetLargestPossibleRegion();
+  for( unsigned int d = 0; d < VDimension; ++d )
+    {
+    partRegion.SetIndex( d, size[d] / 3 );
+    partRegion.SetSize( d, size[d] / 2 );
+    }
+  for( unsigned int m = 0; m < 3; ++m )
+    {
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    filter->SetRadius( radius );
+    if( offsetVector.IsNotNull() )
+      {
+      filter->SetOffsets( offsetVector.GetPointer() );
+      }
+    filter->SetNumberOfBinsPerAxis( MovingTextureFeaturesImageFilterTestBins );
+    filter->SetPixelValueMinMax( 1, 8 );
+    filter->SetDistanceValueMinMax( 0, maxDistance );
+    filter->SetNumberOfThreads( m == 0 ? 1 : 3 );
+    if( m == 2 )
+      {
+      filter->GetOutput()->SetRequestedRegion( partRegion );
+      }
+    filter->Update();
+    if( m == 0 && VDimension == 2 && offsets.empty() )
+      {
+      filter->Print( std::cout );
+      }
+    maps[m] = filter->GetOutput();
+    maps[m]->DisconnectPipeline();
+    if( maps[m]->GetNumberOfComponentsPerPixel() != 18 )
+      {
+      std::cerr << "The output has " << maps[m]->GetNumberOfComponentsPerPixel()
+                << " components instead of 18" << std::endl;
+      return false;
+      }
+    }
+
+  const unsigned int numberOfOffsets = offsetVector.IsNotNull()
+    ? offsetVector->Size() : FilterType::New()->GetOffsets()->Size();
+  typename FilterType::OffsetVectorConstPointer filterOffsets = offsetVector.IsNotNull()
+    ? offsetVector.GetPointer() : FilterType::New()->GetOffsets();
+
+  itk::ImageRegionConstIteratorWithIndex< OutputImageType > mapIt( maps[0], maps[0]->GetLargestPossibleRegion() );
+  for( mapIt.GoToBegin(); !mapIt.IsAtEnd(); ++mapIt )
+    {
+    const typename ImageType::IndexType index = mapIt.GetIndex();
+    const typename OutputImageType::PixelType features = mapIt.Get();
+    if( maps[1]->GetPixel( index ) != features
+        || ( partRegion.IsInside( index ) && maps[2]->GetPixel( index ) != features ) )
+      {
+      std::cerr << "The features at " << index << " depend on the number of threads"
+                << " or on the requested region" << std::endl;
+      return false;
+      }
+
+    // an image of the pixels of the window
+    typename ImageType::RegionType window;
+    window.SetIndex( index );
+    window.PadByRadius( radius );
+    window.Crop( image->GetLargestPossibleRegion() );
+    typename ImageType::Pointer windowImage = ImageType::New();
+    windowImage->SetRegions( window.GetSize() );
+    windowImage->SetSpacing( spacing );
+    windowImage->Allocate();
+    itk::ImageRegionConstIterator< ImageType > imageIt( image, window );
+    itk::ImageRegionIterator< ImageType >      windowIt( windowImage, windowImage->GetLargestPossibleRegion() );
+    for( ; !imageIt.IsAtEnd(); ++imageIt, ++windowIt )
+      {
+      windowIt.Set( imageIt.Get() );
+      }
+
+    double       expected[18];
+    unsigned int numberOfTextureMatrices = 0;
+    unsigned int numberOfRunLengthMatrices = 0;
+    std::fill( expected, expected + 18, 0.0 );
+    for( unsigned int o = 0; o < numberOfOffsets; ++o )
+      {
+      typename CooccurrenceFilterType::Pointer cooccurrenceFilter = CooccurrenceFilterType::New();
+      cooccurrenceFilter->SetInput( windowImage );
+      cooccurrenceFilter->SetOffset( filterOffsets->ElementAt( o ) );
+      cooccurrenceFilter->SetNumberOfBinsPerAxis( MovingTextureFeaturesImageFilterTestBins );
+      cooccurrenceFilter->SetPixelValueMinMax( 1, 8 );
+      cooccurrenceFilter->SetNumberOfThreads( 1 );
+      cooccurrenceFilter->Update();
+      if( cooccurrenceFilter->GetOutput()->GetTotalFrequency() > 0 )
+        {
+        typename TextureFeaturesFilterType::Pointer textureFilter = TextureFeaturesFilterType::New();
+        textureFilter->SetInput( cooccurrenceFilter->GetOutput() );
+        textureFilter->Update();
+        for( unsigned int f = 0; f < 8; ++f )
+          {
+          expected[f] += textureFilter->GetFeature(
+            static_cast< typename TextureFeaturesFilterType::TextureFeatureName >( f ) );
+          }
+        ++numberOfTextureMatrices;
+        }
+
+      typename RunLengthFilterType::Pointer runLengthFilter = RunLengthFilterType::New();
+      runLengthFilter->SetInput( windowImage );
+      runLengthFilter->SetOffset( filterOffsets->ElementAt( o ) );
+      runLengthFilter->SetNumberOfBinsPerAxis( MovingTextureFeaturesImageFilterTestBins );
+      runLengthFilter->SetPixelValueMinMax( 1, 8 );
+      runLengthFilter->SetDistanceValueMinMax( 0, maxDistance );
+      runLengthFilter->SetNumberOfThreads( 1 );
+      runLengthFilter->Update();
+      if( runLengthFilter->GetOutput()->GetTotalFrequency() > 0 )
+        {
+        typename RunLengthFeaturesFilterType::Pointer runLengthFeaturesFilter = RunLengthFeaturesFilterType::New();
+        runLengthFeaturesFilter->SetInput( runLengthFilter->GetOutput() );
+        runLengthFeaturesFilter->Update();
+        for( unsigned int f = 0; f < 10; ++f )
+          {
+          expected[8 + f] += runLengthFeaturesFilter->GetFeature(
+            static_cast< typename RunLengthFeaturesFilterType::RunLengthFeatureName >( f ) );
+          }
+        ++numberOfRunLengthMatrices;
+        }
+      }
+
+    for( unsigned int f = 0; f < 18; ++f )
+      {
+      const unsigned int numberOfMatrices = ( f < 8 ) ? numberOfTextureMatrices : numberOfRunLengthMatrices;
+      if( numberOfMatrices > 0 )
+        {
+        expected[f] /= numberOfMatrices;
+        }
+      if( !MovingTextureFeaturesImageFilterTestClose( expected[f], features[f] ) )
+        {
+        std::cerr << "Feature " << f << " at " << index << " is " << features[f]
+                  << " instead of " << expected[f] << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkMovingTextureFeaturesImageFilterTest( int, char *[] )
+{
+  typedef itk::Size< 2 >   Size2DType;
+  typedef itk::Offset< 2 > Offset2DType;
+  typedef itk::Size< 3 >   Size3DType;
+
+  // default offsets
+  Size2DType     size2D = {{ 13, 11 }};
+  Size2DType     radius2D = {{ 2, 3 }};
+  const double   spacing2D[2] = { 0.7, 1.3 };
+  if( !MovingTextureFeaturesImageFilterTestImage< 2 >( size2D, radius2D, spacing2D, 8.1,
+                                                       std::vector< Offset2DType >() ) )
+    {
+    std::cerr << "2D image with the default offsets" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // offsets longer than one pixel, and a window larger than the image
+  Size2DType                  smallSize2D = {{ 9, 4 }};
+  Size2DType                  largeRadius2D = {{ 1, 5 }};
+  std::vector< Offset2DType > offsets2D;
+  Offset2DType                offset = {{ 2, -1 }};
+  offsets2D.push_back( offset );
+  offset[0] = -1;
+  offset[1] = 3;
+  offsets2D.push_back( offset );
+  if( !MovingTextureFeaturesImageFilterTestImage< 2 >( smallSize2D, largeRadius2D, spacing2D, 8.1, offsets2D ) )
+    {
+    std::cerr << "2D image with long offsets" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  Size3DType   size3D = {{ 7, 6, 5 }};
+  Size3DType   radius3D = {{ 1, 2, 1 }};
+  const double spacing3D[3] = { 1.0, 0.8, 1.5 };
+  if( !MovingTextureFeaturesImageFilterTestImage< 3 >( size3D, radius3D, spacing3D, 6.1,
+                                                       std::vector< itk::Offset< 3 > >() ) )
+    {
+    std::cerr << "3D image with the default offsets" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -22,6 +22,7 @@
 #include "itkImageToImageMetric.h"
 #include "itkSingleValuedNonLinearOptimizer.h"
 #include "itkMultiResolutionPyramidImageFilter.h"
+#include "itkSharedImagePyramid.h"
 #include "itkNumericTraits.h"
 #include "itkDataObjectDecorator.h"
 
@@ -53,6 +54,11 @@ namespace itk
  * MultiResolutionPyramidImageFilters. User must specify the schedule
  * for each pyramid externally prior to calling Update().
  *
+ * Registrations of many images to the same fixed image may share the
+ * smoothing of the fixed image through a SharedImagePyramid, set with
+ * SetFixedSharedImagePyramid(), which uses a
+ * SharedMultiResolutionPyramidImageFilter as fixed image pyramid.
+ *
  * \warning If there is discrepancy between the number of level requested
  * and a pyramid schedule. The pyramid schedule will be overriden
  * with a default one.
@@ -171,6 +177,26 @@ public:
   itkSetObjectMacro(MovingImagePyramid, MovingImagePyramidType);
   itkGetModifiableObjectMacro(MovingImagePyramid, MovingImagePyramidType);
 
+  /** Type of the pyramids of smoothed images shared between registrations. */
+  typedef SharedImagePyramid< FixedImageType >  FixedSharedImagePyramidType;
+  typedef SharedImagePyramid< MovingImageType > MovingSharedImagePyramidType;
+
+  /** Use a SharedMultiResolutionPyramidImageFilter taking the smoothed
+   * images from the given shared pyramid as fixed image pyramid. */
+  void SetFixedSharedImagePyramid(FixedSharedImagePyramidType *pyramid);
+
+  /** Use a SharedMultiResolutionPyramidImageFilter taking the smoothed
+   * images from the given shared pyramid as moving image pyramid. */
+  void SetMovingSharedImagePyramid(MovingSharedImagePyramidType *pyramid);
+
+  /** Set/Get whether the smoothed moving images are removed from the
+   * shared moving image pyramid once the pyramid levels are computed, so
+   * that a pyramid shared by the registrations of many moving images does
+   * not keep all of them. On by default. */
+  itkSetMacro(ReleaseMovingSmoothedImages, bool);
+  itkGetConstMacro(ReleaseMovingSmoothedImages, bool);
+  itkBooleanMacro(ReleaseMovingSmoothedImages);
+
   /** Set/Get the schedules . */
   void SetSchedules(const ScheduleType & fixedSchedule,
                     const ScheduleType & movingSchedule);
@@ -286,6 +312,8 @@ private:
 
   bool m_ScheduleSpecified;
   bool m_NumberOfLevelsSpecified;
+
+  bool m_ReleaseMovingSmoothedImages;
 };
 } // end namespace itk
 
@@ -20,6 +20,7 @@
 
 #include "itkMultiResolutionImageRegistrationMethod.h"
 #include "itkRecursiveMultiResolutionPyramidImageFilter.h"
+#include "itkSharedMultiResolutionPyramidImageFilter.h"
 
 namespace itk
 {
@@ -52,6 +53,8 @@ MultiResolutionImageRegistrationMethod< TFixedImage, TMovingImage >
   m_ScheduleSpecified = false;
   m_NumberOfLevelsSpecified = false;
 
+  m_ReleaseMovingSmoothedImages = true;
+
   m_InitialTransformParameters = ParametersType(1);
   m_InitialTransformParametersOfNextLevel = ParametersType(1);
   m_LastTransformParameters = ParametersType(1);
@@ -128,6 +131,34 @@ MultiResolutionImageRegistrationMethod< TFixedImage, TMovingImage >
   m_Stop = true;
 }
 
+/**
+ * Take the smoothed fixed images from a shared pyramid
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiResolutionImageRegistrationMethod< TFixedImage, TMovingImage >
+::SetFixedSharedImagePyramid(FixedSharedImagePyramidType *pyramid)
+{
+  typedef SharedMultiResolutionPyramidImageFilter< FixedImageType, FixedImageType > PyramidFilterType;
+  typename PyramidFilterType::Pointer pyramidFilter = PyramidFilterType::New();
+  pyramidFilter->SetSharedImagePyramid(pyramid);
+  this->SetFixedImagePyramid(pyramidFilter);
+}
+
+/**
+ * Take the smoothed moving images from a shared pyramid
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiResolutionImageRegistrationMethod< TFixedImage, TMovingImage >
+::SetMovingSharedImagePyramid(MovingSharedImagePyramidType *pyramid)
+{
+  typedef SharedMultiResolutionPyramidImageFilter< MovingImageType, MovingImageType > PyramidFilterType;
+  typename PyramidFilterType::Pointer pyramidFilter = PyramidFilterType::New();
+  pyramidFilter->SetSharedImagePyramid(pyramid);
+  this->SetMovingImagePyramid(pyramidFilter);
+}
+
 /**
  * Set the schedules for the fixed and moving image pyramid
  */
@@ -307,6 +338,8 @@ MultiResolutionImageRegistrationMethod< TFixedImage, TMovingImage >
   os << m_FixedImagePyramid.GetPointer() << std::endl;
   os << indent << "MovingImagePyramid: ";
   os << m_MovingImagePyramid.GetPointer() << std::endl;
+  os << indent << "ReleaseMovingSmoothedImages: ";
+  os << m_ReleaseMovingSmoothedImages << std::endl;
 
   os << indent << "NumberOfLevels: ";
   os << m_NumberOfLevels << std::endl;
@@ -345,6 +378,19 @@ MultiResolutionImageRegistrationMethod< TFixedImage, TMovingImage >
 
   this->PreparePyramids();
 
+  // The levels of the moving image are now held by the moving image
+  // pyramid: its smoothed images are not needed in the shared pyramid.
+  if ( m_ReleaseMovingSmoothedImages )
+    {
+    typedef SharedMultiResolutionPyramidImageFilter< MovingImageType, MovingImageType > SharedPyramidFilterType;
+    SharedPyramidFilterType *sharedPyramidFilter =
+      dynamic_cast< SharedPyramidFilterType * >( m_MovingImagePyramid.GetPointer() );
+    if ( sharedPyramidFilter && sharedPyramidFilter->GetSharedImagePyramid() )
+      {
+      sharedPyramidFilter->GetSharedImagePyramid()->RemoveSmoothedImages(m_MovingImage);
+      }
+    }
+
   for ( m_CurrentLevel = 0; m_CurrentLevel < m_NumberOfLevels;
     m_CurrentLevel++ )
     {
@@ -62,8 +62,16 @@ PointsLocator<TPointsContainer>
   this->m_KdTreeGenerator->SetSample( this->m_SampleAdaptor );
   this->m_KdTreeGenerator->SetBucketSize( 16 );
 
+  // The adaptor reads the points straight from the container, so that the
+  // tree can be built and searched with several threads.
+  this->m_KdTreeGenerator->SetNumberOfThreads(
+    MultiThreader::GetGlobalDefaultNumberOfThreads() );
+
   this->m_KdTreeGenerator->Update();
 
+  this->m_KdTreeGenerator->GetOutput()->SetNumberOfThreads(
+    MultiThreader::GetGlobalDefaultNumberOfThreads() );
+
   this->m_Tree = this->m_KdTreeGenerator->GetOutput();
 }
 
@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSharedImagePyramid_h
+#define itkSharedImagePyramid_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkFixedArray.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkTimeStamp.h"
+
+#include <vector>
+
+namespace itk
+{
+/** \class SharedImagePyramid
+ * \brief Gaussian smoothed versions of images, computed once and shared
+ * between multi-resolution registrations.
+ *
+ * The pyramid keeps the images smoothed with the variances requested for
+ * them, so that registrations using the same image, e.g. an atlas
+ * registered to many subjects, smooth it only once. The smoothed images of
+ * an image are computed by increasing variance, each one from the smoothed
+ * image of largest smaller variance, with the difference of the variances,
+ * which uses smaller kernels than smoothing the image for each variance.
+ * Because of the truncation of the kernels, the results differ slightly
+ * from smoothing the image directly.
+ *
+ * The smoothing with a null variance gives the image itself. An image
+ * grafted from another one, i.e. sharing its buffer and geometry, shares
+ * its smoothed images. The smoothed images of an image are discarded when
+ * it is modified, or with
+ * RemoveSmoothedImages() once it is not used anymore. The registration
+ * methods do that for the moving images when they finish, unless
+ * ReleaseMovingSmoothedImages is off.
+ *
+ * The pyramid may be used concurrently from several threads: the smoothed
+ * images are computed by the first thread requesting them, while the
+ * others wait for them. The smoothed images are only read once computed;
+ * a thread connecting one to a pipeline should graft it into an image of
+ * its own, since the pipeline sets the requested region of its inputs.
+ *
+ * \sa DiscreteGaussianImageFilter
+ * \sa ImageRegistrationMethodv4
+ * \sa SharedMultiResolutionPyramidImageFilter
+ *
+ * \ingroup ITKRegistrationCommon
+ */
+template< typename TImage >
+class SharedImagePyramid:
+  public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedImagePyramid          Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( SharedImagePyramid, Object );
+
+  /** Type of the images. */
+  typedef TImage                               ImageType;
+  typedef typename ImageType::ConstPointer     ImageConstPointer;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, ImageType::ImageDimension );
+
+  /** Type of the variances of the smoothing, per dimension. */
+  typedef FixedArray< double, itkGetStaticConstMacro( ImageDimension ) > VarianceType;
+  typedef std::vector< VarianceType >                                   VarianceContainerType;
+
+  /** Set/Get the maximum error of the truncation of the Gaussian kernels.
+   * Changing it discards the smoothed images. Defaults to 0.01.
+   * \sa DiscreteGaussianImageFilter::SetMaximumError */
+  void SetMaximumError( const double maximumError );
+  itkGetConstMacro( MaximumError, double );
+
+  /** Set/Get the number of threads of the smoothing. Defaults to the
+   * global default number of threads. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Compute the smoothed images of \c image for the given variances,
+   * which are in physical units if \c useImageSpacing is true, and in
+   * pixels otherwise. The variances are processed by increasing order,
+   * whatever their order in the container. */
+  void ComputeSmoothedImages( const ImageType * image, const VarianceContainerType & variances,
+                              const bool useImageSpacing );
+
+  /** Get the image smoothed with the given variance, computing it first if
+   * needed. The returned pointer keeps the smoothed image alive if the
+   * pyramid discards it in the mean time. */
+  ImageConstPointer GetSmoothedImage( const ImageType * image, const VarianceType & variance,
+                                      const bool useImageSpacing );
+
+  /** Get the number of smoothed images kept by the pyramid. */
+  SizeValueType GetNumberOfSmoothedImages() const;
+
+  /** Discard the smoothed images of an image, and of the images grafted
+   * from it. */
+  void RemoveSmoothedImages( const ImageType * image );
+
+  /** Discard all the smoothed images. */
+  void Clear();
+
+protected:
+  SharedImagePyramid();
+  virtual ~SharedImagePyramid() {}
+
+  virtual void PrintSelf( std::ostream & os, Indent indent ) const ITK_OVERRIDE;
+
+private:
+  SharedImagePyramid( const Self & ); //purposely not implemented
+  void operator=( const Self & );     //purposely not implemented
+
+  /** Order the variances by increasing sum, so that each variance comes
+   * after the variances smaller than it in every dimension. */
+  static bool VarianceLess( const VarianceType & variance1, const VarianceType & variance2 );
+
+  /** Whether two images are the same image, or share their buffer and
+   * their geometry, e.g. because one is grafted from the other. */
+  static bool IsSameImage( const ImageType * image1, const ImageType * image2 );
+
+  /** Compute, or find, the image smoothed with the given variance. The
+   * mutex must be locked. */
+  const ImageType * ComputeSmoothedImage( const ImageType * image, const VarianceType & variance,
+                                          const bool useImageSpacing );
+
+  /** Discard the smoothed images of an image which was modified after they
+   * were computed. The mutex must be locked. */
+  void RemoveOutdatedSmoothedImages( const ImageType * image );
+
+  struct EntryType
+    {
+    ImageConstPointer Image;
+    VarianceType      Variance;
+    bool              UseImageSpacing;
+    ImageConstPointer SmoothedImage;
+    TimeStamp         ComputeTime;
+    };
+
+  std::vector< EntryType >      m_Entries;
+  double                        m_MaximumError;
+  ThreadIdType                  m_NumberOfThreads;
+  mutable SimpleFastMutexLock   m_Mutex;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSharedImagePyramid.hxx"
+#endif
+
+#endif
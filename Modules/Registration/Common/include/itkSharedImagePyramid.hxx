@@ -0,0 +1,259 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSharedImagePyramid_hxx
+#define itkSharedImagePyramid_hxx
+
+#include "itkSharedImagePyramid.h"
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkMutexLockHolder.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template< typename TImage >
+SharedImagePyramid< TImage >
+::SharedImagePyramid() :
+  m_MaximumError( 0.01 ),
+  m_NumberOfThreads( MultiThreader::GetGlobalDefaultNumberOfThreads() )
+{
+}
+
+template< typename TImage >
+void
+SharedImagePyramid< TImage >
+::SetMaximumError( const double maximumError )
+{
+  MutexLockHolder< SimpleFastMutexLock > holder( this->m_Mutex );
+  if( this->m_MaximumError != maximumError )
+    {
+    this->m_MaximumError = maximumError;
+    this->m_Entries.clear();
+    this->Modified();
+    }
+}
+
+template< typename TImage >
+bool
+SharedImagePyramid< TImage >
+::VarianceLess( const VarianceType & variance1, const VarianceType & variance2 )
+{
+  double sum1 = 0.0;
+  double sum2 = 0.0;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    sum1 += variance1[d];
+    sum2 += variance2[d];
+    }
+  return sum1 < sum2;
+}
+
+template< typename TImage >
+bool
+SharedImagePyramid< TImage >
+::IsSameImage( const ImageType * image1, const ImageType * image2 )
+{
+  if( image1 == image2 )
+    {
+    return true;
+    }
+  return image1->GetBufferPointer() != ITK_NULLPTR
+    && image1->GetBufferPointer() == image2->GetBufferPointer()
+    && image1->GetBufferedRegion() == image2->GetBufferedRegion()
+    && image1->GetLargestPossibleRegion() == image2->GetLargestPossibleRegion()
+    && image1->GetSpacing() == image2->GetSpacing()
+    && image1->GetOrigin() == image2->GetOrigin()
+    && image1->GetDirection() == image2->GetDirection();
+}
+
+template< typename TImage >
+void
+SharedImagePyramid< TImage >
+::ComputeSmoothedImages( const ImageType * image, const VarianceContainerType & variances, const bool useImageSpacing )
+{
+  VarianceContainerType sortedVariances( variances );
+  std::stable_sort( sortedVariances.begin(), sortedVariances.end(), Self::VarianceLess );
+
+  MutexLockHolder< SimpleFastMutexLock > holder( this->m_Mutex );
+  this->RemoveOutdatedSmoothedImages( image );
+  for( typename VarianceContainerType::const_iterator it = sortedVariances.begin(); it != sortedVariances.end(); ++it )
+    {
+    this->ComputeSmoothedImage( image, *it, useImageSpacing );
+    }
+}
+
+template< typename TImage >
+typename SharedImagePyramid< TImage >::ImageConstPointer
+SharedImagePyramid< TImage >
+::GetSmoothedImage( const ImageType * image, const VarianceType & variance, const bool useImageSpacing )
+{
+  MutexLockHolder< SimpleFastMutexLock > holder( this->m_Mutex );
+  this->RemoveOutdatedSmoothedImages( image );
+  return this->ComputeSmoothedImage( image, variance, useImageSpacing );
+}
+
+template< typename TImage >
+const typename SharedImagePyramid< TImage >::ImageType *
+SharedImagePyramid< TImage >
+::ComputeSmoothedImage( const ImageType * image, const VarianceType & variance, const bool useImageSpacing )
+{
+  if( image == ITK_NULLPTR )
+    {
+    itkExceptionMacro( "The image to smooth is not set." );
+    }
+
+  // Find the smoothed image with the same variance, or with the largest
+  // variance which is smaller in every dimension.
+  const ImageType * sourceImage = image;
+  VarianceType      sourceVariance;
+  sourceVariance.Fill( 0.0 );
+  double            largestSum = 0.0;
+  for( typename std::vector< EntryType >::const_iterator it = this->m_Entries.begin(); it != this->m_Entries.end(); ++it )
+    {
+    if( it->UseImageSpacing != useImageSpacing || !Self::IsSameImage( it->Image, image ) )
+      {
+      continue;
+      }
+    if( it->Variance == variance )
+      {
+      return it->SmoothedImage.GetPointer();
+      }
+    bool   isSmaller = true;
+    double sum = 0.0;
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      isSmaller = isSmaller && it->Variance[d] <= variance[d];
+      sum += it->Variance[d];
+      }
+    if( isSmaller && sum > largestSum )
+      {
+      sourceImage = it->SmoothedImage.GetPointer();
+      sourceVariance = it->Variance;
+      largestSum = sum;
+      }
+    }
+
+  VarianceType differenceVariance;
+  bool         isNull = true;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    differenceVariance[d] = variance[d] - sourceVariance[d];
+    isNull = isNull && variance[d] == 0.0;
+    }
+  if( isNull )
+    {
+    return image;
+    }
+
+  // The smoothing reads a graft of the source image, so that the smoothed
+  // images already handed out are not modified by its pipeline.
+  typename ImageType::Pointer inputImage = ImageType::New();
+  inputImage->Graft( sourceImage );
+
+  typedef DiscreteGaussianImageFilter< ImageType, ImageType > SmoothingFilterType;
+  typename SmoothingFilterType::Pointer smoothingFilter = SmoothingFilterType::New();
+  smoothingFilter->SetUseImageSpacing( useImageSpacing );
+  smoothingFilter->SetVariance( differenceVariance );
+  smoothingFilter->SetMaximumError( this->m_MaximumError );
+  smoothingFilter->SetNumberOfThreads( this->m_NumberOfThreads );
+  smoothingFilter->SetInput( inputImage );
+
+  typename ImageType::Pointer smoothedImage = smoothingFilter->GetOutput();
+  smoothedImage->Update();
+  smoothedImage->DisconnectPipeline();
+
+  EntryType entry;
+  entry.Image = image;
+  entry.Variance = variance;
+  entry.UseImageSpacing = useImageSpacing;
+  entry.SmoothedImage = smoothedImage;
+  entry.ComputeTime.Modified();
+  this->m_Entries.push_back( entry );
+
+  return smoothedImage.GetPointer();
+}
+
+template< typename TImage >
+void
+SharedImagePyramid< TImage >
+::RemoveOutdatedSmoothedImages( const ImageType * image )
+{
+  typename std::vector< EntryType >::iterator last = this->m_Entries.begin();
+  for( typename std::vector< EntryType >::iterator it = this->m_Entries.begin(); it != this->m_Entries.end(); ++it )
+    {
+    if( it->Image != image || image->GetMTime() < it->ComputeTime.GetMTime() )
+      {
+      *last = *it;
+      ++last;
+      }
+    }
+  this->m_Entries.erase( last, this->m_Entries.end() );
+}
+
+template< typename TImage >
+SizeValueType
+SharedImagePyramid< TImage >
+::GetNumberOfSmoothedImages() const
+{
+  MutexLockHolder< SimpleFastMutexLock > holder( this->m_Mutex );
+  return static_cast< SizeValueType >( this->m_Entries.size() );
+}
+
+template< typename TImage >
+void
+SharedImagePyramid< TImage >
+::RemoveSmoothedImages( const ImageType * image )
+{
+  MutexLockHolder< SimpleFastMutexLock > holder( this->m_Mutex );
+  typename std::vector< EntryType >::iterator last = this->m_Entries.begin();
+  for( typename std::vector< EntryType >::iterator it = this->m_Entries.begin(); it != this->m_Entries.end(); ++it )
+    {
+    if( !Self::IsSameImage( it->Image, image ) )
+      {
+      *last = *it;
+      ++last;
+      }
+    }
+  this->m_Entries.erase( last, this->m_Entries.end() );
+}
+
+template< typename TImage >
+void
+SharedImagePyramid< TImage >
+::Clear()
+{
+  MutexLockHolder< SimpleFastMutexLock > holder( this->m_Mutex );
+  this->m_Entries.clear();
+}
+
+template< typename TImage >
+void
+SharedImagePyramid< TImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "MaximumError: " << this->m_MaximumError << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfSmoothedImages: " << this->GetNumberOfSmoothedImages() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
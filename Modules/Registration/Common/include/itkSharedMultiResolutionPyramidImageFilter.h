@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSharedMultiResolutionPyramidImageFilter_h
+#define itkSharedMultiResolutionPyramidImageFilter_h
+
+#include "itkMultiResolutionPyramidImageFilter.h"
+#include "itkSharedImagePyramid.h"
+
+namespace itk
+{
+/** \class SharedMultiResolutionPyramidImageFilter
+ * \brief Creates a multi-resolution pyramid from the smoothed images of a
+ * SharedImagePyramid.
+ *
+ * SharedMultiResolutionPyramidImageFilter creates the same levels as
+ * MultiResolutionPyramidImageFilter, but takes the input image smoothed
+ * with the variance (shrink factor / 2)^2 of each level from a
+ * SharedImagePyramid, before downsampling it. The smoothed images are
+ * computed incrementally, by increasing variance, and are shared by all the
+ * filters using the same pyramid: multi-resolution registrations of many
+ * images to the same fixed image smooth it only once, when their fixed
+ * image pyramids share the same SharedImagePyramid.
+ *
+ * The maximum error of the smoothing is the one of the shared pyramid,
+ * and the MaximumError of the filter is ignored. Since the smoothing is
+ * incremental, the outputs differ slightly from those of
+ * MultiResolutionPyramidImageFilter.
+ *
+ * Each filter has its own shared pyramid by default.
+ *
+ * \sa MultiResolutionPyramidImageFilter
+ * \sa MultiResolutionImageRegistrationMethod
+ *
+ * \ingroup PyramidImageFilter MultiThreaded
+ * \ingroup ITKRegistrationCommon
+ */
+template<
+  typename TInputImage,
+  typename TOutputImage
+  >
+class SharedMultiResolutionPyramidImageFilter:
+  public MultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedMultiResolutionPyramidImageFilter Self;
+  typedef MultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+  Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SharedMultiResolutionPyramidImageFilter,
+               MultiResolutionPyramidImageFilter);
+
+  /** ImageDimension enumeration. */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      Superclass::ImageDimension);
+
+  /** Inherit types from the superclass.. */
+  typedef typename Superclass::InputImageType         InputImageType;
+  typedef typename Superclass::OutputImageType        OutputImageType;
+  typedef typename Superclass::InputImagePointer      InputImagePointer;
+  typedef typename Superclass::OutputImagePointer     OutputImagePointer;
+  typedef typename Superclass::InputImageConstPointer InputImageConstPointer;
+
+  /** Type of the pyramid of smoothed input images. */
+  typedef SharedImagePyramid< InputImageType >        SharedImagePyramidType;
+  typedef typename SharedImagePyramidType::Pointer    SharedImagePyramidPointer;
+
+  /** Set/Get the pyramid of smoothed input images. */
+  itkSetObjectMacro(SharedImagePyramid, SharedImagePyramidType);
+  itkGetModifiableObjectMacro(SharedImagePyramid, SharedImagePyramidType);
+
+  /** The smoothed images of the shared pyramid are computed on the whole
+   * input image, which is thus requested entirely.
+   * \sa ProcessObject::GenerateInputRequestedRegion() */
+  virtual void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+protected:
+  SharedMultiResolutionPyramidImageFilter();
+  ~SharedMultiResolutionPyramidImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** Generate the output data. */
+  void GenerateData() ITK_OVERRIDE;
+
+private:
+  SharedMultiResolutionPyramidImageFilter(const Self &); //purposely not
+                                                         // implemented
+  void operator=(const Self &);                          //purposely not
+                                                         // implemented
+
+  SharedImagePyramidPointer m_SharedImagePyramid;
+};
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSharedMultiResolutionPyramidImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,186 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSharedMultiResolutionPyramidImageFilter_hxx
+#define itkSharedMultiResolutionPyramidImageFilter_hxx
+
+#include "itkSharedMultiResolutionPyramidImageFilter.h"
+#include "itkCastImageFilter.h"
+#include "itkIdentityTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkResampleImageFilter.h"
+#include "itkShrinkImageFilter.h"
+
+#include "vnl/vnl_math.h"
+
+namespace itk
+{
+/**
+ * Constructor
+ */
+template< typename TInputImage, typename TOutputImage >
+SharedMultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+::SharedMultiResolutionPyramidImageFilter()
+{
+  m_SharedImagePyramid = SharedImagePyramidType::New();
+}
+
+/**
+ * GenerateData
+ */
+template< typename TInputImage, typename TOutputImage >
+void
+SharedMultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  if ( !m_SharedImagePyramid )
+    {
+    itkExceptionMacro(<< "The shared image pyramid is not set.");
+    }
+
+  // Get the input pointer
+  InputImageConstPointer inputPtr = this->GetInput();
+
+  // Smooth the input for all the levels at once, so that the pyramid
+  // computes them incrementally
+  const unsigned int numberOfLevels = this->GetNumberOfLevels();
+  typename SharedImagePyramidType::VarianceContainerType variances( numberOfLevels );
+
+  unsigned int ilevel, idim;
+  for ( ilevel = 0; ilevel < numberOfLevels; ilevel++ )
+    {
+    for ( idim = 0; idim < ImageDimension; idim++ )
+      {
+      variances[ilevel][idim] = vnl_math_sqr( 0.5
+                                              * static_cast< float >( this->m_Schedule[ilevel][idim] ) );
+      }
+    }
+  m_SharedImagePyramid->ComputeSmoothedImages(inputPtr, variances, false);
+
+  // Create caster and resampleShrinker filters
+  typedef CastImageFilter< TInputImage, TOutputImage > CasterType;
+
+  typedef ImageToImageFilter< TOutputImage, TOutputImage >  ImageToImageType;
+  typedef ResampleImageFilter< TOutputImage, TOutputImage > ResampleShrinkerType;
+  typedef ShrinkImageFilter< TOutputImage, TOutputImage >   ShrinkerType;
+
+  typename CasterType::Pointer caster = CasterType::New();
+
+  typename ImageToImageType::Pointer shrinkerFilter;
+  //
+  // only one of these pointers is going to be valid, depending on the
+  // value of UseShrinkImageFilter flag
+  typename ResampleShrinkerType::Pointer resampleShrinker;
+  typename ShrinkerType::Pointer shrinker;
+
+  if ( this->GetUseShrinkImageFilter() )
+    {
+    shrinker = ShrinkerType::New();
+    shrinkerFilter = shrinker.GetPointer();
+    }
+  else
+    {
+    resampleShrinker = ResampleShrinkerType::New();
+    typedef itk::LinearInterpolateImageFunction< OutputImageType, double >
+    LinearInterpolatorType;
+    typename LinearInterpolatorType::Pointer interpolator =
+      LinearInterpolatorType::New();
+    resampleShrinker->SetInterpolator(interpolator);
+    resampleShrinker->SetDefaultPixelValue(0);
+    shrinkerFilter = resampleShrinker.GetPointer();
+    }
+  shrinkerFilter->SetInput( caster->GetOutput() );
+
+  unsigned int factors[ImageDimension];
+
+  for ( ilevel = 0; ilevel < numberOfLevels; ilevel++ )
+    {
+    this->UpdateProgress( static_cast< float >( ilevel )
+                          / static_cast< float >( numberOfLevels ) );
+
+    // Allocate memory for each output
+    OutputImagePointer outputPtr = this->GetOutput(ilevel);
+    outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
+    outputPtr->Allocate();
+
+    // compute shrink factors
+    for ( idim = 0; idim < ImageDimension; idim++ )
+      {
+      factors[idim] = this->m_Schedule[ilevel][idim];
+      }
+
+    if ( !this->GetUseShrinkImageFilter() )
+      {
+      typedef itk::IdentityTransform< double, OutputImageType::ImageDimension >
+      IdentityTransformType;
+      typename IdentityTransformType::Pointer identityTransform =
+        IdentityTransformType::New();
+      resampleShrinker->SetOutputParametersFromImage(outputPtr);
+      resampleShrinker->SetTransform(identityTransform);
+      }
+    else
+      {
+      shrinker->SetShrinkFactors(factors);
+      }
+
+    // use mini-pipeline to downsample the smoothed image of the level,
+    // grafted so that the shared smoothed image is not modified
+    InputImagePointer smoothedImage = InputImageType::New();
+    smoothedImage->Graft( m_SharedImagePyramid->GetSmoothedImage(inputPtr, variances[ilevel], false) );
+    caster->SetInput( smoothedImage );
+
+    shrinkerFilter->GraftOutput(outputPtr);
+
+    // force to always update in case shrink factors are the same
+    shrinkerFilter->Modified();
+    shrinkerFilter->UpdateLargestPossibleRegion();
+    this->GraftNthOutput( ilevel, shrinkerFilter->GetOutput() );
+    }
+}
+
+/**
+ * GenerateInputRequestedRegion
+ */
+template< typename TInputImage, typename TOutputImage >
+void
+SharedMultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+{
+  InputImagePointer inputPtr =
+    const_cast< InputImageType * >( this->GetInput() );
+  if ( !inputPtr )
+    {
+    itkExceptionMacro(<< "Input has not been set.");
+    }
+  inputPtr->SetRequestedRegionToLargestPossibleRegion();
+}
+
+/**
+ * PrintSelf method
+ */
+template< typename TInputImage, typename TOutputImage >
+void
+SharedMultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "SharedImagePyramid: " << m_SharedImagePyramid.GetPointer() << std::endl;
+}
+} // namespace itk
+
+#endif
@@ -0,0 +1,301 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSharedMultiResolutionPyramidImageFilter.h"
+#include "itkMultiResolutionImageRegistrationMethod.h"
+#include "itkTranslationTransform.h"
+#include "itkMeanSquaresImageToImageMetric.h"
+#include "itkRegularStepGradientDescentOptimizer.h"
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMultiThreader.h"
+
+/**
+ * Check that the shared image pyramid smooths the images incrementally
+ * like a direct smoothing, once for all the users, including concurrent
+ * ones, and that the registrations using it through the shared
+ * multi-resolution pyramid filter share the smoothing of the fixed image.
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+typedef itk::Image< float, Dimension >         ImageType;
+typedef itk::SharedImagePyramid< ImageType >   PyramidType;
+
+ImageType::Pointer SharedImagePyramidTestImage( double shiftX, double shiftY )
+{
+  ImageType::SizeType size = { { 64, 64 } };
+  ImageType::Pointer  image = ImageType::New();
+  image->SetRegions( size );
+  ImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 1.5;
+  image->SetSpacing( spacing );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               x = index[0] - 32.0 - shiftX;
+    const double               y = index[1] - 32.0 - shiftY / spacing[1];
+    it.Set( 100.0 * std::exp( -( x * x + y * y ) / 120.0 ) + ( index[0] * 7 + index[1] * 13 ) % 11 );
+    }
+  return image;
+}
+
+double SharedImagePyramidMaximumDifference( const ImageType * image1, const ImageType * image2 )
+{
+  double maximumDifference = 0.0;
+  itk::ImageRegionConstIterator< ImageType > it1( image1, image1->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ImageType > it2( image2, image2->GetLargestPossibleRegion() );
+  for( ; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    maximumDifference = std::max( maximumDifference, static_cast< double >( std::abs( it1.Get() - it2.Get() ) ) );
+    }
+  return maximumDifference;
+}
+
+struct SharedImagePyramidThreadData
+{
+  PyramidType *             Pyramid;
+  const ImageType *         Image;
+  PyramidType::VarianceType Variance;
+  ImageType::ConstPointer   SmoothedImages[4];
+};
+
+ITK_THREAD_RETURN_TYPE SharedImagePyramidThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info = static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  SharedImagePyramidThreadData *         data = static_cast< SharedImagePyramidThreadData * >( info->UserData );
+  data->SmoothedImages[info->ThreadID] = data->Pyramid->GetSmoothedImage( data->Image, data->Variance, true );
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/** Register a shifted image to the fixed image with the given shared
+ * pyramid for the fixed image, and return the translation. */
+itk::TranslationTransform< double, Dimension >::ParametersType
+SharedImagePyramidRegistration( ImageType * fixedImage, ImageType * movingImage, PyramidType * fixedImagePyramid,
+                                PyramidType * movingImagePyramid )
+{
+  typedef itk::TranslationTransform< double, Dimension >                   TransformType;
+  typedef itk::RegularStepGradientDescentOptimizer                         OptimizerType;
+  typedef itk::MeanSquaresImageToImageMetric< ImageType, ImageType >       MetricType;
+  typedef itk::LinearInterpolateImageFunction< ImageType, double >         InterpolatorType;
+  typedef itk::MultiResolutionImageRegistrationMethod< ImageType, ImageType > RegistrationType;
+
+  TransformType::Pointer    transform = TransformType::New();
+  OptimizerType::Pointer    optimizer = OptimizerType::New();
+  MetricType::Pointer       metric = MetricType::New();
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  RegistrationType::Pointer registration = RegistrationType::New();
+
+  optimizer->SetMaximumStepLength( 2.0 );
+  optimizer->SetMinimumStepLength( 0.01 );
+  optimizer->SetNumberOfIterations( 100 );
+
+  registration->SetMetric( metric );
+  registration->SetOptimizer( optimizer );
+  registration->SetTransform( transform );
+  registration->SetInterpolator( interpolator );
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+  registration->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  registration->SetFixedSharedImagePyramid( fixedImagePyramid );
+  registration->SetMovingSharedImagePyramid( movingImagePyramid );
+  registration->SetNumberOfLevels( 3 );
+  TransformType::ParametersType initialParameters( transform->GetNumberOfParameters() );
+  initialParameters.Fill( 0.0 );
+  registration->SetInitialTransformParameters( initialParameters );
+
+  registration->Update();
+
+  return registration->GetLastTransformParameters();
+}
+}
+
+int itkSharedImagePyramidTest(int, char* [])
+{
+  ImageType::Pointer image = SharedImagePyramidTestImage( 0.0, 0.0 );
+
+  // the smoothed images are computed by increasing variance, and are close
+  // to the direct smoothings
+  PyramidType::Pointer pyramid = PyramidType::New();
+  PyramidType::VarianceContainerType variances( 3 );
+  variances[0].Fill( 4.0 );
+  variances[1].Fill( 1.0 );
+  variances[2].Fill( 0.0 );
+  pyramid->ComputeSmoothedImages( image, variances, true );
+  if( pyramid->GetNumberOfSmoothedImages() != 2 )
+    {
+    std::cerr << "Wrong number of smoothed images: " << pyramid->GetNumberOfSmoothedImages() << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( pyramid->GetSmoothedImage( image, variances[2], true ) != image.GetPointer() )
+    {
+    std::cerr << "The image smoothed with a null variance is not the image." << std::endl;
+    return EXIT_FAILURE;
+    }
+  ImageType::ConstPointer smoothedImage = pyramid->GetSmoothedImage( image, variances[0], true );
+  pyramid->ComputeSmoothedImages( image, variances, true );
+  if( pyramid->GetNumberOfSmoothedImages() != 2 || pyramid->GetSmoothedImage( image, variances[0], true ) != smoothedImage )
+    {
+    std::cerr << "The smoothed images were computed again." << std::endl;
+    return EXIT_FAILURE;
+    }
+  // an image grafted from the image shares its smoothed images
+  ImageType::Pointer graftedImage = ImageType::New();
+  graftedImage->Graft( image );
+  if( pyramid->GetSmoothedImage( graftedImage, variances[0], true ) != smoothedImage ||
+      pyramid->GetNumberOfSmoothedImages() != 2 )
+    {
+    std::cerr << "The smoothed images of the grafted image were computed again." << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    typedef itk::DiscreteGaussianImageFilter< ImageType, ImageType > SmoothingFilterType;
+    SmoothingFilterType::Pointer smoothingFilter = SmoothingFilterType::New();
+    smoothingFilter->SetVariance( variances[i][0] );
+    smoothingFilter->SetMaximumError( 0.01 );
+    smoothingFilter->SetInput( image );
+    smoothingFilter->Update();
+    const double difference =
+      SharedImagePyramidMaximumDifference( smoothingFilter->GetOutput(), pyramid->GetSmoothedImage( image, variances[i], true ) );
+    std::cout << "Variance " << variances[i] << ": maximum difference " << difference << std::endl;
+    // the incremental smoothing differs most at the corners, where the
+    // boundary conditions of the two smoothings add up
+    if( difference > 1.0 )
+      {
+      std::cerr << "The smoothed image differs from the direct smoothing by " << difference << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the smoothed images of a modified image are discarded
+  image->Modified();
+  if( pyramid->GetSmoothedImage( image, variances[0], true ).IsNull() || pyramid->GetNumberOfSmoothedImages() != 1 )
+    {
+    std::cerr << "The smoothed images of the modified image were not discarded." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // concurrent users share the same smoothed image
+  SharedImagePyramidThreadData threadData;
+  threadData.Pyramid = pyramid;
+  threadData.Image = image;
+  threadData.Variance.Fill( 2.25 );
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( 4 );
+  threader->SetSingleMethod( SharedImagePyramidThreaderCallback, &threadData );
+  threader->SingleMethodExecute();
+  for( itk::ThreadIdType i = 1; i < threader->GetNumberOfThreads(); ++i )
+    {
+    if( threadData.SmoothedImages[i] != threadData.SmoothedImages[0] )
+      {
+      std::cerr << "The threads got different smoothed images." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if( pyramid->GetNumberOfSmoothedImages() != 2 )
+    {
+    std::cerr << "Wrong number of smoothed images after the concurrent smoothing: "
+              << pyramid->GetNumberOfSmoothedImages() << std::endl;
+    return EXIT_FAILURE;
+    }
+  pyramid->Print( std::cout );
+
+  // the shared multi-resolution pyramid filter gives the levels of the
+  // multi-resolution pyramid filter
+  typedef itk::MultiResolutionPyramidImageFilter< ImageType, ImageType >       PyramidFilterType;
+  typedef itk::SharedMultiResolutionPyramidImageFilter< ImageType, ImageType > SharedPyramidFilterType;
+  PyramidType::Pointer filterPyramid = PyramidType::New();
+  filterPyramid->SetMaximumError( 0.1 );
+  for( unsigned int useShrinkImageFilter = 0; useShrinkImageFilter < 2; ++useShrinkImageFilter )
+    {
+    PyramidFilterType::Pointer pyramidFilter = PyramidFilterType::New();
+    pyramidFilter->SetNumberOfLevels( 3 );
+    pyramidFilter->SetUseShrinkImageFilter( useShrinkImageFilter != 0 );
+    pyramidFilter->SetInput( image );
+    pyramidFilter->Update();
+
+    SharedPyramidFilterType::Pointer sharedPyramidFilter = SharedPyramidFilterType::New();
+    sharedPyramidFilter->SetSharedImagePyramid( filterPyramid );
+    sharedPyramidFilter->SetNumberOfLevels( 3 );
+    sharedPyramidFilter->SetUseShrinkImageFilter( useShrinkImageFilter != 0 );
+    sharedPyramidFilter->SetInput( image );
+    sharedPyramidFilter->Update();
+
+    for( unsigned int level = 0; level < 3; ++level )
+      {
+      const ImageType * output = pyramidFilter->GetOutput( level );
+      const ImageType * sharedOutput = sharedPyramidFilter->GetOutput( level );
+      if( output->GetLargestPossibleRegion() != sharedOutput->GetLargestPossibleRegion() ||
+          output->GetSpacing() != sharedOutput->GetSpacing() || output->GetOrigin() != sharedOutput->GetOrigin() )
+        {
+        std::cerr << "Wrong geometry of level " << level << std::endl;
+        return EXIT_FAILURE;
+        }
+      const double difference = SharedImagePyramidMaximumDifference( output, sharedOutput );
+      std::cout << "Level " << level << ": maximum difference " << difference << std::endl;
+      if( difference > 1.0 )
+        {
+        std::cerr << "Level " << level << " differs by " << difference << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  if( filterPyramid->GetNumberOfSmoothedImages() != 3 )
+    {
+    std::cerr << "The shared pyramid filters did not share the smoothed images." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // registrations of two images to the same fixed image smooth it once
+  ImageType::Pointer   fixedImage = SharedImagePyramidTestImage( 0.0, 0.0 );
+  PyramidType::Pointer fixedImagePyramid = PyramidType::New();
+  const double         shifts[2][2] = { { 3.0, -2.0 }, { -2.0, 1.5 } };
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    ImageType::Pointer   movingImage = SharedImagePyramidTestImage( shifts[i][0], shifts[i][1] );
+    PyramidType::Pointer movingImagePyramid = PyramidType::New();
+    const itk::TranslationTransform< double, Dimension >::ParametersType parameters =
+      SharedImagePyramidRegistration( fixedImage, movingImage, fixedImagePyramid, movingImagePyramid );
+    std::cout << "Registration " << i << ": translation " << parameters << std::endl;
+    if( std::abs( parameters[0] - shifts[i][0] ) > 0.2 || std::abs( parameters[1] - shifts[i][1] ) > 0.2 )
+      {
+      std::cerr << "Wrong translation " << parameters << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( fixedImagePyramid->GetNumberOfSmoothedImages() != 3 )
+      {
+      std::cerr << "Wrong number of smoothed fixed images: " << fixedImagePyramid->GetNumberOfSmoothedImages() << std::endl;
+      return EXIT_FAILURE;
+      }
+    // the smoothed moving images are released by the registration
+    if( movingImagePyramid->GetNumberOfSmoothedImages() != 0 )
+      {
+      std::cerr << "The smoothed moving images were not released: "
+                << movingImagePyramid->GetNumberOfSmoothedImages() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
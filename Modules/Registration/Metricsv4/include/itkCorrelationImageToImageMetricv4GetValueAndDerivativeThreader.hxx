@@ -204,12 +204,15 @@ CorrelationImageToImageMetricv4GetValueAndDerivativeThreader<TDomainPartitioner,
 
   try
     {
-    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
-    if( pointIsValid &&
-        this->m_CorrelationAssociate->GetComputeDerivative() &&
+    if( this->m_CorrelationAssociate->GetComputeDerivative() &&
         this->m_CorrelationAssociate->GetGradientSourceIncludesMoving() )
       {
-      this->m_CorrelationAssociate->ComputeMovingImageGradientAtPoint( mappedMovingPoint, mappedMovingImageGradient );
+      pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateMovingPointAndGradient( virtualPoint, mappedMovingPoint,
+                                                                                               mappedMovingPixelValue, mappedMovingImageGradient );
+      }
+    else
+      {
+      pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
       }
     }
   catch( ExceptionObject & exc )
@@ -31,6 +31,7 @@
 #include "itkPointSet.h"
 #include "itkDefaultConvertPixelTraits.h"
 #include "itkDefaultImageToImageMetricTraitsv4.h"
+#include "itkValueAndGradientImageCache.h"
 
 namespace itk
 {
@@ -79,6 +80,16 @@ namespace itk
  *  SetFixedImageGradientCalculator and/or SetMovingImageGradientCalculator.
  *
  * Both image gradient calculation methods are threaded.
+ *
+ * When the moving image gradients are computed with a gradient image filter
+ * and both the moving image and its gradients are linearly interpolated,
+ * \c UseMovingImageValueAndGradientImage can be set to interleave them in a
+ * single image during \c Initialize. The value and gradient at a moving point
+ * are then interpolated together, with a single access to the neighbouring
+ * pixels, giving the same results. This value and gradient image is stored
+ * in a ValueAndGradientImageCache, which can be shared by the metrics using
+ * the same moving image and gradient image, e.g. by the metrics of an
+ * ObjectToObjectMultiMetricv4, so that it is only computed once.
  * Generally it is not recommended to use different image gradient methods for
  * the fixed and moving images because the methods return different results.
  *
@@ -430,6 +441,13 @@ public:
   /** Get the virtual domain sampling point set */
   itkGetModifiableObjectMacro(VirtualSampledPointSet, VirtualPointSetType);
 
+  /** Map the fixed point set samples to the virtual domain. This is done
+   * by \c Initialize, and can be done again after changing the sampled
+   * points, e.g. to draw new samples at each iteration of an optimizer,
+   * without initializing the metric again. The memory of the virtual
+   * point set is reused. */
+  void MapFixedSampledPointSetToVirtual();
+
   /** Set/Get the gradient filter */
   itkSetObjectMacro( FixedImageGradientFilter, FixedImageGradientFilterType );
   itkGetModifiableObjectMacro(FixedImageGradientFilter, FixedImageGradientFilterType );
@@ -461,8 +479,8 @@ public:
   /** Set number of threads to use. This the maximum number of threads to use
    * when multithreaded.  The actual number of threads used (may be less than
    * this value) can be obtained with \c GetNumberOfThreadsUsed. */
-  virtual void SetMaximumNumberOfThreads( const ThreadIdType threads );
-  virtual ThreadIdType GetMaximumNumberOfThreads() const;
+  virtual void SetMaximumNumberOfThreads( const ThreadIdType threads ) ITK_OVERRIDE;
+  virtual ThreadIdType GetMaximumNumberOfThreads() const ITK_OVERRIDE;
 
   /**
     * Finalize the per-thread components for computing
@@ -479,6 +497,34 @@ public:
   /** Get Moving Gradient Image. */
   itkGetModifiableObjectMacro(MovingImageGradientImage, MovingImageGradientImageType);
 
+  /** Type of the cache of the images interleaving the moving image values
+   * and gradients. */
+  typedef ValueAndGradientImageCache< MovingImageDimension, InternalComputationValueType >
+                                                         MovingImageValueAndGradientCacheType;
+  typedef typename MovingImageValueAndGradientCacheType::ValueAndGradientImageType
+                                                         MovingImageValueAndGradientImageType;
+
+  /** Set/Get the interpolation of the moving image values and gradients
+   * together, from an image interleaving them. It is only used with a
+   * moving image gradient filter, and linear interpolators for the moving
+   * image and its gradients. False by default, since it uses more memory. */
+  itkSetMacro(UseMovingImageValueAndGradientImage, bool);
+  itkGetConstReferenceMacro(UseMovingImageValueAndGradientImage, bool);
+  itkBooleanMacro(UseMovingImageValueAndGradientImage);
+
+  /** Set/Get the cache storing the moving value and gradient image. */
+  itkSetObjectMacro(MovingImageValueAndGradientCache, MovingImageValueAndGradientCacheType);
+  itkGetModifiableObjectMacro(MovingImageValueAndGradientCache, MovingImageValueAndGradientCacheType);
+
+  /** Share the cache of the moving value and gradient image with other
+   * metrics. */
+  virtual void SetMovingObjectCache( ObjectType * cache ) ITK_OVERRIDE;
+  virtual ObjectType * GetMovingObjectCache() const ITK_OVERRIDE;
+
+  /** Get the image interleaving the moving image values and gradients.
+   * ITK_NULLPTR if it is not used. */
+  itkGetModifiableObjectMacro(MovingImageValueAndGradientImage, MovingImageValueAndGradientImageType);
+
   /** Get number of valid points from most recent update */
   virtual SizeValueType GetNumberOfValidPoints() const ITK_OVERRIDE
     {
@@ -562,6 +608,9 @@ protected:
   typedef LinearInterpolateImageFunction< MovingImageGradientImageType,
                                           CoordinateRepresentationType >
                                                   MovingImageGradientInterpolatorType;
+  typedef LinearInterpolateImageFunction< MovingImageValueAndGradientImageType,
+                                          CoordinateRepresentationType >
+                                                  MovingImageValueAndGradientInterpolatorType;
 
   friend class ImageToImageMetricv4GetValueAndDerivativeThreaderBase< ThreadedImageRegionPartitioner< VirtualImageDimension >, Self >;
   friend class ImageToImageMetricv4GetValueAndDerivativeThreaderBase< ThreadedIndexedContainerPartitioner, Self >;
@@ -601,6 +650,15 @@ protected:
                          MovingImagePointType & mappedMovingPoint,
                          MovingImagePixelType & mappedMovingPixelValue ) const;
 
+  /** Transform a point from VirtualImage domain to MovingImage domain, and
+   * evaluate both the moving image and its gradient. They are interpolated
+   * together from the moving value and gradient image when it is used. */
+  bool TransformAndEvaluateMovingPointAndGradient(
+                         const VirtualPointType & virtualPoint,
+                         MovingImagePointType & mappedMovingPoint,
+                         MovingImagePixelType & mappedMovingPixelValue,
+                         MovingImageGradientType & mappedMovingImageGradient ) const;
+
   /** Compute image derivatives for a Fixed point. */
   virtual void ComputeFixedImageGradientAtPoint( const FixedImagePointType & mappedPoint, FixedImageGradientType & gradient ) const;
 
@@ -617,6 +675,11 @@ protected:
    * to m_MovingImageGradientImage. */
   virtual void ComputeMovingImageGradientFilterImage() const;
 
+  /** Interleave the moving image values and the gradients of
+   * m_MovingImageGradientImage in m_MovingImageValueAndGradientImage,
+   * or get it from the cache if another metric already computed it. */
+  virtual void ComputeMovingImageValueAndGradientImage();
+
   /** Perform the actual threaded processing, using the appropriate
    * GetValueAndDerivativeThreader. Results get written to
    * member vars. This is available as a separate method so it
@@ -669,6 +732,12 @@ protected:
   mutable FixedImageGradientImagePointer    m_FixedImageGradientImage;
   mutable MovingImageGradientImagePointer   m_MovingImageGradientImage;
 
+  /** Interleaved moving image values and gradients, and their cache. */
+  bool                                                          m_UseMovingImageValueAndGradientImage;
+  typename MovingImageValueAndGradientCacheType::Pointer        m_MovingImageValueAndGradientCache;
+  typename MovingImageValueAndGradientImageType::Pointer        m_MovingImageValueAndGradientImage;
+  typename MovingImageValueAndGradientInterpolatorType::Pointer m_MovingImageValueAndGradientInterpolator;
+
   /** Image gradient calculators */
   FixedImageGradientCalculatorPointer   m_FixedImageGradientCalculator;
   MovingImageGradientCalculatorPointer  m_MovingImageGradientCalculator;
@@ -698,9 +767,6 @@ protected:
   void PrintSelf(std::ostream& os, Indent indent) const ITK_OVERRIDE;
 
 private:
-  /** Map the fixed point set samples to the virtual domain */
-  void MapFixedSampledPointSetToVirtual();
-
   /** Transform a point. Avoid cast if possible */
   void LocalTransformPoint(const typename FixedTransformType::OutputPointType &virtualPoint,
                            typename FixedTransformType::OutputPointType &mappedFixedPoint) const
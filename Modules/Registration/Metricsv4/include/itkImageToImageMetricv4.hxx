@@ -24,6 +24,7 @@
 #include "itkCompositeTransform.h"
 #include "itkLinearInterpolateImageFunction.h"
 #include "itkIdentityTransform.h"
+#include "itkImageRegionIterator.h"
 
 namespace itk
 {
@@ -52,6 +53,12 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   /* Interpolators for image gradient filters */
   this->m_FixedImageGradientInterpolator  = FixedImageGradientInterpolatorType::New();
   this->m_MovingImageGradientInterpolator = MovingImageGradientInterpolatorType::New();
+  this->m_MovingImageValueAndGradientInterpolator = MovingImageValueAndGradientInterpolatorType::New();
+
+  /* The moving value and gradient image is not used by default, since it
+   * uses more memory. */
+  this->m_UseMovingImageValueAndGradientImage = false;
+  this->m_MovingImageValueAndGradientCache = MovingImageValueAndGradientCacheType::New();
 
   /* Setup default gradient image function */
   this->m_DefaultFixedImageGradientCalculator = DefaultFixedImageGradientCalculator::New();
@@ -82,6 +89,34 @@ template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, type
 ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
 ::~ImageToImageMetricv4()
 {
+  if( this->m_MovingImageValueAndGradientCache.IsNotNull() )
+    {
+    this->m_MovingImageValueAndGradientCache->RemoveValueAndGradientImage( this );
+    }
+}
+
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+void
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::SetMovingObjectCache( ObjectType * cache )
+{
+  MovingImageValueAndGradientCacheType * valueAndGradientCache = dynamic_cast< MovingImageValueAndGradientCacheType * >( cache );
+  if( valueAndGradientCache != ITK_NULLPTR && valueAndGradientCache != this->m_MovingImageValueAndGradientCache.GetPointer() )
+    {
+    if( this->m_MovingImageValueAndGradientCache.IsNotNull() )
+      {
+      this->m_MovingImageValueAndGradientCache->RemoveValueAndGradientImage( this );
+      }
+    this->SetMovingImageValueAndGradientCache( valueAndGradientCache );
+    }
+}
+
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+typename ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>::ObjectType *
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::GetMovingObjectCache() const
+{
+  return this->m_MovingImageValueAndGradientCache.GetPointer();
 }
 
 template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
@@ -193,6 +228,9 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
     itkDebugMacro("Initialize: ComputeMovingImageGradientFilterImage");
     this->ComputeMovingImageGradientFilterImage();
     }
+
+  /* Interleave the moving image values and gradients. */
+  this->ComputeMovingImageValueAndGradientImage();
 }
 
 template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
@@ -368,6 +406,55 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   return pointIsValid;
 }
 
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+bool
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::TransformAndEvaluateMovingPointAndGradient(
+                         const VirtualPointType & virtualPoint,
+                         MovingImagePointType & mappedMovingPoint,
+                         MovingImagePixelType & mappedMovingPixelValue,
+                         MovingImageGradientType & mappedMovingImageGradient ) const
+{
+  if( this->m_MovingImageValueAndGradientImage.IsNull() )
+    {
+    if( ! this->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue ) )
+      {
+      return false;
+      }
+    this->ComputeMovingImageGradientAtPoint( mappedMovingPoint, mappedMovingImageGradient );
+    return true;
+    }
+
+  mappedMovingPixelValue = NumericTraits<MovingImagePixelType>::ZeroValue();
+
+  typename MovingTransformType::OutputPointType localVirtualPoint;
+  typename MovingTransformType::OutputPointType localMappedMovingPoint;
+
+  localVirtualPoint.CastFrom(virtualPoint);
+  localMappedMovingPoint = this->m_MovingTransform->TransformPoint( localVirtualPoint );
+  mappedMovingPoint.CastFrom(localMappedMovingPoint);
+
+  if ( this->m_MovingImageMask && ! this->m_MovingImageMask->IsInside( mappedMovingPoint ) )
+    {
+    return false;
+    }
+
+  if( ! this->m_MovingImageValueAndGradientInterpolator->IsInsideBuffer( mappedMovingPoint ) )
+    {
+    return false;
+    }
+
+  // A single interpolation gives the value, followed by the gradient.
+  const typename MovingImageValueAndGradientInterpolatorType::OutputType valueAndGradient =
+    this->m_MovingImageValueAndGradientInterpolator->Evaluate( mappedMovingPoint );
+  DefaultConvertPixelTraits<MovingImagePixelType>::SetNthComponent( 0, mappedMovingPixelValue, valueAndGradient[0] );
+  for( ImageDimensionType d = 0; d < MovingImageDimension; ++d )
+    {
+    mappedMovingImageGradient[d] = valueAndGradient[d + 1];
+    }
+  return true;
+}
+
 template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
 void
 ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
@@ -432,6 +519,78 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   this->m_MovingImageGradientInterpolator->SetInputImage( this->m_MovingImageGradientImage );
 }
 
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+void
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::ComputeMovingImageValueAndGradientImage()
+{
+  typedef LinearInterpolateImageFunction< MovingImageType, CoordinateRepresentationType > MovingLinearInterpolatorType;
+  typedef typename MovingImageValueAndGradientImageType::PixelType                       ValueAndGradientPixelType;
+
+  /* The value and gradient image is only used when interpolating it gives
+   * the same values and gradients as the moving interpolator and the moving
+   * gradient interpolator. */
+  bool useValueAndGradientImage = this->m_UseMovingImageValueAndGradientImage
+    && this->GetGradientSourceIncludesMoving() && this->m_UseMovingImageGradientFilter
+    && this->m_MovingImageGradientImage.IsNotNull()
+    && DefaultConvertPixelTraits<MovingImagePixelType>::GetNumberOfComponents() == 1
+    && dynamic_cast< const MovingLinearInterpolatorType * >( this->m_MovingInterpolator.GetPointer() ) != ITK_NULLPTR;
+  if( useValueAndGradientImage )
+    {
+    const MovingImageGradientImageType * gradientImage = this->m_MovingImageGradientImage;
+    useValueAndGradientImage = gradientImage->GetBufferedRegion() == this->m_MovingImage->GetBufferedRegion()
+      && gradientImage->GetOrigin() == this->m_MovingImage->GetOrigin()
+      && gradientImage->GetSpacing() == this->m_MovingImage->GetSpacing()
+      && gradientImage->GetDirection() == this->m_MovingImage->GetDirection();
+    }
+
+  if( ! useValueAndGradientImage )
+    {
+    if( this->m_MovingImageValueAndGradientCache.IsNotNull() )
+      {
+      this->m_MovingImageValueAndGradientCache->RemoveValueAndGradientImage( this );
+      }
+    this->m_MovingImageValueAndGradientImage = ITK_NULLPTR;
+    return;
+    }
+
+  if( this->m_MovingImageValueAndGradientCache.IsNull() )
+    {
+    this->m_MovingImageValueAndGradientCache = MovingImageValueAndGradientCacheType::New();
+    }
+
+  typename MovingImageValueAndGradientImageType::Pointer valueAndGradientImage =
+    this->m_MovingImageValueAndGradientCache->GetValueAndGradientImage( this->m_MovingImage, this->m_MovingImageGradientImage );
+  if( valueAndGradientImage.IsNull() )
+    {
+    itkDebugMacro("Initialize: compute the moving value and gradient image");
+    valueAndGradientImage = MovingImageValueAndGradientImageType::New();
+    valueAndGradientImage->CopyInformation( this->m_MovingImage );
+    valueAndGradientImage->SetRegions( this->m_MovingImage->GetBufferedRegion() );
+    valueAndGradientImage->Allocate();
+
+    ImageRegionConstIterator< MovingImageType >              movingIt( this->m_MovingImage, this->m_MovingImage->GetBufferedRegion() );
+    ImageRegionConstIterator< MovingImageGradientImageType > gradientIt( this->m_MovingImageGradientImage, this->m_MovingImage->GetBufferedRegion() );
+    ImageRegionIterator< MovingImageValueAndGradientImageType > valueAndGradientIt( valueAndGradientImage, this->m_MovingImage->GetBufferedRegion() );
+    ValueAndGradientPixelType valueAndGradient;
+    for( ; ! valueAndGradientIt.IsAtEnd(); ++movingIt, ++gradientIt, ++valueAndGradientIt )
+      {
+      valueAndGradient[0] = DefaultConvertPixelTraits<MovingImagePixelType>::GetNthComponent( 0, movingIt.Get() );
+      const MovingGradientPixelType & gradient = gradientIt.Get();
+      for( ImageDimensionType d = 0; d < MovingImageDimension; ++d )
+        {
+        valueAndGradient[d + 1] = gradient[d];
+        }
+      valueAndGradientIt.Set( valueAndGradient );
+      }
+    }
+
+  this->m_MovingImageValueAndGradientCache->SetValueAndGradientImage( this, this->m_MovingImage, this->m_MovingImageGradientImage,
+                                                                      valueAndGradientImage );
+  this->m_MovingImageValueAndGradientImage = valueAndGradientImage;
+  this->m_MovingImageValueAndGradientInterpolator->SetInputImage( this->m_MovingImageValueAndGradientImage );
+}
+
 template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
 void
 ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
@@ -521,8 +680,16 @@ void
 ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
 ::MapFixedSampledPointSetToVirtual()
 {
-  this->m_VirtualSampledPointSet = VirtualPointSetType::New();
-  this->m_VirtualSampledPointSet->Initialize();
+  if( this->m_VirtualSampledPointSet.IsNull() )
+    {
+    this->m_VirtualSampledPointSet = VirtualPointSetType::New();
+    this->m_VirtualSampledPointSet->Initialize();
+    }
+  else if( this->m_VirtualSampledPointSet->GetPoints() )
+    {
+    // clear the points, keeping their memory
+    this->m_VirtualSampledPointSet->GetPoints()->Initialize();
+    }
 
   typedef typename FixedSampledPointSetType::PointsContainer PointsContainer;
   typename PointsContainer::ConstPointer
@@ -596,6 +763,7 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   os << indent << "ImageToImageMetricv4: " << std::endl
      << indent << "GetUseFixedImageGradientFilter: " << this->GetUseFixedImageGradientFilter() << std::endl
      << indent << "GetUseMovingImageGradientFilter: " << this->GetUseMovingImageGradientFilter() << std::endl
+     << indent << "UseMovingImageValueAndGradientImage: " << this->GetUseMovingImageValueAndGradientImage() << std::endl
      << indent << "UseFloatingPointCorrection: " << this->GetUseFloatingPointCorrection() << std::endl
      << indent << "FloatingPointCorrectionResolution: " << this->GetFloatingPointCorrectionResolution() << std::endl;
 
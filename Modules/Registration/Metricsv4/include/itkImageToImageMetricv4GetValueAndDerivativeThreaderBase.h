@@ -39,6 +39,16 @@ namespace itk
  *  ProcessVirtualPoint on every point in the virtual image domain.  \c
  *  ProcessVirtualPoint calls \c ProcessPoint on each point.
  *
+ *  Derived classes which compute the jacobian of the moving transform
+ *  with \c ComputeMovingTransformJacobian, and only loop over the
+ *  GetCachedNumberOfLocalParameters() columns of it, may set
+ *  \c m_SupportsSparseJacobian. For transforms with global support whose
+ *  jacobian at a point only depends on a few parameters, e.g.
+ *  BSplineTransform, only these parameters are then computed and
+ *  accumulated. The derivatives of each thread are summed in parallel
+ *  over slices of the parameters, so that the reduction scales to
+ *  transforms with millions of parameters.
+ *
  * \ingroup ITKMetricsv4 */
 template < typename TDomainPartitioner, typename TImageToImageMetricv4 >
 class ImageToImageMetricv4GetValueAndDerivativeThreaderBase
@@ -74,6 +84,7 @@ public:
   typedef typename FixedTransformType::OutputPointType               FixedOutputPointType;
   typedef typename ImageToImageMetricv4Type::MovingTransformType     MovingTransformType;
   typedef typename MovingTransformType::OutputPointType              MovingOutputPointType;
+  typedef typename MovingTransformType::NonZeroJacobianIndicesType   NonZeroJacobianIndicesType;
 
   typedef typename ImageToImageMetricv4Type::MeasureType             MeasureType;
   typedef typename ImageToImageMetricv4Type::DerivativeType          DerivativeType;
@@ -162,6 +173,31 @@ protected:
   virtual void StorePointDerivativeResult( const VirtualIndexType & virtualIndex,
                                            const ThreadIdType threadId );
 
+  /** Compute the jacobian of the moving transform with respect to the
+   * parameters at \c virtualPoint, in the \c MovingTransformJacobian of the
+   * thread. When the sparse jacobian is used, its
+   * GetCachedNumberOfLocalParameters() columns are the derivatives with
+   * respect to the parameters in \c NonZeroJacobianIndices. */
+  void ComputeMovingTransformJacobian( const VirtualPointType & virtualPoint,
+                                       const ThreadIdType threadId ) const;
+
+  /** Whether the derivatives of each thread are reset and summed in
+   * parallel over slices of the parameters. */
+  bool GetParallelizeCompensatedDerivatives() const;
+
+  /** Reset the derivatives of each thread on the given slice of the
+   * parameters. */
+  void ResetCompensatedDerivatives( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  /** Sum the derivatives of each thread in the enclosing class
+   * \c m_DerivativeResult on the given slice of the parameters. */
+  void ReduceCompensatedDerivatives( ThreadIdType threadId, ThreadIdType numberOfThreads );
+
+  /** Static functions used as a "callback" by the MultiThreader to reset
+   * and to sum the derivatives of each thread. */
+  static ITK_THREAD_RETURN_TYPE ResetCompensatedDerivativesThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE ReduceCompensatedDerivativesThreaderCallback( void * arg );
+
   struct GetValueAndDerivativePerThreadStruct
     {
     /** Intermediary threaded metric value storage. */
@@ -178,18 +214,28 @@ protected:
      * classes for efficiency. */
     JacobianType                 MovingTransformJacobian;
     JacobianType                 MovingTransformJacobianPositional;
+    /** Indices of the parameters of the columns of the sparse jacobian. */
+    NonZeroJacobianIndicesType   NonZeroJacobianIndices;
     };
   itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, GetValueAndDerivativePerThreadStruct,
                                             PaddedGetValueAndDerivativePerThreadStruct);
   itkAlignedTypedef( ITK_CACHE_LINE_ALIGNMENT, PaddedGetValueAndDerivativePerThreadStruct,
                                                AlignedGetValueAndDerivativePerThreadStruct );
   mutable AlignedGetValueAndDerivativePerThreadStruct * m_GetValueAndDerivativePerThreadVariables;
+  ThreadIdType                                          m_NumberOfGetValueAndDerivativePerThreadVariables;
 
   /** Cached values to avoid call overhead.
    *  These will only be set once threading has been started. */
   mutable NumberOfParametersType                      m_CachedNumberOfParameters;
   mutable NumberOfParametersType                      m_CachedNumberOfLocalParameters;
 
+  /** Set by derived classes which compute the jacobian with
+   * \c ComputeMovingTransformJacobian. Default is false. */
+  bool                                                m_SupportsSparseJacobian;
+
+  /** Whether the sparse jacobian is used during this threaded execution. */
+  bool                                                m_UseSparseJacobian;
+
 private:
   ImageToImageMetricv4GetValueAndDerivativeThreaderBase( const Self & ); // purposely not implemented
   void operator=( const Self & ); // purposely not implemented
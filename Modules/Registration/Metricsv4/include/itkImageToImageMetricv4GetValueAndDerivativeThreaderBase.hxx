@@ -28,8 +28,11 @@ template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
 ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
 ::ImageToImageMetricv4GetValueAndDerivativeThreaderBase():
   m_GetValueAndDerivativePerThreadVariables( ITK_NULLPTR ),
+  m_NumberOfGetValueAndDerivativePerThreadVariables( 0 ),
   m_CachedNumberOfParameters( 0 ),
-  m_CachedNumberOfLocalParameters( 0 )
+  m_CachedNumberOfLocalParameters( 0 ),
+  m_SupportsSparseJacobian( false ),
+  m_UseSparseJacobian( false )
 {
 }
 
@@ -52,10 +55,28 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
   this->m_CachedNumberOfParameters      = this->m_Associate->GetNumberOfParameters();
   this->m_CachedNumberOfLocalParameters = this->m_Associate->GetNumberOfLocalParameters();
 
-  /* Per-thread results */
+  /* With a sparse jacobian, the local parameters are the parameters the
+   * jacobian at a point depends on. */
+  this->m_UseSparseJacobian = false;
+  if( this->m_SupportsSparseJacobian &&
+      this->m_Associate->GetComputeDerivative() &&
+      this->m_Associate->m_MovingTransform->GetTransformCategory() != MovingTransformType::DisplacementField &&
+      this->m_Associate->m_MovingTransform->GetNumberOfNonZeroJacobianIndices() < this->m_CachedNumberOfLocalParameters )
+    {
+    itkDebugMacro( "ImageToImageMetricv4::Initialize: transform has a sparse jacobian\n" );
+    this->m_UseSparseJacobian = true;
+    this->m_CachedNumberOfLocalParameters = this->m_Associate->m_MovingTransform->GetNumberOfNonZeroJacobianIndices();
+    }
+
+  /* Per-thread results. They are kept from one execution to the next, to
+   * avoid reallocating the derivatives of each thread. */
   const ThreadIdType numThreadsUsed = this->GetNumberOfThreadsUsed();
-  delete[] m_GetValueAndDerivativePerThreadVariables;
-  this->m_GetValueAndDerivativePerThreadVariables = new AlignedGetValueAndDerivativePerThreadStruct[ numThreadsUsed ];
+  if( this->m_NumberOfGetValueAndDerivativePerThreadVariables != numThreadsUsed )
+    {
+    delete[] m_GetValueAndDerivativePerThreadVariables;
+    this->m_GetValueAndDerivativePerThreadVariables = new AlignedGetValueAndDerivativePerThreadStruct[ numThreadsUsed ];
+    this->m_NumberOfGetValueAndDerivativePerThreadVariables = numThreadsUsed;
+    }
 
   if( this->m_Associate->GetComputeDerivative() )
     {
@@ -99,18 +120,22 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
     {
     this->m_GetValueAndDerivativePerThreadVariables[thread].NumberOfValidPoints = NumericTraits< SizeValueType >::ZeroValue();
     this->m_GetValueAndDerivativePerThreadVariables[thread].Measure = NumericTraits< InternalComputationValueType >::ZeroValue();
-    if( this->m_Associate->GetComputeDerivative() )
+    }
+  if( this->m_Associate->GetComputeDerivative() &&
+      this->m_Associate->m_MovingTransform->GetTransformCategory() != MovingTransformType::DisplacementField )
+    {
+    /* Be sure to init to 0 here, because the threader may not use
+     * all the threads if the region is better split into fewer
+     * subregions. */
+    if( this->GetParallelizeCompensatedDerivatives() )
       {
-      if ( this->m_Associate->m_MovingTransform->GetTransformCategory() != MovingTransformType::DisplacementField )
-        {
-        /* Be sure to init to 0 here, because the threader may not use
-         * all the threads if the region is better split into fewer
-         * subregions. */
-        for( NumberOfParametersType p = 0; p < this->m_CachedNumberOfParameters; p++ )
-          {
-          this->m_GetValueAndDerivativePerThreadVariables[thread].CompensatedDerivatives[p].ResetToZero();
-          }
-        }
+      MultiThreader * multiThreader = this->GetMultiThreader();
+      multiThreader->SetSingleMethod( this->ResetCompensatedDerivativesThreaderCallback, this );
+      multiThreader->SingleMethodExecute();
+      }
+    else
+      {
+      this->ResetCompensatedDerivatives( 0, 1 );
       }
     }
 }
@@ -135,16 +160,16 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
     {
     if ( this->m_Associate->m_MovingTransform->GetTransformCategory() != MovingTransformType::DisplacementField )
       {
-      for (NumberOfParametersType p = 0; p < this->m_Associate->GetNumberOfParameters(); p++ )
+      /* Each thread sums a slice of the parameters. */
+      if( this->GetParallelizeCompensatedDerivatives() )
+        {
+        MultiThreader * multiThreader = this->GetMultiThreader();
+        multiThreader->SetSingleMethod( this->ReduceCompensatedDerivativesThreaderCallback, this );
+        multiThreader->SingleMethodExecute();
+        }
+      else
         {
-        /* Use a compensated sum to be ready for when there is a very large number of threads */
-        CompensatedDerivativeValueType sum;
-        sum.ResetToZero();
-        for (ThreadIdType i=0; i<numThreadsUsed; i++)
-          {
-          sum += this->m_GetValueAndDerivativePerThreadVariables[i].CompensatedDerivatives[p].GetSum();
-          }
-        (*(this->m_Associate->m_DerivativeResult))[p] += sum.GetSum();
+        this->ReduceCompensatedDerivatives( 0, 1 );
         }
       }
     }
@@ -217,12 +242,15 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
 
   try
     {
-    pointIsValid = this->m_Associate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
-    if( pointIsValid &&
-        this->m_Associate->GetComputeDerivative() &&
+    if( this->m_Associate->GetComputeDerivative() &&
         this->m_Associate->GetGradientSourceIncludesMoving() )
       {
-      this->m_Associate->ComputeMovingImageGradientAtPoint( mappedMovingPoint, mappedMovingImageGradient );
+      pointIsValid = this->m_Associate->TransformAndEvaluateMovingPointAndGradient( virtualPoint, mappedMovingPoint,
+                                                                                    mappedMovingPixelValue, mappedMovingImageGradient );
+      }
+    else
+      {
+      pointIsValid = this->m_Associate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
       }
     }
   catch( ExceptionObject & exc )
@@ -280,19 +308,33 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
 {
   if ( this->m_Associate->m_MovingTransform->GetTransformCategory() != MovingTransformType::DisplacementField )
     {
-    /* Global support */
+    /* Global support. With a sparse jacobian, only the derivatives with
+     * respect to the non zero jacobian indices are accumulated. */
+    const NumberOfParametersType numberOfDerivatives =
+      this->m_UseSparseJacobian ? this->m_CachedNumberOfLocalParameters : this->m_CachedNumberOfParameters;
     if ( this->m_Associate->GetUseFloatingPointCorrection() )
       {
       DerivativeValueType correctionResolution = this->m_Associate->GetFloatingPointCorrectionResolution();
-      for (NumberOfParametersType p = 0; p < this->m_CachedNumberOfParameters; p++ )
+      for (NumberOfParametersType p = 0; p < numberOfDerivatives; p++ )
         {
         intmax_t test = static_cast< intmax_t >( this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[p] * correctionResolution );
         this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[p] = static_cast<DerivativeValueType>( test / correctionResolution );
         }
       }
-    for (NumberOfParametersType p = 0; p < this->m_CachedNumberOfParameters; p++ )
+    if( this->m_UseSparseJacobian )
+      {
+      const NonZeroJacobianIndicesType & nonZeroJacobianIndices = this->m_GetValueAndDerivativePerThreadVariables[threadId].NonZeroJacobianIndices;
+      for (NumberOfParametersType p = 0; p < numberOfDerivatives; p++ )
+        {
+        this->m_GetValueAndDerivativePerThreadVariables[threadId].CompensatedDerivatives[nonZeroJacobianIndices[p]] += this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[p];
+        }
+      }
+    else
       {
-      this->m_GetValueAndDerivativePerThreadVariables[threadId].CompensatedDerivatives[p] += this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[p];
+      for (NumberOfParametersType p = 0; p < numberOfDerivatives; p++ )
+        {
+        this->m_GetValueAndDerivativePerThreadVariables[threadId].CompensatedDerivatives[p] += this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[p];
+        }
       }
     }
   else
@@ -321,6 +363,100 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
     }
 }
 
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+void
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::ComputeMovingTransformJacobian( const VirtualPointType & virtualPoint, const ThreadIdType threadId ) const
+{
+  AlignedGetValueAndDerivativePerThreadStruct & perThreadVariables = this->m_GetValueAndDerivativePerThreadVariables[threadId];
+  if( this->m_UseSparseJacobian )
+    {
+    this->m_Associate->m_MovingTransform->ComputeSparseJacobianWithRespectToParameters( virtualPoint,
+                                                                                       perThreadVariables.MovingTransformJacobian,
+                                                                                       perThreadVariables.NonZeroJacobianIndices );
+    }
+  else
+    {
+    /** For dense transforms, this returns identity */
+    this->m_Associate->m_MovingTransform->ComputeJacobianWithRespectToParametersCachedTemporaries( virtualPoint,
+                                                                                                  perThreadVariables.MovingTransformJacobian,
+                                                                                                  perThreadVariables.MovingTransformJacobianPositional );
+    }
+}
+
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+bool
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::GetParallelizeCompensatedDerivatives() const
+{
+  /* Starting the threads is only worth it for large numbers of parameters,
+   * e.g. for BSpline transforms. */
+  const ThreadIdType numThreadsUsed = this->GetNumberOfThreadsUsed();
+  return ( numThreadsUsed > 1 ) && ( this->m_CachedNumberOfParameters >= 1024 * numThreadsUsed );
+}
+
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+ITK_THREAD_RETURN_TYPE
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::ResetCompensatedDerivativesThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self * threader = static_cast< Self * >( info->UserData );
+  threader->ResetCompensatedDerivatives( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+ITK_THREAD_RETURN_TYPE
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::ReduceCompensatedDerivativesThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self * threader = static_cast< Self * >( info->UserData );
+  threader->ReduceCompensatedDerivatives( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+void
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::ResetCompensatedDerivatives( ThreadIdType threadId, ThreadIdType numberOfThreads )
+{
+  const NumberOfParametersType sliceStart = this->m_CachedNumberOfParameters * threadId / numberOfThreads;
+  const NumberOfParametersType sliceEnd = this->m_CachedNumberOfParameters * ( threadId + 1 ) / numberOfThreads;
+  for( ThreadIdType i = 0; i < this->GetNumberOfThreadsUsed(); ++i )
+    {
+    CompensatedDerivativeType & derivatives = this->m_GetValueAndDerivativePerThreadVariables[i].CompensatedDerivatives;
+    for( NumberOfParametersType p = sliceStart; p < sliceEnd; p++ )
+      {
+      derivatives[p].ResetToZero();
+      }
+    }
+}
+
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+void
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::ReduceCompensatedDerivatives( ThreadIdType threadId, ThreadIdType numberOfThreads )
+{
+  const NumberOfParametersType sliceStart = this->m_CachedNumberOfParameters * threadId / numberOfThreads;
+  const NumberOfParametersType sliceEnd = this->m_CachedNumberOfParameters * ( threadId + 1 ) / numberOfThreads;
+  DerivativeType & derivativeResult = *( this->m_Associate->m_DerivativeResult );
+  for( NumberOfParametersType p = sliceStart; p < sliceEnd; p++ )
+    {
+    /* Use a compensated sum to be ready for when there is a very large number of threads */
+    CompensatedDerivativeValueType sum;
+    sum.ResetToZero();
+    for( ThreadIdType i = 0; i < this->GetNumberOfThreadsUsed(); ++i )
+      {
+      sum += this->m_GetValueAndDerivativePerThreadVariables[i].CompensatedDerivatives[p].GetSum();
+      }
+    derivativeResult[p] += sum.GetSum();
+    }
+}
+
 template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
 bool
 ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
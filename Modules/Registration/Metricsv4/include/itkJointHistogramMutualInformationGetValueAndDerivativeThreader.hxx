@@ -28,7 +28,9 @@ JointHistogramMutualInformationGetValueAndDerivativeThreader< TDomainPartitioner
 ::JointHistogramMutualInformationGetValueAndDerivativeThreader() :
   m_JointHistogramMIPerThreadVariables( ITK_NULLPTR ),
   m_JointAssociate( ITK_NULLPTR )
-{}
+{
+  this->m_SupportsSparseJacobian = true;
+}
 
 
 template< typename TDomainPartitioner, typename TImageToImageMetric, typename TJointHistogramMetric >
@@ -155,13 +157,11 @@ JointHistogramMutualInformationGetValueAndDerivativeThreader< TDomainPartitioner
   /* Use a pre-allocated jacobian object for efficiency */
   typedef JacobianType & JacobianReferenceType;
   JacobianReferenceType jacobian = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobian;
-  JacobianReferenceType jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
 
-  /** For dense transforms, this returns identity */
-  this->m_JointAssociate->GetMovingTransform()->
-    ComputeJacobianWithRespectToParametersCachedTemporaries(virtualPoint,
-                                                            jacobian,
-                                                            jacobianPositional);
+  /** For dense transforms, this returns identity. For transforms with a
+   * sparse jacobian, only the GetCachedNumberOfLocalParameters() non zero
+   * columns are computed. */
+  this->ComputeMovingTransformJacobian( virtualPoint, threadId );
 
   for ( NumberOfParametersType par = 0; par < this->GetCachedNumberOfLocalParameters(); par++ )
     {
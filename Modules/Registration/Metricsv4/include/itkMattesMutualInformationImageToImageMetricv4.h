@@ -25,6 +25,7 @@
 #include "itkBSplineDerivativeKernelFunction.h"
 #include "itkArray2D.h"
 #include "itkThreadedIndexedContainerPartitioner.h"
+#include "itkMutexLock.h"
 #include "itkMutexLockHolder.h"
 
 namespace itk
@@ -64,7 +65,12 @@ namespace itk
  * \warning Local-support transforms are not yet supported. If used,
  * an exception is thrown during Initialize().
  *
- * \note The per-iteration post-processing code is not multi-threaded, but could be
+ * With global-support transforms, each thread accumulates the joint PDF
+ * derivatives in its own copy, within the limit set by
+ * SetJointPDFDerivativesMemoryLimit(), and the copies are summed by all
+ * the threads after the threaded execution.
+ *
+ * \note The rest of the per-iteration post-processing code is not multi-threaded, but could be
  * readily be made so for a small performance gain.
  * See GetValueCommonAfterThreadedExecution(), GetValueAndDerivative()
  * and threader::AfterThreadedExecution().
@@ -188,6 +194,15 @@ public:
     return this->m_JointPDFDerivatives;
     }
 
+  /** Set/Get the maximum memory, in bytes, used by the additional
+   * accumulators of the joint PDF derivatives. Each thread accumulates the
+   * derivatives in its own copy of the joint PDF derivatives, without any
+   * locking, as long as the copies fit in this limit. Beyond that, the
+   * threads share the accumulators, and buffer their contributions to
+   * reduce the contention on their locks. The default is 256 MB. */
+  itkSetMacro( JointPDFDerivativesMemoryLimit, SizeValueType );
+  itkGetConstMacro( JointPDFDerivativesMemoryLimit, SizeValueType );
+
   virtual void FinalizeThread( const ThreadIdType threadId ) ITK_OVERRIDE;
 
 protected:
@@ -262,8 +277,10 @@ protected:
    * Thread safety note:
    * A seperate object is used locally per each thread. Only the members
    * m_ParentJointPDFDerivativesLockPtr and m_ParentJointPDFDerivatives
-   * are shared between threads and access to m_ParentJointPDFDerivatives
-   * is controlled with the m_ParentJointPDFDerivativesLockPtr mutex lock.
+   * may be shared between threads and access to m_ParentJointPDFDerivatives
+   * is then controlled with the m_ParentJointPDFDerivativesLockPtr mutex lock.
+   * When the lock is null, the parent joint PDF derivatives are owned by
+   * the thread, and the contributions are directly accumulated in them.
    * \ingroup ITKMetricsv4
    */
   class DerivativeBufferManager
@@ -273,14 +290,16 @@ public:
     /* All these methods are thread safe except ReduceBuffer */
 
     void Initialize( size_t maxBufferLength, const size_t cachedNumberOfLocalParameters,
-                     SimpleFastMutexLock * parentDerivativeLockPtr,
+                     MutexLock * parentDerivativeLockPtr,
                      typename JointPDFDerivativesType::Pointer parentJointPDFDerivatives);
 
     void DoubleBufferSize();
 
     DerivativeBufferManager() :
       m_CurrentFillSize(0),
-      m_MemoryBlock(0)
+      m_MemoryBlock(0),
+      m_ParentJointPDFDerivativesLockPtr(ITK_NULLPTR),
+      m_ParentJointPDFDerivativesBuffer(ITK_NULLPTR)
     {
     }
 
@@ -304,9 +323,13 @@ public:
      */
     void BlockAndReduce();
 
-    // If offset is same as previous offset, then accumulate with previous
+    // Return where the contributions for that offset must be accumulated
     PDFValueType * GetNextElementAndAddOffset(const OffsetValueType & offset)
     {
+      if( m_ParentJointPDFDerivativesLockPtr == ITK_NULLPTR )
+        {
+        return m_ParentJointPDFDerivativesBuffer + offset;
+        }
       m_BufferOffsetContainer[m_CurrentFillSize] = offset;
       PDFValueType * PDFBufferForWriting = m_BufferPDFValuesContainer[m_CurrentFillSize];
       ++m_CurrentFillSize;
@@ -331,15 +354,23 @@ private:
     size_t                       m_CachedNumberOfLocalParameters;
     size_t                       m_MaxBufferSize;
     // Pointer handle to parent version
-    SimpleFastMutexLock *   m_ParentJointPDFDerivativesLockPtr;
+    MutexLock *                  m_ParentJointPDFDerivativesLockPtr;
     // Smart pointer handle to parent version
     typename JointPDFDerivativesType::Pointer m_ParentJointPDFDerivatives;
+    // Buffer of the parent version
+    PDFValueType *               m_ParentJointPDFDerivativesBuffer;
   };
 
   std::vector<DerivativeBufferManager>      m_ThreaderDerivativeManager;
-  SimpleFastMutexLock                       m_JointPDFDerivativesLock;
   typename JointPDFDerivativesType::Pointer m_JointPDFDerivatives;
 
+  /** The accumulators of the joint PDF derivatives, the first one being
+   * m_JointPDFDerivatives, and their locks when they are shared between
+   * several threads. */
+  std::vector<typename JointPDFDerivativesType::Pointer> m_ThreaderJointPDFDerivatives;
+  std::vector<MutexLock::Pointer>                        m_ThreaderJointPDFDerivativesLock;
+  SizeValueType                                          m_JointPDFDerivativesMemoryLimit;
+
   PDFValueType m_JointPDFSum;
 
   /** Store the per-point local derivative result by parzen window bin.
@@ -51,6 +51,7 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
   // For multi-threading the metric
   m_ThreaderJointPDF(0),
   m_JointPDFDerivatives(ITK_NULLPTR),
+  m_JointPDFDerivativesMemoryLimit(256 * 1024 * 1024),
   m_JointPDFSum(0.0)
 {
   // We have our own GetValueAndDerivativeThreader's that we want
@@ -378,6 +379,8 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
 ::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+
+  os << indent << "JointPDFDerivativesMemoryLimit: " << this->m_JointPDFDerivativesMemoryLimit << std::endl;
 }
 
 template <typename TFixedImage, typename TMovingImage, typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
@@ -415,9 +418,14 @@ void
 MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
 ::DerivativeBufferManager
 ::Initialize( size_t maxBufferLength, const size_t cachedNumberOfLocalParameters,
-              SimpleFastMutexLock * parentDerivativeLockPtr,
+              MutexLock * parentDerivativeLockPtr,
               typename JointPDFDerivativesType::Pointer parentJointPDFDerivatives)
 {
+  if( parentDerivativeLockPtr == ITK_NULLPTR )
+    {
+    // The parent is owned by this thread: no buffer is needed.
+    maxBufferLength = 0;
+    }
   m_CurrentFillSize = 0;
   m_MemoryBlockSize = cachedNumberOfLocalParameters * maxBufferLength;
   m_BufferPDFValuesContainer.resize(maxBufferLength, ITK_NULLPTR);
@@ -426,10 +434,11 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
   m_MaxBufferSize = maxBufferLength;
   m_ParentJointPDFDerivativesLockPtr = parentDerivativeLockPtr;
   m_ParentJointPDFDerivatives = parentJointPDFDerivatives;
-  // Allocate and initialize to zero (note the () at the end of the new
-  // operator)
-  // the memory as a single block
-  m_MemoryBlock.resize(m_MemoryBlockSize, 0.0);
+  m_ParentJointPDFDerivativesBuffer = parentJointPDFDerivatives->GetBufferPointer();
+  // Allocate and initialize to zero the memory as a single block.
+  // The contributions are accumulated in the buffer, which is reset to
+  // zero after each reduction.
+  m_MemoryBlock.assign(m_MemoryBlockSize, 0.0);
   for( size_t index = 0; index < maxBufferLength; ++index )
     {
     this->m_BufferPDFValuesContainer[index] = &(this->m_MemoryBlock[0]) + index * m_CachedNumberOfLocalParameters;
@@ -459,19 +468,26 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
 ::DerivativeBufferManager
 ::CheckAndReduceIfNecessary()
 {
-  if( m_CurrentFillSize ==  m_MaxBufferSize )
+  if( m_CurrentFillSize ==  m_MaxBufferSize && m_ParentJointPDFDerivativesLockPtr != ITK_NULLPTR )
     {
     //Attempt to acquire the lock once
-    MutexLockHolder< SimpleFastMutexLock > FirstTryLockHolder(*this->m_ParentJointPDFDerivativesLockPtr, true);
+    MutexLockHolder< MutexLock > FirstTryLockHolder(*this->m_ParentJointPDFDerivativesLockPtr, true);
     if(FirstTryLockHolder.GetLockCaptured())
       {
       ReduceBuffer();
       }
+    else if( m_MemoryBlockSize >= this->m_ParentJointPDFDerivatives->GetPixelContainer()->Size() )
+      {
+      // The buffer is already as large as the parent: wait for the lock
+      // instead of growing it without bound.
+      MutexLockHolder< MutexLock > LockHolder(*this->m_ParentJointPDFDerivativesLockPtr);
+      ReduceBuffer();
+      }
     else
       {
       DoubleBufferSize();
       //Attempt to acquire the lock a second time
-      MutexLockHolder< SimpleFastMutexLock > SecondTryLockHolder(*this->m_ParentJointPDFDerivativesLockPtr, true);
+      MutexLockHolder< MutexLock > SecondTryLockHolder(*this->m_ParentJointPDFDerivativesLockPtr, true);
       if(SecondTryLockHolder.GetLockCaptured())
         {
         ReduceBuffer();
@@ -488,7 +504,7 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
 {
   if( m_CurrentFillSize > 0 )
     {
-    MutexLockHolder< SimpleFastMutexLock > LockHolder(*this->m_ParentJointPDFDerivativesLockPtr);
+    MutexLockHolder< MutexLock > LockHolder(*this->m_ParentJointPDFDerivativesLockPtr);
     ReduceBuffer();
     }
 }
@@ -115,6 +115,14 @@ protected:
                              const PDFValueType &            cubicBSplineDerivativeValue,
                              DerivativeValueType *           localSupportDerivativeResultPtr) const;
 
+  /** Sum the accumulators of the joint PDF derivatives in the first one,
+   * and normalize them, on the given slice of the joint PDF derivatives. */
+  void ReduceJointPDFDerivatives( ThreadIdType threadId, ThreadIdType numberOfThreads ) const;
+
+  /** Static function used as a "callback" by the MultiThreader to
+   * reduce the joint PDF derivatives. */
+  static ITK_THREAD_RETURN_TYPE ReduceJointPDFDerivativesThreaderCallback( void * arg );
+
 private:
   MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader( const Self & ); // purposely not implemented
   void operator=( const Self & ); // purposely not implemented
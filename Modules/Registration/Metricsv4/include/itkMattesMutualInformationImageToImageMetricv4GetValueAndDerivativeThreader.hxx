@@ -198,26 +198,58 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
       jointPDFDerivativesRegion.SetSize(jointPDFDerivativesSize);
       }
 
+    // Each thread gets its own accumulator, as long as they fit in the
+    // memory limit. Otherwise the threads share the accumulators.
+    const SizeValueType accumulatorMemorySize = jointPDFDerivativesRegion.GetNumberOfPixels() * sizeof( PDFValueType );
+    const SizeValueType maximumNumberOfAccumulators =
+      1 + this->m_MattesAssociate->m_JointPDFDerivativesMemoryLimit / std::max< SizeValueType >( accumulatorMemorySize, 1 );
+    const ThreadIdType numberOfAccumulators =
+      static_cast< ThreadIdType >( std::min< SizeValueType >( localNumberOfThreadsUsed, maximumNumberOfAccumulators ) );
+    const bool sharedAccumulators = ( numberOfAccumulators < localNumberOfThreadsUsed );
+
     // Set the regions and allocate
-    if( this->m_MattesAssociate->m_JointPDFDerivatives.IsNull() ||
-        ( this->m_MattesAssociate->m_JointPDFDerivatives->GetBufferedRegion() != jointPDFDerivativesRegion )
-        )
+    this->m_MattesAssociate->m_ThreaderJointPDFDerivatives.resize( numberOfAccumulators );
+    for( ThreadIdType accumulator = 0; accumulator < numberOfAccumulators; ++accumulator )
+      {
+      typename JointPDFDerivativesType::Pointer & jointPDFDerivatives =
+        this->m_MattesAssociate->m_ThreaderJointPDFDerivatives[accumulator];
+      if( jointPDFDerivatives.IsNull() || ( jointPDFDerivatives->GetBufferedRegion() != jointPDFDerivativesRegion ) )
+        {
+        jointPDFDerivatives = JointPDFDerivativesType::New();
+        jointPDFDerivatives->SetRegions( jointPDFDerivativesRegion);
+        jointPDFDerivatives->Allocate(true);
+        }
+      else
+        {
+        // Initialize to zero for accumulation
+        jointPDFDerivatives->FillBuffer(0.0F);
+        }
+      }
+    this->m_MattesAssociate->m_JointPDFDerivatives = this->m_MattesAssociate->m_ThreaderJointPDFDerivatives[0];
+
+    if( sharedAccumulators )
       {
-      this->m_MattesAssociate->m_JointPDFDerivatives = JointPDFDerivativesType::New();
-      this->m_MattesAssociate->m_JointPDFDerivatives->SetRegions( jointPDFDerivativesRegion);
-      this->m_MattesAssociate->m_JointPDFDerivatives->Allocate(true);
+      this->m_MattesAssociate->m_ThreaderJointPDFDerivativesLock.resize( numberOfAccumulators );
+      for( ThreadIdType accumulator = 0; accumulator < numberOfAccumulators; ++accumulator )
+        {
+        if( this->m_MattesAssociate->m_ThreaderJointPDFDerivativesLock[accumulator].IsNull() )
+          {
+          this->m_MattesAssociate->m_ThreaderJointPDFDerivativesLock[accumulator] = MutexLock::New();
+          }
+        }
       }
     else
       {
-      // Initialize to zero for accumulation
-      this->m_MattesAssociate->m_JointPDFDerivatives->FillBuffer(0.0F);
+      this->m_MattesAssociate->m_ThreaderJointPDFDerivativesLock.clear();
       }
+
     if( ( this->m_MattesAssociate->m_ThreaderDerivativeManager.size() != localNumberOfThreadsUsed ) )
       {
       this->m_MattesAssociate->m_ThreaderDerivativeManager.resize(localNumberOfThreadsUsed);
       }
     for( ThreadIdType threadId = 0; threadId < localNumberOfThreadsUsed; ++threadId )
       {
+      const ThreadIdType accumulator = threadId % numberOfAccumulators;
       this->m_MattesAssociate->m_ThreaderDerivativeManager[threadId].Initialize(
         // A heuristic that assumues memory for 2x size of
         // m_JointPDFDerivati efficient and easy to make, so
@@ -227,9 +259,10 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
         std::max<size_t>(500,
         this->m_MattesAssociate->m_NumberOfHistogramBins * this->m_MattesAssociate->m_NumberOfHistogramBins / localNumberOfThreadsUsed),
         this->GetCachedNumberOfLocalParameters(),
-        // Need address of the lock
-        &this->m_MattesAssociate->m_JointPDFDerivativesLock,
-        this->m_MattesAssociate->m_JointPDFDerivatives
+        // No lock is needed when the accumulator is owned by the thread
+        sharedAccumulators ? this->m_MattesAssociate->m_ThreaderJointPDFDerivativesLock[accumulator].GetPointer()
+                           : ITK_NULLPTR,
+        this->m_MattesAssociate->m_ThreaderJointPDFDerivatives[accumulator]
         );
       }
     }
@@ -384,7 +417,7 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
             innerProduct += jacobian[dim][mu] * movingImageGradient[dim];
             }
 
-          *(derivativeContributionPtr) = innerProduct * cubicBSplineDerivativeValue;
+          *(derivativeContributionPtr) += innerProduct * cubicBSplineDerivativeValue;
           ++derivativeContributionPtr;
           }
         this->m_MattesAssociate->m_ThreaderDerivativeManager[threadId].CheckAndReduceIfNecessary();
@@ -448,26 +481,17 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
 
   if( this->m_MattesAssociate->GetComputeDerivative() && ( !this->m_MattesAssociate->HasLocalSupport() ) )
     {
-    // This entire block of code is used to accumulate the per-thread buffers
-    // into 1 thread.
-    // For this thread, how many histogram elements are there?
-    const NumberOfParametersType rowSize = this->GetCachedNumberOfLocalParameters()
-      * this->m_MattesAssociate->m_NumberOfHistogramBins;
-    const SizeValueType histogramTotalElementsSize = rowSize
-      * this->m_MattesAssociate->m_NumberOfHistogramBins;
-
-    // NOTE:  Negative 1 so that accumulators can all be positive accumulators
-    const PDFValueType nFactor = -1.0
-      / ( this->m_MattesAssociate->m_MovingImageBinSize * this->m_MattesAssociate->GetNumberOfValidPoints() );
-
-    JointPDFDerivativesValueType *const accumulatorPdfDPtrStart =
-      this->m_MattesAssociate->m_JointPDFDerivatives->GetBufferPointer();
-    JointPDFDerivativesValueType *             accumulatorPdfDPtr = accumulatorPdfDPtrStart;
-    JointPDFDerivativesValueType const * const tempThreadPdfDPtrEnd = accumulatorPdfDPtrStart
-      + histogramTotalElementsSize;
-    while( accumulatorPdfDPtr < tempThreadPdfDPtrEnd )
+    // Accumulate the per-thread accumulators into the first one, each
+    // thread taking care of a slice of the joint PDF derivatives.
+    if( this->GetNumberOfThreadsUsed() > 1 )
       {
-      *( accumulatorPdfDPtr++ ) *= nFactor;
+      MultiThreader * multiThreader = this->GetMultiThreader();
+      multiThreader->SetSingleMethod( this->ReduceJointPDFDerivativesThreaderCallback, this );
+      multiThreader->SingleMethodExecute();
+      }
+    else
+      {
+      this->ReduceJointPDFDerivatives( 0, 1 );
       }
     }
 
@@ -476,6 +500,57 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
   this->m_MattesAssociate->ComputeResults();
 }
 
+template< typename TDomainPartitioner, typename TImageToImageMetric, typename TMattesMutualInformationMetric >
+ITK_THREAD_RETURN_TYPE
+MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomainPartitioner, TImageToImageMetric, TMattesMutualInformationMetric >
+::ReduceJointPDFDerivativesThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self * threader = static_cast< Self * >( info->UserData );
+  threader->ReduceJointPDFDerivatives( info->ThreadID, info->NumberOfThreads );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TDomainPartitioner, typename TImageToImageMetric, typename TMattesMutualInformationMetric >
+void
+MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomainPartitioner, TImageToImageMetric, TMattesMutualInformationMetric >
+::ReduceJointPDFDerivatives( ThreadIdType threadId, ThreadIdType numberOfThreads ) const
+{
+  // For this thread, how many histogram elements are there?
+  const NumberOfParametersType rowSize = this->GetCachedNumberOfLocalParameters()
+    * this->m_MattesAssociate->m_NumberOfHistogramBins;
+  const SizeValueType histogramTotalElementsSize = rowSize
+    * this->m_MattesAssociate->m_NumberOfHistogramBins;
+  const SizeValueType sliceStart = histogramTotalElementsSize * threadId / numberOfThreads;
+  const SizeValueType sliceEnd = histogramTotalElementsSize * ( threadId + 1 ) / numberOfThreads;
+
+  // NOTE:  Negative 1 so that accumulators can all be positive accumulators
+  const PDFValueType nFactor = -1.0
+    / ( this->m_MattesAssociate->m_MovingImageBinSize * this->m_MattesAssociate->GetNumberOfValidPoints() );
+
+  JointPDFDerivativesValueType * const accumulatorPdfDPtrStart =
+    this->m_MattesAssociate->m_ThreaderJointPDFDerivatives[0]->GetBufferPointer() + sliceStart;
+  JointPDFDerivativesValueType const * const accumulatorPdfDPtrEnd =
+    this->m_MattesAssociate->m_ThreaderJointPDFDerivatives[0]->GetBufferPointer() + sliceEnd;
+  for( size_t accumulator = 1; accumulator < this->m_MattesAssociate->m_ThreaderJointPDFDerivatives.size(); ++accumulator )
+    {
+    JointPDFDerivativesValueType *       accumulatorPdfDPtr = accumulatorPdfDPtrStart;
+    JointPDFDerivativesValueType const * tempThreadPdfDPtr =
+      this->m_MattesAssociate->m_ThreaderJointPDFDerivatives[accumulator]->GetBufferPointer() + sliceStart;
+    while( accumulatorPdfDPtr < accumulatorPdfDPtrEnd )
+      {
+      *( accumulatorPdfDPtr++ ) += *( tempThreadPdfDPtr++ );
+      }
+    }
+
+  JointPDFDerivativesValueType * accumulatorPdfDPtr = accumulatorPdfDPtrStart;
+  while( accumulatorPdfDPtr < accumulatorPdfDPtrEnd )
+    {
+    *( accumulatorPdfDPtr++ ) *= nFactor;
+    }
+}
+
 } // end namespace itk
 
 #endif
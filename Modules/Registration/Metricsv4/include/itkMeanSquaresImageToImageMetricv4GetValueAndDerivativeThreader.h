@@ -62,7 +62,10 @@ public:
   typedef typename Superclass::NumberOfParametersType   NumberOfParametersType;
 
 protected:
-  MeanSquaresImageToImageMetricv4GetValueAndDerivativeThreader() {}
+  MeanSquaresImageToImageMetricv4GetValueAndDerivativeThreader()
+  {
+    this->m_SupportsSparseJacobian = true;
+  }
 
   /** This function computes the local voxel-wise contribution of
    *  the metric to the global integral of the metric/derivative.
@@ -66,6 +66,10 @@ namespace itk
   * fixed/moving transform assigned to the first component metric.
   *
   * Each component will be initialized by this metric in the call to Initialize().
+  * Before, the moving object cache of the first component having one is shared with the
+  * other components (see ObjectToObjectMetricBaseTemplate::SetMovingObjectCache()), e.g.
+  * so that image metrics using the same moving image and gradient image only interleave
+  * them once.
   *
   * \note When used with an itkRegistrationParameterScalesEstimator estimator, and the multi-metric
   * holds one or more point-set metrics, the user must assign a virtual domain point set for sampling
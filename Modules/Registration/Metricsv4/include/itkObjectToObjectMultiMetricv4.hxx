@@ -197,6 +197,21 @@ ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TI
     Superclass::SetFixedTransform(  const_cast<MovingTransformType*>(this->m_MetricQueue[0]->GetFixedTransform()) );
     }
 
+  /* Share the cache of the first metric having one, so that data computed
+   * from a moving object is only computed once for metrics sharing it. */
+  ObjectType * movingObjectCache = ITK_NULLPTR;
+  for (SizeValueType j = 0; j < this->GetNumberOfMetrics() && movingObjectCache == ITK_NULLPTR; j++)
+    {
+    movingObjectCache = this->m_MetricQueue[j]->GetMovingObjectCache();
+    }
+  if( movingObjectCache != ITK_NULLPTR )
+    {
+    for (SizeValueType j = 0; j < this->GetNumberOfMetrics(); j++)
+      {
+      this->m_MetricQueue[j]->SetMovingObjectCache( movingObjectCache );
+      }
+    }
+
   /* Initialize individual metrics. */
   for (SizeValueType j = 0; j < this->GetNumberOfMetrics(); j++)
     {
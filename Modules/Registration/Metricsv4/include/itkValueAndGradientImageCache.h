@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkValueAndGradientImageCache_h
+#define itkValueAndGradientImageCache_h
+
+#include "itkImage.h"
+#include "itkVector.h"
+#include <vector>
+
+namespace itk
+{
+/** \class ValueAndGradientImageCache
+ * \brief Cache of images interleaving the values and gradients of scalar images.
+ *
+ * A value and gradient image stores, in each pixel, the value of an image
+ * followed by its gradient, so that both are interpolated together with a
+ * single access to the neighbouring pixels.
+ *
+ * ImageToImageMetricv4 computes the value and gradient image of its moving
+ * image once per Initialize(), and stores it in this cache. Metrics sharing
+ * a cache, e.g. the metrics of an ObjectToObjectMultiMetricv4, reuse the
+ * value and gradient image computed by another metric from the same image
+ * and gradient image, instead of computing their own.
+ *
+ * The images are identified by their address, and a value and gradient
+ * image is only reused while it is more recent than both of them.
+ *
+ * \sa ImageToImageMetricv4
+ *
+ * \ingroup ITKMetricsv4
+ */
+template< unsigned int VImageDimension, typename TInternalComputationValueType = double >
+class ValueAndGradientImageCache : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ValueAndGradientImageCache Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ValueAndGradientImageCache, Object);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, VImageDimension);
+
+  typedef TInternalComputationValueType InternalComputationValueType;
+
+  /** The value is the first component, followed by the gradient. */
+  typedef Vector< InternalComputationValueType, VImageDimension + 1 > ValueAndGradientPixelType;
+  typedef Image< ValueAndGradientPixelType, VImageDimension >          ValueAndGradientImageType;
+  typedef typename ValueAndGradientImageType::Pointer                  ValueAndGradientImagePointer;
+
+  /** Return the value and gradient image computed from \c image and
+   * \c gradientImage, if it is more recent than both of them. Return
+   * ITK_NULLPTR otherwise. */
+  ValueAndGradientImageType * GetValueAndGradientImage( const Object * image,
+                                                        const Object * gradientImage ) const;
+
+  /** Store the value and gradient image used by \c user, computed from
+   * \c image and \c gradientImage. It replaces the one previously used by
+   * \c user. */
+  void SetValueAndGradientImage( const Object * user, const Object * image, const Object * gradientImage,
+                                 ValueAndGradientImageType * valueAndGradientImage );
+
+  /** Release the value and gradient image used by \c user. */
+  void RemoveValueAndGradientImage( const Object * user );
+
+  /** Return the number of different value and gradient images in the cache. */
+  SizeValueType GetNumberOfValueAndGradientImages() const;
+
+protected:
+  ValueAndGradientImageCache();
+  virtual ~ValueAndGradientImageCache() {}
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+private:
+  ValueAndGradientImageCache(const Self &); //purposely not implemented
+  void operator=(const Self &);             //purposely not implemented
+
+  struct EntryType
+    {
+    const Object *               User;
+    const Object *               Image;
+    const Object *               GradientImage;
+    ValueAndGradientImagePointer ValueAndGradientImage;
+    TimeStamp                    ComputeTime;
+    };
+
+  std::vector< EntryType > m_Entries;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkValueAndGradientImageCache.hxx"
+#endif
+
+#endif
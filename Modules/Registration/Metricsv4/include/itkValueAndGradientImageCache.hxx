@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkValueAndGradientImageCache_hxx
+#define itkValueAndGradientImageCache_hxx
+
+#include "itkValueAndGradientImageCache.h"
+
+namespace itk
+{
+
+template< unsigned int VImageDimension, typename TInternalComputationValueType >
+ValueAndGradientImageCache< VImageDimension, TInternalComputationValueType >
+::ValueAndGradientImageCache()
+{
+}
+
+template< unsigned int VImageDimension, typename TInternalComputationValueType >
+typename ValueAndGradientImageCache< VImageDimension, TInternalComputationValueType >::ValueAndGradientImageType *
+ValueAndGradientImageCache< VImageDimension, TInternalComputationValueType >
+::GetValueAndGradientImage( const Object * image, const Object * gradientImage ) const
+{
+  for( typename std::vector< EntryType >::const_iterator it = this->m_Entries.begin(); it != this->m_Entries.end(); ++it )
+    {
+    if( it->Image == image && it->GradientImage == gradientImage &&
+        image->GetMTime() < it->ComputeTime.GetMTime() &&
+        gradientImage->GetMTime() < it->ComputeTime.GetMTime() )
+      {
+      return it->ValueAndGradientImage.GetPointer();
+      }
+    }
+  return ITK_NULLPTR;
+}
+
+template< unsigned int VImageDimension, typename TInternalComputationValueType >
+void
+ValueAndGradientImageCache< VImageDimension, TInternalComputationValueType >
+::SetValueAndGradientImage( const Object * user, const Object * image, const Object * gradientImage,
+                            ValueAndGradientImageType * valueAndGradientImage )
+{
+  // Keep the compute time of the image when it is shared, so that it stays
+  // more recent than its sources.
+  TimeStamp computeTime;
+  computeTime.Modified();
+  for( typename std::vector< EntryType >::const_iterator it = this->m_Entries.begin(); it != this->m_Entries.end(); ++it )
+    {
+    if( it->ValueAndGradientImage.GetPointer() == valueAndGradientImage )
+      {
+      computeTime = it->ComputeTime;
+      break;
+      }
+    }
+
+  this->RemoveValueAndGradientImage( user );
+  EntryType entry;
+  entry.User = user;
+  entry.Image = image;
+  entry.GradientImage = gradientImage;
+  entry.ValueAndGradientImage = valueAndGradientImage;
+  entry.ComputeTime = computeTime;
+  this->m_Entries.push_back( entry );
+  this->Modified();
+}
+
+template< unsigned int VImageDimension, typename TInternalComputationValueType >
+void
+ValueAndGradientImageCache< VImageDimension, TInternalComputationValueType >
+::RemoveValueAndGradientImage( const Object * user )
+{
+  for( typename std::vector< EntryType >::iterator it = this->m_Entries.begin(); it != this->m_Entries.end(); ++it )
+    {
+    if( it->User == user )
+      {
+      this->m_Entries.erase( it );
+      this->Modified();
+      return;
+      }
+    }
+}
+
+template< unsigned int VImageDimension, typename TInternalComputationValueType >
+SizeValueType
+ValueAndGradientImageCache< VImageDimension, TInternalComputationValueType >
+::GetNumberOfValueAndGradientImages() const
+{
+  SizeValueType numberOfImages = 0;
+  for( SizeValueType i = 0; i < this->m_Entries.size(); ++i )
+    {
+    bool shared = false;
+    for( SizeValueType j = 0; j < i; ++j )
+      {
+      if( this->m_Entries[j].ValueAndGradientImage == this->m_Entries[i].ValueAndGradientImage )
+        {
+        shared = true;
+        break;
+        }
+      }
+    if( !shared )
+      {
+      ++numberOfImages;
+      }
+    }
+  return numberOfImages;
+}
+
+template< unsigned int VImageDimension, typename TInternalComputationValueType >
+void
+ValueAndGradientImageCache< VImageDimension, TInternalComputationValueType >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfUsers: " << this->m_Entries.size() << std::endl;
+  os << indent << "NumberOfValueAndGradientImages: " << this->GetNumberOfValueAndGradientImages() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,206 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkJointHistogramMutualInformationImageToImageMetricv4.h"
+#include "itkBSplineTransform.h"
+#include "itkCompositeTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Check that the sparse jacobian of the BSpline transform matches its
+ * dense jacobian, and that the metrics give the same value and derivative
+ * with the sparse jacobian as with the dense one, which is used when the
+ * BSpline transform is wrapped in a composite transform.
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+typedef itk::Image< float, Dimension >                ImageType;
+typedef itk::BSplineTransform< double, Dimension, 3 > BSplineTransformType;
+typedef itk::CompositeTransform< double, Dimension >  CompositeTransformType;
+
+template< typename TMetric >
+int ImageToImageMetricv4SparseJacobianCheck( ImageType * fixedImage, ImageType * movingImage,
+                                             BSplineTransformType * bsplineTransform, const char * name )
+{
+  typename CompositeTransformType::Pointer compositeTransform = CompositeTransformType::New();
+  compositeTransform->AddTransform( bsplineTransform );
+
+  typename TMetric::MeasureType    referenceValue = 0.0;
+  typename TMetric::DerivativeType referenceDerivative;
+  for( unsigned int sparse = 0; sparse < 2; ++sparse )
+    {
+    for( itk::ThreadIdType threads = 1; threads <= 3; threads += 2 )
+      {
+      typename TMetric::Pointer metric = TMetric::New();
+      metric->SetFixedImage( fixedImage );
+      metric->SetMovingImage( movingImage );
+      if( sparse )
+        {
+        metric->SetMovingTransform( bsplineTransform );
+        }
+      else
+        {
+        metric->SetMovingTransform( compositeTransform );
+        }
+      metric->SetMaximumNumberOfThreads( threads );
+      metric->Initialize();
+
+      typename TMetric::MeasureType    value;
+      typename TMetric::DerivativeType derivative;
+      metric->GetValueAndDerivative( value, derivative );
+
+      if( sparse == 0 && threads == 1 )
+        {
+        referenceValue = value;
+        referenceDerivative = derivative;
+        continue;
+        }
+
+      const double tolerance = 1e-8;
+      if( std::abs( value - referenceValue ) > tolerance * std::abs( referenceValue ) )
+        {
+        std::cerr << name << ": wrong value with " << threads << " threads (sparse: " << sparse
+                  << "): expected " << referenceValue << ", got " << value << std::endl;
+        return EXIT_FAILURE;
+        }
+      if( derivative.Size() != referenceDerivative.Size() )
+        {
+        std::cerr << name << ": wrong number of derivatives " << derivative.Size() << std::endl;
+        return EXIT_FAILURE;
+        }
+      for( unsigned int p = 0; p < derivative.Size(); ++p )
+        {
+        if( std::abs( derivative[p] - referenceDerivative[p] ) > tolerance * ( 1.0 + std::abs( referenceDerivative[p] ) ) )
+          {
+          std::cerr << name << ": wrong derivative " << p << " with " << threads << " threads (sparse: " << sparse
+                    << "): expected " << referenceDerivative[p] << ", got " << derivative[p] << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int itkImageToImageMetricv4SparseJacobianTest(int, char* [])
+{
+  // two shifted blobs, with some texture
+  ImageType::SizeType size = { { 48, 41 } };
+  ImageType::Pointer  images[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    images[i] = ImageType::New();
+    images[i]->SetRegions( size );
+    images[i]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[i], images[i]->GetLargestPossibleRegion() );
+    for( ; !it.IsAtEnd(); ++it )
+      {
+      const ImageType::IndexType index = it.GetIndex();
+      const double               x = index[0] - 24.0 - 3.0 * i;
+      const double               y = index[1] - 20.0 + 2.0 * i;
+      it.Set( 100.0 * std::exp( -( x * x + y * y ) / 200.0 ) + ( index[0] * 7 + index[1] * 13 ) % 11 );
+      }
+    }
+
+  BSplineTransformType::Pointer                    bsplineTransform = BSplineTransformType::New();
+  BSplineTransformType::PhysicalDimensionsType     physicalDimensions;
+  BSplineTransformType::MeshSizeType               meshSize;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    physicalDimensions[d] = size[d] - 1;
+    meshSize[d] = 5 + d;
+    }
+  bsplineTransform->SetTransformDomainOrigin( images[0]->GetOrigin() );
+  bsplineTransform->SetTransformDomainDirection( images[0]->GetDirection() );
+  bsplineTransform->SetTransformDomainPhysicalDimensions( physicalDimensions );
+  bsplineTransform->SetTransformDomainMeshSize( meshSize );
+
+  BSplineTransformType::ParametersType parameters( bsplineTransform->GetNumberOfParameters() );
+  for( unsigned int p = 0; p < parameters.Size(); ++p )
+    {
+    parameters[p] = 0.5 * std::sin( 0.7 * p );
+    }
+  bsplineTransform->SetParameters( parameters );
+
+  // the sparse jacobian is made of the non zero columns of the dense one
+  const BSplineTransformType::NumberOfParametersType numberOfNonZeroJacobianIndices =
+    bsplineTransform->GetNumberOfNonZeroJacobianIndices();
+  if( numberOfNonZeroJacobianIndices != Dimension * 16 )
+    {
+    std::cerr << "Wrong number of non zero jacobian indices " << numberOfNonZeroJacobianIndices << std::endl;
+    return EXIT_FAILURE;
+    }
+  BSplineTransformType::JacobianType               jacobian;
+  BSplineTransformType::JacobianType               sparseJacobian;
+  BSplineTransformType::NonZeroJacobianIndicesType nonZeroJacobianIndices;
+  for( unsigned int i = 0; i < 20; ++i )
+    {
+    BSplineTransformType::InputPointType point;
+    point[0] = -2.0 + 2.6 * i;
+    point[1] = 1.0 + 2.1 * i;
+    bsplineTransform->ComputeJacobianWithRespectToParameters( point, jacobian );
+    bsplineTransform->ComputeSparseJacobianWithRespectToParameters( point, sparseJacobian, nonZeroJacobianIndices );
+    if( nonZeroJacobianIndices.size() != numberOfNonZeroJacobianIndices ||
+        sparseJacobian.cols() != numberOfNonZeroJacobianIndices )
+      {
+      std::cerr << "Wrong size of the sparse jacobian at " << point << std::endl;
+      return EXIT_FAILURE;
+      }
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      double sum = 0.0;
+      double sparseSum = 0.0;
+      for( unsigned int p = 0; p < jacobian.cols(); ++p )
+        {
+        sum += jacobian( d, p ) * ( p + 1 );
+        }
+      for( unsigned int k = 0; k < numberOfNonZeroJacobianIndices; ++k )
+        {
+        sparseSum += sparseJacobian( d, k ) * ( nonZeroJacobianIndices[k] + 1 );
+        if( sparseJacobian( d, k ) != jacobian( d, nonZeroJacobianIndices[k] ) )
+          {
+          std::cerr << "Wrong sparse jacobian at " << point << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      if( std::abs( sum - sparseSum ) > 1e-10 * ( 1.0 + std::abs( sum ) ) )
+        {
+        std::cerr << "Missing non zero jacobian indices at " << point << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  typedef itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >                     MeanSquaresMetricType;
+  typedef itk::JointHistogramMutualInformationImageToImageMetricv4< ImageType, ImageType > JointHistogramMetricType;
+
+  int status = EXIT_SUCCESS;
+  status |= ImageToImageMetricv4SparseJacobianCheck< MeanSquaresMetricType >( images[0], images[1], bsplineTransform,
+                                                                              "MeanSquares" );
+  status |= ImageToImageMetricv4SparseJacobianCheck< JointHistogramMetricType >( images[0], images[1], bsplineTransform,
+                                                                                 "JointHistogramMutualInformation" );
+  if( status == EXIT_SUCCESS )
+    {
+    std::cout << "Test passed." << std::endl;
+    }
+  return status;
+}
@@ -0,0 +1,185 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkCorrelationImageToImageMetricv4.h"
+#include "itkObjectToObjectMultiMetricv4.h"
+#include "itkAffineTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Check that the metrics give the same value and derivative when the moving
+ * image values and gradients are interpolated together from the moving value
+ * and gradient image, and that the metrics of a multi metric using the same
+ * moving image and gradient filter share a single value and gradient image.
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+typedef itk::Image< float, Dimension >              ImageType;
+typedef itk::AffineTransform< double, Dimension >   TransformType;
+
+template< typename TMetric >
+int ImageToImageMetricv4ValueAndGradientImageCheck( ImageType * fixedImage, ImageType * movingImage,
+                                                    TransformType * transform, const char * name )
+{
+  typename TMetric::MeasureType    values[2];
+  typename TMetric::DerivativeType derivatives[2];
+  for( unsigned int useValueAndGradientImage = 0; useValueAndGradientImage < 2; ++useValueAndGradientImage )
+    {
+    typename TMetric::Pointer metric = TMetric::New();
+    metric->SetFixedImage( fixedImage );
+    metric->SetMovingImage( movingImage );
+    metric->SetMovingTransform( transform );
+    metric->SetUseMovingImageValueAndGradientImage( useValueAndGradientImage != 0 );
+    metric->Initialize();
+
+    if( ( metric->GetMovingImageValueAndGradientImage() != ITK_NULLPTR ) != ( useValueAndGradientImage != 0 ) )
+      {
+      std::cerr << name << ": the moving value and gradient image is wrongly "
+                << ( useValueAndGradientImage ? "not used" : "used" ) << std::endl;
+      return EXIT_FAILURE;
+      }
+    metric->GetValueAndDerivative( values[useValueAndGradientImage], derivatives[useValueAndGradientImage] );
+    }
+
+  if( values[0] != values[1] )
+    {
+    std::cerr << name << ": wrong value " << values[1] << ", expected " << values[0] << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int p = 0; p < derivatives[0].Size(); ++p )
+    {
+    if( derivatives[0][p] != derivatives[1][p] )
+      {
+      std::cerr << name << ": wrong derivative " << derivatives[1] << ", expected " << derivatives[0] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int itkImageToImageMetricv4ValueAndGradientImageTest(int, char* [])
+{
+  // two shifted blobs, with some texture
+  ImageType::SizeType size = { { 40, 37 } };
+  ImageType::Pointer  images[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    images[i] = ImageType::New();
+    images[i]->SetRegions( size );
+    images[i]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[i], images[i]->GetLargestPossibleRegion() );
+    for( ; !it.IsAtEnd(); ++it )
+      {
+      const ImageType::IndexType index = it.GetIndex();
+      const double               x = index[0] - 20.0 - 3.0 * i;
+      const double               y = index[1] - 18.0 + 2.0 * i;
+      it.Set( 100.0 * std::exp( -( x * x + y * y ) / 150.0 ) + ( index[0] * 7 + index[1] * 13 ) % 11 );
+      }
+    }
+
+  TransformType::Pointer transform = TransformType::New();
+  TransformType::ParametersType parameters = transform->GetParameters();
+  parameters[0] = 1.05;
+  parameters[1] = 0.1;
+  parameters[4] = 1.5;
+  parameters[5] = -0.7;
+  transform->SetParameters( parameters );
+
+  typedef itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType > MeanSquaresMetricType;
+  typedef itk::CorrelationImageToImageMetricv4< ImageType, ImageType > CorrelationMetricType;
+
+  int status = EXIT_SUCCESS;
+  status |= ImageToImageMetricv4ValueAndGradientImageCheck< MeanSquaresMetricType >( images[0], images[1], transform,
+                                                                                     "MeanSquares" );
+  status |= ImageToImageMetricv4ValueAndGradientImageCheck< CorrelationMetricType >( images[0], images[1], transform,
+                                                                                     "Correlation" );
+
+  // metrics using the same moving image and gradient filter share the value
+  // and gradient image through the cache of the multi metric
+  MeanSquaresMetricType::Pointer meanSquaresMetric = MeanSquaresMetricType::New();
+  CorrelationMetricType::Pointer correlationMetric = CorrelationMetricType::New();
+  MeanSquaresMetricType::DefaultMovingImageGradientFilter::Pointer gradientFilter =
+    MeanSquaresMetricType::DefaultMovingImageGradientFilter::New();
+  gradientFilter->SetSigma( 1.0 );
+  meanSquaresMetric->SetMovingImageGradientFilter( gradientFilter );
+  correlationMetric->SetMovingImageGradientFilter( gradientFilter );
+
+  typedef itk::ObjectToObjectMultiMetricv4< Dimension, Dimension, ImageType > MultiMetricType;
+  MultiMetricType::Pointer multiMetric = MultiMetricType::New();
+  multiMetric->AddMetric( meanSquaresMetric );
+  multiMetric->AddMetric( correlationMetric );
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    ImageType * fixedImage = images[i];
+    ImageType * movingImage = images[1 - i];
+    meanSquaresMetric->SetFixedImage( fixedImage );
+    meanSquaresMetric->SetMovingImage( movingImage );
+    meanSquaresMetric->SetMovingTransform( transform );
+    meanSquaresMetric->UseMovingImageValueAndGradientImageOn();
+    correlationMetric->SetFixedImage( fixedImage );
+    correlationMetric->SetMovingImage( movingImage );
+    correlationMetric->SetMovingTransform( transform );
+    correlationMetric->UseMovingImageValueAndGradientImageOn();
+    multiMetric->Initialize();
+
+    if( meanSquaresMetric->GetMovingImageValueAndGradientCache() != correlationMetric->GetMovingImageValueAndGradientCache() )
+      {
+      std::cerr << "The metrics don't share their cache." << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( meanSquaresMetric->GetMovingImageValueAndGradientImage() == ITK_NULLPTR ||
+        meanSquaresMetric->GetMovingImageValueAndGradientImage() != correlationMetric->GetMovingImageValueAndGradientImage() )
+      {
+      std::cerr << "The metrics don't share their value and gradient image." << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( meanSquaresMetric->GetMovingImageValueAndGradientCache()->GetNumberOfValueAndGradientImages() != 1 )
+      {
+      std::cerr << "Wrong number of value and gradient images in the cache: "
+                << meanSquaresMetric->GetMovingImageValueAndGradientCache()->GetNumberOfValueAndGradientImages() << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // the shared image interleaves the values and gradients of the moving image
+    ImageType::IndexType index = { { 13, 21 } };
+    const MeanSquaresMetricType::MovingImageValueAndGradientImageType::PixelType valueAndGradient =
+      meanSquaresMetric->GetMovingImageValueAndGradientImage()->GetPixel( index );
+    const MeanSquaresMetricType::MovingGradientPixelType gradient =
+      meanSquaresMetric->GetMovingImageGradientImage()->GetPixel( index );
+    if( valueAndGradient[0] != movingImage->GetPixel( index ) ||
+        valueAndGradient[1] != gradient[0] || valueAndGradient[2] != gradient[1] )
+      {
+      std::cerr << "Wrong value and gradient " << valueAndGradient << " at " << index << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    MultiMetricType::MeasureType    value;
+    MultiMetricType::DerivativeType derivative;
+    multiMetric->GetValueAndDerivative( value, derivative );
+    }
+
+  if( status == EXIT_SUCCESS )
+    {
+    std::cout << "Test passed." << std::endl;
+    }
+  return status;
+}
@@ -0,0 +1,108 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMattesMutualInformationImageToImageMetricv4.h"
+#include "itkAffineTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Check that the value and derivative of the metric don't depend on the
+ * number of threads, whether the threads accumulate the joint PDF
+ * derivatives in their own copy or share them.
+ */
+
+int itkMattesMutualInformationImageToImageMetricv4ThreadingTest(int, char* [])
+{
+  const unsigned int Dimension = 2;
+  typedef itk::Image< float, Dimension >                                           ImageType;
+  typedef itk::MattesMutualInformationImageToImageMetricv4< ImageType, ImageType > MetricType;
+  typedef itk::AffineTransform< double, Dimension >                                TransformType;
+
+  // two shifted blobs, with some texture
+  ImageType::SizeType size = { { 64, 57 } };
+  ImageType::Pointer  images[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    images[i] = ImageType::New();
+    images[i]->SetRegions( size );
+    images[i]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[i], images[i]->GetLargestPossibleRegion() );
+    for( ; !it.IsAtEnd(); ++it )
+      {
+      const ImageType::IndexType index = it.GetIndex();
+      const double               x = index[0] - 32.0 - 3.0 * i;
+      const double               y = index[1] - 28.0 + 2.0 * i;
+      it.Set( 100.0 * std::exp( -( x * x + y * y ) / 300.0 ) + ( index[0] * 7 + index[1] * 13 ) % 11 );
+      }
+    }
+
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetIdentity();
+
+  MetricType::MeasureType    referenceValue = 0.0;
+  MetricType::DerivativeType referenceDerivative;
+  for( unsigned int shared = 0; shared < 2; ++shared )
+    {
+    for( itk::ThreadIdType threads = 1; threads <= 4; ++threads )
+      {
+      MetricType::Pointer metric = MetricType::New();
+      metric->SetFixedImage( images[0] );
+      metric->SetMovingImage( images[1] );
+      metric->SetMovingTransform( transform );
+      metric->SetNumberOfHistogramBins( 20 );
+      metric->SetMaximumNumberOfThreads( threads );
+      if( shared )
+        {
+        // a single accumulator shared by all the threads
+        metric->SetJointPDFDerivativesMemoryLimit( 0 );
+        }
+      metric->Initialize();
+
+      MetricType::MeasureType    value;
+      MetricType::DerivativeType derivative;
+      metric->GetValueAndDerivative( value, derivative );
+
+      if( shared == 0 && threads == 1 )
+        {
+        referenceValue = value;
+        referenceDerivative = derivative;
+        continue;
+        }
+
+      const double tolerance = 1e-8;
+      if( std::abs( value - referenceValue ) > tolerance * std::abs( referenceValue ) )
+        {
+        std::cerr << "Wrong value with " << threads << " threads (shared: " << shared << "): expected "
+                  << referenceValue << ", got " << value << std::endl;
+        return EXIT_FAILURE;
+        }
+      for( unsigned int p = 0; p < derivative.Size(); ++p )
+        {
+        if( std::abs( derivative[p] - referenceDerivative[p] ) > tolerance * ( 1.0 + std::abs( referenceDerivative[p] ) ) )
+          {
+          std::cerr << "Wrong derivative with " << threads << " threads (shared: " << shared << "): expected "
+                    << referenceDerivative << ", got " << derivative << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
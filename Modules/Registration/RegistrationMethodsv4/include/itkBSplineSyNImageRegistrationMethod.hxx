@@ -21,7 +21,6 @@
 #include "itkBSplineSyNImageRegistrationMethod.h"
 
 #include "itkBSplineSmoothingOnUpdateDisplacementFieldTransformParametersAdaptor.h"
-#include "itkComposeDisplacementFieldsImageFilter.h"
 #include "itkImportImageFilter.h"
 #include "itkInvertDisplacementFieldImageFilter.h"
 #include "itkIterationReporter.h"
@@ -153,32 +152,25 @@ BSplineSyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, T
 
     if ( this->m_AverageMidPointGradients )
       {
-      ImageRegionIteratorWithIndex<DisplacementFieldType> ItF( fixedToMiddleSmoothUpdateField, fixedToMiddleSmoothUpdateField->GetLargestPossibleRegion() );
-      for( ItF.GoToBegin(); !ItF.IsAtEnd(); ++ItF )
+      // Both update fields are defined on the virtual domain.
+      ImageRegionIterator<DisplacementFieldType> ItF( fixedToMiddleSmoothUpdateField, fixedToMiddleSmoothUpdateField->GetLargestPossibleRegion() );
+      ImageRegionIterator<DisplacementFieldType> ItM( movingToMiddleSmoothUpdateField, fixedToMiddleSmoothUpdateField->GetLargestPossibleRegion() );
+      for( ItF.GoToBegin(), ItM.GoToBegin(); !ItF.IsAtEnd(); ++ItF, ++ItM )
         {
-        ItF.Set( ItF.Get() - movingToMiddleSmoothUpdateField->GetPixel( ItF.GetIndex() ) );
-        movingToMiddleSmoothUpdateField->SetPixel( ItF.GetIndex(), -ItF.Get() );
+        ItF.Set( ItF.Get() - ItM.Get() );
+        ItM.Set( -ItF.Get() );
         }
       }
 
-    // Add the update field to both displacement fields (from fixed/moving to middle image) and then smooth
+    // Add the update field to both displacement fields (from fixed/moving to middle image) and then smooth.
+    // The smoothing reads the composed field before it is reused.
 
-    typedef ComposeDisplacementFieldsImageFilter<DisplacementFieldType> ComposerType;
-
-    typename ComposerType::Pointer fixedComposer = ComposerType::New();
-    fixedComposer->SetDisplacementField( fixedToMiddleSmoothUpdateField );
-    fixedComposer->SetWarpingField( this->m_FixedToMiddleTransform->GetDisplacementField() );
-    fixedComposer->Update();
-
-    DisplacementFieldPointer fixedToMiddleSmoothTotalFieldTmp = this->BSplineSmoothDisplacementField( fixedComposer->GetOutput(),
+    DisplacementFieldPointer fixedToMiddleSmoothTotalFieldTmp = this->BSplineSmoothDisplacementField(
+      this->ComposeUpdateField( fixedToMiddleSmoothUpdateField, this->m_FixedToMiddleTransform->GetDisplacementField() ),
       this->m_FixedToMiddleTransform->GetNumberOfControlPointsForTheTotalField(), ITK_NULLPTR, ITK_NULLPTR );
 
-    typename ComposerType::Pointer movingComposer = ComposerType::New();
-    movingComposer->SetDisplacementField( movingToMiddleSmoothUpdateField );
-    movingComposer->SetWarpingField( this->m_MovingToMiddleTransform->GetDisplacementField() );
-    movingComposer->Update();
-
-    DisplacementFieldPointer movingToMiddleSmoothTotalFieldTmp = this->BSplineSmoothDisplacementField( movingComposer->GetOutput(),
+    DisplacementFieldPointer movingToMiddleSmoothTotalFieldTmp = this->BSplineSmoothDisplacementField(
+      this->ComposeUpdateField( movingToMiddleSmoothUpdateField, this->m_MovingToMiddleTransform->GetDisplacementField() ),
       this->m_MovingToMiddleTransform->GetNumberOfControlPointsForTheTotalField(), ITK_NULLPTR, ITK_NULLPTR );
 
     // Iteratively estimate the inverse fields.
@@ -315,17 +307,16 @@ BSplineSyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, T
   const ArrayType & numberOfControlPoints, const WeightedMaskImageType * mask,
   const BSplinePointSetType * gradientPointSet )
 {
-  typedef ImageDuplicator<DisplacementFieldType> DuplicatorType;
-  typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
-  duplicator->SetInputImage( field );
-  duplicator->Update();
-
-  DisplacementFieldPointer smoothField = duplicator->GetModifiableOutput();
-
   for( unsigned int d = 0; d < numberOfControlPoints.Size(); d++ )
     {
     if( numberOfControlPoints[d] <= 0 )
       {
+      typedef ImageDuplicator<DisplacementFieldType> DuplicatorType;
+      typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
+      duplicator->SetInputImage( field );
+      duplicator->Update();
+
+      DisplacementFieldPointer smoothField = duplicator->GetModifiableOutput();
       return smoothField;
       }
     }
@@ -353,7 +344,10 @@ BSplineSyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, T
   bspliner->SetEstimateInverse( false );
   bspliner->Update();
 
-  smoothField = bspliner->GetOutput();
+  // The smoothed field must not be computed again from a composed field
+  // which is reused by the next iterations.
+  DisplacementFieldPointer smoothField = bspliner->GetOutput();
+  smoothField->DisconnectPipeline();
 
   return smoothField;
 }
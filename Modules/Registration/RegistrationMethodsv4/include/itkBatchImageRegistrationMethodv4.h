@@ -0,0 +1,240 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBatchImageRegistrationMethodv4_h
+#define itkBatchImageRegistrationMethodv4_h
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class BatchImageRegistrationMethodv4
+ * \brief Register many moving images to one fixed image, running several
+ * registrations concurrently.
+ *
+ * Registering a set of images to a template, e.g. to build an atlas, runs
+ * the same registration for each moving image. This class schedules these
+ * registrations over a budget of NumberOfThreads threads: up to
+ * NumberOfConcurrentRegistrations registrations run at the same time, each
+ * one with <tt>NumberOfThreads / NumberOfConcurrentRegistrations</tt>
+ * threads for its smoothing, its metrics, their gradient filters and its
+ * optimizer.
+ *
+ * The fixed side is shared by all the registrations and only read by
+ * them: the fixed image, its optional mask, which is set on the image
+ * metrics, and a SharedImagePyramid holding the smoothed fixed images of
+ * the levels, which are thus computed only once. The fixed image and the
+ * mask are updated before the registrations start, and each registration
+ * gets a graft of the fixed image, without source, so that the pipelines
+ * of concurrent registrations do not modify the same image. The gradient
+ * of the fixed image is still computed by the metric of each registration.
+ *
+ * Each registration is created by CreateRegistration(), which creates a
+ * default TRegistration. Derived classes override it to set the metric,
+ * the optimizer and the levels of their registrations; the fixed image,
+ * the moving image, the mask, the pyramid and the numbers of threads are
+ * set afterwards by this class. The moving images are either set with
+ * SetMovingImage(), or read on demand by overriding LoadMovingImage(), so
+ * that only the moving images being registered are in memory.
+ *
+ * The registrations are reported as they finish, and not in the order of
+ * the moving images: RegistrationCompleted() keeps the output transform,
+ * unless KeepOutputTransforms is off, and invokes an IterationEvent, during
+ * which GetCurrentIndex() and GetCurrentRegistration() give the finished
+ * registration, e.g. for an observer writing its transform to disk. These
+ * reports are serialized, but come from the threads running the
+ * registrations. A registration throwing an exception is reported by
+ * GetErrorDescription(), and does not stop the others.
+ *
+ * \sa ImageRegistrationMethodv4
+ * \sa SharedImagePyramid
+ *
+ * \ingroup ITKRegistrationMethodsv4
+ */
+template<typename TRegistration>
+class BatchImageRegistrationMethodv4
+:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef BatchImageRegistrationMethodv4            Self;
+  typedef Object                                    Superclass;
+  typedef SmartPointer<Self>                        Pointer;
+  typedef SmartPointer<const Self>                  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( BatchImageRegistrationMethodv4, Object );
+
+  /** Type of the registrations. */
+  typedef TRegistration                                               RegistrationType;
+  typedef typename RegistrationType::Pointer                          RegistrationPointer;
+
+  typedef typename RegistrationType::FixedImageType                   FixedImageType;
+  typedef typename FixedImageType::Pointer                            FixedImagePointer;
+  typedef typename FixedImageType::ConstPointer                       FixedImageConstPointer;
+  typedef typename RegistrationType::MovingImageType                  MovingImageType;
+  typedef typename MovingImageType::ConstPointer                      MovingImageConstPointer;
+  typedef std::vector<MovingImageConstPointer>                        MovingImagesContainerType;
+
+  typedef typename RegistrationType::OutputTransformType              OutputTransformType;
+  typedef typename OutputTransformType::Pointer                       OutputTransformPointer;
+  typedef std::vector<OutputTransformPointer>                         OutputTransformsContainerType;
+
+  typedef typename RegistrationType::MetricType                       MetricType;
+  typedef typename RegistrationType::MultiMetricType                  MultiMetricType;
+  typedef typename RegistrationType::ImageMetricType                  ImageMetricType;
+  typedef typename ImageMetricType::FixedImageMaskType                FixedImageMaskType;
+  typedef typename FixedImageMaskType::ConstPointer                   FixedImageMaskConstPointer;
+
+  typedef typename RegistrationType::FixedImagePyramidType            FixedImagePyramidType;
+  typedef typename FixedImagePyramidType::Pointer                     FixedImagePyramidPointer;
+
+  /** Set/Get the fixed image, shared by all the registrations. */
+  itkSetConstObjectMacro( FixedImage, FixedImageType );
+  itkGetConstObjectMacro( FixedImage, FixedImageType );
+
+  /** Set/Get the optional fixed image mask, set on the image metrics of
+   * all the registrations. */
+  itkSetConstObjectMacro( FixedImageMask, FixedImageMaskType );
+  itkGetConstObjectMacro( FixedImageMask, FixedImageMaskType );
+
+  /** Set/Get the pyramid holding the smoothed fixed images. A pyramid is
+   * created by default; setting it allows to share it with other
+   * registrations of the same fixed image. */
+  itkSetObjectMacro( FixedImagePyramid, FixedImagePyramidType );
+  itkGetModifiableObjectMacro( FixedImagePyramid, FixedImagePyramidType );
+
+  /** Set/Get the number of moving images, i.e. of registrations. Setting it
+   * keeps the moving images already set with a smaller index. */
+  virtual void SetNumberOfMovingImages( SizeValueType number );
+  virtual SizeValueType GetNumberOfMovingImages() const;
+
+  /** Set/Get the moving image of a registration, increasing the number of
+   * moving images if needed. */
+  virtual void SetMovingImage( SizeValueType index, const MovingImageType * image );
+  virtual const MovingImageType * GetMovingImage( SizeValueType index ) const;
+
+  /** Add a moving image after the others. */
+  virtual void AddMovingImage( const MovingImageType * image );
+
+  /** Set/Get the number of threads shared by the registrations. Defaults to
+   * the global default number of threads. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Set/Get the maximum number of registrations running at the same time.
+   * Defaults to the global default number of threads. */
+  itkSetClampMacro( NumberOfConcurrentRegistrations, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfConcurrentRegistrations, ThreadIdType );
+
+  /** Set/Get whether the output transforms are kept once the registrations
+   * are finished. Turn it off when an observer of the IterationEvent
+   * stores them, to keep the memory bounded. Defaults to true. */
+  itkSetMacro( KeepOutputTransforms, bool );
+  itkGetConstMacro( KeepOutputTransforms, bool );
+  itkBooleanMacro( KeepOutputTransforms );
+
+  /** Run all the registrations. */
+  virtual void StartRegistrations();
+
+  /** Get the output transform of a registration, or a null pointer if the
+   * registration failed, or if KeepOutputTransforms is off. */
+  virtual OutputTransformType * GetOutputTransform( SizeValueType index ) const;
+
+  /** Get the description of the exception thrown by a registration, or an
+   * empty string if it succeeded. */
+  virtual std::string GetErrorDescription( SizeValueType index ) const;
+
+  /** Get the number of registrations which threw an exception. */
+  itkGetConstMacro( NumberOfFailedRegistrations, SizeValueType );
+
+  /** Get the index of the registration being reported, during an
+   * IterationEvent. */
+  itkGetConstMacro( CurrentIndex, SizeValueType );
+
+  /** Get the registration being reported, during an IterationEvent. */
+  itkGetModifiableObjectMacro( CurrentRegistration, RegistrationType );
+
+protected:
+  BatchImageRegistrationMethodv4();
+  virtual ~BatchImageRegistrationMethodv4() {}
+
+  virtual void PrintSelf( std::ostream & os, Indent indent ) const ITK_OVERRIDE;
+
+  /** Create the registration of a moving image. Called from the threads
+   * running the registrations, one at a time. */
+  virtual RegistrationPointer CreateRegistration( SizeValueType index );
+
+  /** Get the moving image of a registration, by default the image set with
+   * SetMovingImage(). Derived classes may read it instead. Called from the
+   * threads running the registrations, concurrently. */
+  virtual MovingImageConstPointer LoadMovingImage( SizeValueType index );
+
+  /** Report a finished registration. Called from the threads running the
+   * registrations, one at a time. */
+  virtual void RegistrationCompleted( SizeValueType index, RegistrationType * registration );
+
+  /** Run the registrations taken from the queue, in one thread. */
+  virtual void ThreadedRegistrations();
+
+private:
+  BatchImageRegistrationMethodv4( const Self & );  //purposely not implemented
+  void operator=( const Self & );                   //purposely not implemented
+
+  /** Set up and run one registration. */
+  void RunRegistration( SizeValueType index );
+
+  static ITK_THREAD_RETURN_TYPE RegistrationsThreaderCallback( void * arg );
+
+  FixedImageConstPointer                                          m_FixedImage;
+  FixedImageMaskConstPointer                                      m_FixedImageMask;
+  FixedImagePyramidPointer                                        m_FixedImagePyramid;
+  MovingImagesContainerType                                       m_MovingImages;
+
+  ThreadIdType                                                    m_NumberOfThreads;
+  ThreadIdType                                                    m_NumberOfConcurrentRegistrations;
+  bool                                                            m_KeepOutputTransforms;
+
+  OutputTransformsContainerType                                   m_OutputTransforms;
+  std::vector<std::string>                                        m_ErrorDescriptions;
+  SizeValueType                                                   m_NumberOfFailedRegistrations;
+
+  SizeValueType                                                   m_CurrentIndex;
+  RegistrationPointer                                             m_CurrentRegistration;
+
+  /** Index of the next registration to run, and number of threads of
+   * each registration. */
+  SizeValueType                                                   m_NextIndex;
+  ThreadIdType                                                    m_NumberOfThreadsPerRegistration;
+  SimpleFastMutexLock                                             m_Mutex;
+  MultiThreader::Pointer                                          m_RegistrationsThreader;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBatchImageRegistrationMethodv4.hxx"
+#endif
+
+#endif
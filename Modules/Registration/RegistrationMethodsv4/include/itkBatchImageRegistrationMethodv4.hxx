@@ -0,0 +1,375 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBatchImageRegistrationMethodv4_hxx
+#define itkBatchImageRegistrationMethodv4_hxx
+
+#include "itkBatchImageRegistrationMethodv4.h"
+#include "itkMutexLockHolder.h"
+
+#include <algorithm>
+
+namespace itk
+{
+/**
+ * Constructor
+ */
+template<typename TRegistration>
+BatchImageRegistrationMethodv4<TRegistration>
+::BatchImageRegistrationMethodv4()
+{
+  this->m_FixedImage = ITK_NULLPTR;
+  this->m_FixedImageMask = ITK_NULLPTR;
+  this->m_FixedImagePyramid = FixedImagePyramidType::New();
+
+  this->m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->m_NumberOfConcurrentRegistrations = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->m_KeepOutputTransforms = true;
+
+  this->m_NumberOfFailedRegistrations = 0;
+  this->m_CurrentIndex = 0;
+  this->m_CurrentRegistration = ITK_NULLPTR;
+
+  this->m_NextIndex = 0;
+  this->m_NumberOfThreadsPerRegistration = 1;
+  this->m_RegistrationsThreader = MultiThreader::New();
+}
+
+template<typename TRegistration>
+void
+BatchImageRegistrationMethodv4<TRegistration>
+::SetNumberOfMovingImages( SizeValueType number )
+{
+  if( number != this->m_MovingImages.size() )
+    {
+    this->m_MovingImages.resize( number );
+    this->Modified();
+    }
+}
+
+template<typename TRegistration>
+SizeValueType
+BatchImageRegistrationMethodv4<TRegistration>
+::GetNumberOfMovingImages() const
+{
+  return static_cast<SizeValueType>( this->m_MovingImages.size() );
+}
+
+template<typename TRegistration>
+void
+BatchImageRegistrationMethodv4<TRegistration>
+::SetMovingImage( SizeValueType index, const MovingImageType * image )
+{
+  if( index >= this->m_MovingImages.size() )
+    {
+    this->m_MovingImages.resize( index + 1 );
+    }
+  if( this->m_MovingImages[index] != image )
+    {
+    this->m_MovingImages[index] = image;
+    this->Modified();
+    }
+}
+
+template<typename TRegistration>
+const typename BatchImageRegistrationMethodv4<TRegistration>::MovingImageType *
+BatchImageRegistrationMethodv4<TRegistration>
+::GetMovingImage( SizeValueType index ) const
+{
+  if( index >= this->m_MovingImages.size() )
+    {
+    itkExceptionMacro( "Moving image " << index << " doesn't exist, there are only "
+                       << this->m_MovingImages.size() << " moving images." );
+    }
+  return this->m_MovingImages[index].GetPointer();
+}
+
+template<typename TRegistration>
+void
+BatchImageRegistrationMethodv4<TRegistration>
+::AddMovingImage( const MovingImageType * image )
+{
+  this->m_MovingImages.push_back( image );
+  this->Modified();
+}
+
+template<typename TRegistration>
+void
+BatchImageRegistrationMethodv4<TRegistration>
+::StartRegistrations()
+{
+  if( this->m_FixedImage.IsNull() )
+    {
+    itkExceptionMacro( "The fixed image is not set." );
+    }
+  if( this->m_FixedImagePyramid.IsNull() )
+    {
+    itkExceptionMacro( "The fixed image pyramid is not set." );
+    }
+
+  const SizeValueType numberOfRegistrations = this->GetNumberOfMovingImages();
+
+  this->m_OutputTransforms.assign( numberOfRegistrations, ITK_NULLPTR );
+  this->m_ErrorDescriptions.assign( numberOfRegistrations, std::string() );
+  this->m_NumberOfFailedRegistrations = 0;
+  this->m_CurrentIndex = 0;
+  this->m_CurrentRegistration = ITK_NULLPTR;
+  this->m_NextIndex = 0;
+
+  const ThreadIdType numberOfConcurrentRegistrations = static_cast<ThreadIdType>(
+    std::max( std::min( static_cast<SizeValueType>( this->m_NumberOfConcurrentRegistrations ), numberOfRegistrations ),
+              static_cast<SizeValueType>( 1 ) ) );
+  this->m_NumberOfThreadsPerRegistration =
+    std::max( this->m_NumberOfThreads / numberOfConcurrentRegistrations, static_cast<ThreadIdType>( 1 ) );
+
+  // The fixed image and the mask are only read by the registrations, and
+  // must not be updated concurrently by them.
+  if( this->m_FixedImage->GetSource() )
+    {
+    this->m_FixedImage->GetSource()->Update();
+    }
+  if( this->m_FixedImageMask.IsNotNull() && this->m_FixedImageMask->GetSource() )
+    {
+    this->m_FixedImageMask->GetSource()->Update();
+    }
+  this->m_FixedImagePyramid->SetNumberOfThreads( this->m_NumberOfThreadsPerRegistration );
+
+  this->InvokeEvent( StartEvent() );
+
+  if( numberOfConcurrentRegistrations <= 1 )
+    {
+    this->ThreadedRegistrations();
+    }
+  else
+    {
+    this->m_RegistrationsThreader->SetNumberOfThreads( numberOfConcurrentRegistrations );
+    this->m_RegistrationsThreader->SetSingleMethod( Self::RegistrationsThreaderCallback, this );
+    this->m_RegistrationsThreader->SingleMethodExecute();
+    }
+
+  this->m_CurrentRegistration = ITK_NULLPTR;
+
+  this->InvokeEvent( EndEvent() );
+}
+
+template<typename TRegistration>
+void
+BatchImageRegistrationMethodv4<TRegistration>
+::ThreadedRegistrations()
+{
+  const SizeValueType numberOfRegistrations = this->GetNumberOfMovingImages();
+  while( true )
+    {
+    SizeValueType index;
+      {
+      MutexLockHolder<SimpleFastMutexLock> holder( this->m_Mutex );
+      if( this->m_NextIndex >= numberOfRegistrations )
+        {
+        return;
+        }
+      index = this->m_NextIndex++;
+      }
+    this->RunRegistration( index );
+    }
+}
+
+template<typename TRegistration>
+void
+BatchImageRegistrationMethodv4<TRegistration>
+::RunRegistration( SizeValueType index )
+{
+  // The registration and its moving image are released as soon as the
+  // registration is reported, so that only the registrations running are
+  // kept in memory.
+  RegistrationPointer registration;
+  try
+    {
+    MovingImageConstPointer movingImage = this->LoadMovingImage( index );
+    if( movingImage.IsNull() )
+      {
+      itkExceptionMacro( "Moving image " << index << " is not set." );
+      }
+
+      {
+      MutexLockHolder<SimpleFastMutexLock> holder( this->m_Mutex );
+      registration = this->CreateRegistration( index );
+      }
+    if( registration.IsNull() )
+      {
+      itkExceptionMacro( "No registration was created for moving image " << index << "." );
+      }
+
+    // The pipeline of the registration sets the requested region of the
+    // fixed image, which is thus grafted into an image of its own. The
+    // pyramid recognizes the graft, and shares its smoothed images.
+    FixedImagePointer fixedImage = FixedImageType::New();
+    fixedImage->Graft( this->m_FixedImage );
+
+    registration->SetFixedImage( fixedImage );
+    registration->SetMovingImage( movingImage );
+    registration->SetFixedImagePyramid( this->m_FixedImagePyramid );
+    registration->SetNumberOfThreads( this->m_NumberOfThreadsPerRegistration );
+
+    MetricType * metric = registration->GetModifiableMetric();
+    std::vector<MetricType *> metrics;
+    if( metric->GetMetricCategory() == MetricType::MULTI_METRIC )
+      {
+      MultiMetricType * multiMetric = dynamic_cast<MultiMetricType *>( metric );
+      for( SizeValueType n = 0; n < multiMetric->GetNumberOfMetrics(); n++ )
+        {
+        metrics.push_back( multiMetric->GetMetricQueue()[n].GetPointer() );
+        }
+      }
+    metrics.push_back( metric );
+    for( typename std::vector<MetricType *>::const_iterator it = metrics.begin(); it != metrics.end(); ++it )
+      {
+      ( *it )->SetMaximumNumberOfThreads( this->m_NumberOfThreadsPerRegistration );
+      ImageMetricType * imageMetric = dynamic_cast<ImageMetricType *>( *it );
+      if( imageMetric )
+        {
+        imageMetric->GetModifiableFixedImageGradientFilter()->SetNumberOfThreads( this->m_NumberOfThreadsPerRegistration );
+        imageMetric->GetModifiableMovingImageGradientFilter()->SetNumberOfThreads( this->m_NumberOfThreadsPerRegistration );
+        if( this->m_FixedImageMask.IsNotNull() )
+          {
+          imageMetric->SetFixedImageMask( this->m_FixedImageMask );
+          }
+        }
+      }
+    registration->GetModifiableOptimizer()->SetNumberOfThreads( this->m_NumberOfThreadsPerRegistration );
+
+    registration->Update();
+    }
+  catch( ExceptionObject & e )
+    {
+    MutexLockHolder<SimpleFastMutexLock> holder( this->m_Mutex );
+    this->m_ErrorDescriptions[index] = e.GetDescription();
+    ++this->m_NumberOfFailedRegistrations;
+    return;
+    }
+  catch( std::exception & e )
+    {
+    MutexLockHolder<SimpleFastMutexLock> holder( this->m_Mutex );
+    this->m_ErrorDescriptions[index] = e.what();
+    ++this->m_NumberOfFailedRegistrations;
+    return;
+    }
+  catch( ... )
+    {
+    MutexLockHolder<SimpleFastMutexLock> holder( this->m_Mutex );
+    this->m_ErrorDescriptions[index] = "Unknown exception.";
+    ++this->m_NumberOfFailedRegistrations;
+    return;
+    }
+
+  MutexLockHolder<SimpleFastMutexLock> holder( this->m_Mutex );
+  this->RegistrationCompleted( index, registration );
+}
+
+template<typename TRegistration>
+typename BatchImageRegistrationMethodv4<TRegistration>::RegistrationPointer
+BatchImageRegistrationMethodv4<TRegistration>
+::CreateRegistration( SizeValueType itkNotUsed( index ) )
+{
+  return RegistrationType::New();
+}
+
+template<typename TRegistration>
+typename BatchImageRegistrationMethodv4<TRegistration>::MovingImageConstPointer
+BatchImageRegistrationMethodv4<TRegistration>
+::LoadMovingImage( SizeValueType index )
+{
+  return this->GetMovingImage( index );
+}
+
+template<typename TRegistration>
+void
+BatchImageRegistrationMethodv4<TRegistration>
+::RegistrationCompleted( SizeValueType index, RegistrationType * registration )
+{
+  if( this->m_KeepOutputTransforms )
+    {
+    this->m_OutputTransforms[index] = registration->GetModifiableTransform();
+    }
+
+  this->m_CurrentIndex = index;
+  this->m_CurrentRegistration = registration;
+  this->InvokeEvent( IterationEvent() );
+  this->m_CurrentRegistration = ITK_NULLPTR;
+}
+
+template<typename TRegistration>
+typename BatchImageRegistrationMethodv4<TRegistration>::OutputTransformType *
+BatchImageRegistrationMethodv4<TRegistration>
+::GetOutputTransform( SizeValueType index ) const
+{
+  if( index >= this->m_OutputTransforms.size() )
+    {
+    itkExceptionMacro( "Output transform " << index << " doesn't exist, there are only "
+                       << this->m_OutputTransforms.size() << " output transforms." );
+    }
+  return this->m_OutputTransforms[index].GetPointer();
+}
+
+template<typename TRegistration>
+std::string
+BatchImageRegistrationMethodv4<TRegistration>
+::GetErrorDescription( SizeValueType index ) const
+{
+  if( index >= this->m_ErrorDescriptions.size() )
+    {
+    itkExceptionMacro( "Registration " << index << " doesn't exist, there are only "
+                       << this->m_ErrorDescriptions.size() << " registrations." );
+    }
+  return this->m_ErrorDescriptions[index];
+}
+
+template<typename TRegistration>
+ITK_THREAD_RETURN_TYPE
+BatchImageRegistrationMethodv4<TRegistration>
+::RegistrationsThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * self = static_cast<Self *>( info->UserData );
+  self->ThreadedRegistrations();
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/*
+ * PrintSelf
+ */
+template<typename TRegistration>
+void
+BatchImageRegistrationMethodv4<TRegistration>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Number of moving images: " << this->m_MovingImages.size() << std::endl;
+  os << indent << "Number of threads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "Number of concurrent registrations: " << this->m_NumberOfConcurrentRegistrations << std::endl;
+  os << indent << "Keep output transforms: " << ( this->m_KeepOutputTransforms ? "On" : "Off" ) << std::endl;
+  os << indent << "Number of failed registrations: " << this->m_NumberOfFailedRegistrations << std::endl;
+  if( this->m_FixedImagePyramid.IsNotNull() )
+    {
+    os << indent << "Fixed image pyramid: " << std::endl;
+    this->m_FixedImagePyramid->Print( os, indent.GetNextIndent() );
+    }
+}
+
+} // end namespace itk
+
+#endif
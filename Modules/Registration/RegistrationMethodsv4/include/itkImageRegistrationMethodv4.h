@@ -28,8 +28,10 @@
 #include "itkImageToImageMetricv4.h"
 #include "itkPointSetToPointSetMetricv4.h"
 #include "itkShrinkImageFilter.h"
+#include "itkSharedImagePyramid.h"
 #include "itkIdentityTransform.h"
 #include "itkTransformParametersAdaptorBase.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 #include <vector>
 
@@ -79,6 +81,28 @@ namespace itk
  * given stage so typical use will be to assign the base adaptor class to
  * level 0 of all stages but we leave that open to the user.
  *
+ * Metric sampling:  Image metrics can be evaluated on a subset of the
+ * virtual domain, drawn at each level according to the metric sampling
+ * strategy and percentage.  With MetricSamplingPerIteration, new samples
+ * are drawn at each iteration of the optimizer, so that each iteration only
+ * processes a small mini-batch, and the size of the mini-batches can grow
+ * along the iterations (see MetricSamplingGrowthFactor).  The sample point
+ * sets are allocated once and reused.
+ *
+ * Image pyramids:  By default, the fixed and moving images are smoothed
+ * for each level when the registration reaches it.  When a fixed or moving
+ * image pyramid is set, the smoothed images of all the levels are computed
+ * once, by increasing sigma, each one from the previous one, and are kept
+ * in the pyramid.  Registrations sharing a pyramid, e.g. the registrations
+ * of an atlas to many subjects, possibly running in different threads,
+ * thus smooth each image only once.
+ *
+ * Warm start:  By default, the optimizer starts each level afresh, i.e. it
+ * estimates again its parameter scales over sampled points, and its learning
+ * rate for the gradient descent optimizers.  With WarmStartOptimizer, the
+ * scales and the learning rate estimated at the first level are kept for the
+ * next levels, as long as the number of transform parameters is unchanged.
+ *
  * Output: The output is the updated transform.
  *
  * \author Nick Tustison
@@ -178,8 +202,15 @@ public:
   /** Weights type for the optimizer. */
   typedef typename OptimizerType::ScalesType                          OptimizerWeightsType;
 
-  /** enum type for metric sampling strategy */
-  enum MetricSamplingStrategyType { NONE, REGULAR, RANDOM };
+  /** enum type for metric sampling strategy:
+   *   \li REGULAR: every n-th voxel of the virtual domain, randomly perturbed,
+   *   \li RANDOM: voxels of the virtual domain drawn uniformly,
+   *   \li STRATIFIED: one random point in each cell of a regular grid
+   *       dividing the virtual domain,
+   *   \li GRADIENT_MAGNITUDE: voxels of the virtual domain drawn with a
+   *       probability proportional to the gradient magnitude of the first
+   *       fixed image, to focus the samples on the edges. */
+  enum MetricSamplingStrategyType { NONE, REGULAR, RANDOM, STRATIFIED, GRADIENT_MAGNITUDE };
 
   typedef typename ImageMetricType::FixedSampledPointSetType          MetricSamplePointSetType;
 
@@ -261,6 +292,38 @@ public:
   itkSetMacro( MetricSamplingPercentagePerLevel, MetricSamplingPercentageArrayType );
   itkGetConstMacro( MetricSamplingPercentagePerLevel, MetricSamplingPercentageArrayType );
 
+  /**
+   * Set/Get whether new metric samples are drawn at each iteration of the
+   * optimizer, i.e. whether the metric is evaluated on mini-batches as in
+   * stochastic gradient descent, instead of on a single sample set per
+   * level. Only used with a sampling strategy. Default is false.
+   */
+  itkSetMacro( MetricSamplingPerIteration, bool );
+  itkGetConstMacro( MetricSamplingPerIteration, bool );
+  itkBooleanMacro( MetricSamplingPerIteration );
+
+  /**
+   * Set/Get whether the optimizer keeps, at the next levels, the scales and
+   * the learning rate it estimated at the first level, instead of estimating
+   * them again. Default is false.
+   */
+  itkSetMacro( WarmStartOptimizer, bool );
+  itkGetConstMacro( WarmStartOptimizer, bool );
+  itkBooleanMacro( WarmStartOptimizer );
+
+  /**
+   * Set/Get the factor by which the sampling percentage grows at each
+   * iteration, when the samples are drawn at each iteration, up to the whole
+   * virtual domain. Larger sample sets reduce the noise of the metric
+   * derivative as the optimizer gets close to convergence. Default is 1,
+   * i.e. the sampling percentage of each level.
+   */
+  itkSetClampMacro( MetricSamplingGrowthFactor, RealType, 1.0, NumericTraits<RealType>::max() );
+  itkGetConstMacro( MetricSamplingGrowthFactor, RealType );
+
+  /** Get the sampling percentage of the current metric samples. */
+  itkGetConstMacro( CurrentMetricSamplingPercentage, RealType );
+
   /** Set/Get the initial fixed transform. */
   itkSetGetDecoratedObjectInputMacro( FixedInitialTransform, InitialTransformType );
 
@@ -356,6 +419,37 @@ public:
   itkGetConstMacro( SmoothingSigmasAreSpecifiedInPhysicalUnits, bool );
   itkBooleanMacro( SmoothingSigmasAreSpecifiedInPhysicalUnits );
 
+  /** Type of the pyramids keeping the smoothed fixed and moving images. */
+  typedef SharedImagePyramid<FixedImageType>                          FixedImagePyramidType;
+  typedef typename FixedImagePyramidType::Pointer                     FixedImagePyramidPointer;
+  typedef SharedImagePyramid<MovingImageType>                         MovingImagePyramidType;
+  typedef typename MovingImagePyramidType::Pointer                    MovingImagePyramidPointer;
+
+  /**
+   * Set/Get the pyramid keeping the smoothed fixed images of all the levels.  It may be shared
+   * between registration methods.  If not set (default), the fixed images are smoothed at each
+   * level.
+   */
+  itkSetObjectMacro( FixedImagePyramid, FixedImagePyramidType );
+  itkGetModifiableObjectMacro( FixedImagePyramid, FixedImagePyramidType );
+
+  /**
+   * Set/Get the pyramid keeping the smoothed moving images of all the levels.  It may be shared
+   * between registration methods.  If not set (default), the moving images are smoothed at each
+   * level.
+   */
+  itkSetObjectMacro( MovingImagePyramid, MovingImagePyramidType );
+  itkGetModifiableObjectMacro( MovingImagePyramid, MovingImagePyramidType );
+
+  /**
+   * Set/Get whether the smoothed moving images are removed from the moving image pyramid when the
+   * registration finishes, so that a pyramid shared by the registrations of many moving images does
+   * not keep all of them.  On by default.
+   */
+  itkSetMacro( ReleaseMovingSmoothedImages, bool );
+  itkGetConstMacro( ReleaseMovingSmoothedImages, bool );
+  itkBooleanMacro( ReleaseMovingSmoothedImages );
+
   /** Make a DataObject of the correct type to be used as the specified output. */
   typedef ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
   using Superclass::MakeOutput;
@@ -443,6 +537,14 @@ protected:
   /** Perform the registration. */
   virtual void  GenerateData() ITK_OVERRIDE;
 
+  /** Perform the registration, then remove the smoothed moving images from the moving image
+   * pyramid, even if the registration failed. */
+  virtual void UpdateOutputData( DataObject *output ) ITK_OVERRIDE;
+
+  /** Remove the smoothed moving images from the moving image pyramid, if ReleaseMovingSmoothedImages
+   * is on. */
+  void ReleaseMovingSmoothedImagesOfPyramid();
+
   virtual void AllocateOutputs();
 
   /** Initialize by setting the interconnects between the components. */
@@ -451,9 +553,17 @@ protected:
   /** Initialize by setting the interconnects between the components. */
   virtual VirtualImageBaseConstPointer GetCurrentLevelVirtualDomainImage();
 
-  /** Get metric samples. */
+  /** Get metric samples. This is done at the start of each level. */
   virtual void SetMetricSamplePoints();
 
+  /** Draw new metric samples in the point sets of the metrics, which are
+   * reused, with the current sampling percentage. */
+  virtual void SampleMetricPoints();
+
+  /** Draw new metric samples for the next iteration of the optimizer, and
+   * map them to the virtual domain of the metrics. */
+  virtual void ResampleMetricPointsAtIteration();
+
   SizeValueType                                                   m_CurrentLevel;
   SizeValueType                                                   m_NumberOfLevels;
   SizeValueType                                                   m_CurrentIteration;
@@ -472,15 +582,22 @@ protected:
   OptimizerPointer                                                m_Optimizer;
   OptimizerWeightsType                                            m_OptimizerWeights;
   bool                                                            m_OptimizerWeightsAreIdentity;
+  bool                                                            m_WarmStartOptimizer;
 
   MetricPointer                                                   m_Metric;
   MetricSamplingStrategyType                                      m_MetricSamplingStrategy;
   MetricSamplingPercentageArrayType                               m_MetricSamplingPercentagePerLevel;
+  bool                                                            m_MetricSamplingPerIteration;
+  RealType                                                        m_MetricSamplingGrowthFactor;
+  RealType                                                        m_CurrentMetricSamplingPercentage;
   SizeValueType                                                   m_NumberOfMetrics;
   int                                                             m_FirstImageMetricIndex;
   std::vector<ShrinkFactorsPerDimensionContainerType>             m_ShrinkFactorsPerLevel;
   SmoothingSigmasArrayType                                        m_SmoothingSigmasPerLevel;
   bool                                                            m_SmoothingSigmasAreSpecifiedInPhysicalUnits;
+  FixedImagePyramidPointer                                        m_FixedImagePyramid;
+  MovingImagePyramidPointer                                       m_MovingImagePyramid;
+  bool                                                            m_ReleaseMovingSmoothedImages;
 
   TransformParametersAdaptorsContainerType                        m_TransformParametersAdaptorsPerLevel;
 
@@ -499,6 +616,19 @@ private:
 
   bool                                                            m_InitializeCenterOfLinearOutputTransform;
 
+  typedef Statistics::MersenneTwisterRandomVariateGenerator       MetricSamplingRandomizerType;
+  typedef std::vector<typename MetricSamplePointSetType::Pointer> MetricSamplePointSetsContainerType;
+  typedef std::vector<MetricSamplingRandomizerType::Pointer>      MetricSamplingRandomizersContainerType;
+
+  /** Sample point set and random generator of each metric, kept across
+   * levels and iterations. */
+  MetricSamplePointSetsContainerType                              m_MetricSamplePointSets;
+  MetricSamplingRandomizersContainerType                          m_MetricSamplingRandomizers;
+
+  /** Cumulative sampling weights of the virtual domain voxels, for the
+   * GRADIENT_MAGNITUDE strategy. */
+  std::vector<RealType>                                           m_MetricSamplingCumulativeWeights;
+
   // helper function to create the right kind of concrete transform
   template<typename TTransform>
   static void MakeOutputTransform(SmartPointer<TTransform> &ptr)
@@ -20,6 +20,8 @@
 
 #include "itkImageRegistrationMethodv4.h"
 
+#include "itkCastImageFilter.h"
+#include "itkCommand.h"
 #include "itkDiscreteGaussianImageFilter.h"
 #include "itkGradientDescentOptimizerv4.h"
 #include "itkImageRandomConstIteratorWithIndex.h"
@@ -27,9 +29,10 @@
 #include "itkImageToImageMetricv4.h"
 #include "itkIterationReporter.h"
 #include "itkMattesMutualInformationImageToImageMetricv4.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
 #include "itkRegistrationParameterScalesFromPhysicalShift.h"
 
+#include <algorithm>
+
 namespace itk
 {
 /**
@@ -94,6 +97,7 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
   this->m_OptimizerWeights.SetSize( 0 );
   this->m_OptimizerWeightsAreIdentity = true;
+  this->m_WarmStartOptimizer = false;
 
   DecoratedOutputTransformPointer transformDecorator =
         itkDynamicCastInDebugMode< DecoratedOutputTransformType * >( this->MakeOutput(0).GetPointer() );
@@ -121,9 +125,16 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
   this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits = true;
 
+  this->m_FixedImagePyramid = ITK_NULLPTR;
+  this->m_MovingImagePyramid = ITK_NULLPTR;
+  this->m_ReleaseMovingSmoothedImages = true;
+
   this->m_MetricSamplingStrategy = NONE;
   this->m_MetricSamplingPercentagePerLevel.SetSize( this->m_NumberOfLevels );
   this->m_MetricSamplingPercentagePerLevel.Fill( 1.0 );
+  this->m_MetricSamplingPerIteration = false;
+  this->m_MetricSamplingGrowthFactor = 1.0;
+  this->m_CurrentMetricSamplingPercentage = 1.0;
 }
 
 template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
@@ -554,6 +565,15 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
   // Although this isn't necessary, we want to leave the option for
   // changing the point sets per level.
 
+  // The variances of the smoothing of all the levels, for the image pyramids.
+  typename FixedImagePyramidType::VarianceContainerType fixedImageVariances( this->m_NumberOfLevels );
+  typename MovingImagePyramidType::VarianceContainerType movingImageVariances( this->m_NumberOfLevels );
+  for( SizeValueType l = 0; l < this->m_NumberOfLevels; l++ )
+    {
+    fixedImageVariances[l].Fill( vnl_math_sqr( this->m_SmoothingSigmasPerLevel[l] ) );
+    movingImageVariances[l].Fill( vnl_math_sqr( this->m_SmoothingSigmasPerLevel[l] ) );
+    }
+
   this->m_FixedSmoothImages.clear();
   this->m_FixedSmoothImages.resize( this->m_NumberOfMetrics );
   this->m_MovingSmoothImages.clear();
@@ -574,41 +594,68 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
         ( this->m_Metric->GetMetricCategory() == MetricType::MULTI_METRIC &&
           multiMetric->GetMetricQueue()[n]->GetMetricCategory() == MetricType::IMAGE_METRIC ) )
       {
-      typedef DiscreteGaussianImageFilter<FixedImageType, FixedImageType> FixedImageSmoothingFilterType;
-      typename FixedImageSmoothingFilterType::Pointer fixedImageSmoothingFilter = FixedImageSmoothingFilterType::New();
-      if( this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits == true )
+      if( this->m_FixedImagePyramid.IsNotNull() )
         {
-        fixedImageSmoothingFilter->SetUseImageSpacingOn();
+        this->m_FixedImagePyramid->ComputeSmoothedImages( this->GetFixedImage( n ), fixedImageVariances,
+          this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits );
+        // The smoothed images of the pyramid are shared with other
+        // registrations, possibly running concurrently: the metric gets a
+        // graft of them, which its pipelines may modify.
+        this->m_FixedSmoothImages[n] = FixedImageType::New();
+        this->m_FixedSmoothImages[n]->Graft( this->m_FixedImagePyramid->GetSmoothedImage(
+          this->GetFixedImage( n ), fixedImageVariances[level], this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits ) );
         }
       else
         {
-        fixedImageSmoothingFilter->SetUseImageSpacingOff();
+        typedef DiscreteGaussianImageFilter<FixedImageType, FixedImageType> FixedImageSmoothingFilterType;
+        typename FixedImageSmoothingFilterType::Pointer fixedImageSmoothingFilter = FixedImageSmoothingFilterType::New();
+        if( this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits == true )
+          {
+          fixedImageSmoothingFilter->SetUseImageSpacingOn();
+          }
+        else
+          {
+          fixedImageSmoothingFilter->SetUseImageSpacingOff();
+          }
+        fixedImageSmoothingFilter->SetVariance( vnl_math_sqr( this->m_SmoothingSigmasPerLevel[level] ) );
+        fixedImageSmoothingFilter->SetMaximumError( 0.01 );
+        fixedImageSmoothingFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+        fixedImageSmoothingFilter->SetInput( this->GetFixedImage( n ) );
+
+        this->m_FixedSmoothImages[n] = fixedImageSmoothingFilter->GetOutput();
+        this->m_FixedSmoothImages[n]->Update();
+        this->m_FixedSmoothImages[n]->DisconnectPipeline();
         }
-      fixedImageSmoothingFilter->SetVariance( vnl_math_sqr( this->m_SmoothingSigmasPerLevel[level] ) );
-      fixedImageSmoothingFilter->SetMaximumError( 0.01 );
-      fixedImageSmoothingFilter->SetInput( this->GetFixedImage( n ) );
 
-      this->m_FixedSmoothImages[n] = fixedImageSmoothingFilter->GetOutput();
-      this->m_FixedSmoothImages[n]->Update();
-      this->m_FixedSmoothImages[n]->DisconnectPipeline();
-
-      typedef DiscreteGaussianImageFilter<MovingImageType, MovingImageType> MovingImageSmoothingFilterType;
-      typename MovingImageSmoothingFilterType::Pointer movingImageSmoothingFilter = MovingImageSmoothingFilterType::New();
-      if( this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits == true )
+      if( this->m_MovingImagePyramid.IsNotNull() )
         {
-        movingImageSmoothingFilter->SetUseImageSpacingOn();
+        this->m_MovingImagePyramid->ComputeSmoothedImages( this->GetMovingImage( n ), movingImageVariances,
+          this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits );
+        this->m_MovingSmoothImages[n] = MovingImageType::New();
+        this->m_MovingSmoothImages[n]->Graft( this->m_MovingImagePyramid->GetSmoothedImage(
+          this->GetMovingImage( n ), movingImageVariances[level], this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits ) );
         }
       else
         {
-        movingImageSmoothingFilter->SetUseImageSpacingOff();
+        typedef DiscreteGaussianImageFilter<MovingImageType, MovingImageType> MovingImageSmoothingFilterType;
+        typename MovingImageSmoothingFilterType::Pointer movingImageSmoothingFilter = MovingImageSmoothingFilterType::New();
+        if( this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits == true )
+          {
+          movingImageSmoothingFilter->SetUseImageSpacingOn();
+          }
+        else
+          {
+          movingImageSmoothingFilter->SetUseImageSpacingOff();
+          }
+        movingImageSmoothingFilter->SetVariance( vnl_math_sqr( this->m_SmoothingSigmasPerLevel[level] ) );
+        movingImageSmoothingFilter->SetMaximumError( 0.01 );
+        movingImageSmoothingFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+        movingImageSmoothingFilter->SetInput( this->GetMovingImage( n ) );
+
+        this->m_MovingSmoothImages[n] = movingImageSmoothingFilter->GetOutput();
+        this->m_MovingSmoothImages[n]->Update();
+        this->m_MovingSmoothImages[n]->DisconnectPipeline();
         }
-      movingImageSmoothingFilter->SetVariance( vnl_math_sqr( this->m_SmoothingSigmasPerLevel[level] ) );
-      movingImageSmoothingFilter->SetMaximumError( 0.01 );
-      movingImageSmoothingFilter->SetInput( this->GetMovingImage( n ) );
-
-      this->m_MovingSmoothImages[n] = movingImageSmoothingFilter->GetOutput();
-      this->m_MovingSmoothImages[n]->Update();
-      this->m_MovingSmoothImages[n]->DisconnectPipeline();
 
       // Update the image metric
 
@@ -757,13 +804,120 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 ::GenerateData()
 {
   this->AllocateOutputs();
-  for( this->m_CurrentLevel = 0; this->m_CurrentLevel < this->m_NumberOfLevels; this->m_CurrentLevel++ )
+
+  // With a warm start, the estimations of the optimizer are turned off after
+  // the first level, and turned back on at the end.
+  typedef GradientDescentOptimizerv4Template<RealType> GradientDescentOptimizerType;
+  GradientDescentOptimizerType * gradientDescentOptimizer =
+    dynamic_cast<GradientDescentOptimizerType *>( this->m_Optimizer.GetPointer() );
+  const bool doEstimateScales = this->m_Optimizer->GetDoEstimateScales();
+  const bool doEstimateLearningRateOnce =
+    gradientDescentOptimizer && gradientDescentOptimizer->GetDoEstimateLearningRateOnce();
+
+  try
+    {
+    for( this->m_CurrentLevel = 0; this->m_CurrentLevel < this->m_NumberOfLevels; this->m_CurrentLevel++ )
+      {
+      const SizeValueType numberOfPreviousParameters = this->m_Optimizer->GetScales().Size();
+
+      this->InitializeRegistrationAtEachLevel( this->m_CurrentLevel );
+
+      if( this->m_WarmStartOptimizer && this->m_CurrentLevel > 0 )
+        {
+        const bool isSameNumberOfParameters =
+          ( numberOfPreviousParameters == this->m_OutputTransform->GetNumberOfLocalParameters() );
+        this->m_Optimizer->SetDoEstimateScales( doEstimateScales && !isSameNumberOfParameters );
+        if( gradientDescentOptimizer )
+          {
+          gradientDescentOptimizer->SetDoEstimateLearningRateOnce( doEstimateLearningRateOnce && !isSameNumberOfParameters );
+          }
+        }
+
+      this->m_Metric->Initialize();
+
+      // Draw new samples after each iteration of the optimizer.
+      unsigned long samplingObserverTag = 0;
+      const bool resampleAtIteration = ( this->m_MetricSamplingStrategy != NONE && this->m_MetricSamplingPerIteration );
+      if( resampleAtIteration )
+        {
+        typedef SimpleMemberCommand<Self> SamplingCommandType;
+        typename SamplingCommandType::Pointer samplingCommand = SamplingCommandType::New();
+        samplingCommand->SetCallbackFunction( this, &Self::ResampleMetricPointsAtIteration );
+        samplingObserverTag = this->m_Optimizer->AddObserver( IterationEvent(), samplingCommand );
+        }
+
+      try
+        {
+        this->m_Optimizer->StartOptimization();
+        }
+      catch( ... )
+        {
+        if( resampleAtIteration )
+          {
+          this->m_Optimizer->RemoveObserver( samplingObserverTag );
+          }
+        throw;
+        }
+
+      if( resampleAtIteration )
+        {
+        this->m_Optimizer->RemoveObserver( samplingObserverTag );
+        }
+      }
+    }
+  catch( ... )
+    {
+    this->m_Optimizer->SetDoEstimateScales( doEstimateScales );
+    if( gradientDescentOptimizer )
+      {
+      gradientDescentOptimizer->SetDoEstimateLearningRateOnce( doEstimateLearningRateOnce );
+      }
+    throw;
+    }
+
+  this->m_Optimizer->SetDoEstimateScales( doEstimateScales );
+  if( gradientDescentOptimizer )
     {
-    this->InitializeRegistrationAtEachLevel( this->m_CurrentLevel );
+    gradientDescentOptimizer->SetDoEstimateLearningRateOnce( doEstimateLearningRateOnce );
+    }
+}
 
-    this->m_Metric->Initialize();
+/*
+ * Remove the smoothed moving images from the pyramid once the registration is done
+ */
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+void
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::UpdateOutputData( DataObject *output )
+{
+  try
+    {
+    Superclass::UpdateOutputData( output );
+    }
+  catch( ... )
+    {
+    this->ReleaseMovingSmoothedImagesOfPyramid();
+    throw;
+    }
+  this->ReleaseMovingSmoothedImagesOfPyramid();
+}
 
-    this->m_Optimizer->StartOptimization();
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+void
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::ReleaseMovingSmoothedImagesOfPyramid()
+{
+  if( !this->m_ReleaseMovingSmoothedImages || this->m_MovingImagePyramid.IsNull() )
+    {
+    return;
+    }
+  for( SizeValueType n = 0; n < this->m_NumberOfMetrics; n++ )
+    {
+    const MovingImageType * movingImage = this->GetMovingImage( n );
+    if( movingImage )
+      {
+      this->m_MovingImagePyramid->RemoveSmoothedImages( movingImage );
+      }
     }
 }
 
@@ -844,6 +998,142 @@ template<typename TFixedImage, typename TMovingImage, typename TTransform, typen
 void
 ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
 ::SetMetricSamplePoints()
+{
+  SizeValueType numberOfLocalMetrics = 1;
+
+  typename MultiMetricType::Pointer multiMetric = dynamic_cast<MultiMetricType *>( this->m_Metric.GetPointer() );
+  if( multiMetric )
+    {
+    numberOfLocalMetrics = multiMetric->GetNumberOfMetrics();
+    if( numberOfLocalMetrics < 1 )
+      {
+      itkExceptionMacro( "Input multi metric should have at least one metric component." );
+      }
+    }
+
+  // The point sets are allocated once, and their memory is reused by each
+  // sampling.
+  if( this->m_MetricSamplePointSets.size() != numberOfLocalMetrics )
+    {
+    this->m_MetricSamplePointSets.resize( numberOfLocalMetrics );
+    this->m_MetricSamplingRandomizers.resize( numberOfLocalMetrics );
+    for( SizeValueType n = 0; n < numberOfLocalMetrics; n++ )
+      {
+      this->m_MetricSamplePointSets[n] = MetricSamplePointSetType::New();
+      this->m_MetricSamplePointSets[n]->Initialize();
+      this->m_MetricSamplingRandomizers[n] = MetricSamplingRandomizerType::New();
+      }
+    }
+  for( SizeValueType n = 0; n < numberOfLocalMetrics; n++ )
+    {
+    this->m_MetricSamplingRandomizers[n]->SetSeed( 1234 );
+    }
+
+  this->m_CurrentMetricSamplingPercentage = this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel];
+
+  this->m_MetricSamplingCumulativeWeights.clear();
+  if( this->m_MetricSamplingStrategy == GRADIENT_MAGNITUDE )
+    {
+    typedef typename ImageMetricType::VirtualImageType    VirtualDomainImageType;
+    typedef typename VirtualDomainImageType::RegionType   VirtualDomainRegionType;
+    typedef typename ImageMetricType::FixedImageType      MetricFixedImageType;
+    typedef typename MetricFixedImageType::PixelType      MetricFixedPixelType;
+    typedef DefaultConvertPixelTraits<MetricFixedPixelType> MetricFixedPixelConvertType;
+
+    const ImageMetricType * firstMetric = ITK_NULLPTR;
+    if( multiMetric )
+      {
+      firstMetric = dynamic_cast<const ImageMetricType *>( multiMetric->GetMetricQueue()[0].GetPointer() );
+      }
+    else
+      {
+      firstMetric = dynamic_cast<const ImageMetricType *>( this->m_Metric.GetPointer() );
+      }
+    if( !firstMetric || !firstMetric->GetFixedImage() )
+      {
+      itkExceptionMacro( "Invalid metric conversion." );
+      }
+    const VirtualDomainImageType * virtualImage = firstMetric->GetVirtualImage();
+    const MetricFixedImageType * fixedImage = firstMetric->GetFixedImage();
+    const VirtualDomainRegionType & virtualDomainRegion = virtualImage->GetRequestedRegion();
+    const typename MetricFixedImageType::RegionType & fixedRegion = fixedImage->GetBufferedRegion();
+    const typename MetricFixedImageType::SpacingType & fixedSpacing = fixedImage->GetSpacing();
+
+    // Central differences of the fixed image at the nearest voxel of each
+    // virtual domain voxel, summed over the pixel components.
+    this->m_MetricSamplingCumulativeWeights.reserve( virtualDomainRegion.GetNumberOfPixels() );
+    RealType totalWeight = NumericTraits<RealType>::ZeroValue();
+    ImageRegionConstIteratorWithIndex<VirtualDomainImageType> It( virtualImage, virtualDomainRegion );
+    for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+      {
+      typename VirtualDomainImageType::PointType point;
+      virtualImage->TransformIndexToPhysicalPoint( It.GetIndex(), point );
+      typename MetricFixedImageType::IndexType index;
+      RealType squaredMagnitude = NumericTraits<RealType>::ZeroValue();
+      if( fixedImage->TransformPhysicalPointToIndex( point, index ) )
+        {
+        for( SizeValueType d = 0; d < ImageDimension; d++ )
+          {
+          typename MetricFixedImageType::IndexType previousIndex = index;
+          typename MetricFixedImageType::IndexType nextIndex = index;
+          if( index[d] > fixedRegion.GetIndex()[d] )
+            {
+            --previousIndex[d];
+            }
+          if( index[d] < fixedRegion.GetUpperIndex()[d] )
+            {
+            ++nextIndex[d];
+            }
+          if( previousIndex[d] == nextIndex[d] )
+            {
+            continue;
+            }
+          const MetricFixedPixelType previousValue = fixedImage->GetPixel( previousIndex );
+          const MetricFixedPixelType nextValue = fixedImage->GetPixel( nextIndex );
+          const RealType distance = ( nextIndex[d] - previousIndex[d] ) * fixedSpacing[d];
+          const unsigned int numberOfComponents = MetricFixedPixelConvertType::GetNumberOfComponents( nextValue );
+          for( unsigned int c = 0; c < numberOfComponents; c++ )
+            {
+            const RealType derivative = ( static_cast<RealType>( MetricFixedPixelConvertType::GetNthComponent( c, nextValue ) )
+              - static_cast<RealType>( MetricFixedPixelConvertType::GetNthComponent( c, previousValue ) ) ) / distance;
+            squaredMagnitude += derivative * derivative;
+            }
+          }
+        }
+      totalWeight += std::sqrt( squaredMagnitude );
+      this->m_MetricSamplingCumulativeWeights.push_back( totalWeight );
+      }
+    // Sample uniformly a constant image.
+    if( totalWeight <= NumericTraits<RealType>::ZeroValue() )
+      {
+      for( SizeValueType i = 0; i < this->m_MetricSamplingCumulativeWeights.size(); i++ )
+        {
+        this->m_MetricSamplingCumulativeWeights[i] = static_cast<RealType>( i + 1 );
+        }
+      }
+    }
+
+  this->SampleMetricPoints();
+
+  for( SizeValueType n = 0; n < numberOfLocalMetrics; n++ )
+    {
+    if( multiMetric )
+      {
+      dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetFixedSampledPointSet( this->m_MetricSamplePointSets[n] );
+      dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetUseFixedSampledPointSet( true );
+      }
+    else
+      {
+      dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetFixedSampledPointSet( this->m_MetricSamplePointSets[n] );
+      dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetUseFixedSampledPointSet( true );
+      }
+    }
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+void
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::SampleMetricPoints()
 {
   typedef typename ImageMetricType::VirtualImageType    VirtualDomainImageType;
   typedef typename VirtualDomainImageType::RegionType   VirtualDomainRegionType;
@@ -895,14 +1185,16 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
   for( SizeValueType n = 0; n < numberOfLocalMetrics; n++ )
     {
-    typename MetricSamplePointSetType::Pointer samplePointSet = MetricSamplePointSetType::New();
-    samplePointSet->Initialize();
+    typename MetricSamplePointSetType::Pointer samplePointSet = this->m_MetricSamplePointSets[n];
+    if( samplePointSet->GetPoints() )
+      {
+      // clear the points, keeping their memory
+      samplePointSet->GetPoints()->Initialize();
+      }
 
     typedef typename MetricSamplePointSetType::PointType SamplePointType;
 
-    typedef typename Statistics::MersenneTwisterRandomVariateGenerator RandomizerType;
-    typename RandomizerType::Pointer randomizer = RandomizerType::New();
-    randomizer->SetSeed( 1234 );
+    MetricSamplingRandomizerType * randomizer = this->m_MetricSamplingRandomizers[n];
 
     unsigned long index = 0;
 
@@ -910,7 +1202,7 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
       {
       case REGULAR:
         {
-        const unsigned long sampleCount = static_cast<unsigned long>( std::ceil( 1.0 / this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel] ) );
+        const unsigned long sampleCount = static_cast<unsigned long>( std::ceil( 1.0 / this->m_CurrentMetricSamplingPercentage ) );
         unsigned long count = sampleCount; //Start at sampleCount to keep behavior backwards identical, using first element.
         ImageRegionConstIteratorWithIndex<VirtualDomainImageType> It( virtualImage, virtualDomainRegion );
         for( It.GoToBegin(); !It.IsAtEnd(); ++It )
@@ -939,7 +1231,7 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
       case RANDOM:
         {
         const unsigned long totalVirtualDomainVoxels = virtualDomainRegion.GetNumberOfPixels();
-        const unsigned long sampleCount = static_cast<unsigned long>( static_cast<float>( totalVirtualDomainVoxels ) * this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel] );
+        const unsigned long sampleCount = static_cast<unsigned long>( static_cast<float>( totalVirtualDomainVoxels ) * this->m_CurrentMetricSamplingPercentage );
         ImageRandomConstIteratorWithIndex<VirtualDomainImageType> ItR( virtualImage, virtualDomainRegion );
         ItR.SetNumberOfSamples( sampleCount );
         for( ItR.GoToBegin(); !ItR.IsAtEnd(); ++ItR )
@@ -960,23 +1252,113 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
           }
         break;
         }
+      case STRATIFIED:
+        {
+        // Divide the virtual domain in cells of about 1 / percentage voxels,
+        // and draw a point uniformly in each of them.
+        const typename VirtualDomainRegionType::SizeType & regionSize = virtualDomainRegion.GetSize();
+        const typename VirtualDomainRegionType::IndexType & regionIndex = virtualDomainRegion.GetIndex();
+        const RealType cellScale = std::pow( this->m_CurrentMetricSamplingPercentage, 1.0 / static_cast<RealType>( ImageDimension ) );
+        SizeValueType numberOfCellsPerDimension[ImageDimension];
+        SizeValueType numberOfCells = 1;
+        for( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          numberOfCellsPerDimension[d] = std::max( static_cast<SizeValueType>( 1 ),
+            static_cast<SizeValueType>( regionSize[d] * cellScale + 0.5 ) );
+          numberOfCells *= numberOfCellsPerDimension[d];
+          }
+        for( SizeValueType cell = 0; cell < numberOfCells; cell++ )
+          {
+          ContinuousIndex<typename SamplePointType::ValueType, ImageDimension> cindex;
+          SizeValueType cellOffset = cell;
+          for( unsigned int d = 0; d < ImageDimension; d++ )
+            {
+            const RealType cellSize = static_cast<RealType>( regionSize[d] ) / numberOfCellsPerDimension[d];
+            const SizeValueType cellIndex = cellOffset % numberOfCellsPerDimension[d];
+            cellOffset /= numberOfCellsPerDimension[d];
+            cindex[d] = regionIndex[d] - 0.5 + ( cellIndex + randomizer->GetVariateWithOpenRange() ) * cellSize;
+            }
+          SamplePointType point;
+          virtualImage->TransformContinuousIndexToPhysicalPoint( cindex, point );
+          if( !fixedMaskImage || fixedMaskImage->IsInside( point ) )
+            {
+            samplePointSet->SetPoint( index, point );
+            ++index;
+            }
+          }
+        break;
+        }
+      case GRADIENT_MAGNITUDE:
+        {
+        const unsigned long totalVirtualDomainVoxels = this->m_MetricSamplingCumulativeWeights.size();
+        if( totalVirtualDomainVoxels == 0 )
+          {
+          itkExceptionMacro( "The sampling weights have not been computed." );
+          }
+        const unsigned long sampleCount = static_cast<unsigned long>( static_cast<float>( totalVirtualDomainVoxels ) * this->m_CurrentMetricSamplingPercentage );
+        const typename VirtualDomainRegionType::SizeType & regionSize = virtualDomainRegion.GetSize();
+        const RealType totalWeight = this->m_MetricSamplingCumulativeWeights.back();
+        for( unsigned long i = 0; i < sampleCount; i++ )
+          {
+          // Inverse transform sampling of the voxel offset.
+          const RealType weight = randomizer->GetVariateWithOpenRange() * totalWeight;
+          SizeValueType offset = std::upper_bound( this->m_MetricSamplingCumulativeWeights.begin(),
+            this->m_MetricSamplingCumulativeWeights.end(), weight ) - this->m_MetricSamplingCumulativeWeights.begin();
+          offset = std::min( offset, static_cast<SizeValueType>( totalVirtualDomainVoxels - 1 ) );
+
+          typename VirtualDomainImageType::IndexType voxelIndex = virtualDomainRegion.GetIndex();
+          for( unsigned int d = 0; d < ImageDimension; d++ )
+            {
+            voxelIndex[d] += offset % regionSize[d];
+            offset /= regionSize[d];
+            }
+          SamplePointType point;
+          virtualImage->TransformIndexToPhysicalPoint( voxelIndex, point );
+
+          // randomly perturb the point within a voxel (approximately)
+          for( unsigned int d = 0; d < ImageDimension; d++ )
+            {
+            point[d] += randomizer->GetNormalVariate() * oneThirdVirtualSpacing[d];
+            }
+          if( !fixedMaskImage || fixedMaskImage->IsInside( point ) )
+            {
+            samplePointSet->SetPoint( index, point );
+            ++index;
+            }
+          }
+        break;
+        }
       default:
         {
         itkExceptionMacro( "Invalid sampling strategy requested." );
         }
       }
+    samplePointSet->Modified();
+    }
+}
 
-    if( multiMetric )
-      {
-      dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetFixedSampledPointSet( samplePointSet );
-      dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->SetUseFixedSampledPointSet( true );
-      }
-    else
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+void
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::ResampleMetricPointsAtIteration()
+{
+  this->m_CurrentMetricSamplingPercentage = std::min( NumericTraits<RealType>::OneValue(),
+    this->m_CurrentMetricSamplingPercentage * this->m_MetricSamplingGrowthFactor );
+
+  this->SampleMetricPoints();
+
+  typename MultiMetricType::Pointer multiMetric = dynamic_cast<MultiMetricType *>( this->m_Metric.GetPointer() );
+  if( multiMetric )
+    {
+    for( SizeValueType n = 0; n < multiMetric->GetNumberOfMetrics(); n++ )
       {
-      dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetFixedSampledPointSet( samplePointSet );
-      dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetUseFixedSampledPointSet( true );
+      dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->MapFixedSampledPointSetToVirtual();
       }
     }
+  else
+    {
+    dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->MapFixedSampledPointSetToVirtual();
+    }
 }
 
 template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
@@ -1087,13 +1469,19 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
     {
     os << indent2 << "Smoothing sigmas are specified in voxel units." << std::endl;
     }
+  os << indent << "Fixed image pyramid: " << this->m_FixedImagePyramid.GetPointer() << std::endl;
+  os << indent << "Moving image pyramid: " << this->m_MovingImagePyramid.GetPointer() << std::endl;
+  os << indent << "Release moving smoothed images: " << ( this->m_ReleaseMovingSmoothedImages ? "On" : "Off" ) << std::endl;
 
   if( this->m_OptimizerWeights.Size() > 0 )
     {
     os << indent << "Optimizers weights: " << this->m_OptimizerWeights << std::endl;
     }
+  os << indent << "Warm start optimizer: " << ( this->m_WarmStartOptimizer ? "On" : "Off" ) << std::endl;
 
   os << indent << "Metric sampling strategy: " << this->m_MetricSamplingStrategy << std::endl;
+  os << indent << "Metric sampling per iteration: " << ( this->m_MetricSamplingPerIteration ? "On" : "Off" ) << std::endl;
+  os << indent << "Metric sampling growth factor: " << this->m_MetricSamplingGrowthFactor << std::endl;
 
   os << indent << "Metric sampling percentage: ";
   for( SizeValueType i = 0; i < this->m_NumberOfLevels; i++ )
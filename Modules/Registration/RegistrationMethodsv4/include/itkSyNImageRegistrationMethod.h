@@ -21,6 +21,7 @@
 #include "itkImageRegistrationMethodv4.h"
 
 #include "itkDisplacementFieldTransform.h"
+#include "itkVectorLinearInterpolateImageFunction.h"
 
 namespace itk
 {
@@ -55,6 +56,10 @@ namespace itk
  * The method evolved since that time with crucial contributions from Gang Song and
  * Nick Tustison. Though similar in spirit, this implementation is not identical.
  *
+ * The fixed and moving images of all the levels can be smoothed once and
+ * shared with other registrations through the image pyramids of the
+ * superclass (see ImageRegistrationMethodv4::SetFixedImagePyramid()).
+ *
  * \todo Need to allow the fixed image to have a composite transform.
  *
  * \author Nick Tustison
@@ -94,6 +99,9 @@ public:
   typedef typename MovingImageType::Pointer                           MovingImagePointer;
   typedef typename Superclass::MovingImagesContainerType              MovingImagesContainerType;
 
+  typedef typename Superclass::FixedImagePyramidType                  FixedImagePyramidType;
+  typedef typename Superclass::MovingImagePyramidType                 MovingImagePyramidType;
+
   typedef typename Superclass::PointSetType                           PointSetType;
   typedef typename PointSetType::Pointer                              PointSetPointer;
   typedef typename Superclass::PointSetsContainerType                 PointSetsContainerType;
@@ -210,10 +218,24 @@ protected:
     const PointSetsContainerType, const TransformBaseType *, const MovingImagesContainerType,
     const PointSetsContainerType, const TransformBaseType *, const FixedImageMaskType *, MeasureType & );
 
-  virtual DisplacementFieldPointer ScaleUpdateField( const DisplacementFieldType * );
+  /** Scale the update field in place, so that its largest displacement is
+   * the learning rate, and return it. */
+  virtual DisplacementFieldPointer ScaleUpdateField( DisplacementFieldType * );
   virtual DisplacementFieldPointer GaussianSmoothDisplacementField( const DisplacementFieldType *, const RealType );
   virtual DisplacementFieldPointer InvertDisplacementField( const DisplacementFieldType *, const DisplacementFieldType * = ITK_NULLPTR );
 
+  /** Compose a displacement field with a warping field, i.e. apply the
+   * warping field and then the displacement field, as
+   * ComposeDisplacementFieldsImageFilter does, into a field allocated on
+   * the domain of the warping field. The composition is computed in
+   * several threads, each processing a range of lines. */
+  void ComposeDisplacementFields( const DisplacementFieldType *, const DisplacementFieldType *, DisplacementFieldType * );
+
+  /** Compose the update field with the total field into a field allocated
+   * once per level and reused by the iterations. The returned field is
+   * overwritten by the next call. */
+  DisplacementFieldType * ComposeUpdateField( const DisplacementFieldType *, const DisplacementFieldType * );
+
   RealType                                                        m_LearningRate;
 
   OutputTransformPointer                                          m_MovingToMiddleTransform;
@@ -230,6 +252,37 @@ private:
   SyNImageRegistrationMethod( const Self & );   //purposely not implemented
   void operator=( const Self & );               //purposely not implemented
 
+  /** Convolve a field along one dimension with a kernel centered on each
+   * pixel, with the zero flux Neumann boundary condition, in several threads
+   * each processing a range of lines of the buffer. */
+  void ConvolveDisplacementFieldAlongDimension( const DisplacementFieldType *, DisplacementFieldType *,
+    const unsigned int, const std::vector<RealType> & );
+
+  struct ConvolutionThreadStruct
+    {
+    const DisplacementFieldType *    Input;
+    DisplacementFieldType *          Output;
+    unsigned int                     Dimension;
+    const std::vector<RealType> *    Kernel;
+    };
+
+  static ITK_THREAD_RETURN_TYPE ConvolutionThreaderCallback( void * );
+
+  typedef VectorLinearInterpolateImageFunction<DisplacementFieldType, RealType> DisplacementFieldInterpolatorType;
+
+  struct CompositionThreadStruct
+    {
+    const DisplacementFieldInterpolatorType * Interpolator;
+    const DisplacementFieldType *             WarpingField;
+    DisplacementFieldType *                   Output;
+    };
+
+  static ITK_THREAD_RETURN_TYPE CompositionThreaderCallback( void * );
+
+  /** Field of the compositions of the update fields with the total fields,
+   * reused by the iterations of a level. */
+  DisplacementFieldPointer                                        m_ComposedField;
+
   RealType                                                        m_GaussianSmoothingVarianceForTheUpdateField;
   RealType                                                        m_GaussianSmoothingVarianceForTheTotalField;
 };
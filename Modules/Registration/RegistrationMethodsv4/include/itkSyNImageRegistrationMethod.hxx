@@ -20,14 +20,12 @@
 
 #include "itkSyNImageRegistrationMethod.h"
 
-#include "itkComposeDisplacementFieldsImageFilter.h"
 #include "itkGaussianOperator.h"
 #include "itkImageMaskSpatialObject.h"
 #include "itkImportImageFilter.h"
 #include "itkInvertDisplacementFieldImageFilter.h"
+#include "itkImageScanlineIterator.h"
 #include "itkIterationReporter.h"
-#include "itkMultiplyImageFilter.h"
-#include "itkVectorNeighborhoodOperatorImageFilter.h"
 #include "itkWindowConvergenceMonitoringFunction.h"
 
 namespace itk
@@ -196,33 +194,26 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
 
     if ( this->m_AverageMidPointGradients )
       {
-      ImageRegionIteratorWithIndex<DisplacementFieldType> ItF( fixedToMiddleSmoothUpdateField, fixedToMiddleSmoothUpdateField->GetLargestPossibleRegion() );
-      for( ItF.GoToBegin(); !ItF.IsAtEnd(); ++ItF )
+      // Both update fields are defined on the virtual domain.
+      ImageRegionIterator<DisplacementFieldType> ItF( fixedToMiddleSmoothUpdateField, fixedToMiddleSmoothUpdateField->GetLargestPossibleRegion() );
+      ImageRegionIterator<DisplacementFieldType> ItM( movingToMiddleSmoothUpdateField, fixedToMiddleSmoothUpdateField->GetLargestPossibleRegion() );
+      for( ItF.GoToBegin(), ItM.GoToBegin(); !ItF.IsAtEnd(); ++ItF, ++ItM )
         {
-        ItF.Set( ItF.Get() - movingToMiddleSmoothUpdateField->GetPixel( ItF.GetIndex() ) );
-        movingToMiddleSmoothUpdateField->SetPixel( ItF.GetIndex(), -ItF.Get() );
+        ItF.Set( ItF.Get() - ItM.Get() );
+        ItM.Set( -ItF.Get() );
         }
       }
 
-    // Add the update field to both displacement fields (from fixed/moving to middle image) and then smooth
-
-    typedef ComposeDisplacementFieldsImageFilter<DisplacementFieldType> ComposerType;
-
-    typename ComposerType::Pointer fixedComposer = ComposerType::New();
-    fixedComposer->SetDisplacementField( fixedToMiddleSmoothUpdateField );
-    fixedComposer->SetWarpingField( this->m_FixedToMiddleTransform->GetDisplacementField() );
-    fixedComposer->Update();
+    // Add the update field to both displacement fields (from fixed/moving to middle image) and then smooth.
+    // The smoothing reads the composed field before it is reused.
 
     DisplacementFieldPointer fixedToMiddleSmoothTotalFieldTmp = this->GaussianSmoothDisplacementField(
-      fixedComposer->GetOutput(), this->m_GaussianSmoothingVarianceForTheTotalField );
-
-    typename ComposerType::Pointer movingComposer = ComposerType::New();
-    movingComposer->SetDisplacementField( movingToMiddleSmoothUpdateField );
-    movingComposer->SetWarpingField( this->m_MovingToMiddleTransform->GetDisplacementField() );
-    movingComposer->Update();
+      this->ComposeUpdateField( fixedToMiddleSmoothUpdateField, this->m_FixedToMiddleTransform->GetDisplacementField() ),
+      this->m_GaussianSmoothingVarianceForTheTotalField );
 
     DisplacementFieldPointer movingToMiddleSmoothTotalFieldTmp = this->GaussianSmoothDisplacementField(
-      movingComposer->GetOutput(), this->m_GaussianSmoothingVarianceForTheTotalField );
+      this->ComposeUpdateField( movingToMiddleSmoothUpdateField, this->m_MovingToMiddleTransform->GetDisplacementField() ),
+      this->m_GaussianSmoothingVarianceForTheTotalField );
 
     // Iteratively estimate the inverse fields.
 
@@ -462,28 +453,29 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
 template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
 typename SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>::DisplacementFieldPointer
 SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
-::ScaleUpdateField( const DisplacementFieldType * updateField )
+::ScaleUpdateField( DisplacementFieldType * updateField )
 {
   typename DisplacementFieldType::SpacingType spacing = updateField->GetSpacing();
-  ImageRegionConstIterator<DisplacementFieldType> ItF( updateField, updateField->GetLargestPossibleRegion() );
 
-  RealType maxNorm = NumericTraits<RealType>::NonpositiveMin();
-  for( ItF.GoToBegin(); !ItF.IsAtEnd(); ++ItF )
-    {
-    DisplacementVectorType vector = ItF.Get();
+  // The largest squared norm is searched over the buffer, and only its
+  // square root is computed.
+  DisplacementVectorType * vectors = updateField->GetBufferPointer();
+  const SizeValueType numberOfPixels = updateField->GetBufferedRegion().GetNumberOfPixels();
 
-    RealType localNorm = 0;
+  RealType maxSquaredNorm = NumericTraits<RealType>::NonpositiveMin();
+  for( SizeValueType n = 0; n < numberOfPixels; n++ )
+    {
+    RealType localSquaredNorm = 0;
     for( SizeValueType d = 0; d < ImageDimension; d++ )
       {
-      localNorm += vnl_math_sqr( vector[d] / spacing[d] );
+      localSquaredNorm += vnl_math_sqr( vectors[n][d] / spacing[d] );
       }
-    localNorm = std::sqrt( localNorm );
-
-    if( localNorm > maxNorm )
+    if( localSquaredNorm > maxSquaredNorm )
       {
-      maxNorm = localNorm;
+      maxSquaredNorm = localSquaredNorm;
       }
     }
+  const RealType maxNorm = std::sqrt( maxSquaredNorm );
 
   RealType scale = this->m_LearningRate;
   if( maxNorm > NumericTraits<RealType>::ZeroValue() )
@@ -491,18 +483,14 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
     scale /= maxNorm;
     }
 
-  typedef Image<RealType, ImageDimension> RealImageType;
-
-  typedef MultiplyImageFilter<DisplacementFieldType, RealImageType, DisplacementFieldType> MultiplierType;
-  typename MultiplierType::Pointer multiplier = MultiplierType::New();
-  multiplier->SetInput( updateField );
-  multiplier->SetConstant( scale );
-
-  typename DisplacementFieldType::Pointer scaledUpdateField = multiplier->GetOutput();
-  scaledUpdateField->Update();
-  scaledUpdateField->DisconnectPipeline();
+  // The update field is only used scaled, and is scaled in place.
+  for( SizeValueType n = 0; n < numberOfPixels; n++ )
+    {
+    vectors[n] *= scale;
+    }
+  updateField->Modified();
 
-  return scaledUpdateField;
+  return updateField;
 }
 
 template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
@@ -530,50 +518,60 @@ typename SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform,
 SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
 ::GaussianSmoothDisplacementField( const DisplacementFieldType * field, const RealType variance )
 {
-  typedef ImageDuplicator<DisplacementFieldType> DuplicatorType;
-  typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
-  duplicator->SetInputImage( field );
-  duplicator->Update();
-
-  DisplacementFieldPointer smoothField = duplicator->GetModifiableOutput();
-
   if( variance <= 0.0 )
     {
+    typedef ImageDuplicator<DisplacementFieldType> DuplicatorType;
+    typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
+    duplicator->SetInputImage( field );
+    duplicator->Update();
+
+    DisplacementFieldPointer smoothField = duplicator->GetModifiableOutput();
     return smoothField;
     }
 
   typedef GaussianOperator<RealType, ImageDimension> GaussianSmoothingOperatorType;
   GaussianSmoothingOperatorType gaussianSmoothingOperator;
 
-  typedef VectorNeighborhoodOperatorImageFilter<DisplacementFieldType, DisplacementFieldType> GaussianSmoothingSmootherType;
-  typename GaussianSmoothingSmootherType::Pointer smoother = GaussianSmoothingSmootherType::New();
+  // The field is smoothed along each dimension in turn, alternating between
+  // two preallocated fields.  The first pass reads the field itself, so that
+  // it does not need to be copied.
+  const typename DisplacementFieldType::RegionType bufferedRegion = field->GetBufferedRegion();
+
+  DisplacementFieldPointer smoothField = DisplacementFieldType::New();
+  smoothField->CopyInformation( field );
+  smoothField->SetRegions( bufferedRegion );
+  smoothField->Allocate();
 
+  DisplacementFieldPointer temporaryField;
+  if( ImageDimension > 1 )
+    {
+    temporaryField = DisplacementFieldType::New();
+    temporaryField->CopyInformation( field );
+    temporaryField->SetRegions( bufferedRegion );
+    temporaryField->Allocate();
+    }
+
+  std::vector<RealType> kernel;
+  const DisplacementFieldType * inputField = field;
   for( SizeValueType d = 0; d < ImageDimension; d++ )
     {
     // smooth along this dimension
     gaussianSmoothingOperator.SetDirection( d );
     gaussianSmoothingOperator.SetVariance( variance );
     gaussianSmoothingOperator.SetMaximumError( 0.001 );
-    gaussianSmoothingOperator.SetMaximumKernelWidth( smoothField->GetRequestedRegion().GetSize()[d] );
+    gaussianSmoothingOperator.SetMaximumKernelWidth( field->GetRequestedRegion().GetSize()[d] );
     gaussianSmoothingOperator.CreateDirectional();
 
-    // todo: make sure we only smooth within the buffered region
-    smoother->SetOperator( gaussianSmoothingOperator );
-    smoother->SetInput( smoothField );
-    try
-      {
-      smoother->Update();
-      }
-    catch( ExceptionObject & exc )
+    kernel.assign( gaussianSmoothingOperator.Begin(), gaussianSmoothingOperator.End() );
+
+    // The last pass writes the smoothed field.
+    DisplacementFieldType * outputField = smoothField.GetPointer();
+    if( ( ImageDimension - d ) % 2 == 0 )
       {
-      std::string msg( "Caught exception: " );
-      msg += exc.what();
-      itkExceptionMacro( << msg );
+      outputField = temporaryField.GetPointer();
       }
-
-    smoothField = smoother->GetOutput();
-    smoothField->Update();
-    smoothField->DisconnectPipeline();
+    this->ConvolveDisplacementFieldAlongDimension( inputField, outputField, d, kernel );
+    inputField = outputField;
     }
 
   const DisplacementVectorType zeroVector( 0.0 );
@@ -590,27 +588,39 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
   const typename DisplacementFieldType::SizeType size = region.GetSize();
   const typename DisplacementFieldType::IndexType startIndex = region.GetIndex();
 
-  ImageRegionConstIteratorWithIndex<DisplacementFieldType> ItF( field, field->GetLargestPossibleRegion() );
-  ImageRegionIteratorWithIndex<DisplacementFieldType> ItS( smoothField, smoothField->GetLargestPossibleRegion() );
-  for( ItF.GoToBegin(), ItS.GoToBegin(); !ItF.IsAtEnd(); ++ItF, ++ItS )
+  // Walk the fields line by line: a line is either entirely on the
+  // boundary, or only its first and last pixels are.  The blending is
+  // skipped when the smoothed field is kept as is.
+  const SizeValueType lineLength = size[0];
+  const IndexValueType lastIndex = static_cast<IndexValueType>( size[0] ) - startIndex[0] - 1;
+  ImageScanlineConstIterator<DisplacementFieldType> ItF( field, region );
+  ImageScanlineIterator<DisplacementFieldType> ItS( smoothField, region );
+  for( ItF.GoToBegin(), ItS.GoToBegin(); !ItF.IsAtEnd(); ItF.NextLine(), ItS.NextLine() )
     {
-    typename DisplacementFieldType::IndexType index = ItF.GetIndex();
+    const typename DisplacementFieldType::IndexType lineIndex = ItF.GetIndex();
     bool isOnBoundary = false;
-    for ( unsigned int d = 0; d < ImageDimension; d++ )
+    for ( unsigned int d = 1; d < ImageDimension; d++ )
       {
-      if( index[d] == startIndex[d] || index[d] == static_cast<IndexValueType>( size[d] ) - startIndex[d] - 1 )
+      if( lineIndex[d] == startIndex[d] || lineIndex[d] == static_cast<IndexValueType>( size[d] ) - startIndex[d] - 1 )
         {
         isOnBoundary = true;
         break;
         }
       }
-    if( isOnBoundary )
-      {
-      ItS.Set( zeroVector );
-      }
-    else
+
+    const DisplacementVectorType * fieldLine = &( ItF.Value() );
+    DisplacementVectorType * smoothLine = &( ItS.Value() );
+    for( SizeValueType i = 0; i < lineLength; i++ )
       {
-      ItS.Set( ItS.Get() * weight1 + ItF.Get() * weight2 );
+      const IndexValueType index = lineIndex[0] + static_cast<IndexValueType>( i );
+      if( isOnBoundary || index == startIndex[0] || index == lastIndex )
+        {
+        smoothLine[i] = zeroVector;
+        }
+      else if( weight2 != 0.0 )
+        {
+        smoothLine[i] = smoothLine[i] * weight1 + fieldLine[i] * weight2;
+        }
       }
     }
 
@@ -642,24 +652,240 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
     this->m_CompositeTransform->AddTransform( this->m_OutputTransform );
     }
 
-  typedef ComposeDisplacementFieldsImageFilter<DisplacementFieldType, DisplacementFieldType> ComposerType;
+  this->m_ComposedField = ITK_NULLPTR;
 
-  typename ComposerType::Pointer composer = ComposerType::New();
-  composer->SetDisplacementField( this->m_MovingToMiddleTransform->GetInverseDisplacementField() );
-  composer->SetWarpingField( this->m_FixedToMiddleTransform->GetDisplacementField() );
-  composer->Update();
+  const DisplacementFieldType * fixedToMiddleField = this->m_FixedToMiddleTransform->GetDisplacementField();
+  DisplacementFieldPointer composedField = DisplacementFieldType::New();
+  composedField->CopyInformation( fixedToMiddleField );
+  composedField->SetRegions( fixedToMiddleField->GetBufferedRegion() );
+  composedField->Allocate();
+  this->ComposeDisplacementFields( this->m_MovingToMiddleTransform->GetInverseDisplacementField(),
+    fixedToMiddleField, composedField );
 
-  typename ComposerType::Pointer inverseComposer = ComposerType::New();
-  inverseComposer->SetDisplacementField( this->m_FixedToMiddleTransform->GetInverseDisplacementField() );
-  inverseComposer->SetWarpingField( this->m_MovingToMiddleTransform->GetDisplacementField() );
-  inverseComposer->Update();
+  const DisplacementFieldType * movingToMiddleField = this->m_MovingToMiddleTransform->GetDisplacementField();
+  DisplacementFieldPointer inverseComposedField = DisplacementFieldType::New();
+  inverseComposedField->CopyInformation( movingToMiddleField );
+  inverseComposedField->SetRegions( movingToMiddleField->GetBufferedRegion() );
+  inverseComposedField->Allocate();
+  this->ComposeDisplacementFields( this->m_FixedToMiddleTransform->GetInverseDisplacementField(),
+    movingToMiddleField, inverseComposedField );
 
-  this->m_OutputTransform->SetDisplacementField( composer->GetOutput() );
-  this->m_OutputTransform->SetInverseDisplacementField( inverseComposer->GetOutput() );
+  this->m_OutputTransform->SetDisplacementField( composedField );
+  this->m_OutputTransform->SetInverseDisplacementField( inverseComposedField );
 
   this->GetTransformOutput()->Set(this->m_OutputTransform);
 }
 
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+void
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::ConvolveDisplacementFieldAlongDimension( const DisplacementFieldType * inputField, DisplacementFieldType * outputField,
+  const unsigned int dimension, const std::vector<RealType> & kernel )
+{
+  const SizeValueType numberOfLines = inputField->GetBufferedRegion().GetNumberOfPixels() /
+    inputField->GetBufferedRegion().GetSize()[dimension];
+  if( numberOfLines == 0 )
+    {
+    return;
+    }
+
+  ConvolutionThreadStruct str;
+  str.Input = inputField;
+  str.Output = outputField;
+  str.Dimension = dimension;
+  str.Kernel = &kernel;
+
+  const ThreadIdType numberOfThreads = static_cast<ThreadIdType>(
+    std::min( static_cast<SizeValueType>( this->GetNumberOfThreads() ), numberOfLines ) );
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( Self::ConvolutionThreaderCallback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+ITK_THREAD_RETURN_TYPE
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::ConvolutionThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const ConvolutionThreadStruct * str = static_cast<const ConvolutionThreadStruct *>( info->UserData );
+
+  const DisplacementFieldType * inputField = str->Input;
+  const unsigned int dimension = str->Dimension;
+  const std::vector<RealType> & kernel = *( str->Kernel );
+
+  const typename DisplacementFieldType::SizeType size = inputField->GetBufferedRegion().GetSize();
+  const OffsetValueType * offsetTable = inputField->GetOffsetTable();
+  const SizeValueType lineLength = size[dimension];
+  const OffsetValueType stride = offsetTable[dimension];
+  const SizeValueType numberOfLines = inputField->GetBufferedRegion().GetNumberOfPixels() / lineLength;
+
+  // Lines processed by this thread.
+  const SizeValueType firstLine = numberOfLines * info->ThreadID / info->NumberOfThreads;
+  const SizeValueType endLine = numberOfLines * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+  const IndexValueType radius = static_cast<IndexValueType>( kernel.size() / 2 );
+  const SizeValueType kernelSize = kernel.size();
+
+  const DisplacementVectorType * inputBuffer = inputField->GetBufferPointer();
+  DisplacementVectorType * outputBuffer = str->Output->GetBufferPointer();
+
+  // Each line is copied with its boundary pixels repeated on both sides, so
+  // that the convolution runs over contiguous memory.
+  std::vector<DisplacementVectorType> paddedLine( lineLength + 2 * radius );
+  for( SizeValueType line = firstLine; line < endLine; line++ )
+    {
+    SizeValueType remainder = line;
+    OffsetValueType lineOffset = 0;
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      if( d == dimension )
+        {
+        continue;
+        }
+      lineOffset += static_cast<OffsetValueType>( remainder % size[d] ) * offsetTable[d];
+      remainder /= size[d];
+      }
+
+    const DisplacementVectorType * inputLine = inputBuffer + lineOffset;
+    for( IndexValueType i = -radius; i < static_cast<IndexValueType>( lineLength ) + radius; i++ )
+      {
+      const IndexValueType clampedIndex = std::max( static_cast<IndexValueType>( 0 ),
+        std::min( i, static_cast<IndexValueType>( lineLength ) - 1 ) );
+      paddedLine[i + radius] = inputLine[clampedIndex * stride];
+      }
+
+    DisplacementVectorType * outputLine = outputBuffer + lineOffset;
+    for( SizeValueType i = 0; i < lineLength; i++ )
+      {
+      DisplacementVectorType sum;
+      sum.Fill( NumericTraits<RealType>::ZeroValue() );
+      const DisplacementVectorType * neighbors = &( paddedLine[i] );
+      for( SizeValueType k = 0; k < kernelSize; k++ )
+        {
+        for( unsigned int j = 0; j < ImageDimension; j++ )
+          {
+          sum[j] += kernel[k] * neighbors[k][j];
+          }
+        }
+      outputLine[i * stride] = sum;
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+typename SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>::DisplacementFieldType *
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::ComposeUpdateField( const DisplacementFieldType * updateField, const DisplacementFieldType * totalField )
+{
+  // The fields of a level share the virtual domain, so that the composed
+  // field is only allocated again at a new level.
+  if( this->m_ComposedField.IsNull() ||
+      this->m_ComposedField->GetBufferedRegion() != totalField->GetBufferedRegion() ||
+      this->m_ComposedField->GetLargestPossibleRegion() != totalField->GetLargestPossibleRegion() ||
+      this->m_ComposedField->GetSpacing() != totalField->GetSpacing() ||
+      this->m_ComposedField->GetOrigin() != totalField->GetOrigin() ||
+      this->m_ComposedField->GetDirection() != totalField->GetDirection() )
+    {
+    this->m_ComposedField = DisplacementFieldType::New();
+    this->m_ComposedField->CopyInformation( totalField );
+    this->m_ComposedField->SetRegions( totalField->GetBufferedRegion() );
+    this->m_ComposedField->Allocate();
+    }
+  this->ComposeDisplacementFields( updateField, totalField, this->m_ComposedField );
+  this->m_ComposedField->Modified();
+
+  return this->m_ComposedField.GetPointer();
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+void
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::ComposeDisplacementFields( const DisplacementFieldType * field, const DisplacementFieldType * warpingField,
+  DisplacementFieldType * composedField )
+{
+  const typename DisplacementFieldType::RegionType & region = warpingField->GetBufferedRegion();
+  const SizeValueType numberOfLines = region.GetNumberOfPixels() / region.GetSize()[0];
+  if( numberOfLines == 0 )
+    {
+    return;
+    }
+
+  typename DisplacementFieldInterpolatorType::Pointer interpolator = DisplacementFieldInterpolatorType::New();
+  interpolator->SetInputImage( field );
+
+  CompositionThreadStruct str;
+  str.Interpolator = interpolator;
+  str.WarpingField = warpingField;
+  str.Output = composedField;
+
+  const ThreadIdType numberOfThreads = static_cast<ThreadIdType>(
+    std::min( static_cast<SizeValueType>( this->GetNumberOfThreads() ), numberOfLines ) );
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( Self::CompositionThreaderCallback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+ITK_THREAD_RETURN_TYPE
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::CompositionThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const CompositionThreadStruct * str = static_cast<const CompositionThreadStruct *>( info->UserData );
+
+  const DisplacementFieldInterpolatorType * interpolator = str->Interpolator;
+  const DisplacementFieldType * warpingField = str->WarpingField;
+
+  const typename DisplacementFieldType::RegionType & region = warpingField->GetBufferedRegion();
+  const SizeValueType lineLength = region.GetSize()[0];
+  const SizeValueType numberOfLines = region.GetNumberOfPixels() / lineLength;
+
+  // Lines processed by this thread.
+  const SizeValueType firstLine = numberOfLines * info->ThreadID / info->NumberOfThreads;
+  const SizeValueType endLine = numberOfLines * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+  const DisplacementVectorType * warpingBuffer = warpingField->GetBufferPointer();
+  DisplacementVectorType * outputBuffer = str->Output->GetBufferPointer();
+
+  // Same arithmetic as ComposeDisplacementFieldsImageFilter.
+  typename DisplacementFieldType::PointType pointIn1;
+  typename DisplacementFieldType::PointType pointIn2;
+  typename DisplacementFieldType::PointType pointIn3;
+  for( SizeValueType line = firstLine; line < endLine; line++ )
+    {
+    const OffsetValueType lineOffset = static_cast<OffsetValueType>( line * lineLength );
+    typename DisplacementFieldType::IndexType index = warpingField->ComputeIndex( lineOffset );
+    for( SizeValueType i = 0; i < lineLength; i++, index[0]++ )
+      {
+      warpingField->TransformIndexToPhysicalPoint( index, pointIn1 );
+
+      const DisplacementVectorType & warpVector = warpingBuffer[lineOffset + i];
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        pointIn2[d] = pointIn1[d] + warpVector[d];
+        }
+
+      typename DisplacementFieldInterpolatorType::OutputType displacement( 0.0 );
+      if( interpolator->IsInsideBuffer( pointIn2 ) )
+        {
+        displacement = interpolator->Evaluate( pointIn2 );
+        }
+
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        pointIn3[d] = pointIn2[d] + displacement[d];
+        }
+
+      outputBuffer[lineOffset + i] = pointIn3 - pointIn1;
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 /*
  * PrintSelf
  */
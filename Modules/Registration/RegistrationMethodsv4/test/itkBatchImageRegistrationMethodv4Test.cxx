@@ -0,0 +1,258 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkBatchImageRegistrationMethodv4.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkTranslationTransform.h"
+#include "itkGradientDescentOptimizerv4.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkCastImageFilter.h"
+#include "itkCommand.h"
+
+#include <stdexcept>
+
+/**
+ * Register shifted blobs to the same fixed blob with a batch of concurrent
+ * translation registrations, the moving images being created on demand,
+ * and the fixed image being the output of a filter not updated yet.
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+typedef itk::Image< double, Dimension >                                ImageType;
+typedef itk::TranslationTransform< double, Dimension >                 TransformType;
+typedef itk::ImageRegistrationMethodv4< ImageType, ImageType, TransformType > RegistrationType;
+typedef itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >   MeanSquaresMetricType;
+typedef itk::GradientDescentOptimizerv4                                OptimizerType;
+
+const unsigned int NumberOfShifts = 6;
+const double       Shifts[NumberOfShifts][2] =
+  { { 3.0, -2.0 }, { -2.5, 1.0 }, { 1.0, 3.0 }, { -1.5, -1.5 }, { 2.0, 0.5 }, { 0.0, -3.0 } };
+
+ImageType::Pointer BatchImageRegistrationMethodv4TestImage( double shiftX, double shiftY )
+{
+  ImageType::SizeType size = { { 64, 64 } };
+  ImageType::Pointer  image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               x = index[0] - 32.0 - shiftX;
+    const double               y = index[1] - 32.0 - shiftY;
+    it.Set( 100.0 * std::exp( -( x * x + y * y ) / 80.0 ) );
+    }
+  return image;
+}
+
+/** Batch creating three level translation registrations, and the shifted
+ * moving images, as an application would read them from disk. */
+class BatchImageRegistrationMethodv4TestBatch:
+  public itk::BatchImageRegistrationMethodv4< RegistrationType >
+{
+public:
+  typedef BatchImageRegistrationMethodv4TestBatch                Self;
+  typedef itk::BatchImageRegistrationMethodv4< RegistrationType > Superclass;
+  typedef itk::SmartPointer< Self >                              Pointer;
+
+  itkNewMacro( Self );
+
+  /** Whether the missing moving image throws a standard exception. */
+  bool m_ThrowStandardException;
+
+protected:
+  BatchImageRegistrationMethodv4TestBatch() : m_ThrowStandardException( false ) {}
+
+  virtual RegistrationPointer CreateRegistration( itk::SizeValueType ) ITK_OVERRIDE
+    {
+    RegistrationPointer registration = RegistrationType::New();
+
+    MeanSquaresMetricType::Pointer metric = MeanSquaresMetricType::New();
+    registration->SetMetric( metric );
+
+    OptimizerType::Pointer optimizer = OptimizerType::New();
+    optimizer->SetNumberOfIterations( 100 );
+    optimizer->SetLearningRate( 0.05 );
+    optimizer->SetDoEstimateLearningRateOnce( false );
+    optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+    registration->SetOptimizer( optimizer );
+
+    RegistrationType::ShrinkFactorsArrayType shrinkFactors( 3 );
+    shrinkFactors[0] = 4;
+    shrinkFactors[1] = 2;
+    shrinkFactors[2] = 1;
+    registration->SetShrinkFactorsPerLevel( shrinkFactors );
+    RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 3 );
+    smoothingSigmas[0] = 2;
+    smoothingSigmas[1] = 1;
+    smoothingSigmas[2] = 0;
+    registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+    return registration;
+    }
+
+  virtual MovingImageConstPointer LoadMovingImage( itk::SizeValueType index ) ITK_OVERRIDE
+    {
+    // the last moving image is missing, to check that its failure does not
+    // stop the other registrations
+    if( index + 1 >= this->GetNumberOfMovingImages() )
+      {
+      if( this->m_ThrowStandardException )
+        {
+        throw std::runtime_error( "Missing moving image" );
+        }
+      return ITK_NULLPTR;
+      }
+    return BatchImageRegistrationMethodv4TestImage( Shifts[index][0], Shifts[index][1] ).GetPointer();
+    }
+};
+
+/** Observer storing the translations as the registrations finish. */
+class BatchImageRegistrationMethodv4TestObserver : public itk::Command
+{
+public:
+  typedef BatchImageRegistrationMethodv4TestObserver Self;
+  typedef itk::Command                               Superclass;
+  typedef itk::SmartPointer< Self >                  Pointer;
+
+  itkNewMacro( Self );
+
+  virtual void Execute( const itk::Object *, const itk::EventObject & ) ITK_OVERRIDE
+    {
+    }
+
+  virtual void Execute( itk::Object * caller, const itk::EventObject & event ) ITK_OVERRIDE
+    {
+    if( !itk::IterationEvent().CheckEvent( &event ) )
+      {
+      return;
+      }
+    BatchImageRegistrationMethodv4TestBatch * batch = dynamic_cast< BatchImageRegistrationMethodv4TestBatch * >( caller );
+    m_Indices.push_back( batch->GetCurrentIndex() );
+    m_Translations.push_back( batch->GetCurrentRegistration()->GetTransform()->GetParameters() );
+    }
+
+  std::vector< itk::SizeValueType >            m_Indices;
+  std::vector< TransformType::ParametersType > m_Translations;
+
+protected:
+  BatchImageRegistrationMethodv4TestObserver() {}
+};
+}
+
+int itkBatchImageRegistrationMethodv4Test( int, char *[] )
+{
+  typedef itk::CastImageFilter< ImageType, ImageType > CastFilterType;
+  CastFilterType::Pointer caster = CastFilterType::New();
+  caster->SetInput( BatchImageRegistrationMethodv4TestImage( 0.0, 0.0 ) );
+
+  BatchImageRegistrationMethodv4TestBatch::Pointer batch = BatchImageRegistrationMethodv4TestBatch::New();
+  batch->SetFixedImage( caster->GetOutput() );
+  batch->SetNumberOfMovingImages( NumberOfShifts + 1 );
+  batch->SetNumberOfThreads( 4 );
+  batch->SetNumberOfConcurrentRegistrations( 3 );
+
+  BatchImageRegistrationMethodv4TestObserver::Pointer observer = BatchImageRegistrationMethodv4TestObserver::New();
+  batch->AddObserver( itk::IterationEvent(), observer );
+
+  try
+    {
+    batch->StartRegistrations();
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << "Exception thrown " << e << std::endl;
+    return EXIT_FAILURE;
+    }
+  batch->Print( std::cout );
+
+  if( batch->GetNumberOfFailedRegistrations() != 1 || batch->GetErrorDescription( NumberOfShifts ).empty() ||
+      batch->GetOutputTransform( NumberOfShifts ) != ITK_NULLPTR )
+    {
+    std::cerr << "The registration of the missing moving image did not fail." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( observer->m_Indices.size() != NumberOfShifts )
+    {
+    std::cerr << "Wrong number of reported registrations: " << observer->m_Indices.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::vector< bool > isReported( NumberOfShifts, false );
+  for( unsigned int i = 0; i < NumberOfShifts; ++i )
+    {
+    const itk::SizeValueType index = observer->m_Indices[i];
+    if( index >= NumberOfShifts || isReported[index] )
+      {
+      std::cerr << "Wrong reported registration " << index << std::endl;
+      return EXIT_FAILURE;
+      }
+    isReported[index] = true;
+
+    const TransformType::ParametersType & parameters = observer->m_Translations[i];
+    std::cout << "Registration " << index << ": translation " << parameters << std::endl;
+    if( !batch->GetErrorDescription( index ).empty() ||
+        batch->GetOutputTransform( index )->GetParameters() != parameters )
+      {
+      std::cerr << "Registration " << index << ": wrong output transform" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( std::abs( parameters[0] - Shifts[index][0] ) > 0.1 || std::abs( parameters[1] - Shifts[index][1] ) > 0.1 )
+      {
+      std::cerr << "Registration " << index << ": wrong translation " << parameters << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the fixed image was smoothed once for all the registrations
+  if( batch->GetFixedImagePyramid()->GetNumberOfSmoothedImages() != 2 )
+    {
+    std::cerr << "Wrong number of smoothed fixed images: "
+              << batch->GetFixedImagePyramid()->GetNumberOfSmoothedImages() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // without keeping the transforms, they are only given to the observer;
+  // a standard exception is reported like an ITK exception
+  observer->m_Indices.clear();
+  observer->m_Translations.clear();
+  batch->KeepOutputTransformsOff();
+  batch->SetNumberOfMovingImages( 3 );
+  batch->SetNumberOfConcurrentRegistrations( 1 );
+  batch->m_ThrowStandardException = true;
+  try
+    {
+    batch->StartRegistrations();
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << "Exception thrown " << e << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( observer->m_Indices.size() != 2 || observer->m_Indices[0] != 0 || observer->m_Indices[1] != 1 ||
+      batch->GetOutputTransform( 0 ) != ITK_NULLPTR || batch->GetNumberOfFailedRegistrations() != 1 ||
+      batch->GetErrorDescription( 2 ) != "Missing moving image" )
+    {
+    std::cerr << "Wrong serial registrations." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkTranslationTransform.h"
+#include "itkGradientDescentOptimizerv4.h"
+#include "itkRegistrationParameterScalesFromPhysicalShift.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Register two shifted blobs with a translation, drawing new metric
+ * samples at each iteration with each sampling strategy.
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+typedef itk::Image< double, Dimension >                                ImageType;
+typedef itk::TranslationTransform< double, Dimension >                 TransformType;
+typedef itk::ImageRegistrationMethodv4< ImageType, ImageType, TransformType > RegistrationType;
+typedef itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >   MetricType;
+typedef itk::GradientDescentOptimizerv4                                OptimizerType;
+typedef itk::RegistrationParameterScalesFromPhysicalShift< MetricType > ScalesEstimatorType;
+
+class SampleCounter : public itk::Command
+{
+public:
+  typedef SampleCounter           Self;
+  typedef itk::Command            Superclass;
+  typedef itk::SmartPointer<Self> Pointer;
+  itkNewMacro( Self );
+
+  virtual void Execute( itk::Object *caller, const itk::EventObject & event ) ITK_OVERRIDE
+    {
+    Execute( (const itk::Object *) caller, event );
+    }
+
+  virtual void Execute( const itk::Object *, const itk::EventObject & event ) ITK_OVERRIDE
+    {
+    if( itk::IterationEvent().CheckEvent( &event ) )
+      {
+      const MetricType::FixedSampledPointSetType * pointSet = m_Metric->GetFixedSampledPointSet();
+      if( m_PointSet != ITK_NULLPTR && pointSet != m_PointSet )
+        {
+        m_PointSetsAreReused = false;
+        }
+      m_PointSet = pointSet;
+      if( m_NumberOfIterations > 0 && pointSet->GetPoint( 0 ) != m_FirstPoint )
+        {
+        ++m_NumberOfResamplings;
+        }
+      m_FirstPoint = pointSet->GetPoint( 0 );
+      ++m_NumberOfIterations;
+      }
+    }
+
+  MetricType *                                     m_Metric;
+  const MetricType::FixedSampledPointSetType *     m_PointSet;
+  MetricType::FixedSampledPointSetType::PointType m_FirstPoint;
+  unsigned int                                     m_NumberOfIterations;
+  unsigned int                                     m_NumberOfResamplings;
+  bool                                             m_PointSetsAreReused;
+
+protected:
+  SampleCounter() :
+    m_Metric( ITK_NULLPTR ),
+    m_PointSet( ITK_NULLPTR ),
+    m_NumberOfIterations( 0 ),
+    m_NumberOfResamplings( 0 ),
+    m_PointSetsAreReused( true )
+    {}
+};
+}
+
+int itkImageRegistrationMethodv4MetricSamplingTest( int, char *[] )
+{
+  // two blobs shifted by ( 3, -2 )
+  ImageType::SizeType size = { { 64, 64 } };
+  ImageType::Pointer  images[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    images[i] = ImageType::New();
+    images[i]->SetRegions( size );
+    images[i]->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it( images[i], images[i]->GetLargestPossibleRegion() );
+    for( ; !it.IsAtEnd(); ++it )
+      {
+      const ImageType::IndexType index = it.GetIndex();
+      const double               x = index[0] - 32.0 - 3.0 * i;
+      const double               y = index[1] - 32.0 + 2.0 * i;
+      it.Set( 100.0 * std::exp( -( x * x + y * y ) / 80.0 ) );
+      }
+    }
+
+  const RegistrationType::MetricSamplingStrategyType strategies[] =
+    { RegistrationType::REGULAR, RegistrationType::RANDOM,
+      RegistrationType::STRATIFIED, RegistrationType::GRADIENT_MAGNITUDE };
+  const char * strategyNames[] = { "REGULAR", "RANDOM", "STRATIFIED", "GRADIENT_MAGNITUDE" };
+
+  for( unsigned int s = 0; s < 4; ++s )
+    {
+    MetricType::Pointer metric = MetricType::New();
+
+    RegistrationType::Pointer registration = RegistrationType::New();
+    registration->SetFixedImage( images[0] );
+    registration->SetMovingImage( images[1] );
+    registration->SetMetric( metric );
+    registration->SetNumberOfLevels( 1 );
+    RegistrationType::ShrinkFactorsArrayType shrinkFactors( 1 );
+    shrinkFactors.Fill( 1 );
+    registration->SetShrinkFactorsPerLevel( shrinkFactors );
+    RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 1 );
+    smoothingSigmas.Fill( 0 );
+    registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+    registration->SetMetricSamplingStrategy( strategies[s] );
+    registration->SetMetricSamplingPercentage( 0.05 );
+    registration->MetricSamplingPerIterationOn();
+    registration->SetMetricSamplingGrowthFactor( 1.02 );
+
+    ScalesEstimatorType::Pointer scalesEstimator = ScalesEstimatorType::New();
+    scalesEstimator->SetMetric( metric );
+    scalesEstimator->SetTransformForward( true );
+
+    OptimizerType::Pointer optimizer = OptimizerType::New();
+    optimizer->SetNumberOfIterations( 100 );
+    optimizer->SetMinimumConvergenceValue( 0.0 );
+    optimizer->SetScalesEstimator( scalesEstimator );
+    optimizer->SetMaximumStepSizeInPhysicalUnits( 1.0 );
+    optimizer->SetDoEstimateLearningRateOnce( true );
+    optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+    registration->SetOptimizer( optimizer );
+
+    SampleCounter::Pointer counter = SampleCounter::New();
+    counter->m_Metric = metric;
+    optimizer->AddObserver( itk::IterationEvent(), counter );
+
+    try
+      {
+      registration->Update();
+      }
+    catch( itk::ExceptionObject & e )
+      {
+      std::cerr << strategyNames[s] << ": exception thrown " << e << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const TransformType::ParametersType parameters = registration->GetOutput()->Get()->GetParameters();
+    std::cout << strategyNames[s] << ": translation " << parameters
+              << ", " << counter->m_NumberOfResamplings << " resamplings in " << counter->m_NumberOfIterations
+              << " iterations, final sampling percentage " << registration->GetCurrentMetricSamplingPercentage() << std::endl;
+
+    if( std::abs( parameters[0] - 3.0 ) > 0.2 || std::abs( parameters[1] + 2.0 ) > 0.2 )
+      {
+      std::cerr << strategyNames[s] << ": wrong translation " << parameters << std::endl;
+      return EXIT_FAILURE;
+      }
+    // the samples of the following iteration are drawn when the optimizer
+    // invokes the iteration event
+    if( counter->m_NumberOfIterations < 2 || counter->m_NumberOfResamplings + 1 < counter->m_NumberOfIterations - 1 )
+      {
+      std::cerr << strategyNames[s] << ": the samples were not drawn at each iteration" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( !counter->m_PointSetsAreReused )
+      {
+      std::cerr << strategyNames[s] << ": the sample point set was not reused" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if( !( registration->GetCurrentMetricSamplingPercentage() > 0.05 ) ||
+        registration->GetCurrentMetricSamplingPercentage() > 1.0 )
+      {
+      std::cerr << strategyNames[s] << ": wrong sampling percentage "
+                << registration->GetCurrentMetricSamplingPercentage() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
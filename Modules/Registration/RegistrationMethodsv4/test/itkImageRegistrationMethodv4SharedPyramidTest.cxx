@@ -0,0 +1,207 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkSyNImageRegistrationMethod.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkTranslationTransform.h"
+#include "itkGradientDescentOptimizerv4.h"
+#include "itkRegistrationParameterScalesFromPhysicalShift.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Register several shifted blobs to the same fixed blob with a translation,
+ * sharing the smoothed fixed images through an image pyramid, and run a SyN
+ * registration with the same pyramid.
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+typedef itk::Image< double, Dimension >                                ImageType;
+typedef itk::TranslationTransform< double, Dimension >                 TransformType;
+typedef itk::ImageRegistrationMethodv4< ImageType, ImageType, TransformType > RegistrationType;
+typedef itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >   MetricType;
+typedef itk::GradientDescentOptimizerv4                                OptimizerType;
+typedef itk::RegistrationParameterScalesFromPhysicalShift< MetricType > ScalesEstimatorType;
+typedef RegistrationType::FixedImagePyramidType                        PyramidType;
+
+ImageType::Pointer ImageRegistrationMethodv4SharedPyramidImage( double shiftX, double shiftY )
+{
+  ImageType::SizeType size = { { 64, 64 } };
+  ImageType::Pointer  image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               x = index[0] - 32.0 - shiftX;
+    const double               y = index[1] - 32.0 - shiftY;
+    it.Set( 100.0 * std::exp( -( x * x + y * y ) / 80.0 ) );
+    }
+  return image;
+}
+
+/** Register the moving image to the fixed image with three levels, and
+ * return the translation. */
+TransformType::ParametersType
+ImageRegistrationMethodv4SharedPyramidRegistration( ImageType * fixedImage, ImageType * movingImage,
+                                                    PyramidType * fixedImagePyramid, PyramidType * movingImagePyramid )
+{
+  MetricType::Pointer metric = MetricType::New();
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+  registration->SetMetric( metric );
+  registration->SetNumberOfLevels( 3 );
+  RegistrationType::ShrinkFactorsArrayType shrinkFactors( 3 );
+  shrinkFactors[0] = 4;
+  shrinkFactors[1] = 2;
+  shrinkFactors[2] = 1;
+  registration->SetShrinkFactorsPerLevel( shrinkFactors );
+  RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 3 );
+  smoothingSigmas[0] = 2;
+  smoothingSigmas[1] = 1;
+  smoothingSigmas[2] = 0;
+  registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+  registration->SetFixedImagePyramid( fixedImagePyramid );
+  registration->SetMovingImagePyramid( movingImagePyramid );
+
+  ScalesEstimatorType::Pointer scalesEstimator = ScalesEstimatorType::New();
+  scalesEstimator->SetMetric( metric );
+  scalesEstimator->SetTransformForward( true );
+
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  optimizer->SetNumberOfIterations( 100 );
+  optimizer->SetScalesEstimator( scalesEstimator );
+  optimizer->SetLearningRate( 0.05 );
+  optimizer->SetDoEstimateLearningRateOnce( false );
+  optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+  registration->SetOptimizer( optimizer );
+
+  registration->Update();
+
+  return registration->GetOutput()->Get()->GetParameters();
+}
+}
+
+int itkImageRegistrationMethodv4SharedPyramidTest( int, char *[] )
+{
+  ImageType::Pointer fixedImage = ImageRegistrationMethodv4SharedPyramidImage( 0.0, 0.0 );
+
+  // the registrations to the same fixed image share its smoothed images
+  PyramidType::Pointer fixedImagePyramid = PyramidType::New();
+  const double         shifts[3][2] = { { 3.0, -2.0 }, { -2.5, 1.0 }, { 1.0, 3.0 } };
+  for( unsigned int i = 0; i < 3; ++i )
+    {
+    ImageType::Pointer   movingImage = ImageRegistrationMethodv4SharedPyramidImage( shifts[i][0], shifts[i][1] );
+    PyramidType::Pointer movingImagePyramid = PyramidType::New();
+
+    TransformType::ParametersType parameters;
+    try
+      {
+      parameters = ImageRegistrationMethodv4SharedPyramidRegistration( fixedImage, movingImage, fixedImagePyramid,
+                                                                       movingImagePyramid );
+      }
+    catch( itk::ExceptionObject & e )
+      {
+      std::cerr << "Registration " << i << ": exception thrown " << e << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::cout << "Registration " << i << ": translation " << parameters << std::endl;
+
+    if( std::abs( parameters[0] - shifts[i][0] ) > 0.1 || std::abs( parameters[1] - shifts[i][1] ) > 0.1 )
+      {
+      std::cerr << "Registration " << i << ": wrong translation " << parameters << std::endl;
+      return EXIT_FAILURE;
+      }
+    // the image smoothed with a null sigma is the fixed image itself
+    if( fixedImagePyramid->GetNumberOfSmoothedImages() != 2 )
+      {
+      std::cerr << "Wrong number of smoothed fixed images: " << fixedImagePyramid->GetNumberOfSmoothedImages() << std::endl;
+      return EXIT_FAILURE;
+      }
+    // the smoothed moving images are released at the end of the registration
+    if( movingImagePyramid->GetNumberOfSmoothedImages() != 0 )
+      {
+      std::cerr << "The smoothed moving images were not released: "
+                << movingImagePyramid->GetNumberOfSmoothedImages() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // SyN takes the smoothed images from the same pyramid
+  typedef itk::SyNImageRegistrationMethod< ImageType, ImageType > SyNRegistrationType;
+  ImageType::Pointer movingImage = ImageRegistrationMethodv4SharedPyramidImage( shifts[0][0], shifts[0][1] );
+
+  MetricType::Pointer metric = MetricType::New();
+
+  SyNRegistrationType::Pointer synRegistration = SyNRegistrationType::New();
+  synRegistration->SetFixedImage( fixedImage );
+  synRegistration->SetMovingImage( movingImage );
+  synRegistration->SetMetric( metric );
+  synRegistration->SetNumberOfLevels( 1 );
+  SyNRegistrationType::ShrinkFactorsArrayType shrinkFactors( 1 );
+  shrinkFactors.Fill( 2 );
+  synRegistration->SetShrinkFactorsPerLevel( shrinkFactors );
+  SyNRegistrationType::SmoothingSigmasArrayType smoothingSigmas( 1 );
+  smoothingSigmas.Fill( 1 );
+  synRegistration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+  SyNRegistrationType::NumberOfIterationsArrayType numberOfIterations( 1 );
+  numberOfIterations.Fill( 5 );
+  synRegistration->SetNumberOfIterationsPerLevel( numberOfIterations );
+  synRegistration->SetDownsampleImagesForMetricDerivatives( false );
+  synRegistration->SetFixedImagePyramid( fixedImagePyramid );
+  SyNRegistrationType::MovingImagePyramidType::Pointer movingImagePyramid = SyNRegistrationType::MovingImagePyramidType::New();
+  synRegistration->SetMovingImagePyramid( movingImagePyramid );
+  // keep the smoothed moving images to check them below
+  synRegistration->ReleaseMovingSmoothedImagesOff();
+
+  try
+    {
+    synRegistration->Update();
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << "SyN registration: exception thrown " << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  PyramidType::VarianceType variance;
+  variance.Fill( 1.0 );
+  if( fixedImagePyramid->GetNumberOfSmoothedImages() != 2 || movingImagePyramid->GetNumberOfSmoothedImages() != 1 )
+    {
+    std::cerr << "SyN registration: wrong number of smoothed images" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // the last update of SyN is computed from the moving image to the fixed
+  // image, the metric gets grafts of the smoothed images
+  if( metric->GetFixedImage()->GetBufferPointer() !=
+        movingImagePyramid->GetSmoothedImage( movingImage, variance, true )->GetBufferPointer() ||
+      metric->GetMovingImage()->GetBufferPointer() !=
+        fixedImagePyramid->GetSmoothedImage( fixedImage, variance, true )->GetBufferPointer() )
+    {
+    std::cerr << "SyN registration: the smoothed images were not taken from the pyramids" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkTranslationTransform.h"
+#include "itkGradientDescentOptimizerv4.h"
+#include "itkRegistrationParameterScalesFromPhysicalShift.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Register a shifted blob with three levels, with and without a warm start
+ * of the optimizer, and check that the scales and the learning rate are only
+ * estimated at the first level with the warm start.
+ */
+
+namespace
+{
+const unsigned int Dimension = 2;
+typedef itk::Image< double, Dimension >                                ImageType;
+typedef itk::TranslationTransform< double, Dimension >                 TransformType;
+typedef itk::ImageRegistrationMethodv4< ImageType, ImageType, TransformType > RegistrationType;
+typedef itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >   MeanSquaresMetricType;
+typedef itk::GradientDescentOptimizerv4                                OptimizerType;
+
+/** Scales estimator counting its estimations. */
+class ImageRegistrationMethodv4WarmStartScalesEstimator:
+  public itk::RegistrationParameterScalesFromPhysicalShift< MeanSquaresMetricType >
+{
+public:
+  typedef ImageRegistrationMethodv4WarmStartScalesEstimator                            Self;
+  typedef itk::RegistrationParameterScalesFromPhysicalShift< MeanSquaresMetricType >  Superclass;
+  typedef itk::SmartPointer< Self >                                                   Pointer;
+
+  itkNewMacro( Self );
+
+  virtual void EstimateScales( ScalesType & scales ) ITK_OVERRIDE
+    {
+    ++m_NumberOfScalesEstimations;
+    Superclass::EstimateScales( scales );
+    }
+
+  virtual FloatType EstimateStepScale( const ParametersType & step ) ITK_OVERRIDE
+    {
+    ++m_NumberOfStepScaleEstimations;
+    return Superclass::EstimateStepScale( step );
+    }
+
+  unsigned int m_NumberOfScalesEstimations;
+  unsigned int m_NumberOfStepScaleEstimations;
+
+protected:
+  ImageRegistrationMethodv4WarmStartScalesEstimator() :
+    m_NumberOfScalesEstimations( 0 ),
+    m_NumberOfStepScaleEstimations( 0 )
+  {}
+};
+
+ImageType::Pointer ImageRegistrationMethodv4WarmStartImage( double shiftX, double shiftY )
+{
+  ImageType::SizeType size = { { 64, 64 } };
+  ImageType::Pointer  image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               x = index[0] - 32.0 - shiftX;
+    const double               y = index[1] - 32.0 - shiftY;
+    it.Set( 100.0 * std::exp( -( x * x + y * y ) / 80.0 ) );
+    }
+  return image;
+}
+
+/** Run the registration, and check the number of estimations, and the
+ * translation with the warm start. */
+int ImageRegistrationMethodv4WarmStartRegistration( bool warmStart, unsigned int expectedNumberOfEstimations )
+{
+  const double       shift[2] = { 3.0, -2.0 };
+  ImageType::Pointer fixedImage = ImageRegistrationMethodv4WarmStartImage( 0.0, 0.0 );
+  ImageType::Pointer movingImage = ImageRegistrationMethodv4WarmStartImage( shift[0], shift[1] );
+
+  MeanSquaresMetricType::Pointer metric = MeanSquaresMetricType::New();
+
+  ImageRegistrationMethodv4WarmStartScalesEstimator::Pointer scalesEstimator =
+    ImageRegistrationMethodv4WarmStartScalesEstimator::New();
+  scalesEstimator->SetMetric( metric );
+  scalesEstimator->SetTransformForward( true );
+
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  optimizer->SetNumberOfIterations( 100 );
+  optimizer->SetScalesEstimator( scalesEstimator );
+  optimizer->SetMaximumStepSizeInPhysicalUnits( 0.5 );
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+  registration->SetMetric( metric );
+  registration->SetOptimizer( optimizer );
+  registration->SetNumberOfLevels( 3 );
+  RegistrationType::ShrinkFactorsArrayType shrinkFactors( 3 );
+  shrinkFactors[0] = 4;
+  shrinkFactors[1] = 2;
+  shrinkFactors[2] = 1;
+  registration->SetShrinkFactorsPerLevel( shrinkFactors );
+  RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 3 );
+  smoothingSigmas[0] = 2;
+  smoothingSigmas[1] = 1;
+  smoothingSigmas[2] = 0;
+  registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+  registration->SetWarmStartOptimizer( warmStart );
+
+  try
+    {
+    registration->Update();
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << "Exception thrown " << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const TransformType::ParametersType parameters = registration->GetOutput()->Get()->GetParameters();
+  std::cout << "Warm start " << warmStart << ": translation " << parameters
+            << ", scales estimations " << scalesEstimator->m_NumberOfScalesEstimations
+            << ", step scale estimations " << scalesEstimator->m_NumberOfStepScaleEstimations << std::endl;
+
+  // without the warm start, the learning rate estimated at the start of a
+  // level is large as the translation is already close to the solution
+  if( warmStart && ( std::abs( parameters[0] - shift[0] ) > 0.1 || std::abs( parameters[1] - shift[1] ) > 0.1 ) )
+    {
+    std::cerr << "Wrong translation " << parameters << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( scalesEstimator->m_NumberOfScalesEstimations != expectedNumberOfEstimations ||
+      scalesEstimator->m_NumberOfStepScaleEstimations != expectedNumberOfEstimations )
+    {
+    std::cerr << "Wrong number of estimations, expected " << expectedNumberOfEstimations << std::endl;
+    return EXIT_FAILURE;
+    }
+  // the settings of the optimizer are restored
+  if( !optimizer->GetDoEstimateScales() || !optimizer->GetDoEstimateLearningRateOnce() )
+    {
+    std::cerr << "The optimizer settings were not restored." << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int itkImageRegistrationMethodv4WarmStartTest( int, char *[] )
+{
+  if( ImageRegistrationMethodv4WarmStartRegistration( false, 3 ) != EXIT_SUCCESS ||
+      ImageRegistrationMethodv4WarmStartRegistration( true, 1 ) != EXIT_SUCCESS )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
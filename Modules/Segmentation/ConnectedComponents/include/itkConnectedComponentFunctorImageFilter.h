@@ -28,23 +28,24 @@ namespace itk
  * objects in an artibitrary image.
  *
  * ConnectedComponentFunctorImageFilter labels the objects in an arbitrary
- * image. Each distinct object is assigned a unique label. The filter makes
- * three passes through the image.  The first pass initializes the
- * output.  The second pass labels each foreground pixel such that all
- * the pixels associated with an object either have the same label or
- * have had their labels entered into a equivalency table.  The third
- * pass through the image flattens the equivalency table such that all
- * pixels for an object have the same label.
+ * image. Each distinct object is assigned a unique label. The image is
+ * split in blocks, one per thread. The first pass labels each block
+ * independently, such that all the pixels of an object in the block either
+ * have the same label or have had their labels entered into an equivalency
+ * table of the block. The labels of the blocks are then gathered in a
+ * union-find structure, where the threads link the labels of the objects
+ * crossing the borders of the blocks concurrently, without locks (see
+ * ConcurrentUnionFind). The last pass writes the final labels, each thread
+ * writing its block.
  *
  * The functor specifies the criteria to join neighboring pixels.  For
  * example a simple intensity threshold difference might be used for
  * scalar imagery.
  *
- * The final object labels are in no particular order (and some object
- * labels may not be used on the final objects).  You can reorder the
- * labels such that object labels are consecutive and sorted based on
- * object size by passing the output of this filter to a
- * RelabelComponentImageFilter.
+ * The final object labels are consecutive, starting at 1, and objects
+ * reached earlier by a raster order scan have a lower label. You can
+ * reorder the labels such that they are sorted based on object size by
+ * passing the output of this filter to a RelabelComponentImageFilter.
  *
  * \sa ImageToImageFilter
  * \ingroup ITKConnectedComponents
@@ -152,7 +153,11 @@ public:
 #endif
 
 protected:
-  ConnectedComponentFunctorImageFilter() {}
+  ConnectedComponentFunctorImageFilter():
+    m_CurrentPass(LabelBlocksPass),
+    m_SplitAxis(0)
+  {}
+
   virtual ~ConnectedComponentFunctorImageFilter() {}
   ConnectedComponentFunctorImageFilter(const Self &) {}
 
@@ -162,6 +167,59 @@ protected:
    * Standard pipeline method.
    */
   void GenerateData() ITK_OVERRIDE;
+
+  /** Run the current pass on a block of the image. */
+  void ThreadedGenerateData(const RegionType & outputRegionForThread, ThreadIdType threadId) ITK_OVERRIDE;
+
+private:
+  void operator=(const Self &); //purposely not implemented
+
+  typedef typename Superclass::LabelType                  LabelType;
+  typedef Image< LabelType, ImageDimension >              LabelImageType;
+  typedef typename TInputImage::OffsetType                OffsetType;
+  typedef std::vector< OffsetType >                       OffsetVectorType;
+  typedef std::vector< LabelType >                        EquivalencesType;
+  typedef ConcurrentUnionFind< LabelType >                UnionFindType;
+
+  /** The passes run by the threads, in that order. */
+  enum PassType {
+    LabelBlocksPass,
+    InsertLabelsPass,
+    LinkBordersPass,
+    FlattenLabelsPass,
+    RelabelRootsPass,
+    WriteOutputPass
+  };
+
+  /** Label a block, with labels local to the block. */
+  void LabelBlock(const RegionType & region, ThreadIdType blockId);
+
+  /** Link the labels of the first slice of a block with the labels of the
+   * last slice of the previous block. */
+  void LinkBlockBorder(const RegionType & region, ThreadIdType blockId);
+
+  /** Write the final labels of a block. */
+  void WriteBlock(const RegionType & region, ThreadIdType blockId);
+
+  /** Union-find operations on the local labels of a block. */
+  static LabelType LookupBlockLabel(EquivalencesType & equivalences, LabelType label);
+
+  static void LinkBlockLabels(EquivalencesType & equivalences, LabelType label1, LabelType label2);
+
+  PassType         m_CurrentPass;
+  unsigned int     m_SplitAxis;
+  OffsetVectorType m_PreviousOffsets;
+
+  typename LabelImageType::Pointer m_LabelImage;
+
+  /** The local equivalences of each block, the first global label of each
+   * block and its number of objects. */
+  std::vector< EquivalencesType > m_BlockEquivalences;
+  std::vector< LabelType >        m_FirstBlockLabels;
+  std::vector< LabelType >        m_NumberOfBlockObjects;
+
+  UnionFindType                  m_Equivalences;
+  std::vector< OutputPixelType > m_FinalLabels;
 };
 } // end namespace itk
 
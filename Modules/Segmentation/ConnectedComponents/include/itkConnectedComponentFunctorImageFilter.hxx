@@ -21,10 +21,11 @@
 #include "itkConnectedComponentFunctorImageFilter.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
-#include "itkEquivalencyTable.h"
 #include "itkConstShapedNeighborhoodIterator.h"
 #include "itkConstantBoundaryCondition.h"
 
+#include <algorithm>
+
 namespace itk
 {
 template< typename TInputImage, typename TOutputImage, typename TFunctor, typename TMaskImage >
@@ -32,210 +33,443 @@ void
 ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
 ::GenerateData()
 {
-  // create an equivalency table
-  EquivalencyTable::Pointer eqTable = EquivalencyTable::New();
-
-  InputPixelType        value, neighborValue;
-  OutputPixelType       label, originalLabel, neighborLabel;
-  OutputPixelType       maxLabel = NumericTraits< OutputPixelType >::ZeroValue();
-  const OutputPixelType maxPossibleLabel = NumericTraits< OutputPixelType >::max();
-
   typename TOutputImage::Pointer output = this->GetOutput();
-  typename TInputImage::ConstPointer input = this->GetInput();
 
-  // Allocate the output and initialize to unlabeled
+  // Allocate the output, and the image of the labels local to the blocks
   this->AllocateOutputs();
-  output->FillBuffer(maxPossibleLabel);
-
-  // Set up the boundary condition to be zero padded (used on output image)
-  ConstantBoundaryCondition< TOutputImage > BC;
-  BC.SetConstant(NumericTraits< OutputPixelType >::ZeroValue());
-
-  // Neighborhood iterators.  Let's use a shaped neighborhood so we can
-  // restrict the access to face connected neighbors. These iterators
-  // will be applied to both the input and the output image
-  typedef ConstShapedNeighborhoodIterator< TInputImage >  InputNeighborhoodIteratorType;
-  typedef ConstShapedNeighborhoodIterator< TOutputImage > OutputNeighborhoodIteratorType;
-
-  SizeType kernelRadius;
-  kernelRadius.Fill(1);
-
-  InputNeighborhoodIteratorType  init( kernelRadius, input, output->GetRequestedRegion() );
-  OutputNeighborhoodIteratorType onit( kernelRadius, output, output->GetRequestedRegion() );
-  onit.OverrideBoundaryCondition(&BC); // assign the boundary condition
-
-  // only activate the indices that are "previous" to the current
-  // pixel and face connected (exclude the center pixel from the
-  // neighborhood)
-  //
-  unsigned int d;
-  typename OutputNeighborhoodIteratorType::OffsetType offset;
+  m_LabelImage = LabelImageType::New();
+  m_LabelImage->CopyInformation(output);
+  m_LabelImage->SetRegions( output->GetRequestedRegion() );
+  m_LabelImage->Allocate();
 
+  // the "previous" neighbors, i.e. the neighbors already visited in a
+  // raster order scan
+  m_PreviousOffsets.clear();
+  OffsetType offset;
+  offset.Fill(0);
   if ( !this->m_FullyConnected )
     {
-    // only activate the "previous" neighbors that are face connected
-    // to the current pixel. do not include the center pixel
-    offset.Fill(0);
-    for ( d = 0; d < InputImageType::ImageDimension; ++d )
+    // the "previous" neighbors that are face connected to the current pixel
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
       {
       offset[d] = -1;
-      init.ActivateOffset(offset);
-      onit.ActivateOffset(offset);
+      m_PreviousOffsets.push_back(offset);
       offset[d] = 0;
       }
     }
   else
     {
-    // activate all "previous" neighbors that are face+edge+vertex
-    // connected to the current pixel. do not include the center pixel
-    unsigned int centerIndex = onit.GetCenterNeighborhoodIndex();
-    for ( d = 0; d < centerIndex; d++ )
+    // all the "previous" neighbors that are face+edge+vertex connected to
+    // the current pixel
+    Neighborhood< char, ImageDimension > neighborhood;
+    neighborhood.SetRadius(1);
+    for ( unsigned int d = 0; d < neighborhood.GetCenterNeighborhoodIndex(); ++d )
       {
-      offset = onit.GetOffset(d);
-      init.ActivateOffset(offset);
-      onit.ActivateOffset(offset);
+      m_PreviousOffsets.push_back( neighborhood.GetOffset(d) );
       }
     }
 
-  // along with a neighborhood iterator on the output, use a standard
-  // iterator on the input and output
-  ImageRegionConstIterator< InputImageType > it;
-  ImageRegionIterator< OutputImageType >     oit;
-  it = ImageRegionConstIterator< InputImageType >( input, output->GetRequestedRegion() );
-  oit = ImageRegionIterator< OutputImageType >( output, output->GetRequestedRegion() );
+  // the blocks are the regions of the threads, split along a single axis
+  typename ImageSource< OutputImageType >::ThreadStruct str;
+  str.Filter = this;
 
-  // Setup a progress reporter.  We have 2 stages to the algorithm so
-  // pretend we have 2 times the number of pixels
-  ProgressReporter progress( this, 0, 2 * output->GetRequestedRegion().GetNumberOfPixels() );
+  MultiThreader *multithreader = this->GetMultiThreader();
+  multithreader->SetNumberOfThreads( this->GetNumberOfThreads() );
+  multithreader->SetSingleMethod(this->ThreaderCallback, &str);
 
-  // if the mask is set mark pixels not under the mask as background
-  typename TMaskImage::ConstPointer mask = this->GetMaskImage();
-  if ( mask )
+  RegionType         splitRegion;
+  const ThreadIdType numberOfBlocks =
+    this->SplitRequestedRegion(0, multithreader->GetNumberOfThreads(), splitRegion);
+  m_SplitAxis = 0;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    if ( splitRegion.GetSize()[d] != output->GetRequestedRegion().GetSize()[d] )
+      {
+      m_SplitAxis = d;
+      }
+    }
+
+  // label the blocks independently
+  m_BlockEquivalences.clear();
+  m_BlockEquivalences.resize(numberOfBlocks);
+  m_CurrentPass = LabelBlocksPass;
+  multithreader->SingleMethodExecute();
+
+  // give each block a range of global labels
+  m_FirstBlockLabels.resize(numberOfBlocks);
+  LabelType numberOfLabels = 0;
+  for ( ThreadIdType i = 0; i < numberOfBlocks; ++i )
+    {
+    m_FirstBlockLabels[i] = numberOfLabels + 1;
+    numberOfLabels += m_BlockEquivalences[i].size() - 1;
+    }
+  m_Equivalences.SetSize(numberOfLabels + 1);
+  m_Equivalences.InsertSet(0);
+
+  // insert the labels and the equivalences of the blocks, then link the
+  // labels across the borders of the blocks
+  m_CurrentPass = InsertLabelsPass;
+  multithreader->SingleMethodExecute();
+  m_BlockEquivalences.clear();
+
+  m_CurrentPass = LinkBordersPass;
+  multithreader->SingleMethodExecute();
+
+  // find the objects, and give them consecutive labels
+  m_NumberOfBlockObjects.assign(numberOfBlocks, 0);
+  m_CurrentPass = FlattenLabelsPass;
+  multithreader->SingleMethodExecute();
+
+  LabelType numberOfObjects = 0;
+  for ( ThreadIdType i = 0; i < numberOfBlocks; ++i )
+    {
+    numberOfObjects += m_NumberOfBlockObjects[i];
+    }
+  const OutputPixelType maxPossibleLabel = NumericTraits< OutputPixelType >::max();
+  if ( numberOfObjects > static_cast< LabelType >( maxPossibleLabel ) )
+    {
+    itkWarningMacro(
+      << "ConnectedComponentFunctorImageFilter::GenerateData: Number of labels " << numberOfObjects
+      << " exceeds number of available labels " << (long)maxPossibleLabel << " for the output type.");
+    }
+
+  m_FinalLabels.resize(numberOfLabels + 1);
+  m_FinalLabels[0] = NumericTraits< OutputPixelType >::ZeroValue();
+  m_CurrentPass = RelabelRootsPass;
+  multithreader->SingleMethodExecute();
+
+  m_CurrentPass = WriteOutputPass;
+  multithreader->SingleMethodExecute();
+
+  m_LabelImage = ITK_NULLPTR;
+  m_FirstBlockLabels.clear();
+  m_NumberOfBlockObjects.clear();
+  m_Equivalences.SetSize(0);
+  m_FinalLabels.clear();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunctor, typename TMaskImage >
+void
+ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
+::ThreadedGenerateData(const RegionType & outputRegionForThread, ThreadIdType threadId)
+{
+  if ( m_CurrentPass == LabelBlocksPass )
     {
-    ImageRegionConstIterator< MaskImageType > mit;
-    mit = ImageRegionConstIterator< MaskImageType >( mask, output->GetRequestedRegion() );
+    this->LabelBlock(outputRegionForThread, threadId);
+    return;
+    }
+
+  // the range of the global labels of the block
+  const LabelType firstLabel = m_FirstBlockLabels[threadId];
+  const LabelType lastLabel = threadId + 1 < m_FirstBlockLabels.size()
+                              ? m_FirstBlockLabels[threadId + 1] : m_Equivalences.GetSize();
+  LabelType       label;
 
-    mit.GoToBegin();
-    oit.GoToBegin();
-    while ( !mit.IsAtEnd() )
+  switch ( m_CurrentPass )
+    {
+    case LabelBlocksPass:
+      break;
+    case InsertLabelsPass:
       {
-      if ( mit.Get() == NumericTraits< MaskPixelType >::ZeroValue() )
+      // the local root of a label is smaller than the label, and thus
+      // already inserted
+      EquivalencesType & equivalences = m_BlockEquivalences[threadId];
+      for ( label = 1; label < equivalences.size(); ++label )
         {
-        // mark pixel as unlabeled
-        oit.Set(NumericTraits< OutputPixelType >::ZeroValue());
+        m_Equivalences.InsertSet(firstLabel + label - 1);
+        const LabelType root = LookupBlockLabel(equivalences, label);
+        if ( root != label )
+          {
+          m_Equivalences.LinkLabels(firstLabel + root - 1, firstLabel + label - 1);
+          }
         }
-
-      ++mit;
-      ++oit;
+      break;
       }
+    case LinkBordersPass:
+      if ( threadId > 0 )
+        {
+        this->LinkBlockBorder(outputRegionForThread, threadId);
+        }
+      break;
+    case FlattenLabelsPass:
+      {
+      LabelType numberOfObjects = 0;
+      for ( label = firstLabel; label < lastLabel; ++label )
+        {
+        if ( m_Equivalences.FlattenSet(label) == label )
+          {
+          ++numberOfObjects;
+          }
+        }
+      m_NumberOfBlockObjects[threadId] = numberOfObjects;
+      break;
+      }
+    case RelabelRootsPass:
+      {
+      // the roots get consecutive labels, in the order of the labels
+      LabelType finalLabel = 1;
+      for ( ThreadIdType i = 0; i < threadId; ++i )
+        {
+        finalLabel += m_NumberOfBlockObjects[i];
+        }
+      const LabelType maxPossibleLabel = static_cast< LabelType >( NumericTraits< OutputPixelType >::max() );
+      for ( label = firstLabel; label < lastLabel; ++label )
+        {
+        if ( m_Equivalences.GetParent(label) == label )
+          {
+          m_FinalLabels[label] = static_cast< OutputPixelType >( std::min(finalLabel, maxPossibleLabel) );
+          ++finalLabel;
+          }
+        }
+      break;
+      }
+    case WriteOutputPass:
+      this->WriteBlock(outputRegionForThread, threadId);
+      break;
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunctor, typename TMaskImage >
+void
+ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
+::LabelBlock(const RegionType & region, ThreadIdType blockId)
+{
+  typename TInputImage::ConstPointer input = this->GetInput();
+  typename TMaskImage::ConstPointer mask = this->GetMaskImage();
+
+  EquivalencesType & equivalences = m_BlockEquivalences[blockId];
+  equivalences.assign( 1, NumericTraits< LabelType >::ZeroValue() );
+
+  // Set up the boundary condition to be zero padded (used on label image)
+  ConstantBoundaryCondition< LabelImageType > BC;
+  BC.SetConstant(NumericTraits< LabelType >::ZeroValue());
+
+  // Neighborhood iterators.  Let's use a shaped neighborhood so we can
+  // restrict the access to the "previous" neighbors. These iterators
+  // will be applied to both the input and the label image
+  typedef ConstShapedNeighborhoodIterator< TInputImage >    InputNeighborhoodIteratorType;
+  typedef ConstShapedNeighborhoodIterator< LabelImageType > LabelNeighborhoodIteratorType;
+
+  SizeType kernelRadius;
+  kernelRadius.Fill(1);
+
+  InputNeighborhoodIteratorType init(kernelRadius, input, region);
+  LabelNeighborhoodIteratorType lnit(kernelRadius, m_LabelImage, region);
+  lnit.OverrideBoundaryCondition(&BC); // assign the boundary condition
+  for ( typename OffsetVectorType::const_iterator oIt = m_PreviousOffsets.begin();
+        oIt != m_PreviousOffsets.end(); ++oIt )
+    {
+    init.ActivateOffset(*oIt);
+    lnit.ActivateOffset(*oIt);
     }
 
-  // iterate over the image, labeling the objects and defining
+  // the neighbors of the first slice of the block in the previous block
+  // are linked later, as they are labeled by another thread
+  std::vector< bool > inPreviousBlock;
+  typename LabelNeighborhoodIteratorType::ConstIterator lsIt;
+  for ( lsIt = lnit.Begin(); !lsIt.IsAtEnd(); ++lsIt )
+    {
+    inPreviousBlock.push_back(blockId > 0 && lsIt.GetNeighborhoodOffset()[m_SplitAxis] < 0);
+    }
+  const SizeValueType firstSliceSize = region.GetNumberOfPixels() / region.GetSize()[m_SplitAxis];
+
+  ImageRegionConstIterator< InputImageType > it(input, region);
+  ImageRegionIterator< LabelImageType >      lit(m_LabelImage, region);
+  ImageRegionConstIterator< MaskImageType >  mit;
+  if ( mask )
+    {
+    mit = ImageRegionConstIterator< MaskImageType >(mask, region);
+    }
+
+  ProgressReporter progress(this, blockId, region.GetNumberOfPixels(), 100, 0.0f, 0.5f);
+
+  // iterate over the block, labeling the objects and defining
   // equivalence classes.  Use the neighborhood iterator to access the
-  // "previous" neighbor pixels and an output iterator to access the
-  // current pixel
-  init.GoToBegin();
-  onit.GoToBegin();
-  it.GoToBegin();
-  oit.GoToBegin();
-  while ( !oit.IsAtEnd() )
+  // "previous" neighbor pixels and an iterator to access the current pixel
+  SizeValueType count = 0;
+  while ( !lit.IsAtEnd() )
     {
-    // Get the current pixel label
-    label = oit.Get();
-    value = it.Get();
-    originalLabel = label;
+    LabelType label = NumericTraits< LabelType >::ZeroValue();
 
-    // If the pixel is not background
-    if ( label != NumericTraits< OutputPixelType >::ZeroValue() )
+    // the pixels not under the mask are not labeled
+    if ( !mask || mit.Get() != NumericTraits< MaskPixelType >::ZeroValue() )
       {
+      const InputPixelType value = it.Get();
+      const bool           firstSlice = count < firstSliceSize;
+
       // loop over the "previous" neighbors to find labels.  this loop
       // may establish one or more new equivalence classes
-      typename InputNeighborhoodIteratorType::ConstIterator isIt;
-      typename OutputNeighborhoodIteratorType::ConstIterator osIt;
-      for ( isIt = init.Begin(), osIt = onit.Begin(); !osIt.IsAtEnd(); ++isIt, ++osIt )
+      typename InputNeighborhoodIteratorType::ConstIterator isIt = init.Begin();
+      unsigned int                                          n = 0;
+      for ( lsIt = lnit.Begin(); !lsIt.IsAtEnd(); ++isIt, ++lsIt, ++n )
         {
-        // get the label of the pixel previous to this one along a
-        // particular dimension (neighbors activated in neighborhood iterator)
-        neighborLabel = osIt.Get();
+        if ( firstSlice && inPreviousBlock[n] )
+          {
+          continue;
+          }
+        const LabelType neighborLabel = lsIt.Get();
 
-        // if the previous pixel has a label, verify equivalence or
-        // establish a new equivalence
-        if ( neighborLabel != NumericTraits< OutputPixelType >::ZeroValue() )
+        // if the previous pixel has a label and is connected to the current
+        // pixel, copy its label or establish a new equivalence
+        if ( neighborLabel != NumericTraits< LabelType >::ZeroValue() && m_Functor( value, isIt.Get() ) )
           {
-          // see if current pixel is connected to its neighbor
-          neighborValue = isIt.Get();
-          if ( m_Functor(value, neighborValue) )
+          if ( label == NumericTraits< LabelType >::ZeroValue() )
+            {
+            label = neighborLabel;
+            }
+          else if ( label != neighborLabel )
             {
-            // if current pixel is unlabeled, then copy the label from neighbor
-            if ( label == maxPossibleLabel )
-              {
-              // copy the label from the previous pixel
-              label = neighborLabel;
-              }
-            // else if current pixel has a label that is not already
-            // equivalent to the label of the previous pixel, then setup
-            // a new equivalence.
-            else if ( ( label != neighborLabel )
-                      && ( eqTable->RecursiveLookup(label)
-                           != eqTable->RecursiveLookup(neighborLabel) ) )
-              {
-              eqTable->Add(label, neighborLabel);
-              }
+            LinkBlockLabels(equivalences, label, neighborLabel);
             }
           }
         }
 
       // if none of the "previous" neighbors were set, then make a new label
-      if ( originalLabel == label )
+      if ( label == NumericTraits< LabelType >::ZeroValue() )
         {
-        // create a new entry label
-        if ( maxLabel == maxPossibleLabel )
-          {
-          itkWarningMacro(
-            << "ConnectedComponentFunctorImageFilter::GenerateData: Number of labels " << (long)maxLabel
-            << " exceeds number of available labels " << (long)maxPossibleLabel << " for the output type.");
-          }
-        else
-          {
-          ++maxLabel;
-          }
-
-        // assign the new label
-        label = maxLabel;
-        }
-
-      // Finally, set the output pixel to whatever label we have
-      if ( label != originalLabel )
-        {
-        oit.Set(label);
+        label = static_cast< LabelType >( equivalences.size() );
+        equivalences.push_back(label);
         }
       }
+    lit.Set(label);
 
     // move the iterators
     ++init;
-    ++onit;
+    ++lnit;
     ++it;
-    ++oit;
+    ++lit;
+    if ( mask )
+      {
+      ++mit;
+      }
+    ++count;
     progress.CompletedPixel();
     }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunctor, typename TMaskImage >
+void
+ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
+::LinkBlockBorder(const RegionType & region, ThreadIdType blockId)
+{
+  typename TInputImage::ConstPointer input = this->GetInput();
+
+  // the first slice of the block, whose "previous" neighbors across the
+  // split axis are in the previous block
+  RegionType sliceRegion = region;
+  SizeType   sliceSize = region.GetSize();
+  sliceSize[m_SplitAxis] = 1;
+  sliceRegion.SetSize(sliceSize);
+
+  ConstantBoundaryCondition< LabelImageType > BC;
+  BC.SetConstant(NumericTraits< LabelType >::ZeroValue());
+
+  typedef ConstShapedNeighborhoodIterator< TInputImage >    InputNeighborhoodIteratorType;
+  typedef ConstShapedNeighborhoodIterator< LabelImageType > LabelNeighborhoodIteratorType;
+
+  SizeType kernelRadius;
+  kernelRadius.Fill(1);
+
+  InputNeighborhoodIteratorType init(kernelRadius, input, sliceRegion);
+  LabelNeighborhoodIteratorType lnit(kernelRadius, m_LabelImage, sliceRegion);
+  lnit.OverrideBoundaryCondition(&BC);
+  for ( typename OffsetVectorType::const_iterator oIt = m_PreviousOffsets.begin();
+        oIt != m_PreviousOffsets.end(); ++oIt )
+    {
+    if ( ( *oIt )[m_SplitAxis] < 0 )
+      {
+      init.ActivateOffset(*oIt);
+      lnit.ActivateOffset(*oIt);
+      }
+    }
+
+  const LabelType firstLabel = m_FirstBlockLabels[blockId];
+  const LabelType firstNeighborLabel = m_FirstBlockLabels[blockId - 1];
+
+  ImageRegionConstIterator< InputImageType > it(input, sliceRegion);
+  ImageRegionConstIterator< LabelImageType > lit(m_LabelImage, sliceRegion);
+  while ( !lit.IsAtEnd() )
+    {
+    const LabelType label = lit.Get();
+    if ( label != NumericTraits< LabelType >::ZeroValue() )
+      {
+      const InputPixelType value = it.Get();
+      typename InputNeighborhoodIteratorType::ConstIterator isIt = init.Begin();
+      typename LabelNeighborhoodIteratorType::ConstIterator lsIt = lnit.Begin();
+      for (; !lsIt.IsAtEnd(); ++isIt, ++lsIt )
+        {
+        const LabelType neighborLabel = lsIt.Get();
+        if ( neighborLabel != NumericTraits< LabelType >::ZeroValue() && m_Functor( value, isIt.Get() ) )
+          {
+          m_Equivalences.LinkLabels(firstNeighborLabel + neighborLabel - 1, firstLabel + label - 1);
+          }
+        }
+      }
+    ++init;
+    ++lnit;
+    ++it;
+    ++lit;
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunctor, typename TMaskImage >
+void
+ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
+::WriteBlock(const RegionType & region, ThreadIdType blockId)
+{
+  const LabelType firstLabel = m_FirstBlockLabels[blockId];
 
-  // Flatten the equavalency table
-  eqTable->Flatten();
+  ProgressReporter progress(this, blockId, region.GetNumberOfPixels(), 100, 0.5f, 0.5f);
 
-  // remap the labels
-  oit.GoToBegin();
+  ImageRegionConstIterator< LabelImageType > lit(m_LabelImage, region);
+  ImageRegionIterator< OutputImageType >     oit(this->GetOutput(), region);
   while ( !oit.IsAtEnd() )
     {
-    label = oit.Get();
-    // if pixel has a label, write out the final equivalence
-    if ( label != NumericTraits< OutputPixelType >::ZeroValue() )
+    const LabelType label = lit.Get();
+    if ( label == NumericTraits< LabelType >::ZeroValue() )
       {
-      oit.Set( eqTable->Lookup(label) );
+      oit.Set( NumericTraits< OutputPixelType >::ZeroValue() );
       }
+    else
+      {
+      oit.Set( m_FinalLabels[m_Equivalences.GetParent(firstLabel + label - 1)] );
+      }
+    ++lit;
     ++oit;
     progress.CompletedPixel();
     }
 }
+
+template< typename TInputImage, typename TOutputImage, typename TFunctor, typename TMaskImage >
+typename ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >::LabelType
+ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
+::LookupBlockLabel(EquivalencesType & equivalences, LabelType label)
+{
+  while ( equivalences[label] != label )
+    {
+    equivalences[label] = equivalences[equivalences[label]];
+    label = equivalences[label];
+    }
+  return label;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunctor, typename TMaskImage >
+void
+ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
+::LinkBlockLabels(EquivalencesType & equivalences, LabelType label1, LabelType label2)
+{
+  // the root of a set is its smallest label, like in the global structure
+  label1 = LookupBlockLabel(equivalences, label1);
+  label2 = LookupBlockLabel(equivalences, label2);
+  if ( label1 < label2 )
+    {
+    equivalences[label2] = label1;
+    }
+  else
+    {
+    equivalences[label1] = label2;
+    }
+}
 } // end namespace itk
 
 #endif
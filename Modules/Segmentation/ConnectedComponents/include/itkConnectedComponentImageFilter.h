@@ -24,6 +24,7 @@
 #include <map>
 #include "itkProgressReporter.h"
 #include "itkBarrier.h"
+#include "itkConcurrentUnionFind.h"
 
 namespace itk
 {
@@ -45,9 +46,14 @@ namespace itk
  *
  * After the filter is executed, ObjectCount holds the number of connected components.
  *
+ * Each thread encodes and labels the runs of a block of lines, and merges
+ * the runs of its lines with the runs of the previous lines, including the
+ * last lines of the previous block, in a union-find structure shared
+ * without locks (see ConcurrentUnionFind). Each thread then makes its
+ * labels consecutive and writes its block.
+ *
  * \sa ImageToImageFilter
  *
- * \ingroup SingleThreaded
  * \ingroup ITKConnectedComponents
  *
  * \wiki
@@ -223,23 +229,10 @@ public:
   typedef std::vector< typename TInputImage::OffsetValueType > OffsetVec;
 
   // the types to support union-find operations
-  typedef std::vector< LabelType > UnionFindType;
-  UnionFindType m_UnionFind;
-  UnionFindType m_Consecutive;
-
-  // functions to support union-find operations
-  void InitUnion( SizeValueType size )
-  {
-    m_UnionFind = UnionFindType(size + 1);
-  }
-
-  void InsertSet(const LabelType label);
-
-  SizeValueType LookupSet(const LabelType label);
-
-  void LinkLabels(const LabelType lab1, const LabelType lab2);
-
-  SizeValueType CreateConsecutive();
+  typedef ConcurrentUnionFind< LabelType > UnionFindType;
+  typedef std::vector< LabelType >         ConsecutiveVectorType;
+  UnionFindType         m_UnionFind;
+  ConsecutiveVectorType m_Consecutive;
 
   //////////////////
   bool CheckNeighbors(const OutputIndexType & A,
@@ -262,7 +255,7 @@ public:
   }
 
   typename std::vector< IdentifierType > m_NumberOfLabels;
-  typename std::vector< IdentifierType > m_FirstLineIdToJoin;
+  typename std::vector< IdentifierType > m_NumberOfObjects;
 
   typename Barrier::Pointer m_Barrier;
 
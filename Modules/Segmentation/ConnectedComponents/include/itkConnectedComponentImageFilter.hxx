@@ -107,7 +107,8 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   const SizeValueType xsize = output->GetRequestedRegion().GetSize()[0];
   const SizeValueType linecount = pixelcount / xsize;
   m_LineMap.resize(linecount);
-  m_FirstLineIdToJoin.resize(nbOfThreads - 1);
+  m_NumberOfObjects.clear();
+  m_NumberOfObjects.resize(nbOfThreads, 0);
 }
 
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
@@ -202,31 +203,40 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   // wait for the other threads to complete that part
   this->Wait();
 
-  // compute the total number of labels
+  // compute the total number of labels, and the first label of that thread
   nbOfLabels = 0;
+  LabelType firstLabelForThread = 1;
   for ( ThreadIdType i = 0; i < nbOfThreads; i++ )
     {
+    if ( i < threadId )
+      {
+      firstLabelForThread += m_NumberOfLabels[i];
+      }
     nbOfLabels += m_NumberOfLabels[i];
     }
+  const LabelType lastLabelForThread = firstLabelForThread + m_NumberOfLabels[threadId];
 
   if ( threadId == 0 )
     {
     // set up the union find structure
-    InitUnion(nbOfLabels);
-    // insert all the labels into the structure -- an extra loop but
-    // saves complicating the ones that come later
-    typename LineMapType::iterator MapBegin = m_LineMap.begin();
-    typename LineMapType::iterator MapEnd = m_LineMap.end();
-    typename LineMapType::iterator LineIt = MapBegin;
-    SizeValueType label = 1;
-    for ( LineIt = MapBegin; LineIt != MapEnd; ++LineIt )
+    m_UnionFind.SetSize(nbOfLabels + 1);
+    m_UnionFind.InsertSet(0);
+    m_Consecutive = ConsecutiveVectorType(nbOfLabels + 1);
+    }
+
+  // wait for the other threads to complete that part
+  this->Wait();
+
+  // insert the labels of the runs of that thread into the structure
+  const LineIdType lastLineIdForThread = firstLineIdForThread + linecountForThread;
+  LabelType        label = firstLabelForThread;
+  for ( LineIdType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ++ThisIdx )
+    {
+    for ( typename lineEncoding::iterator cIt = m_LineMap[ThisIdx].begin(); cIt != m_LineMap[ThisIdx].end(); ++cIt )
       {
-      for ( typename lineEncoding::iterator cIt = LineIt->begin(); cIt != LineIt->end(); ++cIt )
-        {
-        cIt->label = label;
-        InsertSet(label);
-        label++;
-        }
+      cIt->label = label;
+      m_UnionFind.InsertSet(label);
+      label++;
       }
     }
 
@@ -234,28 +244,13 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   this->Wait();
 
   // now process the map and make appropriate entries in an equivalence
-  // table
-  // itkAssertInDebugAndIgnoreInReleaseMacro( linecount == m_LineMap.size() );
+  // table. The neighbor lines of the first lines of the thread belong to
+  // the previous thread: the threads link their labels concurrently.
   const SizeValueType pixelcount = output->GetRequestedRegion().GetNumberOfPixels();
   const SizeValueType xsize = output->GetRequestedRegion().GetSize()[0];
   const SizeValueType linecount = pixelcount / xsize;
 
-  SizeValueType lastLineIdForThread =  linecount;
-  SizeValueType nbOfLineIdToJoin = 0;
-  if ( threadId != nbOfThreads - 1 )
-    {
-    outputRegionForThreadSize = outputRegionForThread.GetSize();
-    outputRegionForThreadSize[splitAxis] -= 1;
-    lastLineIdForThread = firstLineIdForThread
-                          + RegionType(outputRegionIdx, outputRegionForThreadSize).GetNumberOfPixels() / xsizeForThread;
-    m_FirstLineIdToJoin[threadId] = lastLineIdForThread;
-    // found the number of line ids to join
-    nbOfLineIdToJoin =
-      RegionType( outputRegionIdx, outputRegionForThread.GetSize() ).GetNumberOfPixels() / xsizeForThread
-      - RegionType(outputRegionIdx, outputRegionForThreadSize).GetNumberOfPixels() / xsizeForThread;
-    }
-
-  for ( SizeValueType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ++ThisIdx )
+  for ( LineIdType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ++ThisIdx )
     {
     if ( !m_LineMap[ThisIdx].empty() )
       {
@@ -282,62 +277,59 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   // wait for the other threads to complete that part
   this->Wait();
 
-  while ( m_FirstLineIdToJoin.size() != 0 )
+  // point the labels of that thread to their roots, and count the roots
+  SizeValueType nbOfObjects = 0;
+  for ( label = firstLabelForThread; label < lastLabelForThread; ++label )
     {
-    if ( threadId * 2 < static_cast<ThreadIdType>( m_FirstLineIdToJoin.size() ) )
+    if ( m_UnionFind.FlattenSet(label) == label )
       {
-      for ( SizeValueType ThisIdx = m_FirstLineIdToJoin[threadId * 2];
-            ThisIdx < m_FirstLineIdToJoin[threadId * 2] + nbOfLineIdToJoin;
-            ++ThisIdx )
-        {
-        if ( !m_LineMap[ThisIdx].empty() )
-          {
-          for ( typename OffsetVec::const_iterator I = LineOffsets.begin();
-                I != LineOffsets.end(); ++I )
-            {
-            const OffsetValueType NeighIdx = ( *I ) + ThisIdx;
-            // check if the neighbor is in the map
-            if ( NeighIdx >= 0 && NeighIdx < static_cast<OffsetValueType>( linecount ) && !m_LineMap[NeighIdx].empty() )
-              {
-              // Now check whether they are really neighbors
-              const bool areNeighbors =
-                CheckNeighbors(m_LineMap[ThisIdx][0].where, m_LineMap[NeighIdx][0].where);
-              if ( areNeighbors )
-                {
-                // Compare the two lines
-                CompareLines(m_LineMap[ThisIdx], m_LineMap[NeighIdx]);
-                }
-              }
-            }
-          }
-        }
+      ++nbOfObjects;
       }
+    }
+  m_NumberOfObjects[threadId] = nbOfObjects;
 
-    this->Wait();
+  // wait for the other threads to complete that part
+  this->Wait();
 
-    if ( threadId == 0 )
+  // give consecutive labels to the roots, in the order of the labels, the
+  // background value being skipped
+  SizeValueType CLab = 0;
+  SizeValueType objectCount = 0;
+  for ( ThreadIdType i = 0; i < nbOfThreads; i++ )
+    {
+    if ( i < threadId )
+      {
+      CLab += m_NumberOfObjects[i];
+      }
+    objectCount += m_NumberOfObjects[i];
+    }
+  if ( CLab >= static_cast< SizeValueType >( m_BackgroundValue ) )
+    {
+    ++CLab;
+    }
+  for ( label = firstLabelForThread; label < lastLabelForThread; ++label )
+    {
+    if ( m_UnionFind.GetParent(label) == label )
       {
-      // remove the region already joined
-      typename std::vector< SizeValueType > newFirstLineIdToJoin;
-      for ( unsigned int i = 1; i < m_FirstLineIdToJoin.size(); i += 2 )
+      if ( CLab == static_cast< SizeValueType >( m_BackgroundValue ) )
         {
-        newFirstLineIdToJoin.push_back(m_FirstLineIdToJoin[i]);
+        ++CLab;
         }
-      m_FirstLineIdToJoin = newFirstLineIdToJoin;
+      m_Consecutive[label] = CLab;
+      ++CLab;
       }
-
-    this->Wait();
     }
 
   if ( threadId == 0 )
     {
-    m_ObjectCount = CreateConsecutive();
+    m_ObjectCount = objectCount;
     }
 
+  // wait for the other threads to complete that part
   this->Wait();
 
   // check for overflow exception here
-  if ( m_ObjectCount > static_cast< SizeValueType >(
+  if ( objectCount > static_cast< SizeValueType >(
          NumericTraits< OutputPixelType >::max() ) )
     {
     if ( threadId == 0 )
@@ -368,17 +360,12 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   ImageRegionIterator< OutputImageType > fend = oit;
   fend.GoToEnd();
 
-  lastLineIdForThread = firstLineIdForThread
-                        + RegionType( outputRegionIdx,
-                                      outputRegionForThread.GetSize() ).GetNumberOfPixels() / xsizeForThread;
-
-  for ( SizeValueType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ThisIdx++ )
+  for ( LineIdType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ThisIdx++ )
     {
     // now fill the labelled sections
     for ( typename lineEncoding::const_iterator cIt = m_LineMap[ThisIdx].begin(); cIt != m_LineMap[ThisIdx].end(); ++cIt )
       {
-      const SizeValueType   Ilab = LookupSet(cIt->label);
-      const OutputPixelType lab = m_Consecutive[Ilab];
+      const OutputPixelType lab = m_Consecutive[m_UnionFind.GetParent(cIt->label)];
       oit.SetIndex(cIt->where);
       // initialize the non labelled pixels
       for (; fstart != oit; ++fstart )
@@ -407,6 +394,9 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 ::AfterThreadedGenerateData()
 {
   m_NumberOfLabels.clear();
+  m_NumberOfObjects.clear();
+  m_UnionFind.SetSize(0);
+  m_Consecutive.clear();
   m_Barrier = ITK_NULLPTR;
   m_LineMap.clear();
   m_Input = ITK_NULLPTR;
@@ -570,7 +560,7 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
         }
       if ( eq )
         {
-        LinkLabels(nIt->label, cIt->label);
+        m_UnionFind.LinkLabels(nIt->label, cIt->label);
         }
 
       if ( ee1 >= cLast )
@@ -584,72 +574,6 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
     }
 }
 
-// union find related functions
-template< typename TInputImage, typename TOutputImage, typename TMaskImage >
-void
-ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::InsertSet(const LabelType label)
-{
-  m_UnionFind[label] = label;
-}
-
-template< typename TInputImage, typename TOutputImage, typename TMaskImage >
-SizeValueType
-ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::CreateConsecutive()
-{
-  m_Consecutive = UnionFindType( m_UnionFind.size() );
-
-  SizeValueType CLab = 0;
-  SizeValueType count = 0;
-  for ( SizeValueType I = 1; I < m_UnionFind.size(); I++ )
-    {
-    SizeValueType L = m_UnionFind[I];
-    if ( L == I )
-      {
-      if ( CLab == static_cast< SizeValueType >( m_BackgroundValue ) )
-        {
-        ++CLab;
-        }
-      m_Consecutive[L] = CLab;
-      ++CLab;
-      ++count;
-      }
-    }
-  return count;
-}
-
-template< typename TInputImage, typename TOutputImage, typename TMaskImage >
-SizeValueType
-ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::LookupSet(const LabelType label)
-{
-  // recursively set the equivalence if necessary
-  if ( label != m_UnionFind[label] )
-    {
-    m_UnionFind[label] = this->LookupSet(m_UnionFind[label]);
-    }
-  return ( m_UnionFind[label] );
-}
-
-template< typename TInputImage, typename TOutputImage, typename TMaskImage >
-void
-ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::LinkLabels(const LabelType lab1, const LabelType lab2)
-{
-  SizeValueType E1 = this->LookupSet(lab1);
-  SizeValueType E2 = this->LookupSet(lab2);
-
-  if ( E1 < E2 )
-    {
-    m_UnionFind[E2] = E1;
-    }
-  else
-    {
-    m_UnionFind[E1] = E2;
-    }
-}
-
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
 void
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
@@ -20,6 +20,8 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "itkImage.h"
+#include "itkMultiThreader.h"
+#include "itksys/hash_map.hxx"
 #include <vector>
 
 namespace itk
@@ -67,9 +69,12 @@ namespace itk
  * controlled via methods in the superclass,
  * InPlaceImageFilter::InPlaceOn() and InPlaceImageFilter::InPlaceOff().
  *
+ * The objects are counted by several threads, each one counting the
+ * pixels of a part of the input, and the threads then relabel their part
+ * of the output.
+ *
  * \sa ConnectedComponentImageFilter, BinaryThresholdImageFilter, ThresholdImageFilter
  *
- * \ingroup SingleThreaded
  * \ingroup ITKConnectedComponents
  *
  * \wiki
@@ -114,6 +119,7 @@ public:
   typedef   typename TInputImage::IndexType   IndexType;
   typedef   typename TInputImage::SizeType    SizeType;
   typedef   typename TOutputImage::RegionType RegionType;
+  typedef   typename TInputImage::RegionType  InputRegionType;
 
   /**
    * Smart pointer typedef support
@@ -256,9 +262,16 @@ protected:
   virtual ~RelabelComponentImageFilter() {}
 
   /**
-   * Standard pipeline method.
+   * Standard pipeline methods.
    */
-  void GenerateData() ITK_OVERRIDE;
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  void ThreadedGenerateData(const RegionType & outputRegionForThread, ThreadIdType threadId) ITK_OVERRIDE;
+
+  void AfterThreadedGenerateData() ITK_OVERRIDE;
+
+  /** Count the pixels of each label in a part of the input. */
+  void ThreadedCountLabels(const InputRegionType & inputRegionForThread, ThreadIdType threadId);
 
   /** RelabelComponentImageFilter needs the entire input. Therefore
    * it must provide an implementation GenerateInputRequestedRegion().
@@ -302,6 +315,17 @@ protected:
     }
   };
 
+  // sort in the order of the original object numbers
+  class RelabelComponentObjectNumberComparator
+  {
+  public:
+    bool operator()(const RelabelComponentObjectType & a,
+                    const RelabelComponentObjectType & b)
+    {
+      return a.m_ObjectNumber < b.m_ObjectNumber;
+    }
+  };
+
 private:
   RelabelComponentImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &); //purposely not implemented
@@ -314,6 +338,15 @@ private:
 
   ObjectSizeInPixelsContainerType         m_SizeOfObjectsInPixels;
   ObjectSizeInPhysicalUnitsContainerType  m_SizeOfObjectsInPhysicalUnits;
+
+  static ITK_THREAD_RETURN_TYPE CountLabelsThreaderCallback(void *arg);
+
+  /** The number of pixels of each label counted by each thread, and the
+   * map of the input labels to the output labels. */
+  typedef itksys::hash_map< LabelType, ObjectSizeType > SizeMapType;
+  typedef itksys::hash_map< LabelType, LabelType >      RelabelMapType;
+  std::vector< SizeMapType > m_SizeMaps;
+  RelabelMapType             m_RelabelMap;
 };
 } // end namespace itk
 
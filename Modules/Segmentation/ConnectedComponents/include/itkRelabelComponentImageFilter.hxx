@@ -22,8 +22,7 @@
 #include "itkImageRegionIterator.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
-#include "itksys/hash_map.hxx"
-#include <map>
+#include <algorithm>
 
 namespace itk
 {
@@ -46,28 +45,12 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
 template< typename TInputImage, typename TOutputImage >
 void
 RelabelComponentImageFilter< TInputImage, TOutputImage >
-::GenerateData()
+::BeforeThreadedGenerateData()
 {
   SizeValueType i;
 
-  // Use a map to keep track of the size of each object.  Object
-  // number -> ObjectType (which has Object number and the two sizes)
-  typedef itksys::hash_map< LabelType, RelabelComponentObjectType > MapType;
-  MapType sizeMap;
-  typename MapType::iterator mapIt;
-  typedef typename MapType::value_type MapValueType;
-
-  // Get the input and the output
+  // Get the input
   typename TInputImage::ConstPointer input = this->GetInput();
-  typename TOutputImage::Pointer output = this->GetOutput();
-
-  // Setup a progress reporter.  We have 2 stages to the algorithm so
-  // use the total number of pixels accessed. We walk the entire input
-  // in the first pass, then walk just the output requested region in
-  // the second pass.
-  ProgressReporter progress( this, 0,
-                             input->GetRequestedRegion().GetNumberOfPixels()
-                             + output->GetRequestedRegion().GetNumberOfPixels() );
 
   // Calculate the size of pixel
   float physicalPixelSize = 1.0;
@@ -76,45 +59,26 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     physicalPixelSize *= input->GetSpacing()[i];
     }
 
-  RelabelComponentObjectType initialSize;
-  initialSize.m_SizeInPixels = 1;
-  initialSize.m_SizeInPhysicalUnits = physicalPixelSize;
-
   // First pass: walk the entire input image and determine what
-  // labels are used and the number of pixels used in each label.
-  //
-
-  // walk the input
-  ImageRegionConstIterator< InputImageType > it( input, input->GetRequestedRegion() );
-  it.GoToBegin();
-
-  while ( !it.IsAtEnd() )
+  // labels are used and the number of pixels used in each label. Each
+  // thread counts the pixels of a part of the input in its own map.
+  MultiThreader *multithreader = this->GetMultiThreader();
+  multithreader->SetNumberOfThreads( this->GetNumberOfThreads() );
+  multithreader->SetSingleMethod(Self::CountLabelsThreaderCallback, this);
+  m_SizeMaps.clear();
+  m_SizeMaps.resize( multithreader->GetNumberOfThreads() );
+  multithreader->SingleMethodExecute();
+
+  // merge the maps of the threads
+  SizeMapType & sizeMap = m_SizeMaps[0];
+  typename SizeMapType::const_iterator mapIt;
+  for ( i = 1; i < m_SizeMaps.size(); ++i )
     {
-    // Get the input pixel value
-    const LabelType inputValue = static_cast< LabelType >( it.Get() );
-
-    // if the input pixel is not the background
-    if ( inputValue != NumericTraits< LabelType >::ZeroValue() )
+    for ( mapIt = m_SizeMaps[i].begin(); mapIt != m_SizeMaps[i].end(); ++mapIt )
       {
-      // Does this label already exist
-      mapIt = sizeMap.find(inputValue);
-      if ( mapIt == sizeMap.end() )
-        {
-        // label is not currently in the map
-        initialSize.m_ObjectNumber = inputValue;
-        sizeMap.insert( MapValueType(inputValue, initialSize) );
-        }
-      else
-        {
-        // label is already in the map, update the values
-        ( *mapIt ).second.m_SizeInPixels++;
-        ( *mapIt ).second.m_SizeInPhysicalUnits += physicalPixelSize;
-        }
+      sizeMap[( *mapIt ).first] += ( *mapIt ).second;
       }
-
-    // increment the iterators
-    ++it;
-    progress.CompletedPixel();
+    m_SizeMaps[i].clear();
     }
 
   // Now we need to reorder the labels. Use the m_ObjectSortingOrder
@@ -125,24 +89,35 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
   VectorType sizeVector;
   typename VectorType::iterator vit;
 
-  typedef std::map< LabelType, LabelType >    RelabelMapType;
   typedef typename RelabelMapType::value_type RelabelMapValueType;
-  RelabelMapType relabelMap;
+  m_RelabelMap.clear();
 
   // copy the original object map to a vector so we can sort it
+  sizeVector.reserve( sizeMap.size() );
   for ( mapIt = sizeMap.begin(); mapIt != sizeMap.end(); ++mapIt )
     {
-    sizeVector.push_back( ( *mapIt ).second );
+    RelabelComponentObjectType object;
+    object.m_ObjectNumber = ( *mapIt ).first;
+    object.m_SizeInPixels = ( *mapIt ).second;
+    object.m_SizeInPhysicalUnits = ( *mapIt ).second * physicalPixelSize;
+    sizeVector.push_back(object);
     }
+  m_SizeMaps.clear();
 
   // Sort the objects by size by default, unless m_SortByObjectSize
-  // is set to false.
+  // is set to false, in which case the initial order is kept.
   if ( m_SortByObjectSize )
     {
     std::sort(  sizeVector.begin(),
                 sizeVector.end(),
                 RelabelComponentSizeInPixelsComparator() );
     }
+  else
+    {
+    std::sort(  sizeVector.begin(),
+                sizeVector.end(),
+                RelabelComponentObjectNumberComparator() );
+    }
 
   // create a lookup table to map the input label to the output label.
   // cache the object sizes for later access by the user
@@ -161,13 +136,13 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
       {
       // map small objects to the background
       NumberOfObjectsRemoved++;
-      relabelMap.insert( RelabelMapValueType( ( *vit ).m_ObjectNumber, 0 ) );
+      m_RelabelMap.insert( RelabelMapValueType( ( *vit ).m_ObjectNumber, 0 ) );
       }
     else
       {
       // map for input labels to output labels (Note we use i+1 in the
       // map since index 0 is the background)
-      relabelMap.insert( RelabelMapValueType( ( *vit ).m_ObjectNumber, i + 1 ) );
+      m_RelabelMap.insert( RelabelMapValueType( ( *vit ).m_ObjectNumber, i + 1 ) );
 
       // cache object sizes for later access by the user
       m_SizeOfObjectsInPixels[i] = ( *vit ).m_SizeInPixels;
@@ -183,25 +158,66 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     m_SizeOfObjectsInPixels.resize(m_NumberOfObjects);
     m_SizeOfObjectsInPhysicalUnits.resize(m_NumberOfObjects);
     }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+RelabelComponentImageFilter< TInputImage, TOutputImage >
+::ThreadedCountLabels(const InputRegionType & inputRegionForThread, ThreadIdType threadId)
+{
+  SizeMapType & sizeMap = m_SizeMaps[threadId];
+
+  // Setup a progress reporter.  We have 2 stages to the algorithm: we
+  // walk the entire input in the first pass, then walk just the output
+  // requested region in the second pass.
+  ProgressReporter progress(this, threadId, inputRegionForThread.GetNumberOfPixels(), 100, 0.0f, 0.5f);
+
+  // the labels of the neighbor pixels are often the same, so the last
+  // label found in the map is kept
+  LabelType                      previousValue = NumericTraits< LabelType >::ZeroValue();
+  typename SizeMapType::iterator previousIt = sizeMap.end();
 
+  ImageRegionConstIterator< InputImageType > it(this->GetInput(), inputRegionForThread);
+  while ( !it.IsAtEnd() )
+    {
+    // Get the input pixel value
+    const LabelType inputValue = static_cast< LabelType >( it.Get() );
+
+    // if the input pixel is not the background
+    if ( inputValue != NumericTraits< LabelType >::ZeroValue() )
+      {
+      if ( inputValue != previousValue )
+        {
+        previousIt = sizeMap.insert( typename SizeMapType::value_type(inputValue, 0) ).first;
+        previousValue = inputValue;
+        }
+      ++( *previousIt ).second;
+      }
+
+    // increment the iterators
+    ++it;
+    progress.CompletedPixel();
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+RelabelComponentImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const RegionType & outputRegionForThread, ThreadIdType threadId)
+{
   // Second pass: walk just the output requested region and relabel
   // the necessary pixels.
   //
-
-  // Allocate the output
-  this->AllocateOutputs();
+  ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels(), 100, 0.5f, 0.5f);
 
   // Remap the labels.  Note we only walk the region of the output
   // that was requested.  This may be a subset of the input image.
-  OutputPixelType                        outputValue;
-  ImageRegionIterator< OutputImageType > oit;
-  oit = ImageRegionIterator< OutputImageType >( output,
-                                                output->GetRequestedRegion() );
-  it = ImageRegionConstIterator< InputImageType >( input,
-                                                   output->GetRequestedRegion() );
-
-  it.GoToBegin();
-  oit.GoToBegin();
+  const RelabelMapType & relabelMap = m_RelabelMap;
+  LabelType              previousValue = NumericTraits< LabelType >::ZeroValue();
+  OutputPixelType        outputValue = NumericTraits< OutputPixelType >::ZeroValue();
+
+  ImageRegionIterator< OutputImageType >     oit(this->GetOutput(), outputRegionForThread);
+  ImageRegionConstIterator< InputImageType > it(this->GetInput(), outputRegionForThread);
   while ( !oit.IsAtEnd() )
     {
     const LabelType inputValue = static_cast< LabelType >( it.Get() );
@@ -209,12 +225,16 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     if ( inputValue != NumericTraits< LabelType >::ZeroValue() )
       {
       // lookup the mapped label
-      outputValue = static_cast< OutputPixelType >( relabelMap[inputValue] );
+      if ( inputValue != previousValue )
+        {
+        outputValue = static_cast< OutputPixelType >( ( *relabelMap.find(inputValue) ).second );
+        previousValue = inputValue;
+        }
       oit.Set(outputValue);
       }
     else
       {
-      oit.Set(inputValue);
+      oit.Set( static_cast< OutputPixelType >( inputValue ) );
       }
 
     // increment the iterators
@@ -224,6 +244,33 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     }
 }
 
+template< typename TInputImage, typename TOutputImage >
+void
+RelabelComponentImageFilter< TInputImage, TOutputImage >
+::AfterThreadedGenerateData()
+{
+  m_RelabelMap.clear();
+}
+
+template< typename TInputImage, typename TOutputImage >
+ITK_THREAD_RETURN_TYPE
+RelabelComponentImageFilter< TInputImage, TOutputImage >
+::CountLabelsThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self *                           self = static_cast< Self * >( info->UserData );
+
+  // split the whole input, which may be larger than the output
+  InputRegionType    inputRegionForThread = self->GetInput()->GetRequestedRegion();
+  const ThreadIdType total =
+    self->GetImageRegionSplitter()->GetSplit(info->ThreadID, info->NumberOfThreads, inputRegionForThread);
+  if ( info->ThreadID < total )
+    {
+    self->ThreadedCountLabels(inputRegionForThread, info->ThreadID);
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< typename TInputImage, typename TOutputImage >
 void
 RelabelComponentImageFilter< TInputImage, TOutputImage >
@@ -0,0 +1,195 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkConnectedComponentImageFilter.h"
+#include "itkScalarConnectedComponentImageFilter.h"
+#include "itkRelabelComponentImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Label a volume with many objects crossing the blocks of the threads, with
+ * one thread and with several threads, and check that the labels are the
+ * same, and that they are consecutive in raster order.
+ */
+
+namespace
+{
+const unsigned int Dimension = 3;
+typedef itk::Image< unsigned char, Dimension >  InputImageType;
+typedef itk::Image< unsigned int, Dimension >   LabelImageType;
+
+bool ConnectedComponentImageFilterMultiThreadedTestCompare( const LabelImageType * labels1,
+                                                            const LabelImageType * labels2,
+                                                            const char * name )
+{
+  itk::ImageRegionConstIterator< LabelImageType > it1( labels1, labels1->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< LabelImageType > it2( labels2, labels2->GetLargestPossibleRegion() );
+  for(; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    if( it1.Get() != it2.Get() )
+      {
+      std::cerr << name << ": the labels differ with several threads" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+// the first pixel of each object in raster order has the next label
+bool ConnectedComponentImageFilterMultiThreadedTestRasterOrder( const LabelImageType * labels,
+                                                                const char * name )
+{
+  LabelImageType::PixelType maxLabel = 0;
+  itk::ImageRegionConstIterator< LabelImageType > it( labels, labels->GetLargestPossibleRegion() );
+  for(; !it.IsAtEnd(); ++it )
+    {
+    if( it.Get() > maxLabel )
+      {
+      if( it.Get() != maxLabel + 1 )
+        {
+        std::cerr << name << ": the labels are not consecutive in raster order" << std::endl;
+        return false;
+        }
+      ++maxLabel;
+      }
+    }
+  return true;
+}
+}
+
+int itkConnectedComponentImageFilterMultiThreadedTest( int, char *[] )
+{
+  // a volume of thin, oblique sheets, with holes, so that most objects
+  // are labeled by several threads
+  InputImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 30;
+  size[2] = 50;
+  InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  InputImageType::Pointer mask = InputImageType::New();
+  mask->SetRegions( size );
+  mask->Allocate();
+  itk::ImageRegionIteratorWithIndex< InputImageType > it( image, image->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator< InputImageType >          mit( mask, mask->GetLargestPossibleRegion() );
+  for(; !it.IsAtEnd(); ++it, ++mit )
+    {
+    const InputImageType::IndexType index = it.GetIndex();
+    const unsigned int              hash = ( index[0] * 7 + index[1] * 13 + index[2] * 29 ) % 17;
+    it.Set( ( index[0] + 2 * index[2] ) % 9 < 2 && hash != 0 ? 1 + hash % 3 : 0 );
+    mit.Set( ( index[0] * index[1] + index[2] ) % 23 != 0 );
+    }
+
+  const itk::ThreadIdType numbersOfThreads[2] = { 1, 5 };
+
+  // connected components of the binary image
+  typedef itk::ConnectedComponentImageFilter< InputImageType, LabelImageType > ConnectedComponentFilterType;
+  LabelImageType::Pointer   connectedComponents[2];
+  itk::SizeValueType        objectCounts[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    ConnectedComponentFilterType::Pointer filter = ConnectedComponentFilterType::New();
+    filter->SetInput( image );
+    filter->SetFullyConnected( i == 1 );
+    filter->SetNumberOfThreads( numbersOfThreads[i] );
+    filter->Update();
+    objectCounts[i] = filter->GetObjectCount();
+
+    ConnectedComponentFilterType::Pointer filter1 = ConnectedComponentFilterType::New();
+    filter1->SetInput( image );
+    filter1->SetFullyConnected( i == 1 );
+    filter1->SetNumberOfThreads( 1 );
+    filter1->Update();
+    if( filter1->GetObjectCount() != objectCounts[i] ||
+        !ConnectedComponentImageFilterMultiThreadedTestCompare( filter1->GetOutput(), filter->GetOutput(),
+                                                                "ConnectedComponentImageFilter" ) ||
+        !ConnectedComponentImageFilterMultiThreadedTestRasterOrder( filter->GetOutput(),
+                                                                    "ConnectedComponentImageFilter" ) )
+      {
+      return EXIT_FAILURE;
+      }
+    connectedComponents[i] = filter->GetOutput();
+    std::cout << "ConnectedComponentImageFilter: " << objectCounts[i] << " objects" << std::endl;
+    }
+
+  // connected components of the similar pixels under the mask
+  typedef itk::ScalarConnectedComponentImageFilter< InputImageType, LabelImageType > ScalarFilterType;
+  LabelImageType::Pointer scalarComponents[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    ScalarFilterType::Pointer filter = ScalarFilterType::New();
+    filter->SetInput( image );
+    filter->SetMaskImage( mask );
+    filter->SetDistanceThreshold( 1 );
+    filter->SetFullyConnected( true );
+    filter->SetNumberOfThreads( numbersOfThreads[i] );
+    filter->Update();
+    scalarComponents[i] = filter->GetOutput();
+    scalarComponents[i]->DisconnectPipeline();
+    if( !ConnectedComponentImageFilterMultiThreadedTestRasterOrder( scalarComponents[i],
+                                                                    "ScalarConnectedComponentImageFilter" ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  if( !ConnectedComponentImageFilterMultiThreadedTestCompare( scalarComponents[0], scalarComponents[1],
+                                                              "ScalarConnectedComponentImageFilter" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // relabel the components by size
+  typedef itk::RelabelComponentImageFilter< LabelImageType, LabelImageType > RelabelFilterType;
+  LabelImageType::Pointer relabeled[2];
+  itk::SizeValueType      numberOfObjects[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    RelabelFilterType::Pointer relabel = RelabelFilterType::New();
+    relabel->SetInput( connectedComponents[0] );
+    relabel->SetMinimumObjectSize( 3 );
+    relabel->SetNumberOfThreads( numbersOfThreads[i] );
+    relabel->Update();
+    relabeled[i] = relabel->GetOutput();
+    numberOfObjects[i] = relabel->GetNumberOfObjects();
+    if( relabel->GetOriginalNumberOfObjects() != objectCounts[0] )
+      {
+      std::cerr << "RelabelComponentImageFilter: wrong original number of objects "
+                << relabel->GetOriginalNumberOfObjects() << std::endl;
+      return EXIT_FAILURE;
+      }
+    for( itk::SizeValueType n = 1; n < numberOfObjects[i]; ++n )
+      {
+      if( relabel->GetSizeOfObjectsInPixels()[n] > relabel->GetSizeOfObjectsInPixels()[n - 1] )
+        {
+        std::cerr << "RelabelComponentImageFilter: the objects are not sorted by size" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  std::cout << "RelabelComponentImageFilter: " << numberOfObjects[1] << " objects" << std::endl;
+  if( numberOfObjects[0] != numberOfObjects[1] ||
+      !ConnectedComponentImageFilterMultiThreadedTestCompare( relabeled[0], relabeled[1],
+                                                              "RelabelComponentImageFilter" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@
 #define itkBinaryMedianImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include "itkMath.h"
 
 namespace itk
 {
@@ -34,6 +35,10 @@ namespace itk
  * For the case of binary images the median can be obtained by simply counting
  * the neighbors that are foreground.
  *
+ * The count is updated while the neighborhood is moved over the image
+ * (see MovingBoxNeighborhood), so only the pixels entering and leaving the
+ * neighborhood are read at each step.
+ *
  * A median filter is one of the family of nonlinear filters.  It is
  * used to smooth an image without being biased by outliers or shot noise.
  *
@@ -141,6 +146,45 @@ private:
   BinaryMedianImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);          //purposely not implemented
 
+  /** \class ForegroundCounter
+   * Counts the foreground pixels of the neighborhood moved by
+   * MovingBoxNeighborhood.
+   * \ingroup ITKLabelVoting
+   */
+  class ForegroundCounter
+  {
+  public:
+    ForegroundCounter(const InputPixelType & foreground):
+      m_Foreground(foreground),
+      m_Count(0)
+    {}
+
+    void AddPixel(const InputPixelType & p)
+    {
+      if ( Math::ExactlyEquals(p, m_Foreground) )
+        {
+        ++m_Count;
+        }
+    }
+
+    void RemovePixel(const InputPixelType & p)
+    {
+      if ( Math::ExactlyEquals(p, m_Foreground) )
+        {
+        --m_Count;
+        }
+    }
+
+    SizeValueType GetCount() const
+    {
+      return m_Count;
+    }
+
+  private:
+    InputPixelType m_Foreground;
+    SizeValueType  m_Count;
+  };
+
   InputSizeType m_Radius;
 
   InputPixelType m_ForegroundValue;
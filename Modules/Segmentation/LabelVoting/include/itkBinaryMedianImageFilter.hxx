@@ -19,17 +19,9 @@
 #define itkBinaryMedianImageFilter_hxx
 #include "itkBinaryMedianImageFilter.h"
 
-#include "itkConstNeighborhoodIterator.h"
-#include "itkNeighborhoodInnerProduct.h"
-#include "itkImageRegionIterator.h"
-#include "itkNeighborhoodAlgorithm.h"
-#include "itkOffset.h"
+#include "itkMovingBoxNeighborhood.h"
 #include "itkProgressReporter.h"
 
-#include <vector>
-#include <algorithm>
-#include "itkMath.h"
-
 namespace itk
 {
 template< typename TInputImage, typename TOutputImage >
@@ -96,67 +88,40 @@ BinaryMedianImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        ThreadIdType threadId)
 {
-  ZeroFluxNeumannBoundaryCondition< InputImageType > nbc;
-
-  ConstNeighborhoodIterator< InputImageType > bit;
-  ImageRegionIterator< OutputImageType >      it;
-
   // Allocate output
   typename OutputImageType::Pointer output = this->GetOutput();
   typename InputImageType::ConstPointer input  = this->GetInput();
 
-  // Find the data-set boundary "faces"
-  typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType >::FaceListType faceList;
-  NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType > bC;
-  faceList = bC(input, outputRegionForThread, m_Radius);
-
-  typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< InputImageType >::FaceListType::iterator fit;
-
   ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
 
-  // Process each of the boundary faces.  These are N-d regions which border
-  // the edge of the buffer.
-  for ( fit = faceList.begin(); fit != faceList.end(); ++fit )
+  // All of our neighborhoods have an odd number of pixels, so there is
+  // always a median index (if there where an even number of pixels
+  // in the neighborhood we have to average the middle two values).
+  SizeValueType neighborhoodSize = 1;
+  for ( unsigned int i = 0; i < InputImageDimension; i++ )
     {
-    bit = ConstNeighborhoodIterator< InputImageType >(m_Radius, input, *fit);
-    it  = ImageRegionIterator< OutputImageType >(output, *fit);
-    bit.OverrideBoundaryCondition(&nbc);
-    bit.GoToBegin();
-
-    unsigned int neighborhoodSize = bit.Size();
-
-    // All of our neighborhoods have an odd number of pixels, so there is
-    // always a median index (if there where an even number of pixels
-    // in the neighborhood we have to average the middle two values).
-    unsigned int medianPosition = neighborhoodSize / 2;
-
-    while ( !bit.IsAtEnd() )
+    neighborhoodSize *= 2 * m_Radius[i] + 1;
+    }
+  const SizeValueType medianPosition = neighborhoodSize / 2;
+
+  // the pixels outside the image are replaced by the nearest pixel in
+  // the image, as with a ZeroFluxNeumannBoundaryCondition
+  ForegroundCounter counter(m_ForegroundValue);
+  MovingBoxNeighborhood< InputImageType > box(input, m_Radius, outputRegionForThread);
+  box.Initialize(counter);
+  do
+    {
+    if ( counter.GetCount() > medianPosition )
+      {
+      output->SetPixel( box.GetIndex(), static_cast< OutputPixelType >( m_ForegroundValue ) );
+      }
+    else
       {
-      // count the pixels in the neighborhood
-      unsigned int count = 0;
-      for ( unsigned int i = 0; i < neighborhoodSize; ++i )
-        {
-        InputPixelType value = bit.GetPixel(i);
-        if ( Math::ExactlyEquals(value, m_ForegroundValue) )
-          {
-          count++;
-          }
-        }
-
-      if ( count > medianPosition )
-        {
-        it.Set( static_cast< OutputPixelType >( m_ForegroundValue ) );
-        }
-      else
-        {
-        it.Set( static_cast< OutputPixelType >( m_BackgroundValue ) );
-        }
-
-      ++bit;
-      ++it;
-      progress.CompletedPixel();
+      output->SetPixel( box.GetIndex(), static_cast< OutputPixelType >( m_BackgroundValue ) );
       }
+    progress.CompletedPixel();
     }
+  while ( box.Next(counter) );
 }
 
 /**
@@ -482,7 +482,8 @@ protected:
   /** This performs the initial load distribution among the threads.  Every
    *  thread gets a slab of the data to work on. The slabs created along a specific
    *  dimension.  Load balancing is performed along the greatest numbered dimension
-   *  (i.e. the 3rd dimension in the 3D case and the 2nd dimension in the 2D case).
+   *  (i.e. the 3rd dimension in the 3D case and the 2nd dimension in the 2D case),
+   *  unless SelectSplitAxis() chose another one.
    *  During the initializing of the sparse field layer an histogram is computed
    *  that stores the number of nodes in the active set for each index along the
    *  chosen dimension.  This histogram is used to divide the work "equally" among
@@ -490,6 +491,13 @@ protected:
    *  process. */
   void ComputeInitialThreadBoundaries();
 
+  /** Splits the load along another dimension than the greatest numbered one
+   *  when the active set lies in too few of its slices for the threads to get
+   *  equal shares, e.g. a flat front, and another dimension spreads it
+   *  better.  The dimension whose largest slice holds the fewest nodes of the
+   *  active set is then chosen, and the histogram is computed along it. */
+  void SelectSplitAxis();
+
   /** Find the thread to which a pixel belongs  */
   unsigned int GetThreadNumber(unsigned int splitAxisValue);
 
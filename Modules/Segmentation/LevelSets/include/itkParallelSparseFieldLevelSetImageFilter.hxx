@@ -324,6 +324,10 @@ ParallelSparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
 
   m_NumOfThreads = this->GetNumberOfThreads();
 
+  // Change the dimension along which the load is distributed if the front
+  // lies in too few slices of the greatest numbered one
+  this->SelectSplitAxis();
+
   // Cumulative frequency of number of pixels in each Z plane for the entire 3D
   // volume
   m_ZCumulativeFrequency = new int[m_ZSize];
@@ -358,6 +362,74 @@ ParallelSparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
   m_Data = new ThreadData[m_NumOfThreads];
 }
 
+template< typename TInputImage, typename TOutputImage >
+void
+ParallelSparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::SelectSplitAxis()
+{
+  typename OutputImageType::SizeType requestedRegionSize =
+    m_OutputImage->GetRequestedRegion().GetSize();
+  unsigned int i, j;
+
+  // Histogram of the active set along each dimension, indexed as the
+  // global histogram is
+  std::vector< std::vector< int > > histograms(ImageDimension);
+  for ( i = 0; i < ImageDimension; i++ )
+    {
+    histograms[i].resize(requestedRegionSize[i], 0);
+    }
+  typename LayerType::ConstIterator layerIt;
+  for ( layerIt = m_Layers[0]->Begin(); layerIt != m_Layers[0]->End(); ++layerIt )
+    {
+    for ( i = 0; i < ImageDimension; i++ )
+      {
+      histograms[i][layerIt->m_Index[i]]++;
+      }
+    }
+
+  // The largest number of active nodes in a slice of each dimension
+  std::vector< int > largestSlices(ImageDimension, 0);
+  for ( i = 0; i < ImageDimension; i++ )
+    {
+    for ( j = 0; j < requestedRegionSize[i]; j++ )
+      {
+      largestSlices[i] = vnl_math_max(largestSlices[i], histograms[i][j]);
+      }
+    }
+
+  // Keep the greatest numbered dimension as long as every thread can get an
+  // equal share of the active set
+  const SizeValueType numberOfActiveNodes = m_Layers[0]->Size();
+  if ( static_cast< SizeValueType >( largestSlices[m_SplitAxis] ) * m_NumOfThreads <= numberOfActiveNodes )
+    {
+    return;
+    }
+
+  unsigned int splitAxis = m_SplitAxis;
+  for ( i = 0; i < ImageDimension; i++ )
+    {
+    if ( largestSlices[i] < largestSlices[splitAxis] )
+      {
+      splitAxis = i;
+      }
+    }
+  if ( splitAxis == m_SplitAxis )
+    {
+    return;
+    }
+
+  itkDebugMacro("Distributing the load along dimension " << splitAxis);
+  m_SplitAxis = splitAxis;
+  m_ZSize = requestedRegionSize[m_SplitAxis];
+
+  delete[] m_GlobalZHistogram;
+  m_GlobalZHistogram = new int[m_ZSize];
+  for ( i = 0; i < m_ZSize; i++ )
+    {
+    m_GlobalZHistogram[i] = histograms[m_SplitAxis][i];
+    }
+}
+
 template< typename TInputImage, typename TOutputImage >
 void
 ParallelSparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
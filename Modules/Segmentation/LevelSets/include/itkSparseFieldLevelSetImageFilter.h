@@ -20,6 +20,7 @@
 
 #include "itkFiniteDifferenceImageFilter.h"
 #include "itkMultiThreader.h"
+#include "itkAtomicInt.h"
 #include "itkSparseFieldLayer.h"
 #include "itkObjectStore.h"
 #include <vector>
@@ -312,6 +313,22 @@ public:
   void InterpolateSurfaceLocationOff()
   { this->SetInterpolateSurfaceLocation(false); }
 
+  /** Get/Set whether the changes of the active layer are calculated by
+      several threads.  The active layer is then split into the blocks of the
+      image holding some of its nodes, and each thread takes the next active
+      block until none is left, so that the threads stay busy wherever the
+      front lies.  The difference function must be safe to call from several
+      threads.  The time step is the smallest of the time steps of the
+      blocks, which does not depend on the threads.  Turned off by default. */
+  itkSetMacro(UseActiveBlockThreading, bool);
+  itkGetConstMacro(UseActiveBlockThreading, bool);
+  itkBooleanMacro(UseActiveBlockThreading);
+
+  /** Get/Set the size of the active blocks along each dimension. Defaults
+      to 16. */
+  itkSetClampMacro(ActiveBlockSize, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(ActiveBlockSize, unsigned int);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   // Begin concept checking
   itkConceptMacro( OutputEqualityComparableCheck,
@@ -370,6 +387,19 @@ protected:
    *  indices to be applied in the current iteration. */
   TimeStepType CalculateChange() ITK_OVERRIDE;
 
+  /** Calculates the change at an active node, whose neighborhood is given by
+   *  the iterator. */
+  ValueType CalculateActiveNodeChange(NeighborhoodIterator< OutputImageType > & outputIt,
+                                      void *globalData, const ValueType & minNorm);
+
+  /** Sorts the nodes of the active layer by the block of the image holding
+   *  them, and lists the active blocks. */
+  void ConstructActiveBlocks();
+
+  /** Calculates the changes at the nodes of the active blocks taken by one
+   *  thread, until no block is left. */
+  void ThreadedCalculateActiveBlockChanges(const ValueType & minNorm);
+
   /** Initializes a layer of the sparse field using a previously initialized
    * layer. Builds the list of nodes in m_Layer[to] using m_Layer[from].
    * Marks values in the m_StatusImage. */
@@ -494,10 +524,34 @@ protected:
   const InputImageType *m_InputImage;
   OutputImageType      *m_OutputImage;
 
+  /** Whether the changes are calculated by several threads, and the size of
+      the blocks they take. */
+  bool         m_UseActiveBlockThreading;
+  unsigned int m_ActiveBlockSize;
+
+  /** The indices of the active nodes sorted by block, with their positions
+      in the active layer, and the start of each active block in them. */
+  std::vector< std::pair< IndexType, SizeValueType > > m_ActiveBlockNodes;
+  std::vector< SizeValueType >                         m_ActiveBlockStarts;
+
+  /** The time step of each active block, and the next block to be taken by
+      a thread. */
+  std::vector< TimeStepType > m_ActiveBlockTimeSteps;
+  AtomicInt< SizeValueType >  m_NextActiveBlock;
+
 private:
   SparseFieldLevelSetImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                 //purposely not implemented
 
+  /** Structure for passing information into the static callback method. */
+  struct ActiveBlockThreadStruct {
+    SparseFieldLevelSetImageFilter *Filter;
+    ValueType MinNorm;
+  };
+
+  /** This callback method calls ThreadedCalculateActiveBlockChanges. */
+  static ITK_THREAD_RETURN_TYPE CalculateActiveBlockChangesThreaderCallback(void *arg);
+
   /** This flag is true when methods need to check boundary conditions and
       false when methods do not need to check for boundary conditions. */
   bool m_BoundsCheckingActive;
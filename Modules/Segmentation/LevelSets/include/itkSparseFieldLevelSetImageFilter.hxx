@@ -136,6 +136,9 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
   m_InterpolateSurfaceLocation(true),
   m_InputImage(ITK_NULLPTR),
   m_OutputImage(ITK_NULLPTR),
+  m_UseActiveBlockThreading(false),
+  m_ActiveBlockSize(16),
+  m_NextActiveBlock(0),
   m_BoundsCheckingActive(false)
 {
   m_LayerNodeStore = LayerNodeStorageType::New();
@@ -904,9 +907,6 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
 {
   const typename Superclass::FiniteDifferenceFunctionType::Pointer df =
     this->GetDifferenceFunction();
-  typename Superclass::FiniteDifferenceFunctionType::FloatOffsetType offset;
-  ValueType norm_grad_phi_squared, dx_forward, dx_backward, forwardValue,
-            backwardValue, centerValue;
   unsigned  i;
   ValueType MIN_NORM      = 1.0e-6;
   if ( this->GetUseImageSpacing() )
@@ -919,12 +919,53 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
     MIN_NORM *= minSpacing;
     }
 
+  TimeStepType timeStep;
+
+  if ( m_UseActiveBlockThreading && this->GetNumberOfThreads() > 1 )
+    {
+    // The threads take the active blocks one after the other, and store the
+    // updates at the positions of the nodes in the active layer.
+    this->ConstructActiveBlocks();
+
+    m_UpdateBuffer.clear();
+    m_UpdateBuffer.resize( m_Layers[0]->Size(), m_ValueZero );
+    m_ActiveBlockTimeSteps.clear();
+    m_ActiveBlockTimeSteps.resize( m_ActiveBlockStarts.size() - 1, NumericTraits< TimeStepType >::ZeroValue() );
+    m_NextActiveBlock = 0;
+
+    ActiveBlockThreadStruct str;
+    str.Filter = this;
+    str.MinNorm = MIN_NORM;
+
+    this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+    this->GetMultiThreader()->SetSingleMethod(this->CalculateActiveBlockChangesThreaderCallback,
+                                              &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    // A block without any change has no time step.
+    std::vector< bool > validTimeSteps( m_ActiveBlockTimeSteps.size() );
+    bool                anyValidTimeStep = false;
+    for ( i = 0; i < m_ActiveBlockTimeSteps.size(); ++i )
+      {
+      validTimeSteps[i] = ( m_ActiveBlockTimeSteps[i] > NumericTraits< TimeStepType >::ZeroValue() );
+      anyValidTimeStep = anyValidTimeStep || validTimeSteps[i];
+      }
+    if ( anyValidTimeStep )
+      {
+      timeStep = this->ResolveTimeStep(m_ActiveBlockTimeSteps, validTimeSteps);
+      }
+    else
+      {
+      timeStep = NumericTraits< TimeStepType >::ZeroValue();
+      }
+    return timeStep;
+    }
+
   void *globalData = df->GetGlobalDataPointer();
 
   typename LayerType::ConstIterator layerIt;
   NeighborhoodIterator< OutputImageType > outputIt( df->GetRadius(),
                                                     this->m_OutputImage, this->m_OutputImage->GetRequestedRegion() );
-  TimeStepType timeStep;
 
   if ( m_BoundsCheckingActive == false )
     {
@@ -941,74 +982,196 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
   for ( layerIt = m_Layers[0]->Begin(); layerIt != m_Layers[0]->End(); ++layerIt )
     {
     outputIt.SetLocation(layerIt->m_Value);
+    m_UpdateBuffer.push_back( this->CalculateActiveNodeChange(outputIt, globalData, MIN_NORM) );
+    }
+
+  // Ask the finite difference function to compute the time step for
+  // this iteration.  We give it the global data pointer to use, then
+  // ask it to free the global data memory.
+  timeStep = df->ComputeGlobalTimeStep(globalData);
+
+  df->ReleaseGlobalDataPointer(globalData);
+
+  return timeStep;
+}
+
+template< typename TInputImage, typename TOutputImage >
+typename SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >::ValueType
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::CalculateActiveNodeChange(NeighborhoodIterator< OutputImageType > & outputIt,
+                            void *globalData, const ValueType & minNorm)
+{
+  const typename Superclass::FiniteDifferenceFunctionType::Pointer df =
+    this->GetDifferenceFunction();
+  typename Superclass::FiniteDifferenceFunctionType::FloatOffsetType offset;
+  ValueType norm_grad_phi_squared, dx_forward, dx_backward, forwardValue,
+            backwardValue, centerValue;
+  unsigned  i;
 
-    // Calculate the offset to the surface from the center of this
-    // neighborhood.  This is used by some level set functions in sampling a
-    // speed, advection, or curvature term.
-    if ( this->GetInterpolateSurfaceLocation()
-         && ( centerValue = outputIt.GetCenterPixel() ) != 0.0 )
+  // Calculate the offset to the surface from the center of this
+  // neighborhood.  This is used by some level set functions in sampling a
+  // speed, advection, or curvature term.
+  if ( this->GetInterpolateSurfaceLocation()
+       && ( centerValue = outputIt.GetCenterPixel() ) != 0.0 )
+    {
+    // Surface is at the zero crossing, so distance to surface is:
+    // phi(x) / norm(grad(phi)), where phi(x) is the center of the
+    // neighborhood.  The location is therefore
+    // (i,j,k) - ( phi(x) * grad(phi(x)) ) / norm(grad(phi))^2
+    norm_grad_phi_squared = 0.0;
+    for ( i = 0; i < ImageDimension; ++i )
       {
-      // Surface is at the zero crossing, so distance to surface is:
-      // phi(x) / norm(grad(phi)), where phi(x) is the center of the
-      // neighborhood.  The location is therefore
-      // (i,j,k) - ( phi(x) * grad(phi(x)) ) / norm(grad(phi))^2
-      norm_grad_phi_squared = 0.0;
-      for ( i = 0; i < ImageDimension; ++i )
-        {
-        forwardValue  = outputIt.GetNext(i);
-        backwardValue = outputIt.GetPrevious(i);
+      forwardValue  = outputIt.GetNext(i);
+      backwardValue = outputIt.GetPrevious(i);
 
-        if ( forwardValue * backwardValue >= 0 )
-          { //  Neighbors are same sign OR at least one neighbor is zero.
-          dx_forward  = forwardValue - centerValue;
-          dx_backward = centerValue - backwardValue;
+      if ( forwardValue * backwardValue >= 0 )
+        { //  Neighbors are same sign OR at least one neighbor is zero.
+        dx_forward  = forwardValue - centerValue;
+        dx_backward = centerValue - backwardValue;
 
-          // Pick the larger magnitude derivative.
-          if ( ::vnl_math_abs(dx_forward) > ::vnl_math_abs(dx_backward) )
-            {
-            offset[i] = dx_forward;
-            }
-          else
-            {
-            offset[i] = dx_backward;
-            }
+        // Pick the larger magnitude derivative.
+        if ( ::vnl_math_abs(dx_forward) > ::vnl_math_abs(dx_backward) )
+          {
+          offset[i] = dx_forward;
           }
-        else //Neighbors are opposite sign, pick the direction of the 0 surface.
+        else
           {
-          if ( forwardValue * centerValue < 0 )
-            {
-            offset[i] = forwardValue - centerValue;
-            }
-          else
-            {
-            offset[i] = centerValue - backwardValue;
-            }
+          offset[i] = dx_backward;
           }
-
-        norm_grad_phi_squared += offset[i] * offset[i];
         }
-
-      for ( i = 0; i < ImageDimension; ++i )
+      else //Neighbors are opposite sign, pick the direction of the 0 surface.
         {
-        offset[i] = ( offset[i] * centerValue ) / ( norm_grad_phi_squared + MIN_NORM );
+        if ( forwardValue * centerValue < 0 )
+          {
+          offset[i] = forwardValue - centerValue;
+          }
+        else
+          {
+          offset[i] = centerValue - backwardValue;
+          }
         }
 
-      m_UpdateBuffer.push_back( df->ComputeUpdate(outputIt, globalData, offset) );
+      norm_grad_phi_squared += offset[i] * offset[i];
+      }
+
+    for ( i = 0; i < ImageDimension; ++i )
+      {
+      offset[i] = ( offset[i] * centerValue ) / ( norm_grad_phi_squared + minNorm );
+      }
+
+    return df->ComputeUpdate(outputIt, globalData, offset);
+    }
+  else // Don't do interpolation
+    {
+    return df->ComputeUpdate(outputIt, globalData);
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::ConstructActiveBlocks()
+{
+  const typename OutputImageType::RegionType & region = m_OutputImage->GetRequestedRegion();
+  unsigned int i;
+
+  // Number of blocks covering the requested region along each dimension.
+  SizeValueType blockStrides[ImageDimension];
+  SizeValueType numberOfBlocks = 1;
+  for ( i = 0; i < ImageDimension; ++i )
+    {
+    blockStrides[i] = numberOfBlocks;
+    numberOfBlocks *= ( region.GetSize()[i] + m_ActiveBlockSize - 1 ) / m_ActiveBlockSize;
+    }
+
+  // Sort the nodes by block with a counting sort, which keeps the order of
+  // the active layer inside each block.
+  std::vector< SizeValueType > nodeBlocks;
+  nodeBlocks.reserve( m_Layers[0]->Size() );
+  std::vector< SizeValueType > blockCounts(numberOfBlocks, 0);
+
+  typename LayerType::ConstIterator layerIt;
+  for ( layerIt = m_Layers[0]->Begin(); layerIt != m_Layers[0]->End(); ++layerIt )
+    {
+    SizeValueType block = 0;
+    for ( i = 0; i < ImageDimension; ++i )
+      {
+      block += blockStrides[i]
+               * static_cast< SizeValueType >( ( layerIt->m_Value[i] - region.GetIndex()[i] ) / m_ActiveBlockSize );
       }
-    else // Don't do interpolation
+    nodeBlocks.push_back(block);
+    ++blockCounts[block];
+    }
+
+  m_ActiveBlockStarts.clear();
+  SizeValueType start = 0;
+  for ( SizeValueType block = 0; block < numberOfBlocks; ++block )
+    {
+    const SizeValueType count = blockCounts[block];
+    if ( count > 0 )
       {
-      m_UpdateBuffer.push_back( df->ComputeUpdate(outputIt, globalData) );
+      m_ActiveBlockStarts.push_back(start);
       }
+    blockCounts[block] = start;
+    start += count;
     }
+  m_ActiveBlockStarts.push_back(start);
 
-  // Ask the finite difference function to compute the time step for
-  // this iteration.  We give it the global data pointer to use, then
-  // ask it to free the global data memory.
-  timeStep = df->ComputeGlobalTimeStep(globalData);
+  m_ActiveBlockNodes.resize( nodeBlocks.size() );
+  SizeValueType position = 0;
+  for ( layerIt = m_Layers[0]->Begin(); layerIt != m_Layers[0]->End(); ++layerIt, ++position )
+    {
+    m_ActiveBlockNodes[blockCounts[nodeBlocks[position]]++] =
+      std::pair< IndexType, SizeValueType >(layerIt->m_Value, position);
+    }
+}
 
-  df->ReleaseGlobalDataPointer(globalData);
+template< typename TInputImage, typename TOutputImage >
+ITK_THREAD_RETURN_TYPE
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::CalculateActiveBlockChangesThreaderCallback(void *arg)
+{
+  ActiveBlockThreadStruct * str = (ActiveBlockThreadStruct *)
+      ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
 
-  return timeStep;
+  str->Filter->ThreadedCalculateActiveBlockChanges(str->MinNorm);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
+::ThreadedCalculateActiveBlockChanges(const ValueType & minNorm)
+{
+  const typename Superclass::FiniteDifferenceFunctionType::Pointer df =
+    this->GetDifferenceFunction();
+
+  NeighborhoodIterator< OutputImageType > outputIt( df->GetRadius(),
+                                                    this->m_OutputImage, this->m_OutputImage->GetRequestedRegion() );
+
+  if ( m_BoundsCheckingActive == false )
+    {
+    outputIt.NeedToUseBoundaryConditionOff();
+    }
+
+  const SizeValueType numberOfActiveBlocks = m_ActiveBlockTimeSteps.size();
+  SizeValueType       block;
+  while ( ( block = m_NextActiveBlock++ ) < numberOfActiveBlocks )
+    {
+    // Each block has its own global data, so that its time step does not
+    // depend on the blocks taken before by the thread.
+    void *globalData = df->GetGlobalDataPointer();
+
+    for ( SizeValueType n = m_ActiveBlockStarts[block]; n < m_ActiveBlockStarts[block + 1]; ++n )
+      {
+      outputIt.SetLocation(m_ActiveBlockNodes[n].first);
+      m_UpdateBuffer[m_ActiveBlockNodes[n].second] = this->CalculateActiveNodeChange(outputIt, globalData, minNorm);
+      }
+
+    m_ActiveBlockTimeSteps[block] = df->ComputeGlobalTimeStep(globalData);
+    df->ReleaseGlobalDataPointer(globalData);
+    }
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -1196,7 +1359,9 @@ SparseFieldLevelSetImageFilter< TInputImage, TOutputImage >
   unsigned int i;
   os << indent << "m_IsoSurfaceValue: " << m_IsoSurfaceValue << std::endl;
   itkPrintSelfObjectMacro( LayerNodeStore );
-  os << indent << "m_BoundsCheckingActive: " << m_BoundsCheckingActive;
+  os << indent << "m_BoundsCheckingActive: " << m_BoundsCheckingActive << std::endl;
+  os << indent << "m_UseActiveBlockThreading: " << m_UseActiveBlockThreading << std::endl;
+  os << indent << "m_ActiveBlockSize: " << m_ActiveBlockSize << std::endl;
   for ( i = 0; i < m_Layers.size(); i++ )
     {
     os << indent << "m_Layers[" << i << "]: size="
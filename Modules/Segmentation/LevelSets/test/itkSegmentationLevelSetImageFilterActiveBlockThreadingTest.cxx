@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkThresholdSegmentationLevelSetImageFilter.h"
+#include "itkShapeDetectionLevelSetImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Segment a volume with a flat front, which lies in a few slices, serially
+ * and with the changes of the active layer calculated by several threads
+ * taking the active blocks. Without advection, the time steps are the same,
+ * so that the results must be identical.
+ */
+
+namespace
+{
+const unsigned int Dimension = 3;
+typedef itk::Image< float, Dimension > ImageType;
+
+bool SegmentationLevelSetImageFilterActiveBlockThreadingTestCompare( const ImageType * image1,
+                                                                     const ImageType * image2,
+                                                                     const char * name )
+{
+  itk::ImageRegionConstIterator< ImageType > it1( image1, image1->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ImageType > it2( image2, image2->GetLargestPossibleRegion() );
+  for(; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    if( it1.Get() != it2.Get() )
+      {
+      std::cerr << name << ": the level sets differ with the active blocks" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+template< typename TFilter >
+typename ImageType::Pointer
+SegmentationLevelSetImageFilterActiveBlockThreadingTestRun( TFilter * filter, bool useActiveBlocks )
+{
+  filter->SetNumberOfIterations( 20 );
+  filter->SetMaximumRMSError( 0.0 );
+  filter->SetUseActiveBlockThreading( useActiveBlocks );
+  filter->SetActiveBlockSize( 5 );
+  filter->SetNumberOfThreads( useActiveBlocks ? 4 : 1 );
+  filter->Update();
+  std::cout << filter->GetNameOfClass() << ( useActiveBlocks ? " with" : " without" )
+            << " active blocks: RMS change " << filter->GetRMSChange() << std::endl;
+  typename ImageType::Pointer output = filter->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+}
+
+int itkSegmentationLevelSetImageFilterActiveBlockThreadingTest( int, char *[] )
+{
+  ImageType::SizeType size;
+  size.Fill( 40 );
+  ImageType::Pointer initialImage = ImageType::New();
+  initialImage->SetRegions( size );
+  initialImage->Allocate();
+  ImageType::Pointer featureImage = ImageType::New();
+  featureImage->SetRegions( size );
+  featureImage->Allocate();
+
+  // the initial front is the plane z = 10, and the feature is brighter
+  // in a ball, which the front has to reach
+  itk::ImageRegionIteratorWithIndex< ImageType > it( initialImage, initialImage->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator< ImageType >          fit( featureImage, featureImage->GetLargestPossibleRegion() );
+  for(; !it.IsAtEnd(); ++it, ++fit )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    it.Set( index[2] - 10.0f );
+    const float x = index[0] - 20.0f;
+    const float y = index[1] - 20.0f;
+    const float z = index[2] - 16.0f;
+    fit.Set( x * x + y * y + z * z < 144.0f ? 100.0f : 10.0f );
+    }
+
+  typedef itk::ThresholdSegmentationLevelSetImageFilter< ImageType, ImageType > ThresholdFilterType;
+  ImageType::Pointer thresholdOutputs[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    ThresholdFilterType::Pointer filter = ThresholdFilterType::New();
+    filter->SetInput( initialImage );
+    filter->SetFeatureImage( featureImage );
+    filter->SetLowerThreshold( 50.0 );
+    filter->SetUpperThreshold( 150.0 );
+    filter->SetCurvatureScaling( 0.5 );
+    if( i == 0 && filter->GetUseActiveBlockThreading() )
+      {
+      std::cerr << "The active block threading is on by default" << std::endl;
+      return EXIT_FAILURE;
+      }
+    thresholdOutputs[i] = SegmentationLevelSetImageFilterActiveBlockThreadingTestRun( filter.GetPointer(), i == 1 );
+    }
+  if( !SegmentationLevelSetImageFilterActiveBlockThreadingTestCompare( thresholdOutputs[0], thresholdOutputs[1],
+                                                                       "ThresholdSegmentationLevelSetImageFilter" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ShapeDetectionLevelSetImageFilter< ImageType, ImageType > ShapeDetectionFilterType;
+  ImageType::Pointer shapeDetectionOutputs[2];
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    ShapeDetectionFilterType::Pointer filter = ShapeDetectionFilterType::New();
+    filter->SetInput( initialImage );
+    filter->SetFeatureImage( featureImage );
+    filter->SetPropagationScaling( -0.01 );
+    filter->SetCurvatureScaling( 1.0 );
+    shapeDetectionOutputs[i] = SegmentationLevelSetImageFilterActiveBlockThreadingTestRun( filter.GetPointer(), i == 1 );
+    }
+  if( !SegmentationLevelSetImageFilterActiveBlockThreadingTestCompare( shapeDetectionOutputs[0], shapeDetectionOutputs[1],
+                                                                       "ShapeDetectionLevelSetImageFilter" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -289,7 +289,7 @@ LevelSetEvolution< TEquationContainer, WhitakerSparseLevelSetImage< TOutput, VDi
   while( this->m_LevelSetContainerIteratorToProcessWhenThreading != this->m_LevelSetContainer->End() )
     {
     typename LevelSetType::ConstPointer levelSet = this->m_LevelSetContainerIteratorToProcessWhenThreading->GetLevelSet();
-    const LevelSetLayerType zeroLayer = levelSet->GetLayer( 0 );
+    const LevelSetLayerType & zeroLayer = levelSet->GetLayer( 0 );
     typename LevelSetType::LayerConstIterator layerBegin = zeroLayer.begin();
     typename LevelSetType::LayerConstIterator layerEnd = zeroLayer.end();
     typename SplitLevelSetPartitionerType::DomainType completeDomain( layerBegin, layerEnd );
@@ -238,13 +238,15 @@ LevelSetEvolutionComputeIterationThreader<
   LevelSetIdentifierType levelSetId = it->GetIdentifier();
   typename LevelSetEvolutionType::LevelSetLayerType * levelSetLayerUpdateBuffer = this->m_Associate->m_UpdateBuffer[ levelSetId ];
 
+  // the threads got consecutive ranges of the zero layer, so that the pairs
+  // come in the order of the layer and are inserted at its end
   const ThreadIdType numberOfThreads = this->GetNumberOfThreadsUsed();
   for( ThreadIdType ii = 0; ii < numberOfThreads; ++ii )
     {
     typename std::vector< NodePairType >::const_iterator pairIt = this->m_NodePairsPerThread[ii].begin();
     while( pairIt != this->m_NodePairsPerThread[ii].end() )
       {
-      levelSetLayerUpdateBuffer->insert( *pairIt );
+      levelSetLayerUpdateBuffer->insert( levelSetLayerUpdateBuffer->end(), *pairIt );
       ++pairIt;
       }
     }
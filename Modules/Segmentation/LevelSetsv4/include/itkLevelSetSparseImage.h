@@ -24,6 +24,7 @@
 
 #include "itkLabelObject.h"
 #include "itkLabelMap.h"
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +32,13 @@ namespace itk
  *  \class LevelSetSparseImage
  *  \brief Base class for the sparse representation of a level-set function on one Image.
  *
+ *  The status of the nodes is given by the label map. SetLabelMap() and
+ *  Graft() also copy the lines of all its label objects, with their status,
+ *  into one vector sorted in raster order, so that Status() is a binary search
+ *  instead of a scan of the lines of each label object. Editing the label
+ *  objects does not modify the label map, so SetLabelMap() has to be called
+ *  again after such edits.
+ *
  *  \tparam TImage Input image type of the level set function
  *  \todo Think about using image iterators instead of GetPixel()
  *
@@ -111,6 +119,48 @@ protected:
   LabelMapPointer   m_LabelMap;
   LayerIdListType   m_InternalLabelList;
 
+  /** Line of the label map, with the status of its label object */
+  struct StatusLineType
+    {
+    InputType             m_Index;
+    LabelObjectLengthType m_Length;
+    LayerIdType           m_Status;
+    };
+  typedef std::vector< StatusLineType > StatusLineContainerType;
+
+  /** Order the lines, and the indices, in raster order */
+  struct StatusLineCompare
+    {
+    bool operator()( const InputType & index1, const InputType & index2 ) const
+      {
+      for( int dim = VDimension - 1; dim >= 0; --dim )
+        {
+        if( index1[dim] != index2[dim] )
+          {
+          return index1[dim] < index2[dim];
+          }
+        }
+      return false;
+      }
+    bool operator()( const StatusLineType & line1, const StatusLineType & line2 ) const
+      {
+      return ( *this )( line1.m_Index, line2.m_Index );
+      }
+    bool operator()( const InputType & index, const StatusLineType & line ) const
+      {
+      return ( *this )( index, line.m_Index );
+      }
+    };
+
+  StatusLineContainerType m_StatusLines;
+  ModifiedTimeType        m_StatusLinesMTime;
+
+  /** Copy the lines of the label map into m_StatusLines */
+  void UpdateStatusLines();
+
+  /** Returns the status of an index of the label map, i.e. without the domain offset */
+  LayerIdType GetLabelMapStatus( const InputType& mapIndex ) const;
+
   /** Initialize the sparse field layers */
   virtual void InitializeLayers() = 0;
 
@@ -20,13 +20,15 @@
 #define itkLevelSetSparseImage_hxx
 
 #include "itkLevelSetSparseImage.h"
+#include <algorithm>
 
 namespace itk
 {
 
 template< typename TOutput, unsigned int VDimension >
 LevelSetSparseImage< TOutput, VDimension >
-::LevelSetSparseImage()
+::LevelSetSparseImage() :
+  m_StatusLinesMTime( 0 )
 {}
 
 
@@ -42,7 +44,81 @@ LevelSetSparseImage< TOutput, VDimension >
 ::Status( const InputType& inputIndex ) const
 {
   InputType mapIndex = inputIndex - this->m_DomainOffset;
-  return this->m_LabelMap->GetPixel( mapIndex );
+  return this->GetLabelMapStatus( mapIndex );
+}
+
+
+template< typename TOutput, unsigned int VDimension >
+typename LevelSetSparseImage< TOutput, VDimension >::LayerIdType
+LevelSetSparseImage< TOutput, VDimension >
+::GetLabelMapStatus( const InputType& mapIndex ) const
+{
+  if( this->m_LabelMap->GetMTime() != this->m_StatusLinesMTime )
+    {
+    // the label map was modified since its lines were copied
+    return this->m_LabelMap->GetPixel( mapIndex );
+    }
+
+  // the last line starting before mapIndex is the only one which may hold it
+  typename StatusLineContainerType::const_iterator lineIt =
+    std::upper_bound( this->m_StatusLines.begin(), this->m_StatusLines.end(), mapIndex, StatusLineCompare() );
+  if( lineIt != this->m_StatusLines.begin() )
+    {
+    --lineIt;
+    bool isInLine = true;
+    for( unsigned int dim = 1; dim < Dimension; ++dim )
+      {
+      if( lineIt->m_Index[dim] != mapIndex[dim] )
+        {
+        isInLine = false;
+        break;
+        }
+      }
+    if( isInLine && mapIndex[0] < lineIt->m_Index[0] + static_cast< OffsetValueType >( lineIt->m_Length ) )
+      {
+      return lineIt->m_Status;
+      }
+    }
+  return this->m_LabelMap->GetBackgroundValue();
+}
+
+
+template< typename TOutput, unsigned int VDimension >
+void
+LevelSetSparseImage< TOutput, VDimension >
+::UpdateStatusLines()
+{
+  this->m_StatusLines.clear();
+  this->m_StatusLinesMTime = 0;
+  if( this->m_LabelMap.IsNull() )
+    {
+    return;
+    }
+
+  typedef typename LabelMapType::ConstIterator LabelObjectConstIterator;
+
+  SizeValueType numberOfLines = 0;
+  for( LabelObjectConstIterator objectIt( this->m_LabelMap ); !objectIt.IsAtEnd(); ++objectIt )
+    {
+    numberOfLines += objectIt.GetLabelObject()->GetNumberOfLines();
+    }
+  this->m_StatusLines.reserve( numberOfLines );
+
+  for( LabelObjectConstIterator objectIt( this->m_LabelMap ); !objectIt.IsAtEnd(); ++objectIt )
+    {
+    const LabelObjectType * labelObject = objectIt.GetLabelObject();
+    StatusLineType statusLine;
+    statusLine.m_Status = labelObject->GetLabel();
+    for( SizeValueType i = 0; i < labelObject->GetNumberOfLines(); ++i )
+      {
+      const LabelObjectLineType & line = labelObject->GetLine( i );
+      statusLine.m_Index = line.GetIndex();
+      statusLine.m_Length = line.GetLength();
+      this->m_StatusLines.push_back( statusLine );
+      }
+    }
+  std::sort( this->m_StatusLines.begin(), this->m_StatusLines.end(), StatusLineCompare() );
+  this->m_StatusLinesMTime = this->m_LabelMap->GetMTime();
 }
 
 
@@ -62,6 +138,7 @@ LevelSetSparseImage< TOutput, VDimension >
     this->m_NeighborhoodScales[dim] =
         NumericTraits< OutputRealType >::OneValue() / static_cast< OutputRealType >( spacing[dim] );
     }
+  this->UpdateStatusLines();
   this->Modified();
 }
 
@@ -102,6 +179,7 @@ LevelSetSparseImage< TOutput, VDimension >
     LayerMapType newLayers( levelSet->m_Layers );
     std::swap( m_Layers, newLayers );
     }
+  this->UpdateStatusLines();
 }
 
 
@@ -156,6 +234,8 @@ LevelSetSparseImage< TOutput, VDimension >
   Superclass::Initialize();
 
   this->m_LabelMap = ITK_NULLPTR;
+  this->m_StatusLines.clear();
+  this->m_StatusLinesMTime = 0;
   this->InitializeLayers();
   this->InitializeInternalLabelList();
 }
@@ -47,6 +47,26 @@ typename MalcolmSparseLevelSetImage< VDimension >::OutputType
 MalcolmSparseLevelSetImage< VDimension >::Evaluate( const InputType& inputPixel ) const
 {
   InputType mapIndex = inputPixel - this->m_DomainOffset;
+
+  if( this->m_LabelMap.IsNotNull() )
+    {
+    // the status of the node gives the only layer which may hold it
+    const LayerIdType status = this->GetLabelMapStatus( mapIndex );
+    if( status == MinusOneLayer() || status == PlusOneLayer() )
+      {
+      return static_cast<OutputType>( status );
+      }
+    LayerMapConstIterator statusLayerIt = this->m_Layers.find( status );
+    if( statusLayerIt != this->m_Layers.end() )
+      {
+      LayerConstIterator it = ( statusLayerIt->second ).find( mapIndex );
+      if( it != ( statusLayerIt->second ).end() )
+        {
+        return it->second;
+        }
+      }
+    }
+
   LayerMapConstIterator layerIt = this->m_Layers.begin();
 
   while( layerIt != this->m_Layers.end() )
@@ -46,6 +46,26 @@ ShiSparseLevelSetImage< VDimension >
 ::Evaluate( const InputType& inputIndex ) const
 {
   InputType mapIndex = inputIndex - this->m_DomainOffset;
+
+  if( this->m_LabelMap.IsNotNull() )
+    {
+    // the status of the node gives the only layer which may hold it
+    const LayerIdType status = this->GetLabelMapStatus( mapIndex );
+    if( status == this->MinusThreeLayer() || status == this->PlusThreeLayer() )
+      {
+      return static_cast<OutputType>( status );
+      }
+    LayerMapConstIterator statusLayerIt = this->m_Layers.find( status );
+    if( statusLayerIt != this->m_Layers.end() )
+      {
+      LayerConstIterator it = ( statusLayerIt->second ).find( mapIndex );
+      if( it != ( statusLayerIt->second ).end() )
+        {
+        return it->second;
+        }
+      }
+    }
+
   LayerMapConstIterator layerIt = this->m_Layers.begin();
 
   while( layerIt != this->m_Layers.end() )
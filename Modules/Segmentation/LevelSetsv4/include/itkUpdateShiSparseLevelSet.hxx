@@ -192,6 +192,8 @@ UpdateShiSparseLevelSet< VDimension, TEquationContainer >
 
   LevelSetLabelMapPointer outputLabelMap = this->m_OutputLevelSet->GetModifiableLabelMap( );
   outputLabelMap->Graft( labelImageToLabelMapFilter->GetOutput() );
+  // the grafting does not modify the label map, whose lines the level sets copied
+  outputLabelMap->Modified();
 }
 
 template< unsigned int VDimension, typename TEquationContainer >
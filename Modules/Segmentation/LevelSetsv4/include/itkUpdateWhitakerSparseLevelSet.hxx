@@ -194,7 +194,10 @@ void UpdateWhitakerSparseLevelSet< VDimension, TLevelSetValueType, TEquationCont
   labelImageToLabelMapFilter->SetBackgroundValue( LevelSetType::PlusThreeLayer() );
   labelImageToLabelMapFilter->Update();
 
-  this->m_OutputLevelSet->GetModifiableLabelMap( )->Graft( labelImageToLabelMapFilter->GetOutput() );
+  LevelSetLabelMapPointer outputLabelMap = this->m_OutputLevelSet->GetModifiableLabelMap( );
+  outputLabelMap->Graft( labelImageToLabelMapFilter->GetOutput() );
+  // the grafting does not modify the label map, whose lines the level sets copied
+  outputLabelMap->Modified();
   this->m_TempPhi.clear();
 }
 
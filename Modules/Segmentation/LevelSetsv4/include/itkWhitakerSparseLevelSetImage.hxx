@@ -46,6 +46,26 @@ WhitakerSparseLevelSetImage< TOutput, VDimension >
 ::Evaluate( const InputType& inputIndex ) const
 {
   InputType mapIndex = inputIndex - this->m_DomainOffset;
+
+  if( this->m_LabelMap.IsNotNull() )
+    {
+    // the status of the node gives the only layer which may hold it
+    const LayerIdType status = this->GetLabelMapStatus( mapIndex );
+    if( status == MinusThreeLayer() || status == PlusThreeLayer() )
+      {
+      return static_cast<OutputType>( status );
+      }
+    LayerMapConstIterator statusLayerIt = this->m_Layers.find( status );
+    if( statusLayerIt != this->m_Layers.end() )
+      {
+      LayerConstIterator it = ( statusLayerIt->second ).find( mapIndex );
+      if( it != ( statusLayerIt->second ).end() )
+        {
+        return it->second;
+        }
+      }
+    }
+
   LayerMapConstIterator layerIt = this->m_Layers.begin();
 
   OutputType rval = static_cast<OutputType>(ZeroLayer());
@@ -61,5 +61,43 @@ int itkWhitakerSparseLevelSetImageTest( int , char* [] )
     return EXIT_FAILURE;
     }
 
+  // the status of a label map modified after SetLabelMap() is still right
+  index[0] = 5;
+  index[1] = 4;
+  labelMap->SetPixel( index, -3 );
+  if( phi->Status( index ) != -3 )
+    {
+    std::cout << index << ' ' << static_cast< int >( phi->Status( index ) ) << " != -3" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // as well as the one of a node of a layer
+  index[0] = 8;
+  index[1] = 6;
+  labelMap->SetPixel( index, 0 );
+  phi->GetLayer( 0 )[index] = 0.25;
+  phi->SetLabelMap( labelMap );
+
+  if( phi->Status( index ) != 0 || itk::Math::NotExactlyEquals(phi->Evaluate( index ), 0.25) )
+    {
+    std::cout << index << ' ' << phi->Evaluate( index ) << " != 0.25" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  index[0] = 4;
+  index[1] = 4;
+  if( phi->Status( index ) != 3 || itk::Math::NotExactlyEquals(phi->Evaluate( index ), 3) )
+    {
+    std::cout << index << ' ' << phi->Evaluate( index ) << " != 3" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  index[0] = 5;
+  if( phi->Status( index ) != -3 || itk::Math::NotExactlyEquals(phi->Evaluate( index ), -3) )
+    {
+    std::cout << index << ' ' << phi->Evaluate( index ) << " != -3" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
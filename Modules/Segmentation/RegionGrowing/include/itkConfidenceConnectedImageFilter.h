@@ -52,6 +52,10 @@ namespace itk
  * NOTE: the lower and upper threshold are restricted to lie within the
  * valid numeric limits of the input data pixel type. Also, the limits
  * may be adjusted to contain the seed point's intensity.
+ *
+ * The region is grown, and its statistics are accumulated, with the threads
+ * of the filter by a ParallelFloodFiller.
+ *
  * \ingroup RegionGrowingSegmentation
  * \ingroup ITKRegionGrowing
  *
@@ -25,8 +25,7 @@
 #include "itkMeanImageFunction.h"
 #include "itkSumOfSquaresImageFunction.h"
 #include "itkBinaryThresholdImageFunction.h"
-#include "itkFloodFilledImageFunctionConditionalIterator.h"
-#include "itkProgressReporter.h"
+#include "itkParallelFloodFiller.h"
 
 namespace itk
 {
@@ -138,11 +137,8 @@ void
 ConfidenceConnectedImageFilter< TInputImage, TOutputImage >
 ::GenerateData()
 {
-  typedef BinaryThresholdImageFunction< InputImageType, double >  FunctionType;
-  typedef BinaryThresholdImageFunction< OutputImageType, double > SecondFunctionType;
-
-  typedef FloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType >           IteratorType;
-  typedef FloodFilledImageFunctionConditionalConstIterator< InputImageType, SecondFunctionType > SecondIteratorType;
+  typedef BinaryThresholdImageFunction< InputImageType, double > FunctionType;
+  typedef ParallelFloodFiller< OutputImageType, FunctionType >   FillerType;
 
   unsigned int loop;
 
@@ -302,51 +298,30 @@ ConfidenceConnectedImageFilter< TInputImage, TOutputImage >
     << "\nLower intensity = " << lower << ", Upper intensity = " << upper << "\nmean = " << m_Mean
     << " , std::sqrt(variance) = " << std::sqrt(m_Variance) );
 
-  // Segment the image, the iterator walks the output image (so Set()
-  // writes into the output image), starting at the seed point.  As
-  // the iterator walks, if the corresponding pixel in the input image
-  // (accessed via the "function" assigned to the iterator) is within
-  // the [lower, upper] bounds prescribed, the pixel is added to the
-  // output segmentation and its neighbors become candidates for the
-  // iterator to walk.
-  IteratorType it = IteratorType (outputImage, function, m_Seeds);
-  it.GoToBegin();
-  while ( !it.IsAtEnd() )
-    {
-    it.Set(m_ReplaceValue);
-    ++it;
-    }
-
-  ProgressReporter progress(this, 0, region.GetNumberOfPixels() * m_NumberOfIterations);
+  // Segment the image, starting at the seed points, with the threads of
+  // the filter.  If a pixel in the input image (accessed via the
+  // "function" assigned to the filler) is within the [lower, upper]
+  // bounds prescribed, the pixel is added to the output segmentation and
+  // its neighbors become candidates for the region growing.  The sum and
+  // the sum of squares of the input values of the pixels added are
+  // accumulated by the threads as they grow the region.
+  typename FillerType::Pointer filler = FillerType::New();
+  filler->SetImage(outputImage);
+  filler->SetFunction(function);
+  filler->SetSeeds(m_Seeds);
+  filler->SetReplaceValue(m_ReplaceValue);
+  filler->SetComputeStatistics(true);
+  filler->SetNumberOfThreads( this->GetNumberOfThreads() );
+  filler->Fill();
 
   for ( loop = 0; loop < m_NumberOfIterations; ++loop )
     {
     // Now that we have an initial segmentation, let's recalculate the
-    // statistics.  Since we have already labelled the output, we visit
-    // pixels in the input image that have been set in the output image.
-    // Essentially, we flip the iterator around, so we walk the input
-    // image (so Get() will get pixel values from the input) and constrain
-    // iterator such it only visits pixels that were set in the output.
-    typename SecondFunctionType::Pointer secondFunction = SecondFunctionType::New();
-    secondFunction->SetInputImage (outputImage);
-    secondFunction->ThresholdBetween(m_ReplaceValue, m_ReplaceValue);
-
-    typename NumericTraits< typename InputImageType::PixelType >::RealType sum, sumOfSquares;
-    sum = NumericTraits< InputRealType >::ZeroValue();
-    sumOfSquares = NumericTraits< InputRealType >::ZeroValue();
-    typename TOutputImage::SizeValueType numberOfSamples = 0;
-
-    SecondIteratorType sit =
-      SecondIteratorType (inputImage, secondFunction, m_Seeds);
-    sit.GoToBegin();
-    while ( !sit.IsAtEnd() )
-      {
-      const InputRealType value = static_cast< InputRealType >( sit.Get() );
-      sum += value;
-      sumOfSquares += value * value;
-      ++numberOfSamples;
-      ++sit;
-      }
+    // statistics from the pixels that have been set in the output image.
+    const InputRealType sum = filler->GetSum();
+    const InputRealType sumOfSquares = filler->GetSumOfSquares();
+    const SizeValueType numberOfSamples = filler->GetNumberOfFilledPixels();
+
     m_Mean      = sum / double(numberOfSamples);
     m_Variance  = ( sumOfSquares - ( sum * sum / double(numberOfSamples) ) ) / ( double(numberOfSamples) - 1.0 );
     // if the variance is zero, there is no point in continuing
@@ -398,26 +373,13 @@ ConfidenceConnectedImageFilter< TInputImage, TOutputImage >
                    << " , std::sqrt(variance) = " << std::sqrt(m_Variance) );
     itkDebugMacro(<< "\nsum = " << sum << ", sumOfSquares = " << sumOfSquares << "\nnum = " << numberOfSamples);
 
-    // Rerun the segmentation, the iterator walks the output image,
-    // starting at the seed point.  As the iterator walks, if the
-    // corresponding pixel in the input image (accessed via the
-    // "function" assigned to the iterator) is within the [lower,
-    // upper] bounds prescribed, the pixel is added to the output
-    // segmentation and its neighbors become candidates for the
-    // iterator to walk.
+    // Rerun the segmentation, starting at the seed points, with the new
+    // bounds.
     outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
-    IteratorType thirdIt = IteratorType (outputImage, function, m_Seeds);
-    thirdIt.GoToBegin();
-    try
-      {
-      while ( !thirdIt.IsAtEnd() )
-        {
-        thirdIt.Set(m_ReplaceValue);
-        ++thirdIt;
-        progress.CompletedPixel();  // potential exception thrown here
-        }
-      }
-    catch ( ProcessAborted & )
+    filler->Fill();
+
+    this->UpdateProgress( static_cast< float >( loop + 1 ) / static_cast< float >( m_NumberOfIterations ) );
+    if ( this->GetAbortGenerateData() )
       {
       break; // interrupt the iterations loop
       }
@@ -30,6 +30,9 @@ namespace itk
  * connected to an initial Seed AND lie within a Lower and Upper
  * threshold range.
  *
+ * The region is grown with the threads of the filter by a
+ * ParallelFloodFiller.
+ *
  * \ingroup RegionGrowingSegmentation
  * \ingroup ITKRegionGrowing
  */
@@ -20,10 +20,7 @@
 
 #include "itkConnectedThresholdImageFilter.h"
 #include "itkBinaryThresholdImageFunction.h"
-#include "itkFloodFilledImageFunctionConditionalIterator.h"
-#include "itkProgressReporter.h"
-
-#include "itkShapedFloodFilledImageFunctionConditionalIterator.h"
+#include "itkParallelFloodFiller.h"
 #include "itkMath.h"
 
 namespace itk
@@ -292,40 +289,20 @@ ConnectedThresholdImageFilter< TInputImage, TOutputImage >
   function->SetInputImage (inputImage);
   function->ThresholdBetween (m_Lower, m_Upper);
 
-  ProgressReporter progress( this, 0, region.GetNumberOfPixels() );
-
-  if ( this->m_Connectivity == FaceConnectivity )
-    {
-    typedef FloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType > IteratorType;
-    IteratorType it (outputImage, function, m_Seeds);
-    it.GoToBegin();
-
-    while ( !it.IsAtEnd() )
-      {
-      it.Set(m_ReplaceValue);
-      ++it;
-      progress.CompletedPixel();  // potential exception thrown here
-      }
-    }
-  else if ( this->m_Connectivity == FullConnectivity )
-    {
-    // use the fully connected iterator here. The fully connected iterator
-    // below is a superset of the above. However, it is reported to be 20%
-    // slower. Hence we use this "if" block to use the old iterator when
-    // we don't need full connectivity.
-
-    typedef ShapedFloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType > IteratorType;
-    IteratorType it (outputImage, function, m_Seeds);
-    it.FullyConnectedOn();
-    it.GoToBegin();
-
-    while ( !it.IsAtEnd() )
-      {
-      it.Set(m_ReplaceValue);
-      ++it;
-      progress.CompletedPixel();  // potential exception thrown here
-      }
-    }
+  // Grow the region from the seeds with the threads of the filter. With
+  // full connectivity, the region is the one of the fully connected
+  // ShapedFloodFilledImageFunctionConditionalIterator.
+  typedef ParallelFloodFiller< OutputImageType, FunctionType > FillerType;
+  typename FillerType::Pointer filler = FillerType::New();
+  filler->SetImage(outputImage);
+  filler->SetFunction(function);
+  filler->SetSeeds(m_Seeds);
+  filler->SetFullyConnected(this->m_Connectivity == FullConnectivity);
+  filler->SetReplaceValue(m_ReplaceValue);
+  filler->SetNumberOfThreads( this->GetNumberOfThreads() );
+  filler->Fill();
+
+  this->UpdateProgress(1.0);
 }
 } // end namespace itk
 
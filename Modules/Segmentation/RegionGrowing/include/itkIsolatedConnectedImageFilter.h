@@ -63,6 +63,8 @@ namespace itk
  * isolating threshold because no such threshold exists.  The user can
  * check for this by querying the GetThresholdingFailed() flag.
  *
+ * The regions tried are grown with the threads of the filter by a
+ * ParallelFloodFiller.
  *
  * \ingroup RegionGrowingSegmentation
  * \ingroup ITKRegionGrowing
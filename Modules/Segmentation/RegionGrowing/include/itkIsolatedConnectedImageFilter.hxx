@@ -20,12 +20,12 @@
 
 #include "itkIsolatedConnectedImageFilter.h"
 #include "itkBinaryThresholdImageFunction.h"
-#include "itkFloodFilledImageFunctionConditionalIterator.h"
-#include "itkProgressReporter.h"
+#include "itkParallelFloodFiller.h"
 #include "itkIterationReporter.h"
 #include "itkMath.h"
 #include "itkNumericTraits.h"
 #include "itkMath.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -220,15 +220,23 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
   outputImage->Allocate();
   outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
 
-  typedef BinaryThresholdImageFunction< InputImageType >                               FunctionType;
-  typedef FloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType > IteratorType;
+  typedef BinaryThresholdImageFunction< InputImageType >       FunctionType;
+  typedef ParallelFloodFiller< OutputImageType, FunctionType > FillerType;
 
   typename FunctionType::Pointer function = FunctionType::New();
   function->SetInputImage (inputImage);
 
+  // The regions are grown from the first seeds with the threads of the
+  // filter
+  typename FillerType::Pointer filler = FillerType::New();
+  filler->SetImage(outputImage);
+  filler->SetFunction(function);
+  filler->SetSeeds(m_Seeds1);
+  filler->SetReplaceValue(m_ReplaceValue);
+  filler->SetNumberOfThreads( this->GetNumberOfThreads() );
+
   float             progressWeight = 0.0f;
   float             cumulatedProgress = 0.0f;
-  IteratorType      it = IteratorType (outputImage, function, m_Seeds1);
   IterationReporter iterate(this, 0, 1);
 
   // If the upper threshold has not been set, find it.
@@ -250,21 +258,11 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
 
     while ( lower + m_IsolatedValueTolerance < guess )
       {
-      ProgressReporter progress(this, 0, region.GetNumberOfPixels(), 100, cumulatedProgress, progressWeight);
-      cumulatedProgress += progressWeight;
       outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
       function->ThresholdBetween ( m_Lower, static_cast< InputImagePixelType >( guess ) );
-      it.GoToBegin();
-      while ( !it.IsAtEnd() )
-        {
-        it.Set(m_ReplaceValue);
-        if ( it.GetIndex() == *m_Seeds2.begin() )
-          {
-          break;
-          }
-        ++it;
-        progress.CompletedPixel(); // potential exception thrown here
-        }
+      filler->Fill();
+      cumulatedProgress += progressWeight;
+      this->UpdateProgress( std::min(cumulatedProgress, 1.0f) );
       // If any of second seeds are included, decrease the upper bound.
       // Find the sum of the intensities in m_Seeds2.  If the second
       // seeds are not included, the sum should be zero.  Otherwise,
@@ -317,21 +315,11 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
 
     while ( guess < upper - m_IsolatedValueTolerance )
       {
-      ProgressReporter progress(this, 0, region.GetNumberOfPixels(), 100, cumulatedProgress, progressWeight);
-      cumulatedProgress += progressWeight;
       outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
       function->ThresholdBetween (static_cast< InputImagePixelType >( guess ), m_Upper);
-      it.GoToBegin();
-      while ( !it.IsAtEnd() )
-        {
-        it.Set(m_ReplaceValue);
-        if ( it.GetIndex() == *m_Seeds2.begin() )
-          {
-          break;
-          }
-        ++it;
-        progress.CompletedPixel(); // potential exception thrown here
-        }
+      filler->Fill();
+      cumulatedProgress += progressWeight;
+      this->UpdateProgress( std::min(cumulatedProgress, 1.0f) );
       // If any of second seeds are included, increase the lower bound.
       // Find the sum of the intensities in m_Seeds2.  If the second
       // seeds are not included, the sum should be zero.  Otherwise,
@@ -368,8 +356,6 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
     }
 
   // now rerun the algorithm with the thresholds that separate the seeds.
-  ProgressReporter progress(this, 0, region.GetNumberOfPixels(), 100, cumulatedProgress, progressWeight);
-
   outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
   if ( m_FindUpperThreshold )
     {
@@ -379,13 +365,8 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
     {
     function->ThresholdBetween (m_IsolatedValue, m_Upper);
     }
-  it.GoToBegin();
-  while ( !it.IsAtEnd() )
-    {
-    it.Set(m_ReplaceValue);
-    ++it;
-    progress.CompletedPixel(); // potential exception thrown here
-    }
+  filler->Fill();
+  this->UpdateProgress(1.0);
 
   // If any of the second seeds are included or some of the first
   // seeds are not included, the algorithm could not find any threshold
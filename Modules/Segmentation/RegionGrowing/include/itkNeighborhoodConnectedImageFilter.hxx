@@ -20,8 +20,7 @@
 
 #include "itkNeighborhoodConnectedImageFilter.h"
 #include "itkNeighborhoodBinaryThresholdImageFunction.h"
-#include "itkFloodFilledImageFunctionConditionalIterator.h"
-#include "itkProgressReporter.h"
+#include "itkParallelFloodFiller.h"
 
 namespace itk
 {
@@ -125,23 +124,24 @@ NeighborhoodConnectedImageFilter< TInputImage, TOutputImage >
   outputImage->Allocate();
   outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
 
-  typedef NeighborhoodBinaryThresholdImageFunction< InputImageType >                   FunctionType;
-  typedef FloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType > IteratorType;
+  typedef NeighborhoodBinaryThresholdImageFunction< InputImageType > FunctionType;
+  typedef ParallelFloodFiller< OutputImageType, FunctionType >       FillerType;
 
   typename FunctionType::Pointer function = FunctionType::New();
   function->SetInputImage (inputImage);
   function->ThresholdBetween (m_Lower, m_Upper);
   function->SetRadius (m_Radius);
-  IteratorType it = IteratorType (outputImage, function, m_Seeds);
 
-  ProgressReporter progress( this, 0,
-                             outputImage->GetRequestedRegion().GetNumberOfPixels() );
-  while ( !it.IsAtEnd() )
-    {
-    it.Set(m_ReplaceValue);
-    ++it;
-    progress.CompletedPixel();
-    }
+  // Grow the region from the seeds with the threads of the filter
+  typename FillerType::Pointer filler = FillerType::New();
+  filler->SetImage(outputImage);
+  filler->SetFunction(function);
+  filler->SetSeeds(m_Seeds);
+  filler->SetReplaceValue(m_ReplaceValue);
+  filler->SetNumberOfThreads( this->GetNumberOfThreads() );
+  filler->Fill();
+
+  this->UpdateProgress(1.0);
 }
 } // end namespace itk
 
@@ -0,0 +1,217 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParallelFloodFiller_h
+#define itkParallelFloodFiller_h
+
+#include "itkObject.h"
+#include "itkMultiThreader.h"
+#include "itkBarrier.h"
+#include "itkNumericTraits.h"
+#include <vector>
+
+namespace itk
+{
+/** \class ParallelFloodFiller
+ * \brief Set the pixels of an image connected to seeds where an image
+ * function is true, with several threads.
+ *
+ * ParallelFloodFiller sets to ReplaceValue the pixels of the buffered
+ * region of an image that FloodFilledImageFunctionConditionalIterator (or
+ * ShapedFloodFilledImageFunctionConditionalIterator with full connectivity)
+ * would visit: the seeds inside the region where the function is true, and
+ * the pixels where the function is true connected to them. The other
+ * pixels of the image are left as they are.
+ *
+ * The region is grown one layer at a time, in a breadth first search.
+ * The pixels are shared among the threads in contiguous ranges of the
+ * buffer. Each thread lists the neighbors of its pixels of the last layer
+ * for the threads owning them. After a barrier, each thread looks at the
+ * neighbors of its own range, marks them in a bitmap of visited pixels and
+ * evaluates the function, which gives it its pixels of the next layer. No
+ * pixel is looked at by two threads, so that the function only needs to be
+ * safe to evaluate concurrently at different indices, as the image
+ * functions are.
+ *
+ * Optionally, the sum and the sum of squares of the values of the input
+ * image of the function at the pixels set are computed while filling.
+ *
+ * \sa FloodFilledImageFunctionConditionalIterator
+ * \ingroup RegionGrowingSegmentation
+ * \ingroup ITKRegionGrowing
+ */
+template< typename TImage, typename TFunction >
+class ParallelFloodFiller:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParallelFloodFiller        Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods).  */
+  itkTypeMacro(ParallelFloodFiller, Object);
+
+  typedef TImage                           ImageType;
+  typedef typename ImageType::IndexType    IndexType;
+  typedef typename ImageType::OffsetType   OffsetType;
+  typedef typename ImageType::RegionType   RegionType;
+  typedef typename ImageType::PixelType    PixelType;
+  typedef std::vector< IndexType >         SeedsContainerType;
+
+  typedef TFunction                                          FunctionType;
+  typedef typename FunctionType::InputImageType              FunctionInputImageType;
+  typedef typename FunctionInputImageType::PixelType         FunctionInputPixelType;
+  typedef typename NumericTraits< FunctionInputPixelType >::RealType RealType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, ImageType::ImageDimension);
+
+  /** Set/Get the image to fill. */
+  itkSetObjectMacro(Image, ImageType);
+  itkGetModifiableObjectMacro(Image, ImageType);
+
+  /** Set/Get the function deciding which pixels are set. */
+  itkSetConstObjectMacro(Function, FunctionType);
+  itkGetConstObjectMacro(Function, FunctionType);
+
+  /** Set/Get the seeds. */
+  void SetSeeds(const SeedsContainerType & seeds)
+  {
+    m_Seeds = seeds;
+    this->Modified();
+  }
+
+  const SeedsContainerType & GetSeeds() const
+  {
+    return m_Seeds;
+  }
+
+  /** Set/Get whether the pixels touching by an edge or a corner are
+   * connected, rather than only the pixels sharing a face. Default is
+   * false. */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /** Set/Get the value given to the pixels connected to the seeds. */
+  itkSetMacro(ReplaceValue, PixelType);
+  itkGetConstMacro(ReplaceValue, PixelType);
+
+  /** Set/Get whether the sum and the sum of squares of the input values of
+   * the function are computed at the pixels set. Default is false. */
+  itkSetMacro(ComputeStatistics, bool);
+  itkGetConstMacro(ComputeStatistics, bool);
+  itkBooleanMacro(ComputeStatistics);
+
+  /** Set/Get the number of threads. Default is the global default number
+   * of threads of MultiThreader. */
+  itkSetClampMacro(NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, ThreadIdType);
+
+  /** Set the pixels connected to the seeds. */
+  void Fill();
+
+  /** Get the number of pixels set by the last call to Fill(). */
+  itkGetConstMacro(NumberOfFilledPixels, SizeValueType);
+
+  /** Get the sum and the sum of squares of the input values of the function
+   * at the pixels set by the last call to Fill(), when ComputeStatistics
+   * is on. */
+  itkGetConstMacro(Sum, RealType);
+  itkGetConstMacro(SumOfSquares, RealType);
+
+protected:
+  ParallelFloodFiller();
+  virtual ~ParallelFloodFiller() {}
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** Grow the region with the pixels owned by a thread. */
+  void ThreadedFill(ThreadIdType threadId);
+
+  /** Look at a pixel owned by a thread, if it has not been visited yet.
+   * Returns true if the pixel is set. */
+  bool VisitPixel(OffsetValueType offset, ThreadIdType threadId);
+
+  /** Thread owning a pixel of the buffer. */
+  ThreadIdType GetOwner(OffsetValueType offset) const
+  {
+    return static_cast< ThreadIdType >( offset / m_PixelsPerThread );
+  }
+
+private:
+  ParallelFloodFiller(const Self &); //purposely not implemented
+  void operator=(const Self &);      //purposely not implemented
+
+  /** Static callback of the threads filling the image. */
+  static ITK_THREAD_RETURN_TYPE FillThreaderCallback(void *arg);
+
+  typename ImageType::Pointer           m_Image;
+  typename FunctionType::ConstPointer   m_Function;
+  SeedsContainerType                    m_Seeds;
+  bool                                  m_FullyConnected;
+  PixelType                             m_ReplaceValue;
+  bool                                  m_ComputeStatistics;
+  ThreadIdType                          m_NumberOfThreads;
+
+  SizeValueType m_NumberOfFilledPixels;
+  RealType      m_Sum;
+  RealType      m_SumOfSquares;
+
+  MultiThreader::Pointer m_Threader;
+  Barrier::Pointer       m_Barrier;
+  ThreadIdType           m_NumberOfThreadsUsed;
+
+  /** Raw access to the image, whose buffered region is the region grown.
+   * Each thread owns a range of m_PixelsPerThread pixels of the buffer, a
+   * multiple of the number of bits of a word of the bitmap. */
+  RegionType      m_Region;
+  PixelType *     m_Buffer;
+  OffsetValueType m_Strides[ImageDimension];
+  OffsetValueType m_PixelsPerThread;
+
+  /** Neighbors of a pixel, as offsets in the buffer and in the index. */
+  std::vector< OffsetValueType > m_NeighborOffsets;
+  std::vector< OffsetType >      m_NeighborIndexOffsets;
+
+  /** Bitmap of the pixels visited. */
+  std::vector< unsigned int > m_Visited;
+
+  /** Pixels of the last layer set by each thread, and neighbors of them
+   * listed by each thread for each thread. */
+  std::vector< std::vector< OffsetValueType > >                m_Layers;
+  std::vector< std::vector< std::vector< OffsetValueType > > > m_Candidates;
+
+  /** For each layer, whether a thread set a pixel. The layers alternate
+   * between two sets of flags, so that a thread may reset its flag of the
+   * next layer while the others read the flags of the last one. */
+  std::vector< unsigned char > m_ThreadFilled[2];
+
+  std::vector< SizeValueType > m_ThreadNumberOfFilledPixels;
+  std::vector< RealType >      m_ThreadSum;
+  std::vector< RealType >      m_ThreadSumOfSquares;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkParallelFloodFiller.hxx"
+#endif
+
+#endif
@@ -0,0 +1,354 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParallelFloodFiller_hxx
+#define itkParallelFloodFiller_hxx
+
+#include "itkParallelFloodFiller.h"
+
+namespace itk
+{
+template< typename TImage, typename TFunction >
+ParallelFloodFiller< TImage, TFunction >
+::ParallelFloodFiller()
+{
+  m_FullyConnected = false;
+  m_ReplaceValue = NumericTraits< PixelType >::OneValue();
+  m_ComputeStatistics = false;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  m_NumberOfFilledPixels = 0;
+  m_Sum = NumericTraits< RealType >::ZeroValue();
+  m_SumOfSquares = NumericTraits< RealType >::ZeroValue();
+
+  m_Threader = MultiThreader::New();
+  m_NumberOfThreadsUsed = 1;
+  m_Buffer = ITK_NULLPTR;
+  m_PixelsPerThread = 1;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    m_Strides[d] = 0;
+    }
+}
+
+template< typename TImage, typename TFunction >
+void
+ParallelFloodFiller< TImage, TFunction >
+::Fill()
+{
+  if ( m_Image.IsNull() || m_Function.IsNull() )
+    {
+    itkExceptionMacro(<< "The image and the function must be set.");
+    }
+
+  m_NumberOfFilledPixels = 0;
+  m_Sum = NumericTraits< RealType >::ZeroValue();
+  m_SumOfSquares = NumericTraits< RealType >::ZeroValue();
+
+  m_Region = m_Image->GetBufferedRegion();
+  const OffsetValueType numberOfPixels =
+    static_cast< OffsetValueType >( m_Region.GetNumberOfPixels() );
+  if ( numberOfPixels == 0 || m_Seeds.empty() )
+    {
+    return;
+    }
+  m_Buffer = m_Image->GetBufferPointer();
+
+  m_Strides[0] = 1;
+  for ( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+    m_Strides[d] = m_Strides[d - 1] * static_cast< OffsetValueType >( m_Region.GetSize()[d - 1] );
+    }
+
+  // The neighbors sharing a face, or all the pixels of the 3x3x...x3
+  // neighborhood but the center
+  m_NeighborOffsets.clear();
+  m_NeighborIndexOffsets.clear();
+  if ( m_FullyConnected )
+    {
+    unsigned int numberOfNeighbors = 1;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      numberOfNeighbors *= 3;
+      }
+    for ( unsigned int n = 0; n < numberOfNeighbors; ++n )
+      {
+      OffsetType      indexOffset;
+      OffsetValueType offset = 0;
+      bool            isCenter = true;
+      unsigned int    code = n;
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        indexOffset[d] = static_cast< OffsetValueType >( code % 3 ) - 1;
+        code /= 3;
+        offset += indexOffset[d] * m_Strides[d];
+        if ( indexOffset[d] != 0 )
+          {
+          isCenter = false;
+          }
+        }
+      if ( !isCenter )
+        {
+        m_NeighborOffsets.push_back(offset);
+        m_NeighborIndexOffsets.push_back(indexOffset);
+        }
+      }
+    }
+  else
+    {
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      for ( int j = -1; j <= 1; j += 2 )
+        {
+        OffsetType indexOffset;
+        indexOffset.Fill(0);
+        indexOffset[d] = j;
+        m_NeighborOffsets.push_back(j * m_Strides[d]);
+        m_NeighborIndexOffsets.push_back(indexOffset);
+        }
+      }
+    }
+
+  // Share the buffer among the threads in ranges of whole words of the
+  // bitmap, so that no word is written by two threads
+  const OffsetValueType bitsPerWord = 8 * sizeof( unsigned int );
+  const OffsetValueType numberOfWords = ( numberOfPixels + bitsPerWord - 1 ) / bitsPerWord;
+  ThreadIdType numberOfThreads = m_NumberOfThreads;
+  if ( static_cast< OffsetValueType >( numberOfThreads ) > numberOfWords )
+    {
+    numberOfThreads = static_cast< ThreadIdType >( numberOfWords );
+    }
+  m_Threader->SetNumberOfThreads(numberOfThreads);
+  numberOfThreads = m_Threader->GetNumberOfThreads();
+
+  const OffsetValueType wordsPerThread =
+    ( numberOfWords + numberOfThreads - 1 ) / numberOfThreads;
+  m_PixelsPerThread = wordsPerThread * bitsPerWord;
+  m_NumberOfThreadsUsed = static_cast< ThreadIdType >(
+    ( numberOfPixels + m_PixelsPerThread - 1 ) / m_PixelsPerThread );
+  m_Threader->SetNumberOfThreads(m_NumberOfThreadsUsed);
+
+  m_Visited.assign(numberOfWords, 0);
+  m_Layers.resize(m_NumberOfThreadsUsed);
+  m_Candidates.resize(m_NumberOfThreadsUsed);
+  for ( ThreadIdType t = 0; t < m_NumberOfThreadsUsed; ++t )
+    {
+    m_Layers[t].clear();
+    m_Candidates[t].resize(m_NumberOfThreadsUsed);
+    for ( ThreadIdType u = 0; u < m_NumberOfThreadsUsed; ++u )
+      {
+      m_Candidates[t][u].clear();
+      }
+    }
+  m_ThreadFilled[0].assign(m_NumberOfThreadsUsed, 0);
+  m_ThreadFilled[1].assign(m_NumberOfThreadsUsed, 0);
+  m_ThreadNumberOfFilledPixels.assign(m_NumberOfThreadsUsed, 0);
+  m_ThreadSum.assign( m_NumberOfThreadsUsed, NumericTraits< RealType >::ZeroValue() );
+  m_ThreadSumOfSquares.assign( m_NumberOfThreadsUsed, NumericTraits< RealType >::ZeroValue() );
+
+  m_Barrier = Barrier::New();
+  m_Barrier->Initialize(m_NumberOfThreadsUsed);
+
+  m_Threader->SetSingleMethod(Self::FillThreaderCallback, this);
+  m_Threader->SingleMethodExecute();
+
+  for ( ThreadIdType t = 0; t < m_NumberOfThreadsUsed; ++t )
+    {
+    m_NumberOfFilledPixels += m_ThreadNumberOfFilledPixels[t];
+    m_Sum += m_ThreadSum[t];
+    m_SumOfSquares += m_ThreadSumOfSquares[t];
+    }
+}
+
+template< typename TImage, typename TFunction >
+ITK_THREAD_RETURN_TYPE
+ParallelFloodFiller< TImage, TFunction >
+::FillThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  Self *filler = static_cast< Self * >( info->UserData );
+
+  filler->ThreadedFill(info->ThreadID);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TImage, typename TFunction >
+void
+ParallelFloodFiller< TImage, TFunction >
+::ThreadedFill(ThreadIdType threadId)
+{
+  const ThreadIdType              numberOfThreads = m_NumberOfThreadsUsed;
+  const OffsetValueType           bitsPerWord = 8 * sizeof( unsigned int );
+  const typename RegionType::IndexType start = m_Region.GetIndex();
+  const typename RegionType::SizeType  size = m_Region.GetSize();
+  std::vector< OffsetValueType > & layer = m_Layers[threadId];
+
+  // The first layer is made of the seeds
+  for ( typename SeedsContainerType::const_iterator seed = m_Seeds.begin();
+        seed != m_Seeds.end(); ++seed )
+    {
+    if ( m_Region.IsInside(*seed) )
+      {
+      OffsetValueType offset = 0;
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        offset += ( ( *seed )[d] - start[d] ) * m_Strides[d];
+        }
+      if ( this->GetOwner(offset) == threadId )
+        {
+        this->VisitPixel(offset, threadId);
+        }
+      }
+    }
+
+  unsigned int parity = 0;
+  m_ThreadFilled[parity][threadId] = !layer.empty();
+  m_Barrier->Wait();
+
+  for (;; )
+    {
+    bool filled = false;
+    for ( ThreadIdType t = 0; t < numberOfThreads; ++t )
+      {
+      if ( m_ThreadFilled[parity][t] )
+        {
+        filled = true;
+        }
+      }
+    if ( !filled )
+      {
+      break;
+      }
+    parity = 1 - parity;
+
+    // List the neighbors of the last layer for the threads owning them
+    for ( typename std::vector< OffsetValueType >::const_iterator it = layer.begin();
+          it != layer.end(); ++it )
+      {
+      IndexType       index;
+      OffsetValueType remainder = *it;
+      for ( int d = ImageDimension - 1; d >= 0; --d )
+        {
+        index[d] = remainder / m_Strides[d];
+        remainder -= index[d] * m_Strides[d];
+        }
+      for ( size_t n = 0; n < m_NeighborOffsets.size(); ++n )
+        {
+        bool isInside = true;
+        for ( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+          const OffsetValueType neighborIndex = index[d] + m_NeighborIndexOffsets[n][d];
+          if ( neighborIndex < 0 || neighborIndex >= static_cast< OffsetValueType >( size[d] ) )
+            {
+            isInside = false;
+            break;
+            }
+          }
+        if ( isInside )
+          {
+          const OffsetValueType neighbor = *it + m_NeighborOffsets[n];
+          const ThreadIdType    owner = this->GetOwner(neighbor);
+          if ( owner != threadId
+               || !( m_Visited[neighbor / bitsPerWord] & ( 1u << ( neighbor % bitsPerWord ) ) ) )
+            {
+            m_Candidates[threadId][owner].push_back(neighbor);
+            }
+          }
+        }
+      }
+    layer.clear();
+    m_Barrier->Wait();
+
+    // Visit the neighbors listed for this thread, which gives the next layer
+    for ( ThreadIdType t = 0; t < numberOfThreads; ++t )
+      {
+      std::vector< OffsetValueType > & candidates = m_Candidates[t][threadId];
+      for ( typename std::vector< OffsetValueType >::const_iterator it = candidates.begin();
+            it != candidates.end(); ++it )
+        {
+        this->VisitPixel(*it, threadId);
+        }
+      candidates.clear();
+      }
+    m_ThreadFilled[parity][threadId] = !layer.empty();
+    m_Barrier->Wait();
+    }
+}
+
+template< typename TImage, typename TFunction >
+bool
+ParallelFloodFiller< TImage, TFunction >
+::VisitPixel(OffsetValueType offset, ThreadIdType threadId)
+{
+  const OffsetValueType bitsPerWord = 8 * sizeof( unsigned int );
+  unsigned int &        word = m_Visited[offset / bitsPerWord];
+  const unsigned int    bit = 1u << ( offset % bitsPerWord );
+
+  if ( word & bit )
+    {
+    return false;
+    }
+  word |= bit;
+
+  IndexType       index;
+  OffsetValueType remainder = offset;
+  for ( int d = ImageDimension - 1; d >= 0; --d )
+    {
+    const OffsetValueType i = remainder / m_Strides[d];
+    remainder -= i * m_Strides[d];
+    index[d] = m_Region.GetIndex()[d] + i;
+    }
+  if ( !m_Function->EvaluateAtIndex(index) )
+    {
+    return false;
+    }
+
+  m_Buffer[offset] = m_ReplaceValue;
+  m_Layers[threadId].push_back(offset);
+  ++m_ThreadNumberOfFilledPixels[threadId];
+  if ( m_ComputeStatistics )
+    {
+    const RealType value =
+      static_cast< RealType >( m_Function->GetInputImage()->GetPixel(index) );
+    m_ThreadSum[threadId] += value;
+    m_ThreadSumOfSquares[threadId] += value * value;
+    }
+  return true;
+}
+
+template< typename TImage, typename TFunction >
+void
+ParallelFloodFiller< TImage, TFunction >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of seeds: " << m_Seeds.size() << std::endl;
+  os << indent << "FullyConnected: " << m_FullyConnected << std::endl;
+  os << indent << "ReplaceValue: "
+     << static_cast< typename NumericTraits< PixelType >::PrintType >( m_ReplaceValue )
+     << std::endl;
+  os << indent << "ComputeStatistics: " << m_ComputeStatistics << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfFilledPixels: " << m_NumberOfFilledPixels << std::endl;
+  os << indent << "Sum: " << m_Sum << std::endl;
+  os << indent << "SumOfSquares: " << m_SumOfSquares << std::endl;
+}
+} // end namespace itk
+
+#endif
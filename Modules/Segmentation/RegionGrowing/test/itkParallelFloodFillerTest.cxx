@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkParallelFloodFiller.h"
+#include "itkBinaryThresholdImageFunction.h"
+#include "itkFloodFilledImageFunctionConditionalIterator.h"
+#include "itkShapedFloodFilledImageFunctionConditionalIterator.h"
+#include "itkConfidenceConnectedImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Grow regions from several seeds in an image with winding structures,
+ * which cross the ranges of pixels of the threads many times, with the
+ * flood filled iterators and with the parallel flood filler, with face and
+ * full connectivity and with several numbers of threads. The pixels set and
+ * the statistics must be identical. The confidence connected filter must
+ * also give the same segmentation with one thread and with several threads.
+ */
+
+namespace
+{
+const unsigned int Dimension = 3;
+typedef itk::Image< unsigned char, Dimension >                     InputImageType;
+typedef itk::Image< unsigned char, Dimension >                     OutputImageType;
+typedef itk::BinaryThresholdImageFunction< InputImageType, double > FunctionType;
+typedef itk::ParallelFloodFiller< OutputImageType, FunctionType >   FillerType;
+
+bool ParallelFloodFillerTestCompare( const OutputImageType * image1,
+                                     const OutputImageType * image2,
+                                     const char * name )
+{
+  itk::ImageRegionConstIteratorWithIndex< OutputImageType > it1( image1, image1->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< OutputImageType >          it2( image2, image2->GetBufferedRegion() );
+  for(; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    if( it1.Get() != it2.Get() )
+      {
+      std::cerr << name << ": " << static_cast< int >( it2.Get() ) << " instead of "
+                << static_cast< int >( it1.Get() ) << " at " << it1.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+OutputImageType::Pointer ParallelFloodFillerTestAllocate( const InputImageType * image )
+{
+  OutputImageType::Pointer output = OutputImageType::New();
+  output->CopyInformation( image );
+  output->SetRegions( image->GetBufferedRegion() );
+  output->Allocate();
+  output->FillBuffer( 0 );
+  return output;
+}
+}
+
+int itkParallelFloodFillerTest( int, char *[] )
+{
+  // an image with a non zero start index and thin winding walls
+  InputImageType::IndexType start = {{ -3, 2, 5 }};
+  InputImageType::SizeType  size = {{ 43, 31, 23 }};
+  InputImageType::RegionType region( start, size );
+  InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< InputImageType > it( image, region );
+  for(; !it.IsAtEnd(); ++it )
+    {
+    const InputImageType::IndexType index = it.GetIndex();
+    const double value = std::sin( 0.37 * index[0] + 0.2 * index[2] ) * std::cos( 0.29 * index[1] )
+                         + 0.5 * std::sin( 0.13 * index[2] * index[0] );
+    it.Set( static_cast< unsigned char >( 60.0 * ( value + 1.5 ) ) );
+    }
+
+  std::vector< InputImageType::IndexType > seeds;
+  const itk::IndexValueType seedIndices[4][Dimension] = { { 0, 3, 6 }, { 20, 15, 12 }, { 37, 30, 27 }, { 20, 15, 12 } };
+  for( unsigned int i = 0; i < 4; ++i )
+    {
+    InputImageType::IndexType seed;
+    for( unsigned int j = 0; j < Dimension; ++j )
+      {
+      seed[j] = seedIndices[i][j];
+      }
+    seeds.push_back( seed );
+    }
+
+  FunctionType::Pointer function = FunctionType::New();
+  function->SetInputImage( image );
+  function->ThresholdBetween( 70, 110 );
+
+  const itk::ThreadIdType numbersOfThreads[3] = { 1, 2, 5 };
+  for( unsigned int c = 0; c < 2; ++c )
+    {
+    const bool fullyConnected = ( c == 1 );
+
+    // the serial region growing, which visits every seed once
+    OutputImageType::Pointer expected = ParallelFloodFillerTestAllocate( image );
+    double                   expectedSum = 0.0;
+    double                   expectedSumOfSquares = 0.0;
+    itk::SizeValueType       expectedNumberOfPixels = 0;
+    if( fullyConnected )
+      {
+      typedef itk::ShapedFloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType >
+        IteratorType;
+      IteratorType fit( expected, function, seeds );
+      fit.SetFullyConnected( true );
+      for( fit.GoToBegin(); !fit.IsAtEnd(); ++fit )
+        {
+        fit.Set( 255 );
+        }
+      }
+    else
+      {
+      typedef itk::FloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType > IteratorType;
+      IteratorType fit( expected, function, seeds );
+      for( fit.GoToBegin(); !fit.IsAtEnd(); ++fit )
+        {
+        fit.Set( 255 );
+        }
+      }
+    itk::ImageRegionConstIteratorWithIndex< OutputImageType > eit( expected, region );
+    for(; !eit.IsAtEnd(); ++eit )
+      {
+      if( eit.Get() )
+        {
+        const double value = image->GetPixel( eit.GetIndex() );
+        expectedSum += value;
+        expectedSumOfSquares += value * value;
+        ++expectedNumberOfPixels;
+        }
+      }
+    if( expectedNumberOfPixels < 100 || expectedNumberOfPixels > region.GetNumberOfPixels() / 2 )
+      {
+      std::cerr << "The test image should give a small region: " << expectedNumberOfPixels << " pixels" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    for( unsigned int t = 0; t < 3; ++t )
+      {
+      OutputImageType::Pointer output = ParallelFloodFillerTestAllocate( image );
+      FillerType::Pointer filler = FillerType::New();
+      filler->SetImage( output );
+      filler->SetFunction( function );
+      filler->SetSeeds( seeds );
+      filler->SetFullyConnected( fullyConnected );
+      filler->SetReplaceValue( 255 );
+      filler->ComputeStatisticsOn();
+      filler->SetNumberOfThreads( numbersOfThreads[t] );
+      filler->Fill();
+      std::cout << ( fullyConnected ? "Full" : "Face" ) << " connectivity, " << numbersOfThreads[t]
+                << " threads: " << filler->GetNumberOfFilledPixels() << " pixels" << std::endl;
+
+      if( !ParallelFloodFillerTestCompare( expected, output, "Flood filler" ) )
+        {
+        return EXIT_FAILURE;
+        }
+      if( filler->GetNumberOfFilledPixels() != expectedNumberOfPixels
+          || filler->GetSum() != expectedSum
+          || filler->GetSumOfSquares() != expectedSumOfSquares )
+        {
+        std::cerr << "Statistics " << filler->GetNumberOfFilledPixels() << ", " << filler->GetSum()
+                  << ", " << filler->GetSumOfSquares() << " instead of " << expectedNumberOfPixels
+                  << ", " << expectedSum << ", " << expectedSumOfSquares << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // the confidence connected filter with one thread and with several threads
+  typedef itk::ConfidenceConnectedImageFilter< InputImageType, OutputImageType > ConfidenceType;
+  OutputImageType::Pointer confidenceOutputs[3];
+  for( unsigned int t = 0; t < 3; ++t )
+    {
+    ConfidenceType::Pointer confidence = ConfidenceType::New();
+    confidence->SetInput( image );
+    confidence->SetSeed( seeds[1] );
+    confidence->AddSeed( seeds[0] );
+    confidence->SetMultiplier( 1.5 );
+    confidence->SetNumberOfIterations( 3 );
+    confidence->SetInitialNeighborhoodRadius( 1 );
+    confidence->SetReplaceValue( 255 );
+    confidence->SetNumberOfThreads( numbersOfThreads[t] );
+    confidence->Update();
+    confidenceOutputs[t] = confidence->GetOutput();
+    std::cout << "Confidence connected, " << numbersOfThreads[t] << " threads: mean "
+              << confidence->GetMean() << ", variance " << confidence->GetVariance() << std::endl;
+    if( t > 0 && !ParallelFloodFillerTestCompare( confidenceOutputs[0], confidenceOutputs[t],
+                                                  "Confidence connected" ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -79,6 +79,12 @@ namespace itk
  * GenerateData() method does not support streaming, but is the common use case
  * for the components.
  *
+ * \par
+ * The segmenter and the relabeler run with the number of threads of this
+ * filter, each thread working on a slab of the image.  The merge tree is
+ * computed by a single thread.  The output does not depend on the number of
+ * threads.
+ *
  * \par Description of the input to this filter
  * The input to this filter is a scalar itk::Image of any dimensionality.  This
  * input image is assumed to represent some sort of height function or edge map
@@ -185,7 +191,8 @@ public:
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
-  /** Standard process object method.  This filter is not multithreaded. */
+  /** Standard process object method.  The threads are used by the
+   * components of the mini-pipeline. */
   void GenerateData() ITK_OVERRIDE;
 
   /** Overloaded to link the input to this filter with the input of the
@@ -184,6 +184,10 @@ WatershedImageFilter< TInputImage >
   m_Segmenter->GetOutputImage()
   ->SetRequestedRegion( this->GetInput()->GetLargestPossibleRegion() );
 
+  // The segmenter and the relabeler use the threads of this filter
+  m_Segmenter->SetNumberOfThreads( this->GetNumberOfThreads() );
+  m_Relabeler->SetNumberOfThreads( this->GetNumberOfThreads() );
+
   // Setup the progress command
   WatershedMiniPipelineProgressCommand::Pointer c =
     dynamic_cast< WatershedMiniPipelineProgressCommand * >(
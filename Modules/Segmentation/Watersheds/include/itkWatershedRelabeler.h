@@ -54,6 +54,10 @@ namespace watershed
  * image.  FloodLevel controls which level in the segmentation hierarchy to
  * produce on the output.
  *
+ * \par
+ * The input image is copied and relabeled by the threads of the filter, each
+ * on a slab of the image along its slowest varying dimension.
+ *
  * \ingroup WatershedSegmentation
  * \sa itk::WatershedImageFilter
  * \sa itk::EquivalencyTable
@@ -150,6 +154,19 @@ protected:
   virtual void GenerateOutputRequestedRegion(DataObject *output) ITK_OVERRIDE;
 
   virtual void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  /** Data shared by the threads copying and relabeling the input.  */
+  struct ThreadStruct {
+    typename ImageType::Pointer Input;
+    typename ImageType::Pointer Output;
+    EquivalencyTable::Pointer Table;
+    std::vector< typename ImageType::RegionType > Pieces;
+  };
+
+private:
+  /** Static callback of the threads copying and relabeling a slab of the
+   * input.  */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
 };
 } // end namespace watershed
 } // end namespace itk
@@ -19,6 +19,7 @@
 #define itkWatershedRelabeler_hxx
 
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionSplitterSlowDimension.h"
 #include "itkWatershedRelabeler.h"
 
 namespace itk
@@ -56,45 +57,77 @@ void Relabeler< TScalar, TImageDimension >
 
   output->SetBufferedRegion( output->GetRequestedRegion() );
   output->Allocate();
-  //
-  // Copy input to output
-  //
-  ImageRegionIterator< ImageType > it_a( input, output->GetRequestedRegion() );
-  ImageRegionIterator< ImageType > it_b( output, output->GetRequestedRegion() );
-  it_a.GoToBegin();
-  it_b.GoToBegin();
-  while ( !it_a.IsAtEnd() )
-    {
-    it_b.Set( it_a.Get() );
-    ++it_a;
-    ++it_b;
-    }
 
   this->UpdateProgress(0.1);
   //
   // Extract the merges up the requested level
   //
-  if ( tree->Empty() == true )
+  if ( tree->Empty() == false )
     {
-    // itkWarningMacro("Empty input.  No relabeling was done.");
-    return;
+    ScalarType max = tree->Back().saliency;
+    ScalarType mergeLimit = static_cast< ScalarType >( m_FloodLevel * max );
+
+    it = tree->Begin();
+    while ( it != tree->End() && ( *it ).saliency <= mergeLimit )
+      {
+      eqT->Add( ( *it ).from, ( *it ).to );
+      it++;
+      }
+    eqT->Flatten();
     }
-  ScalarType max = tree->Back().saliency;
-  ScalarType mergeLimit = static_cast< ScalarType >( m_FloodLevel * max );
 
   this->UpdateProgress(0.5);
 
-  it = tree->Begin();
-  while ( it != tree->End() && ( *it ).saliency <= mergeLimit )
+  //
+  // Copy input to output, relabeled with the merges
+  //
+  ThreadStruct str;
+  str.Input = input;
+  str.Output = output;
+  str.Table = eqT;
+
+  typedef ImageRegionSplitterSlowDimension SplitterType;
+  SplitterType::Pointer splitter = SplitterType::New();
+  const unsigned int numberOfPieces =
+    splitter->GetNumberOfSplits( output->GetRequestedRegion(), this->GetNumberOfThreads() );
+  str.Pieces.resize(numberOfPieces, output->GetRequestedRegion());
+  for ( unsigned int i = 0; i < numberOfPieces; ++i )
     {
-    eqT->Add( ( *it ).from, ( *it ).to );
-    it++;
+    splitter->GetSplit(i, numberOfPieces, str.Pieces[i]);
     }
 
-  SegmenterType::RelabelImage(output, output->GetRequestedRegion(), eqT);
+  this->GetMultiThreader()->SetNumberOfThreads(numberOfPieces);
+  this->GetMultiThreader()->SetSingleMethod(Self::ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
   this->UpdateProgress(1.0);
 }
 
+template< typename TScalar, unsigned int TImageDimension >
+ITK_THREAD_RETURN_TYPE
+Relabeler< TScalar, TImageDimension >
+::ThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+  if ( info->ThreadID < str->Pieces.size() )
+    {
+    ImageRegionIterator< ImageType > it_a( str->Input, str->Pieces[info->ThreadID] );
+    ImageRegionIterator< ImageType > it_b( str->Output, str->Pieces[info->ThreadID] );
+    it_a.GoToBegin();
+    it_b.GoToBegin();
+    while ( !it_a.IsAtEnd() )
+      {
+      it_b.Set( str->Table->Lookup( it_a.Get() ) );
+      ++it_a;
+      ++it_b;
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template< typename TScalar, unsigned int VImageDimension >
 void Relabeler< TScalar, VImageDimension >
 ::GenerateInputRequestedRegion()
@@ -22,6 +22,8 @@
 #include "itkWatershedBoundary.h"
 #include "itkWatershedSegmentTable.h"
 #include "itkEquivalencyTable.h"
+#include "itkMultiThreader.h"
+#include <vector>
 
 namespace itk
 {
@@ -80,6 +82,15 @@ namespace watershed
  * segments.  The assumption is that the ``shallow'' regions that this
  * thresholding eliminates are generally not of interest.
  *
+ * \par Threads
+ * The thresholding, the gradient descent, the relabeling and the
+ * construction of the segment table are done by the threads of the filter,
+ * each on a slab of the image along its slowest varying dimension.  The
+ * paths of steepest descent leaving a slab are joined to the labels at
+ * their ends once all the slabs are labeled, and the segments and edges
+ * found in the slabs are merged in the order of a serial scan of the image.
+ * The output is then the same for any number of threads.
+ *
  * \sa WatershedImageFilter
  * \ingroup WatershedSegmentation
  * \ingroup ITKWatersheds
@@ -264,6 +275,39 @@ protected:
   typedef itksys::hash_map< IdentifierType, edge_table_t, itksys::hash< IdentifierType >
                          > edge_table_hash_t;
 
+  /** Segment found by a thread in its slab of the image, with the edges
+   * to its neighbors in the order in which they were found.  */
+  struct thread_segment_t {
+    InputPixelType min;
+    edge_table_t edge_table;
+    std::vector< IdentifierType > edge_order;
+  };
+
+  typedef itksys::hash_map< IdentifierType, thread_segment_t, itksys::hash< IdentifierType >
+                            > thread_segment_table_t;
+
+  /** Steps of the algorithm that the threads do on their slabs.  */
+  typedef enum { MIN_MAX, THRESHOLD, RELABEL, GRADIENT_DESCENT,
+                 SEGMENT_TABLE } ThreadStepType;
+
+  /** Data shared by the threads during a step, and their results.  */
+  struct ThreadStruct {
+    Self *Filter;
+    ThreadStepType Step;
+    std::vector< ImageRegionType > Pieces;
+    ImageRegionType Region;
+    InputImageTypePointer Image;
+    InputImageTypePointer Source;
+    OutputImageTypePointer Labels;
+    EquivalencyTable::Pointer Table;
+    InputPixelType Threshold;
+    std::vector< InputPixelType > Minimum;
+    std::vector< InputPixelType > Maximum;
+    std::vector< std::vector< IdentifierType * > > DescentTargets;
+    std::vector< thread_segment_table_t > Segments;
+    std::vector< std::vector< IdentifierType > > SegmentOrder;
+  };
+
   Segmenter();
   Segmenter(const Self &) {}
   virtual ~Segmenter();
@@ -320,6 +364,42 @@ protected:
    * image.  */
   void UpdateSegmentTable(InputImageTypePointer, ImageRegionType);
 
+  /** Splits a region into slabs along its slowest varying dimension, at
+   * most one for each thread, in the order of a scan of the region.  */
+  void SplitRegion(const ImageRegionType & region,
+                   std::vector< ImageRegionType > & pieces);
+
+  /** Runs a step of the algorithm on the slabs of the ThreadStruct, one
+   * for each thread. */
+  void ExecuteThreadStep(ThreadStruct & str);
+
+  /** Does a step of the algorithm on the slab of a thread.  */
+  void ThreadedStep(ThreadStruct & str, ThreadIdType threadId);
+
+  /** Follows the paths of steepest descent starting in the slab of a
+   * thread.  A path leaving the slab is labeled with a temporary label,
+   * which encodes the target it leaves the slab for.  */
+  void ThreadedGradientDescent(ThreadStruct & str, ThreadIdType threadId);
+
+  /** Collects the segments of the slab of a thread and their edges.  */
+  void ThreadedUpdateSegmentTable(ThreadStruct & str, ThreadIdType threadId);
+
+  /** Same as MinMax() and Threshold(), with the threads of the filter.  */
+  void ThreadedMinMax(InputImageTypePointer img,
+                      ImageRegionType region,
+                      InputPixelType & min,
+                      InputPixelType & max);
+
+  void ThreadedThreshold(InputImageTypePointer destination,
+                         InputImageTypePointer source,
+                         ImageRegionType region,
+                         InputPixelType threshold);
+
+  /** Same as RelabelImage(), with the threads of the filter.  */
+  void ThreadedRelabelImage(OutputImageTypePointer,
+                            ImageRegionType,
+                            EquivalencyTable::Pointer);
+
   /** Traverses each boundary and fills in the data needed for joining
    * streamed chunks of an image volume.  Only necessary for streaming
    * applications.   */
@@ -362,6 +442,9 @@ protected:
   connectivity_t m_Connectivity;
 
 private:
+  /** Static callback of the threads doing a step of the algorithm.  */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
   /** Helper, debug method.   */
   //  void PrintFlatRegions(flat_region_table_t &t);
 
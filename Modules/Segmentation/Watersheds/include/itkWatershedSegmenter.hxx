@@ -22,6 +22,7 @@
 #include "itkWatershedSegmenter.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionSplitterSlowDimension.h"
 #include <stack>
 #include <list>
 
@@ -174,7 +175,7 @@ void Segmenter< TInputImage >::GenerateData()
   //
   //
   InputPixelType minimum, maximum;
-  Self::MinMax(input, regionToProcess, minimum, maximum);
+  this->ThreadedMinMax(input, regionToProcess, minimum, maximum);
   // cap the maximum in the image so that we can always define a pixel
   // value that is one greater than the maximum value in the image.
   if ( NumericTraits< InputPixelType >::IsInteger
@@ -186,8 +187,8 @@ CLANG_PRAGMA_POP
     maximum -= NumericTraits< InputPixelType >::OneValue();
     }
   // threshold the image.
-  Self::Threshold( thresholdImage, input, regionToProcess, regionToProcess,
-                   static_cast< InputPixelType >( ( m_Threshold * ( maximum - minimum ) ) + minimum ) );
+  this->ThreadedThreshold( thresholdImage, input, regionToProcess,
+                           static_cast< InputPixelType >( ( m_Threshold * ( maximum - minimum ) ) + minimum ) );
 
   //
   // Redefine the regionToProcess in terms of the threshold image.  The region
@@ -771,7 +772,7 @@ void Segmenter< TInputImage >
   Self::MergeFlatRegions(flatRegions, equivalentLabels);
 
   // Relabel the image with the merged regions.
-  Self::RelabelImage(output, region, equivalentLabels);
+  this->ThreadedRelabelImage(output, region, equivalentLabels);
 
   equivalentLabels->Clear();
 
@@ -818,7 +819,7 @@ void Segmenter< TInputImage >
   Self::MergeFlatRegions(flatRegions, equivalentLabels);
 
   // Relabel the image with the merged regions.
-  Self::RelabelImage(output, region, equivalentLabels);
+  this->ThreadedRelabelImage(output, region, equivalentLabels);
 }
 
 template< typename TInputImage >
@@ -834,6 +835,77 @@ void Segmenter< TInputImage >
   IdentifierType                 newLabel;
   std::stack< IdentifierType * > updateStack;
 
+  //
+  // With several threads, each one labels the paths starting in its own
+  // slab.  The paths leaving a slab get a temporary label, counted down
+  // from the largest label, and are joined to the labels at their ends
+  // once all the slabs are done.
+  //
+  std::vector< ImageRegionType > pieces;
+  this->SplitRegion(region, pieces);
+  const IdentifierType numberOfPieces = static_cast< IdentifierType >( pieces.size() );
+  if ( numberOfPieces > 1
+       && ( NumericTraits< IdentifierType >::max() - m_CurrentLabel ) / numberOfPieces
+       > static_cast< IdentifierType >( region.GetNumberOfPixels() ) )
+    {
+    ThreadStruct str;
+    str.Step = GRADIENT_DESCENT;
+    str.Pieces = pieces;
+    str.Region = region;
+    str.Image = img;
+    str.Labels = output;
+    str.DescentTargets.resize(pieces.size());
+    this->ExecuteThreadStep(str);
+
+    // Follow each target to the slab that labeled it, until a label
+    // given by LabelMinima is found.
+    std::vector< std::vector< IdentifierType > > resolved( pieces.size() );
+    for ( ThreadIdType t = 0; t < pieces.size(); ++t )
+      {
+      resolved[t].resize(str.DescentTargets[t].size(), NULL_LABEL);
+      }
+    EquivalencyTable::Pointer equivalentLabels = EquivalencyTable::New();
+    std::vector< std::pair< IdentifierType, IdentifierType > > chain;
+    for ( ThreadIdType t = 0; t < pieces.size(); ++t )
+      {
+      for ( IdentifierType g = 0; g < str.DescentTargets[t].size(); ++g )
+        {
+        IdentifierType piece = t;
+        IdentifierType target = g;
+        newLabel = NULL_LABEL;
+        chain.clear();
+        while ( newLabel == NULL_LABEL )
+          {
+          if ( resolved[piece][target] != NULL_LABEL )
+            {
+            newLabel = resolved[piece][target];
+            break;
+            }
+          chain.push_back( std::make_pair(piece, target) );
+          const IdentifierType label = *( str.DescentTargets[piece][target] );
+          if ( label < m_CurrentLabel )
+            {
+            newLabel = label;
+            }
+          else
+            {
+            const IdentifierType code = NumericTraits< IdentifierType >::max() - label;
+            piece = code % numberOfPieces;
+            target = code / numberOfPieces;
+            }
+          }
+        for ( size_t c = 0; c < chain.size(); ++c )
+          {
+          resolved[chain[c].first][chain[c].second] = newLabel;
+          }
+        equivalentLabels->Add(NumericTraits< IdentifierType >::max() - ( g * numberOfPieces + t ),
+                              newLabel);
+        }
+      }
+    this->ThreadedRelabelImage(output, region, equivalentLabels);
+    return;
+    }
+
   //
   // Set up our iterators.
   //
@@ -912,7 +984,7 @@ void Segmenter< TInputImage >
     }
 
   equivalentLabels->Flatten();
-  Self::RelabelImage(output, imageRegion, equivalentLabels);
+  this->ThreadedRelabelImage(output, imageRegion, equivalentLabels);
 }
 
 template< typename TInputImage >
@@ -947,61 +1019,125 @@ void Segmenter< TInputImage >
 
   IdentifierType hoodCenter = searchIt.Size() >> 1;
 
-  for ( searchIt.GoToBegin(), labelIt.GoToBegin(); !searchIt.IsAtEnd();
-        ++searchIt, ++labelIt )
+  std::vector< ImageRegionType > pieces;
+  this->SplitRegion(region, pieces);
+  if ( pieces.size() > 1 )
     {
-    segment_label = labelIt.GetPixel(hoodCenter);
-
-    // Find the segment corresponding to this label
-    // and update its minimum value if necessary.
-    segment_ptr = segments->Lookup(segment_label);
-    edge_table_entry_ptr = edgeHash.find(segment_label);
-    if ( segment_ptr == ITK_NULLPTR ) // This segment not yet identified.
-      {                     // So add it to the table.
-      temp_segment.min = searchIt.GetPixel(hoodCenter);
-      segments->Add(segment_label, temp_segment);
-      typedef typename edge_table_hash_t::value_type ValueType;
-      edgeHash.insert( ValueType(segment_label,
-                                 tempEdgeTable) );
-
-      edge_table_entry_ptr = edgeHash.find(segment_label);
-      }
-    else if ( searchIt.GetPixel(hoodCenter) < segment_ptr->min )
+    // Each thread collects the segments and edges of its slab.  Merging
+    // them in the order of the slabs adds the segments and the edges to
+    // the tables in the same order as a serial scan of the image.
+    ThreadStruct str;
+    str.Step = SEGMENT_TABLE;
+    str.Pieces = pieces;
+    str.Region = region;
+    str.Image = input;
+    str.Labels = output;
+    str.Segments.resize(pieces.size());
+    str.SegmentOrder.resize(pieces.size());
+    this->ExecuteThreadStep(str);
+
+    for ( ThreadIdType t = 0; t < pieces.size(); ++t )
       {
-      segment_ptr->min = searchIt.GetPixel(hoodCenter);
-      }
-
-    // Look up each neighboring segment in this segment's edge table.
-    // If an edge exists, compare (and reset) the minimum edge value.
-    // Note that edges are located *between* two adjacent pixels and
-    // the value is taken to be the maximum of the two adjacent pixel
-    // values.
-    for ( i = 0; i < m_Connectivity.size; ++i )
-      {
-      nPos = m_Connectivity.index[i];
-      if ( labelIt.GetPixel(nPos) != segment_label
-           && labelIt.GetPixel(nPos) != NULL_LABEL )
+      for ( typename std::vector< IdentifierType >::const_iterator label = str.SegmentOrder[t].begin();
+            label != str.SegmentOrder[t].end(); ++label )
         {
-        if ( searchIt.GetPixel(nPos) < searchIt.GetPixel(hoodCenter) )
+        segment_label = *label;
+        thread_segment_t & piece_segment = ( *str.Segments[t].find(segment_label) ).second;
+
+        segment_ptr = segments->Lookup(segment_label);
+        if ( segment_ptr == ITK_NULLPTR )
           {
-          lowest_edge = searchIt.GetPixel(hoodCenter); // We want the
+          temp_segment.min = piece_segment.min;
+          segments->Add(segment_label, temp_segment);
+          typedef typename edge_table_hash_t::value_type ValueType;
+          edgeHash.insert( ValueType(segment_label,
+                                     tempEdgeTable) );
           }
-        else
+        else if ( piece_segment.min < segment_ptr->min )
           {
-          lowest_edge = searchIt.GetPixel(nPos);       // max of the
+          segment_ptr->min = piece_segment.min;
           }
-        // adjacent pixels
+        edge_table_entry_ptr = edgeHash.find(segment_label);
 
-        edge_ptr = ( *edge_table_entry_ptr ).second.find( labelIt.GetPixel(nPos) );
-        if ( edge_ptr == ( *edge_table_entry_ptr ).second.end() )
-          {     // This edge has not been identified yet.
-          typedef typename edge_table_t::value_type ValueType;
-          ( *edge_table_entry_ptr ).second.insert(
-            ValueType(labelIt.GetPixel(nPos), lowest_edge) );
+        for ( typename std::vector< IdentifierType >::const_iterator neighbor = piece_segment.edge_order.begin();
+              neighbor != piece_segment.edge_order.end(); ++neighbor )
+          {
+          lowest_edge = ( *piece_segment.edge_table.find(*neighbor) ).second;
+          edge_ptr = ( *edge_table_entry_ptr ).second.find(*neighbor);
+          if ( edge_ptr == ( *edge_table_entry_ptr ).second.end() )
+            {
+            typedef typename edge_table_t::value_type ValueType;
+            ( *edge_table_entry_ptr ).second.insert( ValueType(*neighbor, lowest_edge) );
+            }
+          else if ( lowest_edge < ( *edge_ptr ).second )
+            {
+            ( *edge_ptr ).second = lowest_edge;
+            }
           }
-        else if ( lowest_edge < ( *edge_ptr ).second )
+        }
+
+      // Clean up memory as we go
+      str.Segments[t].clear();
+      }
+    }
+  else
+    {
+    for ( searchIt.GoToBegin(), labelIt.GoToBegin(); !searchIt.IsAtEnd();
+          ++searchIt, ++labelIt )
+      {
+      segment_label = labelIt.GetPixel(hoodCenter);
+
+      // Find the segment corresponding to this label
+      // and update its minimum value if necessary.
+      segment_ptr = segments->Lookup(segment_label);
+      edge_table_entry_ptr = edgeHash.find(segment_label);
+      if ( segment_ptr == ITK_NULLPTR ) // This segment not yet identified.
+        {                     // So add it to the table.
+        temp_segment.min = searchIt.GetPixel(hoodCenter);
+        segments->Add(segment_label, temp_segment);
+        typedef typename edge_table_hash_t::value_type ValueType;
+        edgeHash.insert( ValueType(segment_label,
+                                   tempEdgeTable) );
+
+        edge_table_entry_ptr = edgeHash.find(segment_label);
+        }
+      else if ( searchIt.GetPixel(hoodCenter) < segment_ptr->min )
+        {
+        segment_ptr->min = searchIt.GetPixel(hoodCenter);
+        }
+
+      // Look up each neighboring segment in this segment's edge table.
+      // If an edge exists, compare (and reset) the minimum edge value.
+      // Note that edges are located *between* two adjacent pixels and
+      // the value is taken to be the maximum of the two adjacent pixel
+      // values.
+      for ( i = 0; i < m_Connectivity.size; ++i )
+        {
+        nPos = m_Connectivity.index[i];
+        if ( labelIt.GetPixel(nPos) != segment_label
+             && labelIt.GetPixel(nPos) != NULL_LABEL )
           {
-          ( *edge_ptr ).second = lowest_edge;
+          if ( searchIt.GetPixel(nPos) < searchIt.GetPixel(hoodCenter) )
+            {
+            lowest_edge = searchIt.GetPixel(hoodCenter); // We want the
+            }
+          else
+            {
+            lowest_edge = searchIt.GetPixel(nPos);       // max of the
+            }
+          // adjacent pixels
+
+          edge_ptr = ( *edge_table_entry_ptr ).second.find( labelIt.GetPixel(nPos) );
+          if ( edge_ptr == ( *edge_table_entry_ptr ).second.end() )
+            {     // This edge has not been identified yet.
+            typedef typename edge_table_t::value_type ValueType;
+            ( *edge_table_entry_ptr ).second.insert(
+              ValueType(labelIt.GetPixel(nPos), lowest_edge) );
+            }
+          else if ( lowest_edge < ( *edge_ptr ).second )
+            {
+            ( *edge_ptr ).second = lowest_edge;
+            }
           }
         }
       }
@@ -1042,6 +1178,289 @@ void Segmenter< TInputImage >
     }
 }
 
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::SplitRegion(const ImageRegionType & region,
+              std::vector< ImageRegionType > & pieces)
+{
+  typedef ImageRegionSplitterSlowDimension SplitterType;
+  SplitterType::Pointer splitter = SplitterType::New();
+  const unsigned int numberOfPieces =
+    splitter->GetNumberOfSplits( region, this->GetNumberOfThreads() );
+
+  pieces.resize(numberOfPieces);
+  for ( unsigned int i = 0; i < numberOfPieces; ++i )
+    {
+    pieces[i] = region;
+    splitter->GetSplit(i, numberOfPieces, pieces[i]);
+    }
+}
+
+template< typename TInputImage >
+ITK_THREAD_RETURN_TYPE
+Segmenter< TInputImage >
+::ThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+  if ( info->ThreadID < str->Pieces.size() )
+    {
+    str->Filter->ThreadedStep(*str, info->ThreadID);
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::ExecuteThreadStep(ThreadStruct & str)
+{
+  str.Filter = this;
+  this->GetMultiThreader()->SetNumberOfThreads( static_cast< ThreadIdType >( str.Pieces.size() ) );
+  this->GetMultiThreader()->SetSingleMethod(Self::ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::ThreadedStep(ThreadStruct & str, ThreadIdType threadId)
+{
+  const ImageRegionType & piece = str.Pieces[threadId];
+
+  switch ( str.Step )
+    {
+    case MIN_MAX:
+      Self::MinMax(str.Image, piece, str.Minimum[threadId], str.Maximum[threadId]);
+      break;
+    case THRESHOLD:
+      Self::Threshold(str.Image, str.Source, piece, piece, str.Threshold);
+      break;
+    case RELABEL:
+      {
+      IdentifierType                         temp;
+      ImageRegionIterator< OutputImageType > it(str.Labels, piece);
+      for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+        {
+        temp = str.Table->Lookup( it.Get() );
+        if ( temp != it.Get() )  { it.Set(temp); }
+        }
+      }
+      break;
+    case GRADIENT_DESCENT:
+      this->ThreadedGradientDescent(str, threadId);
+      break;
+    case SEGMENT_TABLE:
+      this->ThreadedUpdateSegmentTable(str, threadId);
+      break;
+    }
+}
+
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::ThreadedGradientDescent(ThreadStruct & str, ThreadIdType threadId)
+{
+  const ImageRegionType &  piece = str.Pieces[threadId];
+  const IdentifierType     numberOfPieces = static_cast< IdentifierType >( str.Pieces.size() );
+  std::vector< IdentifierType * > & targets = str.DescentTargets[threadId];
+
+  InputPixelType minVal;
+  unsigned int   i, nPos;
+  typename InputImageType::OffsetType moveIndex;
+  typename InputImageType::IndexType index;
+  IdentifierType                 newLabel;
+  std::stack< IdentifierType * > updateStack;
+
+  typename ConstNeighborhoodIterator< InputImageType >::RadiusType rad;
+  typename NeighborhoodIterator< OutputImageType >::RadiusType zeroRad;
+  for ( i = 0; i < ImageDimension; ++i )
+    {
+    rad[i] = 1;
+    zeroRad[i] = 0;
+    }
+  ConstNeighborhoodIterator< InputImageType >
+  valueIt(rad, str.Image, str.Region);
+  NeighborhoodIterator< OutputImageType >
+                                         labelIt(zeroRad, str.Labels, str.Region);
+  ImageRegionIterator< OutputImageType > it(str.Labels, piece);
+
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() == NULL_LABEL )
+      {
+      index = it.GetIndex();
+      valueIt.SetLocation(index);
+      labelIt.SetLocation(index);
+      newLabel = NULL_LABEL;
+      while ( newLabel == NULL_LABEL )
+        {
+        updateStack.push( labelIt.GetCenterPointer() );
+        minVal = valueIt.GetPixel(m_Connectivity.index[0]);
+        moveIndex = m_Connectivity.direction[0];
+        for ( unsigned int ii = 1; ii < m_Connectivity.size; ++ii )
+          {
+          nPos = m_Connectivity.index[ii];
+          if ( valueIt.GetPixel(nPos) < minVal )
+            {
+            minVal = valueIt.GetPixel(nPos);
+            moveIndex = m_Connectivity.direction[ii];
+            }
+          }
+        valueIt += moveIndex;
+        labelIt += moveIndex;
+        index += moveIndex;
+        if ( piece.IsInside(index) )
+          {
+          newLabel = labelIt.GetPixel(0);
+          }
+        else
+          {
+          // The label of a pixel in another slab may not be known yet.
+          // Remember where the path goes.
+          newLabel = NumericTraits< IdentifierType >::max()
+                     - ( static_cast< IdentifierType >( targets.size() ) * numberOfPieces + threadId );
+          targets.push_back( labelIt.GetCenterPointer() );
+          }
+        }
+
+      while ( !updateStack.empty() )
+        {
+        *( updateStack.top() ) = newLabel;
+        updateStack.pop();
+        }
+      }
+    }
+}
+
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::ThreadedUpdateSegmentTable(ThreadStruct & str, ThreadIdType threadId)
+{
+  thread_segment_table_t &        segments = str.Segments[threadId];
+  std::vector< IdentifierType > & order = str.SegmentOrder[threadId];
+
+  typename thread_segment_table_t::iterator segment_ptr;
+  typename edge_table_t::iterator edge_ptr;
+  thread_segment_t temp_segment;
+
+  unsigned int i, nPos;
+  typename NeighborhoodIterator< OutputImageType >::RadiusType hoodRadius;
+  IdentifierType segment_label, neighbor_label;
+  InputPixelType lowest_edge;
+
+  for ( i = 0; i < ImageDimension; i++ )
+    {
+    hoodRadius[i] = 1;
+    }
+  ConstNeighborhoodIterator< InputImageType > searchIt(hoodRadius, str.Image, str.Pieces[threadId]);
+  ConstNeighborhoodIterator< OutputImageType > labelIt(hoodRadius, str.Labels, str.Pieces[threadId]);
+
+  IdentifierType hoodCenter = searchIt.Size() >> 1;
+
+  for ( searchIt.GoToBegin(), labelIt.GoToBegin(); !searchIt.IsAtEnd();
+        ++searchIt, ++labelIt )
+    {
+    segment_label = labelIt.GetPixel(hoodCenter);
+
+    segment_ptr = segments.find(segment_label);
+    if ( segment_ptr == segments.end() )
+      {
+      temp_segment.min = searchIt.GetPixel(hoodCenter);
+      typedef typename thread_segment_table_t::value_type ValueType;
+      segment_ptr = segments.insert( ValueType(segment_label, temp_segment) ).first;
+      order.push_back(segment_label);
+      }
+    else if ( searchIt.GetPixel(hoodCenter) < ( *segment_ptr ).second.min )
+      {
+      ( *segment_ptr ).second.min = searchIt.GetPixel(hoodCenter);
+      }
+
+    for ( i = 0; i < m_Connectivity.size; ++i )
+      {
+      nPos = m_Connectivity.index[i];
+      neighbor_label = labelIt.GetPixel(nPos);
+      if ( neighbor_label != segment_label && neighbor_label != NULL_LABEL )
+        {
+        if ( searchIt.GetPixel(nPos) < searchIt.GetPixel(hoodCenter) )
+          {
+          lowest_edge = searchIt.GetPixel(hoodCenter);
+          }
+        else
+          {
+          lowest_edge = searchIt.GetPixel(nPos);
+          }
+
+        edge_ptr = ( *segment_ptr ).second.edge_table.find(neighbor_label);
+        if ( edge_ptr == ( *segment_ptr ).second.edge_table.end() )
+          {
+          typedef typename edge_table_t::value_type ValueType;
+          ( *segment_ptr ).second.edge_table.insert( ValueType(neighbor_label, lowest_edge) );
+          ( *segment_ptr ).second.edge_order.push_back(neighbor_label);
+          }
+        else if ( lowest_edge < ( *edge_ptr ).second )
+          {
+          ( *edge_ptr ).second = lowest_edge;
+          }
+        }
+      }
+    }
+}
+
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::ThreadedMinMax(InputImageTypePointer img, ImageRegionType region,
+                 InputPixelType & min, InputPixelType & max)
+{
+  ThreadStruct str;
+  str.Step = MIN_MAX;
+  this->SplitRegion(region, str.Pieces);
+  str.Image = img;
+  str.Minimum.resize( str.Pieces.size() );
+  str.Maximum.resize( str.Pieces.size() );
+  this->ExecuteThreadStep(str);
+
+  min = str.Minimum[0];
+  max = str.Maximum[0];
+  for ( size_t i = 1; i < str.Pieces.size(); ++i )
+    {
+    if ( str.Maximum[i] > max ) { max = str.Maximum[i]; }
+    if ( str.Minimum[i] < min ) { min = str.Minimum[i]; }
+    }
+}
+
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::ThreadedThreshold(InputImageTypePointer destination,
+                    InputImageTypePointer source,
+                    ImageRegionType region,
+                    InputPixelType threshold)
+{
+  ThreadStruct str;
+  str.Step = THRESHOLD;
+  this->SplitRegion(region, str.Pieces);
+  str.Image = destination;
+  str.Source = source;
+  str.Threshold = threshold;
+  this->ExecuteThreadStep(str);
+}
+
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::ThreadedRelabelImage(OutputImageTypePointer img,
+                       ImageRegionType region,
+                       EquivalencyTable::Pointer eqTable)
+{
+  // Flatten the table before the threads look it up.
+  eqTable->Flatten();
+
+  ThreadStruct str;
+  str.Step = RELABEL;
+  this->SplitRegion(region, str.Pieces);
+  str.Labels = img;
+  str.Table = eqTable;
+  this->ExecuteThreadStep(str);
+}
+
 template< typename TInputImage >
 void Segmenter< TInputImage >
 ::BuildRetainingWall(InputImageTypePointer img,
@@ -0,0 +1,129 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkWatershedImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+/**
+ * Segment an image of integers, which has flat regions and ties between
+ * the heights of the edges, with one thread and with several threads. The
+ * paths of steepest descent and the flat regions cross the slabs of the
+ * threads, and the initial segmentation, the merge tree and the output
+ * must be identical.
+ */
+
+namespace
+{
+template< typename TImage >
+bool WatershedImageFilterThreadingTestCompare( const TImage * image1,
+                                               const TImage * image2,
+                                               const char * name )
+{
+  itk::ImageRegionConstIteratorWithIndex< TImage > it1( image1, image1->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< TImage >          it2( image2, image2->GetBufferedRegion() );
+  for(; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    if( it1.Get() != it2.Get() )
+      {
+      std::cerr << name << ": label " << it2.Get() << " instead of " << it1.Get()
+                << " at " << it1.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int itkWatershedImageFilterThreadingTest( int, char *[] )
+{
+  const unsigned int Dimension = 3;
+  typedef itk::Image< unsigned char, Dimension >                  ImageType;
+  typedef itk::WatershedImageFilter< ImageType >                  FilterType;
+  typedef FilterType::OutputImageType                             LabelImageType;
+  typedef itk::watershed::SegmentTree< FilterType::ScalarType >   SegmentTreeType;
+
+  ImageType::SizeType size = {{ 37, 29, 41 }};
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for(; !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    const double value = std::sin( 0.31 * index[0] ) * std::cos( 0.23 * index[1] )
+                         + std::sin( 0.17 * index[2] + 0.11 * index[0] )
+                         + 0.3 * std::sin( 1.3 * index[0] + 0.7 * index[1] ) * std::cos( 1.1 * index[2] );
+    it.Set( static_cast< unsigned char >( 20.0 * ( value + 2.0 ) ) );
+    }
+
+  const double levels[3] = { 0.0, 0.3, 1.0 };
+  const itk::ThreadIdType numbersOfThreads[3] = { 1, 2, 5 };
+  for( unsigned int l = 0; l < 3; ++l )
+    {
+    LabelImageType::Pointer  basicSegmentations[3];
+    SegmentTreeType::Pointer trees[3];
+    LabelImageType::Pointer  outputs[3];
+    for( unsigned int t = 0; t < 3; ++t )
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( image );
+      filter->SetThreshold( 0.01 );
+      filter->SetLevel( levels[l] );
+      filter->SetNumberOfThreads( numbersOfThreads[t] );
+      filter->Update();
+      basicSegmentations[t] = filter->GetBasicSegmentation();
+      trees[t] = filter->GetSegmentTree();
+      outputs[t] = filter->GetOutput();
+      std::cout << "Level " << levels[l] << ", " << numbersOfThreads[t] << " threads: "
+                << trees[t]->Size() << " merges" << std::endl;
+      }
+
+    for( unsigned int t = 1; t < 3; ++t )
+      {
+      if( !WatershedImageFilterThreadingTestCompare( basicSegmentations[0].GetPointer(),
+                                                     basicSegmentations[t].GetPointer(),
+                                                     "Basic segmentation" )
+          || !WatershedImageFilterThreadingTestCompare( outputs[0].GetPointer(),
+                                                        outputs[t].GetPointer(),
+                                                        "Output" ) )
+        {
+        return EXIT_FAILURE;
+        }
+      if( trees[t]->Size() != trees[0]->Size() )
+        {
+        std::cerr << "The merge trees have different sizes" << std::endl;
+        return EXIT_FAILURE;
+        }
+      SegmentTreeType::ConstIterator m0 = trees[0]->Begin();
+      SegmentTreeType::ConstIterator m = trees[t]->Begin();
+      for(; m0 != trees[0]->End(); ++m0, ++m )
+        {
+        if( m->from != m0->from || m->to != m0->to || m->saliency != m0->saliency )
+          {
+          std::cerr << "Merge of " << m->from << " into " << m->to << " at "
+                    << static_cast< double >( m->saliency ) << " instead of " << m0->from
+                    << " into " << m0->to << " at " << static_cast< double >( m0->saliency ) << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}